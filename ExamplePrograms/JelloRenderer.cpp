@@ -19,6 +19,7 @@ with Virtual Jell-O; if not, write to the Free Software Foundation,
 Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 ***********************************************************************/
 
+#include <Geometry/OrthogonalTransformation.h>
 #include <GL/gl.h>
 #include <GL/GLColorTemplates.h>
 #include <GL/GLVertexArrayParts.h>
@@ -439,3 +440,17 @@ void JelloRenderer::glRenderActionTransparent(GLContextData& contextData) const
 	glPopMatrix();
 	glPopAttrib();
 	}
+
+bool JelloRenderer::getBoundingSphere(Vrui::Point& center,Vrui::Scalar& radius) const
+	{
+	if(!active)
+		return false;
+	
+	/* Enclose the crystal's domain box and transform the sphere to physical coordinates: */
+	const Box& domain=crystal->getDomain();
+	const Vrui::NavTransform& nav=Vrui::getNavigationTransformation();
+	center=nav.transform(Geometry::mid(domain.min,domain.max));
+	radius=Geometry::dist(domain.min,domain.max)*Scalar(0.5)*nav.getScaling();
+	
+	return true;
+	}
@@ -96,6 +96,7 @@ class JelloRenderer:public GLObject,public Vrui::TransparentObject
 	void update(void); // Updates the face splines to represent the new state of the Jell-O crystal; must be called at least once before the first rendering
 	void glRenderAction(GLContextData& contextData) const; // Renders the opaque parts of the most recently updated state of the Jell-O crystal
 	void glRenderActionTransparent(GLContextData& contextData) const; // Renders the transparent part of the most recently updated state of the Jell-O crystal
+	virtual bool getBoundingSphere(Vrui::Point& center,Vrui::Scalar& radius) const; // Returns a sphere enclosing the Jell-O crystal's domain in physical coordinates
 	};
 
 #endif
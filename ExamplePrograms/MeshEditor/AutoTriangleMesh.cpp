@@ -1,7 +1,7 @@
 /***********************************************************************
 AutoTriangleMesh - Class for triangular meshes that enforce triangle
 shape constraints under mesh transformations.
-Copyright (c) 2003-2005 Oliver Kreylos
+Copyright (c) 2003-2011 Oliver Kreylos
 ***********************************************************************/
 
 #include <assert.h>
@@ -45,7 +45,7 @@ AutoTriangleMesh& AutoTriangleMesh::operator=(const AutoTriangleMesh::BaseMesh&
 	if(this!=&source)
 		{
 		/* Copy polygon mesh: */
-		*this=source;
+		BaseMesh::operator=(source);
 		
 		/* Polygon mesh is already created; now triangulate it: */
 		triangulateAllFaces();
@@ -99,26 +99,26 @@ AutoTriangleMesh::FaceIterator AutoTriangleMesh::addFace(const std::vector<AutoT
 void AutoTriangleMesh::splitEdge(const AutoTriangleMesh::EdgeIterator& edge)
 	{
 	/* Get triangle topology: */
-	Edge* e1=&(*edge);
-	Edge* e2=e1->getFaceSucc();
-	Edge* e3=e1->getFacePred();
-	Vertex* v1=e1->getStart();
-	Vertex* v2=e2->getStart();
-	Vertex* v3=e3->getStart();
-	Face* f1=e1->getFace();
+	EdgeIterator e1=edge;
+	EdgeIterator e2=e1->getFaceSucc();
+	EdgeIterator e3=e1->getFacePred();
+	VertexIterator v1=e1->getStart();
+	VertexIterator v2=e2->getStart();
+	VertexIterator v3=e3->getStart();
+	FaceIterator f1=e1->getFace();
 	
 	assert(e2->getFaceSucc()==e3&&e3->getFacePred()==e2);
 	assert(e2->getFace()==f1);
 	assert(e3->getFace()==f1);
 	assert(f1->getEdge()==e1||f1->getEdge()==e2||f1->getEdge()==e3);
 	
-	Edge* e4=e1->getOpposite();
+	EdgeIterator e4=e1->getOpposite();
 	if(e4!=0)
 		{
-		Edge* e5=e4->getFaceSucc();
-		Edge* e6=e4->getFacePred();
-		Vertex* v4=e6->getStart();
-		Face* f2=e4->getFace();
+		EdgeIterator e5=e4->getFaceSucc();
+		EdgeIterator e6=e4->getFacePred();
+		VertexIterator v4=e6->getStart();
+		FaceIterator f2=e4->getFace();
 		
 		assert(e5->getFaceSucc()==e6&&e6->getFacePred()==e5);
 		assert(e4->getStart()==v2);
@@ -152,11 +152,11 @@ void AutoTriangleMesh::splitEdge(const AutoTriangleMesh::EdgeIterator& edge)
 		Color c;
 		for(int i=0;i<4;++i)
 			c[i]=GLubyte(Math::floor((GLfloat(edge->getStart()->color[i])+GLfloat(edge->getEnd()->color[i]))*0.5f+0.5f));
-		Vertex* nv=newVertex(p,c);
+		VertexIterator nv=newVertex(p,c);
 		
 		/* Create two quadrilaterals: */
-		Edge* ne1=BaseMesh::newEdge();
-		Edge* ne2=BaseMesh::newEdge();
+		EdgeIterator ne1=BaseMesh::newEdge();
+		EdgeIterator ne2=BaseMesh::newEdge();
 		nv->setEdge(ne1);
 		e1->setFaceSucc(ne1);
 		e1->setOpposite(ne2);
@@ -172,9 +172,9 @@ void AutoTriangleMesh::splitEdge(const AutoTriangleMesh::EdgeIterator& edge)
 		f2->setEdge(e4);
 		
 		/* Triangulate first quadrilateral: */
-		Edge* ne3=BaseMesh::newEdge();
-		Edge* ne4=BaseMesh::newEdge();
-		Face* nf1=BaseMesh::newFace();
+		EdgeIterator ne3=BaseMesh::newEdge();
+		EdgeIterator ne4=BaseMesh::newEdge();
+		FaceIterator nf1=BaseMesh::newFace();
 		e1->setFaceSucc(ne3);
 		e3->setFacePred(ne3);
 		e2->setFace(nf1);
@@ -188,9 +188,9 @@ void AutoTriangleMesh::splitEdge(const AutoTriangleMesh::EdgeIterator& edge)
 		nf1->setEdge(ne1);
 		
 		/* Triangulate second quadrilateral: */
-		Edge* ne5=BaseMesh::newEdge();
-		Edge* ne6=BaseMesh::newEdge();
-		Face* nf2=BaseMesh::newFace();
+		EdgeIterator ne5=BaseMesh::newEdge();
+		EdgeIterator ne6=BaseMesh::newEdge();
+		FaceIterator nf2=BaseMesh::newFace();
 		e4->setFaceSucc(ne5);
 		e6->setFacePred(ne5);
 		e5->setFace(nf2);
@@ -216,10 +216,10 @@ void AutoTriangleMesh::splitEdge(const AutoTriangleMesh::EdgeIterator& edge)
 		Color c;
 		for(int i=0;i<4;++i)
 			c[i]=GLubyte(Math::floor((GLfloat(edge->getStart()->color[i])+GLfloat(edge->getEnd()->color[i]))*0.5f+0.5f));
-		Vertex* nv=newVertex(p,c);
+		VertexIterator nv=newVertex(p,c);
 		
 		/* Create one quadrilateral: */
-		Edge* ne=BaseMesh::newEdge();
+		EdgeIterator ne=BaseMesh::newEdge();
 		nv->setEdge(ne);
 		e1->setFaceSucc(ne);
 		e2->setFacePred(ne);
@@ -228,9 +228,9 @@ void AutoTriangleMesh::splitEdge(const AutoTriangleMesh::EdgeIterator& edge)
 		f1->setEdge(e1);
 		
 		/* Triangulate quadrilateral: */
-		Edge* ne3=BaseMesh::newEdge();
-		Edge* ne4=BaseMesh::newEdge();
-		Face* nf1=BaseMesh::newFace();
+		EdgeIterator ne3=BaseMesh::newEdge();
+		EdgeIterator ne4=BaseMesh::newEdge();
+		FaceIterator nf1=BaseMesh::newFace();
 		e1->setFaceSucc(ne3);
 		e3->setFacePred(ne3);
 		e2->setFace(nf1);
@@ -250,18 +250,18 @@ void AutoTriangleMesh::splitEdge(const AutoTriangleMesh::EdgeIterator& edge)
 		}
 	}
 
-bool AutoTriangleMesh::canCollapseEdge(const AutoTriangleMesh::Edge* edge) const
+bool AutoTriangleMesh::canCollapseEdge(const AutoTriangleMesh::ConstEdgeIterator& edge) const
 	{
 	/* Get triangle topology: */
-	const Edge* e1=edge;
-	const Edge* e2=e1->getFaceSucc();
-	const Edge* e3=e1->getFacePred();
-	const Edge* e4=e1->getOpposite();
+	ConstEdgeIterator e1=edge;
+	ConstEdgeIterator e2=e1->getFaceSucc();
+	ConstEdgeIterator e3=e1->getFacePred();
+	ConstEdgeIterator e4=e1->getOpposite();
 	if(e4!=0) // Edge is interior edge
 		{
 		/* Check if both side edges of top triangle are on the boundary: */
-		const Edge* e7=e2->getOpposite();
-		const Edge* e8=e3->getOpposite();
+		ConstEdgeIterator e7=e2->getOpposite();
+		ConstEdgeIterator e8=e3->getOpposite();
 		if(e7==0&&e8==0)
 			return false;
 		
@@ -270,12 +270,12 @@ bool AutoTriangleMesh::canCollapseEdge(const AutoTriangleMesh::Edge* edge) const
 			return false;
 		
 		/* Get topology of bottom triangle: */
-		const Edge* e5=e4->getFaceSucc();
-		const Edge* e6=e4->getFacePred();
+		ConstEdgeIterator e5=e4->getFaceSucc();
+		ConstEdgeIterator e6=e4->getFacePred();
 		
 		/* Check if both side edges of bottom triangle are on the boundary: */
-		const Edge* e9=e5->getOpposite();
-		const Edge* e10=e6->getOpposite();
+		ConstEdgeIterator e9=e5->getOpposite();
+		ConstEdgeIterator e10=e6->getOpposite();
 		if(e9==0&&e10==0)
 			return false;
 		
@@ -284,11 +284,11 @@ bool AutoTriangleMesh::canCollapseEdge(const AutoTriangleMesh::Edge* edge) const
 			return false;
 		
 		/* Check if both edge's vertices are on the boundary: */
-		const Edge* ve1;
+		ConstEdgeIterator ve1;
 		for(ve1=e8;ve1!=0&&ve1!=e5;ve1=ve1->getVertexSucc())
 			;
 		bool v1OnBoundary=ve1==0;
-		const Edge* ve2;
+		ConstEdgeIterator ve2;
 		for(ve2=e10;ve2!=0&&ve2!=e2;ve2=ve2->getVertexSucc())
 			;
 		bool v2OnBoundary=ve2==0;
@@ -348,8 +348,8 @@ bool AutoTriangleMesh::canCollapseEdge(const AutoTriangleMesh::Edge* edge) const
 	else // Edge is boundary edge
 		{
 		/* Check if both side edges are on the boundary: */
-		const Edge* e7=e2->getOpposite();
-		const Edge* e8=e3->getOpposite();
+		ConstEdgeIterator e7=e2->getOpposite();
+		ConstEdgeIterator e8=e3->getOpposite();
 		if(e7==0&&e8==0)
 			return false;
 		
@@ -361,8 +361,8 @@ bool AutoTriangleMesh::canCollapseEdge(const AutoTriangleMesh::Edge* edge) const
 		
 			/* Check if the two vertices' platelets share a vertex: */
 			/* Currently highly inefficient at O(n^2); need to optimize! */
-			for(const Edge* ve1=e8->getFacePred();ve1!=0;ve1=ve1->getEndVertexSucc())
-				for(const Edge* ve2=e7->getFaceSucc();ve2!=0;ve2=ve2->getVertexPred())
+			for(ConstEdgeIterator ve1=e8->getFacePred();ve1!=0;ve1=ve1->getEndVertexSucc())
+				for(ConstEdgeIterator ve2=e7->getFaceSucc();ve2!=0;ve2=ve2->getVertexPred())
 					if(ve1->getStart()==ve2->getEnd())
 						return false;
 			}
@@ -374,15 +374,15 @@ bool AutoTriangleMesh::canCollapseEdge(const AutoTriangleMesh::Edge* edge) const
 bool AutoTriangleMesh::collapseEdge(const AutoTriangleMesh::EdgeIterator& edge)
 	{
 	/* Get triangle topology: */
-	Edge* e1=&(*edge);
-	Edge* e2=e1->getFaceSucc();
-	Edge* e3=e1->getFacePred();
-	Edge* e4=e1->getOpposite();
+	EdgeIterator e1=edge;
+	EdgeIterator e2=e1->getFaceSucc();
+	EdgeIterator e3=e1->getFacePred();
+	EdgeIterator e4=e1->getOpposite();
 	if(e4!=0) // Edge is interior edge
 		{
 		/* Check if both side edges of top triangle are on the boundary: */
-		Edge* e7=e2->getOpposite();
-		Edge* e8=e3->getOpposite();
+		EdgeIterator e7=e2->getOpposite();
+		EdgeIterator e8=e3->getOpposite();
 		if(e7==0&&e8==0)
 			return false;
 		
@@ -391,12 +391,12 @@ bool AutoTriangleMesh::collapseEdge(const AutoTriangleMesh::EdgeIterator& edge)
 			return false;
 		
 		/* Get topology of bottom triangle: */
-		Edge* e5=e4->getFaceSucc();
-		Edge* e6=e4->getFacePred();
+		EdgeIterator e5=e4->getFaceSucc();
+		EdgeIterator e6=e4->getFacePred();
 		
 		/* Check if both side edges of bottom triangle are on the boundary: */
-		Edge* e9=e5->getOpposite();
-		Edge* e10=e6->getOpposite();
+		EdgeIterator e9=e5->getOpposite();
+		EdgeIterator e10=e6->getOpposite();
 		if(e9==0&&e10==0)
 			return false;
 		
@@ -405,11 +405,11 @@ bool AutoTriangleMesh::collapseEdge(const AutoTriangleMesh::EdgeIterator& edge)
 			return false;
 		
 		/* Check if both edge's vertices are on the boundary: */
-		Edge* ve1;
+		EdgeIterator ve1;
 		for(ve1=e8;ve1!=0&&ve1!=e5;ve1=ve1->getVertexSucc())
 			;
 		bool v1OnBoundary=ve1==0;
-		Edge* ve2;
+		EdgeIterator ve2;
 		for(ve2=e10;ve2!=0&&ve2!=e2;ve2=ve2->getVertexSucc())
 			;
 		bool v2OnBoundary=ve2==0;
@@ -466,12 +466,12 @@ bool AutoTriangleMesh::collapseEdge(const AutoTriangleMesh::EdgeIterator& edge)
 						return false;
 			}
 		
-		Vertex* v1=e1->getStart();
-		Vertex* v2=e2->getStart();
-		Vertex* v3=e3->getStart();
-		Vertex* v4=e6->getStart();
-		Face* f1=e1->getFace();
-		Face* f2=e4->getFace();
+		VertexIterator v1=e1->getStart();
+		VertexIterator v2=e2->getStart();
+		VertexIterator v3=e3->getStart();
+		VertexIterator v4=e6->getStart();
+		FaceIterator f1=e1->getFace();
+		FaceIterator f2=e4->getFace();
 		
 		/* Move v1 to edge midpoint: */
 		Point p=Geometry::mid(*v1,*v2);
@@ -520,14 +520,14 @@ bool AutoTriangleMesh::collapseEdge(const AutoTriangleMesh::EdgeIterator& edge)
 		/* Remove v2 from mesh: */
 		if(v2OnBoundary)
 			{
-			for(Edge* ve2=e10;ve2!=0;ve2=ve2->getVertexSucc())
+			for(EdgeIterator ve2=e10;ve2!=0;ve2=ve2->getVertexSucc())
 				ve2->setStart(v1);
-			for(Edge* ve2=e2->getVertexPred();ve2!=0;ve2=ve2->getVertexPred())
+			for(EdgeIterator ve2=e2->getVertexPred();ve2!=0;ve2=ve2->getVertexPred())
 				ve2->setStart(v1);
 			}
 		else
 			{
-			for(Edge* ve2=e10;ve2!=e8;ve2=ve2->getVertexSucc())
+			for(EdgeIterator ve2=e10;ve2!=e8;ve2=ve2->getVertexSucc())
 				ve2->setStart(v1);
 			}
 		
@@ -562,8 +562,8 @@ bool AutoTriangleMesh::collapseEdge(const AutoTriangleMesh::EdgeIterator& edge)
 	else // Edge is boundary edge
 		{
 		/* Check if both side edges are on the boundary: */
-		Edge* e7=e2->getOpposite();
-		Edge* e8=e3->getOpposite();
+		EdgeIterator e7=e2->getOpposite();
+		EdgeIterator e8=e3->getOpposite();
 		if(e7==0&&e8==0)
 			return false;
 		
@@ -575,16 +575,16 @@ bool AutoTriangleMesh::collapseEdge(const AutoTriangleMesh::EdgeIterator& edge)
 		
 			/* Check if the two vertices' platelets share a vertex: */
 			/* Currently highly inefficient at O(n^2); need to optimize! */
-			for(const Edge* ve1=e8->getFacePred();ve1!=0;ve1=ve1->getEndVertexSucc())
-				for(const Edge* ve2=e7->getFaceSucc();ve2!=0;ve2=ve2->getVertexPred())
+			for(ConstEdgeIterator ve1=e8->getFacePred();ve1!=0;ve1=ve1->getEndVertexSucc())
+				for(ConstEdgeIterator ve2=e7->getFaceSucc();ve2!=0;ve2=ve2->getVertexPred())
 					if(ve1->getStart()==ve2->getEnd())
 						return false;
 			}
 		
-		Vertex* v1=e1->getStart();
-		Vertex* v2=e2->getStart();
-		Vertex* v3=e3->getStart();
-		Face* f1=e1->getFace();
+		VertexIterator v1=e1->getStart();
+		VertexIterator v2=e2->getStart();
+		VertexIterator v3=e3->getStart();
+		FaceIterator f1=e1->getFace();
 		
 		/* Move v1 to edge midpoint: */
 		Point p=Geometry::mid(*v1,*v2);
@@ -617,7 +617,7 @@ bool AutoTriangleMesh::collapseEdge(const AutoTriangleMesh::EdgeIterator& edge)
 		
 		/* Remove v2 from mesh: */
 		if(e7!=0)
-			for(Edge* ve2=e7->getFaceSucc();ve2!=0;ve2=ve2->getVertexPred())
+			for(EdgeIterator ve2=e7->getFaceSucc();ve2!=0;ve2=ve2->getVertexPred())
 				ve2->setStart(v1);
 		
 		/* Delete removed objects: */
@@ -632,9 +632,9 @@ bool AutoTriangleMesh::collapseEdge(const AutoTriangleMesh::EdgeIterator& edge)
 		
 		/* Invalidate all involved vertices: */
 		v1->version=version;
-		for(Edge* ve1=v1->getEdge();ve1!=0;ve1=ve1->getVertexSucc())
+		for(EdgeIterator ve1=v1->getEdge();ve1!=0;ve1=ve1->getVertexSucc())
 			ve1->getEnd()->version=version;
-		for(Edge* ve1=v1->getEdge()->getVertexPred();ve1!=0;ve1=ve1->getVertexPred())
+		for(EdgeIterator ve1=v1->getEdge()->getVertexPred();ve1!=0;ve1=ve1->getVertexPred())
 			ve1->getEnd()->version=version;
 		}
 			
@@ -645,43 +645,50 @@ void AutoTriangleMesh::limitEdgeLength(const AutoTriangleMesh::Point& center,Aut
 	{
 	Scalar radius2=Math::sqr(radius);
 	
-	/* Iterate through all triangles: */
-	FaceIterator faceIt=BaseMesh::beginFaces();
-	while(faceIt!=BaseMesh::endFaces())
+	/* Iterate through all triangles until no more edges are split, since split triangles can re-use the slots of deleted faces: */
+	bool splitAny;
+	do
 		{
-		/* Check whether face overlaps area of influence and calculate face's maximum edge length: */
-		bool overlaps=false;
-		Edge* longestEdge=0;
-		Scalar longestEdgeLength2=maxEdgeLength*maxEdgeLength;
-		Edge* e=faceIt->getEdge();
-		for(int i=0;i<3;++i)
+		splitAny=false;
+		FaceIterator faceIt=BaseMesh::beginFaces();
+		while(faceIt!=BaseMesh::endFaces())
 			{
-			overlaps=overlaps||Geometry::sqrDist(*e->getStart(),center)<=radius2;
-			
-			/* Calculate edge's squared length: */
-			Scalar edgeLength2=Geometry::sqrDist(*e->getStart(),*e->getEnd());
-			if(longestEdgeLength2<edgeLength2)
+			/* Check whether face overlaps area of influence and calculate face's maximum edge length: */
+			bool overlaps=false;
+			EdgeIterator longestEdge=0;
+			Scalar longestEdgeLength2=maxEdgeLength*maxEdgeLength;
+			EdgeIterator e=faceIt->getEdge();
+			for(int i=0;i<3;++i)
 				{
-				longestEdge=e;
-				longestEdgeLength2=edgeLength2;
+				overlaps=overlaps||Geometry::sqrDist(*e->getStart(),center)<=radius2;
+				
+				/* Calculate edge's squared length: */
+				Scalar edgeLength2=Geometry::sqrDist(*e->getStart(),*e->getEnd());
+				if(longestEdgeLength2<edgeLength2)
+					{
+					longestEdge=e;
+					longestEdgeLength2=edgeLength2;
+					}
+				
+				/* Go to next edge: */
+				e=e->getFaceSucc();
 				}
 			
-			/* Go to next edge: */
-			e=e->getFaceSucc();
-			}
-		
-		/* Check whether the longest triangle edge is too long: */
-		if(overlaps&&longestEdge!=0)
-			{
-			/* Split longest edge: */
-			splitEdge(longestEdge);
-			}
-		else
-			{
-			/* Go to next triangle: */
-			++faceIt;
+			/* Check whether the longest triangle edge is too long: */
+			if(overlaps&&longestEdge!=0)
+				{
+				/* Split longest edge: */
+				splitEdge(longestEdge);
+				splitAny=true;
+				}
+			else
+				{
+				/* Go to next triangle: */
+				++faceIt;
+				}
 			}
 		}
+	while(splitAny);
 	}
 
 void AutoTriangleMesh::ensureEdgeLength(const AutoTriangleMesh::Point& center,AutoTriangleMesh::Scalar radius,AutoTriangleMesh::Scalar minEdgeLength)
@@ -694,7 +701,7 @@ void AutoTriangleMesh::ensureEdgeLength(const AutoTriangleMesh::Point& center,Au
 		{
 		/* Check quickly (ha!) if face overlaps area of influence: */
 		bool overlaps=false;
-		Edge* e=faceIt->getEdge();
+		EdgeIterator e=faceIt->getEdge();
 		do
 			{
 			if(Geometry::sqrDist(*e->getStart(),center)<=radius2)
@@ -711,9 +718,9 @@ void AutoTriangleMesh::ensureEdgeLength(const AutoTriangleMesh::Point& center,Au
 		if(overlaps)
 			{
 			/* Calculate face's minimum edge length: */
-			Edge* shortestEdge=0;
+			EdgeIterator shortestEdge=0;
 			Scalar shortestEdgeLength2=Math::sqr(minEdgeLength);
-			Edge* e=faceIt->getEdge();
+			EdgeIterator e=faceIt->getEdge();
 			do
 				{
 				/* Calculate edge's squared length: */
@@ -1,7 +1,7 @@
 /***********************************************************************
 AutoTriangleMesh - Class for triangular meshes that enforce triangle
 shape constraints under mesh transformations.
-Copyright (c) 2003-2005 Oliver Kreylos
+Copyright (c) 2003-2011 Oliver Kreylos
 ***********************************************************************/
 
 #ifndef AUTOTRIANGLEMESH_INCLUDED
@@ -19,7 +19,6 @@ class AutoTriangleMesh:public PolygonMesh
 	protected:
 	void triangulateAllFaces(void); // Converts polygon mesh to triangle mesh
 	void createVertexIndices(void); // Assigns indices and version numbers to all vertices
-	bool canCollapseEdge(const Edge* edge) const; // Tests if an edge can be collapsed
 	
 	/* Constructors and destructors: */
 	public:
@@ -39,13 +38,10 @@ class AutoTriangleMesh:public PolygonMesh
 	FaceIterator addFace(int numVertices,const VertexIterator vertices[],EdgeHasher* edgeHasher);
 	FaceIterator addFace(const std::vector<VertexIterator>& vertices,EdgeHasher* edgeHasher);
 	void splitEdge(const EdgeIterator& edge); // Splits an edge at its midpoint
-	bool canCollapseEdge(const ConstEdgeIterator& edge) const // Tests if an edge can be collapsed
-		{
-		return canCollapseEdge(&(*edge));
-		};
+	bool canCollapseEdge(const ConstEdgeIterator& edge) const; // Tests if an edge can be collapsed
 	bool canCollapseEdge(const EdgeIterator& edge) const // Ditto
 		{
-		return canCollapseEdge(&(*edge));
+		return canCollapseEdge(ConstEdgeIterator(edge));
 		};
 	bool collapseEdge(const EdgeIterator& edge); // Collapses an edge to its midpoint; returns false if edge is not collapsible
 	void limitEdgeLength(const Point& center,Scalar radius,Scalar maxEdgeLength);
@@ -0,0 +1,536 @@
+/***********************************************************************
+BallPivoter - Class to reconstruct triangle meshes from large point sets
+using the ball pivoting algorithm, with a uniform grid spatial hash for
+neighborhood queries, parallel front propagation inside spatial
+regions, and an ordered sequence of ball radii.
+Copyright (c) 2011 Oliver Kreylos
+***********************************************************************/
+
+#include "BallPivoter.h"
+
+#include <utility>
+#include <algorithm>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Threads/ParallelFor.h>
+
+#include "PointGrid.h"
+
+namespace {
+
+/***************************************************
+Helper classes for queries against the spatial hash:
+***************************************************/
+
+const unsigned int maxSeedNeighbors=16; // Maximum number of closest free neighbors tried when looking for seed triangles
+
+class BallEmptinessTester // Functor class to check whether a ball contains points other than a triangle's vertices
+	{
+	/* Elements: */
+	public:
+	BallPivoter::Index vertices[3]; // Indices of the triangle's vertices
+	bool empty; // Flag whether no other points were found so far
+	
+	/* Methods: */
+	void operator()(BallPivoter::Index index)
+		{
+		if(index!=vertices[0]&&index!=vertices[1]&&index!=vertices[2])
+			empty=false;
+		}
+	};
+
+class SeedNeighborCollector // Functor class to collect free points around a seed vertex
+	{
+	/* Embedded classes: */
+	public:
+	typedef std::pair<BallPivoter::Scalar,BallPivoter::Index> Neighbor; // Pair of squared distance and point index
+	
+	/* Elements: */
+	const BallPivoter::Point* points; // Array of all points
+	const BallPivoter::Index* numBoundaryHalfEdges; // Array of point states
+	const Misc::UInt16* pointRegions; // Array of point regions
+	BallPivoter::Index seed; // Index of the seed vertex
+	unsigned int regionIndex; // Index of the region from which to collect points, or the number of regions to collect from all regions
+	unsigned int numRegions; // Total number of regions
+	std::vector<Neighbor> neighbors; // List of collected neighbors
+	
+	/* Methods: */
+	void operator()(BallPivoter::Index index)
+		{
+		if(index!=seed&&(regionIndex==numRegions||pointRegions[index]==regionIndex)&&numBoundaryHalfEdges[index]==BallPivoter::invalidIndex)
+			neighbors.push_back(Neighbor(Geometry::sqrDist(points[seed],points[index]),index));
+		}
+	};
+
+class PivotFinder // Functor class to find the first point hit by a ball pivoting around a front half-edge
+	{
+	/* Embedded classes: */
+	public:
+	typedef BallPivoter::Scalar Scalar;
+	typedef BallPivoter::Point Point;
+	typedef BallPivoter::Vector Vector;
+	typedef BallPivoter::Index Index;
+	
+	/* Elements: */
+	private:
+	const Point* points; // Array of all points
+	Scalar ballRadius2; // Squared radius of the pivoting ball
+	Index start,end,apex; // Indices of the pivot half-edge's vertices and the apex of its triangle
+	Vector lastFaceNormal; // Normal vector of the pivot half-edge's triangle
+	Point pivot; // Midpoint of the pivot half-edge
+	Scalar maxPivotDistance; // Maximum distance from the pivot of any point that can be hit by the ball
+	Vector pivotX,pivotY; // Frame of the ball's rotation around the pivot half-edge
+	Scalar maxCosPivotAngle; // Pseudo-cosine of the smallest pivoting angle found so far
+	Index nextVertex; // Index of the first point hit by the ball so far
+	Point nextBallCenter; // Ball center when touching the first point hit so far
+	
+	/* Constructors and destructors: */
+	public:
+	PivotFinder(const Point* sPoints,Scalar sBallRadius,Index sStart,Index sEnd,Index sApex,const Point& ballCenter)
+		:points(sPoints),ballRadius2(Math::sqr(sBallRadius)),
+		 start(sStart),end(sEnd),apex(sApex),
+		 maxCosPivotAngle(-3.0),nextVertex(BallPivoter::invalidIndex)
+		{
+		const Point& ps=points[start];
+		const Point& pe=points[end];
+		lastFaceNormal=Geometry::cross(pe-ps,points[apex]-ps);
+		pivot=Geometry::mid(ps,pe);
+		Scalar pivotRadius2=ballRadius2-Geometry::sqrDist(ps,pe)*Scalar(0.25);
+		maxPivotDistance=Math::sqrt(pivotRadius2>Scalar(0)?pivotRadius2:Scalar(0))+sBallRadius;
+		pivotX=ballCenter-pivot;
+		pivotX.normalize();
+		pivotY=Geometry::cross(pe-ps,pivotX);
+		pivotY.normalize();
+		}
+	
+	/* Methods: */
+	const Point& getPivot(void) const
+		{
+		return pivot;
+		}
+	Scalar getMaxPivotDistance(void) const
+		{
+		return maxPivotDistance;
+		}
+	void operator()(Index index)
+		{
+		if(index==start||index==end||index==apex)
+			return;
+		
+		/* Reject triangles that would fold over the pivot half-edge's triangle: */
+		const Point& p0=points[end];
+		Vector d1=points[start]-p0;
+		Vector d2=points[index]-p0;
+		Vector faceNormal=Geometry::cross(d1,d2);
+		if(faceNormal*lastFaceNormal<Scalar(0))
+			return;
+		
+		/* Calculate the center of the ball resting on the potential triangle: */
+		Scalar faceNormal2=Geometry::sqr(faceNormal);
+		if(faceNormal2==Scalar(0))
+			return;
+		Vector circumcenter=(Geometry::cross(faceNormal,d1)*Geometry::sqr(d2)+Geometry::cross(d2,faceNormal)*Geometry::sqr(d1))/(Scalar(2)*faceNormal2);
+		Scalar height2=ballRadius2-Geometry::sqr(circumcenter);
+		if(height2<Scalar(0))
+			return;
+		Point ballCenter=p0+circumcenter+faceNormal*Math::sqrt(height2/faceNormal2);
+		
+		/* Calculate the pivoting angle: */
+		Vector v=ballCenter-pivot;
+		Scalar vLen=v.mag();
+		if(vLen==Scalar(0))
+			return;
+		Scalar cosPivotAngle=(v*pivotX)/vLen;
+		if(v*pivotY<Scalar(0))
+			cosPivotAngle=Scalar(-2)-cosPivotAngle;
+		if(maxCosPivotAngle<cosPivotAngle)
+			{
+			maxCosPivotAngle=cosPivotAngle;
+			nextVertex=index;
+			nextBallCenter=ballCenter;
+			}
+		}
+	Index getNextVertex(void) const
+		{
+		return nextVertex;
+		}
+	const Point& getNextBallCenter(void) const
+		{
+		return nextBallCenter;
+		}
+	};
+
+}
+
+/*******************************************
+Helper class for parallel front propagation:
+*******************************************/
+
+class BallPivoter::RegionPivoter
+	{
+	/* Elements: */
+	public:
+	BallPivoter* pivoter; // The ball pivoter
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
+		{
+		for(size_t region=begin;region<end;++region)
+			pivoter->triangulateRegion((unsigned int)region);
+		}
+	};
+
+/****************************
+Methods of class BallPivoter:
+****************************/
+
+const BallPivoter::Index BallPivoter::invalidIndex;
+
+bool BallPivoter::calcBallCenter(BallPivoter::Index v0,BallPivoter::Index v1,BallPivoter::Index v2,BallPivoter::Point& ballCenter) const
+	{
+	/* Calculate the triangle's circumcenter: */
+	const Point& p0=points[v0];
+	Vector d1=points[v1]-p0;
+	Vector d2=points[v2]-p0;
+	Vector faceNormal=Geometry::cross(d1,d2);
+	Scalar faceNormal2=Geometry::sqr(faceNormal);
+	if(faceNormal2==Scalar(0))
+		return false;
+	Vector circumcenter=(Geometry::cross(faceNormal,d1)*Geometry::sqr(d2)+Geometry::cross(d2,faceNormal)*Geometry::sqr(d1))/(Scalar(2)*faceNormal2);
+	
+	/* Lift the circumcenter onto the ball's center: */
+	Scalar height2=Math::sqr(ballRadius)-Geometry::sqr(circumcenter);
+	if(height2<Scalar(0))
+		return false;
+	ballCenter=p0+circumcenter+faceNormal*Math::sqrt(height2/faceNormal2);
+	return true;
+	}
+
+bool BallPivoter::isBallEmpty(const BallPivoter::Point& ballCenter,BallPivoter::Index v0,BallPivoter::Index v1,BallPivoter::Index v2) const
+	{
+	/* Search for points inside a slightly shrunken ball to be robust against points on the ball's surface: */
+	BallEmptinessTester tester;
+	tester.vertices[0]=v0;
+	tester.vertices[1]=v1;
+	tester.vertices[2]=v2;
+	tester.empty=true;
+	grid->processSphere(ballCenter,ballRadius*Scalar(0.999999),tester);
+	return tester.empty;
+	}
+
+void BallPivoter::addTriangle(BallPivoter::Index v0,BallPivoter::Index v1,BallPivoter::Index v2,const BallPivoter::Point& ballCenter,BallPivoter::Region& region)
+	{
+	Triangle triangle;
+	triangle.vertices[0]=v0;
+	triangle.vertices[1]=v1;
+	triangle.vertices[2]=v2;
+	for(int i=0;i<3;++i)
+		{
+		Index start=triangle.vertices[i];
+		Index end=triangle.vertices[(i+1)%3];
+		
+		/* Mark the half-edge's vertices as used: */
+		if(numBoundaryHalfEdges[start]==invalidIndex)
+			numBoundaryHalfEdges[start]=0;
+		if(numBoundaryHalfEdges[end]==invalidIndex)
+			numBoundaryHalfEdges[end]=0;
+		
+		/* Store the half-edge: */
+		HalfEdgeKey key(start,end);
+		HalfEdgeMap& halfEdges=getHalfEdgeMap(start,end);
+		halfEdges.setEntry(HalfEdgeMap::Entry(key,HalfEdge(triangle.vertices[(i+2)%3],ballCenter)));
+		
+		if(halfEdges.isEntry(key.getOpposite()))
+			{
+			/* Close the opposite boundary half-edge: */
+			--numBoundaryHalfEdges[start];
+			--numBoundaryHalfEdges[end];
+			}
+		else
+			{
+			/* Queue the new half-edge as part of the front: */
+			++numBoundaryHalfEdges[start];
+			++numBoundaryHalfEdges[end];
+			region.front.push_back(key);
+			}
+		}
+	region.triangles.push_back(triangle);
+	}
+
+bool BallPivoter::findSeed(BallPivoter::Index v0,unsigned int regionIndex,BallPivoter::Region& region)
+	{
+	/* Collect all free points that could form a triangle with the seed vertex: */
+	SeedNeighborCollector collector;
+	collector.points=&points[0];
+	collector.numBoundaryHalfEdges=&numBoundaryHalfEdges[0];
+	collector.pointRegions=&pointRegions[0];
+	collector.seed=v0;
+	collector.regionIndex=regionIndex;
+	collector.numRegions=numRegions;
+	grid->processSphere(points[v0],ballRadius*Scalar(2),collector);
+	
+	/* Only try the closest neighbors: */
+	std::vector<SeedNeighborCollector::Neighbor>& neighbors=collector.neighbors;
+	std::sort(neighbors.begin(),neighbors.end());
+	if(neighbors.size()>maxSeedNeighbors)
+		neighbors.resize(maxSeedNeighbors);
+	
+	/* Find the first pair of neighbors forming a triangle with an empty ball: */
+	for(size_t i=0;i<neighbors.size();++i)
+		for(size_t j=i+1;j<neighbors.size();++j)
+			{
+			Index v1=neighbors[i].second;
+			Index v2=neighbors[j].second;
+			
+			/* Orient the triangle along the point normals, or away from the centroid: */
+			Vector faceNormal=Geometry::cross(points[v1]-points[v0],points[v2]-points[v0]);
+			Vector outside=normals.empty()?points[v0]-centroid:normals[v0]+normals[v1]+normals[v2];
+			if(faceNormal*outside<Scalar(0))
+				std::swap(v1,v2);
+			
+			/* Create the seed triangle if the ball resting on it is empty: */
+			Point ballCenter;
+			if(calcBallCenter(v0,v1,v2,ballCenter)&&isBallEmpty(ballCenter,v0,v1,v2))
+				{
+				addTriangle(v0,v1,v2,ballCenter,region);
+				++region.numSeeds;
+				return true;
+				}
+			}
+	
+	return false;
+	}
+
+void BallPivoter::propagateFront(unsigned int regionIndex,BallPivoter::Region& region)
+	{
+	while(!region.front.empty())
+		{
+		/* Get the next front half-edge: */
+		HalfEdgeKey key=region.front.front();
+		region.front.pop_front();
+		HalfEdgeMap& halfEdges=getHalfEdgeMap(key.start,key.end);
+		
+		/* Skip the half-edge if it was closed in the meantime: */
+		if(halfEdges.isEntry(key.getOpposite()))
+			continue;
+		HalfEdge& halfEdge=halfEdges.getEntry(key).getDest();
+		
+		/* Find the first point hit by the ball pivoting around the half-edge: */
+		PivotFinder finder(&points[0],ballRadius,key.start,key.end,halfEdge.apex,halfEdge.ballCenter);
+		grid->processSphere(finder.getPivot(),finder.getMaxPivotDistance(),finder);
+		Index v=finder.getNextVertex();
+		if(v==invalidIndex)
+			{
+			halfEdge.state=BOUNDARY;
+			continue;
+			}
+		
+		/* Leave the half-edge to the seam pass if the point belongs to another region: */
+		if(regionIndex<numRegions&&pointRegions[v]!=regionIndex)
+			{
+			halfEdge.state=DEFERRED;
+			region.deferred.push_back(key);
+			continue;
+			}
+		
+		/* Check if the new triangle keeps the mesh manifold: */
+		if(numBoundaryHalfEdges[v]==0||isHalfEdge(key.start,v)||isHalfEdge(v,key.end))
+			{
+			halfEdge.state=BOUNDARY;
+			continue;
+			}
+		
+		/* Create the new triangle: */
+		addTriangle(key.end,key.start,v,finder.getNextBallCenter(),region);
+		}
+	}
+
+void BallPivoter::triangulateRegion(unsigned int regionIndex)
+	{
+	Region& region=regions[regionIndex];
+	
+	/* Continue pivoting around the region's queued front half-edges: */
+	propagateFront(regionIndex,region);
+	
+	/* Seed and propagate new fronts from the region's remaining free points: */
+	if(regionIndex<numRegions)
+		{
+		for(Index i=regionPointStarts[regionIndex];i<regionPointStarts[regionIndex+1];++i)
+			if(numBoundaryHalfEdges[regionPoints[i]]==invalidIndex&&findSeed(regionPoints[i],regionIndex,region))
+				propagateFront(regionIndex,region);
+		}
+	else
+		{
+		for(Index v=0;v<Index(points.size());++v)
+			if(numBoundaryHalfEdges[v]==invalidIndex&&findSeed(v,regionIndex,region))
+				propagateFront(regionIndex,region);
+		}
+	}
+
+void BallPivoter::reactivateBoundaries(void)
+	{
+	for(unsigned int regionIndex=0;regionIndex<=numRegions;++regionIndex)
+		{
+		Region& region=regions[regionIndex];
+		for(HalfEdgeMap::Iterator heIt=region.halfEdges.begin();!heIt.isFinished();++heIt)
+			{
+			HalfEdge& halfEdge=heIt->getDest();
+			const HalfEdgeKey& key=heIt->getSource();
+			if(halfEdge.state==BOUNDARY&&!region.halfEdges.isEntry(key.getOpposite()))
+				{
+				/* Re-queue the half-edge if the new ball rests empty on its triangle: */
+				Point ballCenter;
+				if(calcBallCenter(key.start,key.end,halfEdge.apex,ballCenter)&&isBallEmpty(ballCenter,key.start,key.end,halfEdge.apex))
+					{
+					halfEdge.ballCenter=ballCenter;
+					halfEdge.state=FRONT;
+					region.front.push_back(key);
+					}
+				}
+			}
+		}
+	}
+
+BallPivoter::BallPivoter(const std::vector<BallPivoter::Point>& sPoints,const std::vector<BallPivoter::Vector>& sNormals,unsigned int sNumRegions)
+	:points(sPoints),normals(sNormals),
+	 centroid(Point::origin),
+	 numRegions(sNumRegions),
+	 pointRegions(points.size(),0),
+	 numBoundaryHalfEdges(points.size(),invalidIndex),
+	 regions(0),
+	 grid(0),ballRadius(0)
+	{
+	/* Ignore normals if there are not exactly one per point: */
+	if(normals.size()!=points.size())
+		normals.clear();
+	
+	/* Determine the number of regions: */
+	if(numRegions==0)
+		numRegions=Threads::getNumParallelForThreads();
+	if(numRegions>points.size()/maxSeedNeighbors)
+		numRegions=(unsigned int)(points.size()/maxSeedNeighbors);
+	if(numRegions>65535U)
+		numRegions=65535U;
+	if(numRegions<1U)
+		numRegions=1U;
+	
+	/* Calculate the points' centroid and bounding box: */
+	Point min=Point::origin;
+	Point max=Point::origin;
+	if(!points.empty())
+		min=max=points[0];
+	Vector sum=Vector::zero;
+	for(std::vector<Point>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
+		{
+		sum+=*pIt-Point::origin;
+		for(int i=0;i<3;++i)
+			{
+			if(min[i]>(*pIt)[i])
+				min[i]=(*pIt)[i];
+			if(max[i]<(*pIt)[i])
+				max[i]=(*pIt)[i];
+			}
+		}
+	if(!points.empty())
+		centroid=Point::origin+sum/Scalar(points.size());
+	
+	/* Split the points into slabs of equal point counts along the bounding box's longest axis: */
+	int splitAxis=0;
+	for(int i=1;i<3;++i)
+		if(max[i]-min[i]>max[splitAxis]-min[splitAxis])
+			splitAxis=i;
+	std::vector<Scalar> coords;
+	coords.reserve(points.size());
+	for(std::vector<Point>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
+		coords.push_back((*pIt)[splitAxis]);
+	std::sort(coords.begin(),coords.end());
+	std::vector<Scalar> splits;
+	for(unsigned int i=1;i<numRegions;++i)
+		splits.push_back(coords[(points.size()*i)/numRegions]);
+	
+	/* Assign each point to its slab and sort point indices by region: */
+	regionPointStarts.resize(numRegions+1,0);
+	for(size_t pi=0;pi<points.size();++pi)
+		{
+		pointRegions[pi]=Misc::UInt16(std::upper_bound(splits.begin(),splits.end(),points[pi][splitAxis])-splits.begin());
+		++regionPointStarts[pointRegions[pi]+1];
+		}
+	for(unsigned int i=0;i<numRegions;++i)
+		regionPointStarts[i+1]+=regionPointStarts[i];
+	regionPoints.resize(points.size());
+	std::vector<Index> fill(regionPointStarts.begin(),regionPointStarts.end()-1);
+	for(size_t pi=0;pi<points.size();++pi)
+		{
+		regionPoints[fill[pointRegions[pi]]]=Index(pi);
+		++fill[pointRegions[pi]];
+		}
+	
+	/* Create the regions and the seam region: */
+	regions=new Region[numRegions+1];
+	}
+
+BallPivoter::~BallPivoter(void)
+	{
+	delete[] regions;
+	}
+
+void BallPivoter::pivot(BallPivoter::Scalar newBallRadius)
+	{
+	if(points.empty())
+		return;
+	ballRadius=newBallRadius;
+	
+	/* Create a spatial hash whose cells cover the largest neighborhood queried by the pivoting ball: */
+	Misc::Timer timer;
+	PointGrid newGrid(points.size(),&points[0],ballRadius*Scalar(2));
+	grid=&newGrid;
+	timer.elapse();
+	statistics.gridTime+=timer.getTime();
+	
+	/* Propagate fronts inside all regions in parallel: */
+	reactivateBoundaries();
+	RegionPivoter regionPivoter;
+	regionPivoter.pivoter=this;
+	Threads::parallelFor(0,numRegions,regionPivoter,1,numRegions);
+	
+	/* Collect the regions' triangles and hand their deferred half-edges to the seam region: */
+	Region& seam=regions[numRegions];
+	for(unsigned int regionIndex=0;regionIndex<numRegions;++regionIndex)
+		{
+		Region& region=regions[regionIndex];
+		triangles.insert(triangles.end(),region.triangles.begin(),region.triangles.end());
+		statistics.numRegionTriangles+=region.triangles.size();
+		statistics.numSeeds+=region.numSeeds;
+		for(std::vector<HalfEdgeKey>::iterator dIt=region.deferred.begin();dIt!=region.deferred.end();++dIt)
+			{
+			getHalfEdgeMap(dIt->start,dIt->end).getEntry(*dIt).getDest().state=FRONT;
+			seam.front.push_back(*dIt);
+			}
+		std::vector<Triangle>().swap(region.triangles);
+		std::vector<HalfEdgeKey>().swap(region.deferred);
+		region.numSeeds=0;
+		}
+	timer.elapse();
+	statistics.regionTime+=timer.getTime();
+	
+	/* Close the seams between regions and triangulate points left over by the regions: */
+	triangulateRegion(numRegions);
+	triangles.insert(triangles.end(),seam.triangles.begin(),seam.triangles.end());
+	statistics.numSeamTriangles+=seam.triangles.size();
+	statistics.numSeeds+=seam.numSeeds;
+	std::vector<Triangle>().swap(seam.triangles);
+	seam.numSeeds=0;
+	timer.elapse();
+	statistics.seamTime+=timer.getTime();
+	
+	grid=0;
+	}
+
+void BallPivoter::reconstruct(const std::vector<BallPivoter::Scalar>& ballRadii)
+	{
+	/* Run one pass per ball radius in increasing order: */
+	std::vector<Scalar> sortedRadii=ballRadii;
+	std::sort(sortedRadii.begin(),sortedRadii.end());
+	for(std::vector<Scalar>::const_iterator rIt=sortedRadii.begin();rIt!=sortedRadii.end();++rIt)
+		pivot(*rIt);
+	}
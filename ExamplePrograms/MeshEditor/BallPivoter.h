@@ -0,0 +1,213 @@
+/***********************************************************************
+BallPivoter - Class to reconstruct triangle meshes from large point sets
+using the ball pivoting algorithm, with a uniform grid spatial hash for
+neighborhood queries, parallel front propagation inside spatial
+regions, and an ordered sequence of ball radii.
+Copyright (c) 2011 Oliver Kreylos
+***********************************************************************/
+
+#ifndef BALLPIVOTER_INCLUDED
+#define BALLPIVOTER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <deque>
+#include <Misc/SizedTypes.h>
+#include <Misc/HashTable.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+
+/* Forward declarations: */
+class PointGrid;
+
+class BallPivoter
+	{
+	/* Embedded classes: */
+	public:
+	typedef double Scalar; // Scalar type for point coordinates
+	typedef Geometry::Point<Scalar,3> Point; // Type for points
+	typedef Geometry::Vector<Scalar,3> Vector; // Type for vectors
+	typedef Misc::UInt32 Index; // Type for point indices
+	static const Index invalidIndex=0xffffffffU; // Index denoting a non-existing point
+	
+	struct Triangle // Structure for reconstructed triangles
+		{
+		/* Elements: */
+		public:
+		Index vertices[3]; // Indices of the triangle's vertices in counter-clockwise order
+		};
+	
+	struct Statistics // Structure to report reconstruction performance
+		{
+		/* Elements: */
+		public:
+		size_t numSeeds; // Number of seed triangles that started new fronts
+		size_t numRegionTriangles; // Number of triangles created by parallel front propagation inside regions
+		size_t numSeamTriangles; // Number of triangles created while merging the regions' seams
+		double gridTime; // Time spent building spatial hashes in seconds
+		double regionTime; // Time spent propagating fronts inside regions in seconds
+		double seamTime; // Time spent merging the regions' seams in seconds
+		
+		/* Constructors and destructors: */
+		Statistics(void)
+			:numSeeds(0),numRegionTriangles(0),numSeamTriangles(0),
+			 gridTime(0.0),regionTime(0.0),seamTime(0.0)
+			{
+			}
+		
+		/* Methods: */
+		double getTotalTime(void) const // Returns the total reconstruction time
+			{
+			return gridTime+regionTime+seamTime;
+			}
+		double getTriangleRate(void) const // Returns the average number of reconstructed triangles per second
+			{
+			double totalTime=getTotalTime();
+			return totalTime>0.0?double(numRegionTriangles+numSeamTriangles)/totalTime:0.0;
+			}
+		};
+	
+	private:
+	enum HalfEdgeState // Enumerated type for states of half-edges without opposite half-edges
+		{
+		FRONT, // Half-edge is queued for pivoting
+		DEFERRED, // Pivoting around the half-edge hit a vertex outside the current region
+		BOUNDARY // Pivoting around the half-edge failed for the current ball radius
+		};
+	
+	class HalfEdgeKey // Directed pair of vertex indices identifying a half-edge
+		{
+		/* Elements: */
+		public:
+		Index start,end; // Indices of the half-edge's start and end vertices
+		
+		/* Constructors and destructors: */
+		HalfEdgeKey(void)
+			{
+			}
+		HalfEdgeKey(Index sStart,Index sEnd)
+			:start(sStart),end(sEnd)
+			{
+			}
+		
+		/* Methods: */
+		HalfEdgeKey getOpposite(void) const // Returns the key of the opposite half-edge
+			{
+			return HalfEdgeKey(end,start);
+			}
+		friend bool operator==(const HalfEdgeKey& k1,const HalfEdgeKey& k2)
+			{
+			return k1.start==k2.start&&k1.end==k2.end;
+			}
+		friend bool operator!=(const HalfEdgeKey& k1,const HalfEdgeKey& k2)
+			{
+			return k1.start!=k2.start||k1.end!=k2.end;
+			}
+		static size_t hash(const HalfEdgeKey& k,size_t tableSize)
+			{
+			return (size_t(k.start)*17+size_t(k.end)*31)%tableSize;
+			}
+		};
+	
+	struct HalfEdge // Structure for half-edges of reconstructed triangles
+		{
+		/* Elements: */
+		public:
+		Index apex; // Index of the vertex opposite the half-edge in its triangle
+		Point ballCenter; // Center of the empty ball resting on the half-edge's triangle
+		int state; // Pivoting state of the half-edge
+		
+		/* Constructors and destructors: */
+		HalfEdge(void)
+			{
+			}
+		HalfEdge(Index sApex,const Point& sBallCenter)
+			:apex(sApex),ballCenter(sBallCenter),state(FRONT)
+			{
+			}
+		};
+	
+	typedef Misc::HashTable<HalfEdgeKey,HalfEdge,HalfEdgeKey> HalfEdgeMap; // Hash table mapping half-edge keys to half-edges
+	
+	struct Region // Structure for regions of space triangulated by independent fronts
+		{
+		/* Elements: */
+		public:
+		HalfEdgeMap halfEdges; // Half-edges whose vertices both lie inside the region
+		std::deque<HalfEdgeKey> front; // Queue of front half-edges to pivot around
+		std::vector<HalfEdgeKey> deferred; // Front half-edges whose pivoting ball hit a vertex outside the region
+		std::vector<Triangle> triangles; // Triangles created inside the region during the current ball radius pass
+		size_t numSeeds; // Number of seed triangles found inside the region during the current ball radius pass
+		
+		/* Constructors and destructors: */
+		Region(void)
+			:halfEdges(1021),numSeeds(0)
+			{
+			}
+		};
+	
+	class RegionPivoter; // Functor class to propagate fronts in parallel
+	
+	/* Elements: */
+	std::vector<Point> points; // Array of input points
+	std::vector<Vector> normals; // Array of optional input point normals used to orient seed triangles; empty if points have no normals
+	Point centroid; // Centroid of the input points; seed triangles face away from it if points have no normals
+	unsigned int numRegions; // Number of regions propagating fronts in parallel
+	std::vector<Misc::UInt16> pointRegions; // Index of the region containing each point
+	std::vector<Index> regionPointStarts; // Index of the first point of each region in the sorted point index array, plus one past-the-end index
+	std::vector<Index> regionPoints; // Indices of all points, sorted by region
+	std::vector<Index> numBoundaryHalfEdges; // Number of half-edges without opposites incident on each point; invalidIndex for points not yet part of any triangle
+	Region* regions; // Array of regions, plus one additional seam region for half-edges crossing region boundaries
+	const PointGrid* grid; // Spatial hash for the current ball radius
+	Scalar ballRadius; // Ball radius for the current pass
+	std::vector<Triangle> triangles; // List of all reconstructed triangles
+	Statistics statistics; // Reconstruction performance statistics
+	
+	/* Private methods: */
+	HalfEdgeMap& getHalfEdgeMap(Index v0,Index v1) // Returns the hash table storing the half-edge between the two given vertices
+		{
+		return regions[pointRegions[v0]==pointRegions[v1]?pointRegions[v0]:numRegions].halfEdges;
+		}
+	bool isHalfEdge(Index v0,Index v1) // Returns true if the half-edge from the first to the second given vertex exists
+		{
+		return getHalfEdgeMap(v0,v1).isEntry(HalfEdgeKey(v0,v1));
+		}
+	bool calcBallCenter(Index v0,Index v1,Index v2,Point& ballCenter) const; // Calculates the center of the ball of the current radius resting on the given triangle on the side of its counter-clockwise normal; returns false if the triangle is too large
+	bool isBallEmpty(const Point& ballCenter,Index v0,Index v1,Index v2) const; // Returns true if no points other than the given three lie inside the ball of the current radius around the given center
+	void addTriangle(Index v0,Index v1,Index v2,const Point& ballCenter,Region& region); // Adds a triangle, and queues its new front half-edges in the given region
+	bool findSeed(Index v0,unsigned int regionIndex,Region& region); // Tries to create a seed triangle incident on the given free vertex using only vertices from the given region, or from all regions if the region index is numRegions
+	void propagateFront(unsigned int regionIndex,Region& region); // Pivots around all front half-edges in the given region until the front is exhausted
+	void triangulateRegion(unsigned int regionIndex); // Propagates fronts and seeds new fronts inside the given region, or across all regions if the region index is numRegions
+	void reactivateBoundaries(void); // Re-queues all boundary half-edges for the current ball radius
+	
+	/* Constructors and destructors: */
+	public:
+	BallPivoter(const std::vector<Point>& sPoints,const std::vector<Vector>& sNormals,unsigned int sNumRegions =0); // Creates a reconstructor for the given points and optional normals using the given number of parallel regions (0: one per online processor)
+	private:
+	BallPivoter(const BallPivoter& source); // Prohibit copy constructor
+	BallPivoter& operator=(const BallPivoter& source); // Prohibit assignment operator
+	public:
+	~BallPivoter(void);
+	
+	/* Methods: */
+	unsigned int getNumRegions(void) const // Returns the number of parallel regions
+		{
+		return numRegions;
+		}
+	void pivot(Scalar newBallRadius); // Continues the reconstruction with a ball of the given radius; radii should be passed in increasing order
+	void reconstruct(const std::vector<Scalar>& ballRadii); // Runs one pivoting pass for each of the given ball radii in increasing order
+	const std::vector<Point>& getPoints(void) const // Returns the input points
+		{
+		return points;
+		}
+	const std::vector<Triangle>& getTriangles(void) const // Returns the list of reconstructed triangles
+		{
+		return triangles;
+		}
+	const Statistics& getStatistics(void) const // Returns the reconstruction performance statistics
+		{
+		return statistics;
+		}
+	};
+
+#endif
@@ -1,7 +1,7 @@
 /***********************************************************************
 BallPivoting - Function to triangulate a set of points lying on a two-
 manifold using the pivoting ball algorithm.
-Copyright (c) 2005 Oliver Kreylos
+Copyright (c) 2005-2011 Oliver Kreylos
 ***********************************************************************/
 
 #include <utility>
@@ -21,13 +21,12 @@ Copyright (c) 2005 Oliver Kreylos
 
 typedef Geometry::Point<double,3> Point;
 typedef Geometry::Vector<double,3> Vector;
-typedef AutoTriangleMesh::Vertex Vertex;
-typedef Geometry::ValuedPoint<Point,Vertex*> VertexPoint;
+typedef AutoTriangleMesh::VertexIterator VertexIterator;
+typedef Geometry::ValuedPoint<Point,VertexIterator> VertexPoint;
 typedef Geometry::ArrayKdTree<VertexPoint> VertexTree;
-typedef AutoTriangleMesh::Edge Edge;
+typedef AutoTriangleMesh::EdgeIterator EdgeIterator;
 typedef AutoTriangleMesh::VertexPair VertexPair;
 typedef AutoTriangleMesh::EdgeHasher EdgeHasher;
-typedef AutoTriangleMesh::Face Face;
 typedef Geometry::ComponentArray<double,3> CA;
 typedef Geometry::Matrix<double,3,3> Matrix;
 
@@ -232,10 +231,10 @@ struct PivotRequest // Structure to store a pivot request over a boundary edge
 	public:
 	Point ballCenter; // Current center point of the pivoting ball
 	Vector faceNormal; // Normal vector of the face the pivoting ball is resting on
-	Edge* edge; // Pointer to the pivot edge
+	EdgeIterator edge; // Pointer to the pivot edge
 	
 	/* Constructors and destructors: */
-	PivotRequest(const Point& sBallCenter,const Vector& sFaceNormal,Edge* sEdge)
+	PivotRequest(const Point& sBallCenter,const Vector& sFaceNormal,const EdgeIterator& sEdge)
 		:ballCenter(sBallCenter),faceNormal(sFaceNormal),
 		 edge(sEdge)
 		{
@@ -254,7 +253,7 @@ class FindNextVertexFunctor
 	double maxPivotDistance;
 	Vector pivotX,pivotY;
 	double minCosPivotAngle;
-	Vertex* minVertex;
+	VertexIterator minVertex;
 	Point minBallCenter;
 	Vector minFaceNormal;
 	
@@ -353,7 +352,7 @@ class FindNextVertexFunctor
 		
 		return true;
 		};
-	Vertex* getNextVertex(void) const
+	VertexIterator getNextVertex(void) const
 		{
 		return minVertex;
 		};
@@ -401,7 +400,7 @@ BPState* startBallPivoting(AutoTriangleMesh& mesh,const ShootBallResult& sbr)
 	for(VIt vIt=bpState->mesh.beginVertices();vIt!=bpState->mesh.endVertices();++vIt)
 		if(!vIt->isInterior())
 			{
-			vertices[numVertices]=VertexPoint(*vIt,&(*vIt));
+			vertices[numVertices]=VertexPoint(*vIt,vIt);
 			++numVertices;
 			}
 	bpState->tree.donatePoints(numVertices,vertices);
@@ -410,7 +409,7 @@ BPState* startBallPivoting(AutoTriangleMesh& mesh,const ShootBallResult& sbr)
 	bpState->edgeHasher=bpState->mesh.startAddingFaces();
 	for(FIt fIt=bpState->mesh.beginFaces();fIt!=bpState->mesh.endFaces();++fIt)
 		for(FEIt feIt=fIt.beginEdges();feIt!=fIt.endEdges();++feIt)
-			bpState->edgeHasher->setEntry(EdgeHasher::Entry(feIt.getVertexPair(),&(*feIt)));
+			bpState->edgeHasher->setEntry(EdgeHasher::Entry(feIt.getVertexPair(),feIt.getIndex()));
 	
 	/* Create the face contained in the shoot ball result: */
 	if(sbr.numVertices==3)
@@ -427,7 +426,7 @@ BPState* startBallPivoting(AutoTriangleMesh& mesh,const ShootBallResult& sbr)
 			/* Push the new triangle's boundary edges onto the queue: */
 			for(FEIt feIt=newFace.beginEdges();feIt!=newFace.endEdges();++feIt)
 				if(feIt->getOpposite()==0)
-					bpState->pivotQueue.push_back(PivotRequest(sbr.ballCenter,faceNormal,&*feIt));
+					bpState->pivotQueue.push_back(PivotRequest(sbr.ballCenter,faceNormal,feIt));
 			}
 		}
 	
@@ -465,7 +464,7 @@ bool pivotOnce(BPState* bpState,int numEdges)
 	if(!bpState->pivotQueue.empty())
 		{
 		/* Get the next pivot request from the queue: */
-		Edge* edge=bpState->pivotQueue.front().edge;
+		EdgeIterator edge=bpState->pivotQueue.front().edge;
 		
 		if(edge->getOpposite()==0)
 			{
@@ -475,7 +474,7 @@ bool pivotOnce(BPState* bpState,int numEdges)
 			bpState->tree.traverseTreeDirected(findNextVertex);
 			
 			/* Create a new triangle if a boundary vertex was found: */
-			Vertex* v=findNextVertex.getNextVertex();
+			VertexIterator v=findNextVertex.getNextVertex();
 			if(v!=0&&!v->isInterior())
 				{
 				/* Create the new triangle: */
@@ -493,20 +492,20 @@ bool pivotOnce(BPState* bpState,int numEdges)
 					/* Push the new triangle's boundary edges onto the queue: */
 					for(FEIt feIt=newFace.beginEdges();feIt!=newFace.endEdges();++feIt)
 						if(feIt->getOpposite()==0)
-							bpState->pivotQueue.push_back(PivotRequest(findNextVertex.getNextBallCenter(),findNextVertex.getNextFaceNormal(),&*feIt));
+							bpState->pivotQueue.push_back(PivotRequest(findNextVertex.getNextBallCenter(),findNextVertex.getNextFaceNormal(),feIt));
 					
 					#if 0
 					/* Remove non-boundary triangles from the mesh: */
 					std::vector<FIt> interiorFaces;
 					if(edge->getStart()->isInterior())
 						{
-						for(Edge* ve=edge;ve!=edge->getOpposite()->getFaceSucc();ve=ve->getVertexSucc())
+						for(EdgeIterator ve=edge;ve!=edge->getOpposite()->getFaceSucc();ve=ve->getVertexSucc())
 							if(ve->getEnd()->isInterior()&&ve->getFaceSucc()->getEnd()->isInterior())
 								interiorFaces.push_back(ve->getFace());
 						}
 					if(edge->getEnd()->isInterior())
 						{
-						for(Edge* ve=edge->getOpposite();ve!=edge->getFaceSucc();ve=ve->getVertexSucc())
+						for(EdgeIterator ve=edge->getOpposite();ve!=edge->getFaceSucc();ve=ve->getVertexSucc())
 							if(ve->getEnd()->isInterior()&&ve->getFaceSucc()->getEnd()->isInterior())
 								interiorFaces.push_back(ve->getFace());
 							
@@ -538,7 +537,7 @@ void finishBallPivoting(BPState* bpState)
 Everything below here is not used right now
 ******************************************/
 
-std::pair<Point,bool> calcBallCenter(const Vertex* edgeStart,const Vertex* edgeEnd,const Vertex* oppositeVertex,double ballRadius)
+std::pair<Point,bool> calcBallCenter(const VertexIterator& edgeStart,const VertexIterator& edgeEnd,const VertexIterator& oppositeVertex,double ballRadius)
 	{
 	/* Gather the three vertices of the given triangle: */
 	Point vs[3];
@@ -596,7 +595,7 @@ AutoTriangleMesh& triangulateVertices(AutoTriangleMesh& mesh,double ballRadius)
 	VertexPoint* vertices=new VertexPoint[numVertices];
 	int i=0;
 	for(VIt vIt=mesh.beginVertices();vIt!=mesh.endVertices();++vIt,++i)
-		vertices[i]=VertexPoint(*vIt,&(*vIt));
+		vertices[i]=VertexPoint(*vIt,vIt);
 	VertexTree tree;
 	tree.donatePoints(numVertices,vertices);
 	
@@ -612,8 +611,8 @@ AutoTriangleMesh& triangulateVertices(AutoTriangleMesh& mesh,double ballRadius)
 		for(FEIt feIt=fIt.beginEdges();feIt!=fIt.endEdges();++feIt)
 			if(feIt->getOpposite()==0)
 				{
-				Edge* edge=&(*feIt);
-				edgeHasher->setEntry(EdgeHasher::Entry(feIt.getVertexPair(),edge));
+				EdgeIterator edge=feIt;
+				edgeHasher->setEntry(EdgeHasher::Entry(feIt.getVertexPair(),edge.getIndex()));
 				if(!haveFaceData)
 					{
 					faceNormal=Geometry::cross((*edge->getEnd())-(*edge->getStart()),(*edge->getFacePred()->getStart())-(*edge->getStart()));
@@ -628,7 +627,7 @@ AutoTriangleMesh& triangulateVertices(AutoTriangleMesh& mesh,double ballRadius)
 	while(!pivotQueue.empty())
 		{
 		/* Get the next pivot request from the queue: */
-		Edge* edge=pivotQueue.front().edge;
+		EdgeIterator edge=pivotQueue.front().edge;
 		
 		if(edge->getOpposite()==0)
 			{
@@ -638,7 +637,7 @@ AutoTriangleMesh& triangulateVertices(AutoTriangleMesh& mesh,double ballRadius)
 			tree.traverseTreeDirected(findNextVertex);
 			
 			/* Create a new triangle if a boundary vertex was found: */
-			Vertex* v=findNextVertex.getNextVertex();
+			VertexIterator v=findNextVertex.getNextVertex();
 			if(v!=0&&!v->isInterior())
 				{
 				/* Create the new triangle: */
@@ -656,7 +655,7 @@ AutoTriangleMesh& triangulateVertices(AutoTriangleMesh& mesh,double ballRadius)
 					/* Push the new triangle's boundary edges onto the queue: */
 					for(FEIt feIt=newFace.beginEdges();feIt!=newFace.endEdges();++feIt)
 						if(feIt->getOpposite()==0)
-							pivotQueue.push(PivotRequest(findNextVertex.getNextBallCenter(),findNextVertex.getNextFaceNormal(),&*feIt));
+							pivotQueue.push(PivotRequest(findNextVertex.getNextBallCenter(),findNextVertex.getNextFaceNormal(),feIt));
 					}
 				}
 			}
@@ -683,7 +682,7 @@ BPState* startBallPivoting(AutoTriangleMesh& mesh,double ballRadius)
 	for(VIt vIt=bpState->mesh.beginVertices();vIt!=bpState->mesh.endVertices();++vIt)
 		if(!vIt->isInterior())
 			{
-			vertices[numVertices]=VertexPoint(*vIt,&(*vIt));
+			vertices[numVertices]=VertexPoint(*vIt,vIt);
 			++numVertices;
 			}
 	bpState->tree.donatePoints(numVertices,vertices);
@@ -697,8 +696,8 @@ BPState* startBallPivoting(AutoTriangleMesh& mesh,double ballRadius)
 		std::pair<Point,bool> ballCenterResult;
 		for(FEIt feIt=fIt.beginEdges();feIt!=fIt.endEdges();++feIt)
 			{
-			Edge* edge=&(*feIt);
-			bpState->edgeHasher->setEntry(EdgeHasher::Entry(feIt.getVertexPair(),edge));
+			EdgeIterator edge=feIt;
+			bpState->edgeHasher->setEntry(EdgeHasher::Entry(feIt.getVertexPair(),edge.getIndex()));
 			if(feIt->getOpposite()==0)
 				{
 				if(!haveFaceData)
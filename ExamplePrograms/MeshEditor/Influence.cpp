@@ -107,7 +107,7 @@ void Influence::actOnMesh(Influence::Mesh& mesh) const
 						{
 						/* Calculate average position for this vertex: */
 						Mesh::Point::AffineCombiner centroidC;
-						const Mesh::Edge* e=vIt->getEdge();
+						Mesh::ConstEdgeIterator e=vIt->getEdge();
 						do
 							{
 							#if 1
@@ -457,7 +457,7 @@ void saveMeshfile(const char* meshfileName,const PolygonMesh& mesh)
 
 void savePlyMeshfile(const char* meshfileName,const PolygonMesh& mesh)
 	{
-	typedef Misc::HashTable<const PolygonMesh::Vertex*,int> VertexHasher;
+	typedef Misc::HashTable<PolygonMesh::ConstVertexIterator,int,PolygonMesh::ConstVertexIterator> VertexHasher;
 	
 	/* Open the ply file: */
 	Misc::File plyFile(meshfileName,"wb",Misc::File::LittleEndian);
@@ -489,7 +489,7 @@ void savePlyMeshfile(const char* meshfileName,const PolygonMesh& mesh)
 		plyFile.write<unsigned char>(vIt->color.getRgba(),3);
 		
 		/* Put vertex into hash table for index generation: */
-		vertexHasher.setEntry(VertexHasher::Entry(&(*vIt),i));
+		vertexHasher.setEntry(VertexHasher::Entry(vIt,i));
 		}
 	
 	/* Write all faces to the ply file: */
@@ -47,7 +47,7 @@ MorphBox::MorphBox(MorphBox::Mesh* sMesh,const MorphBox::Point& origin,const Mor
 		if(inside)
 			{
 			MorphVertex mv;
-			mv.v=&(*vIt);
+			mv.v=vIt;
 			for(int i=0;i<3;++i)
 				mv.boxCoords[i]=bc[i];
 			morphedVertices.push_back(mv);
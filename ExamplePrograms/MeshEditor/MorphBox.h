@@ -32,7 +32,7 @@ class MorphBox
 		{
 		/* Elements: */
 		public:
-		MVertex* v; // Pointer to the morphed vertex
+		MVertexIterator v; // Iterator to the morphed vertex
 		Scalar boxCoords[3]; // Box coordinates of the morphed vertex
 		};
 	
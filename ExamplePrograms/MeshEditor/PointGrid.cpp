@@ -0,0 +1,50 @@
+/***********************************************************************
+PointGrid - Uniform grid spatial hash over an array of points to support
+fast fixed-radius neighborhood queries.
+Copyright (c) 2011 Oliver Kreylos
+***********************************************************************/
+
+#include "PointGrid.h"
+
+/**************************
+Methods of class PointGrid:
+**************************/
+
+PointGrid::PointGrid(size_t numPoints,const PointGrid::Point* sPoints,PointGrid::Scalar sCellSize)
+	:points(sPoints),
+	 origin(Point::origin),cellSize(sCellSize),
+	 numBuckets(numPoints>0?numPoints:1),
+	 bucketStarts(numBuckets+1,0),
+	 bucketPoints(numPoints)
+	{
+	/* Anchor the cell numbering at the lower corner of the points' bounding box: */
+	if(numPoints>0)
+		{
+		origin=points[0];
+		for(size_t pi=1;pi<numPoints;++pi)
+			for(int i=0;i<3;++i)
+				if(origin[i]>points[pi][i])
+					origin[i]=points[pi][i];
+		}
+	
+	/* Count the number of points in each hash bucket: */
+	std::vector<Index> pointBuckets(numPoints);
+	for(size_t pi=0;pi<numPoints;++pi)
+		{
+		const Point& p=points[pi];
+		pointBuckets[pi]=Index(getBucket(getCellIndex(p[0],0),getCellIndex(p[1],1),getCellIndex(p[2],2)));
+		++bucketStarts[pointBuckets[pi]+1];
+		}
+	
+	/* Convert the counts into bucket start indices: */
+	for(size_t bi=0;bi<numBuckets;++bi)
+		bucketStarts[bi+1]+=bucketStarts[bi];
+	
+	/* Sort the point indices into their buckets: */
+	std::vector<Index> fill(bucketStarts.begin(),bucketStarts.end()-1);
+	for(size_t pi=0;pi<numPoints;++pi)
+		{
+		bucketPoints[fill[pointBuckets[pi]]]=Index(pi);
+		++fill[pointBuckets[pi]];
+		}
+	}
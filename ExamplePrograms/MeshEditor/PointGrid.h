@@ -0,0 +1,89 @@
+/***********************************************************************
+PointGrid - Uniform grid spatial hash over an array of points to support
+fast fixed-radius neighborhood queries.
+Copyright (c) 2011 Oliver Kreylos
+***********************************************************************/
+
+#ifndef POINTGRID_INCLUDED
+#define POINTGRID_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Math/Math.h>
+#include <Geometry/Point.h>
+
+class PointGrid
+	{
+	/* Embedded classes: */
+	public:
+	typedef double Scalar; // Scalar type for point coordinates
+	typedef Geometry::Point<Scalar,3> Point; // Type for points
+	typedef Misc::UInt32 Index; // Type for point indices
+	
+	/* Elements: */
+	private:
+	const Point* points; // Pointer to the array of points; not owned by the grid
+	Point origin; // Origin of the grid's cell numbering
+	Scalar cellSize; // Edge length of the grid's cubical cells
+	size_t numBuckets; // Number of hash buckets
+	std::vector<Index> bucketStarts; // Index of first point of each hash bucket in the sorted point index array, plus one past-the-end index
+	std::vector<Index> bucketPoints; // Indices of all points, sorted by hash bucket
+	
+	/* Private methods: */
+	int getCellIndex(Scalar coordinate,int dimension) const // Returns the cell index of the given coordinate along the given dimension
+		{
+		return int(Math::floor((coordinate-origin[dimension])/cellSize));
+		}
+	size_t getBucket(int x,int y,int z) const // Returns the hash bucket of the grid cell of the given index
+		{
+		return ((size_t(x)*73856093U)^(size_t(y)*19349663U)^(size_t(z)*83492791U))%numBuckets;
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	PointGrid(size_t numPoints,const Point* sPoints,Scalar sCellSize); // Creates a grid of the given cell size over the given array of points
+	
+	/* Methods: */
+	Scalar getCellSize(void) const // Returns the grid's cell size
+		{
+		return cellSize;
+		}
+	template <class FunctorParam>
+	void processSphere(const Point& center,Scalar radius,FunctorParam& functor) const // Calls functor(index) exactly once for each point whose distance from the given center is less than the given radius
+		{
+		/* Calculate the range of grid cells overlapping the sphere's bounding box: */
+		int min[3],max[3];
+		for(int i=0;i<3;++i)
+			{
+			min[i]=getCellIndex(center[i]-radius,i);
+			max[i]=getCellIndex(center[i]+radius,i);
+			}
+		Scalar radius2=Math::sqr(radius);
+		
+		/* Check all points in all hash buckets associated with the cells: */
+		int cell[3];
+		for(cell[0]=min[0];cell[0]<=max[0];++cell[0])
+			for(cell[1]=min[1];cell[1]<=max[1];++cell[1])
+				for(cell[2]=min[2];cell[2]<=max[2];++cell[2])
+					{
+					size_t bucket=getBucket(cell[0],cell[1],cell[2]);
+					std::vector<Index>::const_iterator bpEnd=bucketPoints.begin()+bucketStarts[bucket+1];
+					for(std::vector<Index>::const_iterator bpIt=bucketPoints.begin()+bucketStarts[bucket];bpIt!=bpEnd;++bpIt)
+						{
+						const Point& p=points[*bpIt];
+						if(Geometry::sqrDist(p,center)<radius2)
+							{
+							/* Skip points from other cells that collided into the same bucket: */
+							bool inCell=true;
+							for(int i=0;i<3&&inCell;++i)
+								inCell=getCellIndex(p[i],i)==cell[i];
+							if(inCell)
+								functor(*bpIt);
+							}
+						}
+					}
+		}
+	};
+
+#endif
@@ -1,427 +1,642 @@
 /***********************************************************************
 PolygonMesh - Class providing the infrastructure for algorithms working
 on meshes of convex polygons
-Copyright (c) 2001-2005 Oliver Kreylos
+Copyright (c) 2001-2011 Oliver Kreylos
 ***********************************************************************/
 
 #include <assert.h>
-#include <new>
 #include <vector>
-#include <iostream>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/HashTable.h>
 #include <Math/Math.h>
 #include <GL/gl.h>
+#include <Threads/ParallelFor.h>
 
 #include "PolygonMesh.h"
 
-/************************************
-Methods of class PolygonMesh::Vertex:
-************************************/
+/**********************************************************
+Helper structures and classes for parallel mesh processing:
+**********************************************************/
 
-int PolygonMesh::Vertex::getNumEdges(void) const
+struct PolygonMesh::SubdivisionIndices
 	{
-	int result=0;
-	const Edge* ePtr=edge;
-	do
+	/* Elements: */
+	public:
+	std::vector<Index> faces; // Indices of all existing faces in subdivision order
+	std::vector<Index> faceEdgeBases; // Dense position of the first half-edge of each face in subdivision order; extra last entry is the total number of half-edges
+	std::vector<Index> facePoints; // Index of the face point vertex of each existing face, indexed by face
+	std::vector<Index> edgePositions; // Dense position of each existing half-edge, indexed by half-edge
+	std::vector<Index> edgePoints; // Index of the edge point vertex of each existing half-edge, indexed by half-edge
+	};
+
+class PolygonMesh::VertexNormalCalculator
+	{
+	/* Elements: */
+	public:
+	PolygonMesh* mesh; // The polygon mesh
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
 		{
-		++result;
-		ePtr=ePtr->getVertexSucc();
+		for(size_t vertex=begin;vertex<end;++vertex)
+			mesh->calcVertexNormal(Index(vertex));
 		}
-	while(ePtr!=edge);
+	};
 
-	return result;
-	}
-
-bool PolygonMesh::Vertex::isInterior(void) const
+class PolygonMesh::FaceEdgeCounter
 	{
-	if(edge==0)
-		return false;
+	/* Elements: */
+	public:
+	const PolygonMesh* mesh; // The polygon mesh
+	SubdivisionIndices* si; // Index maps for the current subdivision
 	
-	const Edge* ePtr=edge;
-	do
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
 		{
-		ePtr=ePtr->getVertexSucc();
+		for(size_t i=begin;i<end;++i)
+			si->faceEdgeBases[i+1]=Index(mesh->getNumFaceEdges(si->faces[i]));
 		}
-	while(ePtr!=edge&&ePtr!=0);
+	};
+
+class PolygonMesh::FaceEdgeEnumerator
+	{
+	/* Elements: */
+	public:
+	const PolygonMesh* mesh; // The polygon mesh
+	SubdivisionIndices* si; // Index maps for the current subdivision
 	
-	return ePtr!=0;
-	}
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
+		{
+		for(size_t i=begin;i<end;++i)
+			{
+			/* Number the face's half-edges consecutively, starting with the face's first half-edge: */
+			Index firstEdge=mesh->faces[si->faces[i]].edge;
+			Index edge=firstEdge;
+			Index position=si->faceEdgeBases[i];
+			do
+				{
+				si->edgePositions[edge]=position;
+				++position;
+				edge=mesh->edges[edge].faceSucc;
+				}
+			while(edge!=firstEdge);
+			}
+		}
+	};
 
-void PolygonMesh::Vertex::checkVertex(void) const
+class PolygonMesh::FacePointCalculator
 	{
-	assert(edge!=0);
+	/* Elements: */
+	public:
+	PolygonMesh* mesh; // The polygon mesh
+	const SubdivisionIndices* si; // Index maps for the current subdivision
 	
-	const Edge* ePtr=edge;
-	do
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
 		{
-		assert(ePtr->getStart()==this);
-		assert(ePtr->getFacePred()->getFaceSucc()==ePtr);
-		assert(ePtr->getOpposite()!=0);
-		assert(ePtr->getOpposite()->getOpposite()==ePtr);
-		assert(ePtr->sharpness==ePtr->getOpposite()->sharpness);
-		assert(ePtr->getVertexSucc()->getVertexPred()==ePtr);
-		assert(ePtr->getVertexPred()->getVertexSucc()==ePtr);
-		
-		ePtr=ePtr->getVertexSucc();
+		for(size_t i=begin;i<end;++i)
+			{
+			Index face=si->faces[i];
+			mesh->calcFacePoint(face,si->facePoints[face]);
+			}
 		}
-	while(ePtr!=edge);
-	}
+	};
 
-/**********************************
-Methods of class PolygonMesh::Face:
-**********************************/
+class PolygonMesh::EdgeMidpointCalculator
+	{
+	/* Elements: */
+	public:
+	PolygonMesh* mesh; // The polygon mesh
+	const SubdivisionIndices* si; // Index maps for the current subdivision
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
+		{
+		for(size_t i=begin;i<end;++i)
+			mesh->calcEdgeMidpoints(si->faces[i],*si);
+		}
+	};
 
-int PolygonMesh::Face::getNumEdges(void) const
+class PolygonMesh::VertexPointCalculator
 	{
-	int result=0;
-	const Edge* ePtr=edge;
-	do
+	/* Elements: */
+	public:
+	PolygonMesh* mesh; // The polygon mesh
+	const SubdivisionIndices* si; // Index maps for the current subdivision
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
 		{
-		++result;
-		ePtr=ePtr->getFaceSucc();
+		for(size_t vertex=begin;vertex<end;++vertex)
+			mesh->calcVertexPoint(Index(vertex),*si);
 		}
-	while(ePtr!=edge);
+	};
 
-	return result;
-	}
+class PolygonMesh::EdgePointCalculator
+	{
+	/* Elements: */
+	public:
+	PolygonMesh* mesh; // The polygon mesh
+	const SubdivisionIndices* si; // Index maps for the current subdivision
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
+		{
+		for(size_t i=begin;i<end;++i)
+			mesh->calcEdgePoints(si->faces[i],*si);
+		}
+	};
 
-void PolygonMesh::Face::checkFace(void) const
+class PolygonMesh::FaceSubdivider
 	{
-	assert(edge!=0);
+	/* Elements: */
+	public:
+	PolygonMesh* mesh; // The polygon mesh
+	const SubdivisionIndices* si; // Index maps for the current subdivision
+	Edge* newEdges; // Half-edge array of the subdivided mesh
+	Face* newFaces; // Face array of the subdivided mesh
 	
-	const Edge* ePtr=edge;
-	do
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
 		{
-		assert(ePtr->getFace()==this);
-		assert(ePtr->getFaceSucc()->getFacePred()==ePtr);
-		assert(ePtr->getFacePred()->getFaceSucc()==ePtr);
-		
-		ePtr=ePtr->getFaceSucc();
+		for(size_t i=begin;i<end;++i)
+			mesh->subdivideFace(si->faces[i],*si,newEdges,newFaces);
 		}
-	while(ePtr!=edge);
-	}
+	};
 
 /****************************
 Methods of class PolygonMesh:
 ****************************/
 
-PolygonMesh::Vertex* PolygonMesh::newVertex(const PolygonMesh::Point& p,const PolygonMesh::Color& c)
-	{
-	/* Create a new vertex and link it to the vertex list: */
-	++numVertices;
-	Vertex* newVertex=new(vertexAllocator.allocate()) Vertex(p,c,0);
-	newVertex->version=version;
-	newVertex->pred=lastVertex;
-	if(lastVertex!=0)
-		lastVertex->succ=newVertex;
-	else
-		vertices=newVertex;
-	lastVertex=newVertex;
-	return newVertex;
-	}
+const PolygonMesh::Index PolygonMesh::invalidIndex;
 
-void PolygonMesh::deleteVertex(PolygonMesh::Vertex* vertex)
+int PolygonMesh::getNumVertexEdges(PolygonMesh::Index vertex) const
 	{
-	/* Unlink the vertex from the vertex list: */
-	if(vertex->pred!=0)
-		vertex->pred->succ=vertex->succ;
-	else
-		vertices=vertex->succ;
-	if(vertex->succ!=0)
-		vertex->succ->pred=vertex->pred;
-	else
-		lastVertex=vertex->pred;
+	int result=0;
+	Index firstEdge=vertices[vertex].edge;
+	Index edge=firstEdge;
+	do
+		{
+		++result;
+		edge=getVertexSucc(edge);
+		}
+	while(edge!=firstEdge&&edge!=invalidIndex);
 	
-	/* Delete the vertex: */
-	vertex->~Vertex();
-	vertexAllocator.free(vertex);
-	--numVertices;
+	return result;
 	}
 
-PolygonMesh::Edge* PolygonMesh::newEdge(void)
+bool PolygonMesh::isVertexInterior(PolygonMesh::Index vertex) const
 	{
-	/* Create a new edge: */
-	++numEdges;
-	return new(edgeAllocator.allocate()) Edge;
+	Index firstEdge=vertices[vertex].edge;
+	if(firstEdge==invalidIndex)
+		return false;
+	
+	Index edge=firstEdge;
+	do
+		{
+		edge=getVertexSucc(edge);
+		}
+	while(edge!=firstEdge&&edge!=invalidIndex);
+	
+	return edge!=invalidIndex;
 	}
 
-void PolygonMesh::deleteEdge(PolygonMesh::Edge* edge)
+int PolygonMesh::getNumFaceEdges(PolygonMesh::Index face) const
 	{
-	/* Delete the edge: */
-	edge->~Edge();
-	edgeAllocator.free(edge);
-	--numEdges;
+	int result=0;
+	Index firstEdge=faces[face].edge;
+	Index edge=firstEdge;
+	do
+		{
+		++result;
+		edge=edges[edge].faceSucc;
+		}
+	while(edge!=firstEdge);
+	
+	return result;
 	}
 
-PolygonMesh::Face* PolygonMesh::newFace(void)
+void PolygonMesh::checkVertex(PolygonMesh::Index vertex) const
 	{
-	/* Create a new face and link it to the face list: */
-	++numFaces;
-	Face* newFace=new(faceAllocator.allocate()) Face(0);
-	newFace->pred=lastFace;
-	if(lastFace!=0)
-		lastFace->succ=newFace;
-	else
-		faces=newFace;
-	lastFace=newFace;
-	return newFace;
+	Index firstEdge=vertices[vertex].edge;
+	assert(firstEdge!=invalidIndex);
+	
+	Index edge=firstEdge;
+	do
+		{
+		const Edge& e=edges[edge];
+		assert(e.start==vertex);
+		assert(edges[e.facePred].faceSucc==edge);
+		assert(e.opposite!=invalidIndex);
+		assert(edges[e.opposite].opposite==edge);
+		assert(e.sharpness==edges[e.opposite].sharpness);
+		assert(getVertexPred(getVertexSucc(edge))==edge);
+		assert(getVertexSucc(getVertexPred(edge))==edge);
+		
+		edge=getVertexSucc(edge);
+		}
+	while(edge!=firstEdge);
 	}
 
-void PolygonMesh::deleteFace(PolygonMesh::Face* face)
+void PolygonMesh::checkFace(PolygonMesh::Index face) const
 	{
-	/* Unlink the face from the face list: */
-	if(face->pred!=0)
-		face->pred->succ=face->succ;
-	else
-		faces=face->succ;
-	if(face->succ!=0)
-		face->succ->pred=face->pred;
-	else
-		lastFace=face->pred;
+	Index firstEdge=faces[face].edge;
+	assert(firstEdge!=invalidIndex);
 	
-	/* Delete the face: */
-	face->~Face();
-	faceAllocator.free(face);
-	--numFaces;
+	Index edge=firstEdge;
+	do
+		{
+		const Edge& e=edges[edge];
+		assert(e.face==face);
+		assert(edges[e.faceSucc].facePred==edge);
+		assert(edges[e.facePred].faceSucc==edge);
+		
+		edge=e.faceSucc;
+		}
+	while(edge!=firstEdge);
 	}
 
-PolygonMesh::PolygonMesh(const PolygonMesh& source)
-	:version(0),
-	 numVertices(0),vertices(0),lastVertex(0),
-	 numEdges(0),
-	 numFaces(0),faces(0),lastFace(0)
+void PolygonMesh::calcVertexNormal(PolygonMesh::Index vertex)
 	{
-	/* Copy all vertices and associate the copies with their originals: */
-	Misc::HashTable<const Vertex*,Vertex*> vertexMap((source.getNumVertices()*3)/2);
-	for(const Vertex* vPtr=source.vertices;vPtr!=0;vPtr=vPtr->succ)
-		vertexMap.setEntry(Misc::HashTable<const Vertex*,Vertex*>::Entry(vPtr,newVertex(*vPtr,vPtr->color)));
+	Vertex& v=vertices[vertex];
+	if(!vertexValid[vertex]||v.version!=version||v.edge==invalidIndex)
+		return;
 	
-	/* Count the number of edges in the source mesh to estimate the needed hash table size: */
-	const Face* fPtr;
-	int numEdges=0;
-	for(fPtr=source.faces;fPtr!=0;fPtr=fPtr->succ)
+	/* Calculate the vertex' normal vector: */
+	v.normal=Vector::zero;
+	
+	/* Iterate through vertex' platelet: */
+	Index ve=v.edge;
+	do
 		{
-		const Edge* firstSourceEdge=fPtr->getEdge();
-		const Edge* fePtr=firstSourceEdge;
-		do
+		const Edge& ve2=edges[edges[ve].facePred];
+		v.normal+=Geometry::cross(vertices[edges[edges[ve].faceSucc].start]-v,vertices[ve2.start]-v);
+		
+		/* Go to next edge around vertex: */
+		ve=ve2.opposite;
+		}
+	while(ve!=invalidIndex&&ve!=v.edge);
+	
+	if(ve==invalidIndex) // The vertex' platelet is open
+		{
+		ve=edges[v.edge].opposite;
+		while(ve!=invalidIndex)
 			{
-			++numEdges;
-			fePtr=fePtr->getFaceSucc();
+			const Edge& ve2=edges[edges[ve].faceSucc];
+			v.normal+=Geometry::cross(vertices[edges[ve2.faceSucc].start]-v,vertices[edges[ve].start]-v);
+			
+			/* Go to next edge around vertex: */
+			ve=ve2.opposite;
 			}
-		while(fePtr!=firstSourceEdge);
 		}
-	EdgeHasher companions(numEdges);
+	}
+
+void PolygonMesh::calcFacePoint(PolygonMesh::Index face,PolygonMesh::Index facePoint)
+	{
+	/* Average all the face's vertices to calculate the face point: */
+	VertexCombiner centroidC;
+	Index firstEdge=faces[face].edge;
+	Index edge=firstEdge;
+	do
+		{
+		centroidC.addVertex(vertices[edges[edge].start]);
+		edge=edges[edge].faceSucc;
+		}
+	while(edge!=firstEdge);
 	
-	/* Copy faces one at a time: */
-	for(fPtr=source.faces;fPtr!=0;fPtr=fPtr->succ)
+	Vertex& fp=vertices[facePoint];
+	fp=Vertex(centroidC.getPoint(),centroidC.getColor());
+	fp.version=version;
+	}
+
+void PolygonMesh::calcEdgeMidpoints(PolygonMesh::Index face,const PolygonMesh::SubdivisionIndices& si)
+	{
+	Index firstEdge=faces[face].edge;
+	Index edge=firstEdge;
+	do
 		{
-		Face* face=newFace();
-		
-		/* Copy all edges of the face (don't connect them to other faces yet): */
-		const Edge* firstSourceEdge=fPtr->getEdge();
-		const Edge* fePtr=firstSourceEdge;
-		Edge* firstEdge;
-		Edge* lastEdge=0;
-		do
+		const Edge& e=edges[edge];
+		if(e.opposite==invalidIndex||edge<e.opposite) // Only process "dominant" half edges
 			{
-			/* Create a new edge: */
-			Edge* edge=newEdge();
-			Vertex* vPtr=vertexMap.getEntry(fePtr->getStart()).getDest();
-			edge->set(vPtr,face,lastEdge,0,0);
-			edge->sharpness=fePtr->sharpness;
-			vPtr->setEdge(edge);
-			if(lastEdge!=0)
-				lastEdge->setFaceSucc(edge);
-			else
-				firstEdge=edge;
-			
-			lastEdge=edge;
-			fePtr=fePtr->getFaceSucc();
+			/* Calculate the edge midpoint: */
+			const Vertex& v1=vertices[e.start];
+			const Vertex& v2=vertices[edges[e.faceSucc].start];
+			Color midPointColor;
+			for(int i=0;i<4;++i)
+				midPointColor[i]=GLubyte(Math::floor((float(v1.color[i])+float(v2.color[i]))*0.5f+0.5f));
+			Vertex& ep=vertices[si.edgePoints[edge]];
+			ep=Vertex(Geometry::mid(v1,v2),midPointColor);
+			ep.version=version;
 			}
-		while(fePtr!=firstSourceEdge);
-		lastEdge->setFaceSucc(firstEdge);
-		firstEdge->setFacePred(lastEdge);
-		face->setEdge(firstEdge);
 		
-		/* Now go around the edge loop again to connect the face to its neighbours: */
-		Edge* edge=firstEdge;
-		do
+		edge=e.faceSucc;
+		}
+	while(edge!=firstEdge);
+	}
+
+void PolygonMesh::calcVertexPoint(PolygonMesh::Index vertex,const PolygonMesh::SubdivisionIndices& si)
+	{
+	/* Skip deleted vertices and vertices without edges: */
+	if(!vertexValid[vertex])
+		return;
+	Vertex& v=vertices[vertex];
+	Index firstEdge=v.edge;
+	if(firstEdge==invalidIndex)
+		return;
+	
+	/* Find the most clockwise half-edge around the vertex if the vertex is on the boundary: */
+	Index startEdge=firstEdge;
+	Index edge=getVertexPred(firstEdge);
+	while(edge!=invalidIndex&&edge!=firstEdge)
+		{
+		startEdge=edge;
+		edge=getVertexPred(edge);
+		}
+	if(edge==firstEdge)
+		startEdge=firstEdge;
+	
+	/* Add the adjacent face points and edge midpoints to the vertex point: */
+	VertexCombiner vertexPointC;
+	int numEdges=0;
+	int numSharpEdges=0;
+	Index sharpEdgePoints[2];
+	Index lastEdge;
+	edge=startEdge;
+	do
+		{
+		const Edge& e=edges[edge];
+		vertexPointC.addVertex(vertices[si.facePoints[e.face]]);
+		vertexPointC.addVertex(vertices[si.edgePoints[edge]],Scalar(2));
+		if(e.sharpness!=0||e.opposite==invalidIndex)
 			{
-			VertexPair vp(*edge);
-			EdgeHasher::Iterator companionsIt=companions.findEntry(vp);
-			if(companionsIt!=companions.end())
-				{
-				/* Connect the edge to its companion: */
-				edge->setOpposite(companionsIt->getDest());
-				companionsIt->getDest()->setOpposite(edge);
-				companions.removeEntry(companionsIt);
-				}
-			else
-				{
-				/* Add the edge to the companion table: */
-				companions.setEntry(EdgeHasher::Entry(vp,edge));
-				}
-			
-			edge=edge->getFaceSucc();
+			if(numSharpEdges<2)
+				sharpEdgePoints[numSharpEdges]=si.edgePoints[edge];
+			++numSharpEdges;
 			}
-		while(edge!=firstEdge);
+		++numEdges;
+		
+		lastEdge=edge;
+		edge=getVertexSucc(edge);
+		}
+	while(edge!=invalidIndex&&edge!=startEdge);
+	if(edge==invalidIndex)
+		{
+		/* Treat the incoming boundary edge as a sharp edge: */
+		if(numSharpEdges<2)
+			sharpEdgePoints[numSharpEdges]=si.edgePoints[edges[lastEdge].facePred];
+		++numSharpEdges;
 		}
 	
-	/* Calculate all vertex normal vectors: */
-	updateVertexNormals();
+	if(numSharpEdges<2)
+		{
+		/* Add the original vertex to the vertex point and normalize: */
+		vertexPointC.addVertex(v,Scalar(numEdges*(numEdges-3)));
+		v.setPoint(vertexPointC.getPoint());
+		v.color=vertexPointC.getColor();
+		}
+	else if(numSharpEdges==2)
+		{
+		/* Forget what we calculated, use the crease vertex rule: */
+		vertexPointC.reset();
+		vertexPointC.addVertex(v,Scalar(2));
+		vertexPointC.addVertex(vertices[sharpEdgePoints[0]]);
+		vertexPointC.addVertex(vertices[sharpEdgePoints[1]]);
+		v.setPoint(vertexPointC.getPoint());
+		v.color=vertexPointC.getColor();
+		}
+	v.version=version;
+	
+	/* Link the vertex to the first half-edge of its first face's corner quadrilateral: */
+	v.edge=si.edgePositions[firstEdge]*4;
 	}
 
-PolygonMesh::~PolygonMesh(void)
+void PolygonMesh::calcEdgePoints(PolygonMesh::Index face,const PolygonMesh::SubdivisionIndices& si)
 	{
-	/* Delete all faces and their associated half-edges: */
-	Face* fPtr=faces;
-	while(fPtr!=0)
+	Index firstEdge=faces[face].edge;
+	Index edge=firstEdge;
+	do
 		{
-		/* Delete all the face's half-edges: */
-		Edge* ePtr=fPtr->edge;
-		do
+		const Edge& e=edges[edge];
+		if(e.opposite!=invalidIndex&&edge<e.opposite&&e.sharpness==0) // Only process "dominant" half edges of smooth interior edges
 			{
-			Edge* next=ePtr->getFaceSucc();
-			deleteEdge(ePtr);
-			ePtr=next;
+			/* Combine the edge midpoint and the two adjacent face points: */
+			Vertex& ep=vertices[si.edgePoints[edge]];
+			VertexCombiner edgePointC;
+			edgePointC.addVertex(ep,2.0f);
+			edgePointC.addVertex(vertices[si.facePoints[e.face]]);
+			edgePointC.addVertex(vertices[si.facePoints[edges[e.opposite].face]]);
+			ep.setPoint(edgePointC.getPoint());
+			ep.color=edgePointC.getColor();
 			}
-		while(ePtr!=fPtr->edge);
 		
-		/* Delete the face: */
-		Face* next=fPtr->succ;
-		fPtr->~Face();
-		faceAllocator.free(fPtr);
-		
-		fPtr=next;
+		edge=e.faceSucc;
 		}
+	while(edge!=firstEdge);
+	}
+
+void PolygonMesh::subdivideFace(PolygonMesh::Index face,const PolygonMesh::SubdivisionIndices& si,PolygonMesh::Edge* newEdges,PolygonMesh::Face* newFaces)
+	{
+	/*********************************************************************
+	Each half-edge h of the face spawns the quadrilateral at its start
+	vertex. The quadrilateral's index is h's dense position p, and its
+	four half-edges 4p+0 to 4p+3 lead from h's start vertex to h's edge
+	point, to the face point, to the edge point of h's predecessor, and
+	back to h's start vertex, respectively.
+	*********************************************************************/
 	
-	/* Delete all vertices: */
-	Vertex* vPtr=vertices;
-	while(vPtr!=0)
+	Index facePoint=si.facePoints[face];
+	Index firstEdge=faces[face].edge;
+	Index edge=firstEdge;
+	do
 		{
-		Vertex* next=vPtr->succ;
-		vPtr->~Vertex();
-		vertexAllocator.free(vPtr);
+		const Edge& e=edges[edge];
+		const Edge& pred=edges[e.facePred];
+		Index quad=si.edgePositions[edge];
+		Index base=quad*4;
+		Edge* qe=newEdges+base;
+		
+		/* Create the half-edge from the corner vertex to the edge point: */
+		qe[0].start=e.start;
+		qe[0].face=quad;
+		qe[0].facePred=base+3;
+		qe[0].faceSucc=base+1;
+		qe[0].opposite=e.opposite!=invalidIndex?si.edgePositions[edges[e.opposite].faceSucc]*4+3:invalidIndex;
+		qe[0].sharpness=e.sharpness>0?e.sharpness-1:e.sharpness;
+		
+		/* Create the half-edge from the edge point to the face point: */
+		qe[1].start=si.edgePoints[edge];
+		qe[1].face=quad;
+		qe[1].facePred=base;
+		qe[1].faceSucc=base+2;
+		qe[1].opposite=si.edgePositions[e.faceSucc]*4+2;
+		qe[1].sharpness=0;
+		
+		/* Create the half-edge from the face point to the predecessor's edge point: */
+		qe[2].start=facePoint;
+		qe[2].face=quad;
+		qe[2].facePred=base+1;
+		qe[2].faceSucc=base+3;
+		qe[2].opposite=si.edgePositions[e.facePred]*4+1;
+		qe[2].sharpness=0;
+		
+		/* Create the half-edge from the predecessor's edge point to the corner vertex: */
+		qe[3].start=si.edgePoints[e.facePred];
+		qe[3].face=quad;
+		qe[3].facePred=base+2;
+		qe[3].faceSucc=base;
+		qe[3].opposite=pred.opposite!=invalidIndex?si.edgePositions[pred.opposite]*4:invalidIndex;
+		qe[3].sharpness=pred.sharpness>0?pred.sharpness-1:pred.sharpness;
 		
-		vPtr=next;
+		newFaces[quad].edge=base;
+		
+		/* Link the edge point to the subdivided mesh from the edge's "dominant" half: */
+		if(e.opposite==invalidIndex||edge<e.opposite)
+			vertices[si.edgePoints[edge]].edge=base+1;
+		
+		edge=e.faceSucc;
 		}
+	while(edge!=firstEdge);
+	
+	/* Link the face point to the subdivided mesh: */
+	vertices[facePoint].edge=si.edgePositions[firstEdge]*4+2;
 	}
 
-PolygonMesh::EdgeHasher* PolygonMesh::startAddingFaces(void)
+PolygonMesh::VertexIterator PolygonMesh::newVertex(const PolygonMesh::Point& p,const PolygonMesh::Color& c)
 	{
-	return new EdgeHasher(101);
+	/* Re-use a deleted vertex or append a new vertex to the vertex array: */
+	++numVertices;
+	Index vertex;
+	if(!freeVertices.empty())
+		{
+		vertex=freeVertices.back();
+		freeVertices.pop_back();
+		vertices[vertex]=Vertex(p,c);
+		vertexValid[vertex]=true;
+		}
+	else
+		{
+		vertex=Index(vertices.size());
+		vertices.push_back(Vertex(p,c));
+		vertexValid.push_back(true);
+		}
+	vertices[vertex].version=version;
+	return VertexIterator(this,vertex);
 	}
 
-PolygonMesh::FaceIterator PolygonMesh::addFace(int numVertices,const PolygonMesh::VertexIterator vertices[],PolygonMesh::EdgeHasher* edgeHasher)
+void PolygonMesh::deleteVertex(const PolygonMesh::VertexIterator& vertexIt)
 	{
-	/* Check whether the given face conforms with the mesh: */
-	for(int i=0;i<numVertices;++i)
+	/* Put the vertex onto the free list: */
+	vertexValid[vertexIt.vertex]=false;
+	vertices[vertexIt.vertex].edge=invalidIndex;
+	freeVertices.push_back(vertexIt.vertex);
+	--numVertices;
+	}
+
+PolygonMesh::EdgeIterator PolygonMesh::newEdge(void)
+	{
+	/* Re-use a deleted edge or append a new edge to the edge array: */
+	++numEdges;
+	Index edge;
+	if(!freeEdges.empty())
 		{
-		/* Look for the current edge in the edge hash table: */
-		Vertex* v1=vertices[i].vertex;
-		Vertex* v2=vertices[(i+1)%numVertices].vertex;
-		EdgeHasher::Iterator ehIt=edgeHasher->findEntry(VertexPair(v1,v2));
-		if(!ehIt.isFinished())
-			{
-			Edge* edge=ehIt->getDest();
-			
-			/* Test if the companion edge already has an opposite: */
-			if(edge->getOpposite()!=0)
-				return FaceIterator(0);
-				// Misc::throwStdErr("PolygonMesh::addFace: Given face would create non-manifold mesh");
-			
-			/* Test if the two edges are properly oriented: */
-			if(edge->getStart()!=v2||edge->getEnd()!=v1)
-				return FaceIterator(0);
-				// Misc::throwStdErr("PolygonMesh::addFace: Given face is oriented wrongly");
-			}
+		edge=freeEdges.back();
+		freeEdges.pop_back();
 		}
-	
-	/* Create the new face without connecting it to neighbours yet: */
-	Face* face=newFace();
-	Edge* firstEdge;
-	Edge* lastEdge=0;
-	for(int i=0;i<numVertices;++i)
+	else
 		{
-		Edge* edge=newEdge();
-		vertices[i]->setEdge(edge);
-		edge->set(vertices[i].vertex,face,lastEdge,0,0);
-		edge->sharpness=0;
-		if(lastEdge!=0)
-			lastEdge->setFaceSucc(edge);
-		else
-			firstEdge=edge;
-		lastEdge=edge;
+		edge=Index(edges.size());
+		edges.push_back(Edge());
 		}
-	lastEdge->setFaceSucc(firstEdge);
-	firstEdge->setFacePred(lastEdge);
-	face->setEdge(firstEdge);
-	
-	/* Walk around the face again and connect it to its neighbours: */
-	lastEdge=firstEdge;
-	do
+	return EdgeIterator(this,edge);
+	}
+
+void PolygonMesh::deleteEdge(const PolygonMesh::EdgeIterator& edgeIt)
+	{
+	/* Put the edge onto the free list: */
+	edges[edgeIt.edge].face=invalidIndex;
+	freeEdges.push_back(edgeIt.edge);
+	--numEdges;
+	}
+
+PolygonMesh::FaceIterator PolygonMesh::newFace(void)
+	{
+	/* Re-use a deleted face or append a new face to the face array: */
+	++numFaces;
+	Index face;
+	if(!freeFaces.empty())
 		{
-		VertexPair vp(*lastEdge);
-		EdgeHasher::Iterator ehIt=edgeHasher->findEntry(vp);
-		if(!ehIt.isFinished())
-			{
-			/* Connect the edge to its companion: */
-			Edge* companion=ehIt->getDest();
-			assert(companion->getOpposite()==0);
-			assert(companion->getEnd()==lastEdge->getStart());
-			lastEdge->setOpposite(companion);
-			companion->setOpposite(lastEdge);
-			// edgeHasher->removeEntry(ehIt);
-			}
-		else
-			{
-			/* Add the edge to the companion table: */
-			edgeHasher->setEntry(EdgeHasher::Entry(vp,lastEdge));
-			}
-		
-		lastEdge=lastEdge->getFaceSucc();
+		face=freeFaces.back();
+		freeFaces.pop_back();
 		}
-	while(lastEdge!=firstEdge);
-	
-	return FaceIterator(face);
+	else
+		{
+		face=Index(faces.size());
+		faces.push_back(Face());
+		}
+	faces[face].edge=invalidIndex;
+	return FaceIterator(this,face);
 	}
 
-PolygonMesh::FaceIterator PolygonMesh::addFace(const std::vector<PolygonMesh::VertexIterator>& vertices,PolygonMesh::EdgeHasher* edgeHasher)
+void PolygonMesh::deleteFace(const PolygonMesh::FaceIterator& faceIt)
+	{
+	/* Put the face onto the free list: */
+	faces[faceIt.face].edge=invalidIndex;
+	freeFaces.push_back(faceIt.face);
+	--numFaces;
+	}
+
+PolygonMesh::PolygonMesh(const PolygonMesh& source)
+	:version(source.version),
+	 numVertices(source.numVertices),vertices(source.vertices),vertexValid(source.vertexValid),freeVertices(source.freeVertices),
+	 numEdges(source.numEdges),edges(source.edges),freeEdges(source.freeEdges),
+	 numFaces(source.numFaces),faces(source.faces),freeFaces(source.freeFaces)
+	{
+	/* Calculate all vertex normal vectors: */
+	for(std::vector<Vertex>::iterator vIt=vertices.begin();vIt!=vertices.end();++vIt)
+		vIt->version=version;
+	updateVertexNormals();
+	}
+
+PolygonMesh::EdgeHasher* PolygonMesh::startAddingFaces(void)
+	{
+	return new EdgeHasher(101);
+	}
+
+PolygonMesh::FaceIterator PolygonMesh::addFace(int numVertices,const PolygonMesh::VertexIterator vertices[],PolygonMesh::EdgeHasher* edgeHasher)
 	{
-	int numVertices=vertices.size();
 	/* Check whether the given face conforms with the mesh: */
 	for(int i=0;i<numVertices;++i)
 		{
 		/* Look for the current edge in the edge hash table: */
-		Vertex* v1=vertices[i].vertex;
-		Vertex* v2=vertices[(i+1)%numVertices].vertex;
+		Index v1=vertices[i].vertex;
+		Index v2=vertices[(i+1)%numVertices].vertex;
 		EdgeHasher::Iterator ehIt=edgeHasher->findEntry(VertexPair(v1,v2));
 		if(!ehIt.isFinished())
 			{
-			Edge* edge=ehIt->getDest();
+			const Edge& edge=edges[ehIt->getDest()];
 			
 			/* Test if the companion edge already has an opposite: */
-			if(edge->getOpposite()!=0)
-				return FaceIterator(0);
+			if(edge.opposite!=invalidIndex)
+				return FaceIterator();
 				// Misc::throwStdErr("PolygonMesh::addFace: Given face would create non-manifold mesh");
 			
 			/* Test if the two edges are properly oriented: */
-			if(edge->getStart()!=v2||edge->getEnd()!=v1)
-				return FaceIterator(0);
+			if(edge.start!=v2||edges[edge.faceSucc].start!=v1)
+				return FaceIterator();
 				// Misc::throwStdErr("PolygonMesh::addFace: Given face is oriented wrongly");
 			}
 		}
 	
 	/* Create the new face without connecting it to neighbours yet: */
-	Face* face=newFace();
-	Edge* firstEdge;
-	Edge* lastEdge=0;
+	FaceIterator face=newFace();
+	EdgeIterator firstEdge;
+	EdgeIterator lastEdge;
 	for(int i=0;i<numVertices;++i)
 		{
-		Edge* edge=newEdge();
-		vertices[i]->setEdge(edge);
-		edge->set(vertices[i].vertex,face,lastEdge,0,0);
+		EdgeIterator edge=newEdge();
+		vertices[i].setEdge(edge);
+		edge->set(vertices[i],face,lastEdge,0,0);
 		edge->sharpness=0;
 		if(lastEdge!=0)
 			lastEdge->setFaceSucc(edge);
@@ -437,12 +652,12 @@ PolygonMesh::FaceIterator PolygonMesh::addFace(const std::vector<PolygonMesh::Ve
 	lastEdge=firstEdge;
 	do
 		{
-		VertexPair vp(*lastEdge);
+		VertexPair vp=lastEdge.getVertexPair();
 		EdgeHasher::Iterator ehIt=edgeHasher->findEntry(vp);
 		if(!ehIt.isFinished())
 			{
 			/* Connect the edge to its companion: */
-			Edge* companion=ehIt->getDest();
+			EdgeIterator companion(this,ehIt->getDest());
 			assert(companion->getOpposite()==0);
 			assert(companion->getEnd()==lastEdge->getStart());
 			lastEdge->setOpposite(companion);
@@ -452,14 +667,19 @@ PolygonMesh::FaceIterator PolygonMesh::addFace(const std::vector<PolygonMesh::Ve
 		else
 			{
 			/* Add the edge to the companion table: */
-			edgeHasher->setEntry(EdgeHasher::Entry(vp,lastEdge));
+			edgeHasher->setEntry(EdgeHasher::Entry(vp,lastEdge.edge));
 			}
 		
 		lastEdge=lastEdge->getFaceSucc();
 		}
 	while(lastEdge!=firstEdge);
 	
-	return FaceIterator(face);
+	return face;
+	}
+
+PolygonMesh::FaceIterator PolygonMesh::addFace(const std::vector<PolygonMesh::VertexIterator>& vertices,PolygonMesh::EdgeHasher* edgeHasher)
+	{
+	return addFace(int(vertices.size()),&vertices[0],edgeHasher);
 	}
 
 void PolygonMesh::setEdgeSharpness(PolygonMesh::VertexIterator v1,PolygonMesh::VertexIterator v2,int sharpness,PolygonMesh::EdgeHasher* edgeHasher)
@@ -467,12 +687,7 @@ void PolygonMesh::setEdgeSharpness(PolygonMesh::VertexIterator v1,PolygonMesh::V
 	/* Find the edge in the mesh: */
 	EdgeHasher::Iterator ehIt=edgeHasher->findEntry(VertexPair(v1.vertex,v2.vertex));
 	if(!ehIt.isFinished())
-		{
-		Edge* edge=ehIt->getDest();
-		edge->sharpness=sharpness;
-		if(edge->getOpposite()!=0)
-			edge->getOpposite()->sharpness=sharpness;
-		}
+		setEdgeSharpness(EdgeIterator(this,ehIt->getDest()),sharpness);
 	else
 		Misc::throwStdErr("PolygonMesh::setEdgeSharpness: Given edge does not exist in mesh");
 	}
@@ -485,38 +700,10 @@ void PolygonMesh::finishAddingFaces(PolygonMesh::EdgeHasher* edgeHasher)
 
 void PolygonMesh::updateVertexNormals(void)
 	{
-	/* Update the normals of all changed vertices: */
-	for(Vertex* vPtr=vertices;vPtr!=0;vPtr=vPtr->succ)
-		if(vPtr->version==version&&vPtr->getEdge()!=0)
-			{
-			/* Calculate the vertex' normal vector: */
-			vPtr->normal=Vector::zero;
-			
-			/* Iterate through vertex' platelet: */
-			const Edge* ve=vPtr->getEdge();
-			do
-				{
-				const Edge* ve2=ve->getFacePred();
-				vPtr->normal+=Geometry::cross(*ve->getEnd()-*vPtr,*ve2->getStart()-*vPtr);
-				
-				/* Go to next edge around vertex: */
-				ve=ve2->getOpposite();
-				}
-			while(ve!=0&&ve!=vPtr->getEdge());
-			
-			if(ve==0) // The vertex' platelet is open
-				{
-				ve=vPtr->getEdge()->getOpposite();
-				while(ve!=0)
-					{
-					const Edge* ve2=ve->getFaceSucc();
-					vPtr->normal+=Geometry::cross(*ve2->getEnd()-*vPtr,*ve->getStart()-*vPtr);
-
-					/* Go to next edge around vertex: */
-					ve=ve2->getOpposite();
-					}
-				}
-			}
+	/* Update the normals of all changed vertices in parallel: */
+	VertexNormalCalculator calculator;
+	calculator.mesh=this;
+	Threads::parallelFor(0,vertices.size(),calculator,1024);
 	}
 
 void PolygonMesh::removeSingularVertex(const PolygonMesh::VertexIterator& vertexIt)
@@ -526,14 +713,14 @@ void PolygonMesh::removeSingularVertex(const PolygonMesh::VertexIterator& vertex
 		return;
 	
 	/* Remove the vertex: */
-	deleteVertex(vertexIt.vertex);
+	deleteVertex(vertexIt);
 	}
 
 void PolygonMesh::removeVertex(const PolygonMesh::VertexIterator& vertexIt)
 	{
 	/* Store all faces from the vertex' platelet: */
-	std::vector<Face*> faces;
-	Edge* edge=vertexIt->getEdge();
+	std::vector<FaceIterator> faces;
+	EdgeIterator edge=vertexIt->getEdge();
 	do
 		{
 		/* Store the current face: */
@@ -548,132 +735,33 @@ void PolygonMesh::removeVertex(const PolygonMesh::VertexIterator& vertexIt)
 			faces.push_back(edge->getFace());
 	
 	/* Remove all faces: */
-	for(std::vector<Face*>::const_iterator fIt=faces.begin();fIt!=faces.end();++fIt)
+	for(std::vector<FaceIterator>::const_iterator fIt=faces.begin();fIt!=faces.end();++fIt)
 		removeFace(*fIt);
 	
 	/* Delete the vertex: */
-	deleteVertex(vertexIt.vertex);
-	}
-
-#if 0
-
-/******************************************************************
-Do not use this function - put in but abandoned and probably broken
-******************************************************************/
-
-PolygonMesh::FaceIterator PolygonMesh::removeVertex(const PolygonMesh::VertexIterator& vertexIt)
-	{
-	if(vertexIt->isInterior())
-		{
-		/* Combine all surrounding faces into a single face: */
-		Face* vertexFace=newFace();
-		Edge* lastEdge=0;
-		Edge* ePtr=vertexIt->getEdge();
-		ePtr->getOpposite()->setOpposite(0);
-		while(ePtr!=0)
-			{
-			/* Re-arrange all face pointers: */
-			Edge* vePtr=ePtr->getFaceSucc();
-			while(vePtr!=ePtr->getFacePred())
-				{
-				vePtr->setFace(vertexFace);
-				vePtr=vePtr->getFaceSucc();
-				}
-			
-			/* Fix up the vertex: */
-			ePtr->getEnd()->setEdge(ePtr->getFaceSucc());
-			
-			/* Delete the outgoing and incoming edges: */
-			Edge* nextEptr=ePtr->getVertexSucc();
-			ePtr->getFaceSucc()->setFacePred(lastEdge);
-			if(lastEdge!=0)
-				lastEdge->setFacePred(ePtr->getFaceSucc());
-			else
-				vertexFace->setEdge(ePtr->getFaceSucc());
-			lastEdge=ePtr->getFacePred()->getFacePred();
-			deleteFace(ePtr->getFace());
-			deleteEdge(ePtr->getFacePred());
-			deleteEdge(ePtr);
-			
-			/* Go to the next face: */
-			ePtr=nextEptr;
-			}
-		
-		/* Close the face loop: */
-		lastEdge->setFaceSucc(vertexFace->getEdge());
-		vertexFace->getEdge()->setFacePred(lastEdge);
-		
-		deleteVertex(vertexIt.vertex);
-		return vertexFace;
-		}
-	else if(vertexIt->getEdge()!=0)
-		{
-		/* Go backwards until border edge is hit: */
-		Edge* ePtr;
-		for(ePtr=vertexIt->getEdge();ePtr->getOpposite()!=0;ePtr=ePtr->getVertexPred())
-			;
-		
-		/* Remove all surrounding faces: */
-		while(ePtr!=0)
-			{
-			Edge* nextEptr=ePtr->getVertexSucc();
-			deleteFace(ePtr->getFace());
-			Edge* fePtr=ePtr;
-			do
-				{
-				Edge* nextFePtr=fePtr->getFaceSucc();
-				
-				/* Fix up the vertex: */
-				if(nextFePtr!=ePtr)
-					{
-					if(nextFePtr->getVertexPred()!=0)
-						nextFePtr->getStart()->setEdge(nextFePtr->getVertexPred());
-					else
-						nextFePtr->getStart()->setEdge(fePtr->getOpposite()->getFacePred());
-					}
-				
-				/* Remove the edge: */
-				if(fePtr->getOpposite()!=0)
-					fePtr->getOpposite()->setOpposite(0);
-				deleteEdge(fePtr);
-				}
-			while(fePtr!=ePtr);
-			
-			ePtr=nextEptr;
-			}
-		
-		deleteVertex(vertexIt.vertex);
-		return FaceIterator(0);
-		}
-	else // Dangling vertex
-		{
-		deleteVertex(vertexIt.vertex);
-		return FaceIterator(0);
-		}
+	deleteVertex(vertexIt);
 	}
 
-#endif
-
 PolygonMesh::FaceIterator PolygonMesh::vertexToFace(const PolygonMesh::VertexIterator& vertexIt)
 	{
 	/* Remove solitary vertices: */
 	if(vertexIt->getEdge()==0)
 		{
-		deleteVertex(vertexIt.vertex);
-		return FaceIterator(0);
+		deleteVertex(vertexIt);
+		return FaceIterator();
 		}
 	
 	/* Walk around the vertex and flip its edges: */
-	Face* vertexFace=newFace();
-	Edge* lastEdge=0;
-	Edge* ePtr=vertexIt->getEdge();
+	FaceIterator vertexFace=newFace();
+	EdgeIterator lastEdge;
+	EdgeIterator ePtr=vertexIt->getEdge();
 	do
 		{
-		Edge* nextEdge=ePtr->getFacePred()->getOpposite();
+		EdgeIterator nextEdge=ePtr->getFacePred()->getOpposite();
 		
 		/* Remove the edge from its current face and add it to the vertex face: */
-		Edge* pred=ePtr->getFacePred();
-		Edge* succ=ePtr->getFaceSucc();
+		EdgeIterator pred=ePtr->getFacePred();
+		EdgeIterator succ=ePtr->getFaceSucc();
 		
 		/* Test for the dangerous special case of a triangle: */
 		if(succ->getFaceSucc()==pred)
@@ -695,9 +783,9 @@ PolygonMesh::FaceIterator PolygonMesh::vertexToFace(const PolygonMesh::VertexIte
 			pred->setOpposite(ePtr);
 			ePtr->sharpness=pred->sharpness=0;
 			pred->getFace()->setEdge(pred);
-
+			
 			#ifndef NDEBUG
-			pred->getFace()->checkFace();
+			checkFace(pred->getFace().face);
 			#endif
 			}
 		
@@ -706,7 +794,7 @@ PolygonMesh::FaceIterator PolygonMesh::vertexToFace(const PolygonMesh::VertexIte
 			lastEdge->setFaceSucc(ePtr);
 			
 			#ifndef NDEBUG
-			ePtr->getStart()->checkVertex();
+			checkVertex(ePtr->getStart().vertex);
 			#endif
 			}
 		else
@@ -720,34 +808,25 @@ PolygonMesh::FaceIterator PolygonMesh::vertexToFace(const PolygonMesh::VertexIte
 	vertexFace->getEdge()->setFacePred(lastEdge);
 	
 	#ifndef NDEBUG
-	ePtr->getStart()->checkVertex();
-	vertexFace->checkFace();
+	checkVertex(ePtr->getStart().vertex);
+	checkFace(vertexFace.face);
 	#endif
 	
 	/* Delete the vertex and return the new face: */
 	vertexIt->setEdge(0);
-	deleteVertex(vertexIt.vertex);
+	deleteVertex(vertexIt);
 	
-	return FaceIterator(vertexFace);
+	return vertexFace;
 	}
 
-PolygonMesh::VertexIterator PolygonMesh::splitEdge(const PolygonMesh::EdgeIterator& edgeIt,PolygonMesh::Vertex* edgePoint)
+PolygonMesh::VertexIterator PolygonMesh::splitEdge(const PolygonMesh::EdgeIterator& edgeIt,const PolygonMesh::VertexIterator& edgePoint)
 	{
-	/* Link vertex to mesh: */
-	edgePoint->pred=lastVertex;
-	edgePoint->succ=0;
-	if(lastVertex!=0)
-		lastVertex->succ=edgePoint;
-	else
-		vertices=edgePoint;
-	lastVertex=edgePoint;
-	
-	Edge* edge1=edgeIt.edge;
-	Vertex* vertex1=edge1->getStart();
-	Edge* edge2=edge1->getOpposite();
-	Vertex* vertex2=edge2->getStart();
-	Edge* edge3=newEdge();
-	Edge* edge4=newEdge();
+	EdgeIterator edge1(this,edgeIt.edge);
+	VertexIterator vertex1=edge1->getStart();
+	EdgeIterator edge2=edge1->getOpposite();
+	VertexIterator vertex2=edge2->getStart();
+	EdgeIterator edge3=newEdge();
+	EdgeIterator edge4=newEdge();
 	
 	/* Split edge1 and edge2: */
 	edgePoint->setEdge(edge3);
@@ -763,29 +842,29 @@ PolygonMesh::VertexIterator PolygonMesh::splitEdge(const PolygonMesh::EdgeIterat
 	edge4->getFaceSucc()->setFacePred(edge4);
 	
 	#ifndef NDEBUG
-	vertex1->checkVertex();
-	vertex2->checkVertex();
-	edgePoint->checkVertex();
-	edge1->getFace()->checkFace();
-	edge2->getFace()->checkFace();
+	checkVertex(vertex1.vertex);
+	checkVertex(vertex2.vertex);
+	checkVertex(edgePoint.vertex);
+	checkFace(edge1->getFace().face);
+	checkFace(edge2->getFace().face);
 	#endif
 	
-	return VertexIterator(edgePoint);
+	return edgePoint;
 	}
 
 void PolygonMesh::rotateEdge(const PolygonMesh::EdgeIterator& edgeIt)
 	{
 	/* Collect environment of the edge to rotate: */
-	Edge* edge1=edgeIt.edge;
-	Vertex* vertex1=edge1->getStart();
-	Face* face1=edge1->getFace();
-	Edge* edge3=edge1->getFacePred();
-	Edge* edge4=edge1->getFaceSucc();
-	Edge* edge2=edge1->getOpposite();
-	Vertex* vertex2=edge2->getStart();
-	Face* face2=edge2->getFace();
-	Edge* edge5=edge2->getFacePred();
-	Edge* edge6=edge2->getFaceSucc();
+	EdgeIterator edge1(this,edgeIt.edge);
+	VertexIterator vertex1=edge1->getStart();
+	FaceIterator face1=edge1->getFace();
+	EdgeIterator edge3=edge1->getFacePred();
+	EdgeIterator edge4=edge1->getFaceSucc();
+	EdgeIterator edge2=edge1->getOpposite();
+	VertexIterator vertex2=edge2->getStart();
+	FaceIterator face2=edge2->getFace();
+	EdgeIterator edge5=edge2->getFacePred();
+	EdgeIterator edge6=edge2->getFaceSucc();
 	
 	/* Rotate the edge: */
 	vertex1->setEdge(edge6);
@@ -802,36 +881,37 @@ void PolygonMesh::rotateEdge(const PolygonMesh::EdgeIterator& edgeIt)
 
 PolygonMesh::FaceIterator PolygonMesh::removeEdge(const PolygonMesh::EdgeIterator& edgeIt)
 	{
-	Edge* edge2=edgeIt->getOpposite();
+	EdgeIterator edge1(this,edgeIt.edge);
+	EdgeIterator edge2=edge1->getOpposite();
 	if(edge2!=0)
 		{
 		/* Have all edges of the second face point to the first instead: */
-		Face* newFace=edgeIt->getFace();
-		for(Edge* ePtr=edge2->getFaceSucc();ePtr!=edge2;ePtr=ePtr->getFaceSucc())
+		FaceIterator newFace=edge1->getFace();
+		for(EdgeIterator ePtr=edge2->getFaceSucc();ePtr!=edge2;ePtr=ePtr->getFaceSucc())
 			ePtr->setFace(newFace);
 		
 		/* Fix up the edge's start vertex: */
-		edgeIt->getFacePred()->setFaceSucc(edge2->getFaceSucc());
-		edge2->getFaceSucc()->setFacePred(edgeIt->getFacePred());
-		edgeIt->getStart()->setEdge(edge2->getFaceSucc());
+		edge1->getFacePred()->setFaceSucc(edge2->getFaceSucc());
+		edge2->getFaceSucc()->setFacePred(edge1->getFacePred());
+		edge1->getStart()->setEdge(edge2->getFaceSucc());
 		
 		/* Fix up the edge's end vertex: */
-		edgeIt->getFaceSucc()->setFacePred(edge2->getFacePred());
-		edge2->getFacePred()->setFaceSucc(edgeIt->getFaceSucc());
-		edge2->getStart()->setEdge(edgeIt->getFaceSucc());
+		edge1->getFaceSucc()->setFacePred(edge2->getFacePred());
+		edge2->getFacePred()->setFaceSucc(edge1->getFaceSucc());
+		edge2->getStart()->setEdge(edge1->getFaceSucc());
 		
 		/* Remove the edge and the second face: */
-		newFace->setEdge(edgeIt->getFaceSucc());
+		newFace->setEdge(edge1->getFaceSucc());
 		deleteFace(edge2->getFace());
-		deleteEdge(edgeIt.edge);
+		deleteEdge(edge1);
 		deleteEdge(edge2);
 		
-		return FaceIterator(newFace);
+		return newFace;
 		}
 	else
 		{
 		/* Fix up all vertices around the face: */
-		Edge* ePtr=edgeIt.edge;
+		EdgeIterator ePtr=edge1;
 		do
 			{
 			/* Fix up the edge's start vertex: */
@@ -843,31 +923,30 @@ PolygonMesh::FaceIterator PolygonMesh::removeEdge(const PolygonMesh::EdgeIterato
 			/* Go to the next edge: */
 			ePtr=ePtr->getFaceSucc();
 			}
-		while(ePtr!=edgeIt.edge);
+		while(ePtr!=edge1);
 		
 		/* Delete the face: */
 		deleteFace(ePtr->getFace());
 		
 		/* Delete all edges: */
-		ePtr=edgeIt.edge;
 		ePtr->getFacePred()->setFaceSucc(0);
 		while(ePtr!=0)
 			{
-			Edge* next=ePtr->getFaceSucc();
+			EdgeIterator next=ePtr->getFaceSucc();
 			deleteEdge(ePtr);
 			ePtr=next;
 			}
 		
-		return FaceIterator(0);
+		return FaceIterator();
 		}
 	}
 
 void PolygonMesh::removeFace(const PolygonMesh::FaceIterator& fIt)
 	{
-	Edge* fe;
+	EdgeIterator firstEdge=fIt->getEdge();
+	EdgeIterator fe=firstEdge;
 	
 	/* Fix the edge pointers of the face's vertices: */
-	fe=fIt->getEdge();
 	do
 		{
 		if(fe->getOpposite()!=0)
@@ -877,7 +956,7 @@ void PolygonMesh::removeFace(const PolygonMesh::FaceIterator& fIt)
 		
 		fe=fe->getFaceSucc();
 		}
-	while(fe!=fIt->getEdge());
+	while(fe!=firstEdge);
 	
 	/* Unlink the face's edges from their opposites: */
 	do
@@ -887,45 +966,45 @@ void PolygonMesh::removeFace(const PolygonMesh::FaceIterator& fIt)
 		
 		fe=fe->getFaceSucc();
 		}
-	while(fe!=fIt->getEdge());
+	while(fe!=firstEdge);
 	
 	/* Delete the face's edges: */
 	do
 		{
-		Edge* fe2=fe->getFaceSucc();
+		EdgeIterator fe2=fe->getFaceSucc();
 		
 		deleteEdge(fe);
 		
 		fe=fe2;
 		}
-	while(fe!=fIt->getEdge());
+	while(fe!=firstEdge);
 	
 	/* Delete the face: */
-	deleteFace(&(*fIt));
+	deleteFace(fIt);
 	}
 
 void PolygonMesh::triangulateFace(const PolygonMesh::FaceIterator& fIt)
 	{
 	/* Set up an initial triangle at the face's base point: */
-	Face* f=&(*fIt);
-	Edge* e1=f->getEdge();
-	Vertex* v0=e1->getStart();
+	FaceIterator f(this,fIt.face);
+	EdgeIterator e1=f->getEdge();
+	VertexIterator v0=e1->getStart();
 	v0->version=version;
-	Edge* e2=e1->getFaceSucc();
-	Vertex* v1=e2->getStart();
+	EdgeIterator e2=e1->getFaceSucc();
+	VertexIterator v1=e2->getStart();
 	v1->version=version;
-	Edge* e3=e2->getFaceSucc();
-	Vertex* v2=e3->getStart();
+	EdgeIterator e3=e2->getFaceSucc();
+	VertexIterator v2=e3->getStart();
 	v2->version=version;
-	Edge* lastEdge=e1->getFacePred();
+	EdgeIterator lastEdge=e1->getFacePred();
 	
 	/* Walk around face: */
 	while(e3!=lastEdge)
 		{
 		/* Chop triangle (v0,v1,v2) off face: */
-		Edge* ne1=newEdge();
-		Edge* ne2=newEdge();
-		Face* nf=newFace();
+		EdgeIterator ne1=newEdge();
+		EdgeIterator ne2=newEdge();
+		FaceIterator nf=newFace();
 		nf->setEdge(e1);
 		e1->setFace(nf);
 		e1->setFacePred(ne1);
@@ -955,33 +1034,25 @@ PolygonMesh::EdgeIterator PolygonMesh::splitFace(const PolygonMesh::VertexIterat
 	{
 	/* Find the face sharing both vertices: */
 	
+	return EdgeIterator();
 	}
 
-PolygonMesh::VertexIterator PolygonMesh::splitFace(const PolygonMesh::FaceIterator& faceIt,PolygonMesh::Vertex* facePoint)
+PolygonMesh::VertexIterator PolygonMesh::splitFace(const PolygonMesh::FaceIterator& faceIt,const PolygonMesh::VertexIterator& facePoint)
 	{
-	/* Link the face point to the mesh: */
-	facePoint->pred=lastVertex;
-	facePoint->succ=0;
-	if(lastVertex!=0)
-		lastVertex->succ=facePoint;
-	else
-		vertices=facePoint;
-	lastVertex=facePoint;
-
 	/* Create a fan of triangles around the face point: */
-	Edge* firstOuterEdge=faceIt->getEdge();
-	deleteFace(faceIt.face);
-	Edge* outerEdge=firstOuterEdge;
-	Edge* firstInnerEdge;
-	Edge* lastInnerEdge=0;
+	EdgeIterator firstOuterEdge=faceIt->getEdge();
+	deleteFace(faceIt);
+	EdgeIterator outerEdge=firstOuterEdge;
+	EdgeIterator firstInnerEdge;
+	EdgeIterator lastInnerEdge;
 	do
 		{
-		Edge* nextOuterEdge=outerEdge->getFaceSucc();
+		EdgeIterator nextOuterEdge=outerEdge->getFaceSucc();
 		
 		/* Create a new triangle: */
-		Face* triangle=newFace();
-		Edge* innerEdge1=newEdge();
-		Edge* innerEdge2=newEdge();
+		FaceIterator triangle=newFace();
+		EdgeIterator innerEdge1=newEdge();
+		EdgeIterator innerEdge2=newEdge();
 		facePoint->setEdge(innerEdge1);
 		innerEdge1->set(facePoint,triangle,innerEdge2,outerEdge,lastInnerEdge);
 		innerEdge1->sharpness=0;
@@ -997,7 +1068,7 @@ PolygonMesh::VertexIterator PolygonMesh::splitFace(const PolygonMesh::FaceIterat
 		triangle->setEdge(outerEdge);
 		
 		#ifndef NDEBUG
-		triangle->checkFace();
+		checkFace(triangle.face);
 		#endif
 		
 		lastInnerEdge=innerEdge2;
@@ -1010,39 +1081,30 @@ PolygonMesh::VertexIterator PolygonMesh::splitFace(const PolygonMesh::FaceIterat
 	firstInnerEdge->setOpposite(lastInnerEdge);
 	
 	#ifndef NDEBUG
-	facePoint->checkVertex();
+	checkVertex(facePoint.vertex);
 	#endif
 	
-	return VertexIterator(facePoint);
+	return facePoint;
 	}
 
-PolygonMesh::VertexIterator PolygonMesh::splitFaceCatmullClark(const PolygonMesh::FaceIterator& faceIt,PolygonMesh::Vertex* facePoint)
+PolygonMesh::VertexIterator PolygonMesh::splitFaceCatmullClark(const PolygonMesh::FaceIterator& faceIt,const PolygonMesh::VertexIterator& facePoint)
 	{
 	assert(faceIt->getNumEdges()%2==0);
 	
-	/* Link the face point to the mesh: */
-	facePoint->pred=lastVertex;
-	facePoint->succ=0;
-	if(lastVertex!=0)
-		lastVertex->succ=facePoint;
-	else
-		vertices=facePoint;
-	lastVertex=facePoint;
-	
 	/* Create a fan of quadrilaterals around the face point: */
-	Edge* firstOuterEdge=faceIt->getEdge()->getFaceSucc();
-	deleteFace(faceIt.face);
-	Edge* outerEdge=firstOuterEdge;
-	Edge* firstInnerEdge;
-	Edge* lastInnerEdge=0;
+	EdgeIterator firstOuterEdge=faceIt->getEdge()->getFaceSucc();
+	deleteFace(faceIt);
+	EdgeIterator outerEdge=firstOuterEdge;
+	EdgeIterator firstInnerEdge;
+	EdgeIterator lastInnerEdge;
 	do
 		{
-		Edge* nextOuterEdge=outerEdge->getFaceSucc()->getFaceSucc();
+		EdgeIterator nextOuterEdge=outerEdge->getFaceSucc()->getFaceSucc();
 		
 		/* Create a new quadrilateral: */
-		Face* quad=newFace();
-		Edge* innerEdge1=newEdge();
-		Edge* innerEdge2=newEdge();
+		FaceIterator quad=newFace();
+		EdgeIterator innerEdge1=newEdge();
+		EdgeIterator innerEdge2=newEdge();
 		facePoint->setEdge(innerEdge1);
 		innerEdge1->set(facePoint,quad,innerEdge2,outerEdge,lastInnerEdge);
 		innerEdge1->sharpness=0;
@@ -1060,7 +1122,7 @@ PolygonMesh::VertexIterator PolygonMesh::splitFaceCatmullClark(const PolygonMesh
 		quad->setEdge(innerEdge1);
 		
 		#ifndef NDEBUG
-		quad->checkFace();
+		checkFace(quad.face);
 		#endif
 		
 		lastInnerEdge=innerEdge2;
@@ -1073,10 +1135,10 @@ PolygonMesh::VertexIterator PolygonMesh::splitFaceCatmullClark(const PolygonMesh
 	firstInnerEdge->setOpposite(lastInnerEdge);
 	
 	#ifndef NDEBUG
-	facePoint->checkVertex();
+	checkVertex(facePoint.vertex);
 	#endif
 	
-	return VertexIterator(facePoint);
+	return facePoint;
 	}
 
 PolygonMesh::FaceIterator PolygonMesh::splitFaceDooSabin(const PolygonMesh::FaceIterator& faceIt)
@@ -1085,14 +1147,14 @@ PolygonMesh::FaceIterator PolygonMesh::splitFaceDooSabin(const PolygonMesh::Face
 	VertexCombiner centroidC;
 	int numVertices=0;
 	for(FaceEdgeIterator feIt=faceIt.beginEdges();feIt!=faceIt.endEdges();++feIt,++numVertices)
-		centroidC.addVertex(feIt->getStart());
+		centroidC.addVertex(*feIt->getStart());
 	Point centroid=centroidC.getPoint();
 	Color centroidColor=centroidC.getColor();
 	
 	/* Walk around the face again and create the inner face: */
-	Face* innerFace=newFace();
-	Edge* lastInnerEdge=0;
-	Edge* outerEdge=faceIt->getEdge();
+	FaceIterator innerFace=newFace();
+	EdgeIterator lastInnerEdge;
+	EdgeIterator outerEdge=faceIt->getEdge();
 	for(int i=0;i<numVertices;++i,outerEdge=outerEdge->getFaceSucc())
 		{
 		/* Create a new vertex and a new edge: */
@@ -1100,8 +1162,8 @@ PolygonMesh::FaceIterator PolygonMesh::splitFaceDooSabin(const PolygonMesh::Face
 		Color newColor;
 		for(int i=0;i<4;++i)
 			newColor[i]=GLubyte(Math::floor((centroidColor[i]+GLfloat(outerEdge->getStart()->color[i]))*0.5f+0.5f));
-		Vertex* newV=newVertex(newPoint,newColor);
-		Edge* newE=newEdge();
+		VertexIterator newV=newVertex(newPoint,newColor);
+		EdgeIterator newE=newEdge();
 		newV->setEdge(newE);
 		newE->set(newV,innerFace,lastInnerEdge,0,0);
 		newE->sharpness=0;
@@ -1115,20 +1177,20 @@ PolygonMesh::FaceIterator PolygonMesh::splitFaceDooSabin(const PolygonMesh::Face
 	innerFace->getEdge()->setFacePred(lastInnerEdge);
 	
 	/* Walk around the face again and create one quad face for each edge: */
-	Edge* innerEdge=innerFace->getEdge();
+	EdgeIterator innerEdge=innerFace->getEdge();
 	outerEdge=faceIt->getEdge();
-	Edge* lastCrossEdge=0;
-	Edge* firstCrossEdge;
+	EdgeIterator lastCrossEdge;
+	EdgeIterator firstCrossEdge;
 	for(int i=0;i<numVertices;++i,innerEdge=innerEdge->getFaceSucc())
 		{
-		Edge* nextOuterEdge=outerEdge->getFaceSucc();
+		EdgeIterator nextOuterEdge=outerEdge->getFaceSucc();
 		
 		/* Create a new face and three new edges: */
-		Face* quad=newFace();
+		FaceIterator quad=newFace();
 		quad->setEdge(outerEdge);
-		Edge* e1=newEdge();
-		Edge* e2=newEdge();
-		Edge* e3=newEdge();
+		EdgeIterator e1=newEdge();
+		EdgeIterator e2=newEdge();
+		EdgeIterator e3=newEdge();
 		e1->set(innerEdge->getEnd(),quad,e3,e2,innerEdge);
 		e1->sharpness=0;
 		innerEdge->setOpposite(e1);
@@ -1149,18 +1211,114 @@ PolygonMesh::FaceIterator PolygonMesh::splitFaceDooSabin(const PolygonMesh::Face
 	firstCrossEdge->setOpposite(lastCrossEdge);
 	
 	/* Delete the old face and return the inner one: */
-	deleteFace(faceIt.face);
+	deleteFace(faceIt);
+	
+	return innerFace;
+	}
+
+void PolygonMesh::subdivideCatmullClark(unsigned int maxNumThreads)
+	{
+	if(numFaces==0)
+		return;
+	
+	/* Collect all existing faces and assign their face points: */
+	SubdivisionIndices si;
+	si.faces.reserve(numFaces);
+	si.facePoints.resize(faces.size(),invalidIndex);
+	Index nextVertex=Index(vertices.size());
+	for(Index face=0;face<faces.size();++face)
+		if(faces[face].edge!=invalidIndex)
+			{
+			si.faces.push_back(face);
+			si.facePoints[face]=nextVertex;
+			++nextVertex;
+			}
+	size_t numOldFaces=si.faces.size();
+	
+	/* Assign each half-edge its position in face order: */
+	si.faceEdgeBases.resize(numOldFaces+1);
+	si.faceEdgeBases[0]=0;
+	FaceEdgeCounter counter;
+	counter.mesh=this;
+	counter.si=&si;
+	Threads::parallelFor(0,numOldFaces,counter,1024,maxNumThreads);
+	for(size_t i=0;i<numOldFaces;++i)
+		si.faceEdgeBases[i+1]+=si.faceEdgeBases[i];
+	size_t numOldEdges=si.faceEdgeBases[numOldFaces];
+	si.edgePositions.resize(edges.size(),invalidIndex);
+	FaceEdgeEnumerator enumerator;
+	enumerator.mesh=this;
+	enumerator.si=&si;
+	Threads::parallelFor(0,numOldFaces,enumerator,1024,maxNumThreads);
+	
+	/* Assign an edge point to each pair of half-edges: */
+	si.edgePoints.resize(edges.size(),invalidIndex);
+	for(Index edge=0;edge<edges.size();++edge)
+		{
+		const Edge& e=edges[edge];
+		if(e.face!=invalidIndex&&(e.opposite==invalidIndex||edge<e.opposite))
+			{
+			si.edgePoints[edge]=nextVertex;
+			if(e.opposite!=invalidIndex)
+				si.edgePoints[e.opposite]=nextVertex;
+			++nextVertex;
+			}
+		}
+	
+	/* Create the face points and edge points: */
+	numVertices+=int(nextVertex-vertices.size());
+	size_t numOldVertices=vertices.size();
+	vertices.resize(nextVertex);
+	vertexValid.resize(nextVertex,true);
+	
+	/* Calculate the face points and edge midpoints from the original vertices: */
+	FacePointCalculator fpc;
+	fpc.mesh=this;
+	fpc.si=&si;
+	Threads::parallelFor(0,numOldFaces,fpc,1024,maxNumThreads);
+	EdgeMidpointCalculator emc;
+	emc.mesh=this;
+	emc.si=&si;
+	Threads::parallelFor(0,numOldFaces,emc,1024,maxNumThreads);
+	
+	/* Move the original vertices to their vertex points: */
+	VertexPointCalculator vpc;
+	vpc.mesh=this;
+	vpc.si=&si;
+	Threads::parallelFor(0,numOldVertices,vpc,1024,maxNumThreads);
+	
+	/* Move the edge midpoints to their edge points: */
+	EdgePointCalculator epc;
+	epc.mesh=this;
+	epc.si=&si;
+	Threads::parallelFor(0,numOldFaces,epc,1024,maxNumThreads);
+	
+	/* Split all faces into quadrilaterals: */
+	std::vector<Edge> newEdges(numOldEdges*4);
+	std::vector<Face> newFaces(numOldEdges);
+	FaceSubdivider subdivider;
+	subdivider.mesh=this;
+	subdivider.si=&si;
+	subdivider.newEdges=&newEdges[0];
+	subdivider.newFaces=&newFaces[0];
+	Threads::parallelFor(0,numOldFaces,subdivider,1024,maxNumThreads);
 	
-	return FaceIterator(innerFace);
+	/* Replace the mesh's half-edges and faces: */
+	edges.swap(newEdges);
+	freeEdges.clear();
+	numEdges=int(edges.size());
+	faces.swap(newFaces);
+	freeFaces.clear();
+	numFaces=int(faces.size());
 	}
 
 void PolygonMesh::checkMesh(void) const
 	{
 	/* Check all vertices: */
-	for(const Vertex* vPtr=vertices;vPtr!=0;vPtr=vPtr->succ)
-		vPtr->checkVertex();
+	for(Index vertex=findVertex(0);vertex!=invalidIndex;vertex=findVertex(vertex+1))
+		checkVertex(vertex);
 	
 	/* Check all faces: */
-	for(const Face* fPtr=faces;fPtr!=0;fPtr=fPtr->succ)
-		fPtr->checkFace();
+	for(Index face=findFace(0);face!=invalidIndex;face=findFace(face+1))
+		checkFace(face);
 	}
@@ -1,15 +1,16 @@
 /***********************************************************************
 PolygonMesh - Class providing the infrastructure for algorithms working
 on meshes of convex polygons
-Copyright (c) 2001-2005 Oliver Kreylos
+Copyright (c) 2001-2011 Oliver Kreylos
 ***********************************************************************/
 
 #ifndef POLYGONMESH_INCLUDED
 #define POLYGONMESH_INCLUDED
 
 #include <vector>
-#include <Misc/PoolAllocator.h>
+#include <Misc/SizedTypes.h>
 #include <Misc/HashTable.h>
+#include <Math/Math.h>
 #include <Geometry/Point.h>
 #include <Geometry/Vector.h>
 #include <GL/gl.h>
@@ -24,6 +25,8 @@ class PolygonMesh
 	typedef Geometry::Point<Scalar,dimension> Point;
 	typedef Geometry::Vector<Scalar,dimension> Vector;
 	typedef GLColor<GLubyte,4> Color;
+	typedef Misc::UInt32 Index; // Type for indices of vertices, half-edges, and faces
+	static const Index invalidIndex=0xffffffffU; // Index denoting a non-existing vertex, half-edge, or face
 	
 	/* Forward declarations: */
 	class Vertex;
@@ -39,12 +42,30 @@ class PolygonMesh
 	class ConstFaceIterator;
 	class FaceEdgeIterator;
 	class ConstFaceEdgeIterator;
+	class VertexProxy;
+	class ConstVertexProxy;
+	class EdgeProxy;
+	class ConstEdgeProxy;
+	struct NullElement; // Incomplete type to construct invalid iterators from null pointer constants
+	
+	friend class EdgeIterator;
+	friend class ConstEdgeIterator;
+	friend class VertexIterator;
+	friend class ConstVertexIterator;
+	friend class VertexEdgeIterator;
+	friend class ConstVertexEdgeIterator;
+	friend class FaceIterator;
+	friend class ConstFaceIterator;
+	friend class FaceEdgeIterator;
+	friend class ConstFaceEdgeIterator;
 	
 	class Vertex:public Point // Basic data structure for representing mesh vertices
 		{
+		friend class PolygonMesh;
 		friend class VertexIterator;
 		friend class ConstVertexIterator;
-		friend class PolygonMesh;
+		friend class VertexEdgeIterator;
+		friend class ConstVertexEdgeIterator;
 		
 		/* Elements: */
 		public:
@@ -52,43 +73,24 @@ class PolygonMesh
 		Color color; // Vertex color
 		Vector normal; // Vertex normal vector
 		private:
-		Edge* edge; // Pointer to one half-edge starting at the vertex
-		/* Pointers to form a double-linked list: */
-		Vertex* pred;
-		Vertex* succ;
+		Index edge; // Index of one half-edge starting at the vertex
 		
 		/* Constructors and destructors: */
-		Vertex(const Point& sPoint,const Color& sColor,Vertex* sSucc) // Constructs vertex from a point and a color
-			:Point(sPoint),color(sColor),
-			 edge(0),pred(0),succ(sSucc)
+		public:
+		Vertex(void) // Creates uninitialized vertex
+			{
+			};
+		Vertex(const Point& sPoint,const Color& sColor) // Constructs vertex from a point and a color
+			:Point(sPoint),version(0),color(sColor),
+			 edge(invalidIndex)
 			{
 			};
 		
 		/* Methods: */
-		public:
 		void setPoint(const Point& sPoint)
 			{
 			Point::operator=(sPoint);
 			};
-		const Edge* getEdge(void) const
-			{
-			return edge;
-			};
-		Edge* getEdge(void)
-			{
-			return edge;
-			};
-		void setEdge(Edge* sEdge)
-			{
-			edge=sEdge;
-			};
-		int getNumEdges(void) const;
-		Vertex* getSucc(void)
-			{
-			return succ;
-			};
-		bool isInterior(void) const; // Checks if the vertex is completely surrounded by faces
-		void checkVertex(void) const;
 		};
 	
 	class VertexCombiner // Class to calculate affine combinations of mesh vertices
@@ -134,21 +136,21 @@ class PolygonMesh
 			weightSum=0.0f;
 			return *this;
 			};
-		VertexCombiner& addVertex(const Vertex* vPtr) // Adds vertex with affine weight 1
+		VertexCombiner& addVertex(const Vertex& v) // Adds vertex with affine weight 1
 			{
 			for(int i=0;i<3;++i)
-				pointSum[i]+=(*vPtr)[i];
+				pointSum[i]+=v[i];
 			for(int i=0;i<4;++i)
-				colorSum[i]+=float(vPtr->color[i]);
+				colorSum[i]+=float(v.color[i]);
 			weightSum+=1.0f;
 			return *this;
 			};
-		VertexCombiner& addVertex(const Vertex* vPtr,float weight) // Adds vertex with given affine weight
+		VertexCombiner& addVertex(const Vertex& v,float weight) // Adds vertex with given affine weight
 			{
 			for(int i=0;i<3;++i)
-				pointSum[i]+=(*vPtr)[i]*weight;
+				pointSum[i]+=v[i]*weight;
 			for(int i=0;i<4;++i)
-				colorSum[i]+=float(vPtr->color[i])*weight;
+				colorSum[i]+=float(v.color[i])*weight;
 			weightSum+=weight;
 			return *this;
 			};
@@ -156,127 +158,19 @@ class PolygonMesh
 	
 	class Edge // Basic data structure for representing vertices, edges and polygons and their adjacency
 		{
+		friend class PolygonMesh;
+		friend class EdgeIterator;
+		friend class ConstEdgeIterator;
+		
 		/* Elements: */
 		private:
-		Vertex* start; // Pointer to start vertex of half-edge
-		Face* face; // Pointer to face
-		Edge* facePred; // Pointer to next half-edge in clockwise order around a face
-		Edge* faceSucc; // Pointer to next half-edge in counter-clockwise order around a face
-		Edge* opposite; // Pointer to opposite half-edge in adjacent polygon
+		Index start; // Index of start vertex of half-edge
+		Index face; // Index of face; invalidIndex if the half-edge was deleted
+		Index facePred; // Index of next half-edge in clockwise order around a face
+		Index faceSucc; // Index of next half-edge in counter-clockwise order around a face
+		Index opposite; // Index of opposite half-edge in adjacent polygon; invalidIndex on the boundary
 		public:
 		int sharpness; // Sharpness coefficient of edge for Catmull-Clark subdivision
-		Vertex* edgePoint; // Pointer to edge point for Catmull-Clark subdivision
-		
-		/* Access methods: */
-		public:
-		const Vertex* getStart(void) const
-			{
-			return start;
-			};
-		Vertex* getStart(void)
-			{
-			return start;
-			};
-		const Vertex* getEnd(void) const // Returns end point of half-edge
-			{
-			return faceSucc->start;
-			};
-		Vertex* getEnd(void) // Ditto
-			{
-			return faceSucc->start;
-			};
-		const Face* getFace(void) const
-			{
-			return face;
-			};
-		Face* getFace(void)
-			{
-			return face;
-			};
-		const Edge* getFacePred(void) const
-			{
-			return facePred;
-			};
-		Edge* getFacePred(void)
-			{
-			return facePred;
-			};
-		const Edge* getFaceSucc(void) const
-			{
-			return faceSucc;
-			};
-		Edge* getFaceSucc(void)
-			{
-			return faceSucc;
-			};
-		const Edge* getVertexPred(void) const // Returns next half-edge around vertex in clockwise order, 0 if doesn't exist
-			{
-			return opposite!=0?opposite->faceSucc:0;
-			};
-		Edge* getVertexPred(void) // Ditto
-			{
-			return opposite!=0?opposite->faceSucc:0;
-			};
-		const Edge* getVertexSucc(void) const // Returns next half-edge around vertex in counter-clockwise order, 0 if doesn't exist
-			{
-			return facePred->opposite;
-			};
-		Edge* getVertexSucc(void) // Ditto
-			{
-			return facePred->opposite;
-			};
-		const Edge* getEndVertexPred(void) const // Returns next half-edge around edge end vertex in clockwise order, 0 if doesn't exist
-			{
-			return faceSucc->opposite;
-			};
-		Edge* getEndVertexPred(void) // Ditto
-			{
-			return faceSucc->opposite;
-			};
-		const Edge* getEndVertexSucc(void) const // Returns next half-edge around edge end vertex in counter-clockwise order, 0 if doesn't exist
-			{
-			return opposite!=0?opposite->facePred:0;
-			};
-		Edge* getEndVertexSucc(void) // Ditto
-			{
-			return opposite!=0?opposite->facePred:0;
-			};
-		const Edge* getOpposite(void) const
-			{
-			return opposite;
-			};
-		Edge* getOpposite(void)
-			{
-			return opposite;
-			};
-		void set(Vertex* sStart,Face* sFace,Edge* sFacePred,Edge* sFaceSucc,Edge* sOpposite)
-			{
-			start=sStart;
-			face=sFace;
-			facePred=sFacePred;
-			faceSucc=sFaceSucc;
-			opposite=sOpposite;
-			};
-		void setStart(Vertex* sStart)
-			{
-			start=sStart;
-			};
-		void setFace(Face* sFace)
-			{
-			face=sFace;
-			};
-		void setFacePred(Edge* sFacePred)
-			{
-			facePred=sFacePred;
-			};
-		void setFaceSucc(Edge* sFaceSucc)
-			{
-			faceSucc=sFaceSucc;
-			};
-		void setOpposite(Edge* sOpposite)
-			{
-			opposite=sOpposite;
-			};
 		};
 	
 	class VertexPair // Helper structure for creating polygon meshes
@@ -285,16 +179,16 @@ class PolygonMesh
 		
 		/* Elements: */
 		private:
-		const Vertex* vertices[2]; // Pointers to the two vertices (ordered by size_t order)
+		Index vertices[2]; // Indices of the two vertices in ascending order
 		
 		/* Constructors and destructors: */
 		public:
 		VertexPair(void)
 			{
 			};
-		VertexPair(const Vertex* sVertex1,const Vertex* sVertex2)
+		VertexPair(Index sVertex1,Index sVertex2)
 			{
-			if(reinterpret_cast<size_t>(sVertex1)<reinterpret_cast<size_t>(sVertex2))
+			if(sVertex1<sVertex2)
 				{
 				vertices[0]=sVertex1;
 				vertices[1]=sVertex2;
@@ -305,21 +199,6 @@ class PolygonMesh
 				vertices[1]=sVertex1;
 				}
 			};
-		VertexPair(const Edge& edge)
-			{
-			const Vertex* v1=edge.getStart();
-			const Vertex* v2=edge.getEnd();
-			if(reinterpret_cast<size_t>(v1)<reinterpret_cast<size_t>(v2))
-				{
-				vertices[0]=v1;
-				vertices[1]=v2;
-				}
-			else
-				{
-				vertices[0]=v2;
-				vertices[1]=v1;
-				}
-			};
 		
 		/* Methods: */
 		friend bool operator==(const VertexPair& p1,const VertexPair& p2)
@@ -332,50 +211,23 @@ class PolygonMesh
 			};
 		static size_t hash(const VertexPair& p,size_t tableSize)
 			{
-			size_t val1=reinterpret_cast<size_t>(p.vertices[0]);
-			size_t val2=reinterpret_cast<size_t>(p.vertices[1]);
+			size_t val1=size_t(p.vertices[0]);
+			size_t val2=size_t(p.vertices[1]);
 			return (val1*17+val2*31)%tableSize;
 			};
 		};
 	
 	class Face // Basic data structure for representing faces
 		{
+		friend class PolygonMesh;
 		friend class FaceIterator;
 		friend class ConstFaceIterator;
-		friend class PolygonMesh;
+		friend class FaceEdgeIterator;
+		friend class ConstFaceEdgeIterator;
 		
 		/* Elements: */
 		private:
-		Edge* edge; // Pointer to any one of the polygon's edges
-		/* Pointers to form a double-linked list: */
-		Face* pred;
-		Face* succ;
-		public:
-		Vertex* facePoint; // Pointer to face point for Catmull-Clark subdivision
-		mutable bool visited; // Flag to mark faces as visited during triangle strip generation
-		
-		/* Constructors and destructors: */
-		Face(Face* sSucc)
-			:edge(0),pred(0),succ(sSucc)
-			{
-			};
-		
-		/* Methods: */
-		public:
-		const Edge* getEdge(void) const
-			{
-			return edge;
-			};
-		Edge* getEdge(void)
-			{
-			return edge;
-			};
-		void setEdge(Edge* sEdge)
-			{
-			edge=sEdge;
-			};
-		int getNumEdges(void) const;
-		void checkFace(void) const;
+		Index edge; // Index of any one of the polygon's edges; invalidIndex if the face was deleted
 		};
 	
 	class EdgeIterator // Iterator for edges
@@ -385,17 +237,22 @@ class PolygonMesh
 		
 		/* Elements: */
 		private:
-		Edge* loopStart; // First edge in loop around vertex/face
-		Edge* edge; // Edge pointed to
+		PolygonMesh* mesh; // Mesh containing the edge
+		Index loopStart; // First edge in loop around vertex/face
+		Index edge; // Edge pointed to
 		
 		/* Constructors and destructors: */
 		public:
-		EdgeIterator(void) // Constructs invalid operator
-			:loopStart(0),edge(0)
+		EdgeIterator(void) // Constructs invalid iterator
+			:mesh(0),loopStart(invalidIndex),edge(invalidIndex)
+			{
+			};
+		EdgeIterator(const NullElement*) // Ditto; allows comparisons with 0 as for pointers
+			:mesh(0),loopStart(invalidIndex),edge(invalidIndex)
 			{
 			};
-		EdgeIterator(Edge* sEdge)
-			:loopStart(sEdge),edge(sEdge)
+		EdgeIterator(PolygonMesh* sMesh,Index sEdge)
+			:mesh(sMesh),loopStart(sEdge),edge(sEdge)
 			{
 			};
 		
@@ -410,30 +267,106 @@ class PolygonMesh
 			};
 		Edge& operator*(void) const
 			{
-			return *edge;
+			return mesh->edges[edge];
+			};
+		EdgeProxy operator->(void) const
+			{
+			return EdgeProxy(*this);
 			};
-		Edge* operator->(void) const
+		Index getIndex(void) const
 			{
 			return edge;
 			};
+		VertexIterator getStart(void) const
+			{
+			return VertexIterator(mesh,mesh->edges[edge].start);
+			};
+		VertexIterator getEnd(void) const // Returns end point of half-edge
+			{
+			return VertexIterator(mesh,mesh->edges[mesh->edges[edge].faceSucc].start);
+			};
+		FaceIterator getFace(void) const
+			{
+			return FaceIterator(mesh,mesh->edges[edge].face);
+			};
+		EdgeIterator getFacePred(void) const
+			{
+			return EdgeIterator(mesh,mesh->edges[edge].facePred);
+			};
+		EdgeIterator getFaceSucc(void) const
+			{
+			return EdgeIterator(mesh,mesh->edges[edge].faceSucc);
+			};
+		EdgeIterator getVertexPred(void) const // Returns next half-edge around vertex in clockwise order, invalid if doesn't exist
+			{
+			return EdgeIterator(mesh,mesh->getVertexPred(edge));
+			};
+		EdgeIterator getVertexSucc(void) const // Returns next half-edge around vertex in counter-clockwise order, invalid if doesn't exist
+			{
+			return EdgeIterator(mesh,mesh->getVertexSucc(edge));
+			};
+		EdgeIterator getEndVertexPred(void) const // Returns next half-edge around edge end vertex in clockwise order, invalid if doesn't exist
+			{
+			return EdgeIterator(mesh,mesh->edges[mesh->edges[edge].faceSucc].opposite);
+			};
+		EdgeIterator getEndVertexSucc(void) const // Returns next half-edge around edge end vertex in counter-clockwise order, invalid if doesn't exist
+			{
+			Index opposite=mesh->edges[edge].opposite;
+			return EdgeIterator(mesh,opposite!=invalidIndex?mesh->edges[opposite].facePred:invalidIndex);
+			};
+		EdgeIterator getOpposite(void) const
+			{
+			return EdgeIterator(mesh,mesh->edges[edge].opposite);
+			};
+		void set(const VertexIterator& sStart,const FaceIterator& sFace,const EdgeIterator& sFacePred,const EdgeIterator& sFaceSucc,const EdgeIterator& sOpposite) const
+			{
+			Edge& e=mesh->edges[edge];
+			e.start=sStart.vertex;
+			e.face=sFace.face;
+			e.facePred=sFacePred.edge;
+			e.faceSucc=sFaceSucc.edge;
+			e.opposite=sOpposite.edge;
+			};
+		void setStart(const VertexIterator& sStart) const
+			{
+			mesh->edges[edge].start=sStart.vertex;
+			};
+		void setFace(const FaceIterator& sFace) const
+			{
+			mesh->edges[edge].face=sFace.face;
+			};
+		void setFacePred(const EdgeIterator& sFacePred) const
+			{
+			mesh->edges[edge].facePred=sFacePred.edge;
+			};
+		void setFaceSucc(const EdgeIterator& sFaceSucc) const
+			{
+			mesh->edges[edge].faceSucc=sFaceSucc.edge;
+			};
+		void setOpposite(const EdgeIterator& sOpposite) const
+			{
+			mesh->edges[edge].opposite=sOpposite.edge;
+			};
 		bool isUpperHalf(void) const // Checks if an edge iterator is the "dominant" part of a pair of half edges
 			{
-			return reinterpret_cast<size_t>(edge)>reinterpret_cast<size_t>(edge->getOpposite());
+			Index opposite=mesh->edges[edge].opposite;
+			return opposite==invalidIndex||edge>opposite;
 			};
 		VertexPair getVertexPair(void) const
 			{
-			return VertexPair(*edge);
+			const Edge& e=mesh->edges[edge];
+			return VertexPair(e.start,mesh->edges[e.faceSucc].start);
 			};
 		EdgeIterator& advanceFace(void)
 			{
-			if((edge=edge->getFaceSucc())==loopStart) // Did we walk around a face once?
-				edge=0; // Mark iterator as invalid
+			if((edge=mesh->edges[edge].faceSucc)==loopStart) // Did we walk around a face once?
+				edge=invalidIndex; // Mark iterator as invalid
 			return *this;
 			};
 		EdgeIterator& advanceVertex(void)
 			{
-			if((edge=edge->getVertexSucc())==loopStart) // Did we walk around a vertex once?
-				edge=0; // Mark iterator as invalid
+			if((edge=mesh->getVertexSucc(edge))==loopStart) // Did we walk around a vertex once?
+				edge=invalidIndex; // Mark iterator as invalid
 			return *this;
 			};
 		};
@@ -444,21 +377,26 @@ class PolygonMesh
 		
 		/* Elements: */
 		private:
-		const Edge* loopStart; // First edge in loop around vertex/face
-		const Edge* edge; // Edge pointed to
+		const PolygonMesh* mesh; // Mesh containing the edge
+		Index loopStart; // First edge in loop around vertex/face
+		Index edge; // Edge pointed to
 		
 		/* Constructors and destructors: */
 		public:
-		ConstEdgeIterator(void) // Constructs invalid operator
-			:loopStart(0),edge(0)
+		ConstEdgeIterator(void) // Constructs invalid iterator
+			:mesh(0),loopStart(invalidIndex),edge(invalidIndex)
+			{
+			};
+		ConstEdgeIterator(const NullElement*) // Ditto; allows comparisons with 0 as for pointers
+			:mesh(0),loopStart(invalidIndex),edge(invalidIndex)
 			{
 			};
-		ConstEdgeIterator(const Edge* sEdge)
-			:loopStart(sEdge),edge(sEdge)
+		ConstEdgeIterator(const PolygonMesh* sMesh,Index sEdge)
+			:mesh(sMesh),loopStart(sEdge),edge(sEdge)
 			{
 			};
 		ConstEdgeIterator(const EdgeIterator& eIt)
-			:loopStart(eIt.loopStart),edge(eIt.edge)
+			:mesh(eIt.mesh),loopStart(eIt.loopStart),edge(eIt.edge)
 			{
 			};
 		
@@ -473,30 +411,77 @@ class PolygonMesh
 			};
 		const Edge& operator*(void) const
 			{
-			return *edge;
+			return mesh->edges[edge];
 			};
-		const Edge* operator->(void) const
+		ConstEdgeProxy operator->(void) const
+			{
+			return ConstEdgeProxy(*this);
+			};
+		Index getIndex(void) const
 			{
 			return edge;
 			};
+		ConstVertexIterator getStart(void) const
+			{
+			return ConstVertexIterator(mesh,mesh->edges[edge].start);
+			};
+		ConstVertexIterator getEnd(void) const // Returns end point of half-edge
+			{
+			return ConstVertexIterator(mesh,mesh->edges[mesh->edges[edge].faceSucc].start);
+			};
+		ConstFaceIterator getFace(void) const
+			{
+			return ConstFaceIterator(mesh,mesh->edges[edge].face);
+			};
+		ConstEdgeIterator getFacePred(void) const
+			{
+			return ConstEdgeIterator(mesh,mesh->edges[edge].facePred);
+			};
+		ConstEdgeIterator getFaceSucc(void) const
+			{
+			return ConstEdgeIterator(mesh,mesh->edges[edge].faceSucc);
+			};
+		ConstEdgeIterator getVertexPred(void) const // Returns next half-edge around vertex in clockwise order, invalid if doesn't exist
+			{
+			return ConstEdgeIterator(mesh,mesh->getVertexPred(edge));
+			};
+		ConstEdgeIterator getVertexSucc(void) const // Returns next half-edge around vertex in counter-clockwise order, invalid if doesn't exist
+			{
+			return ConstEdgeIterator(mesh,mesh->getVertexSucc(edge));
+			};
+		ConstEdgeIterator getEndVertexPred(void) const // Returns next half-edge around edge end vertex in clockwise order, invalid if doesn't exist
+			{
+			return ConstEdgeIterator(mesh,mesh->edges[mesh->edges[edge].faceSucc].opposite);
+			};
+		ConstEdgeIterator getEndVertexSucc(void) const // Returns next half-edge around edge end vertex in counter-clockwise order, invalid if doesn't exist
+			{
+			Index opposite=mesh->edges[edge].opposite;
+			return ConstEdgeIterator(mesh,opposite!=invalidIndex?mesh->edges[opposite].facePred:invalidIndex);
+			};
+		ConstEdgeIterator getOpposite(void) const
+			{
+			return ConstEdgeIterator(mesh,mesh->edges[edge].opposite);
+			};
 		bool isUpperHalf(void) const // Checks if an edge iterator is the "dominant" part of a pair of half edges
 			{
-			return reinterpret_cast<size_t>(edge)>reinterpret_cast<size_t>(edge->getOpposite());
+			Index opposite=mesh->edges[edge].opposite;
+			return opposite==invalidIndex||edge>opposite;
 			};
 		VertexPair getVertexPair(void) const
 			{
-			return VertexPair(*edge);
+			const Edge& e=mesh->edges[edge];
+			return VertexPair(e.start,mesh->edges[e.faceSucc].start);
 			};
 		ConstEdgeIterator& advanceFace(void)
 			{
-			if((edge=edge->getFaceSucc())==loopStart) // Did we walk around a face once?
-				edge=0; // Mark iterator as invalid
+			if((edge=mesh->edges[edge].faceSucc)==loopStart) // Did we walk around a face once?
+				edge=invalidIndex; // Mark iterator as invalid
 			return *this;
 			};
 		ConstEdgeIterator& advanceVertex(void)
 			{
-			if((edge=edge->getVertexSucc())==loopStart) // Did we walk around a vertex once?
-				edge=0; // Mark iterator as invalid
+			if((edge=mesh->getVertexSucc(edge))==loopStart) // Did we walk around a vertex once?
+				edge=invalidIndex; // Mark iterator as invalid
 			return *this;
 			};
 		};
@@ -504,20 +489,26 @@ class PolygonMesh
 	class VertexIterator // Iterator for vertices
 		{
 		friend class PolygonMesh;
+		friend class EdgeIterator;
 		friend class ConstVertexIterator;
 		
 		/* Elements: */
 		private:
-		Vertex* vertex; // Vertex pointed to
+		PolygonMesh* mesh; // Mesh containing the vertex
+		Index vertex; // Vertex pointed to
 		
 		/* Constructors and destructors: */
 		public:
 		VertexIterator(void) // Constructs invalid iterator
-			:vertex(0)
+			:mesh(0),vertex(invalidIndex)
 			{
 			};
-		VertexIterator(Vertex* sVertex)
-			:vertex(sVertex)
+		VertexIterator(const NullElement*) // Ditto; allows comparisons with 0 as for pointers
+			:mesh(0),vertex(invalidIndex)
+			{
+			};
+		VertexIterator(PolygonMesh* sMesh,Index sVertex)
+			:mesh(sMesh),vertex(sVertex)
 			{
 			};
 		
@@ -532,19 +523,39 @@ class PolygonMesh
 			};
 		Vertex& operator*(void) const
 			{
-			return *vertex;
+			return mesh->vertices[vertex];
 			};
-		Vertex* operator->(void) const
+		VertexProxy operator->(void) const
 			{
-			return vertex;
+			return VertexProxy(*this);
 			};
 		static size_t hash(const VertexIterator& vertexIt,size_t tableSize)
 			{
-			return reinterpret_cast<size_t>(vertexIt.vertex)%tableSize;
+			return size_t(vertexIt.vertex)%tableSize;
+			};
+		Index getIndex(void) const
+			{
+			return vertex;
+			};
+		EdgeIterator getEdge(void) const
+			{
+			return EdgeIterator(mesh,mesh->vertices[vertex].edge);
+			};
+		void setEdge(const EdgeIterator& sEdge) const
+			{
+			mesh->vertices[vertex].edge=sEdge.edge;
+			};
+		int getNumEdges(void) const
+			{
+			return mesh->getNumVertexEdges(vertex);
+			};
+		bool isInterior(void) const // Checks if the vertex is completely surrounded by faces
+			{
+			return mesh->isVertexInterior(vertex);
 			};
 		VertexEdgeIterator beginEdges(void) const
 			{
-			return VertexEdgeIterator(vertex);
+			return VertexEdgeIterator(mesh,vertex);
 			};
 		VertexEdgeIterator endEdges(void) const
 			{
@@ -552,17 +563,17 @@ class PolygonMesh
 			};
 		Point& getPoint(void) const
 			{
-			return *vertex;
+			return mesh->vertices[vertex];
 			};
 		VertexIterator& operator++(void)
 			{
-			vertex=vertex->succ;
+			vertex=mesh->findVertex(vertex+1);
 			return *this;
 			};
 		VertexIterator operator++(int)
 			{
 			VertexIterator result(*this);
-			vertex=vertex->succ;
+			vertex=mesh->findVertex(vertex+1);
 			return result;
 			};
 		};
@@ -570,23 +581,29 @@ class PolygonMesh
 	class ConstVertexIterator // Iterator for constant vertices
 		{
 		friend class PolygonMesh;
+		friend class ConstEdgeIterator;
 		
 		/* Elements: */
 		private:
-		const Vertex* vertex; // Vertex pointed to
+		const PolygonMesh* mesh; // Mesh containing the vertex
+		Index vertex; // Vertex pointed to
 		
 		/* Constructors and destructors: */
 		public:
 		ConstVertexIterator(void) // Constructs invalid iterator
-			:vertex(0)
+			:mesh(0),vertex(invalidIndex)
 			{
 			};
-		ConstVertexIterator(const Vertex* sVertex)
-			:vertex(sVertex)
+		ConstVertexIterator(const NullElement*) // Ditto; allows comparisons with 0 as for pointers
+			:mesh(0),vertex(invalidIndex)
+			{
+			};
+		ConstVertexIterator(const PolygonMesh* sMesh,Index sVertex)
+			:mesh(sMesh),vertex(sVertex)
 			{
 			};
 		ConstVertexIterator(const VertexIterator& it)
-			:vertex(it.vertex)
+			:mesh(it.mesh),vertex(it.vertex)
 			{
 			};
 		
@@ -601,19 +618,35 @@ class PolygonMesh
 			};
 		const Vertex& operator*(void) const
 			{
-			return *vertex;
+			return mesh->vertices[vertex];
 			};
-		const Vertex* operator->(void) const
+		ConstVertexProxy operator->(void) const
 			{
-			return vertex;
+			return ConstVertexProxy(*this);
 			};
 		static size_t hash(const ConstVertexIterator& vertexIt,size_t tableSize)
 			{
-			return reinterpret_cast<size_t>(vertexIt.vertex)%tableSize;
+			return size_t(vertexIt.vertex)%tableSize;
+			};
+		Index getIndex(void) const
+			{
+			return vertex;
+			};
+		ConstEdgeIterator getEdge(void) const
+			{
+			return ConstEdgeIterator(mesh,mesh->vertices[vertex].edge);
+			};
+		int getNumEdges(void) const
+			{
+			return mesh->getNumVertexEdges(vertex);
+			};
+		bool isInterior(void) const // Checks if the vertex is completely surrounded by faces
+			{
+			return mesh->isVertexInterior(vertex);
 			};
 		ConstVertexEdgeIterator beginEdges(void) const
 			{
-			return ConstVertexEdgeIterator(vertex);
+			return ConstVertexEdgeIterator(mesh,vertex);
 			};
 		ConstVertexEdgeIterator endEdges(void) const
 			{
@@ -621,17 +654,17 @@ class PolygonMesh
 			};
 		const Point& getPoint(void) const
 			{
-			return *vertex;
+			return mesh->vertices[vertex];
 			};
 		ConstVertexIterator& operator++(void)
 			{
-			vertex=vertex->succ;
+			vertex=mesh->findVertex(vertex+1);
 			return *this;
 			};
 		ConstVertexIterator operator++(int)
 			{
 			ConstVertexIterator result(*this);
-			vertex=vertex->succ;
+			vertex=mesh->findVertex(vertex+1);
 			return result;
 			};
 		};
@@ -646,8 +679,8 @@ class PolygonMesh
 		VertexEdgeIterator(void) // Constructs invalid iterator
 			{
 			};
-		VertexEdgeIterator(Vertex* vertex) // Constructs an iterator for a vertex
-			:EdgeIterator(vertex->getEdge())
+		VertexEdgeIterator(PolygonMesh* sMesh,Index vertex) // Constructs an iterator for a vertex
+			:EdgeIterator(sMesh,sMesh->vertices[vertex].edge)
 			{
 			};
 		
@@ -674,8 +707,8 @@ class PolygonMesh
 		ConstVertexEdgeIterator(void) // Constructs invalid iterator
 			{
 			};
-		ConstVertexEdgeIterator(const Vertex* vertex) // Constructs an iterator for a vertex
-			:ConstEdgeIterator(vertex->getEdge())
+		ConstVertexEdgeIterator(const PolygonMesh* sMesh,Index vertex) // Constructs an iterator for a vertex
+			:ConstEdgeIterator(sMesh,sMesh->vertices[vertex].edge)
 			{
 			};
 		ConstVertexEdgeIterator(const VertexEdgeIterator& it)
@@ -700,20 +733,26 @@ class PolygonMesh
 	class FaceIterator // Iterator for faces
 		{
 		friend class PolygonMesh;
+		friend class EdgeIterator;
 		friend class ConstFaceIterator;
 		
 		/* Elements: */
 		private:
-		Face* face; // Face pointed to
+		PolygonMesh* mesh; // Mesh containing the face
+		Index face; // Face pointed to
 		
 		/* Constructors and destructors: */
 		public:
 		FaceIterator(void) // Constructs invalid iterator
-			:face(0)
+			:mesh(0),face(invalidIndex)
 			{
 			};
-		FaceIterator(Face* sFace)
-			:face(sFace)
+		FaceIterator(const NullElement*) // Ditto; allows comparisons with 0 as for pointers
+			:mesh(0),face(invalidIndex)
+			{
+			};
+		FaceIterator(PolygonMesh* sMesh,Index sFace)
+			:mesh(sMesh),face(sFace)
 			{
 			};
 		
@@ -728,19 +767,35 @@ class PolygonMesh
 			};
 		Face& operator*(void) const
 			{
-			return *face;
+			return mesh->faces[face];
 			};
-		Face* operator->(void) const
+		const FaceIterator* operator->(void) const // Faces have no attributes; the iterator itself provides the face's methods
 			{
-			return face;
+			return this;
 			};
 		static size_t hash(const FaceIterator& faceIt,size_t tableSize)
 			{
-			return reinterpret_cast<size_t>(faceIt.face)%tableSize;
+			return size_t(faceIt.face)%tableSize;
+			};
+		Index getIndex(void) const
+			{
+			return face;
+			};
+		EdgeIterator getEdge(void) const
+			{
+			return EdgeIterator(mesh,mesh->faces[face].edge);
+			};
+		void setEdge(const EdgeIterator& sEdge) const
+			{
+			mesh->faces[face].edge=sEdge.edge;
+			};
+		int getNumEdges(void) const
+			{
+			return mesh->getNumFaceEdges(face);
 			};
 		FaceEdgeIterator beginEdges(void) const
 			{
-			return FaceEdgeIterator(face);
+			return FaceEdgeIterator(mesh,face);
 			};
 		FaceEdgeIterator endEdges(void) const
 			{
@@ -748,13 +803,13 @@ class PolygonMesh
 			};
 		FaceIterator& operator++(void)
 			{
-			face=face->succ;
+			face=mesh->findFace(face+1);
 			return *this;
 			};
 		FaceIterator operator++(int)
 			{
 			FaceIterator result(*this);
-			face=face->succ;
+			face=mesh->findFace(face+1);
 			return result;
 			};
 		};
@@ -762,23 +817,29 @@ class PolygonMesh
 	class ConstFaceIterator // Iterator for constant faces
 		{
 		friend class PolygonMesh;
+		friend class ConstEdgeIterator;
 		
 		/* Elements: */
 		private:
-		const Face* face; // Face pointed to
+		const PolygonMesh* mesh; // Mesh containing the face
+		Index face; // Face pointed to
 		
 		/* Constructors and destructors: */
 		public:
 		ConstFaceIterator(void) // Constructs invalid iterator
-			:face(0)
+			:mesh(0),face(invalidIndex)
 			{
 			};
-		ConstFaceIterator(const Face* sFace)
-			:face(sFace)
+		ConstFaceIterator(const NullElement*) // Ditto; allows comparisons with 0 as for pointers
+			:mesh(0),face(invalidIndex)
+			{
+			};
+		ConstFaceIterator(const PolygonMesh* sMesh,Index sFace)
+			:mesh(sMesh),face(sFace)
 			{
 			};
 		ConstFaceIterator(const FaceIterator& it)
-			:face(it.face)
+			:mesh(it.mesh),face(it.face)
 			{
 			};
 		
@@ -793,19 +854,31 @@ class PolygonMesh
 			};
 		const Face& operator*(void) const
 			{
-			return *face;
+			return mesh->faces[face];
 			};
-		const Face* operator->(void) const
+		const ConstFaceIterator* operator->(void) const // Ditto
 			{
-			return face;
+			return this;
 			};
 		static size_t hash(const ConstFaceIterator& faceIt,size_t tableSize)
 			{
-			return reinterpret_cast<size_t>(faceIt.face)%tableSize;
+			return size_t(faceIt.face)%tableSize;
+			};
+		Index getIndex(void) const
+			{
+			return face;
+			};
+		ConstEdgeIterator getEdge(void) const
+			{
+			return ConstEdgeIterator(mesh,mesh->faces[face].edge);
+			};
+		int getNumEdges(void) const
+			{
+			return mesh->getNumFaceEdges(face);
 			};
 		ConstFaceEdgeIterator beginEdges(void) const
 			{
-			return ConstFaceEdgeIterator(face);
+			return ConstFaceEdgeIterator(mesh,face);
 			};
 		ConstFaceEdgeIterator endEdges(void) const
 			{
@@ -813,13 +886,13 @@ class PolygonMesh
 			};
 		ConstFaceIterator& operator++(void)
 			{
-			face=face->succ;
+			face=mesh->findFace(face+1);
 			return *this;
 			};
 		ConstFaceIterator operator++(int)
 			{
 			ConstFaceIterator result(*this);
-			face=face->succ;
+			face=mesh->findFace(face+1);
 			return result;
 			};
 		};
@@ -834,8 +907,8 @@ class PolygonMesh
 		FaceEdgeIterator(void) // Constructs invalid iterator
 			{
 			};
-		FaceEdgeIterator(Face* face) // Constructs an iterator for a face
-			:EdgeIterator(face->getEdge())
+		FaceEdgeIterator(PolygonMesh* sMesh,Index face) // Constructs an iterator for a face
+			:EdgeIterator(sMesh,sMesh->faces[face].edge)
 			{
 			};
 		
@@ -862,8 +935,8 @@ class PolygonMesh
 		ConstFaceEdgeIterator(void) // Constructs invalid iterator
 			{
 			};
-		ConstFaceEdgeIterator(const Face* face) // Constructs an iterator for a face
-			:ConstEdgeIterator(face->getEdge())
+		ConstFaceEdgeIterator(const PolygonMesh* sMesh,Index face) // Constructs an iterator for a face
+			:ConstEdgeIterator(sMesh,sMesh->faces[face].edge)
 			{
 			};
 		ConstFaceEdgeIterator(const FaceEdgeIterator& it)
@@ -885,61 +958,195 @@ class PolygonMesh
 			};
 		};
 	
-	typedef Misc::HashTable<VertexPair,Edge*,VertexPair> EdgeHasher;
+	class VertexProxy:public VertexIterator // Class returned by the arrow operator of vertex iterators to access a vertex like through a pointer
+		{
+		/* Elements: */
+		public:
+		unsigned int& version; // Vertex's version number
+		Color& color; // Vertex's color
+		Vector& normal; // Vertex's normal vector
+		
+		/* Constructors and destructors: */
+		VertexProxy(const VertexIterator& sVertex)
+			:VertexIterator(sVertex),
+			 version((*sVertex).version),color((*sVertex).color),normal((*sVertex).normal)
+			{
+			};
+		
+		/* Methods: */
+		VertexProxy* operator->(void)
+			{
+			return this;
+			};
+		void setPoint(const Point& sPoint) const
+			{
+			(**this).setPoint(sPoint);
+			};
+		Scalar* getComponents(void) const
+			{
+			return (**this).getComponents();
+			};
+		};
 	
-	class CollapsedEdge // Class representing a collapsed edge, with enough information to undo the collapse
+	class ConstVertexProxy:public ConstVertexIterator // Class returned by the arrow operator of constant vertex iterators
 		{
-		friend class PolygonMesh;
+		/* Elements: */
+		public:
+		const unsigned int& version; // Vertex's version number
+		const Color& color; // Vertex's color
+		const Vector& normal; // Vertex's normal vector
 		
+		/* Constructors and destructors: */
+		ConstVertexProxy(const ConstVertexIterator& sVertex)
+			:ConstVertexIterator(sVertex),
+			 version((*sVertex).version),color((*sVertex).color),normal((*sVertex).normal)
+			{
+			};
+		
+		/* Methods: */
+		ConstVertexProxy* operator->(void)
+			{
+			return this;
+			};
+		const Scalar* getComponents(void) const
+			{
+			return (**this).getComponents();
+			};
+		};
+	
+	class EdgeProxy:public EdgeIterator // Class returned by the arrow operator of edge iterators to access a half-edge like through a pointer
+		{
 		/* Elements: */
-		private:
-		Edge* edges[2]; // Two half edges starting at the collapsed edge vertex that need to be pried apart when undoing
-		Vector offsets[2]; // Offset vectors to add to the collapsed edge vertex to reconstruct the original vertices
+		public:
+		int& sharpness; // Half-edge's sharpness coefficient
 		
 		/* Constructors and destructors: */
-		CollapsedEdge(...);
+		EdgeProxy(const EdgeIterator& sEdge)
+			:EdgeIterator(sEdge),
+			 sharpness((*sEdge).sharpness)
+			{
+			};
+		
+		/* Methods: */
+		EdgeProxy* operator->(void)
+			{
+			return this;
+			};
 		};
 	
+	class ConstEdgeProxy:public ConstEdgeIterator // Class returned by the arrow operator of constant edge iterators
+		{
+		/* Elements: */
+		public:
+		const int& sharpness; // Half-edge's sharpness coefficient
+		
+		/* Constructors and destructors: */
+		ConstEdgeProxy(const ConstEdgeIterator& sEdge)
+			:ConstEdgeIterator(sEdge),
+			 sharpness((*sEdge).sharpness)
+			{
+			};
+		
+		/* Methods: */
+		ConstEdgeProxy* operator->(void)
+			{
+			return this;
+			};
+		};
+	
+	typedef Misc::HashTable<VertexPair,Index,VertexPair> EdgeHasher; // Hash table mapping vertex pairs to half-edge indices
+	
+	private:
+	struct SubdivisionIndices; // Structure holding index maps while subdividing the mesh
+	class VertexNormalCalculator; // Calculates normal vectors of a range of updated vertices
+	class FaceEdgeCounter; // Counts the half-edges of a range of faces
+	class FaceEdgeEnumerator; // Assigns dense positions to the half-edges of a range of faces
+	class FacePointCalculator; // Calculates Catmull-Clark face points for a range of faces
+	class EdgeMidpointCalculator; // Calculates the midpoints of the edges of a range of faces
+	class VertexPointCalculator; // Calculates Catmull-Clark vertex points for a range of vertices
+	class EdgePointCalculator; // Calculates Catmull-Clark edge points for the edges of a range of faces
+	class FaceSubdivider; // Splits a range of faces into quadrilaterals
+	
+	/*********************************************************************
+	All mesh elements are stored in flat arrays, and refer to each other
+	by 32-bit indices. Slots of deleted elements are kept on free lists
+	and re-used by subsequently created elements, so indices of existing
+	elements remain valid until the elements are deleted.
+	*********************************************************************/
+	
 	/* Elements: */
 	protected:
-	/* Allocators for vertices, edges and faces: */
-	Misc::PoolAllocator<Vertex> vertexAllocator;
-	Misc::PoolAllocator<Edge> edgeAllocator;
-	Misc::PoolAllocator<Face> faceAllocator;
-	
 	unsigned int version; // Version number of the entire mesh
 	int numVertices; // Number of vertices in the mesh
-	Vertex* vertices; // Pointer to head of vertex list
-	Vertex* lastVertex; // Pointer to tail of vertex list
+	std::vector<Vertex> vertices; // Array of vertices, including deleted ones
+	std::vector<bool> vertexValid; // Flags marking the entries of the vertex array that hold existing vertices
+	std::vector<Index> freeVertices; // Indices of deleted vertices
 	int numEdges; // Number of edges in the mesh
+	std::vector<Edge> edges; // Array of half-edges, including deleted ones
+	std::vector<Index> freeEdges; // Indices of deleted half-edges
 	int numFaces; // Number of faces in the mesh
-	Face* faces; // Pointer to head of face list
-	Face* lastFace; // Pointer to tail of face list
+	std::vector<Face> faces; // Array of faces, including deleted ones
+	std::vector<Index> freeFaces; // Indices of deleted faces
+	
+	/* Private methods: */
+	private:
+	Index getVertexPred(Index edge) const // Returns the index of the next half-edge around an edge's start vertex in clockwise order
+		{
+		Index opposite=edges[edge].opposite;
+		return opposite!=invalidIndex?edges[opposite].faceSucc:invalidIndex;
+		};
+	Index getVertexSucc(Index edge) const // Returns the index of the next half-edge around an edge's start vertex in counter-clockwise order
+		{
+		return edges[edges[edge].facePred].opposite;
+		};
+	Index findVertex(Index vertex) const // Returns the index of the first existing vertex at or after the given index
+		{
+		for(;vertex<vertices.size();++vertex)
+			if(vertexValid[vertex])
+				return vertex;
+		return invalidIndex;
+		};
+	Index findFace(Index face) const // Returns the index of the first existing face at or after the given index
+		{
+		for(;face<faces.size();++face)
+			if(faces[face].edge!=invalidIndex)
+				return face;
+		return invalidIndex;
+		};
+	int getNumVertexEdges(Index vertex) const; // Returns the number of half-edges starting at a vertex
+	bool isVertexInterior(Index vertex) const; // Checks if a vertex is completely surrounded by faces
+	int getNumFaceEdges(Index face) const; // Returns the number of half-edges around a face
+	void checkVertex(Index vertex) const;
+	void checkFace(Index face) const;
+	void calcVertexNormal(Index vertex); // Recalculates the normal vector of the given vertex if it was updated
+	void calcFacePoint(Index face,Index facePoint); // Calculates the Catmull-Clark face point of a face
+	void calcEdgeMidpoints(Index face,const SubdivisionIndices& si); // Calculates the midpoints of all edges of a face represented by the face's half-edges
+	void calcVertexPoint(Index vertex,const SubdivisionIndices& si); // Moves a vertex to its Catmull-Clark vertex point and links it to the subdivided mesh
+	void calcEdgePoints(Index face,const SubdivisionIndices& si); // Moves the midpoints of all edges of a face represented by the face's half-edges to their Catmull-Clark edge points
+	void subdivideFace(Index face,const SubdivisionIndices& si,Edge* newEdges,Face* newFaces); // Splits a face into one quadrilateral per corner
 	
 	/* Protected methods: */
-	Vertex* newVertex(const Point& p,const Color& c); // Creates a new vertex
-	void deleteVertex(Vertex* vertex); // Deletes a vertex
-	Edge* newEdge(void); // Creates a new edge
-	void deleteEdge(Edge* edge); // Deletes an edge
-	Face* newFace(void); // Creates a new face
-	void deleteFace(Face* face); // Deletes a face
+	protected:
+	VertexIterator newVertex(const Point& p,const Color& c); // Creates a new vertex
+	void deleteVertex(const VertexIterator& vertexIt); // Deletes a vertex
+	EdgeIterator newEdge(void); // Creates a new edge
+	void deleteEdge(const EdgeIterator& edgeIt); // Deletes an edge
+	FaceIterator newFace(void); // Creates a new face
+	void deleteFace(const FaceIterator& faceIt); // Deletes a face
 	
 	/* Constructors and destructors: */
 	public:
 	PolygonMesh(void) // Creates empty mesh
 		:version(0),
-		 numVertices(0),vertices(0),lastVertex(0),
-		 numEdges(0),
-		 numFaces(0),faces(0),lastFace(0)
+		 numVertices(0),numEdges(0),numFaces(0)
 		{
 		};
 	PolygonMesh(const PolygonMesh& source); // Copies a polygon mesh
-	~PolygonMesh(void);
 	
 	/* Methods: */
 	VertexIterator addVertex(const Point& pos,const Color& color)
 		{
-		return VertexIterator(newVertex(pos,color));
+		return newVertex(pos,color);
 		};
 	EdgeHasher* startAddingFaces(void);
 	FaceIterator addFace(int numVertices,const VertexIterator vertices[],EdgeHasher* edgeHasher);
@@ -952,23 +1159,19 @@ class PolygonMesh
 		};
 	VertexIterator beginVertices(void)
 		{
-		return VertexIterator(vertices);
+		return VertexIterator(this,findVertex(0));
 		};
 	ConstVertexIterator beginVertices(void) const
 		{
-		return ConstVertexIterator(vertices);
+		return ConstVertexIterator(this,findVertex(0));
 		};
 	VertexIterator endVertices(void)
 		{
-		return VertexIterator(0);
+		return VertexIterator(this,invalidIndex);
 		};
 	ConstVertexIterator endVertices(void) const
 		{
-		return ConstVertexIterator(0);
-		};
-	Vertex* createVertex(const Point& p,const Color& c,Vertex* succ =0) // Creates a new vertex without adding it to the main vertex list
-		{
-		return new(vertexAllocator.allocate()) Vertex(p,c,succ);
+		return ConstVertexIterator(this,invalidIndex);
 		};
 	int getNumEdges(void) const
 		{
@@ -980,19 +1183,19 @@ class PolygonMesh
 		};
 	FaceIterator beginFaces(void)
 		{
-		return FaceIterator(faces);
+		return FaceIterator(this,findFace(0));
 		};
 	ConstFaceIterator beginFaces(void) const
 		{
-		return ConstFaceIterator(faces);
+		return ConstFaceIterator(this,findFace(0));
 		};
 	FaceIterator endFaces(void)
 		{
-		return FaceIterator(0);
+		return FaceIterator(this,invalidIndex);
 		};
 	ConstFaceIterator endFaces(void) const
 		{
-		return ConstFaceIterator(0);
+		return ConstFaceIterator(this,invalidIndex);
 		};
 	void updateVertexNormals(void); // Recalculates the normal vectors of all updated vertices
 	void validateVertices(void) // Marks all vertices as up-to-date
@@ -1006,10 +1209,10 @@ class PolygonMesh
 	void removeSingularVertex(const VertexIterator& vertexIt); // Removes a singular vertex (a vertex without edges)
 	void removeVertex(const VertexIterator& vertexIt); // Removes a vertex by turning its platelet into a hole
 	FaceIterator vertexToFace(const VertexIterator& vertexIt); // Converts a vertex into a face by splitting triangles off all adjacent faces
-	VertexIterator splitEdge(const EdgeIterator& edgeIt,Vertex* edgePoint); // Splits an existing edge using an existing unlinked vertex
+	VertexIterator splitEdge(const EdgeIterator& edgeIt,const VertexIterator& edgePoint); // Splits an existing edge using an existing vertex without edges
 	VertexIterator splitEdge(const EdgeIterator& edgeIt,const Point& p,const Color& c) // Splits an existing edge by creating a new vertex
 		{
-		return splitEdge(edgeIt,createVertex(p,c));
+		return splitEdge(edgeIt,newVertex(p,c));
 		};
 	void rotateEdge(const EdgeIterator& edgeIt); // Rotates an edge in counter-clockwise direction
 	FaceIterator removeEdge(const EdgeIterator& edgeIt); // Joins two faces by removing an edge
@@ -1026,19 +1229,18 @@ class PolygonMesh
 	void removeFace(const FaceIterator& faceIt); // Removes a face by replacing it with a hole
 	void triangulateFace(const FaceIterator& faceIt); // Splits a face into triangles by inserting new edges
 	EdgeIterator splitFace(const VertexIterator& vIt1,const VertexIterator& vIt2); // Splits a face by connecting two points by a new edge
-	VertexIterator splitFace(const FaceIterator& faceIt,Vertex* facePoint); // Splits an existing face into a triangle fan around the existing unlinked vertex
-	template <class InputPointType>
-	VertexIterator splitFace(const FaceIterator& faceIt,const InputPointType& p) // Splits an existing face into a triangle fan around the new vertex
+	VertexIterator splitFace(const FaceIterator& faceIt,const VertexIterator& facePoint); // Splits an existing face into a triangle fan around an existing vertex without edges
+	VertexIterator splitFace(const FaceIterator& faceIt,const Point& p,const Color& c) // Splits an existing face into a triangle fan around a new vertex
 		{
-		return splitFace(faceIt,createVertex(p));
+		return splitFace(faceIt,newVertex(p,c));
 		};
-	VertexIterator splitFaceCatmullClark(const FaceIterator& faceIt,Vertex* v); // Ditto, uses existing unlinked vertex
-	template <class InputPointType>
-	VertexIterator splitFaceCatmullClark(const FaceIterator& faceIt,const InputPointType& p) // Splits an existing face into a quad fan around the new vertex
+	VertexIterator splitFaceCatmullClark(const FaceIterator& faceIt,const VertexIterator& facePoint); // Splits an existing face into a quad fan around an existing vertex without edges
+	VertexIterator splitFaceCatmullClark(const FaceIterator& faceIt,const Point& p,const Color& c) // Splits an existing face into a quad fan around a new vertex
 		{
-		return splitFaceCatmullClark(faceIt,createVertex(p));
+		return splitFaceCatmullClark(faceIt,newVertex(p,c));
 		};
 	FaceIterator splitFaceDooSabin(const FaceIterator& faceIt); // Insets a face as in Doo-Sabin subdivision
+	void subdivideCatmullClark(unsigned int maxNumThreads =0); // Applies one level of Catmull-Clark subdivision to the entire mesh using at most the given number of threads; 0 uses the parallel loop default
 	void checkMesh(void) const; // Checks the mesh for sanity
 	};
 
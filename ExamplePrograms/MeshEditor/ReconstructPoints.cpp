@@ -0,0 +1,216 @@
+/***********************************************************************
+ReconstructPoints - Command line program to reconstruct a triangle mesh
+from a point set stored in a PLY file using parallel ball pivoting, and
+to report reconstruction performance.
+Copyright (c) 2011 Oliver Kreylos
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+#include <vector>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/Timer.h>
+#include <Misc/File.h>
+#include <IO/OpenFile.h>
+#include <IO/ValueSource.h>
+
+#include "PlyFileStructures.h"
+#include "BallPivoter.h"
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+template <class PlyFileParam>
+void readPlyPoints(const PLYFileHeader& header,PlyFileParam& ply,std::vector<BallPivoter::Point>& points,std::vector<BallPivoter::Vector>& normals)
+	{
+	/* Process all elements in order: */
+	for(size_t elementIndex=0;elementIndex<header.getNumElements();++elementIndex)
+		{
+		/* Get the next element: */
+		const PLYElement& element=header.getElement(elementIndex);
+		
+		if(element.isElement("vertex"))
+			{
+			/* Get the indices of all relevant vertex value components: */
+			unsigned int posIndex[3];
+			posIndex[0]=element.getPropertyIndex("x");
+			posIndex[1]=element.getPropertyIndex("y");
+			posIndex[2]=element.getPropertyIndex("z");
+			unsigned int normalIndex[3];
+			normalIndex[0]=element.getPropertyIndex("nx");
+			normalIndex[1]=element.getPropertyIndex("ny");
+			normalIndex[2]=element.getPropertyIndex("nz");
+			bool hasNormal=normalIndex[0]<element.getNumProperties()&&normalIndex[1]<element.getNumProperties()&&normalIndex[2]<element.getNumProperties();
+			
+			/* Read the vertex element: */
+			points.reserve(element.getNumValues());
+			if(hasNormal)
+				normals.reserve(element.getNumValues());
+			PLYElement::Value vertexValue(element);
+			for(size_t i=0;i<element.getNumValues();++i)
+				{
+				/* Read vertex element from file: */
+				vertexValue.read(ply);
+				
+				/* Extract vertex position and normal vector from vertex element: */
+				BallPivoter::Point point;
+				for(int j=0;j<3;++j)
+					point[j]=vertexValue.getValue(posIndex[j]).getScalar()->getDouble();
+				points.push_back(point);
+				if(hasNormal)
+					{
+					BallPivoter::Vector normal;
+					for(int j=0;j<3;++j)
+						normal[j]=vertexValue.getValue(normalIndex[j]).getScalar()->getDouble();
+					normals.push_back(normal);
+					}
+				}
+			}
+		else
+			{
+			/* Skip the entire element: */
+			skipElement(element,ply);
+			}
+		}
+	}
+
+void loadPlyPoints(const char* plyFileName,std::vector<BallPivoter::Point>& points,std::vector<BallPivoter::Vector>& normals)
+	{
+	/* Open the PLY file: */
+	IO::FilePtr plyFile(IO::openFile(plyFileName));
+	
+	/* Read the PLY file's header: */
+	PLYFileHeader header(*plyFile);
+	if(!header.isValid())
+		Misc::throwStdErr("Input file %s is not a valid PLY file",plyFileName);
+	
+	/* Read the PLY file in ASCII or binary mode: */
+	if(header.getFileType()==PLYFileHeader::Ascii)
+		{
+		/* Attach a value source to the PLY file: */
+		IO::ValueSource ply(plyFile);
+		
+		/* Read the PLY file in ASCII mode: */
+		readPlyPoints(header,ply,points,normals);
+		}
+	else
+		{
+		/* Set the PLY file's endianness: */
+		plyFile->setEndianness(header.getFileEndianness());
+		
+		/* Read the PLY file in binary mode: */
+		readPlyPoints(header,*plyFile,points,normals);
+		}
+	}
+
+void savePlyMesh(const char* plyFileName,const BallPivoter& pivoter)
+	{
+	/* Open the ply file: */
+	Misc::File plyFile(plyFileName,"wb",Misc::File::LittleEndian);
+	
+	/* Write the ply file header: */
+	const std::vector<BallPivoter::Point>& points=pivoter.getPoints();
+	const std::vector<BallPivoter::Triangle>& triangles=pivoter.getTriangles();
+	fprintf(plyFile.getFilePtr(),"ply\n");
+	fprintf(plyFile.getFilePtr(),"format binary_little_endian 1.0\n");
+	fprintf(plyFile.getFilePtr(),"element vertex %u\n",(unsigned int)points.size());
+	fprintf(plyFile.getFilePtr(),"property float x\n");
+	fprintf(plyFile.getFilePtr(),"property float y\n");
+	fprintf(plyFile.getFilePtr(),"property float z\n");
+	fprintf(plyFile.getFilePtr(),"element face %u\n",(unsigned int)triangles.size());
+	fprintf(plyFile.getFilePtr(),"property list uchar int vertex_indices\n");
+	fprintf(plyFile.getFilePtr(),"end_header\n");
+	
+	/* Write all vertices to the ply file: */
+	for(std::vector<BallPivoter::Point>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
+		for(int i=0;i<3;++i)
+			plyFile.write<float>(float((*pIt)[i]));
+	
+	/* Write all triangles to the ply file: */
+	for(std::vector<BallPivoter::Triangle>::const_iterator tIt=triangles.begin();tIt!=triangles.end();++tIt)
+		{
+		plyFile.write<unsigned char>(3);
+		for(int i=0;i<3;++i)
+			plyFile.write<int>(int(tIt->vertices[i]));
+		}
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* inputFileName=0;
+	const char* outputFileName=0;
+	std::vector<BallPivoter::Scalar> ballRadii;
+	unsigned int numRegions=0;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"RADIUS")==0)
+				{
+				++i;
+				if(i<argc)
+					ballRadii.push_back(BallPivoter::Scalar(atof(argv[i])));
+				}
+			else if(strcasecmp(argv[i]+1,"REGIONS")==0)
+				{
+				++i;
+				if(i<argc)
+					numRegions=(unsigned int)atoi(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"O")==0)
+				{
+				++i;
+				if(i<argc)
+					outputFileName=argv[i];
+				}
+			}
+		else
+			inputFileName=argv[i];
+		}
+	if(inputFileName==0||ballRadii.empty())
+		{
+		fprintf(stderr,"Usage: %s <input PLY file> -radius <ball radius> [-radius <ball radius> ...] [-regions <number of regions>] [-o <output PLY file>]\n",argv[0]);
+		return 1;
+		}
+	
+	try
+		{
+		/* Load the point set: */
+		Misc::Timer loadTimer;
+		std::vector<BallPivoter::Point> points;
+		std::vector<BallPivoter::Vector> normals;
+		loadPlyPoints(inputFileName,points,normals);
+		loadTimer.elapse();
+		printf("Read %u points%s in %f s\n",(unsigned int)points.size(),normals.empty()?"":" with normals",loadTimer.getTime());
+		
+		/* Reconstruct the surface: */
+		BallPivoter pivoter(points,normals,numRegions);
+		pivoter.reconstruct(ballRadii);
+		
+		/* Report reconstruction performance: */
+		const BallPivoter::Statistics& stats=pivoter.getStatistics();
+		printf("Reconstructed %u triangles in %u regions from %u seeds\n",(unsigned int)pivoter.getTriangles().size(),pivoter.getNumRegions(),(unsigned int)stats.numSeeds);
+		printf("  %u triangles inside regions, %u triangles on seams\n",(unsigned int)stats.numRegionTriangles,(unsigned int)stats.numSeamTriangles);
+		printf("  Spatial hash: %f s, regions: %f s, seams: %f s\n",stats.gridTime,stats.regionTime,stats.seamTime);
+		printf("  Total: %f s, %.0f triangles per second\n",stats.getTotalTime(),stats.getTriangleRate());
+		
+		/* Save the reconstructed mesh: */
+		if(outputFileName!=0)
+			savePlyMesh(outputFileName,pivoter);
+		}
+	catch(std::runtime_error err)
+		{
+		fprintf(stderr,"Caught exception %s\n",err.what());
+		return 1;
+		}
+	
+	return 0;
+	}
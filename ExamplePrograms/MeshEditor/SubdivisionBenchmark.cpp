@@ -0,0 +1,363 @@
+/***********************************************************************
+SubdivisionBenchmark - Command line program to measure Catmull-Clark
+subdivision of a polygon mesh at subdivision levels 1 to 4, and to
+compare the half-edge traversal speed of array-of-structures and
+structure-of-arrays mesh layouts.
+Copyright (c) 2011 Oliver Kreylos
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Geometry/AffineCombiner.h>
+
+#include "PolygonMesh.h"
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+typedef PolygonMesh::Index Index;
+typedef PolygonMesh::Scalar Scalar;
+typedef PolygonMesh::Point Point;
+
+struct HalfEdge // Half-edge record in array-of-structures layout, as used by PolygonMesh
+	{
+	/* Elements: */
+	public:
+	Index start,face,facePred,faceSucc,opposite;
+	int sharpness;
+	};
+
+class AoSLinks // Accessor for half-edges stored in array-of-structures layout
+	{
+	/* Elements: */
+	public:
+	std::vector<HalfEdge> edges;
+	
+	/* Methods: */
+	Index getStart(Index edge) const
+		{
+		return edges[edge].start;
+		};
+	Index getFace(Index edge) const
+		{
+		return edges[edge].face;
+		};
+	Index getFacePred(Index edge) const
+		{
+		return edges[edge].facePred;
+		};
+	Index getFaceSucc(Index edge) const
+		{
+		return edges[edge].faceSucc;
+		};
+	Index getOpposite(Index edge) const
+		{
+		return edges[edge].opposite;
+		};
+	int getSharpness(Index edge) const
+		{
+		return edges[edge].sharpness;
+		};
+	};
+
+class SoALinks // Accessor for half-edges stored in structure-of-arrays layout
+	{
+	/* Elements: */
+	public:
+	std::vector<Index> starts,faces,facePreds,faceSuccs,opposites;
+	std::vector<int> sharpnesses;
+	
+	/* Methods: */
+	Index getStart(Index edge) const
+		{
+		return starts[edge];
+		};
+	Index getFace(Index edge) const
+		{
+		return faces[edge];
+		};
+	Index getFacePred(Index edge) const
+		{
+		return facePreds[edge];
+		};
+	Index getFaceSucc(Index edge) const
+		{
+		return faceSuccs[edge];
+		};
+	Index getOpposite(Index edge) const
+		{
+		return opposites[edge];
+		};
+	int getSharpness(Index edge) const
+		{
+		return sharpnesses[edge];
+		};
+	};
+
+struct Topology // Densely numbered copy of a polygon mesh's vertices and half-edges
+	{
+	/* Elements: */
+	public:
+	std::vector<Point> points; // Vertex positions
+	std::vector<Index> vertexEdges; // One half-edge starting at each vertex
+	std::vector<Index> faceEdges; // One half-edge of each face
+	AoSLinks aos; // Half-edges in array-of-structures layout
+	SoALinks soa; // Half-edges in structure-of-arrays layout
+	};
+
+/****************
+Helper functions:
+****************/
+
+PolygonMesh* createTorus(int numU,int numV)
+	{
+	/* Create a quadrilateral torus mesh: */
+	PolygonMesh* mesh=new PolygonMesh;
+	std::vector<PolygonMesh::VertexIterator> vertices;
+	for(int v=0;v<numV;++v)
+		{
+		Scalar beta=Scalar(2)*Math::Constants<Scalar>::pi*Scalar(v)/Scalar(numV);
+		for(int u=0;u<numU;++u)
+			{
+			Scalar alpha=Scalar(2)*Math::Constants<Scalar>::pi*Scalar(u)/Scalar(numU);
+			Scalar r=Scalar(2)+Scalar(0.75)*Math::cos(beta);
+			Point p(r*Math::cos(alpha),r*Math::sin(alpha),Scalar(0.75)*Math::sin(beta));
+			vertices.push_back(mesh->addVertex(p,PolygonMesh::Color(255,255,255)));
+			}
+		}
+	PolygonMesh::EdgeHasher* edgeHasher=mesh->startAddingFaces();
+	for(int v=0;v<numV;++v)
+		for(int u=0;u<numU;++u)
+			{
+			PolygonMesh::VertexIterator face[4];
+			face[0]=vertices[v*numU+u];
+			face[1]=vertices[v*numU+(u+1)%numU];
+			face[2]=vertices[((v+1)%numV)*numU+(u+1)%numU];
+			face[3]=vertices[((v+1)%numV)*numU+u];
+			mesh->addFace(4,face,edgeHasher);
+			}
+	
+	/* Crease one ring around the torus' outer equator: */
+	for(int u=0;u<numU;++u)
+		mesh->setEdgeSharpness(vertices[u],vertices[(u+1)%numU],2,edgeHasher);
+	mesh->finishAddingFaces(edgeHasher);
+	
+	return mesh;
+	}
+
+void extractTopology(const PolygonMesh& mesh,Topology& topology)
+	{
+	/* Number all vertices densely: */
+	std::vector<Index> vertexMap;
+	Index numVertices=0;
+	for(PolygonMesh::ConstVertexIterator vIt=mesh.beginVertices();vIt!=mesh.endVertices();++vIt,++numVertices)
+		{
+		if(vertexMap.size()<=vIt.getIndex())
+			vertexMap.resize(vIt.getIndex()+1,PolygonMesh::invalidIndex);
+		vertexMap[vIt.getIndex()]=numVertices;
+		topology.points.push_back(*vIt);
+		}
+	
+	/* Number all half-edges densely in face order: */
+	std::vector<Index> edgeMap;
+	Index numEdges=0;
+	Index numFaces=0;
+	for(PolygonMesh::ConstFaceIterator fIt=mesh.beginFaces();fIt!=mesh.endFaces();++fIt,++numFaces)
+		{
+		topology.faceEdges.push_back(numEdges);
+		for(PolygonMesh::ConstFaceEdgeIterator feIt=fIt.beginEdges();feIt!=fIt.endEdges();++feIt,++numEdges)
+			{
+			if(edgeMap.size()<=feIt.getIndex())
+				edgeMap.resize(feIt.getIndex()+1,PolygonMesh::invalidIndex);
+			edgeMap[feIt.getIndex()]=numEdges;
+			}
+		}
+	
+	/* Copy all half-edges into both layouts: */
+	topology.aos.edges.resize(numEdges);
+	topology.soa.starts.resize(numEdges);
+	topology.soa.faces.resize(numEdges);
+	topology.soa.facePreds.resize(numEdges);
+	topology.soa.faceSuccs.resize(numEdges);
+	topology.soa.opposites.resize(numEdges);
+	topology.soa.sharpnesses.resize(numEdges);
+	topology.vertexEdges.resize(numVertices,PolygonMesh::invalidIndex);
+	Index face=0;
+	for(PolygonMesh::ConstFaceIterator fIt=mesh.beginFaces();fIt!=mesh.endFaces();++fIt,++face)
+		for(PolygonMesh::ConstFaceEdgeIterator feIt=fIt.beginEdges();feIt!=fIt.endEdges();++feIt)
+			{
+			Index edge=edgeMap[feIt.getIndex()];
+			HalfEdge& he=topology.aos.edges[edge];
+			he.start=vertexMap[feIt->getStart().getIndex()];
+			he.face=face;
+			he.facePred=edgeMap[feIt->getFacePred().getIndex()];
+			he.faceSucc=edgeMap[feIt->getFaceSucc().getIndex()];
+			he.opposite=feIt->getOpposite()!=0?edgeMap[feIt->getOpposite().getIndex()]:PolygonMesh::invalidIndex;
+			he.sharpness=feIt->sharpness;
+			topology.soa.starts[edge]=he.start;
+			topology.soa.faces[edge]=he.face;
+			topology.soa.facePreds[edge]=he.facePred;
+			topology.soa.faceSuccs[edge]=he.faceSucc;
+			topology.soa.opposites[edge]=he.opposite;
+			topology.soa.sharpnesses[edge]=he.sharpness;
+			if(topology.vertexEdges[he.start]==PolygonMesh::invalidIndex)
+				topology.vertexEdges[he.start]=edge;
+			}
+	}
+
+template <class LinksParam>
+double calcVertexPoints(const Topology& topology,const LinksParam& links,std::vector<Point>& vertexPoints)
+	{
+	/* Calculate all face points by walking around all faces: */
+	std::vector<Point> facePoints(topology.faceEdges.size());
+	for(size_t face=0;face<topology.faceEdges.size();++face)
+		{
+		Point::AffineCombiner fpc;
+		Index edge=topology.faceEdges[face];
+		do
+			{
+			fpc.addPoint(topology.points[links.getStart(edge)]);
+			edge=links.getFaceSucc(edge);
+			}
+		while(edge!=topology.faceEdges[face]);
+		facePoints[face]=fpc.getPoint();
+		}
+	
+	/* Calculate all vertex points by walking around all vertices: */
+	double checksum=0.0;
+	for(size_t vertex=0;vertex<topology.vertexEdges.size();++vertex)
+		{
+		Point::AffineCombiner vpc;
+		int numEdges=0;
+		int numSharpEdges=0;
+		Index edge=topology.vertexEdges[vertex];
+		do
+			{
+			vpc.addPoint(facePoints[links.getFace(edge)]);
+			vpc.addPoint(Geometry::mid(topology.points[links.getStart(edge)],topology.points[links.getStart(links.getFaceSucc(edge))]),Scalar(2));
+			if(links.getSharpness(edge)!=0)
+				++numSharpEdges;
+			++numEdges;
+			edge=links.getOpposite(links.getFacePred(edge));
+			}
+		while(edge!=PolygonMesh::invalidIndex&&edge!=topology.vertexEdges[vertex]);
+		if(edge==PolygonMesh::invalidIndex||numSharpEdges>=2)
+			vertexPoints[vertex]=topology.points[vertex];
+		else
+			{
+			vpc.addPoint(topology.points[vertex],Scalar(numEdges*(numEdges-3)));
+			vertexPoints[vertex]=vpc.getPoint();
+			}
+		for(int i=0;i<3;++i)
+			checksum+=double(vertexPoints[vertex][i]);
+		}
+	
+	return checksum;
+	}
+
+template <class LinksParam>
+double timeVertexPoints(const Topology& topology,const LinksParam& links,int numRuns,double& checksum)
+	{
+	std::vector<Point> vertexPoints(topology.points.size());
+	Misc::Timer timer;
+	for(int run=0;run<numRuns;++run)
+		checksum=calcVertexPoints(topology,links,vertexPoints);
+	timer.elapse();
+	return timer.getTime()*1000.0/double(numRuns);
+	}
+
+double subdivide(PolygonMesh& mesh,unsigned int maxNumThreads)
+	{
+	Misc::Timer timer;
+	mesh.subdivideCatmullClark(maxNumThreads);
+	timer.elapse();
+	return timer.getTime()*1000.0;
+	}
+
+bool samePoints(const PolygonMesh& mesh1,const PolygonMesh& mesh2)
+	{
+	PolygonMesh::ConstVertexIterator v1It=mesh1.beginVertices();
+	PolygonMesh::ConstVertexIterator v2It=mesh2.beginVertices();
+	for(;v1It!=mesh1.endVertices()&&v2It!=mesh2.endVertices();++v1It,++v2It)
+		if(*v1It!=*v2It)
+			return false;
+	return v1It==mesh1.endVertices()&&v2It==mesh2.endVertices();
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int torusSize=100;
+	unsigned int maxNumThreads=0;
+	int numRuns=3;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"size")==0&&i+1<argc)
+				torusSize=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"threads")==0&&i+1<argc)
+				maxNumThreads=(unsigned int)atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"runs")==0&&i+1<argc)
+				numRuns=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring unrecognized argument "<<argv[i]<<std::endl;
+		}
+	
+	/* Create the control mesh: */
+	PolygonMesh* serialMesh=createTorus(torusSize,torusSize);
+	PolygonMesh* parallelMesh=new PolygonMesh(*serialMesh);
+	std::cout<<"Torus of "<<serialMesh->getNumFaces()<<" quadrilaterals with one creased ring"<<std::endl;
+	
+	int result=0;
+	for(int level=1;level<=4;++level)
+		{
+		/* Subdivide both meshes by one level, using one thread and the thread limit, respectively: */
+		double serialTime=subdivide(*serialMesh,1);
+		double parallelTime=subdivide(*parallelMesh,maxNumThreads);
+		std::cout<<"Level "<<level<<": "<<serialMesh->getNumVertices()<<" vertices, "<<serialMesh->getNumFaces()<<" faces; subdivision in "<<serialTime<<" ms (1 thread), "<<parallelTime<<" ms (all threads)"<<std::endl;
+		
+		/* Check the subdivided mesh: */
+		serialMesh->checkMesh();
+		if(serialMesh->getNumVertices()-serialMesh->getNumEdges()/2+serialMesh->getNumFaces()!=0)
+			{
+			std::cout<<"  Subdivided mesh is not a torus"<<std::endl;
+			result=1;
+			}
+		if(!samePoints(*serialMesh,*parallelMesh))
+			{
+			std::cout<<"  Subdivided meshes differ between thread counts"<<std::endl;
+			result=1;
+			}
+		
+		/* Compare the traversal speed of both half-edge layouts: */
+		Topology topology;
+		extractTopology(*serialMesh,topology);
+		double aosChecksum,soaChecksum;
+		double aosTime=timeVertexPoints(topology,topology.aos,numRuns,aosChecksum);
+		double soaTime=timeVertexPoints(topology,topology.soa,numRuns,soaChecksum);
+		std::cout<<"  Face and vertex point traversal: "<<aosTime<<" ms (array of structures), "<<soaTime<<" ms (structure of arrays)"<<std::endl;
+		if(aosChecksum!=soaChecksum)
+			{
+			std::cout<<"  Traversal results differ between layouts"<<std::endl;
+			result=1;
+			}
+		}
+	
+	delete serialMesh;
+	delete parallelMesh;
+	return result;
+	}
@@ -1272,6 +1272,7 @@ void ShowEarthModel::display(GLContextData& contextData) const
 		
 		/* Create a render state to traverse the scene graph: */
 		SceneGraph::GLRenderState renderState(contextData,t.inverseTransform(Vrui::getMainViewer()->getHeadPosition()),t.inverseTransform(Vrui::getUpDirection()));
+		renderState.time=Vrui::getApplicationTime();
 		
 		/* Render all scene graphs: */
 		for(unsigned int i=0;i<sceneGraphs.size();++i)
@@ -10,6 +10,7 @@
 #include <SceneGraph/BoxNode.h>
 #include <SceneGraph/ShapeNode.h>
 #include <SceneGraph/NodeCreator.h>
+#include <SceneGraph/InlineNode.h>
 #include <SceneGraph/VRMLFile.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/OpenFile.h>
@@ -25,6 +26,7 @@ class VruiSceneGraphDemo:public Vrui::Application
 	VruiSceneGraphDemo(int& argc,char**& argv,char**& appDefaults);
 	
 	/* Methods: */
+	virtual void frame(void);
 	virtual void display(GLContextData& contextData) const;
 	};
 
@@ -99,10 +101,21 @@ VruiSceneGraphDemo::VruiSceneGraphDemo(int& argc,char**& argv,char**& appDefault
 	Vrui::setNavigationTransformation(Geometry::mid(bbox.min,bbox.max),Geometry::dist(bbox.min,bbox.max));
 	}
 
+void VruiSceneGraphDemo::frame(void)
+	{
+	/* Swap in any inline nodes that finished loading in the background: */
+	SceneGraph::InlineNode::finishBackgroundLoads(Vrui::getMainPipe());
+	
+	/* Keep checking while there are unfinished loads: */
+	if(SceneGraph::InlineNode::haveBackgroundLoads())
+		Vrui::scheduleUpdate(Vrui::getApplicationTime()+0.1);
+	}
+
 void VruiSceneGraphDemo::display(GLContextData& contextData) const
 	{
 	/* Create a GL render state object: */
 	SceneGraph::GLRenderState glRenderState(contextData,Vrui::getHeadPosition(),Vrui::getNavigationTransformation().inverseTransform(Vrui::getUpDirection()));
+	glRenderState.time=Vrui::getApplicationTime();
 	
 	/* Render the scene graph: */
 	root->glRenderAction(glRenderState);
@@ -0,0 +1,81 @@
+/***********************************************************************
+GLEXTBlendFuncSeparate - OpenGL extension class for the
+GL_EXT_blend_func_separate extension.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the OpenGL Support Library (GLSupport).
+
+The OpenGL Support Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The OpenGL Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the OpenGL Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <GL/Extensions/GLEXTBlendFuncSeparate.h>
+
+#include <GL/gl.h>
+#include <GL/GLContextData.h>
+#include <GL/GLExtensionManager.h>
+
+/***********************************************
+Static elements of class GLEXTBlendFuncSeparate:
+***********************************************/
+
+GL_THREAD_LOCAL(GLEXTBlendFuncSeparate*) GLEXTBlendFuncSeparate::current=0;
+
+/***************************************
+Methods of class GLEXTBlendFuncSeparate:
+***************************************/
+
+GLEXTBlendFuncSeparate::GLEXTBlendFuncSeparate(void)
+	{
+	/* Get all function pointers: */
+	glBlendFuncSeparateEXTProc=GLExtensionManager::getFunction<PFNGLBLENDFUNCSEPARATEEXTPROC>("glBlendFuncSeparateEXT");
+	}
+
+GLEXTBlendFuncSeparate::~GLEXTBlendFuncSeparate(void)
+	{
+	}
+
+const char* GLEXTBlendFuncSeparate::getExtensionName(void) const
+	{
+	return "GL_EXT_blend_func_separate";
+	}
+
+void GLEXTBlendFuncSeparate::activate(void)
+	{
+	current=this;
+	}
+
+void GLEXTBlendFuncSeparate::deactivate(void)
+	{
+	current=0;
+	}
+
+bool GLEXTBlendFuncSeparate::isSupported(void)
+	{
+	/* Ask the current extension manager whether the extension is supported in the current OpenGL context: */
+	return GLExtensionManager::isExtensionSupported("GL_EXT_blend_func_separate");
+	}
+
+void GLEXTBlendFuncSeparate::initExtension(void)
+	{
+	/* Check if the extension is already initialized: */
+	if(!GLExtensionManager::isExtensionRegistered("GL_EXT_blend_func_separate"))
+		{
+		/* Create a new extension object: */
+		GLEXTBlendFuncSeparate* newExtension=new GLEXTBlendFuncSeparate;
+		
+		/* Register the extension with the current extension manager: */
+		GLExtensionManager::registerExtension(newExtension);
+		}
+	}
@@ -0,0 +1,81 @@
+/***********************************************************************
+GLEXTBlendFuncSeparate - OpenGL extension class for the
+GL_EXT_blend_func_separate extension.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the OpenGL Support Library (GLSupport).
+
+The OpenGL Support Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The OpenGL Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the OpenGL Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef GLEXTENSIONS_GLEXTBLENDFUNCSEPARATE_INCLUDED
+#define GLEXTENSIONS_GLEXTBLENDFUNCSEPARATE_INCLUDED
+
+#include <GL/gl.h>
+#include <GL/TLSHelper.h>
+#include <GL/Extensions/GLExtension.h>
+
+/********************************
+Extension-specific parts of gl.h:
+********************************/
+
+#ifndef GL_EXT_blend_func_separate
+#define GL_EXT_blend_func_separate 1
+
+/* Extension-specific functions: */
+typedef void (APIENTRY * PFNGLBLENDFUNCSEPARATEEXTPROC) (GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha);
+
+/* Extension-specific constants: */
+#define GL_BLEND_DST_RGB_EXT              0x80C8
+#define GL_BLEND_SRC_RGB_EXT              0x80C9
+#define GL_BLEND_DST_ALPHA_EXT            0x80CA
+#define GL_BLEND_SRC_ALPHA_EXT            0x80CB
+
+#endif
+
+class GLEXTBlendFuncSeparate:public GLExtension
+	{
+	/* Elements: */
+	private:
+	static GL_THREAD_LOCAL(GLEXTBlendFuncSeparate*) current; // Pointer to extension object for current OpenGL context
+	
+	PFNGLBLENDFUNCSEPARATEEXTPROC glBlendFuncSeparateEXTProc;
+	
+	/* Constructors and destructors: */
+	private:
+	GLEXTBlendFuncSeparate(void);
+	public:
+	virtual ~GLEXTBlendFuncSeparate(void);
+	
+	/* Methods: */
+	public:
+	virtual const char* getExtensionName(void) const;
+	virtual void activate(void);
+	virtual void deactivate(void);
+	static bool isSupported(void); // Returns true if the extension is supported in the current OpenGL context
+	static void initExtension(void); // Initializes the extension in the current OpenGL context
+	
+	/* Extension entry points: */
+	inline friend void glBlendFuncSeparateEXT(GLenum sfactorRGB,GLenum dfactorRGB,GLenum sfactorAlpha,GLenum dfactorAlpha)
+		{
+		GLEXTBlendFuncSeparate::current->glBlendFuncSeparateEXTProc(sfactorRGB,dfactorRGB,sfactorAlpha,dfactorAlpha);
+		}
+	};
+
+/*******************************
+Extension-specific entry points:
+*******************************/
+
+#endif
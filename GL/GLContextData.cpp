@@ -36,7 +36,8 @@ Methods of class GLContextData:
 ******************************/
 
 GLContextData::GLContextData(int sTableSize,float sWaterMark,float sGrowRate)
-	:context(sTableSize,sWaterMark,sGrowRate)
+	:context(sTableSize,sWaterMark,sGrowRate),
+	 auxiliaryLists(17)
 	{
 	}
 
@@ -45,6 +46,11 @@ GLContextData::~GLContextData(void)
 	/* Delete all data items in this context: */
 	for(ItemHash::Iterator it=context.begin();!it.isFinished();++it)
 		delete it->getDest();
+	
+	/* Delete all auxiliary display lists: */
+	for(AuxiliaryListHash::Iterator alIt=auxiliaryLists.begin();!alIt.isFinished();++alIt)
+		for(std::vector<GLuint>::iterator lIt=alIt->getDest().begin();lIt!=alIt->getDest().end();++lIt)
+			glDeleteLists(*lIt,1);
 	}
 
 void GLContextData::initThing(const GLObject* thing)
@@ -91,3 +97,78 @@ void GLContextData::makeCurrent(GLContextData* newCurrentContextData)
 		currentContextDataChangedCallbacks.call(&cbData);
 		}
 	}
+
+void GLContextData::newList(GLuint listId,GLenum mode)
+	{
+	if(!listCompilations.empty())
+		{
+		/* OpenGL cannot nest display list compilations; split the enclosing display list: */
+		ListCompilation& outer=listCompilations.back();
+		if(outer.tailListId==0)
+			{
+			/* End the enclosing list's first segment with a call to a new, still empty, tail list: */
+			outer.tailListId=glGenLists(1);
+			outer.auxiliaryLists.push_back(outer.tailListId);
+			glCallList(outer.tailListId);
+			}
+		
+		/* Finish the enclosing list's current segment: */
+		glEndList();
+		}
+	
+	/* Delete the auxiliary display lists of the display list's previous contents: */
+	AuxiliaryListHash::Iterator alIt=auxiliaryLists.findEntry(listId);
+	if(!alIt.isFinished())
+		{
+		for(std::vector<GLuint>::iterator lIt=alIt->getDest().begin();lIt!=alIt->getDest().end();++lIt)
+			glDeleteLists(*lIt,1);
+		auxiliaryLists.removeEntry(alIt);
+		}
+	
+	/* Start compiling the display list: */
+	ListCompilation lc;
+	lc.listId=listId;
+	lc.mode=mode;
+	lc.tailListId=0;
+	listCompilations.push_back(lc);
+	glNewList(listId,mode);
+	}
+
+void GLContextData::endList(void)
+	{
+	/* Finish the display list's current segment, unless a display list compiled directly via glNewList already ended it: */
+	GLint listIndex=0;
+	glGetIntegerv(GL_LIST_INDEX,&listIndex);
+	if(listIndex!=0)
+		glEndList();
+	ListCompilation& lc=listCompilations.back();
+	if(lc.tailListId!=0)
+		{
+		/* Compile the tail list to replay all nested display lists and subsequent segments in order: */
+		glNewList(lc.tailListId,GL_COMPILE);
+		for(std::vector<GLuint>::iterator tcIt=lc.tailCalls.begin();tcIt!=lc.tailCalls.end();++tcIt)
+			glCallList(*tcIt);
+		glEndList();
+		
+		/* Keep the auxiliary display lists until the display list is compiled again: */
+		auxiliaryLists.setEntry(AuxiliaryListHash::Entry(lc.listId,lc.auxiliaryLists));
+		}
+	GLuint listId=lc.listId;
+	GLenum mode=lc.mode;
+	listCompilations.pop_back();
+	
+	if(!listCompilations.empty())
+		{
+		ListCompilation& outer=listCompilations.back();
+		
+		/* Record the nested display list in the enclosing list if its contents were executed: */
+		if(mode==GL_COMPILE_AND_EXECUTE)
+			outer.tailCalls.push_back(listId);
+		
+		/* Continue the enclosing list in a new segment: */
+		GLuint segmentId=glGenLists(1);
+		outer.auxiliaryLists.push_back(segmentId);
+		outer.tailCalls.push_back(segmentId);
+		glNewList(segmentId,outer.mode);
+		}
+	}
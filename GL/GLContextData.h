@@ -23,9 +23,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef GLCONTEXTDATA_INCLUDED
 #define GLCONTEXTDATA_INCLUDED
 
+#include <vector>
 #include <Misc/HashTable.h>
 #include <Misc/CallbackData.h>
 #include <Misc/CallbackList.h>
+#include <GL/gl.h>
 #include <GL/TLSHelper.h>
 #include <GL/GLObject.h>
 
@@ -50,10 +52,25 @@ class GLContextData
 	private:
 	typedef Misc::HashTable<const GLObject*,GLObject::DataItem*> ItemHash; // Class for hash table mapping pointers to data items
 	
+	struct ListCompilation // Structure describing a display list currently being compiled via newList
+		{
+		/* Elements: */
+		public:
+		GLuint listId; // ID of the compiled display list
+		GLenum mode; // Compilation mode of the display list
+		GLuint tailListId; // ID of the display list called at the end of the list's first segment to replay everything after the first nested compilation, or 0 if no compilation was nested yet
+		std::vector<GLuint> tailCalls; // IDs of nested display lists and of the list's subsequent segments, in the order in which the tail list calls them
+		std::vector<GLuint> auxiliaryLists; // IDs of the tail list and all subsequent segments, which are owned by the compiled display list
+		};
+	
+	typedef Misc::HashTable<GLuint,std::vector<GLuint> > AuxiliaryListHash; // Class for hash table mapping display list IDs to the IDs of their auxiliary display lists
+	
 	/* Elements: */
 	static Misc::CallbackList currentContextDataChangedCallbacks; // List of callbacks called whenever the current context data object changes
 	static GL_THREAD_LOCAL(GLContextData*) currentContextData; // Pointer to the current context data object (associated with the current OpenGL context)
 	ItemHash context; // A hash table for the context
+	std::vector<ListCompilation> listCompilations; // Stack of display lists currently being compiled via newList, innermost last
+	AuxiliaryListHash auxiliaryLists; // Auxiliary display lists of all display lists whose compilation was split by nested compilations
 	
 	/* Constructors and destructors: */
 	public:
@@ -79,6 +96,14 @@ class GLContextData
 		}
 	static void makeCurrent(GLContextData* newCurrentContextData); // Sets the given context data object as the current one
 	
+	/* Methods to compile display lists during rendering: */
+	void newList(GLuint listId,GLenum mode); // Starts compiling the given display list like glNewList; can be called while another display list is being compiled via newList
+	void endList(void); // Finishes compiling the innermost display list started via newList like glEndList
+	bool isCompilingList(void) const // Returns true if a display list is currently being compiled via newList
+		{
+		return !listCompilations.empty();
+		}
+	
 	/* Methods to store/retrieve context data items: */
 	bool isRealized(const GLObject* thing) const
 		{
@@ -32,6 +32,33 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLTexEnvTemplates.h>
 #include <GL/GLTexCoordTemplates.h>
 #include <GL/GLVertexTemplates.h>
+#include <GL/GLContextData.h>
+
+namespace {
+
+/**************************************
+Layout constants of glyph atlas images:
+**************************************/
+
+const GLsizei atlasPadding=2; // Number of empty texels around each character cell to support antialiasing and bilinear filtering
+const GLsizei atlasSolidSize=4; // Size of the fully opaque square in the lower-left corner of the glyph atlas
+
+}
+
+/*********************************
+Methods of class GLFont::DataItem:
+*********************************/
+
+GLFont::DataItem::DataItem(void)
+	:atlasTextureObjectId(0)
+	{
+	glGenTextures(1,&atlasTextureObjectId);
+	}
+
+GLFont::DataItem::~DataItem(void)
+	{
+	glDeleteTextures(1,&atlasTextureObjectId);
+	}
 
 /*********************************
 Methods of class GLFont::CharInfo:
@@ -70,59 +97,10 @@ GLsizei GLFont::calcStringWidth(const char* string) const
 
 void GLFont::uploadStringTexture(const char* string,GLsizei stringWidth,GLsizei textureWidth) const
 	{
-	/* Calculate the proper texture image dimensions: */
-	GLsizei imageWidth,imageHeight;
-	int x,baseLineRow;
-	if(antialiasing)
-		{
-		imageWidth=stringWidth;
-		imageHeight=fontHeight;
-		baseLineRow=baseLine;
-		x=maxLeftLap+1;
-		}
-	else
-		{
-		imageWidth=stringWidth;
-		imageHeight=fontHeight;
-		baseLineRow=baseLine;
-		x=maxLeftLap+1;
-		}
-	
-	/* Create a luminance-only texture image of appropriate size: */
-	GLubyte* image=new GLubyte[imageWidth*imageHeight];
-	memset(image,255,imageWidth*imageHeight);
-	
-	if(string!=0)
-		{
-		/* Copy all characters into the texture image: */
-		for(const char* cPtr=string;*cPtr!=0;++cPtr)
-			{
-			int charIndex=int(*cPtr)-firstCharacter;
-			if(charIndex>=0&&charIndex<numCharacters)
-				{
-				const CharInfo* ciPtr=&characters[charIndex];
-				const unsigned char* rasterLine=&rasterLines[ciPtr->rasterLineOffset];
-				const unsigned char* span=&spans[ciPtr->spanOffset];
-				
-				/* Copy all raster lines: */
-				for(int y=baseLineRow-ciPtr->descent;y<baseLineRow+ciPtr->ascent;++y,++rasterLine)
-					{
-					/* Copy all spans in this line: */
-					GLubyte* texPtr=&image[imageWidth*y+x+ciPtr->glyphOffset];
-					int numSpans=int(*rasterLine);
-					for(int i=0;i<numSpans;++i,++span)
-						{
-						texPtr+=int((*span)>>3);
-						int numPixels=int((*span)&0x07);
-						for(int j=0;j<numPixels;++j,++texPtr)
-							*texPtr=GLubyte(0);
-						}
-					}
-				
-				x+=ciPtr->width;
-				}
-			}
-		}
+	/* Create a luminance-only texture image of the string: */
+	GLubyte* image=createStringImage(string,stringWidth);
+	GLsizei imageWidth=stringWidth;
+	GLsizei imageHeight=fontHeight;
 	
 	/* Upload the created texture image: */
 	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP);
@@ -383,6 +361,49 @@ void GLFont::loadFont(IO::File& file)
 	for(GLint i=0;i<10;++i)
 		totalWidth+=characters[i+GLint('0')-firstCharacter].width;
 	averageWidth=GLfloat(totalWidth)/(10.0f*GLfloat(fontHeight));
+	
+	/* Assign glyph atlas cells to all characters: */
+	layoutAtlas();
+	}
+
+void GLFont::layoutAtlas(void)
+	{
+	/* Calculate the total area of all character cells: */
+	GLsizei cellHeight=fontHeight+2*atlasPadding;
+	GLsizei maxCellWidth=atlasSolidSize;
+	GLsizei totalArea=atlasSolidSize*cellHeight;
+	for(GLsizei i=0;i<numCharacters;++i)
+		{
+		GLsizei cellWidth=characters[i].width+maxLeftLap+maxRightLap+2*atlasPadding;
+		if(maxCellWidth<cellWidth)
+			maxCellWidth=cellWidth;
+		totalArea+=cellWidth*cellHeight;
+		}
+	
+	/* Make the atlas roughly square: */
+	for(atlasWidth=1;atlasWidth<maxCellWidth||atlasWidth*atlasWidth<totalArea;atlasWidth<<=1)
+		;
+	
+	/* Assign cells row by row, starting to the right of the opaque square: */
+	GLsizei x=atlasSolidSize;
+	GLsizei y=0;
+	for(GLsizei i=0;i<numCharacters;++i)
+		{
+		GLsizei cellWidth=characters[i].width+maxLeftLap+maxRightLap+2*atlasPadding;
+		if(x+cellWidth>atlasWidth)
+			{
+			/* Start a new row: */
+			x=0;
+			y+=cellHeight;
+			}
+		characters[i].atlasX=x+atlasPadding;
+		characters[i].atlasY=y+atlasPadding;
+		x+=cellWidth;
+		}
+	
+	/* Calculate the atlas height: */
+	for(atlasHeight=1;atlasHeight<y+cellHeight;atlasHeight<<=1)
+		;
 	}
 
 GLFont::GLFont(const char* fontName)
@@ -391,8 +412,9 @@ GLFont::GLFont(const char* fontName)
 	 numRasterLines(0),rasterLines(0),
 	 numSpans(0),spans(0),
 	 fontHeight(0),textureHeight(0),
+	 atlasWidth(0),atlasHeight(0),
 	 textHeight(1.0),hAlignment(Left),vAlignment(Baseline),
-	 antialiasing(false)
+	 antialiasing(false),atlasRendering(false)
 	{
 	/* Read the font from file: */
 	char fontFileName[1024];
@@ -453,6 +475,217 @@ GLFont::~GLFont(void)
 	delete[] spans;
 	}
 
+void GLFont::initContext(GLContextData& contextData) const
+	{
+	/* Create a data item and store it in the context: */
+	DataItem* dataItem=new DataItem;
+	contextData.addDataItem(this,dataItem);
+	
+	if(characters!=0)
+		{
+		/* Upload the glyph atlas as an alpha-only texture: */
+		GLubyte* image=createAtlasImage();
+		glBindTexture(GL_TEXTURE_2D,dataItem->atlasTextureObjectId);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS,0);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH,0);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS,0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+		glTexImage2D(GL_TEXTURE_2D,0,GL_ALPHA8,atlasWidth,atlasHeight,0,GL_ALPHA,GL_UNSIGNED_BYTE,image);
+		glBindTexture(GL_TEXTURE_2D,0);
+		delete[] image;
+		}
+	}
+
+GLubyte* GLFont::createAtlasImage(void) const
+	{
+	/* Create an empty alpha-only image: */
+	GLubyte* image=new GLubyte[atlasWidth*atlasHeight];
+	memset(image,0,atlasWidth*atlasHeight);
+	
+	/* Fill the opaque square used for string backgrounds: */
+	for(GLsizei y=0;y<atlasSolidSize;++y)
+		memset(image+y*atlasWidth,255,atlasSolidSize);
+	
+	/* Copy all characters into their cells: */
+	for(GLsizei charIndex=0;charIndex<numCharacters;++charIndex)
+		{
+		const CharInfo* ciPtr=&characters[charIndex];
+		const unsigned char* rasterLine=&rasterLines[ciPtr->rasterLineOffset];
+		const unsigned char* span=&spans[ciPtr->spanOffset];
+		
+		/* Copy all raster lines: */
+		for(int y=baseLine-ciPtr->descent;y<baseLine+ciPtr->ascent;++y,++rasterLine)
+			{
+			/* Copy all spans in this line: */
+			GLubyte* imgPtr=&image[atlasWidth*(ciPtr->atlasY+y)+ciPtr->atlasX+maxLeftLap+ciPtr->glyphOffset];
+			int numSpans=int(*rasterLine);
+			for(int i=0;i<numSpans;++i,++span)
+				{
+				imgPtr+=int((*span)>>3);
+				int numPixels=int((*span)&0x07);
+				for(int j=0;j<numPixels;++j,++imgPtr)
+					*imgPtr=GLubyte(255);
+				}
+			}
+		}
+	
+	if(antialiasing)
+		{
+		/* Apply the same separable 1-2-1 filter used for string textures in both directions: */
+		GLubyte* row=new GLubyte[atlasWidth>atlasHeight?atlasWidth:atlasHeight];
+		for(GLsizei y=0;y<atlasHeight;++y)
+			{
+			GLubyte* iPtr=image+y*atlasWidth;
+			memcpy(row,iPtr,atlasWidth);
+			for(GLsizei x=0;x<atlasWidth;++x)
+				{
+				int l=row[x>0?x-1:x];
+				int r=row[x<atlasWidth-1?x+1:x];
+				iPtr[x]=GLubyte((l+2*int(row[x])+r+2)/4);
+				}
+			}
+		for(GLsizei x=0;x<atlasWidth;++x)
+			{
+			for(GLsizei y=0;y<atlasHeight;++y)
+				row[y]=image[y*atlasWidth+x];
+			for(GLsizei y=0;y<atlasHeight;++y)
+				{
+				int b=row[y>0?y-1:y];
+				int t=row[y<atlasHeight-1?y+1:y];
+				image[y*atlasWidth+x]=GLubyte((b+2*int(row[y])+t+2)/4);
+				}
+			}
+		delete[] row;
+		}
+	
+	return image;
+	}
+
+GLubyte* GLFont::createStringImage(const char* string,GLsizei stringWidth) const
+	{
+	/* Calculate the image dimensions: */
+	GLsizei imageWidth=stringWidth;
+	GLsizei imageHeight=fontHeight;
+	int baseLineRow=baseLine;
+	int x=maxLeftLap+1;
+	
+	/* Create a white luminance-only image: */
+	GLubyte* image=new GLubyte[imageWidth*imageHeight];
+	memset(image,255,imageWidth*imageHeight);
+	
+	if(string!=0)
+		{
+		/* Copy all characters into the texture image: */
+		for(const char* cPtr=string;*cPtr!=0;++cPtr)
+			{
+			int charIndex=int(*cPtr)-firstCharacter;
+			if(charIndex>=0&&charIndex<numCharacters)
+				{
+				const CharInfo* ciPtr=&characters[charIndex];
+				const unsigned char* rasterLine=&rasterLines[ciPtr->rasterLineOffset];
+				const unsigned char* span=&spans[ciPtr->spanOffset];
+				
+				/* Copy all raster lines: */
+				for(int y=baseLineRow-ciPtr->descent;y<baseLineRow+ciPtr->ascent;++y,++rasterLine)
+					{
+					/* Copy all spans in this line: */
+					GLubyte* texPtr=&image[imageWidth*y+x+ciPtr->glyphOffset];
+					int numSpans=int(*rasterLine);
+					for(int i=0;i<numSpans;++i,++span)
+						{
+						texPtr+=int((*span)>>3);
+						int numPixels=int((*span)&0x07);
+						for(int j=0;j<numPixels;++j,++texPtr)
+							*texPtr=GLubyte(0);
+						}
+					}
+				
+				x+=ciPtr->width;
+				}
+			}
+		}
+	
+	return image;
+	}
+
+GLFont::TBox GLFont::getAtlasSolidTexCoords(void) const
+	{
+	/* Return the center of the opaque square, where filtering does not reach any transparent texels: */
+	GLfloat half=GLfloat(atlasSolidSize)*0.5f;
+	return TBox(GLVector<GLfloat,2>(half/GLfloat(atlasWidth),half/GLfloat(atlasHeight)),GLVector<GLfloat,2>(0.0f,0.0f));
+	}
+
+void GLFont::bindAtlasTexture(GLContextData& contextData) const
+	{
+	/* Retrieve the context data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	
+	/* Bind the glyph atlas texture: */
+	glBindTexture(GL_TEXTURE_2D,dataItem->atlasTextureObjectId);
+	}
+
+void GLFont::calcAtlasQuads(const char* string,GLsizei textureWidth,const GLFont::TBox& textureBox,const GLFont::TBox& stringBox,std::vector<GLFont::AtlasQuad>& quads) const
+	{
+	if(string==0)
+		return;
+	
+	/* Convert the string's texture coordinate box to texel space: */
+	GLfloat sMin=textureBox.origin[0]*GLfloat(textureWidth);
+	GLfloat sMax=(textureBox.origin[0]+textureBox.size[0])*GLfloat(textureWidth);
+	GLfloat tMin=textureBox.origin[1]*GLfloat(textureHeight);
+	GLfloat tMax=(textureBox.origin[1]+textureBox.size[1])*GLfloat(textureHeight);
+	if(sMax<=sMin||tMax<=tMin)
+		return;
+	
+	/* Calculate the scale factors from texel space to model space: */
+	GLfloat sScale=stringBox.size[0]/(sMax-sMin);
+	GLfloat tScale=stringBox.size[1]/(tMax-tMin);
+	
+	/* Clip the character cells' common vertical extent: */
+	GLfloat t0=tMin>0.0f?tMin:0.0f;
+	GLfloat t1=tMax<GLfloat(fontHeight)?tMax:GLfloat(fontHeight);
+	if(t1<=t0)
+		return;
+	
+	/* Create a quad for each character whose cell overlaps the texel-space box: */
+	GLfloat x=GLfloat(maxLeftLap+1);
+	for(const char* cPtr=string;*cPtr!=0&&x-GLfloat(maxLeftLap)<sMax;++cPtr)
+		{
+		int charIndex=int(*cPtr)-firstCharacter;
+		if(charIndex>=0&&charIndex<numCharacters)
+			{
+			const CharInfo* ciPtr=&characters[charIndex];
+			
+			/* Calculate and clip the character's cell in texel space: */
+			GLfloat s0=x-GLfloat(maxLeftLap);
+			GLfloat s1=x+GLfloat(ciPtr->width+maxRightLap);
+			GLfloat cs0=s0>sMin?s0:sMin;
+			GLfloat cs1=s1<sMax?s1:sMax;
+			
+			/* Skip characters without glyphs, such as spaces: */
+			if(cs0<cs1&&ciPtr->ascent+ciPtr->descent>0)
+				{
+				AtlasQuad quad;
+				quad.modelBox.origin[0]=stringBox.origin[0]+(cs0-sMin)*sScale;
+				quad.modelBox.origin[1]=stringBox.origin[1]+(t0-tMin)*tScale;
+				quad.modelBox.size[0]=(cs1-cs0)*sScale;
+				quad.modelBox.size[1]=(t1-t0)*tScale;
+				quad.atlasBox.origin[0]=(GLfloat(ciPtr->atlasX)+cs0-s0)/GLfloat(atlasWidth);
+				quad.atlasBox.origin[1]=(GLfloat(ciPtr->atlasY)+t0)/GLfloat(atlasHeight);
+				quad.atlasBox.size[0]=(cs1-cs0)/GLfloat(atlasWidth);
+				quad.atlasBox.size[1]=(t1-t0)/GLfloat(atlasHeight);
+				quads.push_back(quad);
+				}
+			
+			x+=GLfloat(ciPtr->width);
+			}
+		}
+	}
+
 GLFont::Vector GLFont::calcStringSize(GLsizei stringWidth) const
 	{
 	/* Return the string's scaled width: */
@@ -22,19 +22,21 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef GLFONT_INCLUDED
 #define GLFONT_INCLUDED
 
+#include <vector>
 #include <Misc/Endianness.h>
 #include <GL/gl.h>
 #include <GL/GLColor.h>
 #include <GL/GLVector.h>
 #include <GL/GLBox.h>
 #include <GL/GLString.h>
+#include <GL/GLObject.h>
 
 /* Forward declarations: */
 namespace IO {
 class File;
 }
 
-class GLFont
+class GLFont:public GLObject
 	{
 	/* Embedded classes: */
 	public:
@@ -53,7 +55,26 @@ class GLFont
 		Top,VCenter,Baseline,Bottom
 		};
 	
+	struct AtlasQuad // Structure describing a quad rendering one character, or part of one character, from the font's glyph atlas
+		{
+		/* Elements: */
+		public:
+		TBox modelBox; // Position and size of the quad in the string's model-space plane
+		TBox atlasBox; // Texture coordinates of the quad in the glyph atlas
+		};
+	
 	private:
+	struct DataItem:public GLObject::DataItem
+		{
+		/* Elements: */
+		public:
+		GLuint atlasTextureObjectId; // ID of texture object containing the font's glyph atlas
+		
+		/* Constructors and destructors: */
+		DataItem(void);
+		virtual ~DataItem(void);
+		};
+	
 	struct CharInfo
 		{
 		/* Elements: */
@@ -65,6 +86,9 @@ class GLFont
 		GLsizei rasterLineOffset; // Offset of raster line descriptors in main array
 		GLsizei spanOffset; // Offset of span descriptors in main array
 		
+		/* Glyph atlas description (not stored in font file): */
+		GLsizei atlasX,atlasY; // Texel position of the lower-left corner of the character's cell in the glyph atlas
+		
 		/* Methods: */
 		void read(IO::File& file); // Reads a CharInfo structure from a font file
 		};
@@ -83,6 +107,7 @@ class GLFont
 	GLint baseLine; // Position of baseline
 	GLsizei textureHeight; // Height of a texture image to hold a single line of text
 	GLfloat averageWidth; // Average width of a character box
+	GLsizei atlasWidth,atlasHeight; // Size of the glyph atlas texture image holding all characters
 	
 	/* Current font status: */
 	GLfloat textHeight; // Scaled height of font
@@ -91,6 +116,7 @@ class GLFont
 	HAlignment hAlignment; // Horizontal alignment
 	VAlignment vAlignment; // Vertical alignment
 	bool antialiasing; // Flag to enable antialiasing
+	bool atlasRendering; // Flag whether labels using this font are rendered as batches of quads from the glyph atlas instead of per-string textures
 	
 	/* Private methods: */
 	GLsizei calcStringWidth(const char* string) const; // Calculates the texel width of a string
@@ -98,13 +124,17 @@ class GLFont
 	void uploadStringTexture(const char* string,const Color& stringBackgroundColor,const Color& stringForegroundColor,GLsizei stringWidth,GLsizei textureWidth) const; // Creates and uploads a texture for a string using the given colors
 	void uploadStringTexture(const char* string,const Color& stringBackgroundColor,const Color& stringForegroundColor,GLsizei selectionStart,GLsizei selectionEnd,const Color& selectionBackgroundColor,const Color& selectionForegroundColor,GLsizei stringWidth,GLsizei textureWidth) const; // Creates and uploads a texture for a string using the given colors, selection range, and selection colors
 	void loadFont(IO::File& file); // Loads font from given file
+	void layoutAtlas(void); // Assigns cells in the glyph atlas to all characters
 	
 	/* Constructors and Destructors: */
 	public:
 	GLFont(const char* fontName); // Creates a GL font from a font file
 	~GLFont(void);
 	
-	/* Methods: */
+	/* Methods from GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
+	
+	/* New methods: */
 	bool isValid(void) const // Checks if the font object was created successfully
 		{
 		return characters!=0;
@@ -155,6 +185,31 @@ class GLFont
 		{
 		antialiasing=newAntialiasing;
 		}
+	bool isAtlasRendering(void) const // Returns true if labels using this font are rendered from the glyph atlas
+		{
+		return atlasRendering;
+		}
+	void setAtlasRendering(bool newAtlasRendering) // Sets the glyph atlas rendering flag
+		{
+		atlasRendering=newAtlasRendering;
+		}
+	GLsizei getAtlasWidth(void) const // Returns the width of the glyph atlas texture image
+		{
+		return atlasWidth;
+		}
+	GLsizei getAtlasHeight(void) const // Returns the height of the glyph atlas texture image
+		{
+		return atlasHeight;
+		}
+	GLubyte* createAtlasImage(void) const; // Returns a new[]-allocated alpha-only image of the glyph atlas
+	GLubyte* createStringImage(const char* string,GLsizei stringWidth) const; // Returns a new[]-allocated luminance-only image of the given string of the given texel width and the font's texel height, as uploaded into string textures by uploadStringTexture
+	TBox getAtlasSolidTexCoords(void) const; // Returns texture coordinates of a fully opaque region of the glyph atlas to render string backgrounds
+	void bindAtlasTexture(GLContextData& contextData) const; // Binds the glyph atlas texture object of the given OpenGL context to GL_TEXTURE_2D
+	void calcAtlasQuads(const char* string,GLsizei textureWidth,const TBox& textureBox,const TBox& stringBox,std::vector<AtlasQuad>& quads) const; // Appends glyph atlas quads for all characters of the given string that overlap the given region of its string texture, mapped to the given model-space rectangle
+	void calcAtlasQuads(const GLString& string,const TBox& stringBox,std::vector<AtlasQuad>& quads) const // Ditto, for the string's entire current texture coordinate box
+		{
+		calcAtlasQuads(string.string,string.textureWidth,string.textureBox,stringBox,quads);
+		}
 	Vector calcStringSize(GLsizei stringWidth) const; // Returns the size of the bounding box of a string
 	Vector calcStringSize(const char* string) const // Ditto
 		{
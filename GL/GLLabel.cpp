@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <GL/GLLabel.h>
 
+#include <algorithm>
 #include <GL/gl.h>
 #include <GL/GLColorTemplates.h>
 #include <GL/GLTexCoordTemplates.h>
@@ -29,6 +30,46 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLVector.h>
 #include <GL/GLFont.h>
 #include <GL/GLContextData.h>
+#include <GL/GLVertexArrayParts.h>
+#include <GL/GLVertex.h>
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+typedef GLVertex<GLfloat,2,GLubyte,4,void,GLfloat,3> AtlasVertex; // Type for vertices of glyph atlas quads
+
+inline void addAtlasQuad(std::vector<AtlasVertex>& vertices,const GLFont::TBox& modelBox,GLfloat z,const GLFont::TBox& atlasBox,const GLColor<GLubyte,4>& color) // Appends a glyph atlas quad in counter-clockwise order
+	{
+	static const int cornerOrder[4]={0,1,3,2};
+	for(int i=0;i<4;++i)
+		{
+		AtlasVertex v;
+		GLFont::TBox::Vector tc=atlasBox.getCorner(cornerOrder[i]);
+		GLFont::TBox::Vector p=modelBox.getCorner(cornerOrder[i]);
+		v.texCoord[0]=tc[0];
+		v.texCoord[1]=tc[1];
+		v.color=color;
+		v.position[0]=p[0];
+		v.position[1]=p[1];
+		v.position[2]=z;
+		vertices.push_back(v);
+		}
+	}
+
+class LabelFontOrder // Functor class to sort labels by font
+	{
+	/* Methods: */
+	public:
+	bool operator()(const GLLabel* l1,const GLLabel* l2) const
+		{
+		return l1->getFont()<l2->getFont();
+		}
+	};
+
+}
 
 /**************************************************
 Static elements of class GLLabel::DeferredRenderer:
@@ -63,6 +104,38 @@ void GLLabel::DeferredRenderer::draw(void)
 	if(gatheredLabels.empty())
 		return;
 	
+	/* Move all labels whose fonts render from glyph atlases into a separate list: */
+	std::vector<const GLLabel*>::iterator keepIt=gatheredLabels.begin();
+	for(std::vector<const GLLabel*>::iterator lIt=gatheredLabels.begin();lIt!=gatheredLabels.end();++lIt)
+		{
+		if((*lIt)->font->isAtlasRendering())
+			atlasLabels.push_back(*lIt);
+		else
+			{
+			*keepIt=*lIt;
+			++keepIt;
+			}
+		}
+	gatheredLabels.erase(keepIt,gatheredLabels.end());
+	
+	if(!atlasLabels.empty())
+		{
+		/* Draw the atlas-rendered labels in one batch per font: */
+		std::sort(atlasLabels.begin(),atlasLabels.end(),LabelFontOrder());
+		std::vector<const GLLabel*>::iterator groupBegin=atlasLabels.begin();
+		while(groupBegin!=atlasLabels.end())
+			{
+			std::vector<const GLLabel*>::iterator groupEnd;
+			for(groupEnd=groupBegin+1;groupEnd!=atlasLabels.end()&&(*groupEnd)->font==(*groupBegin)->font;++groupEnd)
+				;
+			GLLabel::drawAtlasLabels(&*groupBegin,groupEnd-groupBegin,contextData);
+			groupBegin=groupEnd;
+			}
+		atlasLabels.clear();
+		}
+	if(gatheredLabels.empty())
+		return;
+	
 	/* Save and set up OpenGL state: */
 	GLbitfield attribPushMask=GL_TEXTURE_BIT;
 	bool lightingOn=glIsEnabled(GL_LIGHTING);
@@ -138,6 +211,68 @@ bool GLLabel::DeferredRenderer::addLabel(const GLLabel* label)
 Methods of class GLLabel:
 ************************/
 
+void GLLabel::drawAtlasLabels(const GLLabel* const* labels,size_t numLabels,GLContextData& contextData)
+	{
+	const GLFont* font=labels[0]->font;
+	
+	/* Generate background quads for all labels, followed by character quads for all labels: */
+	std::vector<AtlasVertex> vertices;
+	GLFont::TBox solidBox=font->getAtlasSolidTexCoords();
+	for(size_t i=0;i<numLabels;++i)
+		{
+		const GLLabel* l=labels[i];
+		GLFont::TBox box(GLFont::TBox::Vector(l->labelBox.origin[0],l->labelBox.origin[1]),GLFont::TBox::Vector(l->labelBox.size[0],l->labelBox.size[1]));
+		addAtlasQuad(vertices,box,l->labelBox.origin[2],solidBox,GLColor<GLubyte,4>(l->background));
+		}
+	GLsizei numBackgroundVertices=GLsizei(vertices.size());
+	std::vector<GLFont::AtlasQuad> quads;
+	for(size_t i=0;i<numLabels;++i)
+		{
+		const GLLabel* l=labels[i];
+		GLFont::TBox box(GLFont::TBox::Vector(l->labelBox.origin[0],l->labelBox.origin[1]),GLFont::TBox::Vector(l->labelBox.size[0],l->labelBox.size[1]));
+		quads.clear();
+		font->calcAtlasQuads(*l,box,quads);
+		GLColor<GLubyte,4> foreground(l->foreground);
+		for(std::vector<GLFont::AtlasQuad>::iterator qIt=quads.begin();qIt!=quads.end();++qIt)
+			addAtlasQuad(vertices,qIt->modelBox,l->labelBox.origin[2],qIt->atlasBox,foreground);
+		}
+	
+	/* Save and set up OpenGL state: */
+	GLbitfield attribPushMask=GL_COLOR_BUFFER_BIT|GL_CURRENT_BIT|GL_DEPTH_BUFFER_BIT|GL_ENABLE_BIT|GL_TEXTURE_BIT;
+	bool lightingOn=glIsEnabled(GL_LIGHTING);
+	if(lightingOn)
+		attribPushMask|=GL_LIGHTING_BIT;
+	glPushAttrib(attribPushMask);
+	glEnable(GL_TEXTURE_2D);
+	glTexEnvMode(GLTexEnvEnums::TEXTURE_ENV,GLTexEnvEnums::MODULATE);
+	if(lightingOn)
+		{
+		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
+		glColorMaterial(GL_FRONT_AND_BACK,GL_AMBIENT_AND_DIFFUSE);
+		glEnable(GL_COLOR_MATERIAL);
+		}
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
+	glNormal3f(0.0f,0.0f,1.0f);
+	font->bindAtlasTexture(contextData);
+	GLVertexArrayParts::enable(AtlasVertex::getPartsMask());
+	glVertexPointer(&vertices[0]);
+	
+	/* Draw backgrounds and characters without writing depth, as character quads overlap the backgrounds and each other: */
+	glDepthMask(GL_FALSE);
+	glDrawArrays(GL_QUADS,0,GLsizei(vertices.size()));
+	
+	/* Draw the backgrounds again to only update the depth buffer: */
+	glDepthMask(GL_TRUE);
+	glColorMask(GL_FALSE,GL_FALSE,GL_FALSE,GL_FALSE);
+	glDrawArrays(GL_QUADS,0,numBackgroundVertices);
+	
+	/* Reset OpenGL state: */
+	GLVertexArrayParts::disable(AtlasVertex::getPartsMask());
+	glBindTexture(GL_TEXTURE_2D,0);
+	glPopAttrib();
+	}
+
 GLLabel::GLLabel(const char* sString,const GLFont& sFont)
 	:GLString(sString,sFont),font(&sFont),
 	 background(font->getBackgroundColor()),foreground(font->getForegroundColor()),
@@ -395,6 +530,14 @@ void GLLabel::draw(GLContextData& contextData) const
 	if(DeferredRenderer::addLabel(this))
 		return;
 	
+	/* Check if the label's font renders from a glyph atlas: */
+	if(font->isAtlasRendering())
+		{
+		const GLLabel* label=this;
+		drawAtlasLabels(&label,1,contextData);
+		return;
+		}
+	
 	/* Retrieve the context data item: */
 	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
 	
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef GLLABEL_INCLUDED
 #define GLLABEL_INCLUDED
 
+#include <stddef.h>
 #include <vector>
 #include <GL/gl.h>
 #include <GL/TLSHelper.h>
@@ -48,6 +49,7 @@ class GLLabel:public GLString,public GLObject
 		GLContextData& contextData; // Reference to the OpenGL context data object
 		DeferredRenderer* previousDeferredRenderer; // Pointer to the deferred renderer that was suspended when this one was installed
 		std::vector<const GLLabel*> gatheredLabels; // List of gathered GLLabel objects
+		std::vector<const GLLabel*> atlasLabels; // List of gathered GLLabel objects whose fonts render from glyph atlases
 		
 		/* Constructors and destructors: */
 		public:
@@ -88,6 +90,9 @@ class GLLabel:public GLString,public GLObject
 	unsigned int version; // Monotonically increasing version number of string
 	Box labelBox; // Position of label in model space
 	
+	/* Private methods: */
+	static void drawAtlasLabels(const GLLabel* const* labels,size_t numLabels,GLContextData& contextData); // Draws the given labels, which must all share the same atlas-rendered font, as batched glyph atlas quads
+	
 	/* Constructors and destructors: */
 	public:
 	GLLabel(void) // Dummy constructor
@@ -0,0 +1,180 @@
+/***********************************************************************
+GLFontAtlasTest - Program to check that the glyph atlas quads generated
+by GLFont reproduce the layout and rasterization of string textures,
+without requiring an OpenGL context.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the OpenGL Support Library (GLSupport).
+
+The OpenGL Support Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The OpenGL Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the OpenGL Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include <GL/gl.h>
+#include <GL/GLFont.h>
+#include <GL/GLString.h>
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline int roundTexel(GLfloat coord)
+	{
+	return int(floorf(coord+0.5f));
+	}
+
+bool checkString(const GLFont& font,const GLubyte* atlas,const std::string& str,std::string& error)
+	{
+	/* Lay out the string and rasterize it as a string texture: */
+	GLString string(str.c_str(),font);
+	GLsizei stringWidth=string.getTexelWidth();
+	GLsizei fontHeight=GLsizei(font.getTextPixelHeight());
+	GLubyte* stringImage=font.createStringImage(str.c_str(),stringWidth);
+	
+	/* Map the string's texture coordinate box to texel space, where the box covers the centers of the string's outermost texels: */
+	GLFont::TBox stringBox(GLFont::TBox::Vector(0.5f,0.5f),GLFont::TBox::Vector(GLfloat(stringWidth-1),GLfloat(fontHeight-1)));
+	std::vector<GLFont::AtlasQuad> quads;
+	font.calcAtlasQuads(string,stringBox,quads);
+	
+	/* Composite the atlas texels covered by all quads: */
+	GLsizei atlasWidth=font.getAtlasWidth();
+	GLsizei atlasHeight=font.getAtlasHeight();
+	std::vector<bool> composite(size_t(stringWidth)*size_t(fontHeight),false);
+	bool result=true;
+	for(std::vector<GLFont::AtlasQuad>::const_iterator qIt=quads.begin();qIt!=quads.end()&&result;++qIt)
+		{
+		/* Check that the quad lies inside the string's box as calculated from its texel width: */
+		GLfloat left=qIt->modelBox.origin[0];
+		GLfloat right=left+qIt->modelBox.size[0];
+		if(left<0.5f||right>GLfloat(stringWidth)-0.5f)
+			{
+			error="quad extends outside the string's box";
+			result=false;
+			break;
+			}
+		
+		int s0=roundTexel(left);
+		int s1=roundTexel(right);
+		int t0=roundTexel(qIt->modelBox.origin[1]);
+		int t1=roundTexel(qIt->modelBox.origin[1]+qIt->modelBox.size[1]);
+		int atlasX=roundTexel(qIt->atlasBox.origin[0]*GLfloat(atlasWidth));
+		int atlasY=roundTexel(qIt->atlasBox.origin[1]*GLfloat(atlasHeight));
+		for(int t=t0;t<t1;++t)
+			for(int s=s0;s<s1;++s)
+				if(atlas[(atlasY+t-t0)*atlasWidth+atlasX+s-s0]!=0)
+					composite[size_t(t)*size_t(stringWidth)+size_t(s)]=true;
+		}
+	
+	/* Compare the composited glyphs against the string texture, which has black glyphs on white: */
+	for(size_t i=0;i<composite.size()&&result;++i)
+		if(composite[i]!=(stringImage[i]==0))
+			{
+			error="atlas quads do not reproduce the string texture";
+			result=false;
+			}
+	
+	delete[] stringImage;
+	return result;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	std::vector<std::string> fontNames;
+	int numStrings=1000;
+	unsigned int seed=1;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"strings")==0)
+				{
+				++i;
+				if(i<argc)
+					numStrings=atoi(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"seed")==0)
+				{
+				++i;
+				if(i<argc)
+					seed=(unsigned int)(atoi(argv[i]));
+				}
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			fontNames.push_back(argv[i]);
+		}
+	if(fontNames.empty())
+		{
+		/* Check a selection of proportional, italic, and fixed-size fonts: */
+		fontNames.push_back("HelveticaMediumUpright");
+		fontNames.push_back("CenturySchoolbookBoldItalic");
+		fontNames.push_back("TimesBoldUpright12");
+		fontNames.push_back("CourierMediumUpright12");
+		}
+	
+	int result=0;
+	srand(seed);
+	for(std::vector<std::string>::const_iterator fnIt=fontNames.begin();fnIt!=fontNames.end();++fnIt)
+		{
+		try
+			{
+			/* Load the font and create its glyph atlas without antialiasing, to compare texels exactly: */
+			GLFont font(fnIt->c_str());
+			font.setAntialiasing(false);
+			GLubyte* atlas=font.createAtlasImage();
+			
+			/* Check random strings of printable characters: */
+			int numMismatches=0;
+			for(int i=0;i<numStrings;++i)
+				{
+				std::string str;
+				int length=1+rand()%40;
+				for(int j=0;j<length;++j)
+					str.push_back(char(32+rand()%95));
+				std::string error;
+				if(!checkString(font,atlas,str,error))
+					{
+					if(numMismatches<10)
+						std::cerr<<*fnIt<<": "<<error<<" for \""<<str<<"\""<<std::endl;
+					++numMismatches;
+					}
+				}
+			delete[] atlas;
+			
+			std::cout<<*fnIt<<": "<<font.getAtlasWidth()<<"x"<<font.getAtlasHeight()<<" atlas, "<<numMismatches<<" of "<<numStrings<<" strings mismatched"<<std::endl;
+			if(numMismatches!=0)
+				result=1;
+			}
+		catch(std::runtime_error err)
+			{
+			std::cerr<<"Caught exception "<<err.what()<<" while checking font "<<*fnIt<<std::endl;
+			result=1;
+			}
+		}
+	
+	return result;
+	}
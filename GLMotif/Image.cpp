@@ -1,5 +1,6 @@
 /***********************************************************************
-Image - Class for widgets displaying image as textures.
+Image - Class for widgets displaying image as textures, or tiled image
+pyramids through a per-context cache of tile textures.
 Copyright (c) 2011 Oliver Kreylos
 
 This file is part of the GLMotif Widget Library (GLMotif).
@@ -21,6 +22,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <GLMotif/Image.h>
 
+#include <Misc/Utility.h>
+#include <Math/Math.h>
 #include <GL/gl.h>
 #include <GL/GLColorTemplates.h>
 #include <GL/GLVertexTemplates.h>
@@ -34,30 +37,70 @@ namespace GLMotif {
 Methods of class Image::DataItem:
 ********************************/
 
-Image::DataItem::DataItem(void)
+Image::DataItem::DataItem(unsigned int sNumCachedTiles)
 	:npotdtSupported(GLARBTextureNonPowerOfTwo::isSupported()),
 	 textureObjectId(0),version(0),
-	 regionVersion(0)
+	 regionVersion(0),
+	 numCachedTiles(sNumCachedTiles),cachedTiles(numCachedTiles>0?new CachedTile[numCachedTiles]:0),
+	 tileMap(numCachedTiles>0?numCachedTiles*2+1:1),
+	 lruHead(~0U),lruTail(~0U),frameNumber(0)
 	{
 	if(npotdtSupported)
 		GLARBTextureNonPowerOfTwo::initExtension();
 	
 	glGenTextures(1,&textureObjectId);
+	
+	/* Create the tile cache's texture objects and link them into the LRU list: */
+	for(unsigned int i=0;i<numCachedTiles;++i)
+		{
+		CachedTile& ct=cachedTiles[i];
+		ct.valid=false;
+		glGenTextures(1,&ct.textureObjectId);
+		ct.lastUsed=0;
+		ct.pred=i>0?i-1:~0U;
+		ct.succ=i+1<numCachedTiles?i+1:~0U;
+		}
+	if(numCachedTiles>0)
+		{
+		lruHead=0;
+		lruTail=numCachedTiles-1;
+		}
 	}
 
 Image::DataItem::~DataItem(void)
 	{
 	glDeleteTextures(1,&textureObjectId);
+	for(unsigned int i=0;i<numCachedTiles;++i)
+		glDeleteTextures(1,&cachedTiles[i].textureObjectId);
+	delete[] cachedTiles;
+	}
+
+void Image::DataItem::touchTile(unsigned int tile)
+	{
+	CachedTile& ct=cachedTiles[tile];
+	ct.lastUsed=frameNumber;
+	if(tile==lruHead)
+		return;
+	
+	/* Unlink the tile from the LRU list: */
+	cachedTiles[ct.pred].succ=ct.succ;
+	if(ct.succ!=~0U)
+		cachedTiles[ct.succ].pred=ct.pred;
+	else
+		lruTail=ct.pred;
+	
+	/* Link the tile to the front of the LRU list: */
+	ct.pred=~0U;
+	ct.succ=lruHead;
+	cachedTiles[lruHead].pred=tile;
+	lruHead=tile;
 	}
 
 /**********************
 Methods of class Image:
 **********************/
 
-Image::Image(const char* sName,Container* sParent,const Images::RGBImage& sImage,const GLfloat sResolution[2],bool sManageChild)
-	:Widget(sName,sParent,false),
-	 image(sImage),version(1),
-	 regionVersion(1)
+void Image::initRegion(const GLfloat sResolution[2])
 	{
 	/* Copy the image resolution: */
 	for(int i=0;i<2;++i)
@@ -66,8 +109,199 @@ Image::Image(const char* sName,Container* sParent,const Images::RGBImage& sImage
 	/* Initialize the region to display the entire image: */
 	region[0]=0.0f;
 	region[1]=0.0f;
-	region[2]=GLfloat(image.getWidth());
-	region[3]=GLfloat(image.getHeight());
+	region[2]=GLfloat(imageSize[0]);
+	region[3]=GLfloat(imageSize[1]);
+	}
+
+unsigned int Image::getCachedTile(Image::DataItem* dataItem,const Images::ImagePyramid::TileIndex& tileIndex,unsigned int& numUploads,std::vector<Images::ImagePyramid::TileIndex>& requests) const
+	{
+	/* Check if the tile is already cached: */
+	DataItem::TileMap::Iterator tmIt=dataItem->tileMap.findEntry(tileIndex);
+	if(!tmIt.isFinished())
+		{
+		dataItem->touchTile(tmIt->getDest());
+		return tmIt->getDest();
+		}
+	
+	/* Upload the tile if it has been paged in, the per-frame upload budget allows, and the least recently used tile was not drawn in this frame: */
+	const unsigned int maxNumUploads=8;
+	unsigned int tile=dataItem->lruTail;
+	if(numUploads<maxNumUploads&&dataItem->cachedTiles[tile].lastUsed!=dataItem->frameNumber&&pyramid->isTileReady(tileIndex))
+		{
+		/* Evict the least recently used tile: */
+		CachedTile& ct=dataItem->cachedTiles[tile];
+		if(ct.valid)
+			dataItem->tileMap.removeEntry(ct.tileIndex);
+		
+		/* Upload the new tile: */
+		glBindTexture(GL_TEXTURE_2D,ct.textureObjectId);
+		glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS,0);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH,0);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS,0);
+		GLsizei tileSize=GLsizei(pyramid->getTileSize());
+		glTexImage2D(GL_TEXTURE_2D,0,GL_RGB8,tileSize,tileSize,0,GL_RGB,GL_UNSIGNED_BYTE,pyramid->getTile(tileIndex));
+		++numUploads;
+		
+		ct.tileIndex=tileIndex;
+		ct.valid=true;
+		dataItem->tileMap.setEntry(DataItem::TileMap::Entry(tileIndex,tile));
+		dataItem->touchTile(tile);
+		return tile;
+		}
+	
+	/* Request the tile from the pyramid's loader thread: */
+	requests.push_back(tileIndex);
+	return ~0U;
+	}
+
+void Image::drawTile(Image::DataItem* dataItem,const Images::ImagePyramid::TileIndex& tileIndex,unsigned int cachedTile,const GLfloat clip[4]) const
+	{
+	/* Calculate the position of the tile's interior in image pixel space: */
+	const Images::ImagePyramid::Level& level=pyramid->getLevel(tileIndex.level);
+	GLfloat tileSize=GLfloat(pyramid->getTileSize());
+	GLfloat tileStride=GLfloat(pyramid->getTileStride());
+	GLfloat scale[2],tileMin[2];
+	for(int i=0;i<2;++i)
+		{
+		scale[i]=GLfloat(imageSize[i])/GLfloat(level.size[i]);
+		tileMin[i]=GLfloat(tileIndex.tile[i])*tileStride*scale[i];
+		}
+	
+	/* Calculate the texture coordinates and widget-space positions of the clip rectangle's corners, skipping the tile's one-pixel border: */
+	const Box& interior=getInterior();
+	GLfloat tex[4],pos[4];
+	for(int i=0;i<2;++i)
+		for(int j=0;j<4;j+=2)
+			{
+			tex[j+i]=((clip[j+i]-tileMin[i])/scale[i]+1.0f)/tileSize;
+			pos[j+i]=interior.origin[i]+(clip[j+i]-region[i])*interior.size[i]/(region[2+i]-region[i]);
+			}
+	GLfloat z=interior.origin[2];
+	
+	/* Draw the clip rectangle: */
+	glBindTexture(GL_TEXTURE_2D,dataItem->cachedTiles[cachedTile].textureObjectId);
+	glBegin(GL_QUADS);
+	glTexCoord2f(tex[0],tex[1]);
+	glVertex3f(pos[0],pos[1],z);
+	glTexCoord2f(tex[2],tex[1]);
+	glVertex3f(pos[2],pos[1],z);
+	glTexCoord2f(tex[2],tex[3]);
+	glVertex3f(pos[2],pos[3],z);
+	glTexCoord2f(tex[0],tex[3]);
+	glVertex3f(pos[0],pos[3],z);
+	glEnd();
+	}
+
+void Image::drawPyramid(Image::DataItem* dataItem) const
+	{
+	/* Start a new frame for the tile cache: */
+	++dataItem->frameNumber;
+	
+	/* Calculate the visible part of the image in image pixel space: */
+	GLfloat visible[4];
+	for(int i=0;i<2;++i)
+		{
+		visible[i]=region[i]>0.0f?region[i]:0.0f;
+		visible[2+i]=region[2+i]<GLfloat(imageSize[i])?region[2+i]:GLfloat(imageSize[i]);
+		}
+	
+	/* Request and touch the coarsest level's single tile to always have a fallback: */
+	std::vector<Images::ImagePyramid::TileIndex> requests;
+	unsigned int numUploads=0;
+	unsigned int numLevels=pyramid->getNumLevels();
+	getCachedTile(dataItem,Images::ImagePyramid::TileIndex(numLevels-1,0,0),numUploads,requests);
+	
+	if(visible[0]<visible[2]&&visible[1]<visible[3])
+		{
+		/* Select the coarsest level whose pixels are not larger than the displayed image pixels: */
+		GLfloat pixelScale=Misc::min((region[2]-region[0])/(getInterior().size[0]*resolution[0]),(region[3]-region[1])/(getInterior().size[1]*resolution[1]));
+		unsigned int levelIndex=0;
+		while(levelIndex+1<numLevels&&GLfloat(imageSize[0])/GLfloat(pyramid->getLevel(levelIndex+1).size[0])<=pixelScale)
+			++levelIndex;
+		
+		/* Draw all visible tiles of the selected level; tiles are placed tile stride pixels apart: */
+		GLfloat tileStride=GLfloat(pyramid->getTileStride());
+		const Images::ImagePyramid::Level& level=pyramid->getLevel(levelIndex);
+		GLfloat scale[2];
+		unsigned int tileMin[2],tileMax[2];
+		for(int i=0;i<2;++i)
+			{
+			scale[i]=GLfloat(imageSize[i])/GLfloat(level.size[i]);
+			tileMin[i]=(unsigned int)(visible[i]/(scale[i]*tileStride));
+			tileMax[i]=(unsigned int)Math::ceil(visible[2+i]/(scale[i]*tileStride));
+			if(tileMax[i]>level.numTiles[i])
+				tileMax[i]=level.numTiles[i];
+			}
+		for(unsigned int ty=tileMin[1];ty<tileMax[1];++ty)
+			for(unsigned int tx=tileMin[0];tx<tileMax[0];++tx)
+				{
+				/* Clip the tile against the visible region: */
+				Images::ImagePyramid::TileIndex tileIndex(levelIndex,tx,ty);
+				GLfloat clip[4];
+				clip[0]=Misc::max(GLfloat(tx)*tileStride*scale[0],visible[0]);
+				clip[1]=Misc::max(GLfloat(ty)*tileStride*scale[1],visible[1]);
+				clip[2]=Misc::min(GLfloat(tx+1)*tileStride*scale[0],visible[2]);
+				clip[3]=Misc::min(GLfloat(ty+1)*tileStride*scale[1],visible[3]);
+				
+				unsigned int cachedTile=getCachedTile(dataItem,tileIndex,numUploads,requests);
+				if(cachedTile!=~0U)
+					drawTile(dataItem,tileIndex,cachedTile,clip);
+				else
+					{
+					/* Cover the missing tile with the finest coarser level whose covering tiles are all cached: */
+					for(unsigned int fallbackIndex=levelIndex+1;fallbackIndex<numLevels;++fallbackIndex)
+						{
+						const Images::ImagePyramid::Level& fallbackLevel=pyramid->getLevel(fallbackIndex);
+						GLfloat fallbackScale[2];
+						unsigned int fMin[2],fMax[2];
+						for(int i=0;i<2;++i)
+							{
+							fallbackScale[i]=GLfloat(imageSize[i])/GLfloat(fallbackLevel.size[i]);
+							fMin[i]=(unsigned int)(clip[i]/(fallbackScale[i]*tileStride));
+							fMax[i]=(unsigned int)Math::ceil(clip[2+i]/(fallbackScale[i]*tileStride));
+							if(fMax[i]>fallbackLevel.numTiles[i])
+								fMax[i]=fallbackLevel.numTiles[i];
+							}
+						bool complete=true;
+						for(unsigned int fy=fMin[1];fy<fMax[1]&&complete;++fy)
+							for(unsigned int fx=fMin[0];fx<fMax[0]&&complete;++fx)
+								complete=dataItem->tileMap.isEntry(Images::ImagePyramid::TileIndex(fallbackIndex,fx,fy));
+						if(complete)
+							{
+							for(unsigned int fy=fMin[1];fy<fMax[1];++fy)
+								for(unsigned int fx=fMin[0];fx<fMax[0];++fx)
+									{
+									Images::ImagePyramid::TileIndex fallbackTileIndex(fallbackIndex,fx,fy);
+									unsigned int fallbackTile=dataItem->tileMap.getEntry(fallbackTileIndex).getDest();
+									dataItem->touchTile(fallbackTile);
+									GLfloat fallbackClip[4];
+									fallbackClip[0]=Misc::max(GLfloat(fx)*tileStride*fallbackScale[0],clip[0]);
+									fallbackClip[1]=Misc::max(GLfloat(fy)*tileStride*fallbackScale[1],clip[1]);
+									fallbackClip[2]=Misc::min(GLfloat(fx+1)*tileStride*fallbackScale[0],clip[2]);
+									fallbackClip[3]=Misc::min(GLfloat(fy+1)*tileStride*fallbackScale[1],clip[3]);
+									drawTile(dataItem,fallbackTileIndex,fallbackTile,fallbackClip);
+									}
+							break;
+							}
+						}
+					}
+				}
+		}
+	
+	/* Replace this OpenGL context's load queue with the tiles missing in this frame: */
+	pyramid->requestTiles(dataItem,requests);
+	}
+
+Image::Image(const char* sName,Container* sParent,const Images::RGBImage& sImage,const GLfloat sResolution[2],bool sManageChild)
+	:Widget(sName,sParent,false),
+	 image(sImage),pyramid(0),tileCacheSize(0),version(1),
+	 regionVersion(1)
+	{
+	/* Initialize the displayed region: */
+	for(int i=0;i<2;++i)
+		imageSize[i]=image.getSize(i);
+	initRegion(sResolution);
 	
 	/* Manage me: */
 	if(sManageChild)
@@ -76,27 +310,42 @@ Image::Image(const char* sName,Container* sParent,const Images::RGBImage& sImage
 
 Image::Image(const char* sName,Container* sParent,const char* imageFileName,const GLfloat sResolution[2],bool sManageChild)
 	:Widget(sName,sParent,false),
-	 version(1),
+	 pyramid(0),tileCacheSize(0),version(1),
 	 regionVersion(1)
 	{
 	/* Load the image file: */
 	image=Images::readImageFile(imageFileName);
 	
-	/* Copy the image resolution: */
+	/* Initialize the displayed region: */
 	for(int i=0;i<2;++i)
-		resolution[i]=sResolution[i];
+		imageSize[i]=image.getSize(i);
+	initRegion(sResolution);
 	
-	/* Initialize the region to display the entire image: */
-	region[0]=0.0f;
-	region[1]=0.0f;
-	region[2]=GLfloat(image.getWidth());
-	region[3]=GLfloat(image.getHeight());
+	/* Manage me: */
+	if(sManageChild)
+		manageChild();
+	}
+
+Image::Image(const char* sName,Container* sParent,Images::ImagePyramid* sPyramid,const GLfloat sResolution[2],bool sManageChild)
+	:Widget(sName,sParent,false),
+	 pyramid(sPyramid),tileCacheSize(256),version(1),
+	 regionVersion(1)
+	{
+	/* Initialize the displayed region: */
+	for(int i=0;i<2;++i)
+		imageSize[i]=pyramid->getImageSize(i);
+	initRegion(sResolution);
 	
 	/* Manage me: */
 	if(sManageChild)
 		manageChild();
 	}
 
+Image::~Image(void)
+	{
+	delete pyramid;
+	}
+
 Vector Image::calcNaturalSize(void) const
 	{
 	/* Calculate the widget's natural interior size based on the image resolution and display region: */
@@ -147,6 +396,17 @@ void Image::draw(GLContextData& contextData) const
 	glEnable(GL_TEXTURE_2D);
 	glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_REPLACE);
 	
+	if(pyramid!=0)
+		{
+		/* Draw the image pyramid's visible tiles: */
+		drawPyramid(dataItem);
+		
+		/* Protect the texture objects and restore OpenGL state: */
+		glBindTexture(GL_TEXTURE_2D,0);
+		glPopAttrib();
+		return;
+		}
+	
 	/* Bind the texture object: */
 	glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectId);
 	
@@ -218,9 +478,21 @@ void Image::draw(GLContextData& contextData) const
 void Image::initContext(GLContextData& contextData) const
 	{
 	/* Create and register the context data item: */
-	DataItem* dataItem=new DataItem;
+	DataItem* dataItem=new DataItem(pyramid!=0?tileCacheSize:0);
 	contextData.addDataItem(this,dataItem);
 	
+	/* Initialize the tile cache's texture objects: */
+	for(unsigned int i=0;i<dataItem->numCachedTiles;++i)
+		{
+		glBindTexture(GL_TEXTURE_2D,dataItem->cachedTiles[i].textureObjectId);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_BASE_LEVEL,0);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAX_LEVEL,0);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+		}
+	
 	/* Bind the texture object: */
 	glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectId);
 	
@@ -270,9 +542,9 @@ void Image::setRegion(const GLfloat newRegion[4])
 		imageBox.origin[0]+=delta;
 		imageBox.size[0]-=delta;
 		}
-	if(region[2]>GLfloat(image.getWidth()))
+	if(region[2]>GLfloat(imageSize[0]))
 		{
-		GLfloat delta=(region[2]-GLfloat(image.getWidth()))/(region[2]-region[0])*ww;
+		GLfloat delta=(region[2]-GLfloat(imageSize[0]))/(region[2]-region[0])*ww;
 		imageBox.size[0]-=delta;
 		}
 	if(region[1]<0.0f)
@@ -281,9 +553,9 @@ void Image::setRegion(const GLfloat newRegion[4])
 		imageBox.origin[1]+=delta;
 		imageBox.size[1]-=delta;
 		}
-	if(region[3]>GLfloat(image.getHeight()))
+	if(region[3]>GLfloat(imageSize[1]))
 		{
-		GLfloat delta=(region[3]-GLfloat(image.getHeight()))/(region[3]-region[1])*wh;
+		GLfloat delta=(region[3]-GLfloat(imageSize[1]))/(region[3]-region[1])*wh;
 		imageBox.size[1]-=delta;
 		}
 	
@@ -291,4 +563,9 @@ void Image::setRegion(const GLfloat newRegion[4])
 	++regionVersion;
 	}
 
+void Image::setTileCacheSize(unsigned int newTileCacheSize)
+	{
+	tileCacheSize=newTileCacheSize>0?newTileCacheSize:1;
+	}
+
 }
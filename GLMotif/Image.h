@@ -1,5 +1,6 @@
 /***********************************************************************
-Image - Class for widgets displaying image as textures.
+Image - Class for widgets displaying image as textures, or tiled image
+pyramids through a per-context cache of tile textures.
 Copyright (c) 2011 Oliver Kreylos
 
 This file is part of the GLMotif Widget Library (GLMotif).
@@ -22,9 +23,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef GLMOTIF_IMAGE_INCLUDED
 #define GLMOTIF_IMAGE_INCLUDED
 
+#include <vector>
 #include <GL/gl.h>
 #include <GL/GLObject.h>
+#include <Misc/HashTable.h>
 #include <Images/RGBImage.h>
+#include <Images/ImagePyramid.h>
 #include <GLMotif/Widget.h>
 
 namespace GLMotif {
@@ -33,35 +37,68 @@ class Image:public Widget,public GLObject
 	{
 	/* Embedded classes: */
 	private:
-	struct DataItem:public GLObject::DataItem
+	struct CachedTile // Structure for texture objects caching image pyramid tiles
 		{
 		/* Elements: */
 		public:
+		Images::ImagePyramid::TileIndex tileIndex; // Index of the cached tile
+		bool valid; // Flag whether the texture object contains a tile
+		GLuint textureObjectId; // ID of the texture object
+		unsigned int lastUsed; // Number of the frame in which the tile was last drawn
+		unsigned int pred,succ; // Indices of the previous and next tiles in the cache's LRU list
+		};
+	
+	struct DataItem:public GLObject::DataItem
+		{
+		/* Embedded classes: */
+		public:
+		typedef Misc::HashTable<Images::ImagePyramid::TileIndex,unsigned int,Images::ImagePyramid::TileIndex> TileMap; // Hash table mapping tile indices to cached tiles
+		
+		/* Elements: */
 		bool npotdtSupported; // Flag if the OpenGL context supports non-power-of-two-dimension textures
 		GLuint textureObjectId; // ID of texture object holding image texture
 		unsigned int textureSize[2]; // Width and height of texture containing image
 		unsigned int version; // Version number of image in image texture object
 		GLfloat regionTex[4]; // Texture coordinates to display current image region
 		unsigned int regionVersion; // Version number of displayed image region
+		unsigned int numCachedTiles; // Number of texture objects caching image pyramid tiles
+		CachedTile* cachedTiles; // Array of cached image pyramid tiles
+		TileMap tileMap; // Map from tile indices to cached tiles
+		unsigned int lruHead,lruTail; // Indices of the most and least recently used cached tiles
+		unsigned int frameNumber; // Number of the current frame to protect tiles drawn in the current frame from eviction
 		
 		/* Constructors and destructors: */
-		DataItem(void);
+		DataItem(unsigned int sNumCachedTiles);
 		virtual ~DataItem(void);
+		
+		/* Methods: */
+		void touchTile(unsigned int tile); // Marks the given cached tile as used in the current frame
 		};
 	
 	/* Elements: */
 	private:
 	Images::RGBImage image; // The displayed image
+	Images::ImagePyramid* pyramid; // The displayed image pyramid if the widget displays a tiled image pyramid instead of an image
+	unsigned int imageSize[2]; // Size of the displayed image or the image pyramid's full-resolution level
+	unsigned int tileCacheSize; // Number of image pyramid tiles cached in each OpenGL context
 	unsigned int version; // Version number of image
 	GLfloat resolution[2]; // The horizontal and vertical resolution of the image in pixels per GLMotif length unit
 	GLfloat region[4]; // Region of the image currently mapped to the widget's interior in pixel units
 	Box imageBox; // Extents of image inside the widget's interior
 	unsigned int regionVersion; // Version number of displayed image region
 	
+	/* Private methods: */
+	void initRegion(const GLfloat sResolution[2]); // Initializes the image resolution and the displayed region
+	unsigned int getCachedTile(DataItem* dataItem,const Images::ImagePyramid::TileIndex& tileIndex,unsigned int& numUploads,std::vector<Images::ImagePyramid::TileIndex>& requests) const; // Returns the index of the given pyramid tile in the tile cache, uploading it if it is ready; returns ~0U and adds the tile to the request list otherwise
+	void drawTile(DataItem* dataItem,const Images::ImagePyramid::TileIndex& tileIndex,unsigned int cachedTile,const GLfloat clip[4]) const; // Draws the part of a cached pyramid tile inside the given clip rectangle in image pixel space
+	void drawPyramid(DataItem* dataItem) const; // Draws the displayed region of the image pyramid
+	
 	/* Constructors and destructors: */
 	public:
 	Image(const char* sName,Container* sParent,const Images::RGBImage& sImage,const GLfloat sResolution[2],bool sManageChild =true); // Creates an image widget displaying the given image at the given resolution
 	Image(const char* sName,Container* sParent,const char* imageFileName,const GLfloat sResolution[2],bool sManageChild =true); // Creates an image widget displaying the given image file at the given resolution
+	Image(const char* sName,Container* sParent,Images::ImagePyramid* sPyramid,const GLfloat sResolution[2],bool sManageChild =true); // Creates an image widget displaying the given tiled image pyramid at the given resolution; widget inherits the pyramid object
+	virtual ~Image(void);
 	
 	/* Methods from Widget: */
 	virtual Vector calcNaturalSize(void) const;
@@ -72,10 +109,23 @@ class Image:public Widget,public GLObject
 	virtual void initContext(GLContextData& contextData) const;
 	
 	/* New methods: */
-	const Images::RGBImage& getImage(void) const // Returns the current image
+	const Images::RGBImage& getImage(void) const // Returns the current image; returns an invalid image if the widget displays an image pyramid
 		{
 		return image;
 		}
+	Images::ImagePyramid* getPyramid(void) const // Returns the displayed image pyramid, or null if the widget displays an image
+		{
+		return pyramid;
+		}
+	const unsigned int* getImageSize(void) const // Returns the size of the displayed image or image pyramid in pixels
+		{
+		return imageSize;
+		}
+	unsigned int getImageSize(int dimension) const // Ditto
+		{
+		return imageSize[dimension];
+		}
+	void setTileCacheSize(unsigned int newTileCacheSize); // Sets the number of image pyramid tiles cached in each OpenGL context; only affects OpenGL contexts initialized afterwards
 	const GLfloat* getResolution(void) const // Returns the current image's resolution
 		{
 		return resolution;
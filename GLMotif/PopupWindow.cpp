@@ -297,7 +297,7 @@ void PopupWindow::draw(GLContextData& contextData) const
 	else
 		{
 		/* Cache the popup window's visual representation into the display list: */
-		glNewList(dataItem->displayListId,GL_COMPILE_AND_EXECUTE);
+		contextData.newList(dataItem->displayListId,GL_COMPILE_AND_EXECUTE);
 		}
 	#endif
 	
@@ -392,7 +392,7 @@ void PopupWindow::draw(GLContextData& contextData) const
 	if(dataItem->version!=version)
 		{
 		/* Finish caching the popup window's visual representation: */
-		glEndList();
+		contextData.endList();
 		
 		/* Mark the display list as up-to-date: */
 		dataItem->version=version;
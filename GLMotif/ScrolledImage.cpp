@@ -49,11 +49,11 @@ void ScrolledImage::init(bool sManageChild)
 	//image->setBorderType(Widget::PLAIN);
 	
 	/* Initialize the horizontal scroll bar: */
-	horizontalScrollBar->setPositionRange(0,image->getImage().getSize(0),image->getImage().getSize(0));
+	horizontalScrollBar->setPositionRange(0,image->getImageSize(0),image->getImageSize(0));
 	horizontalScrollBar->getValueChangedCallbacks().add(this,&ScrolledImage::scrollBarCallback);
 	
 	/* Initialize the vertical scroll bar: */
-	verticalScrollBar->setPositionRange(0,image->getImage().getSize(1),image->getImage().getSize(1));
+	verticalScrollBar->setPositionRange(0,image->getImageSize(1),image->getImageSize(1));
 	verticalScrollBar->getValueChangedCallbacks().add(this,&ScrolledImage::scrollBarCallback);
 	
 	/* Manage the children: */
@@ -110,6 +110,17 @@ ScrolledImage::ScrolledImage(const char* sName,Container* sParent,const char* sI
 	init(sManageChild);
 	}
 
+ScrolledImage::ScrolledImage(const char* sName,Container* sParent,Images::ImagePyramid* sPyramid,const GLfloat sResolution[2],bool sManageChild)
+	:Container(sName,sParent,false),
+	 preferredSize(0.0f,0.0f,0.0f),
+	 image(new Image("Image",this,sPyramid,sResolution,false)),
+	 horizontalScrollBar(new ScrollBar("HorizontalScrollBar",this,ScrollBar::HORIZONTAL,false,false)),
+	 verticalScrollBar(new ScrollBar("VerticalScrollBar",this,ScrollBar::VERTICAL,false,false)),
+	 zoomFactor(1.0f)
+	{
+	init(sManageChild);
+	}
+
 ScrolledImage::~ScrolledImage(void)
 	{
 	/* Delete the child widgets: */
@@ -352,20 +363,20 @@ void ScrolledImage::setZoomFactor(GLfloat newZoomFactor,const Vector& fixedPoint
 		newRegion[0+i]=fpi[i]-newSize[i]*fpw[i];
 		newRegion[2+i]=fpi[i]+newSize[i]*(1.0f-fpw[i]);
 		newPageSize[i]=int(Math::floor(newSize[i]+0.5f));
-		if(newPageSize[i]>int(image->getImage().getSize(i)))
-			newPageSize[i]=int(image->getImage().getSize(i));
+		if(newPageSize[i]>int(image->getImageSize(i)))
+			newPageSize[i]=int(image->getImageSize(i));
 		newPageOrigin[i]=int(Math::floor(newRegion[i]+0.5));
 		if(newPageOrigin[i]<0)
 			newPageOrigin[i]=0;
-		if(newPageOrigin[i]>int(image->getImage().getSize(i))-newPageSize[i])
-			newPageOrigin[i]=int(image->getImage().getSize(i))-newPageSize[i];
+		if(newPageOrigin[i]>int(image->getImageSize(i))-newPageSize[i])
+			newPageOrigin[i]=int(image->getImageSize(i))-newPageSize[i];
 		}
 	image->setRegion(newRegion);
 	
 	/* Adjust the scroll bars: */
-	horizontalScrollBar->setPositionRange(0,int(image->getImage().getSize(0)),newPageSize[0]);
+	horizontalScrollBar->setPositionRange(0,int(image->getImageSize(0)),newPageSize[0]);
 	horizontalScrollBar->setPosition(newPageOrigin[0]);
-	verticalScrollBar->setPositionRange(0,int(image->getImage().getSize(1)),newPageSize[1]);
+	verticalScrollBar->setPositionRange(0,int(image->getImageSize(1)),newPageSize[1]);
 	verticalScrollBar->setPosition(newPageOrigin[1]);
 	}
 
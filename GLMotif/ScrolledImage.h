@@ -48,6 +48,7 @@ class ScrolledImage:public Container
 	public:
 	ScrolledImage(const char* sName,Container* sParent,const Images::RGBImage& sImage,const GLfloat sResolution[2],bool manageChild =true);
 	ScrolledImage(const char* sName,Container* sParent,const char* imageFileName,const GLfloat sResolution[2],bool manageChild =true);
+	ScrolledImage(const char* sName,Container* sParent,Images::ImagePyramid* sPyramid,const GLfloat sResolution[2],bool manageChild =true); // Displays a tiled image pyramid, loading tiles for the displayed region and zoom factor in the background; widget inherits the pyramid object
 	virtual ~ScrolledImage(void);
 	
 	/* Methods inherited from Widget: */
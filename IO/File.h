@@ -117,9 +117,10 @@ class File:public Misc::RefCounted
 	static const char* getAccessModeName(AccessMode accessMode); // Returns a string describing the given access mode
 	void flushReadBuffer(void) // Clears the read buffer so that the next read access has to go to the data source
 		{
-		/* Reset the read buffer pointers: */
+		/* Reset the read buffer pointers and the end-of-file flag: */
 		readDataEnd=readBuffer;
 		readPtr=readBuffer;
+		haveEof=false;
 		}
 	void setReadBuffer(size_t newReadBufferSize,Byte* newReadBuffer,bool deleteOldBuffer =true); // Allows derived class to set a new read buffer while deleting or releasing the previous buffer; discards unread data in read buffer
 	size_t getReadBufferDataSize(void) const // Returns current amount of data in the read buffer
@@ -271,6 +272,20 @@ class File:public Misc::RefCounted
 		
 		return result;
 		}
+	size_t peekInBuffer(const void*& buffer) // Returns a pointer to the unread data in the file's internal buffer and its size without reading it; fills the buffer first if it is empty; returns zero at end-of-file
+		{
+		/* Read more data if the buffer is empty: */
+		if(readPtr==readDataEnd&&!haveEof)
+			fillReadBuffer();
+		
+		/* Return all unread buffer content: */
+		buffer=readPtr;
+		return readDataEnd-readPtr;
+		}
+	void skipInBuffer(size_t skipSize) // Marks the given amount of data returned by the last peekInBuffer call as read; does not check for buffer bounds
+		{
+		readPtr+=skipSize;
+		}
 	void readRaw(void* buffer,size_t bufferSize) // Reads exactly the given amount of data into the provided buffer; blocks until read complete
 		{
 		/* Check if there is enough data in the read buffer: */
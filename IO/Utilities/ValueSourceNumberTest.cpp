@@ -0,0 +1,286 @@
+/***********************************************************************
+ValueSourceNumberTest - Program to check the numbers parsed by
+IO::ValueSource against the C library's strtod and strtol functions,
+and to compare their parsing times.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the I/O Support Library (IO).
+
+The I/O Support Library is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as published
+by the Free Software Foundation; either version 2 of the License, or (at
+your option) any later version.
+
+The I/O Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the I/O Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
+#include <Misc/Timer.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <IO/ValueSource.h>
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+double randUniform(void)
+	{
+	return double(rand())/double(RAND_MAX);
+	}
+
+std::string createNumberToken(int tokenIndex)
+	{
+	/* Create tokens in the formats typically found in text-based model files: */
+	char token[64];
+	switch(tokenIndex%6)
+		{
+		case 0: // Fixed-point with few decimals
+			snprintf(token,sizeof(token),"%.*f",rand()%7,(randUniform()-0.5)*pow(10.0,double(rand()%7)));
+			break;
+		
+		case 1: // Scientific with up to 15 significant digits
+			snprintf(token,sizeof(token),"%.*e",rand()%15,(randUniform()-0.5)*pow(10.0,double(rand()%41-20)));
+			break;
+		
+		case 2: // Fixed-point in the unit interval
+			snprintf(token,sizeof(token),"%.*f",1+rand()%9,randUniform());
+			break;
+		
+		case 3: // Full double precision
+			snprintf(token,sizeof(token),"%.17g",(randUniform()-0.5)*pow(10.0,double(rand()%81-40)));
+			break;
+		
+		case 4: // Large and tiny exponents
+			snprintf(token,sizeof(token),"%.6e",(randUniform()+0.1)*pow(10.0,double(rand()%601-300)));
+			break;
+		
+		default: // Integral values
+			snprintf(token,sizeof(token),"%d",rand()%2000001-1000000);
+		}
+	return token;
+	}
+
+bool isExactlyRepresentable(const std::string& token)
+	{
+	/* Count the token's significant mantissa digits and its decimal scale: */
+	int numDigits=0;
+	int scale=0;
+	bool fraction=false;
+	std::string::const_iterator tIt;
+	for(tIt=token.begin();tIt!=token.end()&&*tIt!='e'&&*tIt!='E';++tIt)
+		{
+		if(*tIt=='.')
+			fraction=true;
+		else if(*tIt>='0'&&*tIt<='9')
+			{
+			if(numDigits>0||*tIt!='0')
+				++numDigits;
+			if(fraction)
+				--scale;
+			}
+		}
+	if(tIt!=token.end())
+		scale+=atoi(&*tIt+1);
+	
+	/* The mantissa and the power of ten are exact doubles in this range, so a single multiplication or division rounds correctly: */
+	return numDigits<=15&&scale>=-22&&scale<=22;
+	}
+
+Misc::UInt64 ulpDistance(double a,double b)
+	{
+	/* Map the doubles' bit patterns onto a monotonic integer scale: */
+	Misc::SInt64 ia,ib;
+	memcpy(&ia,&a,sizeof(double));
+	memcpy(&ib,&b,sizeof(double));
+	if(ia<0)
+		ia=Misc::SInt64(0x8000000000000000ULL)-ia;
+	if(ib<0)
+		ib=Misc::SInt64(0x8000000000000000ULL)-ib;
+	return ia>ib?Misc::UInt64(ia-ib):Misc::UInt64(ib-ia);
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int numTokens=2000000;
+	unsigned int seed=1;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"numbers")==0)
+				{
+				++i;
+				if(i<argc)
+					numTokens=atoi(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"seed")==0)
+				{
+				++i;
+				if(i<argc)
+					seed=(unsigned int)(atoi(argv[i]));
+				}
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring unrecognized argument "<<argv[i]<<std::endl;
+		}
+	
+	/* Create the test tokens: */
+	srand(seed);
+	std::vector<std::string> tokens;
+	tokens.reserve(numTokens);
+	std::string text;
+	for(int i=0;i<numTokens;++i)
+		{
+		tokens.push_back(createNumberToken(i));
+		text.append(tokens.back());
+		
+		/* Separate tokens by the kinds of whitespace found in model files, so that tokens straddle the file's buffer boundaries: */
+		text.push_back(i%8==7?'\n':(i%3==0?'\t':' '));
+		}
+	
+	/* Write the tokens to a temporary file: */
+	char tempFileName[]="/tmp/ValueSourceNumberTestXXXXXX";
+	int tempFd=mkstemp(tempFileName);
+	if(tempFd<0)
+		{
+		std::cerr<<"Unable to create temporary file"<<std::endl;
+		return 1;
+		}
+	bool written=write(tempFd,text.data(),text.size())==ssize_t(text.size());
+	close(tempFd);
+	if(!written)
+		{
+		std::cerr<<"Unable to write temporary file "<<tempFileName<<std::endl;
+		unlink(tempFileName);
+		return 1;
+		}
+	
+	int result=0;
+	try
+		{
+		/* Parse the tokens with a value source: */
+		std::vector<double> values(numTokens);
+		{
+		IO::ValueSource source(IO::openFile(tempFileName));
+		source.skipWs();
+		Misc::Timer timer;
+		for(int i=0;i<numTokens;++i)
+			values[i]=source.readNumber();
+		timer.elapse();
+		std::cout<<"IO::ValueSource::readNumber: "<<numTokens<<" numbers in "<<timer.getTime()*1000.0<<" ms"<<std::endl;
+		if(!source.eof())
+			{
+			std::cerr<<"Value source did not reach end of file"<<std::endl;
+			result=1;
+			}
+		}
+		
+		/* Parse the same tokens with the bulk reader: */
+		std::vector<double> bulkValues(numTokens);
+		{
+		IO::ValueSource source(IO::openFile(tempFileName));
+		source.skipWs();
+		Misc::Timer timer;
+		source.readNumbers(numTokens,&bulkValues[0]);
+		timer.elapse();
+		std::cout<<"IO::ValueSource::readNumbers: "<<numTokens<<" numbers in "<<timer.getTime()*1000.0<<" ms"<<std::endl;
+		}
+		
+		/* Parse the tokens from memory with strtod: */
+		std::vector<double> referenceValues(numTokens);
+		{
+		Misc::Timer timer;
+		const char* tPtr=text.c_str();
+		for(int i=0;i<numTokens;++i)
+			{
+			char* endPtr;
+			referenceValues[i]=strtod(tPtr,&endPtr);
+			tPtr=endPtr;
+			}
+		timer.elapse();
+		std::cout<<"strtod: "<<numTokens<<" numbers in "<<timer.getTime()*1000.0<<" ms"<<std::endl;
+		}
+		
+		/* Compare the results: */
+		int numExactMismatches=0;
+		int numRoundingDifferences=0;
+		Misc::UInt64 maxUlps=0;
+		int numBulkMismatches=0;
+		for(int i=0;i<numTokens;++i)
+			{
+			if(values[i]!=referenceValues[i])
+				{
+				if(isExactlyRepresentable(tokens[i]))
+					{
+					/* Tokens in the fast path's exact range must match strtod bit by bit: */
+					if(numExactMismatches<10)
+						std::cerr<<"Mismatch for "<<tokens[i]<<": "<<values[i]<<" vs strtod "<<referenceValues[i]<<std::endl;
+					++numExactMismatches;
+					}
+				else
+					++numRoundingDifferences;
+				Misc::UInt64 ulps=ulpDistance(values[i],referenceValues[i]);
+				if(maxUlps<ulps)
+					maxUlps=ulps;
+				}
+			if(bulkValues[i]!=values[i])
+				++numBulkMismatches;
+			}
+		std::cout<<numExactMismatches<<" mismatches in the exact range, "<<numRoundingDifferences<<" rounding differences outside (max "<<maxUlps<<" ulp), "<<numBulkMismatches<<" bulk reader mismatches"<<std::endl;
+		if(numExactMismatches!=0||numBulkMismatches!=0)
+			result=1;
+		
+		/* Parse the integral tokens again as integers: */
+		{
+		IO::ValueSource source(IO::openFile(tempFileName));
+		source.skipWs();
+		int numIntegerMismatches=0;
+		for(int i=0;i<numTokens;++i)
+			{
+			if(i%6==5)
+				{
+				int value=source.readInteger();
+				if(value!=int(strtol(tokens[i].c_str(),0,10)))
+					++numIntegerMismatches;
+				}
+			else
+				source.readNumber();
+			}
+		std::cout<<numIntegerMismatches<<" integer mismatches against strtol"<<std::endl;
+		if(numIntegerMismatches!=0)
+			result=1;
+		}
+		}
+	catch(std::runtime_error err)
+		{
+		std::cerr<<"Caught exception "<<err.what()<<std::endl;
+		result=1;
+		}
+	
+	unlink(tempFileName);
+	return result;
+	}
@@ -22,10 +22,36 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <IO/ValueSource.h>
 
 #include <ctype.h>
+#include <string.h>
 #include <math.h>
+#include <Misc/SizedTypes.h>
 
 namespace IO {
 
+namespace {
+
+/*********************************************
+Helper functions for fast-path number parsing:
+*********************************************/
+
+const Misc::UInt64 maxExactMantissa=(Misc::UInt64(1)<<53)-1; // Largest integer mantissa that converts to double without rounding
+const double exactPowersOfTen[23]= // Powers of ten that are exactly representable as doubles
+	{
+	1.0e0,1.0e1,1.0e2,1.0e3,1.0e4,1.0e5,1.0e6,1.0e7,1.0e8,1.0e9,
+	1.0e10,1.0e11,1.0e12,1.0e13,1.0e14,1.0e15,1.0e16,1.0e17,1.0e18,1.0e19,
+	1.0e20,1.0e21,1.0e22
+	};
+
+inline bool nextBufferChar(int& c,const unsigned char*& bPtr,const unsigned char* bEnd) // Reads the next character from a read buffer; returns false at the end of the buffer
+	{
+	if(bPtr==bEnd)
+		return false;
+	c=*(bPtr++);
+	return true;
+	}
+
+}
+
 /****************************
 Methods of class ValueSource:
 ****************************/
@@ -121,6 +147,190 @@ char ValueSource::processEscape(void)
 	return result;
 	}
 
+void ValueSource::finishBufferNumber(const unsigned char* bufferStart,const unsigned char* bPtr,int terminator)
+	{
+	/* Mark the number and its terminating character as read: */
+	source->skipInBuffer(bPtr-bufferStart);
+	lastChar=terminator;
+	
+	/* Skip whitespace: */
+	while(cc[lastChar]&WHITESPACE)
+		lastChar=source->getChar();
+	}
+
+bool ValueSource::readIntegerInBuffer(int& result)
+	{
+	/* Access the unread part of the source's read buffer: */
+	const void* buffer;
+	size_t bufferSize=source->peekInBuffer(buffer);
+	const unsigned char* bufferStart=static_cast<const unsigned char*>(buffer);
+	const unsigned char* bPtr=bufferStart;
+	const unsigned char* bEnd=bufferStart+bufferSize;
+	int c=lastChar;
+	
+	/* Read a plus or minus sign: */
+	bool negate=c=='-';
+	if((c=='-'||c=='+')&&!nextBufferChar(c,bPtr,bEnd))
+		return false;
+	
+	/* Read up to nine digits, which cannot overflow: */
+	int numDigits=0;
+	int value=0;
+	while(cc[c]&DIGIT)
+		{
+		if(numDigits==9)
+			return false;
+		value=value*10+int(c-'0');
+		++numDigits;
+		if(!nextBufferChar(c,bPtr,bEnd))
+			return false;
+		}
+	
+	/* Let the slow path signal errors: */
+	if(numDigits==0)
+		return false;
+	
+	result=negate?-value:value;
+	finishBufferNumber(bufferStart,bPtr,c);
+	return true;
+	}
+
+bool ValueSource::readUnsignedIntegerInBuffer(unsigned int& result)
+	{
+	/* Access the unread part of the source's read buffer: */
+	const void* buffer;
+	size_t bufferSize=source->peekInBuffer(buffer);
+	const unsigned char* bufferStart=static_cast<const unsigned char*>(buffer);
+	const unsigned char* bPtr=bufferStart;
+	const unsigned char* bEnd=bufferStart+bufferSize;
+	int c=lastChar;
+	
+	/* Read up to nine digits, which cannot overflow: */
+	int numDigits=0;
+	unsigned int value=0;
+	while(cc[c]&DIGIT)
+		{
+		if(numDigits==9)
+			return false;
+		value=value*10U+(unsigned int)(c-'0');
+		++numDigits;
+		if(!nextBufferChar(c,bPtr,bEnd))
+			return false;
+		}
+	
+	/* Let the slow path signal errors: */
+	if(numDigits==0)
+		return false;
+	
+	result=value;
+	finishBufferNumber(bufferStart,bPtr,c);
+	return true;
+	}
+
+bool ValueSource::readNumberInBuffer(double& result)
+	{
+	/* Access the unread part of the source's read buffer: */
+	const void* buffer;
+	size_t bufferSize=source->peekInBuffer(buffer);
+	const unsigned char* bufferStart=static_cast<const unsigned char*>(buffer);
+	const unsigned char* bPtr=bufferStart;
+	const unsigned char* bEnd=bufferStart+bufferSize;
+	int c=lastChar;
+	
+	/* Read a plus or minus sign: */
+	bool negate=c=='-';
+	if((c=='-'||c=='+')&&!nextBufferChar(c,bPtr,bEnd))
+		return false;
+	
+	/*********************************************************************
+	Accumulate all mantissa digits into an integer and track the decimal
+	exponent separately. If the mantissa stays exactly representable and
+	the exponent's magnitude is small, a single multiplication or division
+	by an exact power of ten yields the correctly rounded result, i.e.,
+	the same value strtod() would return. Everything else, including
+	numbers that continue past the end of the read buffer, is left to the
+	slow path.
+	*********************************************************************/
+	
+	/* Read an integral number part: */
+	bool haveDigit=false;
+	Misc::UInt64 mantissa=0;
+	int exponent=0;
+	while(cc[c]&DIGIT)
+		{
+		haveDigit=true;
+		if(mantissa>(maxExactMantissa-9)/10)
+			return false;
+		mantissa=mantissa*10+Misc::UInt64(c-'0');
+		if(!nextBufferChar(c,bPtr,bEnd))
+			return false;
+		}
+	
+	/* Check for a period: */
+	if(c=='.')
+		{
+		if(!nextBufferChar(c,bPtr,bEnd))
+			return false;
+		
+		/* Read a fractional number part: */
+		while(cc[c]&DIGIT)
+			{
+			haveDigit=true;
+			if(mantissa>(maxExactMantissa-9)/10)
+				return false;
+			mantissa=mantissa*10+Misc::UInt64(c-'0');
+			--exponent;
+			if(!nextBufferChar(c,bPtr,bEnd))
+				return false;
+			}
+		}
+	
+	/* Let the slow path signal errors: */
+	if(!haveDigit)
+		return false;
+	
+	/* Check for an exponent indicator: */
+	if(c=='e'||c=='E')
+		{
+		if(!nextBufferChar(c,bPtr,bEnd))
+			return false;
+		
+		/* Read a plus or minus sign: */
+		bool negateExponent=c=='-';
+		if((c=='-'||c=='+')&&!nextBufferChar(c,bPtr,bEnd))
+			return false;
+		
+		/* Read the exponent: */
+		if(!(cc[c]&DIGIT))
+			return false;
+		int explicitExponent=0;
+		while(cc[c]&DIGIT)
+			{
+			if(explicitExponent>1000)
+				return false;
+			explicitExponent=explicitExponent*10+int(c-'0');
+			if(!nextBufferChar(c,bPtr,bEnd))
+				return false;
+			}
+		exponent+=negateExponent?-explicitExponent:explicitExponent;
+		}
+	
+	/* Use the slow path if the exponent is out of range: */
+	if(exponent<-22||exponent>22)
+		return false;
+	
+	/* Assemble the result: */
+	double value=double(mantissa);
+	if(exponent>=0)
+		value*=exactPowersOfTen[exponent];
+	else
+		value/=exactPowersOfTen[-exponent];
+	result=negate?-value:value;
+	
+	finishBufferNumber(bufferStart,bPtr,c);
+	return true;
+	}
+
 ValueSource::ValueSource(FilePtr sSource)
 	:source(sSource),
 	 cc(characterClasses+1),
@@ -579,6 +789,11 @@ std::string ValueSource::readString(void)
 
 int ValueSource::readInteger(void)
 	{
+	/* Try the fast path first: */
+	int fastResult;
+	if(readIntegerInBuffer(fastResult))
+		return fastResult;
+	
 	/* Read a plus or minus sign: */
 	bool negate=lastChar=='-';
 	if(lastChar=='-'||lastChar=='+')
@@ -609,6 +824,11 @@ int ValueSource::readInteger(void)
 
 unsigned int ValueSource::readUnsignedInteger(void)
 	{
+	/* Try the fast path first: */
+	unsigned int fastResult;
+	if(readUnsignedIntegerInBuffer(fastResult))
+		return fastResult;
+	
 	/* Signal an error if the next character is not a digit: */
 	if(!(cc[lastChar]&DIGIT))
 		throw NumberError();
@@ -630,11 +850,21 @@ unsigned int ValueSource::readUnsignedInteger(void)
 
 double ValueSource::readNumber(void)
 	{
+	/* Try the fast path first: */
+	double fastResult;
+	if(readNumberInBuffer(fastResult))
+		return fastResult;
+	
 	/* Read a plus or minus sign: */
 	bool negate=lastChar=='-';
 	if(lastChar=='-'||lastChar=='+')
 		lastChar=source->getChar();
 	
+	/* Accumulate the mantissa digits as in the fast path as long as they stay exact, so that results do not depend on buffer boundaries: */
+	bool exact=true;
+	Misc::UInt64 mantissa=0;
+	int mantissaExponent=0;
+	
 	/* Read an integral number part: */
 	bool haveDigit=false;
 	double result=0.0;
@@ -642,6 +872,10 @@ double ValueSource::readNumber(void)
 		{
 		haveDigit=true;
 		result=result*10.0+double(lastChar-'0');
+		if(mantissa>(maxExactMantissa-9)/10)
+			exact=false;
+		else
+			mantissa=mantissa*10+Misc::UInt64(lastChar-'0');
 		lastChar=source->getChar();
 		}
 	
@@ -658,6 +892,13 @@ double ValueSource::readNumber(void)
 			haveDigit=true;
 			fraction=fraction*10.0+double(lastChar-'0');
 			fractionBase*=10.0;
+			if(mantissa>(maxExactMantissa-9)/10)
+				exact=false;
+			else
+				{
+				mantissa=mantissa*10+Misc::UInt64(lastChar-'0');
+				--mantissaExponent;
+				}
 			lastChar=source->getChar();
 			}
 		
@@ -668,11 +909,8 @@ double ValueSource::readNumber(void)
 	if(!haveDigit)
 		throw NumberError();
 	
-	/* Negate the result if a minus sign was read: */
-	if(negate)
-		result=-result;
-	
 	/* Check for an exponent indicator: */
+	double exponent=0.0;
 	if(lastChar=='e'||lastChar=='E')
 		{
 		lastChar=source->getChar();
@@ -687,17 +925,35 @@ double ValueSource::readNumber(void)
 			throw NumberError();
 		
 		/* Read the exponent: */
-		double exponent=0.0;
 		while(cc[lastChar]&DIGIT)
 			{
 			exponent=exponent*10.0+double(lastChar-'0');
 			lastChar=source->getChar();
 			}
-		
+		if(negateExponent)
+			exponent=-exponent;
+		}
+	
+	if(exact&&exponent+double(mantissaExponent)>=-22.0&&exponent+double(mantissaExponent)<=22.0)
+		{
+		/* Assemble the correctly rounded result exactly like the fast path: */
+		int totalExponent=int(exponent)+mantissaExponent;
+		result=double(mantissa);
+		if(totalExponent>=0)
+			result*=exactPowersOfTen[totalExponent];
+		else
+			result/=exactPowersOfTen[-totalExponent];
+		}
+	else if(exponent!=0.0)
+		{
 		/* Multiply the mantissa with the exponent: */
-		result*=pow(10.0,negateExponent?-exponent:exponent);
+		result*=pow(10.0,exponent);
 		}
 	
+	/* Negate the result if a minus sign was read: */
+	if(negate)
+		result=-result;
+	
 	/* Skip whitespace: */
 	while(cc[lastChar]&WHITESPACE)
 		lastChar=source->getChar();
@@ -705,4 +961,28 @@ double ValueSource::readNumber(void)
 	return result;
 	}
 
+void ValueSource::readIntegers(size_t numValues,int* values)
+	{
+	for(size_t i=0;i<numValues;++i)
+		values[i]=readInteger();
+	}
+
+void ValueSource::readUnsignedIntegers(size_t numValues,unsigned int* values)
+	{
+	for(size_t i=0;i<numValues;++i)
+		values[i]=readUnsignedInteger();
+	}
+
+void ValueSource::readNumbers(size_t numValues,double* values)
+	{
+	for(size_t i=0;i<numValues;++i)
+		values[i]=readNumber();
+	}
+
+void ValueSource::readNumbers(size_t numValues,float* values)
+	{
+	for(size_t i=0;i<numValues;++i)
+		values[i]=float(readNumber());
+	}
+
 }
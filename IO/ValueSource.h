@@ -63,6 +63,10 @@ class ValueSource
 	
 	/* Private methods: */
 	char processEscape(void); // Processes an escape sequence from the character source
+	void finishBufferNumber(const unsigned char* bufferStart,const unsigned char* bPtr,int terminator); // Consumes a number parsed directly from the source's read buffer up to the given position, and skips whitespace
+	bool readIntegerInBuffer(int& result); // Fast path to read a signed integer directly from the source's read buffer; returns false if the slow path has to be used
+	bool readUnsignedIntegerInBuffer(unsigned int& result); // Ditto, for unsigned integers
+	bool readNumberInBuffer(double& result); // Ditto, for floating-point numbers
 	
 	/* Constructors and destructors: */
 	public:
@@ -140,6 +144,10 @@ class ValueSource
 	int readInteger(void); // Reads the next signed integer from the character source
 	unsigned int readUnsignedInteger(void); // Reads the next unsigned integer from the character source
 	double readNumber(void); // Reads the next floating-point number from the character source
+	void readIntegers(size_t numValues,int* values); // Reads the given number of signed integers into the given array
+	void readUnsignedIntegers(size_t numValues,unsigned int* values); // Reads the given number of unsigned integers into the given array
+	void readNumbers(size_t numValues,double* values); // Reads the given number of floating-point numbers into the given array
+	void readNumbers(size_t numValues,float* values); // Ditto, converting to single precision
 	};
 
 }
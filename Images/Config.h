@@ -24,6 +24,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #define IMAGES_CONFIG_HAVE_PNG 1
 #define IMAGES_CONFIG_HAVE_JPEG 1
-#define IMAGES_CONFIG_HAVE_TIFF 1
+#define IMAGES_CONFIG_HAVE_TIFF 0
 
 #endif
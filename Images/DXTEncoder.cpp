@@ -0,0 +1,327 @@
+/***********************************************************************
+DXTEncoder - Functions to compress RGBA images into S3TC DXT1 or DXT5
+blocks for upload as compressed OpenGL textures, and to decompress them
+for OpenGL contexts without S3TC support.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Images/DXTEncoder.h>
+
+#include <Misc/SizedTypes.h>
+
+namespace Images {
+
+namespace {
+
+/**************************************
+Helper functions for block compression:
+**************************************/
+
+inline unsigned int packRGB565(int r,int g,int b) // Packs 8-bit color components into a 5:6:5 color, rounding to nearest
+	{
+	return (((r*31+127)/255)<<11)|(((g*63+127)/255)<<5)|((b*31+127)/255);
+	}
+
+inline void unpackRGB565(unsigned int color,int rgb[3]) // Expands a 5:6:5 color to 8-bit color components the way the hardware does
+	{
+	int r=(color>>11)&0x1f;
+	int g=(color>>5)&0x3f;
+	int b=color&0x1f;
+	rgb[0]=(r<<3)|(r>>2);
+	rgb[1]=(g<<2)|(g>>4);
+	rgb[2]=(b<<3)|(b>>2);
+	}
+
+void encodeColorBlock(const RGBAImage::Color block[16],unsigned char result[8]) // Encodes the color part of a DXT1 or DXT5 block
+	{
+	/* Find the bounding box of the block's colors: */
+	int min[3],max[3];
+	for(int i=0;i<3;++i)
+		min[i]=max[i]=block[0][i];
+	for(int p=1;p<16;++p)
+		for(int i=0;i<3;++i)
+			{
+			if(min[i]>block[p][i])
+				min[i]=block[p][i];
+			if(max[i]<block[p][i])
+				max[i]=block[p][i];
+			}
+	
+	/* Inset the bounding box slightly to reduce the influence of outliers: */
+	for(int i=0;i<3;++i)
+		{
+		int inset=(max[i]-min[i])>>4;
+		min[i]+=inset;
+		max[i]-=inset;
+		}
+	
+	/* Select the bounding box diagonal that best matches the colors' correlation: */
+	int center[3];
+	for(int i=0;i<3;++i)
+		center[i]=(min[i]+max[i])>>1;
+	int covRG=0,covRB=0;
+	for(int p=0;p<16;++p)
+		{
+		int d0=block[p][0]-center[0];
+		covRG+=d0*(block[p][1]-center[1]);
+		covRB+=d0*(block[p][2]-center[2]);
+		}
+	if(covRG<0)
+		{
+		int t=min[1];
+		min[1]=max[1];
+		max[1]=t;
+		}
+	if(covRB<0)
+		{
+		int t=min[2];
+		min[2]=max[2];
+		max[2]=t;
+		}
+	
+	/* Quantize the endpoints and order them to select the four-color mode: */
+	unsigned int c0=packRGB565(max[0],max[1],max[2]);
+	unsigned int c1=packRGB565(min[0],min[1],min[2]);
+	if(c0<c1)
+		{
+		unsigned int t=c0;
+		c0=c1;
+		c1=t;
+		}
+	result[0]=(unsigned char)(c0&0xff);
+	result[1]=(unsigned char)(c0>>8);
+	result[2]=(unsigned char)(c1&0xff);
+	result[3]=(unsigned char)(c1>>8);
+	
+	/* Calculate the block's palette as the hardware will decode it: */
+	int palette[4][3];
+	unpackRGB565(c0,palette[0]);
+	unpackRGB565(c1,palette[1]);
+	for(int i=0;i<3;++i)
+		{
+		palette[2][i]=(2*palette[0][i]+palette[1][i])/3;
+		palette[3][i]=(palette[0][i]+2*palette[1][i])/3;
+		}
+	
+	/* Assign each pixel to its closest palette entry; identical endpoints map everything to the first entry: */
+	unsigned int indices=0;
+	if(c0!=c1)
+		{
+		for(int p=15;p>=0;--p)
+			{
+			int bestIndex=0;
+			int bestDist2=0x7fffffff;
+			for(int e=0;e<4;++e)
+				{
+				int dist2=0;
+				for(int i=0;i<3;++i)
+					{
+					int d=int(block[p][i])-palette[e][i];
+					dist2+=d*d;
+					}
+				if(bestDist2>dist2)
+					{
+					bestIndex=e;
+					bestDist2=dist2;
+					}
+				}
+			indices=(indices<<2)|(unsigned int)bestIndex;
+			}
+		}
+	for(int i=0;i<4;++i)
+		result[4+i]=(unsigned char)((indices>>(i*8))&0xff);
+	}
+
+void encodeAlphaBlock(const RGBAImage::Color block[16],unsigned char result[8]) // Encodes the interpolated alpha part of a DXT5 block
+	{
+	/* Find the alpha range: */
+	int min=block[0][3];
+	int max=block[0][3];
+	for(int p=1;p<16;++p)
+		{
+		if(min>block[p][3])
+			min=block[p][3];
+		if(max<block[p][3])
+			max=block[p][3];
+		}
+	
+	/* Use the eight-value mode, which requires the first endpoint to be larger: */
+	result[0]=(unsigned char)max;
+	result[1]=(unsigned char)min;
+	
+	/* Assign each pixel to its closest alpha value; palette entries are a0, a1, then six interpolants from a0 to a1: */
+	Misc::UInt64 indices=0;
+	if(max>min)
+		{
+		int range=max-min;
+		for(int p=15;p>=0;--p)
+			{
+			/* Calculate the closest interpolation step between max (step 0) and min (step 7): */
+			int step=((max-int(block[p][3]))*7+range/2)/range;
+			int index=step==0?0:(step==7?1:step+1);
+			indices=(indices<<3)|Misc::UInt64(index);
+			}
+		}
+	for(int i=0;i<6;++i)
+		result[2+i]=(unsigned char)((indices>>(i*8))&0xff);
+	}
+
+void decodeColorBlock(const unsigned char block[8],bool dxt1,RGBAImage::Color result[16]) // Decodes the color part of a DXT1 or DXT5 block; DXT1 blocks can select the three-color mode with transparent black
+	{
+	/* Calculate the block's palette: */
+	unsigned int c0=(unsigned int)(block[0])|((unsigned int)(block[1])<<8);
+	unsigned int c1=(unsigned int)(block[2])|((unsigned int)(block[3])<<8);
+	int palette[4][4];
+	unpackRGB565(c0,palette[0]);
+	unpackRGB565(c1,palette[1]);
+	palette[0][3]=palette[1][3]=palette[2][3]=palette[3][3]=255;
+	if(c0>c1||!dxt1)
+		{
+		for(int i=0;i<3;++i)
+			{
+			palette[2][i]=(2*palette[0][i]+palette[1][i])/3;
+			palette[3][i]=(palette[0][i]+2*palette[1][i])/3;
+			}
+		}
+	else
+		{
+		for(int i=0;i<3;++i)
+			{
+			palette[2][i]=(palette[0][i]+palette[1][i])/2;
+			palette[3][i]=0;
+			}
+		palette[3][3]=0;
+		}
+	
+	/* Look up all pixels: */
+	unsigned int indices=(unsigned int)(block[4])|((unsigned int)(block[5])<<8)|((unsigned int)(block[6])<<16)|((unsigned int)(block[7])<<24);
+	for(int p=0;p<16;++p,indices>>=2)
+		for(int i=0;i<4;++i)
+			result[p][i]=GLubyte(palette[indices&0x3U][i]);
+	}
+
+void decodeAlphaBlock(const unsigned char block[8],RGBAImage::Color result[16]) // Decodes the interpolated alpha part of a DXT5 block
+	{
+	/* Calculate the block's alpha palette in eight-value or six-value mode: */
+	int palette[8];
+	palette[0]=block[0];
+	palette[1]=block[1];
+	if(palette[0]>palette[1])
+		{
+		for(int i=1;i<7;++i)
+			palette[i+1]=((7-i)*palette[0]+i*palette[1])/7;
+		}
+	else
+		{
+		for(int i=1;i<5;++i)
+			palette[i+1]=((5-i)*palette[0]+i*palette[1])/5;
+		palette[6]=0;
+		palette[7]=255;
+		}
+	
+	/* Look up all pixels: */
+	Misc::UInt64 indices=0;
+	for(int i=5;i>=0;--i)
+		indices=(indices<<8)|Misc::UInt64(block[2+i]);
+	for(int p=0;p<16;++p,indices>>=3)
+		result[p][3]=GLubyte(palette[indices&0x7U]);
+	}
+
+void fetchBlock(unsigned int width,unsigned int height,const RGBAImage::Color* pixels,unsigned int bx,unsigned int by,RGBAImage::Color block[16]) // Copies a 4x4 block from an image, replicating edge pixels
+	{
+	for(unsigned int y=0;y<4;++y)
+		{
+		unsigned int sy=by+y<height?by+y:height-1;
+		const RGBAImage::Color* rowPtr=pixels+size_t(sy)*size_t(width);
+		for(unsigned int x=0;x<4;++x)
+			{
+			unsigned int sx=bx+x<width?bx+x:width-1;
+			block[y*4+x]=rowPtr[sx];
+			}
+		}
+	}
+
+}
+
+/*************************************************
+Functions to encode and decode DXT1 and DXT5 data:
+*************************************************/
+
+void encodeDXT1Block(const RGBAImage::Color block[16],unsigned char result[8])
+	{
+	encodeColorBlock(block,result);
+	}
+
+void encodeDXT5Block(const RGBAImage::Color block[16],unsigned char result[16])
+	{
+	encodeAlphaBlock(block,result);
+	encodeColorBlock(block,result+8);
+	}
+
+size_t getDXTSize(unsigned int width,unsigned int height,bool dxt5)
+	{
+	return size_t((width+3)/4)*size_t((height+3)/4)*(dxt5?16:8);
+	}
+
+void encodeDXT(unsigned int width,unsigned int height,const RGBAImage::Color* pixels,bool dxt5,unsigned char* result)
+	{
+	RGBAImage::Color block[16];
+	for(unsigned int by=0;by<height;by+=4)
+		for(unsigned int bx=0;bx<width;bx+=4)
+			{
+			fetchBlock(width,height,pixels,bx,by,block);
+			if(dxt5)
+				{
+				encodeDXT5Block(block,result);
+				result+=16;
+				}
+			else
+				{
+				encodeDXT1Block(block,result);
+				result+=8;
+				}
+			}
+	}
+
+void decodeDXT(unsigned int width,unsigned int height,const unsigned char* blocks,bool dxt5,RGBAImage::Color* result)
+	{
+	RGBAImage::Color block[16];
+	for(unsigned int by=0;by<height;by+=4)
+		for(unsigned int bx=0;bx<width;bx+=4)
+			{
+			if(dxt5)
+				{
+				decodeColorBlock(blocks+8,false,block);
+				decodeAlphaBlock(blocks,block);
+				blocks+=16;
+				}
+			else
+				{
+				decodeColorBlock(blocks,true,block);
+				blocks+=8;
+				}
+			
+			/* Store the block's pixels that lie inside the image: */
+			for(unsigned int y=0;y<4&&by+y<height;++y)
+				for(unsigned int x=0;x<4&&bx+x<width;++x)
+					result[size_t(by+y)*size_t(width)+size_t(bx+x)]=block[y*4+x];
+			}
+	}
+
+}
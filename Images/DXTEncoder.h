@@ -0,0 +1,41 @@
+/***********************************************************************
+DXTEncoder - Functions to compress RGBA images into S3TC DXT1 or DXT5
+blocks for upload as compressed OpenGL textures, and to decompress them
+for OpenGL contexts without S3TC support.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IMAGES_DXTENCODER_INCLUDED
+#define IMAGES_DXTENCODER_INCLUDED
+
+#include <stddef.h>
+#include <Images/RGBAImage.h>
+
+namespace Images {
+
+void encodeDXT1Block(const RGBAImage::Color block[16],unsigned char result[8]); // Encodes a 4x4 block of pixels in row-major order into an opaque four-color DXT1 block; ignores alpha
+void encodeDXT5Block(const RGBAImage::Color block[16],unsigned char result[16]); // Encodes a 4x4 block of pixels in row-major order into a DXT5 block with interpolated alpha
+
+size_t getDXTSize(unsigned int width,unsigned int height,bool dxt5); // Returns the size of a DXT1- or DXT5-compressed image of the given size in bytes
+void encodeDXT(unsigned int width,unsigned int height,const RGBAImage::Color* pixels,bool dxt5,unsigned char* result); // Encodes an image in row-major pixel order into DXT1 or DXT5 blocks; partial blocks along the right and top edges are padded by replicating edge pixels; result must have room for getDXTSize bytes
+void decodeDXT(unsigned int width,unsigned int height,const unsigned char* blocks,bool dxt5,RGBAImage::Color* result); // Decodes DXT1 or DXT5 blocks into an image in row-major pixel order, the way the hardware does; result must have room for width*height pixels
+
+}
+
+#endif
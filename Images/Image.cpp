@@ -44,7 +44,7 @@ Image<ScalarParam,numComponentsParam>::ImageRepresentation::ImageRepresentation(
 	size[1]=sHeight;
 	
 	/* Allocate the image array: */
-	image=new Color[size[0]*size[1]];
+	image=new Color[size_t(size[0])*size_t(size[1])];
 	}
 
 template <class ScalarParam,int numComponentsParam>
@@ -191,57 +191,20 @@ template <class ScalarParam,int numComponentsParam>
 void
 Image<ScalarParam,numComponentsParam>::resize(
 	unsigned int newWidth,
-	unsigned int newHeight)
+	unsigned int newHeight,
+	Resampler::Filter filter)
 	{
-	unsigned int oldWidth=rep->size[0];
-	unsigned int oldHeight=rep->size[1];
-	
-	/* Allocate an intermediate floating-point buffer: */
-	typedef GLColor<GLfloat,numComponents> FColor;
-	FColor* buffer=new FColor[size_t(newWidth)*size_t(oldHeight)];
-	
-	/* Resample pixel rows: */
-	for(unsigned int x=0;x<newWidth;++x)
-		{
-		float sampleX=(float(x)+0.5f)*float(oldWidth)/float(newWidth)+0.5f;
-		/* Note: sampleX is the x coordinate of the next pixel to the right, to get around some issues. */
-		
-		unsigned int sx=(unsigned int)(sampleX);
-		const Color* sCol0=sx>0?&rep->image[sx-1]:&rep->image[0];
-		const Color* sCol1=sx<oldWidth?&rep->image[sx]:&rep->image[oldWidth-1];
-		float w1=sampleX-float(sx);
-		float w0=1.0f-w1;
-		FColor* dCol=&buffer[x];
-		for(unsigned int y=0;y<oldHeight;++y,sCol0+=oldWidth,sCol1+=oldWidth,dCol+=newWidth)
-			{
-			for(int i=0;i<numComponents;++i)
-				(*dCol)[i]=GLfloat((*sCol0)[i])*w0+GLfloat((*sCol1)[i])*w1;
-			}
-		}
+	/* Resample the image into a new image representation: */
+	unsigned int newSize[2];
+	newSize[0]=newWidth;
+	newSize[1]=newHeight;
+	ImageRepresentation* newRep=new ImageRepresentation(newWidth,newHeight);
+	Resampler resampler(filter);
+	resampler.resample(numComponents,rep->size,rep->image[0].getRgba(),newSize,newRep->image[0].getRgba());
 	
-	/* Create the new image representation: */
+	/* Replace the image representation: */
 	rep->detach();
-	rep=new ImageRepresentation(newWidth,newHeight);
-	
-	/* Resample pixel columns: */
-	for(unsigned int y=0;y<newHeight;++y)
-		{
-		float sampleY=(float(y)+0.5f)*float(oldHeight)/float(newHeight)+0.5f;
-		/* Note: sampleY is the y coordinate of the next pixel to the top, to get around some issues. */
-		
-		unsigned int sy=(unsigned int)(sampleY);
-		const FColor* sRow0=sy>0?&buffer[(sy-1)*newWidth]:&buffer[0];
-		const FColor* sRow1=sy<oldHeight?&buffer[sy*newWidth]:&buffer[(oldHeight-1)*newWidth];
-		float w1=sampleY-float(sy);
-		float w0=1.0f-w1;
-		Color* dRow=&rep->image[y*newWidth];
-		for(unsigned int x=0;x<newWidth;++x,++sRow0,++sRow1,++dRow)
-			{
-			for(int i=0;i<numComponents;++i)
-				(*dRow)[i]=Scalar((*sRow0)[i]*w0+(*sRow1)[i]*w1+0.5f);
-			}
-		}
-	delete[] buffer;
+	rep=newRep;
 	}
 
 /*************************************************
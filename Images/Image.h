@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <stddef.h>
 #include <GL/gl.h>
 #include <GL/GLColor.h>
+#include <Images/Resampler.h>
 
 namespace Images {
 
@@ -206,7 +207,11 @@ class Image
 		/* Return the row pointer: */
 		return &rep->image[size_t(y)*size_t(rep->size[0])];
 		}
-	void resize(unsigned int newWidth,unsigned int newHeight); // Resamples the image to the given size
+	void resize(unsigned int newWidth,unsigned int newHeight,Resampler::Filter filter); // Resamples the image to the given size using the given filter
+	void resize(unsigned int newWidth,unsigned int newHeight) // Resamples the image to the given size using bilinear interpolation
+		{
+		resize(newWidth,newHeight,Resampler::BILINEAR);
+		}
 	};
 
 }
@@ -0,0 +1,521 @@
+/***********************************************************************
+ImagePyramid - Class for tiled multi-resolution image pyramids stored in
+memory-mapped files, to display images too large to be held in memory
+or texture memory as a whole. Tiles are paged in by a background thread
+on request.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Images/ImagePyramid.h>
+
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <stdexcept>
+#include <Misc/SelfDestructPointer.h>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/StringPrintf.h>
+#include <IO/File.h>
+#include <IO/SeekableFile.h>
+#include <IO/OpenFile.h>
+#include <IO/MemMappedFile.h>
+#include <Images/RGBImage.h>
+#include <Images/ImageReader.h>
+
+namespace Images {
+
+namespace {
+
+/**************************************
+Helper objects for image pyramid files:
+**************************************/
+
+const char pyramidMagic[16]="VruiPyramid"; // Identifier at the beginning of pyramid files
+const Misc::UInt32 pyramidVersion=2; // Version number of the pyramid file format
+const Misc::UInt32 pyramidByteOrderMark=0x01020304U; // Marker to reject pyramid files written on machines with different endianness
+const size_t pyramidAlignment=4096; // Alignment of tile data inside pyramid files, to page in tiles with few page faults
+const size_t maxStripSize=size_t(64)*size_t(1024)*size_t(1024); // Maximum size of a strip of source image rows decoded in one go while building a pyramid
+
+/*********************************************************
+Helper function to calculate the layout of a pyramid file:
+*********************************************************/
+
+size_t calcPyramidLayout(const unsigned int imageSize[2],unsigned int tileSize,std::vector<ImagePyramid::Level>& levels) // Calculates the sizes and tile offsets of all levels; returns the total file size
+	{
+	/* Halve the image size until the level fits into the interior of a single tile: */
+	unsigned int tileStride=tileSize-2;
+	unsigned int size[2];
+	for(int i=0;i<2;++i)
+		size[i]=imageSize[i];
+	while(true)
+		{
+		ImagePyramid::Level level;
+		for(int i=0;i<2;++i)
+			{
+			level.size[i]=size[i];
+			level.numTiles[i]=(size[i]+tileStride-1)/tileStride;
+			}
+		level.offset=0;
+		levels.push_back(level);
+		if(size[0]<=tileStride&&size[1]<=tileStride)
+			break;
+		for(int i=0;i<2;++i)
+			size[i]=(size[i]+1)/2;
+		}
+	
+	/* Calculate the size of the file header and align the first tile: */
+	size_t offset=sizeof(pyramidMagic)+2*sizeof(Misc::UInt32)+2*sizeof(Misc::SInt64)+4*sizeof(Misc::UInt32);
+	offset+=levels.size()*(2*sizeof(Misc::UInt32)+sizeof(Misc::UInt64));
+	offset=(offset+pyramidAlignment-1)/pyramidAlignment*pyramidAlignment;
+	
+	/* Store all levels' tiles consecutively: */
+	size_t tileDataSize=size_t(tileSize)*size_t(tileSize)*3;
+	for(std::vector<ImagePyramid::Level>::iterator lIt=levels.begin();lIt!=levels.end();++lIt)
+		{
+		lIt->offset=offset;
+		offset+=size_t(lIt->numTiles[0])*size_t(lIt->numTiles[1])*tileDataSize;
+		}
+	
+	return offset;
+	}
+
+/**************************************************************
+Helper class to write a pyramid level while it is being built:
+**************************************************************/
+
+class PyramidLevelWriter
+	{
+	/* Elements: */
+	private:
+	IO::SeekableFile& pyramid; // The pyramid file being written
+	const ImagePyramid::Level& level; // Layout of the written level
+	unsigned int tileSize; // Width and height of all tiles in pixels
+	unsigned int tileStride; // Distance between adjacent tiles in pixels
+	size_t rowSize; // Size of one of the level's pixel rows in bytes
+	PyramidLevelWriter* next; // Writer for the next coarser level, or null if this is the coarsest level
+	GLubyte* strips[2]; // Buffers holding the rows of the two overlapping rows of tiles currently being assembled
+	GLubyte* tile; // Buffer to assemble a single tile
+	GLubyte* pendingRow; // Odd-numbered row waiting to be downsampled together with the following row
+	GLubyte* downsampledRow; // Buffer for a row of the next coarser level
+	unsigned int numRows; // Number of rows received so far
+	
+	/* Private methods: */
+	void writeTileRow(unsigned int ty) // Writes the given row of tiles from its strip buffer, replicating edge pixels into tile borders and partial tiles
+		{
+		const GLubyte* strip=strips[ty%2];
+		size_t tileDataSize=size_t(tileSize)*size_t(tileSize)*3;
+		pyramid.setWritePosAbs(IO::SeekableFile::Offset(level.offset+size_t(ty)*size_t(level.numTiles[0])*tileDataSize));
+		for(unsigned int tx=0;tx<level.numTiles[0];++tx)
+			{
+			/* Calculate the range of level columns covered by the tile and its border: */
+			unsigned int x0=tx>0?tx*tileStride-1:0;
+			unsigned int x1=tx*tileStride+tileStride<level.size[0]?tx*tileStride+tileStride:level.size[0]-1;
+			unsigned int i0=x0+1-tx*tileStride;
+			unsigned int i1=x1+1-tx*tileStride;
+			
+			GLubyte* tPtr=tile;
+			for(unsigned int j=0;j<tileSize;++j,tPtr+=tileSize*3)
+				{
+				/* Find the strip row holding the level row covered by the tile row, clamped to the level: */
+				unsigned int y=ty*tileStride+j;
+				y=y>0?y-1:0;
+				if(y>=level.size[1])
+					y=level.size[1]-1;
+				const GLubyte* sRow=strip+size_t(y+1-ty*tileStride)*rowSize;
+				
+				/* Copy the covered pixels and replicate the level's edge pixels: */
+				for(unsigned int i=0;i<i0;++i)
+					memcpy(tPtr+i*3,sRow+size_t(x0)*3,3);
+				memcpy(tPtr+i0*3,sRow+size_t(x0)*3,size_t(i1-i0+1)*3);
+				for(unsigned int i=i1+1;i<tileSize;++i)
+					memcpy(tPtr+i*3,sRow+size_t(x1)*3,3);
+				}
+			pyramid.writeRaw(tile,tileDataSize);
+			}
+		}
+	void downsample(const GLubyte* row0,const GLubyte* row1) // Box-filters the given pair of rows into a row of the next coarser level and passes it on
+		{
+		unsigned int nextWidth=(level.size[0]+1)/2;
+		GLubyte* dPtr=downsampledRow;
+		for(unsigned int x=0;x<nextWidth;++x,dPtr+=3)
+			{
+			size_t x0=size_t(2*x)*3;
+			size_t x1=2*x+1<level.size[0]?x0+3:x0;
+			for(int i=0;i<3;++i)
+				dPtr[i]=GLubyte(((unsigned int)(row0[x0+i])+(unsigned int)(row0[x1+i])+(unsigned int)(row1[x0+i])+(unsigned int)(row1[x1+i])+2U)/4U);
+			}
+		next->addRow(downsampledRow);
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	PyramidLevelWriter(IO::SeekableFile& sPyramid,const ImagePyramid::Level& sLevel,unsigned int sTileSize,PyramidLevelWriter* sNext)
+		:pyramid(sPyramid),level(sLevel),tileSize(sTileSize),tileStride(tileSize-2),
+		 rowSize(size_t(level.size[0])*3),next(sNext),
+		 tile(new GLubyte[size_t(tileSize)*size_t(tileSize)*3]),
+		 pendingRow(next!=0?new GLubyte[rowSize]:0),downsampledRow(next!=0?new GLubyte[size_t((level.size[0]+1)/2)*3]:0),
+		 numRows(0)
+		{
+		for(int i=0;i<2;++i)
+			strips[i]=new GLubyte[size_t(tileSize)*rowSize];
+		}
+	~PyramidLevelWriter(void)
+		{
+		for(int i=0;i<2;++i)
+			delete[] strips[i];
+		delete[] tile;
+		delete[] pendingRow;
+		delete[] downsampledRow;
+		}
+	
+	/* Methods: */
+	void addRow(const GLubyte* row) // Adds the level's next pixel row, in order from top to bottom
+		{
+		unsigned int y=level.size[1]-1-numRows;
+		++numRows;
+		
+		/* Store the row in the strip buffers of all rows of tiles whose interiors or borders cover it: */
+		unsigned int tyMin=y>0?(y-1)/tileStride:0;
+		unsigned int tyMax=(y+1)/tileStride<level.numTiles[1]?(y+1)/tileStride:level.numTiles[1]-1;
+		for(unsigned int ty=tyMin;ty<=tyMax;++ty)
+			memcpy(strips[ty%2]+size_t(y+1-ty*tileStride)*rowSize,row,rowSize);
+		
+		/* Write the row of tiles whose lowest row was just received: */
+		if(y==0)
+			writeTileRow(0);
+		else if((y+1)%tileStride==0&&(y+1)/tileStride<level.numTiles[1])
+			writeTileRow((y+1)/tileStride);
+		
+		if(next!=0)
+			{
+			/* Downsample pairs of rows, replicating the top row of levels with odd height: */
+			if(y%2==1)
+				memcpy(pendingRow,row,rowSize);
+			else if(y==level.size[1]-1)
+				downsample(row,row);
+			else
+				downsample(row,pendingRow);
+			}
+		}
+	};
+
+}
+
+/*****************************
+Methods of class ImagePyramid:
+*****************************/
+
+void* ImagePyramid::loaderThreadMethod(void)
+	{
+	size_t pageSize=size_t(sysconf(_SC_PAGESIZE));
+	while(true)
+		{
+		/* Wait for the next request: */
+		TileIndex tileIndex;
+		{
+		Threads::MutexCond::Lock loaderLock(loaderCond);
+		while(!shutdown&&requestQueues.empty())
+			loaderCond.wait(loaderLock);
+		if(shutdown)
+			break;
+		
+		/* Take the next tile from the clients' queues in round-robin order, and drop drained queues: */
+		if(nextRequestQueue>=requestQueues.size())
+			nextRequestQueue=0;
+		RequestQueue& queue=requestQueues[nextRequestQueue];
+		tileIndex=queue.tiles.front();
+		queue.tiles.pop_front();
+		if(queue.tiles.empty())
+			{
+			requestQueues[nextRequestQueue]=requestQueues.back();
+			requestQueues.pop_back();
+			}
+		else
+			++nextRequestQueue;
+		if(readyTiles.isEntry(tileIndex))
+			continue;
+		}
+		
+		/* Page in the tile by touching each of its memory pages: */
+		const GLubyte* tile=getTile(tileIndex);
+		size_t pageStart=size_t(tile)/pageSize*pageSize;
+		madvise(reinterpret_cast<void*>(pageStart),size_t(tile)+tileDataSize-pageStart,MADV_WILLNEED);
+		volatile GLubyte sum=0;
+		for(size_t i=0;i<tileDataSize;i+=pageSize)
+			sum+=tile[i];
+		sum+=tile[tileDataSize-1];
+		
+		/* Mark the tile as ready and retire the oldest ready tiles: */
+		{
+		Threads::MutexCond::Lock loaderLock(loaderCond);
+		readyTiles.setEntry(TileSet::Entry(tileIndex));
+		readyQueue.push_back(tileIndex);
+		while(readyQueue.size()>maxNumReadyTiles)
+			{
+			readyTiles.removeEntry(readyQueue.front());
+			readyQueue.pop_front();
+			}
+		}
+		
+		/* Notify clients that the tile is ready: */
+		TileLoadedCallbackData cbData(this,tileIndex);
+		tileLoadedCallbacks.call(&cbData);
+		}
+	
+	return 0;
+	}
+
+ImagePyramid::ImagePyramid(const char* pyramidFileName)
+	:fileMemory(0),
+	 sourceFileSize(0),sourceModTime(0),
+	 tileSize(0),tileDataSize(0),
+	 nextRequestQueue(0),
+	 readyTiles(1021),maxNumReadyTiles(1024),
+	 shutdown(false)
+	{
+	/* Read the pyramid file's header: */
+	IO::FilePtr header=IO::openFile(pyramidFileName);
+	char magic[sizeof(pyramidMagic)];
+	header->readRaw(magic,sizeof(magic));
+	if(memcmp(magic,pyramidMagic,sizeof(pyramidMagic))!=0)
+		Misc::throwStdErr("Images::ImagePyramid: File %s is not an image pyramid file",pyramidFileName);
+	if(header->read<Misc::UInt32>()!=pyramidVersion||header->read<Misc::UInt32>()!=pyramidByteOrderMark)
+		Misc::throwStdErr("Images::ImagePyramid: Image pyramid file %s has unsupported version or byte order",pyramidFileName);
+	sourceFileSize=header->read<Misc::SInt64>();
+	sourceModTime=header->read<Misc::SInt64>();
+	for(int i=0;i<2;++i)
+		imageSize[i]=header->read<Misc::UInt32>();
+	tileSize=header->read<Misc::UInt32>();
+	unsigned int numLevels=header->read<Misc::UInt32>();
+	
+	/* Check the pyramid's layout against the header: */
+	if(imageSize[0]==0||imageSize[1]==0||tileSize<4||(tileSize&(tileSize-1))!=0)
+		Misc::throwStdErr("Images::ImagePyramid: Image pyramid file %s has invalid image or tile size",pyramidFileName);
+	size_t fileSize=calcPyramidLayout(imageSize,tileSize,levels);
+	tileDataSize=size_t(tileSize)*size_t(tileSize)*3;
+	bool valid=numLevels==levels.size();
+	for(std::vector<Level>::iterator lIt=levels.begin();valid&&lIt!=levels.end();++lIt)
+		{
+		for(int i=0;i<2;++i)
+			valid=valid&&header->read<Misc::UInt32>()==lIt->size[i];
+		valid=valid&&header->read<Misc::UInt64>()==Misc::UInt64(lIt->offset);
+		}
+	if(!valid)
+		Misc::throwStdErr("Images::ImagePyramid: Image pyramid file %s has corrupted header",pyramidFileName);
+	header=0;
+	
+	/* Memory-map the pyramid file: */
+	file=new IO::MemMappedFile(pyramidFileName);
+	if(size_t(file->getSize())<fileSize)
+		Misc::throwStdErr("Images::ImagePyramid: Image pyramid file %s is truncated",pyramidFileName);
+	fileMemory=static_cast<const GLubyte*>(static_cast<const IO::MemMappedFile*>(file.getPointer())->getMemory());
+	
+	/* Start the loader thread: */
+	loaderThread.start(this,&ImagePyramid::loaderThreadMethod);
+	}
+
+ImagePyramid::~ImagePyramid(void)
+	{
+	/* Tell the loader thread to exit and wait for it: */
+	{
+	Threads::MutexCond::Lock loaderLock(loaderCond);
+	shutdown=true;
+	loaderCond.broadcast();
+	}
+	loaderThread.join();
+	}
+
+std::string ImagePyramid::getPyramidFileName(const char* imageFileName)
+	{
+	std::string result=imageFileName;
+	result.append(".pyramid");
+	return result;
+	}
+
+void ImagePyramid::build(const char* imageFileName,const char* pyramidFileName,unsigned int tileSize)
+	{
+	if(tileSize<4||(tileSize&(tileSize-1))!=0)
+		Misc::throwStdErr("Images::ImagePyramid::build: Tile size %u is not a power of two of at least 4",tileSize);
+	
+	/* Open the source image without decoding its pixels: */
+	struct stat sourceStat;
+	if(stat(imageFileName,&sourceStat)!=0)
+		Misc::throwStdErr("Images::ImagePyramid::build: Unable to access image file %s",imageFileName);
+	Misc::SelfDestructPointer<ImageReader> reader(ImageReader::create(imageFileName));
+	const unsigned int* imageSize=reader->getImageSize();
+	
+	/* Calculate the pyramid's layout: */
+	std::vector<Level> levels;
+	calcPyramidLayout(imageSize,tileSize,levels);
+	
+	/* Decode the source image in strips of whole tile rows that fit into the strip size limit: */
+	unsigned int tileStride=tileSize-2;
+	size_t sourceRowSize=size_t(imageSize[0])*sizeof(RGBImage::Color);
+	unsigned int stripHeight=tileStride;
+	if(maxStripSize/sourceRowSize>size_t(tileStride))
+		stripHeight=(unsigned int)(maxStripSize/sourceRowSize/tileStride)*tileStride;
+	if(stripHeight>imageSize[1])
+		stripHeight=imageSize[1];
+	
+	/* Write the pyramid into a temporary file first so that concurrent readers never see a partial pyramid: */
+	std::string tempFileName=Misc::stringPrintf("%s.%d",pyramidFileName,int(getpid()));
+	RGBImage::Color* sourceStrip=new RGBImage::Color[size_t(stripHeight)*size_t(imageSize[0])];
+	std::vector<PyramidLevelWriter*> writers(levels.size(),0);
+	try
+		{
+		IO::SeekableFilePtr pyramid=IO::openSeekableFile(tempFileName.c_str(),IO::File::WriteOnly);
+		
+		/* Write the header and pad to the first tile: */
+		pyramid->writeRaw(pyramidMagic,sizeof(pyramidMagic));
+		pyramid->write<Misc::UInt32>(pyramidVersion);
+		pyramid->write<Misc::UInt32>(pyramidByteOrderMark);
+		pyramid->write<Misc::SInt64>(Misc::SInt64(sourceStat.st_size));
+		pyramid->write<Misc::SInt64>(Misc::SInt64(sourceStat.st_mtime));
+		for(int i=0;i<2;++i)
+			pyramid->write<Misc::UInt32>(imageSize[i]);
+		pyramid->write<Misc::UInt32>(tileSize);
+		pyramid->write<Misc::UInt32>(Misc::UInt32(levels.size()));
+		size_t headerSize=sizeof(pyramidMagic)+2*sizeof(Misc::UInt32)+2*sizeof(Misc::SInt64)+4*sizeof(Misc::UInt32);
+		for(std::vector<Level>::iterator lIt=levels.begin();lIt!=levels.end();++lIt)
+			{
+			for(int i=0;i<2;++i)
+				pyramid->write<Misc::UInt32>(lIt->size[i]);
+			pyramid->write<Misc::UInt64>(Misc::UInt64(lIt->offset));
+			headerSize+=2*sizeof(Misc::UInt32)+sizeof(Misc::UInt64);
+			}
+		for(;headerSize<levels[0].offset;++headerSize)
+			pyramid->write<Misc::UInt8>(0);
+		
+		/* Create a chain of level writers that downsample each level into the next coarser one as its rows arrive: */
+		for(size_t l=levels.size();l>0;--l)
+			writers[l-1]=new PyramidLevelWriter(*pyramid,levels[l-1],tileSize,l<levels.size()?writers[l]:0);
+		
+		/* Feed the source image to the full-resolution level strip by strip from top to bottom, in the order in which image files store their rows, so that readers can continue decoding where the previous strip ended: */
+		for(unsigned int y1=imageSize[1];y1>0;)
+			{
+			unsigned int size[2]={imageSize[0],y1<stripHeight?y1:stripHeight};
+			unsigned int offset[2]={0,y1-size[1]};
+			reader->readRegion(offset,size,sourceStrip,imageSize[0]);
+			for(unsigned int y=size[1];y>0;--y)
+				writers[0]->addRow(sourceStrip[size_t(y-1)*size_t(imageSize[0])].getRgba());
+			y1=offset[1];
+			}
+		
+		pyramid->flush();
+		pyramid=0;
+		}
+	catch(std::runtime_error err)
+		{
+		/* Remove the partial file and report the error: */
+		for(std::vector<PyramidLevelWriter*>::iterator wIt=writers.begin();wIt!=writers.end();++wIt)
+			delete *wIt;
+		delete[] sourceStrip;
+		unlink(tempFileName.c_str());
+		Misc::throwStdErr("Images::ImagePyramid::build: Unable to write image pyramid file %s due to exception %s",pyramidFileName,err.what());
+		}
+	for(std::vector<PyramidLevelWriter*>::iterator wIt=writers.begin();wIt!=writers.end();++wIt)
+		delete *wIt;
+	delete[] sourceStrip;
+	
+	/* Replace any previous pyramid file: */
+	if(rename(tempFileName.c_str(),pyramidFileName)!=0)
+		{
+		unlink(tempFileName.c_str());
+		Misc::throwStdErr("Images::ImagePyramid::build: Unable to create image pyramid file %s",pyramidFileName);
+		}
+	}
+
+ImagePyramid* ImagePyramid::open(const char* imageFileName,unsigned int tileSize)
+	{
+	struct stat sourceStat;
+	if(stat(imageFileName,&sourceStat)!=0)
+		Misc::throwStdErr("Images::ImagePyramid::open: Unable to access image file %s",imageFileName);
+	std::string pyramidFileName=getPyramidFileName(imageFileName);
+	
+	/* Try opening an existing pyramid file and check it against the image file: */
+	try
+		{
+		ImagePyramid* result=new ImagePyramid(pyramidFileName.c_str());
+		if(result->sourceFileSize==Misc::SInt64(sourceStat.st_size)&&result->sourceModTime==Misc::SInt64(sourceStat.st_mtime))
+			return result;
+		delete result;
+		}
+	catch(std::runtime_error err)
+		{
+		/* Pyramid file does not exist or is corrupted; fall through to rebuild it: */
+		}
+	
+	/* Build the pyramid file and open it: */
+	build(imageFileName,pyramidFileName.c_str(),tileSize);
+	return new ImagePyramid(pyramidFileName.c_str());
+	}
+
+bool ImagePyramid::isTileReady(const ImagePyramid::TileIndex& tileIndex)
+	{
+	Threads::MutexCond::Lock loaderLock(loaderCond);
+	return readyTiles.isEntry(tileIndex);
+	}
+
+void ImagePyramid::requestTiles(const void* client,const std::vector<ImagePyramid::TileIndex>& tileIndices)
+	{
+	Threads::MutexCond::Lock loaderLock(loaderCond);
+	
+	/* Find the client's request queue: */
+	std::vector<RequestQueue>::iterator rqIt;
+	for(rqIt=requestQueues.begin();rqIt!=requestQueues.end()&&rqIt->client!=client;++rqIt)
+		;
+	if(rqIt==requestQueues.end())
+		{
+		/* Create a new request queue for the client: */
+		requestQueues.push_back(RequestQueue());
+		rqIt=requestQueues.end()-1;
+		rqIt->client=client;
+		}
+	
+	/* Replace the client's request queue: */
+	rqIt->tiles.clear();
+	for(std::vector<TileIndex>::const_iterator tiIt=tileIndices.begin();tiIt!=tileIndices.end();++tiIt)
+		if(!readyTiles.isEntry(*tiIt))
+			rqIt->tiles.push_back(*tiIt);
+	
+	if(rqIt->tiles.empty())
+		{
+		/* Remove the empty request queue: */
+		*rqIt=requestQueues.back();
+		requestQueues.pop_back();
+		}
+	else
+		loaderCond.signal();
+	}
+
+void ImagePyramid::setMaxNumReadyTiles(size_t newMaxNumReadyTiles)
+	{
+	Threads::MutexCond::Lock loaderLock(loaderCond);
+	maxNumReadyTiles=newMaxNumReadyTiles>0?newMaxNumReadyTiles:1;
+	while(readyQueue.size()>maxNumReadyTiles)
+		{
+		readyTiles.removeEntry(readyQueue.front());
+		readyQueue.pop_front();
+		}
+	}
+
+}
@@ -0,0 +1,194 @@
+/***********************************************************************
+ImagePyramid - Class for tiled multi-resolution image pyramids stored in
+memory-mapped files, to display images too large to be held in memory
+or texture memory as a whole. Tiles are paged in by a background thread
+on request.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IMAGES_IMAGEPYRAMID_INCLUDED
+#define IMAGES_IMAGEPYRAMID_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <GL/gl.h>
+#include <Misc/SizedTypes.h>
+#include <Misc/Autopointer.h>
+#include <Misc/HashTable.h>
+#include <Misc/CallbackData.h>
+#include <Misc/CallbackList.h>
+#include <Threads/Thread.h>
+#include <Threads/MutexCond.h>
+
+/* Forward declarations: */
+namespace IO {
+class MemMappedFile;
+}
+
+namespace Images {
+
+class ImagePyramid
+	{
+	/* Embedded classes: */
+	public:
+	struct TileIndex // Structure identifying a tile by pyramid level and position
+		{
+		/* Elements: */
+		public:
+		unsigned int level; // Pyramid level; level 0 has the full image resolution
+		unsigned int tile[2]; // Tile column and row inside the level, starting at the lower-left corner
+		
+		/* Constructors and destructors: */
+		TileIndex(void)
+			{
+			}
+		TileIndex(unsigned int sLevel,unsigned int sTileX,unsigned int sTileY)
+			:level(sLevel)
+			{
+			tile[0]=sTileX;
+			tile[1]=sTileY;
+			}
+		
+		/* Methods: */
+		friend bool operator==(const TileIndex& ti1,const TileIndex& ti2)
+			{
+			return ti1.level==ti2.level&&ti1.tile[0]==ti2.tile[0]&&ti1.tile[1]==ti2.tile[1];
+			}
+		friend bool operator!=(const TileIndex& ti1,const TileIndex& ti2)
+			{
+			return ti1.level!=ti2.level||ti1.tile[0]!=ti2.tile[0]||ti1.tile[1]!=ti2.tile[1];
+			}
+		static size_t hash(const TileIndex& ti,size_t tableSize)
+			{
+			return ((size_t(ti.tile[1])*65537U+size_t(ti.tile[0]))*31U+size_t(ti.level))%tableSize;
+			}
+		};
+	
+	struct Level // Structure describing a single pyramid level
+		{
+		/* Elements: */
+		public:
+		unsigned int size[2]; // Level width and height in pixels
+		unsigned int numTiles[2]; // Number of tile columns and rows; tiles are placed tile stride pixels apart
+		size_t offset; // Offset of the level's first tile from the beginning of the pyramid file
+		};
+	
+	class TileLoadedCallbackData:public Misc::CallbackData // Callback data sent when a requested tile has been paged in
+		{
+		/* Elements: */
+		public:
+		ImagePyramid* pyramid; // The pyramid containing the tile
+		TileIndex tileIndex; // Index of the paged-in tile
+		
+		/* Constructors and destructors: */
+		TileLoadedCallbackData(ImagePyramid* sPyramid,const TileIndex& sTileIndex)
+			:pyramid(sPyramid),tileIndex(sTileIndex)
+			{
+			}
+		};
+	
+	private:
+	typedef Misc::HashTable<TileIndex,void,TileIndex> TileSet; // Type for sets of tiles
+	
+	struct RequestQueue // Structure for a client's queue of tiles to be paged in
+		{
+		/* Elements: */
+		public:
+		const void* client; // The client that requested the tiles
+		std::deque<TileIndex> tiles; // Requested tiles in order of priority
+		};
+	
+	/* Elements: */
+	Misc::Autopointer<IO::MemMappedFile> file; // The memory-mapped pyramid file
+	const GLubyte* fileMemory; // Base address of the file's memory map
+	Misc::SInt64 sourceFileSize; // Size of the source image file when the pyramid was built
+	Misc::SInt64 sourceModTime; // Modification time of the source image file when the pyramid was built
+	unsigned int imageSize[2]; // Width and height of the full-resolution image
+	unsigned int tileSize; // Width and height of all tiles in pixels, including a one-pixel border shared with neighboring tiles
+	size_t tileDataSize; // Size of a tile's RGB pixel data in bytes
+	std::vector<Level> levels; // List of pyramid levels, starting with the full-resolution level
+	Threads::MutexCond loaderCond; // Condition variable protecting the loader state and signaling new requests
+	std::vector<RequestQueue> requestQueues; // Per-client queues of tiles to be paged in
+	size_t nextRequestQueue; // Index of the request queue from which the loader thread takes the next tile
+	TileSet readyTiles; // Set of recently paged-in tiles
+	std::deque<TileIndex> readyQueue; // Recently paged-in tiles in order of loading, to bound the size of the ready set
+	size_t maxNumReadyTiles; // Maximum number of tiles kept in the ready set
+	bool shutdown; // Flag to tell the loader thread to exit
+	Misc::CallbackList tileLoadedCallbacks; // Callbacks called from the loader thread when a requested tile has been paged in
+	Threads::Thread loaderThread; // Background thread paging in requested tiles
+	
+	/* Private methods: */
+	void* loaderThreadMethod(void); // Method run by the loader thread
+	
+	/* Constructors and destructors: */
+	public:
+	ImagePyramid(const char* pyramidFileName); // Opens an existing pyramid file; throws exception if the file is not a valid pyramid file
+	private:
+	ImagePyramid(const ImagePyramid& source); // Prohibit copy constructor
+	ImagePyramid& operator=(const ImagePyramid& source); // Prohibit assignment operator
+	public:
+	~ImagePyramid(void); // Stops the loader thread and unmaps the pyramid file
+	
+	/* Methods: */
+	static std::string getPyramidFileName(const char* imageFileName); // Returns the name of the pyramid file belonging to the given image file
+	static void build(const char* imageFileName,const char* pyramidFileName,unsigned int tileSize =256); // Builds a pyramid file from an image file in any format supported by ImageReader, decoding the image in strips in file order and downsampling all levels incrementally; tile size must be a power of two of at least 4
+	static ImagePyramid* open(const char* imageFileName,unsigned int tileSize =256); // Opens the pyramid file belonging to the given image file, and (re-)builds it first if it does not exist or does not match the image file
+	const unsigned int* getImageSize(void) const // Returns the size of the full-resolution image
+		{
+		return imageSize;
+		}
+	unsigned int getImageSize(int dimension) const // Ditto
+		{
+		return imageSize[dimension];
+		}
+	unsigned int getTileSize(void) const // Returns the width and height of all tiles in pixels, including their one-pixel borders
+		{
+		return tileSize;
+		}
+	unsigned int getTileStride(void) const // Returns the distance between the origins of adjacent tiles in pixels, i.e., the width and height of a tile's interior
+		{
+		return tileSize-2;
+		}
+	unsigned int getNumLevels(void) const // Returns the number of pyramid levels
+		{
+		return (unsigned int)levels.size();
+		}
+	const Level& getLevel(unsigned int levelIndex) const // Returns the given pyramid level
+		{
+		return levels[levelIndex];
+		}
+	const GLubyte* getTile(const TileIndex& tileIndex) const // Returns the given tile's RGB pixels in row-major order; tile pixel (i, j) is level pixel (tile[0]*stride+i-1, tile[1]*stride+j-1), and pixels beyond the level's edge replicate the edge; access may block on disk I/O unless the tile is ready
+		{
+		const Level& l=levels[tileIndex.level];
+		return fileMemory+l.offset+(size_t(tileIndex.tile[1])*size_t(l.numTiles[0])+size_t(tileIndex.tile[0]))*tileDataSize;
+		}
+	bool isTileReady(const TileIndex& tileIndex); // Returns true if the given tile has recently been paged in by the loader thread
+	void requestTiles(const void* client,const std::vector<TileIndex>& tileIndices); // Replaces the given client's request queue with the given tiles in order of priority; tiles that are already ready are ignored; the loader thread serves all clients' queues in turn
+	void setMaxNumReadyTiles(size_t newMaxNumReadyTiles); // Sets the maximum number of paged-in tiles that are reported as ready
+	Misc::CallbackList& getTileLoadedCallbacks(void) // Returns the list of callbacks called from the loader thread when a requested tile has been paged in
+		{
+		return tileLoadedCallbacks;
+		}
+	};
+
+}
+
+#endif
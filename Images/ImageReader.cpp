@@ -0,0 +1,166 @@
+/***********************************************************************
+ImageReader - Abstract base class for image file readers that determine
+image sizes without decoding pixels, and decode rectangular regions of
+images, optionally at reduced resolution, into caller-provided buffers.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Images/ImageReader.h>
+
+#include <Images/Config.h>
+
+#include <ctype.h>
+#include <string.h>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/Timer.h>
+#include <Misc/FileNameExtensions.h>
+#include <IO/SeekableFile.h>
+#include <IO/OpenFile.h>
+#include <Images/ReadPNMImage.h>
+#include <Images/ReadPNGImage.h>
+#include <Images/ReadJPEGImage.h>
+#include <Images/ReadTIFFImage.h>
+
+namespace Images {
+
+/****************************
+Methods of class ImageReader:
+****************************/
+
+IO::File& ImageReader::rewind(void)
+	{
+	/* Seek back to the beginning if the file is seekable; otherwise, open it again: */
+	IO::SeekableFilePtr seekableFile=file;
+	if(seekableFile!=0)
+		seekableFile->setReadPosAbs(0);
+	else
+		file=IO::openFile(imageFileName.c_str());
+	
+	return *file;
+	}
+
+ImageReader::ImageReader(const char* sImageFileName,IO::FilePtr sFile)
+	:imageFileName(sImageFileName),file(sFile),
+	 scaleShift(0)
+	{
+	imageSize[0]=imageSize[1]=0;
+	}
+
+ImageReader::~ImageReader(void)
+	{
+	}
+
+ImageReader* ImageReader::create(const char* imageFileName,IO::FilePtr file)
+	{
+	/* Try to determine image file format from file name extension: */
+	const char* ext=Misc::getExtension(imageFileName);
+	int extLen=strlen(ext);
+	if(strcasecmp(ext,".gz")==0)
+		{
+		/* Strip the gzip extension and try again: */
+		const char* gzExt=ext;
+		ext=Misc::getExtension(imageFileName,gzExt);
+		extLen=gzExt-ext;
+		}
+	
+	if(extLen==4
+	   &&ext[0]=='.'
+	   &&tolower(ext[1])=='p'
+	   &&(tolower(ext[2])=='b'
+	      ||tolower(ext[2])=='g'
+	      ||tolower(ext[2])=='n'
+	      ||tolower(ext[2])=='p')
+	   &&tolower(ext[3])=='m') // It's a Portable AnyMap image
+		return new PNMImageReader(imageFileName,file);
+	#if IMAGES_CONFIG_HAVE_PNG
+	else if(strncasecmp(ext,".png",extLen)==0) // It's a PNG image
+		return new PNGImageReader(imageFileName,file);
+	#endif
+	#if IMAGES_CONFIG_HAVE_JPEG
+	else if(strncasecmp(ext,".jpg",extLen)==0||strncasecmp(ext,".jpeg",extLen)==0) // It's a JPEG image
+		return new JPEGImageReader(imageFileName,file);
+	#endif
+	#if IMAGES_CONFIG_HAVE_TIFF
+	else if(strncasecmp(ext,".tif",extLen)==0||strncasecmp(ext,".tiff",extLen)==0) // It's a TIFF image
+		return new TIFFImageReader(imageFileName,file);
+	#endif
+	else
+		Misc::throwStdErr("Images::ImageReader::create: Unknown extension in image file name \"%s\"",imageFileName);
+	
+	/* Never reached; just to make compiler happy: */
+	return 0;
+	}
+
+ImageReader* ImageReader::create(const char* imageFileName)
+	{
+	/* Open the image file: */
+	IO::FilePtr file(IO::openFile(imageFileName));
+	
+	/* Call the general function: */
+	return create(imageFileName,file);
+	}
+
+unsigned int ImageReader::getMaxScaleShift(void) const
+	{
+	/* Default readers only decode at full resolution: */
+	return 0;
+	}
+
+void ImageReader::setScaleShift(unsigned int newScaleShift)
+	{
+	if(newScaleShift>getMaxScaleShift())
+		Misc::throwStdErr("Images::ImageReader::setScaleShift: Downscaling factor %u not supported for image \"%s\"",1U<<newScaleShift,imageFileName.c_str());
+	scaleShift=newScaleShift;
+	}
+
+void ImageReader::readRegion(const unsigned int offset[2],const unsigned int size[2],RGBImage::Color* pixels,size_t rowStride)
+	{
+	/* Check the region against the downscaled image: */
+	for(int i=0;i<2;++i)
+		if(offset[i]>getSize(i)||size[i]>getSize(i)-offset[i])
+			Misc::throwStdErr("Images::ImageReader::readRegion: Region exceeds bounds of image \"%s\"",imageFileName.c_str());
+	if(size[0]==0||size[1]==0)
+		return;
+	
+	/* Decode the region and update the performance statistics: */
+	Misc::Timer timer;
+	decodeRegion(offset,size,pixels,rowStride!=0?rowStride:size_t(size[0]));
+	timer.elapse();
+	++statistics.numRegions;
+	statistics.numPixels+=size_t(size[0])*size_t(size[1]);
+	statistics.decodeTime+=timer.getTime();
+	}
+
+RGBImage ImageReader::readRegion(const unsigned int offset[2],const unsigned int size[2])
+	{
+	RGBImage result(size[0],size[1]);
+	readRegion(offset,size,result.modifyPixels(),size[0]);
+	return result;
+	}
+
+RGBImage ImageReader::readImage(void)
+	{
+	unsigned int offset[2]={0,0};
+	unsigned int size[2];
+	for(int i=0;i<2;++i)
+		size[i]=getSize(i);
+	return readRegion(offset,size);
+	}
+
+}
@@ -0,0 +1,112 @@
+/***********************************************************************
+ImageReader - Abstract base class for image file readers that determine
+image sizes without decoding pixels, and decode rectangular regions of
+images, optionally at reduced resolution, into caller-provided buffers.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IMAGES_IMAGEREADER_INCLUDED
+#define IMAGES_IMAGEREADER_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <IO/File.h>
+#include <Images/RGBImage.h>
+
+namespace Images {
+
+class ImageReader
+	{
+	/* Embedded classes: */
+	public:
+	struct Statistics // Structure to report decoding performance
+		{
+		/* Elements: */
+		public:
+		size_t numRegions; // Number of regions decoded so far
+		size_t numPixels; // Total number of pixels delivered in all decoded regions
+		double decodeTime; // Total time spent decoding regions in seconds
+		
+		/* Constructors and destructors: */
+		Statistics(void)
+			:numRegions(0),numPixels(0),decodeTime(0.0)
+			{
+			}
+		
+		/* Methods: */
+		double getThroughput(void) const // Returns the average number of delivered pixels per second
+			{
+			return decodeTime>0.0?double(numPixels)/decodeTime:0.0;
+			}
+		};
+	
+	/* Elements: */
+	protected:
+	std::string imageFileName; // Name of the image file
+	IO::FilePtr file; // The image file
+	unsigned int imageSize[2]; // Width and height of the full-resolution image
+	unsigned int scaleShift; // Binary logarithm of the downscaling factor applied while decoding
+	Statistics statistics; // Decoding performance statistics
+	
+	/* Protected methods: */
+	IO::File& rewind(void); // Resets the image file's read position to the beginning, re-opening the file if it is not seekable; returns the file
+	virtual void decodeRegion(const unsigned int offset[2],const unsigned int size[2],RGBImage::Color* pixels,size_t rowStride) =0; // Decodes a region of the downscaled image into the given buffer; the region is guaranteed to be non-empty and inside the downscaled image
+	
+	/* Constructors and destructors: */
+	public:
+	ImageReader(const char* sImageFileName,IO::FilePtr sFile); // Creates a reader for the given already-open image file; derived class constructors must read the image's size
+	private:
+	ImageReader(const ImageReader& source); // Prohibit copy constructor
+	ImageReader& operator=(const ImageReader& source); // Prohibit assignment operator
+	public:
+	virtual ~ImageReader(void);
+	
+	/* Methods: */
+	static ImageReader* create(const char* imageFileName,IO::FilePtr file); // Returns a reader for the given already-open image file; auto-detects file format
+	static ImageReader* create(const char* imageFileName); // Ditto, but opens the given file itself
+	const unsigned int* getImageSize(void) const // Returns the size of the full-resolution image
+		{
+		return imageSize;
+		}
+	unsigned int getImageSize(int dimension) const // Ditto
+		{
+		return imageSize[dimension];
+		}
+	virtual unsigned int getMaxScaleShift(void) const; // Returns the binary logarithm of the largest downscaling factor supported by the file format
+	unsigned int getScaleShift(void) const // Returns the binary logarithm of the current downscaling factor
+		{
+		return scaleShift;
+		}
+	void setScaleShift(unsigned int newScaleShift); // Sets the binary logarithm of the downscaling factor for subsequent reads; throws exception if the factor is not supported
+	unsigned int getSize(int dimension) const // Returns the width or height of the image at the current downscaling factor
+		{
+		return (imageSize[dimension]+(1U<<scaleShift)-1U)>>scaleShift;
+		}
+	void readRegion(const unsigned int offset[2],const unsigned int size[2],RGBImage::Color* pixels,size_t rowStride =0); // Decodes the region of the downscaled image with the given lower-left corner and size into the given buffer, starting with the region's bottom row; rows are rowStride pixels apart, or size[0] pixels if rowStride is zero
+	RGBImage readRegion(const unsigned int offset[2],const unsigned int size[2]); // Ditto, but returns a new image
+	RGBImage readImage(void); // Decodes the entire downscaled image
+	const Statistics& getStatistics(void) const // Returns the reader's decoding performance statistics
+		{
+		return statistics;
+		}
+	};
+
+}
+
+#endif
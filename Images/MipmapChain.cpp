@@ -0,0 +1,340 @@
+/***********************************************************************
+MipmapChain - Class to build and store complete mipmap chains for RGBA
+texture images, optionally compressed into S3TC DXT1 or DXT5 blocks and
+cached in files next to their source images.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Images/MipmapChain.h>
+
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
+#include <Misc/StringPrintf.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Images/Resampler.h>
+#include <Images/DXTEncoder.h>
+
+namespace Images {
+
+namespace {
+
+/*************************************
+Helper objects for mipmap cache files:
+*************************************/
+
+const char cacheMagic[16]="VruiMipmaps"; // Identifier at the beginning of mipmap cache files
+const Misc::UInt32 cacheVersion=1; // Version number of the mipmap cache file format
+const Misc::UInt32 cacheByteOrderMark=0x01020304U; // Marker to reject cache files written on machines with different endianness
+
+/******************************************
+Helper class for sRGB to linear conversion:
+******************************************/
+
+class ColorConverter
+	{
+	/* Elements: */
+	private:
+	bool gammaCorrect; // Flag whether color channels are converted between sRGB and linear space
+	float toLinear[256]; // Table mapping 8-bit color components to linear intensities
+	static const int numToSRGBEntries=4096; // Number of entries in the inverse conversion table
+	GLubyte toSRGB[numToSRGBEntries+1]; // Table mapping quantized linear intensities to 8-bit color components
+	
+	/* Constructors and destructors: */
+	public:
+	ColorConverter(bool sGammaCorrect)
+		:gammaCorrect(sGammaCorrect)
+		{
+		for(int i=0;i<256;++i)
+			{
+			float c=float(i)/255.0f;
+			if(gammaCorrect)
+				toLinear[i]=c<=0.04045f?c/12.92f:powf((c+0.055f)/1.055f,2.4f);
+			else
+				toLinear[i]=c;
+			}
+		for(int i=0;i<=numToSRGBEntries;++i)
+			{
+			float c=float(i)/float(numToSRGBEntries);
+			if(gammaCorrect)
+				c=c<=0.0031308f?c*12.92f:1.055f*powf(c,1.0f/2.4f)-0.055f;
+			toSRGB[i]=GLubyte(c*255.0f+0.5f);
+			}
+		}
+	
+	/* Methods: */
+	void convertToLinear(const RGBAImage::Color* pixels,size_t numPixels,float* result) const // Converts 8-bit pixels to linear floating-point pixels
+		{
+		for(size_t p=0;p<numPixels;++p,result+=4)
+			{
+			for(int i=0;i<3;++i)
+				result[i]=toLinear[pixels[p][i]];
+			result[3]=float(pixels[p][3])/255.0f;
+			}
+		}
+	void convertFromLinear(const float* pixels,size_t numPixels,RGBAImage::Color* result) const // Converts linear floating-point pixels to 8-bit pixels, clamping filter overshoot
+		{
+		for(size_t p=0;p<numPixels;++p,pixels+=4)
+			{
+			for(int i=0;i<3;++i)
+				{
+				float c=pixels[i];
+				int index=c<=0.0f?0:(c>=1.0f?numToSRGBEntries:int(c*float(numToSRGBEntries)+0.5f));
+				result[p][i]=toSRGB[index];
+				}
+			float a=pixels[3];
+			result[p][3]=a<=0.0f?GLubyte(0):(a>=1.0f?GLubyte(255):GLubyte(a*255.0f+0.5f));
+			}
+		}
+	};
+
+}
+
+/****************************
+Methods of class MipmapChain:
+****************************/
+
+void MipmapChain::clear(void)
+	{
+	for(std::vector<Level>::iterator lIt=levels.begin();lIt!=levels.end();++lIt)
+		delete[] lIt->data;
+	levels.clear();
+	}
+
+MipmapChain::MipmapChain(void)
+	:format(RGBA8)
+	{
+	}
+
+MipmapChain::MipmapChain(const RGBAImage& image,MipmapChain::Filter filter,bool gammaCorrect)
+	:format(RGBA8)
+	{
+	ColorConverter converter(gammaCorrect);
+	Resampler resampler(filter==LANCZOS?Resampler::LANCZOS3:Resampler::BOX);
+	
+	/* Copy the base level: */
+	Level base;
+	for(int i=0;i<2;++i)
+		base.size[i]=image.getSize(i);
+	size_t numPixels=size_t(base.size[0])*size_t(base.size[1]);
+	base.dataSize=numPixels*sizeof(RGBAImage::Color);
+	base.data=new unsigned char[base.dataSize];
+	memcpy(base.data,image.getPixels(),base.dataSize);
+	levels.push_back(base);
+	
+	/* Convert the base level to linear space: */
+	float* source=new float[numPixels*4];
+	converter.convertToLinear(image.getPixels(),numPixels,source);
+	
+	/* Create all smaller levels from their respective predecessors to avoid accumulating quantization errors: */
+	while(levels.back().size[0]>1||levels.back().size[1]>1)
+		{
+		const Level& prev=levels.back();
+		Level level;
+		for(int i=0;i<2;++i)
+			level.size[i]=prev.size[i]>1?prev.size[i]/2:1;
+		numPixels=size_t(level.size[0])*size_t(level.size[1]);
+		
+		/* Downsample the previous level: */
+		float* dest=new float[numPixels*4];
+		resampler.resample(4,prev.size,source,level.size,dest);
+		delete[] source;
+		source=dest;
+		
+		/* Convert the level back to 8-bit pixels: */
+		level.dataSize=numPixels*sizeof(RGBAImage::Color);
+		level.data=new unsigned char[level.dataSize];
+		converter.convertFromLinear(source,numPixels,reinterpret_cast<RGBAImage::Color*>(level.data));
+		levels.push_back(level);
+		}
+	delete[] source;
+	}
+
+MipmapChain::~MipmapChain(void)
+	{
+	clear();
+	}
+
+std::string MipmapChain::getCacheFileName(const char* imageFileName)
+	{
+	std::string result=imageFileName;
+	result.append(".mipmaps");
+	return result;
+	}
+
+bool MipmapChain::readCacheFile(const char* imageFileName,MipmapChain::Filter filter,bool gammaCorrect)
+	{
+	/* Only cache regular files: */
+	struct stat sourceStat;
+	if(stat(imageFileName,&sourceStat)!=0||!S_ISREG(sourceStat.st_mode))
+		return false;
+	
+	std::vector<Level> newLevels;
+	Format newFormat=RGBA8;
+	try
+		{
+		/* Open the cache file and check its header against the image file's size and modification time: */
+		IO::FilePtr cache=IO::openFile(getCacheFileName(imageFileName).c_str());
+		char magic[sizeof(cacheMagic)];
+		cache->readRaw(magic,sizeof(magic));
+		bool valid=memcmp(magic,cacheMagic,sizeof(cacheMagic))==0;
+		valid=valid&&cache->read<Misc::UInt32>()==cacheVersion;
+		valid=valid&&cache->read<Misc::UInt32>()==cacheByteOrderMark;
+		valid=valid&&cache->read<Misc::SInt64>()==Misc::SInt64(sourceStat.st_size);
+		valid=valid&&cache->read<Misc::SInt64>()==Misc::SInt64(sourceStat.st_mtime);
+		valid=valid&&cache->read<Misc::UInt32>()==Misc::UInt32(filter);
+		valid=valid&&cache->read<Misc::UInt32>()==(gammaCorrect?1U:0U);
+		if(!valid)
+			return false;
+		
+		/* Read all levels: */
+		newFormat=Format(cache->read<Misc::UInt32>());
+		unsigned int numLevels=cache->read<Misc::UInt32>();
+		for(unsigned int l=0;l<numLevels;++l)
+			{
+			Level level;
+			for(int i=0;i<2;++i)
+				level.size[i]=cache->read<Misc::UInt32>();
+			level.dataSize=size_t(cache->read<Misc::UInt64>());
+			level.data=new unsigned char[level.dataSize];
+			newLevels.push_back(level);
+			cache->readRaw(level.data,level.dataSize);
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		/* Cache file does not exist or is truncated: */
+		for(std::vector<Level>::iterator lIt=newLevels.begin();lIt!=newLevels.end();++lIt)
+			delete[] lIt->data;
+		return false;
+		}
+	
+	/* Replace the current levels: */
+	clear();
+	format=newFormat;
+	levels=newLevels;
+	return true;
+	}
+
+void MipmapChain::writeCacheFile(const char* imageFileName,MipmapChain::Filter filter,bool gammaCorrect) const
+	{
+	struct stat sourceStat;
+	if(stat(imageFileName,&sourceStat)!=0||!S_ISREG(sourceStat.st_mode))
+		return;
+	
+	/* Write the cache into a temporary file first so that concurrent readers never see a partial cache: */
+	std::string cacheFileName=getCacheFileName(imageFileName);
+	std::string tempFileName=Misc::stringPrintf("%s.%d",cacheFileName.c_str(),int(getpid()));
+	try
+		{
+		IO::FilePtr cache=IO::openFile(tempFileName.c_str(),IO::File::WriteOnly);
+		cache->writeRaw(cacheMagic,sizeof(cacheMagic));
+		cache->write<Misc::UInt32>(cacheVersion);
+		cache->write<Misc::UInt32>(cacheByteOrderMark);
+		cache->write<Misc::SInt64>(Misc::SInt64(sourceStat.st_size));
+		cache->write<Misc::SInt64>(Misc::SInt64(sourceStat.st_mtime));
+		cache->write<Misc::UInt32>(Misc::UInt32(filter));
+		cache->write<Misc::UInt32>(gammaCorrect?1U:0U);
+		cache->write<Misc::UInt32>(Misc::UInt32(format));
+		cache->write<Misc::UInt32>(Misc::UInt32(levels.size()));
+		for(std::vector<Level>::const_iterator lIt=levels.begin();lIt!=levels.end();++lIt)
+			{
+			for(int i=0;i<2;++i)
+				cache->write<Misc::UInt32>(lIt->size[i]);
+			cache->write<Misc::UInt64>(Misc::UInt64(lIt->dataSize));
+			cache->writeRaw(lIt->data,lIt->dataSize);
+			}
+		cache->flush();
+		cache=0;
+		if(rename(tempFileName.c_str(),cacheFileName.c_str())!=0)
+			unlink(tempFileName.c_str());
+		}
+	catch(std::runtime_error err)
+		{
+		/* Caching is optional; ignore the error and remove any partial file: */
+		unlink(tempFileName.c_str());
+		}
+	}
+
+size_t MipmapChain::getDataSize(void) const
+	{
+	size_t result=0;
+	for(std::vector<Level>::const_iterator lIt=levels.begin();lIt!=levels.end();++lIt)
+		result+=lIt->dataSize;
+	return result;
+	}
+
+void MipmapChain::compress(void)
+	{
+	if(format!=RGBA8||levels.empty())
+		return;
+	
+	/* Check if the base level is fully opaque: */
+	const RGBAImage::Color* basePixels=reinterpret_cast<const RGBAImage::Color*>(levels[0].data);
+	size_t numBasePixels=size_t(levels[0].size[0])*size_t(levels[0].size[1]);
+	bool opaque=true;
+	for(size_t p=0;p<numBasePixels&&opaque;++p)
+		opaque=basePixels[p][3]==GLubyte(255);
+	format=opaque?DXT1:DXT5;
+	
+	/* Compress all levels: */
+	for(std::vector<Level>::iterator lIt=levels.begin();lIt!=levels.end();++lIt)
+		{
+		size_t compressedSize=getDXTSize(lIt->size[0],lIt->size[1],!opaque);
+		unsigned char* compressed=new unsigned char[compressedSize];
+		encodeDXT(lIt->size[0],lIt->size[1],reinterpret_cast<const RGBAImage::Color*>(lIt->data),!opaque,compressed);
+		delete[] lIt->data;
+		lIt->data=compressed;
+		lIt->dataSize=compressedSize;
+		}
+	}
+
+void MipmapChain::glTexImage2D(GLenum target,GLint internalFormat) const
+	{
+	/* Set up pixel processing pipeline: */
+	glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS,0);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH,0);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS,0);
+	
+	/* Upload all levels: */
+	std::vector<RGBAImage::Color> pixels;
+	for(unsigned int l=0;l<levels.size();++l)
+		{
+		const unsigned char* data=levels[l].data;
+		if(format!=RGBA8)
+			{
+			/* Decompress the level for OpenGL contexts that do not support S3TC textures: */
+			pixels.resize(size_t(levels[l].size[0])*size_t(levels[l].size[1]));
+			decodeDXT(levels[l].size[0],levels[l].size[1],levels[l].data,format==DXT5,&pixels[0]);
+			data=reinterpret_cast<const unsigned char*>(&pixels[0]);
+			}
+		::glTexImage2D(target,l,internalFormat,levels[l].size[0],levels[l].size[1],0,GL_RGBA,GL_UNSIGNED_BYTE,data);
+		}
+	glTexParameteri(target,GL_TEXTURE_BASE_LEVEL,0);
+	glTexParameteri(target,GL_TEXTURE_MAX_LEVEL,GLint(levels.size())-1);
+	}
+
+}
@@ -0,0 +1,110 @@
+/***********************************************************************
+MipmapChain - Class to build and store complete mipmap chains for RGBA
+texture images, optionally compressed into S3TC DXT1 or DXT5 blocks and
+cached in files next to their source images.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IMAGES_MIPMAPCHAIN_INCLUDED
+#define IMAGES_MIPMAPCHAIN_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <GL/gl.h>
+#include <Images/RGBAImage.h>
+
+namespace Images {
+
+class MipmapChain
+	{
+	/* Embedded classes: */
+	public:
+	enum Filter // Enumerated type for downsampling filters
+		{
+		BOX, // Area-weighted average of covered pixels; fast, but leaves some aliasing
+		LANCZOS // Three-lobed Lanczos-windowed sinc; sharper and with less aliasing, but slower
+		};
+	
+	enum Format // Enumerated type for storage formats of mipmap levels
+		{
+		RGBA8, // Uncompressed pixels with 8-bit components
+		DXT1, // Opaque S3TC DXT1 blocks, 8 bytes per 4x4 pixels
+		DXT5 // S3TC DXT5 blocks with interpolated alpha, 16 bytes per 4x4 pixels
+		};
+	
+	struct Level // Structure describing a single mipmap level
+		{
+		/* Elements: */
+		public:
+		unsigned int size[2]; // Level width and height in pixels
+		size_t dataSize; // Size of the level's pixel or block data in bytes
+		unsigned char* data; // The level's pixel or block data
+		};
+	
+	/* Elements: */
+	private:
+	Format format; // Storage format of all levels
+	std::vector<Level> levels; // List of mipmap levels, starting with the base level
+	
+	/* Private methods: */
+	void clear(void); // Destroys all levels
+	
+	/* Constructors and destructors: */
+	public:
+	MipmapChain(void); // Creates an empty mipmap chain
+	MipmapChain(const RGBAImage& image,Filter filter,bool gammaCorrect); // Builds an uncompressed mipmap chain down to 1x1 pixels from the given base image; filters color channels in linear space if gammaCorrect is true, treating pixels as sRGB
+	private:
+	MipmapChain(const MipmapChain& source); // Prohibit copy constructor
+	MipmapChain& operator=(const MipmapChain& source); // Prohibit assignment operator
+	public:
+	~MipmapChain(void);
+	
+	/* Methods: */
+	static std::string getCacheFileName(const char* imageFileName); // Returns the name of the cache file for the given image file
+	bool readCacheFile(const char* imageFileName,Filter filter,bool gammaCorrect); // Replaces the chain with one read from the given image file's cache file; returns false if there is no cache file or it does not match the image file or the given settings
+	void writeCacheFile(const char* imageFileName,Filter filter,bool gammaCorrect) const; // Writes the chain to the given image file's cache file; silently ignores write errors
+	bool isValid(void) const // Returns true if the chain contains at least one level
+		{
+		return !levels.empty();
+		}
+	Format getFormat(void) const // Returns the storage format of all levels
+		{
+		return format;
+		}
+	bool isCompressed(void) const // Returns true if the levels are stored as DXT blocks
+		{
+		return format!=RGBA8;
+		}
+	unsigned int getNumLevels(void) const // Returns the number of levels in the chain
+		{
+		return (unsigned int)levels.size();
+		}
+	const Level& getLevel(unsigned int levelIndex) const // Returns the given mipmap level
+		{
+		return levels[levelIndex];
+		}
+	size_t getDataSize(void) const; // Returns the total size of all levels' data in bytes
+	void compress(void); // Compresses all levels into DXT1 blocks if all pixels are opaque, and DXT5 blocks otherwise; does nothing if the chain is already compressed
+	void glTexImage2D(GLenum target,GLint internalFormat) const; // Uploads all levels into the currently bound texture object as uncompressed pixels, decompressing DXT levels on the fly, and sets its base and maximum levels
+	};
+
+}
+
+#endif
@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #if IMAGES_CONFIG_HAVE_JPEG
 
 #include <stdio.h>
+#include <string.h>
 #include <jpeglib.h>
 #include <stdexcept>
 #include <Misc/ThrowStdErr.h>
@@ -186,6 +187,190 @@ RGBImage readJPEGImage(const char* imageName,IO::File& source)
 	return result;
 	}
 
+/***************************************************
+Declaration of struct JPEGImageReader::DecoderState:
+***************************************************/
+
+struct JPEGImageReader::DecoderState
+	{
+	/* Elements: */
+	public:
+	JPEGExceptionErrorManager errorManager; // Error manager throwing exceptions
+	JPEGFileSourceManager sourceManager; // Source manager reading from the image file
+	jpeg_decompress_struct decompressStruct; // JPEG library decompression object
+	unsigned int scaleShift; // Binary logarithm of the downscaling factor with which the image is decoded
+	JDIMENSION cropX,cropWidth; // Range of decoded output columns
+	JSAMPLE* rowBuffer; // Buffer for a decoded row
+	
+	/* Constructors and destructors: */
+	DecoderState(IO::File& source)
+		:sourceManager(source),
+		 scaleShift(0),cropX(0),cropWidth(0),rowBuffer(0)
+		{
+		/* Create a JPEG decompression object and associate it with the source stream: */
+		decompressStruct.err=&errorManager;
+		decompressStruct.client_data=0;
+		jpeg_create_decompress(&decompressStruct);
+		decompressStruct.src=&sourceManager;
+		}
+	~DecoderState(void)
+		{
+		delete[] rowBuffer;
+		jpeg_destroy_decompress(&decompressStruct);
+		}
+	};
+
+/********************************
+Methods of class JPEGImageReader:
+********************************/
+
+void JPEGImageReader::decodeRegion(const unsigned int offset[2],const unsigned int size[2],RGBImage::Color* pixels,size_t rowStride)
+	{
+	/* Calculate the range of output rows covered by the region; JPEG files store rows from top to bottom: */
+	JDIMENSION firstRow=getSize(1)-(offset[1]+size[1]);
+	
+	#ifdef LIBJPEG_TURBO_VERSION_NUMBER
+	
+	/* Only decode the image blocks overlapping the region's columns, plus a one-pixel margin as upsampling at the cropped edges differs from full decoding: */
+	JDIMENSION cropX=offset[0]>0?offset[0]-1:0;
+	JDIMENSION cropEnd=offset[0]+size[0]<getSize(0)?offset[0]+size[0]+1:getSize(0);
+	JDIMENSION cropWidth=cropEnd-cropX;
+	
+	#else
+	
+	/* Decode entire rows: */
+	JDIMENSION cropX=0;
+	JDIMENSION cropWidth=getSize(0);
+	
+	#endif
+	
+	/* Start over unless the region begins at or below the next row of the current decoder, and uses its downscaling factor and decoded columns: */
+	if(decoder!=0&&(decoder->scaleShift!=scaleShift||decoder->decompressStruct.output_scanline>firstRow||cropX<decoder->cropX||cropX+cropWidth>decoder->cropX+decoder->cropWidth))
+		{
+		delete decoder;
+		decoder=0;
+		}
+	
+	try
+		{
+		if(decoder==0)
+			{
+			/* Start reading the image file from the beginning: */
+			decoder=new DecoderState(rewind());
+			jpeg_decompress_struct& jds=decoder->decompressStruct;
+			
+			/* Read the JPEG file header: */
+			jpeg_read_header(&jds,true);
+			
+			/* Request RGB output downscaled in the DCT domain: */
+			jds.out_color_space=JCS_RGB;
+			jds.scale_num=1;
+			jds.scale_denom=1U<<scaleShift;
+			
+			/* Prepare for decompression: */
+			jpeg_start_decompress(&jds);
+			if(jds.output_width!=getSize(0)||jds.output_height!=getSize(1)||jds.output_components!=3)
+				throw std::runtime_error("Unexpected output image layout");
+			
+			#ifdef LIBJPEG_TURBO_VERSION_NUMBER
+			
+			/* Crop the decoded rows; the JPEG library widens the crop to whole image blocks: */
+			jpeg_crop_scanline(&jds,&cropX,&cropWidth);
+			
+			#endif
+			
+			/* Allocate a row buffer: */
+			decoder->scaleShift=scaleShift;
+			decoder->cropX=cropX;
+			decoder->cropWidth=cropWidth;
+			decoder->rowBuffer=new JSAMPLE[size_t(cropWidth)*3];
+			}
+		jpeg_decompress_struct& jds=decoder->decompressStruct;
+		
+		#ifdef LIBJPEG_TURBO_VERSION_NUMBER
+		
+		/* Skip the rows above the region without decoding them: */
+		while(jds.output_scanline<firstRow)
+			jpeg_skip_scanlines(&jds,firstRow-jds.output_scanline);
+		
+		#else
+		
+		/* Decode and discard the rows above the region: */
+		while(jds.output_scanline<firstRow)
+			if(jpeg_read_scanlines(&jds,&decoder->rowBuffer,1)!=1)
+				throw std::runtime_error("Premature end of image data");
+		
+		#endif
+		
+		/* Read the region's rows: */
+		size_t regionRowOffset=size_t(offset[0]-decoder->cropX)*3;
+		size_t regionRowSize=size_t(size[0])*3;
+		for(unsigned int y=size[1];y>0;--y)
+			{
+			if(jpeg_read_scanlines(&jds,&decoder->rowBuffer,1)!=1)
+				throw std::runtime_error("Premature end of image data");
+			memcpy(pixels+size_t(y-1)*rowStride,decoder->rowBuffer+regionRowOffset,regionRowSize);
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		/* Clean up: */
+		delete decoder;
+		decoder=0;
+		
+		/* Wrap and re-throw the exception: */
+		Misc::throwStdErr("Images::JPEGImageReader::decodeRegion: Caught exception \"%s\" while reading image \"%s\"",err.what(),imageFileName.c_str());
+		}
+	
+	/* Keep the decoder state to continue with the next region; the rows below the region are not decoded yet: */
+	}
+
+JPEGImageReader::JPEGImageReader(const char* sImageFileName,IO::FilePtr sFile)
+	:ImageReader(sImageFileName,sFile),
+	 decoder(0)
+	{
+	/* Create a JPEG error handler and a JPEG decompression object: */
+	JPEGExceptionErrorManager jpegErrorManager;
+	jpeg_decompress_struct jpegDecompressStruct;
+	jpegDecompressStruct.err=&jpegErrorManager;
+	jpegDecompressStruct.client_data=0;
+	jpeg_create_decompress(&jpegDecompressStruct);
+	
+	/* Associate the decompression object with the image file: */
+	JPEGFileSourceManager jpegSourceManager(*file);
+	jpegDecompressStruct.src=&jpegSourceManager;
+	
+	try
+		{
+		/* Read the JPEG file header: */
+		jpeg_read_header(&jpegDecompressStruct,true);
+		imageSize[0]=jpegDecompressStruct.image_width;
+		imageSize[1]=jpegDecompressStruct.image_height;
+		}
+	catch(std::runtime_error err)
+		{
+		/* Clean up: */
+		jpeg_destroy_decompress(&jpegDecompressStruct);
+		
+		/* Wrap and re-throw the exception: */
+		Misc::throwStdErr("Images::JPEGImageReader: Caught exception \"%s\" while reading image \"%s\"",err.what(),sImageFileName);
+		}
+	
+	/* Clean up: */
+	jpeg_destroy_decompress(&jpegDecompressStruct);
+	}
+
+JPEGImageReader::~JPEGImageReader(void)
+	{
+	delete decoder;
+	}
+
+unsigned int JPEGImageReader::getMaxScaleShift(void) const
+	{
+	/* The JPEG library can downscale by factors of up to 8 while decoding: */
+	return 3;
+	}
+
 }
 
 #endif
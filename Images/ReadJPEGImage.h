@@ -28,16 +28,34 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #if IMAGES_CONFIG_HAVE_JPEG
 
 #include <Images/RGBImage.h>
-
-/* Forward declarations: */
-namespace IO {
-class File;
-}
+#include <Images/ImageReader.h>
 
 namespace Images {
 
 RGBImage readJPEGImage(const char* imageName,IO::File& source); // Reads an RGB image in JPEG format from the given data source
 
+class JPEGImageReader:public ImageReader // Class to read regions of JPEG images; supports DCT-domain downscaling by factors of 2, 4, and 8, skips undisplayed image blocks where the JPEG library allows it, and continues decoding where the previous region ended if the next region lies below it
+	{
+	/* Embedded classes: */
+	private:
+	struct DecoderState; // Structure holding the JPEG library state of a partially decoded image
+	
+	/* Elements: */
+	DecoderState* decoder; // Decoder state kept after the most recently decoded region, or null
+	
+	/* Protected methods from ImageReader: */
+	protected:
+	virtual void decodeRegion(const unsigned int offset[2],const unsigned int size[2],RGBImage::Color* pixels,size_t rowStride);
+	
+	/* Constructors and destructors: */
+	public:
+	JPEGImageReader(const char* sImageFileName,IO::FilePtr sFile); // Creates a reader for the given already-open JPEG image file and reads its header
+	virtual ~JPEGImageReader(void);
+	
+	/* Methods from ImageReader: */
+	virtual unsigned int getMaxScaleShift(void) const;
+	};
+
 }
 
 #endif
@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #if IMAGES_CONFIG_HAVE_PNG
 
 #include <png.h>
+#include <string.h>
 #include <stdexcept>
 #include <Misc/ThrowStdErr.h>
 #include <IO/File.h>
@@ -59,6 +60,27 @@ void pngWarningFunction(png_structp pngReadStruct,png_const_charp warningMsg)
 	/* Ignore warnings */
 	}
 
+/***************************************************************
+Helper function to set up conversion of PNG images to 8-bit RGB:
+***************************************************************/
+
+void setRGBTransforms(png_structp pngReadStruct,png_infop pngInfoStruct,int elementSize,int colorType)
+	{
+	if(colorType==PNG_COLOR_TYPE_PALETTE)
+		png_set_expand(pngReadStruct);
+	else if(colorType==PNG_COLOR_TYPE_GRAY&&elementSize<8)
+		png_set_expand(pngReadStruct);
+	if(elementSize==16)
+		png_set_strip_16(pngReadStruct);
+	if(colorType==PNG_COLOR_TYPE_GRAY||colorType==PNG_COLOR_TYPE_GRAY_ALPHA)
+		png_set_gray_to_rgb(pngReadStruct);
+	if(colorType==PNG_COLOR_TYPE_GRAY_ALPHA||colorType==PNG_COLOR_TYPE_RGB_ALPHA)
+		png_set_strip_alpha(pngReadStruct);
+	double gamma;
+	if(png_get_gAMA(pngReadStruct,pngInfoStruct,&gamma))
+		png_set_gamma(pngReadStruct,2.2,gamma);
+	}
+
 }
 
 RGBImage readPNGImage(const char* imageName,IO::File& source)
@@ -96,19 +118,7 @@ RGBImage readPNGImage(const char* imageName,IO::File& source)
 		png_get_IHDR(pngReadStruct,pngInfoStruct,&imageSize[0],&imageSize[1],&elementSize,&colorType,0,0,0);
 		
 		/* Set up image processing: */
-		if(colorType==PNG_COLOR_TYPE_PALETTE)
-			png_set_expand(pngReadStruct);
-		else if(colorType==PNG_COLOR_TYPE_GRAY&&elementSize<8)
-			png_set_expand(pngReadStruct);
-		if(elementSize==16)
-			png_set_strip_16(pngReadStruct);
-		if(colorType==PNG_COLOR_TYPE_GRAY||colorType==PNG_COLOR_TYPE_GRAY_ALPHA)
-			png_set_gray_to_rgb(pngReadStruct);
-		if(colorType==PNG_COLOR_TYPE_GRAY_ALPHA||colorType==PNG_COLOR_TYPE_RGB_ALPHA)
-			png_set_strip_alpha(pngReadStruct);
-		double gamma;
-		if(png_get_gAMA(pngReadStruct,pngInfoStruct,&gamma))
-			png_set_gamma(pngReadStruct,2.2,gamma);
+		setRGBTransforms(pngReadStruct,pngInfoStruct,elementSize,colorType);
 		png_read_update_info(pngReadStruct,pngInfoStruct);
 		
 		/* Initialize the result image: */
@@ -225,6 +235,193 @@ RGBAImage readTransparentPNGImage(const char* imageName,IO::File& source)
 	return result;
 	}
 
+/**************************************************
+Declaration of struct PNGImageReader::DecoderState:
+**************************************************/
+
+struct PNGImageReader::DecoderState
+	{
+	/* Elements: */
+	public:
+	png_structp pngReadStruct; // PNG library read structure
+	png_infop pngInfoStruct; // PNG library image information structure
+	int numPasses; // Number of interlacing passes
+	unsigned int nextRow; // Index of the next file row to be decoded, counting from the top
+	png_byte* rowBuffer; // Buffer to decode rows outside the requested region
+	};
+
+/*******************************
+Methods of class PNGImageReader:
+*******************************/
+
+void PNGImageReader::openDecoder(void)
+	{
+	/* Start reading the image file from the beginning: */
+	IO::File& source=rewind();
+	unsigned char pngSignature[8];
+	source.read(pngSignature,8);
+	if(!png_check_sig(pngSignature,8))
+		throw std::runtime_error("illegal PNG header");
+	
+	/* Allocate the PNG library data structures: */
+	png_structp pngReadStruct=png_create_read_struct(PNG_LIBPNG_VER_STRING,0,pngErrorFunction,pngWarningFunction);
+	if(pngReadStruct==0)
+		throw std::runtime_error("Internal error in PNG library");
+	png_infop pngInfoStruct=png_create_info_struct(pngReadStruct);
+	if(pngInfoStruct==0)
+		{
+		png_destroy_read_struct(&pngReadStruct,0,0);
+		throw std::runtime_error("Internal error in PNG library");
+		}
+	
+	/* Initialize PNG I/O to read from the image file: */
+	png_set_read_fn(pngReadStruct,&source,pngReadDataFunction);
+	
+	decoder=new DecoderState;
+	decoder->pngReadStruct=pngReadStruct;
+	decoder->pngInfoStruct=pngInfoStruct;
+	decoder->numPasses=1;
+	decoder->nextRow=0;
+	decoder->rowBuffer=0;
+	
+	/* Read PNG image header: */
+	png_set_sig_bytes(pngReadStruct,8);
+	png_read_info(pngReadStruct,pngInfoStruct);
+	int elementSize;
+	int colorType;
+	png_get_IHDR(pngReadStruct,pngInfoStruct,0,0,&elementSize,&colorType,0,0,0);
+	
+	/* Set up image processing: */
+	setRGBTransforms(pngReadStruct,pngInfoStruct,elementSize,colorType);
+	decoder->numPasses=png_set_interlace_handling(pngReadStruct);
+	png_read_update_info(pngReadStruct,pngInfoStruct);
+	
+	decoder->rowBuffer=new png_byte[size_t(imageSize[0])*3];
+	}
+
+void PNGImageReader::closeDecoder(void)
+	{
+	if(decoder!=0)
+		{
+		delete[] decoder->rowBuffer;
+		png_destroy_read_struct(&decoder->pngReadStruct,&decoder->pngInfoStruct,0);
+		delete decoder;
+		decoder=0;
+		}
+	}
+
+void PNGImageReader::decodeRegion(const unsigned int offset[2],const unsigned int size[2],RGBImage::Color* pixels,size_t rowStride)
+	{
+	/* Calculate the range of file rows covered by the region; PNG files store rows from top to bottom: */
+	unsigned int firstRow=imageSize[1]-(offset[1]+size[1]);
+	unsigned int lastRow=imageSize[1]-offset[1];
+	size_t rowSize=size_t(imageSize[0])*3;
+	size_t regionRowSize=size_t(size[0])*3;
+	size_t regionRowOffset=size_t(offset[0])*3;
+	
+	/* Start over unless the region begins at or below the next row of a partially decoded non-interlaced image: */
+	if(decoder!=0&&(interlaced||decoder->nextRow>firstRow))
+		closeDecoder();
+	
+	png_byte* regionRows=0;
+	try
+		{
+		if(decoder==0)
+			openDecoder();
+		
+		if(!interlaced)
+			{
+			/* Decode rows until the region's last row, and copy the region's part of its rows: */
+			for(;decoder->nextRow<lastRow;++decoder->nextRow)
+				{
+				png_read_row(decoder->pngReadStruct,decoder->rowBuffer,0);
+				if(decoder->nextRow>=firstRow)
+					memcpy(pixels+size_t(lastRow-1-decoder->nextRow)*rowStride,decoder->rowBuffer+regionRowOffset,regionRowSize);
+				}
+			}
+		else
+			{
+			/* Interlaced images need all passes over all rows; only the region's rows are kept between passes: */
+			regionRows=new png_byte[size_t(size[1])*rowSize];
+			for(int pass=0;pass<decoder->numPasses;++pass)
+				for(unsigned int row=0;row<imageSize[1];++row)
+					png_read_row(decoder->pngReadStruct,row>=firstRow&&row<lastRow?regionRows+size_t(row-firstRow)*rowSize:decoder->rowBuffer,0);
+			
+			/* Copy the region's part of its rows: */
+			for(unsigned int row=firstRow;row<lastRow;++row)
+				memcpy(pixels+size_t(lastRow-1-row)*rowStride,regionRows+size_t(row-firstRow)*rowSize+regionRowOffset,regionRowSize);
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		/* Clean up: */
+		delete[] regionRows;
+		closeDecoder();
+		
+		/* Wrap and re-throw the exception: */
+		Misc::throwStdErr("Images::PNGImageReader::decodeRegion: Caught exception \"%s\" while reading image \"%s\"",err.what(),imageFileName.c_str());
+		}
+	
+	/* Clean up; the decoder state of a non-interlaced image is kept to continue with the next region: */
+	delete[] regionRows;
+	if(interlaced)
+		closeDecoder();
+	}
+
+PNGImageReader::PNGImageReader(const char* sImageFileName,IO::FilePtr sFile)
+	:ImageReader(sImageFileName,sFile),
+	 interlaced(false),decoder(0)
+	{
+	/* Check for PNG file signature: */
+	unsigned char pngSignature[8];
+	file->read(pngSignature,8);
+	if(!png_check_sig(pngSignature,8))
+		Misc::throwStdErr("Images::PNGImageReader: illegal PNG header in image \"%s\"",sImageFileName);
+	
+	/* Allocate the PNG library data structures: */
+	png_structp pngReadStruct=png_create_read_struct(PNG_LIBPNG_VER_STRING,0,pngErrorFunction,pngWarningFunction);
+	if(pngReadStruct==0)
+		Misc::throwStdErr("Images::PNGImageReader: Internal error in PNG library");
+	png_infop pngInfoStruct=png_create_info_struct(pngReadStruct);
+	if(pngInfoStruct==0)
+		{
+		png_destroy_read_struct(&pngReadStruct,0,0);
+		Misc::throwStdErr("Images::PNGImageReader: Internal error in PNG library");
+		}
+	
+	/* Initialize PNG I/O to read from the image file: */
+	png_set_read_fn(pngReadStruct,file.getPointer(),pngReadDataFunction);
+	
+	try
+		{
+		/* Read PNG image header: */
+		png_set_sig_bytes(pngReadStruct,8);
+		png_read_info(pngReadStruct,pngInfoStruct);
+		png_uint_32 pngImageSize[2];
+		int interlaceType;
+		png_get_IHDR(pngReadStruct,pngInfoStruct,&pngImageSize[0],&pngImageSize[1],0,0,&interlaceType,0,0);
+		for(int i=0;i<2;++i)
+			imageSize[i]=pngImageSize[i];
+		interlaced=interlaceType!=PNG_INTERLACE_NONE;
+		}
+	catch(std::runtime_error err)
+		{
+		/* Clean up: */
+		png_destroy_read_struct(&pngReadStruct,&pngInfoStruct,0);
+		
+		/* Wrap and re-throw the exception: */
+		Misc::throwStdErr("Images::PNGImageReader: Caught exception \"%s\" while reading image \"%s\"",err.what(),sImageFileName);
+		}
+	
+	/* Clean up: */
+	png_destroy_read_struct(&pngReadStruct,&pngInfoStruct,0);
+	}
+
+PNGImageReader::~PNGImageReader(void)
+	{
+	closeDecoder();
+	}
+
 }
 
 #endif
@@ -29,17 +29,37 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <Images/RGBImage.h>
 #include <Images/RGBAImage.h>
-
-/* Forward declarations: */
-namespace IO {
-class File;
-}
+#include <Images/ImageReader.h>
 
 namespace Images {
 
 RGBImage readPNGImage(const char* imageName,IO::File& source); // Reads an RGB image in PNG format from the given data source
 RGBAImage readTransparentPNGImage(const char* imageName,IO::File& source); // Reads an RGBA image in PNG format from the given data source
 
+class PNGImageReader:public ImageReader // Class to read regions of PNG images; decodes image rows only up to the region's last row unless the image is interlaced, and continues decoding where the previous region ended if the next region lies below it
+	{
+	/* Embedded classes: */
+	private:
+	struct DecoderState; // Structure holding the PNG library state of a partially decoded image
+	
+	/* Elements: */
+	bool interlaced; // Flag whether the image is stored in Adam7 interlaced order
+	DecoderState* decoder; // Decoder state kept after the most recently decoded region, or null
+	
+	/* Private methods: */
+	void openDecoder(void); // Starts decoding the image file from the beginning; throws exception on errors
+	void closeDecoder(void); // Releases the current decoder state
+	
+	/* Protected methods from ImageReader: */
+	protected:
+	virtual void decodeRegion(const unsigned int offset[2],const unsigned int size[2],RGBImage::Color* pixels,size_t rowStride);
+	
+	/* Constructors and destructors: */
+	public:
+	PNGImageReader(const char* sImageFileName,IO::FilePtr sFile); // Creates a reader for the given already-open PNG image file and reads its header
+	virtual ~PNGImageReader(void);
+	};
+
 }
 
 #endif
@@ -47,6 +47,54 @@ inline void skipComments(IO::ValueSource& header)
 		}
 	}
 
+IO::ValueSource* parseHeader(IO::File& source,int& imageType,unsigned int& width,unsigned int& height,unsigned int& maxValue) // Parses a PNM header; returns a value source to read pixel values for ASCII images, or null for binary images
+	{
+	/* Parse the file's header: */
+	Misc::SelfDestructPointer<IO::ValueSource> header(new IO::ValueSource(&source));
+	header->skipWs();
+	
+	/* Read the magic field including the image type indicator: */
+	int magic=header->getChar();
+	imageType=header->getChar();
+	if(magic!='P'||imageType<'1'||imageType>'6')
+		throw std::runtime_error("Invalid PNM header");
+	header->skipWs();
+	skipComments(*header);
+	
+	/* Read the image width, height, and maximal pixel component value: */
+	width=header->readUnsignedInteger();
+	skipComments(*header);
+	if(imageType=='1'||imageType=='4') // PBM files don't have the maxValue field
+		{
+		header->setWhitespace(""); // Disable all whitespace to read the last header field
+		height=header->readUnsignedInteger();
+		maxValue=1;
+		}
+	else
+		{
+		height=header->readUnsignedInteger();
+		skipComments(*header);
+		header->setWhitespace(""); // Disable all whitespace to read the last header field
+		maxValue=header->readUnsignedInteger();
+		}
+	
+	/* Read the separating whitespace character: */
+	header->getChar();
+	
+	/* Delete the header parser if the rest of the file is in binary; otherwise re-enable whitespace: */
+	if(imageType>='4')
+		{
+		header.setTarget(0);
+		source.setEndianness(Misc::BigEndian);
+		return 0;
+		}
+	else
+		{
+		header->resetCharacterClasses();
+		return header.releaseTarget();
+		}
+	}
+
 }
 
 RGBImage readPNMImage(const char* imageName,IO::File& source)
@@ -55,46 +103,9 @@ RGBImage readPNMImage(const char* imageName,IO::File& source)
 	try
 		{
 		/* Parse the file's header: */
-		Misc::SelfDestructPointer<IO::ValueSource> header(new IO::ValueSource(&source));
-		header->skipWs();
-		
-		/* Read the magic field including the image type indicator: */
-		int magic=header->getChar();
-		int imageType=header->getChar();
-		if(magic!='P'||imageType<'1'||imageType>'6')
-			throw std::runtime_error("Invalid PNM header");
-		header->skipWs();
-		skipComments(*header);
-		
-		/* Read the image width, height, and maximal pixel component value: */
+		int imageType;
 		unsigned int width,height,maxValue;
-		width=header->readUnsignedInteger();
-		skipComments(*header);
-		if(imageType=='1'||imageType=='4') // PBM files don't have the maxValue field
-			{
-			header->setWhitespace(""); // Disable all whitespace to read the last header field
-			height=header->readUnsignedInteger();
-			maxValue=1;
-			}
-		else
-			{
-			height=header->readUnsignedInteger();
-			skipComments(*header);
-			header->setWhitespace(""); // Disable all whitespace to read the last header field
-			maxValue=header->readUnsignedInteger();
-			}
-		
-		/* Read the separating whitespace character: */
-		header->getChar();
-		
-		/* Delete the header parser if the rest of the file is in binary; otherwise re-enable whitespace: */
-		if(imageType>='4')
-			{
-			header.setTarget(0);
-			source.setEndianness(Misc::BigEndian);
-			}
-		else
-			header->resetCharacterClasses();
+		Misc::SelfDestructPointer<IO::ValueSource> header(parseHeader(source,imageType,width,height,maxValue));
 		
 		/* Read the image: */
 		result=RGBImage(width,height);
@@ -251,4 +262,191 @@ RGBImage readPNMImage(const char* imageName,IO::File& source)
 	return result;
 	}
 
+/*******************************
+Methods of class PNMImageReader:
+*******************************/
+
+void PNMImageReader::decodeRegion(const unsigned int offset[2],const unsigned int size[2],RGBImage::Color* pixels,size_t rowStride)
+	{
+	/* Calculate the range of file rows covered by the region; PNM files store rows from top to bottom: */
+	unsigned int firstRow=imageSize[1]-(offset[1]+size[1]);
+	unsigned int lastRow=imageSize[1]-offset[1];
+	
+	try
+		{
+		if(imageType>='4')
+			{
+			/* Calculate the size of a raw pixel row and the range of raw bytes covering the region: */
+			size_t componentSize=maxValue<256?1:2;
+			size_t rowSize,readOffset,readSize;
+			if(imageType=='4')
+				{
+				rowSize=(size_t(imageSize[0])+7)>>3;
+				readOffset=size_t(offset[0])>>3;
+				readSize=((size_t(offset[0])+size_t(size[0])+7)>>3)-readOffset;
+				}
+			else
+				{
+				size_t pixelSize=(imageType=='6'?3:1)*componentSize;
+				rowSize=size_t(imageSize[0])*pixelSize;
+				readOffset=size_t(offset[0])*pixelSize;
+				readSize=size_t(size[0])*pixelSize;
+				}
+			
+			/* Position the file at the beginning of the region's first row: */
+			IO::SeekableFilePtr seekableFile;
+			if(dataOffset>=0)
+				seekableFile=file;
+			else
+				{
+				/* Re-read the file's header and skip all rows above the region: */
+				IO::File& source=rewind();
+				int it;
+				unsigned int w,h,mv;
+				delete parseHeader(source,it,w,h,mv);
+				source.skip<Misc::UInt8>(size_t(firstRow)*rowSize);
+				}
+			
+			/* Allocate a row buffer: */
+			Misc::SelfDestructArray<Misc::UInt8> tempRow8(componentSize==1?readSize:0);
+			Misc::SelfDestructArray<Misc::UInt16> tempRow16(componentSize==2?readSize/2:0);
+			
+			/* Read each row of the region: */
+			for(unsigned int row=firstRow;row<lastRow;++row)
+				{
+				/* Read the region's part of the row of raw pixel values from the file: */
+				if(seekableFile!=0)
+					seekableFile->setReadPosAbs(dataOffset+IO::SeekableFile::Offset(size_t(row)*rowSize+readOffset));
+				else
+					file->skip<Misc::UInt8>(readOffset);
+				if(componentSize==1)
+					file->read(tempRow8.getArray(),readSize);
+				else
+					file->read(tempRow16.getArray(),readSize/2);
+				if(seekableFile==0)
+					file->skip<Misc::UInt8>(rowSize-readOffset-readSize);
+				
+				/* Convert pixel values: */
+				RGBImage::Color* rowPtr=pixels+size_t(lastRow-1-row)*rowStride;
+				switch(imageType)
+					{
+					case '4': // Binary bitmap image
+						{
+						unsigned int bit=offset[0]&0x7U;
+						Misc::UInt8* tempRowPtr=tempRow8;
+						for(unsigned int x=0;x<size[0];++x,++rowPtr)
+							{
+							(*rowPtr)[0]=(*rowPtr)[1]=(*rowPtr)[2]=RGBImage::Color::Scalar(((*tempRowPtr)&(0x80U>>bit))!=0x0U?255U:0U);
+							if(++bit==8)
+								{
+								bit=0;
+								++tempRowPtr;
+								}
+							}
+						break;
+						}
+					
+					case '5': // Binary greyscale image
+						if(componentSize==1)
+							{
+							Misc::UInt8* tempRowPtr=tempRow8;
+							for(unsigned int x=0;x<size[0];++x,++rowPtr,++tempRowPtr)
+								(*rowPtr)[0]=(*rowPtr)[1]=(*rowPtr)[2]=RGBImage::Scalar(*tempRowPtr);
+							}
+						else
+							{
+							Misc::UInt16* tempRowPtr=tempRow16;
+							for(unsigned int x=0;x<size[0];++x,++rowPtr,++tempRowPtr)
+								(*rowPtr)[0]=(*rowPtr)[1]=(*rowPtr)[2]=RGBImage::Scalar(((unsigned int)(*tempRowPtr)*256U)/(maxValue+1));
+							}
+						break;
+					
+					case '6': // Binary RGB color image
+						if(componentSize==1)
+							{
+							Misc::UInt8* tempRowPtr=tempRow8;
+							for(unsigned int x=0;x<size[0];++x,++rowPtr,tempRowPtr+=3)
+								for(int i=0;i<3;++i)
+									(*rowPtr)[i]=RGBImage::Scalar(tempRowPtr[i]);
+							}
+						else
+							{
+							Misc::UInt16* tempRowPtr=tempRow16;
+							for(unsigned int x=0;x<size[0];++x,++rowPtr,tempRowPtr+=3)
+								for(int i=0;i<3;++i)
+									(*rowPtr)[i]=RGBImage::Scalar(((unsigned int)(tempRowPtr[i])*256U)/(maxValue+1));
+							}
+						break;
+					}
+				}
+			}
+		else
+			{
+			/* Re-read the file's header: */
+			IO::File& source=rewind();
+			int it;
+			unsigned int w,h,mv;
+			Misc::SelfDestructPointer<IO::ValueSource> values(parseHeader(source,it,w,h,mv));
+			
+			/* Skip all pixel values above the region: */
+			unsigned int numComponents=imageType=='3'?3:1;
+			size_t numSkipValues=size_t(firstRow)*size_t(imageSize[0])*numComponents;
+			for(size_t i=0;i<numSkipValues;++i)
+				values->readUnsignedInteger();
+			
+			/* Read each row of the region: */
+			for(unsigned int row=firstRow;row<lastRow;++row)
+				{
+				/* Skip the pixel values left of the region: */
+				for(unsigned int i=0;i<offset[0]*numComponents;++i)
+					values->readUnsignedInteger();
+				
+				/* Read and convert the region's pixel values: */
+				RGBImage::Color* rowPtr=pixels+size_t(lastRow-1-row)*rowStride;
+				for(unsigned int x=0;x<size[0];++x,++rowPtr)
+					{
+					if(imageType=='1')
+						(*rowPtr)[0]=(*rowPtr)[1]=(*rowPtr)[2]=RGBImage::Color::Scalar(values->readUnsignedInteger()!=0U?255U:0U);
+					else if(imageType=='2')
+						(*rowPtr)[0]=(*rowPtr)[1]=(*rowPtr)[2]=RGBImage::Color::Scalar((values->readUnsignedInteger()*256U)/(maxValue+1));
+					else
+						for(int i=0;i<3;++i)
+							(*rowPtr)[i]=RGBImage::Color::Scalar((values->readUnsignedInteger()*256U)/(maxValue+1));
+					}
+				
+				/* Skip the pixel values right of the region unless this is the region's last row: */
+				if(row+1<lastRow)
+					for(unsigned int i=(offset[0]+size[0])*numComponents;i<imageSize[0]*numComponents;++i)
+						values->readUnsignedInteger();
+				}
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		/* Wrap and re-throw the exception: */
+		Misc::throwStdErr("Images::PNMImageReader::decodeRegion: Caught exception \"%s\" while reading image \"%s\"",err.what(),imageFileName.c_str());
+		}
+	}
+
+PNMImageReader::PNMImageReader(const char* sImageFileName,IO::FilePtr sFile)
+	:ImageReader(sImageFileName,sFile),
+	 dataOffset(-1)
+	{
+	try
+		{
+		/* Parse the file's header: */
+		delete parseHeader(*file,imageType,imageSize[0],imageSize[1],maxValue);
+		
+		/* Remember the position of the first pixel row to seek directly to the rows of binary images: */
+		IO::SeekableFilePtr seekableFile=file;
+		if(imageType>='4'&&seekableFile!=0)
+			dataOffset=seekableFile->getReadPos();
+		}
+	catch(std::runtime_error err)
+		{
+		/* Wrap and re-throw the exception: */
+		Misc::throwStdErr("Images::PNMImageReader: Caught exception \"%s\" while reading image \"%s\"",err.what(),sImageFileName);
+		}
+	}
+
 }
@@ -1,6 +1,7 @@
 /***********************************************************************
-ReadPNMImage - Functions to read RGB images from image files in PNM
-(Portable AnyMap) formats over an IO::File abstraction.
+ReadPNMImage - Functions and image reader class to read RGB images from
+image files in PNM (Portable AnyMap) formats over an IO::File
+abstraction.
 Copyright (c) 2011 Oliver Kreylos
 
 This file is part of the Image Handling Library (Images).
@@ -23,17 +24,31 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef IMAGES_READPNMIMAGE_INCLUDED
 #define IMAGES_READPNMIMAGE_INCLUDED
 
+#include <IO/SeekableFile.h>
 #include <Images/RGBImage.h>
-
-/* Forward declarations: */
-namespace IO {
-class File;
-}
+#include <Images/ImageReader.h>
 
 namespace Images {
 
 RGBImage readPNMImage(const char* imageName,IO::File& source); // Reads an RGB image in Portable AnyMap format from the given data source
 
+class PNMImageReader:public ImageReader // Class to read regions of PNM images; seeks directly to the region's rows in binary images stored in seekable files
+	{
+	/* Elements: */
+	private:
+	int imageType; // PNM image type character from '1' to '6'
+	unsigned int maxValue; // Maximum pixel component value
+	IO::SeekableFile::Offset dataOffset; // Position of the first pixel row in the file for binary images in seekable files, or -1
+	
+	/* Protected methods from ImageReader: */
+	protected:
+	virtual void decodeRegion(const unsigned int offset[2],const unsigned int size[2],RGBImage::Color* pixels,size_t rowStride);
+	
+	/* Constructors and destructors: */
+	public:
+	PNMImageReader(const char* sImageFileName,IO::FilePtr sFile); // Creates a reader for the given already-open PNM image file and reads its header
+	};
+
 }
 
 #endif
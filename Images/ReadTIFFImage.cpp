@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <iostream>
 #include <tiffio.h>
 #include <stdexcept>
+#include <Misc/Utility.h>
 #include <Misc/ThrowStdErr.h>
 #include <IO/File.h>
 #include <IO/SeekableFile.h>
@@ -88,7 +89,7 @@ toff_t tiffSeekFunction(thandle_t handle,toff_t offset,int whence)
 			break;
 
 		case SEEK_END:
-			source->setReadPosAbs(source->getSize()-offset);
+			source->setReadPosAbs(source->getSize()+offset);
 			break;
 		}
 	
@@ -257,6 +258,160 @@ RGBAImage readTransparentTIFFImage(const char* imageName,IO::File& source)
 	return result;
 	}
 
+/********************************
+Methods of class TIFFImageReader:
+********************************/
+
+void TIFFImageReader::decodeRegion(const unsigned int offset[2],const unsigned int size[2],RGBImage::Color* pixels,size_t rowStride)
+	{
+	/* Calculate the range of image rows covered by the region; TIFF files store rows from top to bottom: */
+	unsigned int firstRow=imageSize[1]-(offset[1]+size[1]);
+	unsigned int lastRow=imageSize[1]-offset[1];
+	unsigned int lastCol=offset[0]+size[0];
+	
+	uint32* rgbaBuffer=0;
+	try
+		{
+		if(tiled)
+			{
+			/* Allocate a temporary RGBA buffer for a single tile: */
+			rgbaBuffer=new uint32[size_t(tileSize[0])*size_t(tileSize[1])];
+			
+			/* Read all tiles overlapping the region: */
+			for(unsigned int tileY=(firstRow/tileSize[1])*tileSize[1];tileY<lastRow;tileY+=tileSize[1])
+				{
+				unsigned int rowBegin=Misc::max(tileY,firstRow);
+				unsigned int rowEnd=Misc::min(tileY+tileSize[1],lastRow);
+				for(unsigned int tileX=(offset[0]/tileSize[0])*tileSize[0];tileX<lastCol;tileX+=tileSize[0])
+					{
+					/* Read the tile into the temporary buffer; tile rows are stored bottom-up, starting at the bottom of the full tile: */
+					if(!TIFFReadRGBATile(tiffFile,tileX,tileY,rgbaBuffer))
+						throw std::runtime_error("Error while reading image tile");
+					
+					/* Copy the tile's part of the region: */
+					unsigned int colBegin=Misc::max(tileX,offset[0]);
+					unsigned int colEnd=Misc::min(tileX+tileSize[0],lastCol);
+					for(unsigned int row=rowBegin;row<rowEnd;++row)
+						{
+						const uint32* sPtr=rgbaBuffer+size_t(tileSize[1]-1-(row-tileY))*size_t(tileSize[0])+(colBegin-tileX);
+						RGBImage::Color* dPtr=pixels+size_t(lastRow-1-row)*rowStride+(colBegin-offset[0]);
+						for(unsigned int col=colBegin;col<colEnd;++col,++sPtr,++dPtr)
+							{
+							(*dPtr)[0]=RGBImage::Scalar(TIFFGetR(*sPtr));
+							(*dPtr)[1]=RGBImage::Scalar(TIFFGetG(*sPtr));
+							(*dPtr)[2]=RGBImage::Scalar(TIFFGetB(*sPtr));
+							}
+						}
+					}
+				}
+			}
+		else
+			{
+			/* Allocate a temporary RGBA buffer for a single strip: */
+			rgbaBuffer=new uint32[size_t(imageSize[0])*size_t(rowsPerStrip)];
+			
+			/* Read all strips overlapping the region: */
+			for(unsigned int stripY=(firstRow/rowsPerStrip)*rowsPerStrip;stripY<lastRow;stripY+=rowsPerStrip)
+				{
+				/* Read the strip into the temporary buffer; strip rows are stored bottom-up: */
+				if(!TIFFReadRGBAStrip(tiffFile,stripY,rgbaBuffer))
+					throw std::runtime_error("Error while reading image strip");
+				unsigned int stripRows=Misc::min(rowsPerStrip,imageSize[1]-stripY);
+				
+				/* Copy the strip's part of the region: */
+				unsigned int rowBegin=Misc::max(stripY,firstRow);
+				unsigned int rowEnd=Misc::min(stripY+stripRows,lastRow);
+				for(unsigned int row=rowBegin;row<rowEnd;++row)
+					{
+					const uint32* sPtr=rgbaBuffer+size_t(stripRows-1-(row-stripY))*size_t(imageSize[0])+offset[0];
+					RGBImage::Color* dPtr=pixels+size_t(lastRow-1-row)*rowStride;
+					for(unsigned int col=offset[0];col<lastCol;++col,++sPtr,++dPtr)
+						{
+						(*dPtr)[0]=RGBImage::Scalar(TIFFGetR(*sPtr));
+						(*dPtr)[1]=RGBImage::Scalar(TIFFGetG(*sPtr));
+						(*dPtr)[2]=RGBImage::Scalar(TIFFGetB(*sPtr));
+						}
+					}
+				}
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		/* Clean up: */
+		delete[] rgbaBuffer;
+		
+		/* Wrap and re-throw the exception: */
+		Misc::throwStdErr("Images::TIFFImageReader::decodeRegion: Caught exception \"%s\" while reading image \"%s\"",err.what(),imageFileName.c_str());
+		}
+	
+	/* Clean up: */
+	delete[] rgbaBuffer;
+	}
+
+TIFFImageReader::TIFFImageReader(const char* sImageFileName,IO::FilePtr sFile)
+	:ImageReader(sImageFileName,sFile),
+	 seekableFile(file),tiffFile(0),
+	 tiled(false),rowsPerStrip(0)
+	{
+	/* Check if the image file is seekable: */
+	if(seekableFile==0)
+		{
+		/* Create a seekable filter for the image file: */
+		seekableFile=new IO::SeekableFilter(file);
+		}
+	tileSize[0]=tileSize[1]=0;
+	
+	/* Set the TIFF error handler: */
+	TIFFSetErrorHandler(tiffErrorFunction);
+	TIFFSetWarningHandler(tiffWarningFunction);
+	
+	try
+		{
+		/* Pretend to open the TIFF file and register the hook functions: */
+		tiffFile=TIFFClientOpen(sImageFileName,"rm",seekableFile.getPointer(),tiffReadFunction,tiffWriteFunction,tiffSeekFunction,tiffCloseFunction,tiffSizeFunction,tiffMapFileFunction,tiffUnmapFileFunction);
+		if(tiffFile==0)
+			throw std::runtime_error("Error while opening image");
+		
+		/* Get the image size: */
+		uint32 width,height;
+		TIFFGetField(tiffFile,TIFFTAG_IMAGEWIDTH,&width);
+		TIFFGetField(tiffFile,TIFFTAG_IMAGELENGTH,&height);
+		imageSize[0]=width;
+		imageSize[1]=height;
+		
+		/* Get the image's storage layout: */
+		tiled=TIFFIsTiled(tiffFile)!=0;
+		if(tiled)
+			{
+			uint32 tileWidth,tileHeight;
+			TIFFGetField(tiffFile,TIFFTAG_TILEWIDTH,&tileWidth);
+			TIFFGetField(tiffFile,TIFFTAG_TILELENGTH,&tileHeight);
+			tileSize[0]=tileWidth;
+			tileSize[1]=tileHeight;
+			}
+		else
+			{
+			uint32 stripHeight;
+			TIFFGetFieldDefaulted(tiffFile,TIFFTAG_ROWSPERSTRIP,&stripHeight);
+			rowsPerStrip=stripHeight==0||stripHeight>height?height:stripHeight;
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		/* Clean up: */
+		if(tiffFile!=0)
+			TIFFClose(tiffFile);
+		
+		/* Wrap and re-throw the exception: */
+		Misc::throwStdErr("Images::TIFFImageReader: Caught exception \"%s\" while reading image \"%s\"",err.what(),sImageFileName);
+		}
+	}
+
+TIFFImageReader::~TIFFImageReader(void)
+	{
+	TIFFClose(tiffFile);
+	}
+
 }
 
 #endif
@@ -27,19 +27,39 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #if IMAGES_CONFIG_HAVE_TIFF
 
+#include <IO/SeekableFile.h>
 #include <Images/RGBImage.h>
 #include <Images/RGBAImage.h>
+#include <Images/ImageReader.h>
 
 /* Forward declarations: */
-namespace IO {
-class File;
-}
+struct tiff;
 
 namespace Images {
 
 RGBImage readTIFFImage(const char* imageName,IO::File& source); // Reads an RGB image in TIFF format from the given data source
 RGBAImage readTransparentTIFFImage(const char* imageName,IO::File& source); // Reads an RGBA image in TIFF format from the given data source
 
+class TIFFImageReader:public ImageReader // Class to read regions of TIFF images; decodes only the tiles or strips overlapping the region
+	{
+	/* Elements: */
+	private:
+	IO::SeekableFilePtr seekableFile; // Seekable view of the image file, kept open for random access
+	tiff* tiffFile; // Handle of the open TIFF image
+	bool tiled; // Flag whether the image is stored in tiles instead of strips
+	unsigned int tileSize[2]; // Width and height of image tiles in tiled images
+	unsigned int rowsPerStrip; // Number of image rows per strip in stripped images
+	
+	/* Protected methods from ImageReader: */
+	protected:
+	virtual void decodeRegion(const unsigned int offset[2],const unsigned int size[2],RGBImage::Color* pixels,size_t rowStride);
+	
+	/* Constructors and destructors: */
+	public:
+	TIFFImageReader(const char* sImageFileName,IO::FilePtr sFile); // Creates a reader for the given already-open TIFF image file and reads its directory
+	virtual ~TIFFImageReader(void);
+	};
+
 }
 
 #endif
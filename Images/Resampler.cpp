@@ -0,0 +1,359 @@
+/***********************************************************************
+Resampler - Class to resample images to arbitrary sizes using separable
+filters with precomputed weight tables, processing bands of output rows
+in parallel.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Images/Resampler.h>
+
+#include <math.h>
+#include <GL/gl.h>
+#include <Threads/ParallelFor.h>
+
+namespace Images {
+
+namespace {
+
+/******************************
+Helper functions for filtering:
+******************************/
+
+inline float getFilterRadius(Resampler::Filter filter) // Returns the support radius of a filter kernel at unit scale
+	{
+	switch(filter)
+		{
+		case Resampler::BOX:
+			return 0.5f;
+		
+		case Resampler::BILINEAR:
+			return 1.0f;
+		
+		case Resampler::BICUBIC:
+			return 2.0f;
+		
+		default:
+			return 3.0f;
+		}
+	}
+
+inline float evalFilter(Resampler::Filter filter,float x) // Evaluates a point-sampled filter kernel at unit scale
+	{
+	if(x<0.0f)
+		x=-x;
+	switch(filter)
+		{
+		case Resampler::BILINEAR:
+			return x<1.0f?1.0f-x:0.0f;
+		
+		case Resampler::BICUBIC:
+			if(x<1.0f)
+				return (1.5f*x-2.5f)*x*x+1.0f;
+			else if(x<2.0f)
+				return ((-0.5f*x+2.5f)*x-4.0f)*x+2.0f;
+			else
+				return 0.0f;
+		
+		default:
+			{
+			if(x<1.0e-6f)
+				return 1.0f;
+			if(x>=3.0f)
+				return 0.0f;
+			float pix=float(M_PI)*x;
+			return 3.0f*sinf(pix)*sinf(pix/3.0f)/(pix*pix);
+			}
+		}
+	}
+
+/****************************************************************
+Helper class to convert filtered values back to pixel components:
+****************************************************************/
+
+template <class ScalarParam>
+class ScalarConverter
+	{
+	};
+
+template <>
+class ScalarConverter<GLubyte>
+	{
+	/* Methods: */
+	public:
+	static GLubyte fromFloat(float value)
+		{
+		return value<=0.0f?GLubyte(0):(value>=255.0f?GLubyte(255):GLubyte(value+0.5f));
+		}
+	};
+
+template <>
+class ScalarConverter<GLushort>
+	{
+	/* Methods: */
+	public:
+	static GLushort fromFloat(float value)
+		{
+		return value<=0.0f?GLushort(0):(value>=65535.0f?GLushort(65535):GLushort(value+0.5f));
+		}
+	};
+
+template <>
+class ScalarConverter<GLfloat>
+	{
+	/* Methods: */
+	public:
+	static GLfloat fromFloat(float value)
+		{
+		return value;
+		}
+	};
+
+/**********************************************************************
+Helper function to filter a single source row horizontally; the number
+of components is a template parameter for the common cases to let the
+compiler unroll and vectorize the inner loop:
+**********************************************************************/
+
+template <class ScalarParam,int numComponentsParam>
+inline void filterRow(const Resampler::WeightTable& weights,unsigned int destWidth,const ScalarParam* source,float* dest)
+	{
+	for(unsigned int x=0;x<destWidth;++x,dest+=numComponentsParam)
+		{
+		float sum[numComponentsParam];
+		for(int i=0;i<numComponentsParam;++i)
+			sum[i]=0.0f;
+		for(size_t t=weights.getFirstTap(x);t<weights.getLastTap(x);++t)
+			{
+			const ScalarParam* sPtr=source+size_t(weights.getTapIndex(t))*numComponentsParam;
+			float w=weights.getTapWeight(t);
+			for(int i=0;i<numComponentsParam;++i)
+				sum[i]+=float(sPtr[i])*w;
+			}
+		for(int i=0;i<numComponentsParam;++i)
+			dest[i]=sum[i];
+		}
+	}
+
+template <class ScalarParam>
+inline void filterRow(const Resampler::WeightTable& weights,int numComponents,unsigned int destWidth,const ScalarParam* source,float* dest)
+	{
+	switch(numComponents)
+		{
+		case 1:
+			filterRow<ScalarParam,1>(weights,destWidth,source,dest);
+			break;
+		
+		case 2:
+			filterRow<ScalarParam,2>(weights,destWidth,source,dest);
+			break;
+		
+		case 3:
+			filterRow<ScalarParam,3>(weights,destWidth,source,dest);
+			break;
+		
+		case 4:
+			filterRow<ScalarParam,4>(weights,destWidth,source,dest);
+			break;
+		
+		default:
+			for(unsigned int x=0;x<destWidth;++x,dest+=numComponents)
+				{
+				for(int i=0;i<numComponents;++i)
+					dest[i]=0.0f;
+				for(size_t t=weights.getFirstTap(x);t<weights.getLastTap(x);++t)
+					{
+					const ScalarParam* sPtr=source+size_t(weights.getTapIndex(t))*numComponents;
+					float w=weights.getTapWeight(t);
+					for(int i=0;i<numComponents;++i)
+						dest[i]+=float(sPtr[i])*w;
+					}
+				}
+		}
+	}
+
+/**********************************************************************
+Helper class to resample a band of destination rows. Each destination
+row is the weighted sum of horizontally filtered source rows, which are
+kept in a small ring buffer indexed by source row, so that each source
+row is filtered horizontally at most once per band and no full-size
+intermediate image is needed:
+**********************************************************************/
+
+template <class ScalarParam>
+class BandResampler
+	{
+	/* Elements: */
+	public:
+	int numComponents; // Number of interleaved pixel components
+	const unsigned int* sourceSize; // Source image size
+	const ScalarParam* source; // Source image
+	const unsigned int* destSize; // Destination image size
+	ScalarParam* dest; // Destination image
+	const Resampler::WeightTable* horizontal; // Weight table for horizontal filtering
+	const Resampler::WeightTable* vertical; // Weight table for vertical filtering
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
+		{
+		size_t sourceRowSize=size_t(sourceSize[0])*size_t(numComponents);
+		size_t destRowSize=size_t(destSize[0])*size_t(numComponents);
+		
+		/* Create the ring buffer of horizontally filtered source rows; rows contributing to the same destination row never share a slot: */
+		unsigned int ringSize=vertical->getMaxNumTaps();
+		float* ring=new float[size_t(ringSize)*destRowSize];
+		std::vector<unsigned int> ringRows(ringSize,~0U);
+		float* accum=new float[destRowSize];
+		
+		for(size_t y=begin;y<end;++y)
+			{
+			/* Accumulate all contributing source rows: */
+			for(size_t i=0;i<destRowSize;++i)
+				accum[i]=0.0f;
+			for(size_t t=vertical->getFirstTap(y);t<vertical->getLastTap(y);++t)
+				{
+				/* Filter the source row horizontally unless it is already in the ring buffer: */
+				unsigned int sourceRow=vertical->getTapIndex(t);
+				unsigned int slot=sourceRow%ringSize;
+				float* row=ring+size_t(slot)*destRowSize;
+				if(ringRows[slot]!=sourceRow)
+					{
+					filterRow(*horizontal,numComponents,destSize[0],source+size_t(sourceRow)*sourceRowSize,row);
+					ringRows[slot]=sourceRow;
+					}
+				
+				float w=vertical->getTapWeight(t);
+				for(size_t i=0;i<destRowSize;++i)
+					accum[i]+=row[i]*w;
+				}
+			
+			/* Store the destination row: */
+			ScalarParam* dRow=dest+y*destRowSize;
+			for(size_t i=0;i<destRowSize;++i)
+				dRow[i]=ScalarConverter<ScalarParam>::fromFloat(accum[i]);
+			}
+		
+		delete[] accum;
+		delete[] ring;
+		}
+	};
+
+}
+
+/***************************************
+Methods of class Resampler::WeightTable:
+***************************************/
+
+Resampler::WeightTable::WeightTable(Resampler::Filter filter,unsigned int sourceSize,unsigned int destSize)
+	:maxNumTaps(0)
+	{
+	/* Stretch the filter kernel when reducing to suppress aliasing: */
+	float scale=float(sourceSize)/float(destSize);
+	float filterScale=scale>1.0f?scale:1.0f;
+	float radius=getFilterRadius(filter)*filterScale;
+	
+	for(unsigned int d=0;d<destSize;++d)
+		{
+		firstTaps.push_back(tapIndices.size());
+		
+		/* Calculate the destination pixel's center and footprint in source pixel space: */
+		float center=(float(d)+0.5f)*scale;
+		int s0=int(floorf(center-radius));
+		int s1=int(ceilf(center+radius));
+		size_t first=tapIndices.size();
+		float weightSum=0.0f;
+		for(int s=s0;s<s1;++s)
+			{
+			float weight;
+			if(filter==BOX)
+				{
+				/* Calculate the overlap of the source pixel with the destination pixel's footprint: */
+				float lo=float(s)>center-radius?float(s):center-radius;
+				float hi=float(s+1)<center+radius?float(s+1):center+radius;
+				weight=hi>lo?hi-lo:0.0f;
+				}
+			else
+				weight=evalFilter(filter,(float(s)+0.5f-center)/filterScale);
+			
+			if(weight!=0.0f)
+				{
+				/* Clamp the source pixel index to the image edge: */
+				tapIndices.push_back(s<0?0U:(s>=int(sourceSize)?sourceSize-1:(unsigned int)s));
+				tapWeights.push_back(weight);
+				weightSum+=weight;
+				}
+			}
+		
+		if(weightSum!=0.0f)
+			{
+			/* Normalize the weights: */
+			for(size_t i=first;i<tapWeights.size();++i)
+				tapWeights[i]/=weightSum;
+			}
+		else
+			{
+			/* Fall back to the nearest source pixel: */
+			tapIndices.resize(first);
+			tapWeights.resize(first);
+			unsigned int s=(unsigned int)center;
+			tapIndices.push_back(s<sourceSize?s:sourceSize-1);
+			tapWeights.push_back(1.0f);
+			}
+		
+		if(maxNumTaps<(unsigned int)(tapIndices.size()-first))
+			maxNumTaps=(unsigned int)(tapIndices.size()-first);
+		}
+	firstTaps.push_back(tapIndices.size());
+	}
+
+/**************************
+Methods of class Resampler:
+**************************/
+
+template <class ScalarParam>
+void Resampler::resample(int numComponents,const unsigned int sourceSize[2],const ScalarParam* source,const unsigned int destSize[2],ScalarParam* dest) const
+	{
+	if(destSize[0]==0||destSize[1]==0||sourceSize[0]==0||sourceSize[1]==0)
+		return;
+	
+	/* Calculate the weight tables for both dimensions: */
+	WeightTable horizontal(filter,sourceSize[0],destSize[0]);
+	WeightTable vertical(filter,sourceSize[1],destSize[1]);
+	
+	/* Resample bands of destination rows in parallel, with bands of at least 64k components: */
+	BandResampler<ScalarParam> band;
+	band.numComponents=numComponents;
+	band.sourceSize=sourceSize;
+	band.source=source;
+	band.destSize=destSize;
+	band.dest=dest;
+	band.horizontal=&horizontal;
+	band.vertical=&vertical;
+	size_t minBandSize=65536/(size_t(destSize[0])*size_t(numComponents))+1;
+	Threads::parallelFor(0,destSize[1],band,minBandSize,maxNumThreads);
+	}
+
+/**********************************************
+Force instantiation of all standard resamplers:
+**********************************************/
+
+template void Resampler::resample<GLubyte>(int,const unsigned int[2],const GLubyte*,const unsigned int[2],GLubyte*) const;
+template void Resampler::resample<GLushort>(int,const unsigned int[2],const GLushort*,const unsigned int[2],GLushort*) const;
+template void Resampler::resample<GLfloat>(int,const unsigned int[2],const GLfloat*,const unsigned int[2],GLfloat*) const;
+
+}
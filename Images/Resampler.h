@@ -0,0 +1,103 @@
+/***********************************************************************
+Resampler - Class to resample images to arbitrary sizes using separable
+filters with precomputed weight tables, processing bands of output rows
+in parallel.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IMAGES_RESAMPLER_INCLUDED
+#define IMAGES_RESAMPLER_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+
+namespace Images {
+
+class Resampler
+	{
+	/* Embedded classes: */
+	public:
+	enum Filter // Enumerated type for resampling filters
+		{
+		BOX, // Area-weighted average of covered source pixels
+		BILINEAR, // Tent filter; bilinear interpolation when enlarging
+		BICUBIC, // Catmull-Rom cubic spline
+		LANCZOS3 // Three-lobed Lanczos-windowed sinc
+		};
+	
+	class WeightTable // Class holding the source pixels and weights contributing to each destination pixel along one dimension
+		{
+		/* Elements: */
+		private:
+		unsigned int maxNumTaps; // Maximum number of taps of any destination pixel
+		std::vector<size_t> firstTaps; // Index of first tap for each destination pixel, plus an end marker
+		std::vector<unsigned int> tapIndices; // Source pixel indices of all taps, clamped to the source range
+		std::vector<float> tapWeights; // Normalized weights of all taps
+		
+		/* Constructors and destructors: */
+		public:
+		WeightTable(Filter filter,unsigned int sourceSize,unsigned int destSize); // Calculates the weight table to resample between the given sizes
+		
+		/* Methods: */
+		unsigned int getMaxNumTaps(void) const // Returns the maximum number of taps of any destination pixel
+			{
+			return maxNumTaps;
+			}
+		size_t getFirstTap(unsigned int destIndex) const // Returns the index of the first tap of the given destination pixel
+			{
+			return firstTaps[destIndex];
+			}
+		size_t getLastTap(unsigned int destIndex) const // Returns one past the index of the last tap of the given destination pixel
+			{
+			return firstTaps[destIndex+1];
+			}
+		unsigned int getTapIndex(size_t tap) const // Returns the source pixel index of the given tap
+			{
+			return tapIndices[tap];
+			}
+		float getTapWeight(size_t tap) const // Returns the weight of the given tap
+			{
+			return tapWeights[tap];
+			}
+		};
+	
+	/* Elements: */
+	private:
+	Filter filter; // Resampling filter
+	unsigned int maxNumThreads; // Maximum number of threads used to resample an image; 0 uses one per processor
+	
+	/* Constructors and destructors: */
+	public:
+	Resampler(Filter sFilter,unsigned int sMaxNumThreads =0) // Creates a resampler with the given filter and thread limit
+		:filter(sFilter),maxNumThreads(sMaxNumThreads)
+		{
+		}
+	
+	/* Methods: */
+	Filter getFilter(void) const // Returns the resampling filter
+		{
+		return filter;
+		}
+	template <class ScalarParam>
+	void resample(int numComponents,const unsigned int sourceSize[2],const ScalarParam* source,const unsigned int destSize[2],ScalarParam* dest) const; // Resamples an image with interleaved pixel components in row-major order; source and destination must not overlap; implemented for GLubyte, GLushort, and GLfloat components
+	};
+
+}
+
+#endif
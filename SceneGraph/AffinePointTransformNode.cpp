@@ -95,4 +95,19 @@ Vector AffinePointTransformNode::transformNormal(const Point& basePoint,const Ve
 	return result;
 	}
 
+void AffinePointTransformNode::transformPoints(size_t numPoints,const Point* points,Point* transformedPoints) const
+	{
+	for(size_t i=0;i<numPoints;++i)
+		transformedPoints[i]=transform.transform(points[i]);
+	}
+
+void AffinePointTransformNode::transformNormals(size_t numNormals,const Point* basePoints,const Vector* normals,Vector* transformedNormals) const
+	{
+	for(size_t i=0;i<numNormals;++i)
+		{
+		transformedNormals[i]=normalTransform.transform(normals[i]);
+		transformedNormals[i].normalize();
+		}
+	}
+
 }
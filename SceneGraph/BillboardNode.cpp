@@ -29,6 +29,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/EventTypes.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/DrawListCollector.h>
 
 namespace SceneGraph {
 
@@ -91,6 +92,9 @@ void BillboardNode::update(void)
 		orthoZAxis.normalize();
 		rotationNormal=Geometry::cross(axisOfRotation.getValue(),orthoZAxis);
 		}
+	
+	/* Cache the children's bounding boxes for culling: */
+	updateChildBoxes();
 	}
 
 void BillboardNode::glRenderAction(GLRenderState& renderState) const
@@ -131,12 +135,17 @@ void BillboardNode::glRenderAction(GLRenderState& renderState) const
 		previousTransform=renderState.pushTransform(transform);
 		}
 	
-	/* Call the render actions of all children in order: */
-	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-		(*chIt)->glRenderAction(renderState);
+	/* Call the render actions of all visible children in order: */
+	renderChildren(renderState);
 		
 	/* Pop the transformation off the matrix stack: */
 	renderState.popTransform(previousTransform);
 	}
 
+void BillboardNode::collectDrawItems(DrawListCollector& collector) const
+	{
+	/* The billboard transformation depends on the viewer; render the entire billboard through its render action, without culling: */
+	collector.addNode(*this,Box::empty);
+	}
+
 }
@@ -57,6 +57,7 @@ class BillboardNode:public GroupNode
 	
 	/* Methods from GraphNode: */
 	virtual void glRenderAction(GLRenderState& renderState) const;
+	virtual void collectDrawItems(DrawListCollector& collector) const;
 	};
 
 }
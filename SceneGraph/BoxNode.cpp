@@ -28,6 +28,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/EventTypes.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/TriangleCollector.h>
 
 namespace SceneGraph {
 
@@ -162,6 +163,9 @@ void BoxNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void BoxNode::update(void)
 	{
+	/* Bump up the geometry version number: */
+	GeometryNode::update();
+	
 	Point pmin=center.getValue();
 	Point pmax=center.getValue();
 	for(int i=0;i<3;++i)
@@ -190,4 +194,16 @@ void BoxNode::glRenderAction(GLRenderState& renderState) const
 	DisplayList::glRenderAction(renderState.contextData);
 	}
 
+
+void BoxNode::collectTriangles(TriangleCollector& collector) const
+	{
+	/* Add the box's six faces with outward-facing counter-clockwise vertex order: */
+	static const int faceVertices[6][4]=
+		{
+		{0,4,6,2},{1,3,7,5},{0,1,5,4},{2,6,7,3},{0,2,3,1},{4,5,7,6}
+		};
+	for(int face=0;face<6;++face)
+		collector.addQuad(box.getVertex(faceVertices[face][0]),box.getVertex(faceVertices[face][1]),box.getVertex(faceVertices[face][2]),box.getVertex(faceVertices[face][3]));
+	}
+
 }
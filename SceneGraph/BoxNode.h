@@ -62,6 +62,7 @@ class BoxNode:public GeometryNode,public DisplayList
 	/* Methods from GeometryNode: */
 	virtual Box calcBoundingBox(void) const;
 	virtual void glRenderAction(GLRenderState& renderState) const;
+	virtual void collectTriangles(TriangleCollector& collector) const;
 	
 	/* New methods: */
 	const Box& getBox(void) const // Returns the current derived box
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/ConeNode.h>
 
 #include <string.h>
+#include <vector>
 #include <Math/Math.h>
 #include <Math/Constants.h>
 #include <GL/gl.h>
@@ -30,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/EventTypes.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/TriangleCollector.h>
 
 namespace SceneGraph {
 
@@ -176,6 +178,9 @@ void ConeNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void ConeNode::update(void)
 	{
+	/* Bump up the geometry version number: */
+	GeometryNode::update();
+	
 	/* Invalidate the display list: */
 	DisplayList::update();
 	}
@@ -197,4 +202,40 @@ void ConeNode::glRenderAction(GLRenderState& renderState) const
 	DisplayList::glRenderAction(renderState.contextData);
 	}
 
+
+void ConeNode::collectTriangles(TriangleCollector& collector) const
+	{
+	Scalar h2=Math::div2(height.getValue());
+	Scalar br=bottomRadius.getValue();
+	int ns=numSegments.getValue();
+	if(ns<1)
+		return;
+	
+	/* Calculate the points around the cone's base in the same order as the renderer: */
+	std::vector<Point> base;
+	base.reserve(ns+1);
+	for(int i=0;i<ns;++i)
+		{
+		Scalar angle=Scalar(2)*Math::Constants<Scalar>::pi*Scalar(i)/Scalar(ns);
+		base.push_back(Point(-Math::sin(angle)*br,-h2,-Math::cos(angle)*br));
+		}
+	base.push_back(base.front());
+	
+	if(side.getValue())
+		{
+		/* Add the cone side: */
+		Point apex(Scalar(0),h2,Scalar(0));
+		for(int i=0;i<ns;++i)
+			collector.addTriangle(apex,base[i],base[i+1]);
+		}
+	
+	if(bottom.getValue())
+		{
+		/* Add the cone bottom: */
+		Point center(Scalar(0),-h2,Scalar(0));
+		for(int i=0;i<ns;++i)
+			collector.addTriangle(center,base[i+1],base[i]);
+		}
+	}
+
 }
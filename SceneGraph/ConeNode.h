@@ -59,6 +59,7 @@ class ConeNode:public GeometryNode,public DisplayList
 	/* Methods from GeometryNode: */
 	virtual Box calcBoundingBox(void) const;
 	virtual void glRenderAction(GLRenderState& renderState) const;
+	virtual void collectTriangles(TriangleCollector& collector) const;
 	};
 
 }
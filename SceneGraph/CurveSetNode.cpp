@@ -109,6 +109,9 @@ void CurveSetNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void CurveSetNode::update(void)
 	{
+	/* Bump up the geometry version number: */
+	GeometryNode::update();
+	
 	for(size_t fileIndex=0;fileIndex<url.getNumValues();++fileIndex)
 		{
 		/* Open the curve file: */
@@ -130,8 +133,7 @@ void CurveSetNode::update(void)
 				{
 				/* Read the next vertex: */
 				Point v;
-				for(int k=0;k<3;++k)
-					v[k]=Scalar(source.readNumber());
+				source.readNumbers(3,v.getComponents());
 				
 				/* Store the vertex: */
 				vertices.push_back(v);
@@ -143,6 +145,17 @@ void CurveSetNode::update(void)
 	++version;
 	}
 
+const std::vector<Point>& CurveSetNode::getVertices(std::vector<Point>& transformedVertices) const
+	{
+	if(pointTransform.getValue()==0||vertices.empty())
+		return vertices;
+	
+	/* Transform all vertices in one batch: */
+	transformedVertices.resize(vertices.size());
+	pointTransform.getValue()->transformPoints(vertices.size(),&vertices[0],&transformedVertices[0]);
+	return transformedVertices;
+	}
+
 Box CurveSetNode::calcBoundingBox(void) const
 	{
 	Box result=Box::empty;
@@ -189,34 +202,24 @@ void CurveSetNode::glRenderAction(GLRenderState& renderState) const
 		
 		if(dataItem->version!=version)
 			{
+			/* Get the curve vertices: */
+			std::vector<Point> transformedVertices;
+			const std::vector<Point>& vs=getVertices(transformedVertices);
+			
 			/* Allocate the vertex buffer: */
-			glBufferDataARB(GL_ARRAY_BUFFER_ARB,(vertices.size()+numVertices.size()*2)*sizeof(Vertex),0,GL_STATIC_DRAW_ARB);
+			glBufferDataARB(GL_ARRAY_BUFFER_ARB,(vs.size()+numVertices.size()*2)*sizeof(Vertex),0,GL_STATIC_DRAW_ARB);
 			Vertex* vPtr=static_cast<Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
 			
 			/* Copy curve vertices into the vertex buffer: */
-			for(std::vector<Point>::const_iterator vIt=vertices.begin();vIt!=vertices.end();++vIt)
-				{
-				if(pointTransform.getValue()!=0)
-					vPtr->position=pointTransform.getValue()->transformPoint(*vIt);
-				else
-					vPtr->position=*vIt;
-				++vPtr;
-				}
+			for(std::vector<Point>::const_iterator vIt=vs.begin();vIt!=vs.end();++vIt,++vPtr)
+				vPtr->position=*vIt;
 			
 			/* Copy curve end points into the vertex buffer: */
 			GLsizei baseIndex=0;
 			for(std::vector<GLsizei>::const_iterator nvIt=numVertices.begin();nvIt!=numVertices.end();++nvIt)
 				{
-				if(pointTransform.getValue()!=0)
-					{
-					vPtr[0].position=pointTransform.getValue()->transformPoint(vertices[baseIndex]);
-					vPtr[1].position=pointTransform.getValue()->transformPoint(vertices[baseIndex+*nvIt-1]);
-					}
-				else
-					{
-					vPtr[0].position=vertices[baseIndex];
-					vPtr[1].position=vertices[baseIndex+*nvIt-1];
-					}
+				vPtr[0].position=vs[baseIndex];
+				vPtr[1].position=vs[baseIndex+*nvIt-1];
 				vPtr+=2;
 				baseIndex+=*nvIt;
 				}
@@ -261,40 +264,33 @@ void CurveSetNode::glRenderAction(GLRenderState& renderState) const
 		Render the curve set directly:
 		*******************************************************************/
 		
+		/* Get the curve vertices: */
+		std::vector<Point> transformedVertices;
+		const std::vector<Point>& vs=getVertices(transformedVertices);
+		
 		/* Draw all curves: */
-		std::vector<Point>::const_iterator vIt=vertices.begin();
+		std::vector<Point>::const_iterator vIt=vs.begin();
 		for(std::vector<GLsizei>::const_iterator nvIt=numVertices.begin();nvIt!=numVertices.end();++nvIt)
 			{
 			/* Render the curve: */
 			glBegin(GL_LINE_STRIP);
 			for(GLsizei i=0;i<*nvIt;++i,++vIt)
-				{
-				if(pointTransform.getValue()!=0)
-					glVertex(pointTransform.getValue()->transformPoint(*vIt));
-				else
-					glVertex(*vIt);
-				}
+				glVertex(*vIt);
 			glEnd();
 			}
 		
 		/* Draw the endpoints of all curves: */
+		glBegin(GL_POINTS);
 		GLint baseVertexIndex=0;
 		for(std::vector<GLsizei>::const_iterator nvIt=numVertices.begin();nvIt!=numVertices.end();++nvIt)
 			{
-			if(pointTransform.getValue()!=0)
-				{
-				glVertex(pointTransform.getValue()->transformPoint(vertices[baseVertexIndex]));
-				glVertex(pointTransform.getValue()->transformPoint(vertices[baseVertexIndex+*nvIt-1]));
-				}
-			else
-				{
-				glVertex(vertices[baseVertexIndex]);
-				glVertex(vertices[baseVertexIndex+*nvIt-1]);
-				}
+			glVertex(vs[baseVertexIndex]);
+			glVertex(vs[baseVertexIndex+*nvIt-1]);
 			
 			/* Go to the next curve: */
 			baseVertexIndex+=*nvIt;
 			}
+		glEnd();
 		}
 	}
 
@@ -67,6 +67,9 @@ class CurveSetNode:public GeometryNode,public GLObject
 	std::vector<Point> vertices; // Array of vertices for all curves
 	unsigned int version; // Version number of curve set
 	
+	/* Protected methods: */
+	const std::vector<Point>& getVertices(std::vector<Point>& transformedVertices) const; // Returns the curve vertices, transformed in one batch into the given list if there is a point transformation
+	
 	/* Constructors and destructors: */
 	public:
 	CurveSetNode(void); // Creates an empty curve set
@@ -23,6 +23,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/CylinderNode.h>
 
 #include <string.h>
+#include <vector>
 #include <Math/Math.h>
 #include <Math/Constants.h>
 #include <GL/gl.h>
@@ -30,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLVertexTemplates.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/TriangleCollector.h>
 
 namespace SceneGraph {
 
@@ -170,6 +172,9 @@ void CylinderNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void CylinderNode::update(void)
 	{
+	/* Bump up the geometry version number: */
+	GeometryNode::update();
+	
 	/* Invalidate the display list: */
 	DisplayList::update();
 	}
@@ -191,4 +196,52 @@ void CylinderNode::glRenderAction(GLRenderState& renderState) const
 	DisplayList::glRenderAction(renderState.contextData);
 	}
 
+
+void CylinderNode::collectTriangles(TriangleCollector& collector) const
+	{
+	Scalar h2=Math::div2(height.getValue());
+	Scalar r=radius.getValue();
+	int ns=numSegments.getValue();
+	if(ns<1)
+		return;
+	
+	/* Calculate the points around the cylinder's bottom and top in the same order as the renderer: */
+	std::vector<Point> bottomRing,topRing;
+	bottomRing.reserve(ns+1);
+	topRing.reserve(ns+1);
+	for(int i=0;i<ns;++i)
+		{
+		Scalar angle=Scalar(2)*Math::Constants<Scalar>::pi*Scalar(i)/Scalar(ns);
+		Scalar c=Math::cos(angle);
+		Scalar s=Math::sin(angle);
+		bottomRing.push_back(Point(-s*r,-h2,-c*r));
+		topRing.push_back(Point(-s*r,h2,-c*r));
+		}
+	bottomRing.push_back(bottomRing.front());
+	topRing.push_back(topRing.front());
+	
+	if(side.getValue())
+		{
+		/* Add the cylinder side: */
+		for(int i=0;i<ns;++i)
+			collector.addQuad(topRing[i],bottomRing[i],bottomRing[i+1],topRing[i+1]);
+		}
+	
+	if(bottom.getValue())
+		{
+		/* Add the cylinder bottom: */
+		Point center(Scalar(0),-h2,Scalar(0));
+		for(int i=0;i<ns;++i)
+			collector.addTriangle(center,bottomRing[i+1],bottomRing[i]);
+		}
+	
+	if(top.getValue())
+		{
+		/* Add the cylinder top: */
+		Point center(Scalar(0),h2,Scalar(0));
+		for(int i=0;i<ns;++i)
+			collector.addTriangle(center,topRing[i],topRing[i+1]);
+		}
+	}
+
 }
@@ -0,0 +1,86 @@
+/***********************************************************************
+DirtyRangeHistory - Class to record which ranges of a node's derived
+arrays changed in its most recent versions, to let OpenGL contexts
+holding older versions update only the changed parts of their buffers.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/DirtyRangeHistory.h>
+
+namespace SceneGraph {
+
+/**********************************
+Methods of class DirtyRangeHistory:
+**********************************/
+
+void DirtyRangeHistory::addFullChange(void)
+	{
+	++version;
+	numRanges=0;
+	}
+
+void DirtyRangeHistory::addRangeChange(size_t begin,size_t end)
+	{
+	/* Contexts holding the initial version have not received any elements yet, so the first version always changes all elements: */
+	if(version==0)
+		{
+		addFullChange();
+		return;
+		}
+	
+	++version;
+	begins[version%maxNumRanges]=begin;
+	ends[version%maxNumRanges]=end;
+	if(numRanges<maxNumRanges)
+		++numRanges;
+	}
+
+bool DirtyRangeHistory::getRangeSince(unsigned int sinceVersion,size_t& begin,size_t& end) const
+	{
+	/* Bail out if any of the versions since the given one changed all elements, or is no longer remembered: */
+	unsigned int numVersions=version-sinceVersion;
+	if(numVersions>numRanges)
+		return false;
+	
+	/* Combine the ranges of all versions since the given one: */
+	begin=end=0;
+	for(unsigned int i=0;i<numVersions;++i)
+		{
+		unsigned int index=(version-i)%maxNumRanges;
+		if(begins[index]<ends[index])
+			{
+			if(begin>=end)
+				{
+				begin=begins[index];
+				end=ends[index];
+				}
+			else
+				{
+				if(begin>begins[index])
+					begin=begins[index];
+				if(end<ends[index])
+					end=ends[index];
+				}
+			}
+		}
+	
+	return true;
+	}
+
+}
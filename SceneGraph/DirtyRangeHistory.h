@@ -0,0 +1,62 @@
+/***********************************************************************
+DirtyRangeHistory - Class to record which ranges of a node's derived
+arrays changed in its most recent versions, to let OpenGL contexts
+holding older versions update only the changed parts of their buffers.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_DIRTYRANGEHISTORY_INCLUDED
+#define SCENEGRAPH_DIRTYRANGEHISTORY_INCLUDED
+
+#include <stddef.h>
+
+namespace SceneGraph {
+
+class DirtyRangeHistory
+	{
+	/* Embedded classes: */
+	public:
+	static const unsigned int maxNumRanges=8; // Number of most recent versions whose changed ranges are remembered
+	
+	/* Elements: */
+	private:
+	unsigned int version; // Current version number
+	unsigned int numRanges; // Number of most recent versions that changed only a range of elements
+	size_t begins[maxNumRanges],ends[maxNumRanges]; // Half-open element ranges changed by the most recent versions, indexed by version number modulo maxNumRanges
+	
+	/* Constructors and destructors: */
+	public:
+	DirtyRangeHistory(void) // Creates a history at the initial version, which contexts use to mark that they hold no elements
+		:version(0),numRanges(0)
+		{
+		}
+	
+	/* Methods: */
+	unsigned int getVersion(void) const // Returns the current version number
+		{
+		return version;
+		}
+	void addFullChange(void); // Starts a new version in which all elements changed
+	void addRangeChange(size_t begin,size_t end); // Starts a new version in which only the elements in the given half-open range changed
+	bool getRangeSince(unsigned int sinceVersion,size_t& begin,size_t& end) const; // Returns a half-open range covering all elements changed since the given version, or false if all elements have to be updated
+	};
+
+}
+
+#endif
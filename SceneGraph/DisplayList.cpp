@@ -68,9 +68,9 @@ void DisplayList::glRenderAction(GLContextData& contextData) const
 	if(dataItem->version!=version)
 		{
 		/* Upload the new geometry into the display list: */
-		glNewList(dataItem->displayListId,GL_COMPILE_AND_EXECUTE);
+		contextData.newList(dataItem->displayListId,GL_COMPILE_AND_EXECUTE);
 		createList(contextData);
-		glEndList();
+		contextData.endList();
 		
 		/* Mark the display list as up-to-date: */
 		dataItem->version=version;
@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/Internal/Doom3MaterialManager.h>
 #include <SceneGraph/Internal/Doom3MD5Mesh.h>
 
 namespace SceneGraph {
@@ -102,6 +103,9 @@ void Doom3MD5MeshNode::glRenderAction(GLRenderState& renderState) const
 	{
 	if(mesh!=0)
 		{
+		/* Evaluate time-varying material expressions for the current frame: */
+		dataContext.getValue()->getMaterialManager()->setTime(float(renderState.time));
+		
 		/* Draw the mesh: */
 		mesh->drawSurface(renderState.contextData,false);
 		}
@@ -116,7 +116,8 @@ void Doom3ModelNode::glRenderAction(GLRenderState& renderState) const
 		glPushAttrib(GL_POLYGON_BIT);
 		glFrontFace(GL_CW);
 		
-		/* Initialize the material manager: */
+		/* Evaluate time-varying material expressions for the current frame and initialize the material manager: */
+		dataContext.getValue()->getMaterialManager()->setTime(float(renderState.time));
 		Doom3MaterialManager::RenderContext mmRc=dataContext.getValue()->getMaterialManager()->start(renderState.contextData,false);
 		
 		/* Draw the model: */
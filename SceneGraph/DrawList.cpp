@@ -0,0 +1,162 @@
+/***********************************************************************
+DrawList - Class to flatten a scene graph into a list of draw items in
+root coordinates, built in parallel, which can be rendered from several
+windows without traversing the scene graph.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/DrawList.h>
+
+#include <algorithm>
+#include <functional>
+#include <Threads/ParallelFor.h>
+#include <SceneGraph/GraphNode.h>
+#include <SceneGraph/ShapeNode.h>
+#include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/Internal/BackgroundJobs.h>
+
+namespace SceneGraph {
+
+/************************************************
+Declaration of struct DrawList::SubtreeCollector:
+************************************************/
+
+struct DrawList::SubtreeCollector:public FrameLoopBody
+	{
+	/* Elements: */
+	public:
+	const std::vector<DrawListCollector::DeferredSubtree>& subtrees; // List of deferred subtrees
+	std::vector<std::vector<Item> > results; // Draw items collected from each deferred subtree
+	
+	/* Constructors and destructors: */
+	SubtreeCollector(const std::vector<DrawListCollector::DeferredSubtree>& sSubtrees)
+		:subtrees(sSubtrees),results(sSubtrees.size())
+		{
+		}
+	
+	/* Methods from FrameLoopBody: */
+	virtual void operator()(size_t index)
+		{
+		/* Collect the subtree's draw items into its own result list: */
+		const DrawListCollector::DeferredSubtree& ds=subtrees[index];
+		DrawListCollector collector(ds.transform,~0U);
+		collector.collectChild(*ds.node);
+		std::swap(results[index],collector.getItems());
+		}
+	};
+
+/*****************************************
+Declaration of struct DrawList::ItemOrder:
+*****************************************/
+
+struct DrawList::ItemOrder
+	{
+	/* Methods: */
+	public:
+	bool operator()(const Item& i1,const Item& i2) const
+		{
+		/* Render state-sortable shapes first, sorted by texture and material, and all other items last in traversal order: */
+		if(i1.stateSorted!=i2.stateSorted)
+			return i1.stateSorted;
+		if(i1.stateSorted)
+			{
+			if(i1.texture!=i2.texture)
+				return std::less<const TextureNode*>()(i1.texture,i2.texture);
+			if(i1.material!=i2.material)
+				return std::less<const MaterialNode*>()(i1.material,i2.material);
+			}
+		return false;
+		}
+	};
+
+/*************************
+Methods of class DrawList:
+*************************/
+
+DrawList::DrawList(unsigned int sMaxNumThreads)
+	:maxNumThreads(sMaxNumThreads)
+	{
+	if(maxNumThreads==0)
+		maxNumThreads=Threads::getNumParallelForThreads();
+	}
+
+void DrawList::build(const GraphNode& root)
+	{
+	/* Collect the top levels of the scene graph, deepening the split until there are enough independent subtrees to keep all threads busy: */
+	unsigned int targetNumSubtrees=maxNumThreads*4;
+	DrawListCollector top(OGTransform::identity,maxNumThreads>1?1U:~0U);
+	top.collectChild(root);
+	for(unsigned int splitDepth=2;splitDepth<=8&&!top.getDeferredSubtrees().empty()&&top.getDeferredSubtrees().size()<targetNumSubtrees;++splitDepth)
+		{
+		DrawListCollector deeper(OGTransform::identity,splitDepth);
+		deeper.collectChild(root);
+		
+		/* Stop if the scene graph does not branch any further: */
+		if(deeper.getDeferredSubtrees().size()<=top.getDeferredSubtrees().size())
+			break;
+		
+		std::swap(top,deeper);
+		}
+	
+	/* Collect all deferred subtrees in parallel: */
+	const std::vector<DrawListCollector::DeferredSubtree>& subtrees=top.getDeferredSubtrees();
+	SubtreeCollector collector(subtrees);
+	runFrameLoop(subtrees.size(),collector,maxNumThreads);
+	
+	/* Merge the top-level items and the deferred subtrees' items in traversal order: */
+	const std::vector<Item>& topItems=top.getItems();
+	items.clear();
+	std::vector<Item>::const_iterator tiIt=topItems.begin();
+	for(size_t i=0;i<subtrees.size();++i)
+		{
+		std::vector<Item>::const_iterator tiEnd=topItems.begin()+subtrees[i].itemIndex;
+		items.insert(items.end(),tiIt,tiEnd);
+		tiIt=tiEnd;
+		items.insert(items.end(),collector.results[i].begin(),collector.results[i].end());
+		}
+	items.insert(items.end(),tiIt,topItems.end());
+	
+	/* Sort the draw items to minimize OpenGL state changes: */
+	std::stable_sort(items.begin(),items.end(),ItemOrder());
+	}
+
+void DrawList::glRenderAction(GLRenderState& renderState) const
+	{
+	GLRenderState::CullingStatistics& stats=renderState.cullingStatistics;
+	
+	/* Render all draw items: */
+	for(std::vector<Item>::const_iterator iIt=items.begin();iIt!=items.end();++iIt)
+		{
+		/* Skip the item if it is outside the view frustum or too small: */
+		++stats.numVisited;
+		if(renderState.cullBox(iIt->box))
+			continue;
+		++stats.numDrawn;
+		
+		/* Render the item in its model coordinates: */
+		OGTransform previousTransform=renderState.pushTransform(iIt->transform);
+		if(iIt->shape!=0)
+			iIt->shape->glRenderShape(renderState);
+		else
+			iIt->node->glRenderAction(renderState);
+		renderState.popTransform(previousTransform);
+		}
+	}
+
+}
@@ -0,0 +1,66 @@
+/***********************************************************************
+DrawList - Class to flatten a scene graph into a list of draw items in
+root coordinates, built in parallel, which can be rendered from several
+windows without traversing the scene graph.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_DRAWLIST_INCLUDED
+#define SCENEGRAPH_DRAWLIST_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <SceneGraph/DrawListCollector.h>
+
+/* Forward declarations: */
+namespace SceneGraph {
+class GraphNode;
+class GLRenderState;
+}
+
+namespace SceneGraph {
+
+class DrawList
+	{
+	/* Embedded classes: */
+	private:
+	typedef DrawListCollector::Item Item;
+	struct SubtreeCollector; // Loop body collecting deferred subtrees in parallel
+	struct ItemOrder; // Functor to sort draw items by OpenGL state
+	
+	/* Elements: */
+	unsigned int maxNumThreads; // Maximum number of threads used to build the draw list
+	std::vector<Item> items; // List of draw items in rendering order
+	
+	/* Constructors and destructors: */
+	public:
+	DrawList(unsigned int sMaxNumThreads =0); // Creates an empty draw list built by at most the given number of threads; 0 uses the default number of parallel threads
+	
+	/* Methods: */
+	size_t getNumItems(void) const // Returns the number of draw items
+		{
+		return items.size();
+		}
+	void build(const GraphNode& root); // Replaces the draw list with the flattened scene graph below the given root node; root must not be changed concurrently; the draw list refers to the graph's nodes and must be rebuilt after any change to the graph before it is rendered again
+	void glRenderAction(GLRenderState& renderState) const; // Renders all draw items that survive frustum and screen-size culling; the render state must be at its initial transformation; can be called concurrently from several rendering threads
+	};
+
+}
+
+#endif
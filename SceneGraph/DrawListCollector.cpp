@@ -0,0 +1,115 @@
+/***********************************************************************
+DrawListCollector - Class encapsulating the traversal state of a scene
+graph while flattening it into a list of draw items in root coordinates.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/DrawListCollector.h>
+
+#include <SceneGraph/GraphNode.h>
+#include <SceneGraph/ShapeNode.h>
+#include <SceneGraph/AppearanceNode.h>
+#include <SceneGraph/MaterialNode.h>
+#include <SceneGraph/TextureNode.h>
+
+namespace SceneGraph {
+
+/**********************************
+Methods of class DrawListCollector:
+**********************************/
+
+DrawListCollector::DrawListCollector(const OGTransform& sTransform,unsigned int sSplitDepth)
+	:currentTransform(sTransform),
+	 depth(0),splitDepth(sSplitDepth)
+	{
+	}
+
+OGTransform DrawListCollector::pushTransform(const OGTransform& deltaTransform)
+	{
+	/* Update the current transformation: */
+	OGTransform result=currentTransform;
+	currentTransform*=deltaTransform;
+	currentTransform.renormalize();
+	
+	return result;
+	}
+
+void DrawListCollector::popTransform(const OGTransform& previousTransform)
+	{
+	/* Reinstate the current transformation: */
+	currentTransform=previousTransform;
+	}
+
+void DrawListCollector::collectChild(const GraphNode& child)
+	{
+	if(depth>=splitDepth)
+		{
+		/* Remember the child and where its items belong: */
+		DeferredSubtree ds;
+		ds.node=&child;
+		ds.transform=currentTransform;
+		ds.itemIndex=items.size();
+		deferredSubtrees.push_back(ds);
+		}
+	else
+		{
+		/* Collect the child's items: */
+		++depth;
+		child.collectDrawItems(*this);
+		--depth;
+		}
+	}
+
+void DrawListCollector::addNode(const GraphNode& node,const Box& box)
+	{
+	Item item;
+	item.node=&node;
+	item.shape=0;
+	item.transform=currentTransform;
+	item.box=box;
+	item.box.transform(currentTransform);
+	item.texture=0;
+	item.material=0;
+	item.stateSorted=false;
+	items.push_back(item);
+	}
+
+void DrawListCollector::addShape(const ShapeNode& shape,const Box& box)
+	{
+	Item item;
+	item.node=&shape;
+	item.shape=&shape;
+	item.transform=currentTransform;
+	item.box=box;
+	item.box.transform(currentTransform);
+	item.texture=0;
+	item.material=0;
+	item.stateSorted=true;
+	const AppearanceNode* appearance=shape.appearance.getValue().getPointer();
+	if(appearance!=0)
+		{
+		item.texture=appearance->texture.getValue().getPointer();
+		item.material=appearance->material.getValue().getPointer();
+		if(item.material!=0&&item.material->transparency.getValue()>0.0f)
+			item.stateSorted=false;
+		}
+	items.push_back(item);
+	}
+
+}
@@ -0,0 +1,106 @@
+/***********************************************************************
+DrawListCollector - Class encapsulating the traversal state of a scene
+graph while flattening it into a list of draw items in root coordinates.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_DRAWLISTCOLLECTOR_INCLUDED
+#define SCENEGRAPH_DRAWLISTCOLLECTOR_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Geometry/Box.h>
+#include <Geometry/OrthogonalTransformation.h>
+#include <SceneGraph/Geometry.h>
+
+/* Forward declarations: */
+namespace SceneGraph {
+class GraphNode;
+class ShapeNode;
+class TextureNode;
+class MaterialNode;
+}
+
+namespace SceneGraph {
+
+class DrawListCollector
+	{
+	/* Embedded classes: */
+	public:
+	struct Item // Structure for draw items
+		{
+		/* Elements: */
+		public:
+		const GraphNode* node; // Node to render
+		const ShapeNode* shape; // The node as a shape node whose appearance is known, or null if the node is rendered through its render action
+		OGTransform transform; // Transformation from the node's model coordinates to root coordinates
+		Box box; // Bounding box of the node in root coordinates, or an empty box if the node must not be culled
+		const TextureNode* texture; // Shape's texture node, or null
+		const MaterialNode* material; // Shape's material node, or null
+		bool stateSorted; // Flag whether the item can be reordered by OpenGL state, i.e., is an opaque shape
+		};
+	
+	struct DeferredSubtree // Structure for subtrees whose items are collected later, typically in parallel
+		{
+		/* Elements: */
+		public:
+		const GraphNode* node; // Root node of the subtree
+		OGTransform transform; // Transformation from the subtree root's parent's model coordinates to root coordinates
+		size_t itemIndex; // Index in the item list at which the subtree's items have to be inserted
+		};
+	
+	/* Elements: */
+	private:
+	OGTransform currentTransform; // Transformation from current model coordinates to root coordinates
+	unsigned int depth; // Current nesting depth of collected nodes
+	unsigned int splitDepth; // Nesting depth at which nodes are deferred instead of collected
+	std::vector<Item> items; // List of collected draw items
+	std::vector<DeferredSubtree> deferredSubtrees; // List of deferred subtrees in traversal order
+	
+	/* Constructors and destructors: */
+	public:
+	DrawListCollector(const OGTransform& sTransform,unsigned int sSplitDepth); // Creates an empty collector with the given initial transformation that defers nodes at the given nesting depth; a split depth of ~0 defers nothing
+	
+	/* Methods: */
+	const OGTransform& getTransform(void) const // Returns the transformation from current model coordinates to root coordinates
+		{
+		return currentTransform;
+		}
+	OGTransform pushTransform(const OGTransform& deltaTransform); // Appends the given transformation to the current transformation and returns the previous transformation
+	void popTransform(const OGTransform& previousTransform); // Resets the current transformation; must be result from previous pushTransform call
+	void collectChild(const GraphNode& child); // Collects the draw items of the given child node of the current node, or defers it if the split depth is reached
+	void addNode(const GraphNode& node,const Box& box); // Adds a node rendered through its render action with the given bounding box in current model coordinates
+	void addShape(const ShapeNode& shape,const Box& box); // Adds a shape node with the given bounding box in current model coordinates
+	const std::vector<Item>& getItems(void) const // Returns the list of collected draw items
+		{
+		return items;
+		}
+	std::vector<Item>& getItems(void) // Ditto
+		{
+		return items;
+		}
+	const std::vector<DeferredSubtree>& getDeferredSubtrees(void) const // Returns the list of deferred subtrees
+		{
+		return deferredSubtrees;
+		}
+	};
+
+}
+
+#endif
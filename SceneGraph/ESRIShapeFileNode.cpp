@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/ESRIShapeFileNode.h>
 
 #include <string.h>
+#include <algorithm>
 #include <Misc/SelfDestructPointer.h>
 #include <Misc/ThrowStdErr.h>
 #include <IO/File.h>
@@ -61,27 +62,21 @@ struct GeographicProjection // Structure for geographic map projections
 	double primeMeridianOffset; // Offset to WGS 84 prime meridian in radians
 	
 	/* Methods: */
-	Point toCartesian(double x,double y,double z) const // Transforms a point in geographic coordinates to Cartesian coordinates
+	void toCartesian(size_t numPoints,Geometry::Point<double,3>* points) const // Transforms an array of points from geographic coordinates to Cartesian coordinates in-place
 		{
-		/* Assemble the source point's proper geodetic coordinates: */
-		Geometry::Geoid<double>::Point geodetic;
-		if(longitudeFirst)
+		/* Assemble the source points' proper geodetic coordinates: */
+		for(size_t i=0;i<numPoints;++i)
 			{
-			geodetic[0]=x;
-			geodetic[1]=y;
+			Geometry::Point<double,3>& p=points[i];
+			if(!longitudeFirst)
+				std::swap(p[0],p[1]);
+			p[0]*=longitudeFactor;
+			p[0]+=primeMeridianOffset;
+			p[1]*=latitudeFactor;
 			}
-		else
-			{
-			geodetic[0]=y;
-			geodetic[1]=x;
-			}
-		geodetic[0]*=longitudeFactor;
-		geodetic[0]+=primeMeridianOffset;
-		geodetic[1]*=latitudeFactor;
-		geodetic[2]=z;
 		
-		/* Convert the point to Cartesian: */
-		return geoid.geodeticToCartesian(geodetic);
+		/* Convert all points to Cartesian in one go: */
+		geoid.geodeticToCartesian(numPoints,points,points);
 		}
 	};
 
@@ -102,10 +97,15 @@ class MapProjection // Base class for map projections
 		{
 		geoProjection=newGeoProjection;
 		}
-	virtual Point toCartesian(double x,double y,double z) const // Transforms a point in projected coordinates to Cartesian coordinates
+	virtual void toGeographic(size_t numPoints,Geometry::Point<double,3>* points) const // Transforms an array of points from projected coordinates to geographic coordinates in-place
 		{
-		/* Pass the point directly to the geodetic projection: */
-		return geoProjection.toCartesian(x,y,z);
+		/* Points are already in geographic coordinates: */
+		}
+	void toCartesian(size_t numPoints,Geometry::Point<double,3>* points) const // Transforms an array of points from projected coordinates to Cartesian coordinates in-place
+		{
+		/* Unproject the points and pass them to the geodetic projection: */
+		toGeographic(numPoints,points);
+		geoProjection.toCartesian(numPoints,points);
 		}
 	};
 
@@ -121,21 +121,26 @@ class AlbersProjection:public MapProjection // Class for Albers equal-area conic
 	double a,e2,e,n,c,rho0; // Derived projection coefficients
 	
 	/* Methods from MapProjection: */
-	virtual Point toCartesian(double x,double y,double z) const
+	virtual void toGeographic(size_t numPoints,Geometry::Point<double,3>* points) const
 		{
-		x=(x-offset[0])*unitFactor;
-		y=(y-offset[1])*unitFactor;
-		
-		double longitude=centralMeridian+Math::atan(x/(rho0-y))/n;
-		
-		double rho=Math::sqrt(Math::sqr(x)+Math::sqr(rho0-y));
-		double q=(c-Math::sqr(rho*n/a))/n;
-		double beta=Math::asin(q/(1.0-((1.0-e2)/(2.0*e))*Math::log((1.0-e)/(1.0+e))));
-		double latitude=beta
-		                +(e2*(1.0/3.0+e2*(31.0/180.0+e2*517.0/5040.0)))*Math::sin(2.0*beta)
-		                +(e2*e2*(23.0/360.0+e2*251.0/3780.0))*Math::sin(4.0*beta)
-		                +(e2*e2*e2*761.0/45360.0)*Math::sin(6.0*beta);
-		return geoProjection.toCartesian(longitude,latitude,z);
+		double betaDenominator=1.0-((1.0-e2)/(2.0*e))*Math::log((1.0-e)/(1.0+e));
+		for(size_t i=0;i<numPoints;++i)
+			{
+			double x=(points[i][0]-offset[0])*unitFactor;
+			double y=(points[i][1]-offset[1])*unitFactor;
+			
+			double longitude=centralMeridian+Math::atan(x/(rho0-y))/n;
+			
+			double rho=Math::sqrt(Math::sqr(x)+Math::sqr(rho0-y));
+			double q=(c-Math::sqr(rho*n/a))/n;
+			double beta=Math::asin(q/betaDenominator);
+			double latitude=beta
+			                +(e2*(1.0/3.0+e2*(31.0/180.0+e2*517.0/5040.0)))*Math::sin(2.0*beta)
+			                +(e2*e2*(23.0/360.0+e2*251.0/3780.0))*Math::sin(4.0*beta)
+			                +(e2*e2*e2*761.0/45360.0)*Math::sin(6.0*beta);
+			points[i][0]=longitude;
+			points[i][1]=latitude;
+			}
 		}
 	
 	/* New methods: */
@@ -714,17 +719,13 @@ void readPointArray(IO::File& shapeFile,int numPoints,bool readZ,bool readM,cons
 		shapeFile.skip<double>(numPoints);
 		}
 	
-	/* Store all points in the point set: */
+	/* Project all points to Cartesian coordinates in one batch: */
 	if(projection!=0)
-		{
-		for(int i=0;i<numPoints;++i)
-			coord->point.appendValue(projection->toCartesian(ps[i][0],ps[i][1],ps[i][2]));
-		}
-	else
-		{
-		for(int i=0;i<numPoints;++i)
-			coord->point.appendValue(ps[i]);
-		}
+		projection->toCartesian(numPoints,ps);
+	
+	/* Store all points in the point set: */
+	for(int i=0;i<numPoints;++i)
+		coord->point.appendValue(ps[i]);
 	
 	delete[] ps;
 	}
@@ -954,14 +955,14 @@ void ESRIShapeFileNode::update(void)
 			case POINTM:
 				{
 				/* Read a single point: */
-				double px=shapeFile->read<double>();
-				double py=shapeFile->read<double>();
-				double pz=0.0;
+				Geometry::Point<double,3> p;
+				shapeFile->read<double>(p.getComponents(),2);
+				p[2]=0.0;
 				
 				if(recordShapeType==POINTZ)
 					{
 					/* Read the point's z component: */
-					pz=shapeFile->read<double>();
+					p[2]=shapeFile->read<double>();
 					}
 				
 				if(recordShapeType==POINTZ||recordShapeType==POINTM)
@@ -974,9 +975,8 @@ void ESRIShapeFileNode::update(void)
 				isPolyline=false;
 				recordNumPoints=1;
 				if(projection!=0)
-					pointsCoord->point.appendValue(projection->toCartesian(px,py,pz));
-				else
-					pointsCoord->point.appendValue(Point(px,py,pz));
+					projection->toCartesian(1,&p);
+				pointsCoord->point.appendValue(p);
 				
 				break;
 				}
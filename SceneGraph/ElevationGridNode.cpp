@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/ElevationGridNode.h>
 
 #include <string.h>
+#include <vector>
 #include <GL/gl.h>
 #include <GL/GLColorTemplates.h>
 #include <GL/GLContextData.h>
@@ -32,10 +33,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/Extensions/GLARBVertexBufferObject.h>
 #include <GL/GLGeometryWrappers.h>
 #include <GL/GLGeometryVertex.h>
+#include <Threads/ParallelFor.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/TriangleCollector.h>
 
 #include <SceneGraph/Internal/LoadElevationGrid.h>
+#include <SceneGraph/Internal/BackgroundJobs.h>
 
 namespace SceneGraph {
 
@@ -45,7 +49,8 @@ Methods of class ElevationGridNode::DataItem:
 
 ElevationGridNode::DataItem::DataItem(void)
 	:vertexBufferObjectId(0),indexBufferObjectId(0),
-	 version(0)
+	 version(0),
+	 frameNumber(0),numUploadsInFrame(0)
 	{
 	if(GLARBVertexBufferObject::isSupported())
 		{
@@ -62,6 +67,9 @@ ElevationGridNode::DataItem::DataItem(void)
 
 ElevationGridNode::DataItem::~DataItem(void)
 	{
+	/* Destroy all tile vertex buffer objects: */
+	releaseTiles();
+	
 	/* Destroy the vertex buffer object: */
 	if(vertexBufferObjectId!=0)
 		glDeleteBuffersARB(1,&vertexBufferObjectId);
@@ -71,6 +79,98 @@ ElevationGridNode::DataItem::~DataItem(void)
 		glDeleteBuffersARB(1,&indexBufferObjectId);
 	}
 
+void ElevationGridNode::DataItem::releaseTiles(void)
+	{
+	for(std::list<int>::iterator lIt=tileLru.begin();lIt!=tileLru.end();++lIt)
+		{
+		glDeleteBuffersARB(1,&tileBuffers[*lIt].bufferId);
+		tileBuffers[*lIt].bufferId=0;
+		}
+	tileLru.clear();
+	}
+
+/*********************************************************
+Declaration of class ElevationGridNode::TileGenerationJob:
+*********************************************************/
+
+class ElevationGridNode::TileGenerationJob:public Threads::WorkerPool::Job
+	{
+	/* Elements: */
+	private:
+	const ElevationGridNode* node; // The elevation grid; kept alive by the node's destructor waiting for all pending jobs
+	int tileIndex; // Index of the tile to generate
+	
+	/* Constructors and destructors: */
+	public:
+	TileGenerationJob(const ElevationGridNode* sNode,int sTileIndex)
+		:node(sNode),tileIndex(sTileIndex)
+		{
+		}
+	
+	/* Methods from Threads::WorkerPool::Job: */
+	virtual void execute(void)
+		{
+		try
+			{
+			/* Generate the tile's vertices and store them in the cache: */
+			node->storeTileVertices(tileIndex,node->generateTileVertices(tileIndex));
+			}
+		catch(...)
+			{
+			/* Clear the request flag to retry the tile later: */
+			Threads::Mutex::Lock tileVerticesLock(node->tileVerticesMutex);
+			node->tileRequested[tileIndex]=false;
+			}
+		
+		/* Signal job completion: */
+		Threads::MutexCond::Lock tileJobsLock(node->tileJobsCond);
+		--node->numTileJobs;
+		node->tileJobsCond.broadcast();
+		}
+	};
+
+/************************************************************
+Declaration of class ElevationGridNode::TileBoundsCalculator:
+************************************************************/
+
+struct ElevationGridNode::TileBoundsCalculator
+	{
+	/* Elements: */
+	public:
+	ElevationGridNode* node;
+	const std::vector<int>* leaves; // List of indices of leaf tiles
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end)
+		{
+		for(size_t i=begin;i<end;++i)
+			node->calcTileBounds(node->tiles[(*leaves)[i]]);
+		}
+	};
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const unsigned int maxTileUploadsPerFrame=8; // Maximum number of tiles uploaded to an OpenGL context while rendering one frame
+
+Scalar sqrDist(const Point& p,const Box& box) // Returns the squared distance from a point to a box
+	{
+	Scalar result(0);
+	for(int i=0;i<3;++i)
+		{
+		if(p[i]<box.min[i])
+			result+=Math::sqr(box.min[i]-p[i]);
+		else if(p[i]>box.max[i])
+			result+=Math::sqr(p[i]-box.max[i]);
+		}
+	return result;
+	}
+
+}
+
 /**********************************
 Methods of class ElevationGridNode:
 **********************************/
@@ -100,66 +200,120 @@ Vector ElevationGridNode::calcVertexNormal(int x,int z) const
 	return result;
 	}
 
-void ElevationGridNode::uploadIndexedQuadStripSet(void) const
+unsigned int ElevationGridNode::calcLayoutVersion(void) const
+	{
+	/* Field versions only ever increase, so their sum changes whenever any of the fields changes: */
+	unsigned int result=texCoord.getVersion()+color.getVersion()+colorPerVertex.getVersion()+normal.getVersion()+normalPerVertex.getVersion();
+	result+=origin.getVersion()+xDimension.getVersion()+xSpacing.getVersion()+zDimension.getVersion()+zSpacing.getVersion();
+	result+=heightUrl.getVersion()+heightIsY.getVersion()+ccw.getVersion()+tileSize.getVersion()+pointTransform.getVersion();
+	return result;
+	}
+
+unsigned int ElevationGridNode::calcAttributeVersion(void) const
+	{
+	unsigned int result=0;
+	if(texCoord.getValue()!=0)
+		result+=texCoord.getValue()->point.getVersion();
+	if(color.getValue()!=0)
+		result+=color.getValue()->color.getVersion();
+	if(normal.getValue()!=0)
+		result+=normal.getValue()->vector.getVersion();
+	return result;
+	}
+
+void ElevationGridNode::storeGridVertices(size_t begin,size_t end,ElevationGridNode::Vertex* vertices) const
 	{
-	/* Define the vertex type used in the vertex array: */
-	typedef GLGeometry::Vertex<Scalar,2,GLubyte,4,Scalar,Scalar,3> Vertex;
-	
-	/* Initialize the vertex buffer object: */
 	int xDim=xDimension.getValue();
 	int zDim=zDimension.getValue();
 	Scalar xSp=xSpacing.getValue();
 	Scalar zSp=zSpacing.getValue();
-	glBufferDataARB(GL_ARRAY_BUFFER_ARB,xDim*zDim*sizeof(Vertex),0,GL_STATIC_DRAW_ARB);
 	
-	/* Store all vertices: */
-	Vertex* vPtr=static_cast<Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
-	size_t vInd=0;
-	for(int z=0;z<zDim;++z)
-		for(int x=0;x<xDim;++x,++vPtr,++vInd)
+	/* Create arrays to batch-transform vertex positions and normal vectors if there is a point transformation: */
+	const PointTransformNode* pt=pointTransform.getValue().getPointer();
+	std::vector<Point> points;
+	std::vector<Vector> normals;
+	if(pt!=0)
+		{
+		points.resize(end-begin);
+		normals.resize(end-begin);
+		}
+	
+	/* Store all vertices in the range: */
+	Vertex* vPtr=vertices;
+	for(size_t vInd=begin;vInd<end;++vInd,++vPtr)
+		{
+		int x=int(vInd%size_t(xDim));
+		int z=int(vInd/size_t(xDim));
+		
+		/* Store the vertex' texture coordinate: */
+		if(texCoord.getValue()!=0)
+			vPtr->texCoord=texCoord.getValue()->point.getValue(vInd);
+		else
+			vPtr->texCoord=Vertex::TexCoord(Scalar(x)/Scalar(xDim-1),Scalar(z)/Scalar(zDim-1));
+		
+		/* Store the vertex' color: */
+		if(color.getValue()!=0)
+			vPtr->color=Vertex::Color(color.getValue()->color.getValue(vInd));
+		else
+			vPtr->color=Vertex::Color(255,255,255);
+		
+		/* Calculate the vertex' position and normal: */
+		Point p;
+		p[0]=origin.getValue()[0]+Scalar(x)*Scalar(xSp);
+		p[1]=origin.getValue()[1]+height.getValue(vInd);
+		p[2]=origin.getValue()[2]+Scalar(z)*Scalar(zSp);
+		Vector n;
+		if(normal.getValue()!=0)
+			n=Geometry::normalize(normal.getValue()->vector.getValue(vInd));
+		else
+			n=calcVertexNormal(x,z);
+		if(!heightIsY.getValue())
 			{
-			/* Store the vertex' texture coordinate: */
-			if(texCoord.getValue()!=0)
-				vPtr->texCoord=texCoord.getValue()->point.getValue(vInd);
-			else
-				vPtr->texCoord=Vertex::TexCoord(Scalar(x)/Scalar(xDim-1),Scalar(z)/Scalar(zDim-1));
-			
-			/* Store the vertex' color: */
-			if(color.getValue()!=0)
-				vPtr->color=Vertex::Color(color.getValue()->color.getValue(vInd));
-			else
-				vPtr->color=Vertex::Color(255,255,255);
-			
-			/* Calculate the vertex' position and normal: */
-			Point p;
-			p[0]=origin.getValue()[0]+Scalar(x)*Scalar(xSp);
-			p[1]=origin.getValue()[1]+height.getValue(z*xDim+x);
-			p[2]=origin.getValue()[2]+Scalar(z)*Scalar(zSp);
-			Vector n;
-			if(normal.getValue()!=0)
-				n=Geometry::normalize(normal.getValue()->vector.getValue(vInd));
-			else
-				n=calcVertexNormal(x,z);
-			if(!heightIsY.getValue())
-				{
-				std::swap(p[1],p[2]);
-				std::swap(n[1],n[2]);
-				n=-n;
-				}
-			
-			/* Store the vertex position and normal: */
-			if(pointTransform.getValue()!=0)
-				{
-				vPtr->normal=Vertex::Normal(pointTransform.getValue()->transformNormal(p,n));
-				vPtr->position=Vertex::Position(pointTransform.getValue()->transformPoint(p));
-				}
-			else
-				{
-				vPtr->normal=Vertex::Normal(n);
-				vPtr->position=Vertex::Position(p);
-				}
+			std::swap(p[1],p[2]);
+			std::swap(n[1],n[2]);
+			n=-n;
+			}
+		
+		/* Store the vertex position and normal, or defer them until after the batch transformation: */
+		if(pt!=0)
+			{
+			points[vInd-begin]=p;
+			normals[vInd-begin]=n;
+			}
+		else
+			{
+			vPtr->normal=Vertex::Normal(n);
+			vPtr->position=Vertex::Position(p);
+			}
+		}
+	
+	if(pt!=0)
+		{
+		/* Transform all vertex normals and positions in one go: */
+		size_t numVertices=points.size();
+		pt->transformNormals(numVertices,&points[0],&normals[0],&normals[0]);
+		pt->transformPoints(numVertices,&points[0],&points[0]);
+		
+		/* Store the transformed vertex positions and normals: */
+		for(size_t i=0;i<numVertices;++i)
+			{
+			vertices[i].normal=Vertex::Normal(normals[i]);
+			vertices[i].position=Vertex::Position(points[i]);
 			}
+		}
+	}
+
+void ElevationGridNode::uploadIndexedQuadStripSet(void) const
+	{
+	/* Initialize the vertex buffer object: */
+	int xDim=xDimension.getValue();
+	int zDim=zDimension.getValue();
+	size_t numVertices=size_t(xDim)*size_t(zDim);
+	glBufferDataARB(GL_ARRAY_BUFFER_ARB,numVertices*sizeof(Vertex),0,GL_STATIC_DRAW_ARB);
 	
+	/* Store all vertices: */
+	Vertex* vBase=static_cast<Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
+	storeGridVertices(0,numVertices,vBase);
 	glUnmapBufferARB(GL_ARRAY_BUFFER_ARB);
 	
 	/* Initialize the index buffer object: */
@@ -189,6 +343,14 @@ void ElevationGridNode::uploadIndexedQuadStripSet(void) const
 	glUnmapBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB);
 	}
 
+void ElevationGridNode::updateIndexedQuadStripSet(size_t begin,size_t end) const
+	{
+	/* Recalculate the changed vertices and upload them into the bound vertex buffer object: */
+	std::vector<Vertex> vertices(end-begin);
+	storeGridVertices(begin,end,&vertices[0]);
+	glBufferSubDataARB(GL_ARRAY_BUFFER_ARB,begin*sizeof(Vertex),(end-begin)*sizeof(Vertex),&vertices[0]);
+	}
+
 void ElevationGridNode::uploadQuadSet(void) const
 	{
 	/* Define the vertex type used in the vertex array: */
@@ -201,8 +363,19 @@ void ElevationGridNode::uploadQuadSet(void) const
 	Scalar zSp=zSpacing.getValue();
 	glBufferDataARB(GL_ARRAY_BUFFER_ARB,(xDim-1)*(zDim-1)*4*sizeof(Vertex),0,GL_STATIC_DRAW_ARB);
 	
+	/* Create arrays to batch-transform vertex positions and normal vectors if there is a point transformation: */
+	const PointTransformNode* pt=pointTransform.getValue().getPointer();
+	std::vector<Point> points;
+	std::vector<Vector> normals;
+	if(pt!=0)
+		{
+		points.reserve(size_t(xDim-1)*size_t(zDim-1)*4);
+		normals.reserve(size_t(xDim-1)*size_t(zDim-1)*4);
+		}
+	
 	/* Store all vertices: */
-	Vertex* vPtr=static_cast<Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
+	Vertex* vBase=static_cast<Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
+	Vertex* vPtr=vBase;
 	size_t qInd=0;
 	for(int z=0;z<zDim-1;++z)
 		for(int x=0;x<xDim-1;++x,vPtr+=4,++qInd)
@@ -304,16 +477,8 @@ void ElevationGridNode::uploadQuadSet(void) const
 					std::swap(cn[i][1],cn[i][2]);
 					cn[i]=-cn[i];
 					}
-				if(pointTransform.getValue()!=0)
-					{
-					v[i].normal=Vertex::Normal(pointTransform.getValue()->transformNormal(cp[i],cn[i]));
-					v[i].position=Vertex::Position(pointTransform.getValue()->transformPoint(cp[i]));
-					}
-				else
-					{
-					v[i].normal=Vertex::Normal(cn[i]);
-					v[i].position=Vertex::Position(cp[i]);
-					}
+				v[i].normal=Vertex::Normal(cn[i]);
+				v[i].position=Vertex::Position(cp[i]);
 				}
 			
 			/* Store the corner vertices of the current quad: */
@@ -322,18 +487,503 @@ void ElevationGridNode::uploadQuadSet(void) const
 				/* Store the corner vertices in counter-clockwise order: */
 				for(int i=0;i<4;++i)
 					vPtr[i]=v[3-i];
+				if(pt!=0)
+					for(int i=0;i<4;++i)
+						{
+						points.push_back(cp[3-i]);
+						normals.push_back(cn[3-i]);
+						}
 				}
 			else
 				{
 				/* Store the corner vertices in clockwise order: */
 				for(int i=0;i<4;++i)
 					vPtr[i]=v[i];
+				if(pt!=0)
+					for(int i=0;i<4;++i)
+						{
+						points.push_back(cp[i]);
+						normals.push_back(cn[i]);
+						}
 				}
 			}
 	
+	if(pt!=0&&!points.empty())
+		{
+		/* Transform all vertex normals and positions in one go: */
+		size_t numVertices=points.size();
+		pt->transformNormals(numVertices,&points[0],&normals[0],&normals[0]);
+		pt->transformPoints(numVertices,&points[0],&points[0]);
+		
+		/* Overwrite the untransformed vertex positions and normals: */
+		for(size_t i=0;i<numVertices;++i)
+			{
+			vBase[i].normal=Vertex::Normal(normals[i]);
+			vBase[i].position=Vertex::Position(points[i]);
+			}
+		}
+	
 	glUnmapBufferARB(GL_ARRAY_BUFFER_ARB);
 	}
 
+int ElevationGridNode::createTile(int level,int x0,int z0)
+	{
+	/* Bail out if the tile does not contain any grid cells: */
+	if(x0>=xDimension.getValue()-1||z0>=zDimension.getValue()-1)
+		return -1;
+	
+	/* Create the tile: */
+	int result=int(tiles.size());
+	tiles.push_back(Tile());
+	tiles[result].level=level;
+	tiles[result].x0=x0;
+	tiles[result].z0=z0;
+	for(int i=0;i<4;++i)
+		tiles[result].children[i]=-1;
+	
+	if(level>0)
+		{
+		/* Create the tile's children: */
+		int half=tileCells<<(level-1);
+		for(int i=0;i<4;++i)
+			{
+			int child=createTile(level-1,x0+(i&0x1)*half,z0+(i>>1)*half);
+			tiles[result].children[i]=child;
+			}
+		}
+	
+	return result;
+	}
+
+void ElevationGridNode::buildTiles(void)
+	{
+	/* Delete the previous tile hierarchy: */
+	waitForTileJobs();
+	releaseTileVertices();
+	tiles.clear();
+	tileCells=0;
+	
+	/* Check whether the elevation grid should be rendered in tiled mode: */
+	if(!valid||!indexed||tileSize.getValue()<=0||xDimension.getValue()<2||zDimension.getValue()<2)
+		return;
+	
+	/* Find the level of the root tile covering the entire grid: */
+	tileCells=tileSize.getValue();
+	int maxCells=xDimension.getValue()-1;
+	if(maxCells<zDimension.getValue()-1)
+		maxCells=zDimension.getValue()-1;
+	int rootLevel=0;
+	while((tileCells<<rootLevel)<maxCells)
+		++rootLevel;
+	
+	/* Create the tile quadtree: */
+	createTile(rootLevel,0,0);
+	
+	/* Calculate the bounds of all leaf tiles in parallel: */
+	std::vector<int> leaves;
+	for(size_t i=0;i<tiles.size();++i)
+		if(tiles[i].level==0)
+			leaves.push_back(int(i));
+	TileBoundsCalculator tbc;
+	tbc.node=this;
+	tbc.leaves=&leaves;
+	Threads::parallelFor(0,leaves.size(),tbc,16);
+	
+	/* Calculate the bounds of interior tiles bottom-up; children always come after their parents: */
+	for(size_t i=tiles.size();i>0;--i)
+		{
+		Tile& tile=tiles[i-1];
+		if(tile.level>0)
+			{
+			tile.box=Box::empty;
+			bool first=true;
+			for(int j=0;j<4;++j)
+				if(tile.children[j]>=0)
+					{
+					const Tile& child=tiles[tile.children[j]];
+					tile.box.addBox(child.box);
+					if(first||tile.heightMin>child.heightMin)
+						tile.heightMin=child.heightMin;
+					first=false;
+					}
+			}
+		}
+	
+	/* Initialize the tile vertex cache: */
+	tileVertices.assign(tiles.size(),static_cast<Vertex*>(0));
+	tileRequested.assign(tiles.size(),false);
+	}
+
+void ElevationGridNode::setTileVertex(const ElevationGridNode::Tile& tile,int i,int j,bool skirt,ElevationGridNode::Vertex& vertex,Point& vertexPos,Vector& vertexNormal) const
+	{
+	/* Calculate the index of the grid sample underlying the tile vertex: */
+	int xDim=xDimension.getValue();
+	int zDim=zDimension.getValue();
+	int x=tile.x0+(i<<tile.level);
+	if(x>xDim-1)
+		x=xDim-1;
+	int z=tile.z0+(j<<tile.level);
+	if(z>zDim-1)
+		z=zDim-1;
+	size_t vInd=size_t(z)*size_t(xDim)+size_t(x);
+	
+	/* Store the vertex' texture coordinate: */
+	if(texCoord.getValue()!=0)
+		vertex.texCoord=texCoord.getValue()->point.getValue(vInd);
+	else
+		vertex.texCoord=Vertex::TexCoord(Scalar(x)/Scalar(xDim-1),Scalar(z)/Scalar(zDim-1));
+	
+	/* Store the vertex' color: */
+	if(color.getValue()!=0)
+		vertex.color=Vertex::Color(color.getValue()->color.getValue(vInd));
+	else
+		vertex.color=Vertex::Color(255,255,255);
+	
+	/* Calculate the vertex' position and normal: */
+	vertexPos[0]=origin.getValue()[0]+Scalar(x)*xSpacing.getValue();
+	if(skirt)
+		{
+		/* Drop skirt vertices below the tile's lowest point by one cell size of the tile's level: */
+		Scalar cellSize=xSpacing.getValue();
+		if(cellSize<zSpacing.getValue())
+			cellSize=zSpacing.getValue();
+		vertexPos[1]=origin.getValue()[1]+tile.heightMin-Scalar(1<<tile.level)*cellSize;
+		}
+	else
+		vertexPos[1]=origin.getValue()[1]+height.getValue(vInd);
+	vertexPos[2]=origin.getValue()[2]+Scalar(z)*zSpacing.getValue();
+	if(normal.getValue()!=0)
+		vertexNormal=Geometry::normalize(normal.getValue()->vector.getValue(vInd));
+	else
+		vertexNormal=calcVertexNormal(x,z);
+	if(!heightIsY.getValue())
+		{
+		std::swap(vertexPos[1],vertexPos[2]);
+		std::swap(vertexNormal[1],vertexNormal[2]);
+		vertexNormal=-vertexNormal;
+		}
+	}
+
+void ElevationGridNode::calcTileBounds(ElevationGridNode::Tile& tile) const
+	{
+	int xDim=xDimension.getValue();
+	int zDim=zDimension.getValue();
+	int n=tileCells+1;
+	
+	/* Collect the tile's untransformed vertex positions and its minimum height: */
+	std::vector<Point> points;
+	points.reserve(size_t(n)*size_t(n));
+	int hc=heightIsY.getValue()?1:2;
+	int zc=heightIsY.getValue()?2:1;
+	bool first=true;
+	for(int j=0;j<n;++j)
+		{
+		int z=tile.z0+(j<<tile.level);
+		if(z>zDim-1)
+			z=zDim-1;
+		for(int i=0;i<n;++i)
+			{
+			int x=tile.x0+(i<<tile.level);
+			if(x>xDim-1)
+				x=xDim-1;
+			Scalar h=height.getValue(size_t(z)*size_t(xDim)+size_t(x));
+			if(first||tile.heightMin>h)
+				tile.heightMin=h;
+			first=false;
+			Point p;
+			p[0]=origin.getValue()[0]+Scalar(x)*xSpacing.getValue();
+			p[hc]=origin.getValue()[hc]+h;
+			p[zc]=origin.getValue()[zc]+Scalar(z)*zSpacing.getValue();
+			points.push_back(p);
+			}
+		}
+	
+	/* Calculate the tile's bounding box: */
+	if(pointTransform.getValue()!=0)
+		tile.box=pointTransform.getValue()->calcBoundingBox(points);
+	else
+		{
+		tile.box=Box::empty;
+		for(std::vector<Point>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
+			tile.box.addPoint(*pIt);
+		}
+	}
+
+size_t ElevationGridNode::getNumTileVertices(void) const
+	{
+	/* Each tile has a square grid of vertices plus one skirt vertex for each vertex along the four edges: */
+	size_t n=size_t(tileCells+1);
+	return n*n+4*n;
+	}
+
+size_t ElevationGridNode::getNumTileIndices(void) const
+	{
+	/* Each grid cell has two triangles, and each skirt cell has two triangles in each orientation: */
+	size_t c=size_t(tileCells);
+	return c*c*6+4*c*12;
+	}
+
+ElevationGridNode::Vertex* ElevationGridNode::generateTileVertices(int tileIndex) const
+	{
+	const Tile& tile=tiles[tileIndex];
+	int n=tileCells+1;
+	size_t numVertices=getNumTileVertices();
+	
+	/* Generate the grid and skirt vertices: */
+	Vertex* vertices=new Vertex[numVertices];
+	std::vector<Point> points(numVertices);
+	std::vector<Vector> normals(numVertices);
+	size_t vInd=0;
+	for(int j=0;j<n;++j)
+		for(int i=0;i<n;++i,++vInd)
+			setTileVertex(tile,i,j,false,vertices[vInd],points[vInd],normals[vInd]);
+	for(int edge=0;edge<4;++edge)
+		for(int k=0;k<n;++k,++vInd)
+			{
+			int i=edge==1?n-1:(edge==3?0:k);
+			int j=edge==0?0:(edge==2?n-1:k);
+			setTileVertex(tile,i,j,true,vertices[vInd],points[vInd],normals[vInd]);
+			}
+	
+	/* Transform all vertex normals and positions in one go: */
+	if(pointTransform.getValue()!=0)
+		{
+		pointTransform.getValue()->transformNormals(numVertices,&points[0],&normals[0],&normals[0]);
+		pointTransform.getValue()->transformPoints(numVertices,&points[0],&points[0]);
+		}
+	for(size_t i=0;i<numVertices;++i)
+		{
+		vertices[i].normal=Vertex::Normal(normals[i]);
+		vertices[i].position=Vertex::Position(points[i]);
+		}
+	
+	return vertices;
+	}
+
+void ElevationGridNode::storeTileVertices(int tileIndex,ElevationGridNode::Vertex* vertices) const
+	{
+	Threads::Mutex::Lock tileVerticesLock(tileVerticesMutex);
+	
+	tileRequested[tileIndex]=false;
+	if(tileVertices[tileIndex]!=0)
+		{
+		/* The tile was already generated by someone else: */
+		delete[] vertices;
+		return;
+		}
+	
+	/* Store the vertex array: */
+	tileVertices[tileIndex]=vertices;
+	tileVerticesLru.push_front(tileIndex);
+	
+	/* Evict the oldest vertex arrays if the cache is full: */
+	size_t maxSize=maxNumTiles.getValue()>1?size_t(maxNumTiles.getValue()):1;
+	while(tileVerticesLru.size()>maxSize)
+		{
+		int evictIndex=tileVerticesLru.back();
+		delete[] tileVertices[evictIndex];
+		tileVertices[evictIndex]=0;
+		tileVerticesLru.pop_back();
+		}
+	}
+
+void ElevationGridNode::waitForTileJobs(void) const
+	{
+	Threads::MutexCond::Lock tileJobsLock(tileJobsCond);
+	while(numTileJobs>0)
+		tileJobsCond.wait(tileJobsLock);
+	}
+
+void ElevationGridNode::releaseTileVertices(void)
+	{
+	Threads::Mutex::Lock tileVerticesLock(tileVerticesMutex);
+	for(std::list<int>::iterator lIt=tileVerticesLru.begin();lIt!=tileVerticesLru.end();++lIt)
+		{
+		delete[] tileVertices[*lIt];
+		tileVertices[*lIt]=0;
+		}
+	tileVerticesLru.clear();
+	}
+
+void ElevationGridNode::uploadTileIndices(void) const
+	{
+	glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,getNumTileIndices()*sizeof(GLuint),0,GL_STATIC_DRAW_ARB);
+	GLuint* iPtr=static_cast<GLuint*>(glMapBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
+	
+	/* Store the grid triangles: */
+	GLuint n=GLuint(tileCells+1);
+	for(GLuint j=0;j<n-1;++j)
+		for(GLuint i=0;i<n-1;++i,iPtr+=6)
+			{
+			GLuint a=j*n+i;
+			GLuint b=a+1;
+			GLuint c=a+n+1;
+			GLuint d=a+n;
+			if(ccw.getValue())
+				{
+				iPtr[0]=a;
+				iPtr[1]=d;
+				iPtr[2]=c;
+				iPtr[3]=a;
+				iPtr[4]=c;
+				iPtr[5]=b;
+				}
+			else
+				{
+				iPtr[0]=a;
+				iPtr[1]=c;
+				iPtr[2]=d;
+				iPtr[3]=a;
+				iPtr[4]=b;
+				iPtr[5]=c;
+				}
+			}
+	
+	/* Store the skirt triangles in both orientations so they are visible from either side: */
+	for(GLuint edge=0;edge<4;++edge)
+		for(GLuint k=0;k<n-1;++k,iPtr+=12)
+			{
+			GLuint i0=edge==1?n-1:(edge==3?0:k);
+			GLuint j0=edge==0?0:(edge==2?n-1:k);
+			GLuint i1=edge==1?n-1:(edge==3?0:k+1);
+			GLuint j1=edge==0?0:(edge==2?n-1:k+1);
+			GLuint top0=j0*n+i0;
+			GLuint top1=j1*n+i1;
+			GLuint bottom0=n*n+edge*n+k;
+			GLuint bottom1=bottom0+1;
+			iPtr[0]=top0;
+			iPtr[1]=bottom0;
+			iPtr[2]=bottom1;
+			iPtr[3]=top0;
+			iPtr[4]=bottom1;
+			iPtr[5]=top1;
+			iPtr[6]=top0;
+			iPtr[7]=bottom1;
+			iPtr[8]=bottom0;
+			iPtr[9]=top0;
+			iPtr[10]=top1;
+			iPtr[11]=bottom1;
+			}
+	
+	glUnmapBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB);
+	}
+
+bool ElevationGridNode::isTileAvailable(ElevationGridNode::DataItem* dataItem,int tileIndex) const
+	{
+	/* Check if the tile is already uploaded: */
+	if(dataItem->tileBuffers[tileIndex].bufferId!=0)
+		return true;
+	
+	/* Check if the tile's vertices are already generated: */
+	{
+	Threads::Mutex::Lock tileVerticesLock(tileVerticesMutex);
+	if(tileVertices[tileIndex]!=0)
+		return dataItem->numUploadsInFrame<maxTileUploadsPerFrame;
+	if(tileRequested[tileIndex])
+		return false;
+	tileRequested[tileIndex]=true;
+	}
+	
+	/* Request generation of the tile's vertices in the background: */
+	{
+	Threads::MutexCond::Lock tileJobsLock(tileJobsCond);
+	++numTileJobs;
+	}
+	submitBackgroundJob(new TileGenerationJob(this,tileIndex));
+	
+	return false;
+	}
+
+void ElevationGridNode::drawTile(ElevationGridNode::DataItem* dataItem,int tileIndex) const
+	{
+	TileBuffer& tb=dataItem->tileBuffers[tileIndex];
+	if(tb.bufferId==0)
+		{
+		/* Evict the least recently used tile if the context's tile cache is full and that tile was not drawn in this frame: */
+		if(!dataItem->tileLru.empty()&&dataItem->tileLru.size()>=size_t(maxNumTiles.getValue()))
+			{
+			TileBuffer& evict=dataItem->tileBuffers[dataItem->tileLru.back()];
+			if(evict.lastUsed!=dataItem->frameNumber)
+				{
+				glDeleteBuffersARB(1,&evict.bufferId);
+				evict.bufferId=0;
+				dataItem->tileLru.pop_back();
+				}
+			}
+		
+		/* Create a vertex buffer object for the tile: */
+		glGenBuffersARB(1,&tb.bufferId);
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,tb.bufferId);
+		tb.lruIt=dataItem->tileLru.insert(dataItem->tileLru.begin(),tileIndex);
+		++dataItem->numUploadsInFrame;
+		
+		/* Upload the tile's vertices from the cache, or generate them right now if they are not cached: */
+		bool uploaded=false;
+		{
+		Threads::Mutex::Lock tileVerticesLock(tileVerticesMutex);
+		if(tileVertices[tileIndex]!=0)
+			{
+			glBufferDataARB(GL_ARRAY_BUFFER_ARB,getNumTileVertices()*sizeof(Vertex),tileVertices[tileIndex],GL_STATIC_DRAW_ARB);
+			uploaded=true;
+			}
+		}
+		if(!uploaded)
+			{
+			Vertex* vertices=generateTileVertices(tileIndex);
+			glBufferDataARB(GL_ARRAY_BUFFER_ARB,getNumTileVertices()*sizeof(Vertex),vertices,GL_STATIC_DRAW_ARB);
+			storeTileVertices(tileIndex,vertices);
+			}
+		}
+	else
+		{
+		/* Move the tile to the front of the LRU list: */
+		dataItem->tileLru.splice(dataItem->tileLru.begin(),dataItem->tileLru,tb.lruIt);
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,tb.bufferId);
+		}
+	tb.lastUsed=dataItem->frameNumber;
+	
+	/* Draw the tile: */
+	glVertexPointer(static_cast<Vertex*>(0));
+	glDrawElements(GL_TRIANGLES,GLsizei(getNumTileIndices()),GL_UNSIGNED_INT,0);
+	}
+
+void ElevationGridNode::renderTile(GLRenderState& renderState,ElevationGridNode::DataItem* dataItem,int tileIndex,const Point& viewerPos) const
+	{
+	const Tile& tile=tiles[tileIndex];
+	
+	/* Bail out if the tile is culled: */
+	if(renderState.cullBox(tile.box))
+		return;
+	
+	/* Check whether the tile should be replaced by its children: */
+	bool refine=false;
+	if(tile.level>0)
+		{
+		Scalar tileSize2=Geometry::sqrDist(tile.box.min,tile.box.max);
+		if(sqrDist(viewerPos,tile.box)<Math::sqr(lodDistance.getValue())*tileSize2)
+			{
+			/* Only refine if all children are ready to be drawn; request the missing ones in any case: */
+			refine=true;
+			for(int i=0;i<4;++i)
+				if(tile.children[i]>=0&&!isTileAvailable(dataItem,tile.children[i]))
+					refine=false;
+			}
+		}
+	
+	if(refine)
+		{
+		/* Render the tile's children: */
+		for(int i=0;i<4;++i)
+			if(tile.children[i]>=0)
+				renderTile(renderState,dataItem,tile.children[i],viewerPos);
+		}
+	else
+		{
+		/* Draw the tile itself: */
+		drawTile(dataItem,tileIndex);
+		}
+	}
+
 ElevationGridNode::ElevationGridNode(void)
 	:colorPerVertex(true),normalPerVertex(true),
 	 creaseAngle(0),
@@ -342,10 +992,23 @@ ElevationGridNode::ElevationGridNode(void)
 	 zDimension(0),zSpacing(0),
 	 heightIsY(true),
 	 ccw(true),solid(true),
-	 multiplexer(0),valid(false),indexed(false),version(0)
+	 tileSize(0),lodDistance(2),maxNumTiles(512),
+	 multiplexer(0),valid(false),indexed(false),
+	 lastLayoutVersion(0),lastAttributeVersion(0),lastHeightVersion(0),
+	 tileCells(0),
+	 numTileJobs(0)
 	{
 	}
 
+ElevationGridNode::~ElevationGridNode(void)
+	{
+	/* Wait until no background jobs reference the elevation grid anymore: */
+	waitForTileJobs();
+	
+	/* Delete all cached tile vertex arrays: */
+	releaseTileVertices();
+	}
+
 const char* ElevationGridNode::getStaticClassName(void)
 	{
 	return "ElevationGrid";
@@ -433,12 +1096,27 @@ void ElevationGridNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 		{
 		vrmlFile.parseField(solid);
 		}
+	else if(strcmp(fieldName,"tileSize")==0)
+		{
+		vrmlFile.parseField(tileSize);
+		}
+	else if(strcmp(fieldName,"lodDistance")==0)
+		{
+		vrmlFile.parseField(lodDistance);
+		}
+	else if(strcmp(fieldName,"maxNumTiles")==0)
+		{
+		vrmlFile.parseField(maxNumTiles);
+		}
 	else
 		GeometryNode::parseField(fieldName,vrmlFile);
 	}
 
 void ElevationGridNode::update(void)
 	{
+	/* Bump up the geometry version number: */
+	GeometryNode::update();
+	
 	/* Check whether the height field should be loaded from a file: */
 	if(heightUrl.getNumValues()>0)
 		{
@@ -459,8 +1137,35 @@ void ElevationGridNode::update(void)
 	/* Check whether the elevation grid can be represented by a set of indexed triangle strips: */
 	indexed=(color.getValue()==0||colorPerVertex.getValue())&&normalPerVertex.getValue();
 	
-	/* Bump up the elevation grid's version number: */
-	++version;
+	/* Create the level-of-detail tile hierarchy if requested: */
+	buildTiles();
+	
+	/* Check whether only some height values changed since the last update, and the grid is uploaded as a single set of indexed quad strips: */
+	unsigned int layoutVersion=calcLayoutVersion();
+	unsigned int attributeVersion=calcAttributeVersion();
+	size_t begin,end;
+	if(valid&&indexed&&tileCells==0&&heightUrl.getNumValues()==0&&pointTransform.getValue()==0&&layoutVersion==lastLayoutVersion&&attributeVersion==lastAttributeVersion&&height.getVersion()!=lastHeightVersion&&height.getDirtyRange(lastHeightVersion,begin,end))
+		{
+		/* Grid vertices' normal vectors depend on their direct neighbors' heights: */
+		size_t xDim=size_t(xDimension.getValue());
+		size_t numVertices=xDim*size_t(zDimension.getValue());
+		begin=begin>=xDim?begin-xDim:0;
+		end=end+xDim<=numVertices?end+xDim:numVertices;
+		
+		/* Bump up the elevation grid's version number, remembering the changed vertices: */
+		vertexChanges.addRangeChange(begin,end);
+		}
+	else
+		{
+		/* Bump up the elevation grid's version number: */
+		vertexChanges.addFullChange();
+		}
+	
+	/* Remember the state of the elevation grid's fields for the next update: */
+	lastLayoutVersion=layoutVersion;
+	lastAttributeVersion=attributeVersion;
+	lastHeightVersion=height.getVersion();
+	height.clearDirty();
 	}
 
 Box ElevationGridNode::calcBoundingBox(void) const
@@ -471,37 +1176,26 @@ Box ElevationGridNode::calcBoundingBox(void) const
 		{
 		if(pointTransform.getValue()!=0)
 			{
-			/* Return the bounding box of the transformed point coordinates: */
-			if(heightIsY.getValue())
-				{
-				MFFloat::ValueList::const_iterator hIt=height.getValues().begin();
-				Point p;
-				p[2]=origin.getValue()[2];
-				for(int z=0;z<zDimension.getValue();++z,p[2]+=zSpacing.getValue())
-					{
-					p[0]=origin.getValue()[0];
-					for(int x=0;x<xDimension.getValue();++x,p[0]+=xSpacing.getValue(),++hIt)
-						{
-						p[1]=origin.getValue()[1]+*hIt;
-						result.addPoint(pointTransform.getValue()->transformPoint(p));
-						}
-					}
-				}
-			else
+			/* Collect all grid vertices: */
+			std::vector<Point> points;
+			points.reserve(size_t(xDimension.getValue())*size_t(zDimension.getValue()));
+			int hc=heightIsY.getValue()?1:2;
+			int zc=heightIsY.getValue()?2:1;
+			MFFloat::ValueList::const_iterator hIt=height.getValues().begin();
+			Point p;
+			p[zc]=origin.getValue()[zc];
+			for(int z=0;z<zDimension.getValue();++z,p[zc]+=zSpacing.getValue())
 				{
-				MFFloat::ValueList::const_iterator hIt=height.getValues().begin();
-				Point p;
-				p[1]=origin.getValue()[1];
-				for(int z=0;z<zDimension.getValue();++z,p[1]+=zSpacing.getValue())
+				p[0]=origin.getValue()[0];
+				for(int x=0;x<xDimension.getValue();++x,p[0]+=xSpacing.getValue(),++hIt)
 					{
-					p[0]=origin.getValue()[0];
-					for(int x=0;x<xDimension.getValue();++x,p[0]+=xSpacing.getValue(),++hIt)
-						{
-						p[2]=origin.getValue()[2]+*hIt;
-						result.addPoint(pointTransform.getValue()->transformPoint(p));
-						}
+					p[hc]=origin.getValue()[hc]+*hIt;
+					points.push_back(p);
 					}
 				}
+			
+			/* Return the bounding box of the transformed point coordinates: */
+			result=pointTransform.getValue()->calcBoundingBox(points);
 			}
 		else
 			{
@@ -541,11 +1235,6 @@ void ElevationGridNode::glRenderAction(GLRenderState& renderState) const
 	/* Get the context data item: */
 	DataItem* dataItem=renderState.contextData.retrieveDataItem<DataItem>(this);
 	
-	typedef GLGeometry::Vertex<Scalar,2,GLubyte,4,Scalar,Scalar,3> Vertex;
-	
-	/* Bind the vertex buffer object: */
-	glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->vertexBufferObjectId);
-	
 	/* Set up the vertex arrays: */
 	int vertexArrayParts=Vertex::getPartsMask();
 	if(color.getValue()==0)
@@ -554,45 +1243,91 @@ void ElevationGridNode::glRenderAction(GLRenderState& renderState) const
 		vertexArrayParts&=~GLVertexArrayParts::Color;
 		}
 	GLVertexArrayParts::enable(vertexArrayParts);
-	glVertexPointer(static_cast<Vertex*>(0));
 	
-	if(indexed)
+	if(tileCells>0)
 		{
-		/* Bind the index buffer object: */
+		/* Bind the index buffer object shared by all tiles: */
 		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,dataItem->indexBufferObjectId);
 		
-		/* Check if the buffers are current: */
-		if(dataItem->version!=version)
+		/* Check if the tile buffers are current: */
+		if(dataItem->version!=vertexChanges.getVersion())
 			{
-			/* Upload the set of indexed quad strips: */
-			uploadIndexedQuadStripSet();
+			/* Discard all previously uploaded tiles: */
+			dataItem->releaseTiles();
+			TileBuffer empty;
+			empty.bufferId=0;
+			empty.lastUsed=0;
+			dataItem->tileBuffers.assign(tiles.size(),empty);
+			
+			/* Upload the tile index array: */
+			uploadTileIndices();
 			
 			/* Mark the buffers as up-to-date: */
-			dataItem->version=version;
+			dataItem->version=vertexChanges.getVersion();
 			}
 		
-		/* Draw the elevation grid as a set of indexed quad strips: */
-		const GLuint* iPtr=0;
-		for(int z=0;z<zDimension.getValue()-1;++z,iPtr+=xDimension.getValue()*2)
-			glDrawElements(GL_QUAD_STRIP,xDimension.getValue()*2,GL_UNSIGNED_INT,iPtr);
+		/* Render the tile quadtree starting from the root: */
+		++dataItem->frameNumber;
+		dataItem->numUploadsInFrame=0;
+		renderTile(renderState,dataItem,0,renderState.getViewerPos());
 		
 		/* Protect the index buffer object: */
 		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
 		}
 	else
 		{
-		/* Check if the buffer is current: */
-		if(dataItem->version!=version)
+		/* Bind the vertex buffer object: */
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->vertexBufferObjectId);
+		glVertexPointer(static_cast<Vertex*>(0));
+		
+		if(indexed)
 			{
-			/* Upload the set of quads: */
-			uploadQuadSet();
+			/* Bind the index buffer object: */
+			glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,dataItem->indexBufferObjectId);
 			
-			/* Mark the buffers as up-to-date: */
-			dataItem->version=version;
+			/* Check if the buffers are current: */
+			if(dataItem->version!=vertexChanges.getVersion())
+				{
+				size_t begin,end;
+				if(vertexChanges.getRangeSince(dataItem->version,begin,end))
+					{
+					/* Update only the changed vertices: */
+					if(begin<end)
+						updateIndexedQuadStripSet(begin,end);
+					}
+				else
+					{
+					/* Upload the set of indexed quad strips: */
+					uploadIndexedQuadStripSet();
+					}
+				
+				/* Mark the buffers as up-to-date: */
+				dataItem->version=vertexChanges.getVersion();
+				}
+			
+			/* Draw the elevation grid as a set of indexed quad strips: */
+			const GLuint* iPtr=0;
+			for(int z=0;z<zDimension.getValue()-1;++z,iPtr+=xDimension.getValue()*2)
+				glDrawElements(GL_QUAD_STRIP,xDimension.getValue()*2,GL_UNSIGNED_INT,iPtr);
+			
+			/* Protect the index buffer object: */
+			glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
+			}
+		else
+			{
+			/* Check if the buffer is current: */
+			if(dataItem->version!=vertexChanges.getVersion())
+				{
+				/* Upload the set of quads: */
+				uploadQuadSet();
+			
+				/* Mark the buffers as up-to-date: */
+				dataItem->version=vertexChanges.getVersion();
+				}
+			
+			/* Draw the elevation grid as a set of quads: */
+			glDrawArrays(GL_QUADS,0,(xDimension.getValue()-1)*(zDimension.getValue()-1)*4);
 			}
-		
-		/* Draw the elevation grid as a set of quads: */
-		glDrawArrays(GL_QUADS,0,(xDimension.getValue()-1)*(zDimension.getValue()-1)*4);
 		}
 	
 	/* Reset the vertex arrays: */
@@ -602,6 +1337,49 @@ void ElevationGridNode::glRenderAction(GLRenderState& renderState) const
 	glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
 	}
 
+void ElevationGridNode::collectTriangles(TriangleCollector& collector) const
+	{
+	/* Bail out if the elevation grid is invalid: */
+	if(!valid)
+		return;
+	
+	/* Calculate the positions of all grid vertices at full resolution: */
+	int xDim=xDimension.getValue();
+	int zDim=zDimension.getValue();
+	std::vector<Point> points;
+	points.reserve(size_t(xDim)*size_t(zDim));
+	int hc=heightIsY.getValue()?1:2;
+	int zc=heightIsY.getValue()?2:1;
+	MFFloat::ValueList::const_iterator hIt=height.getValues().begin();
+	Point p;
+	p[zc]=origin.getValue()[zc];
+	for(int z=0;z<zDim;++z,p[zc]+=zSpacing.getValue())
+		{
+		p[0]=origin.getValue()[0];
+		for(int x=0;x<xDim;++x,p[0]+=xSpacing.getValue(),++hIt)
+			{
+			p[hc]=origin.getValue()[hc]+*hIt;
+			points.push_back(p);
+			}
+		}
+	if(pointTransform.getValue()!=0)
+		pointTransform.getValue()->transformPoints(points.size(),&points[0],&points[0]);
+	
+	/* Add two triangles for each grid cell, using the same vertex order as the renderer: */
+	for(int z=0;z<zDim-1;++z)
+		{
+		const Point* row0=&points[size_t(z)*size_t(xDim)];
+		const Point* row1=row0+xDim;
+		for(int x=0;x<xDim-1;++x)
+			{
+			if(ccw.getValue())
+				collector.addQuad(row1[x],row1[x+1],row0[x+1],row0[x]);
+			else
+				collector.addQuad(row0[x],row0[x+1],row1[x+1],row1[x]);
+			}
+		}
+	}
+
 void ElevationGridNode::initContext(GLContextData& contextData) const
 	{
 	/* Create a data item and store it in the context: */
@@ -23,9 +23,16 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_ELEVATIONGRIDNODE_INCLUDED
 #define SCENEGRAPH_ELEVATIONGRIDNODE_INCLUDED
 
+#include <list>
+#include <vector>
+#include <Threads/Mutex.h>
+#include <Threads/MutexCond.h>
+#include <Geometry/Box.h>
 #include <GL/gl.h>
 #include <GL/GLObject.h>
+#include <GL/GLGeometryVertex.h>
 #include <SceneGraph/FieldTypes.h>
+#include <SceneGraph/DirtyRangeHistory.h>
 #include <SceneGraph/GeometryNode.h>
 #include <SceneGraph/TextureCoordinateNode.h>
 #include <SceneGraph/ColorNode.h>
@@ -49,6 +56,28 @@ class ElevationGridNode:public GeometryNode,public GLObject
 	/* Elements: */
 	
 	protected:
+	typedef GLGeometry::Vertex<Scalar,2,GLubyte,4,Scalar,Scalar,3> Vertex; // Type for uploaded vertices
+	
+	struct Tile // Structure for nodes of the quadtree of level-of-detail tiles
+		{
+		/* Elements: */
+		public:
+		int level; // Tile's level in the quadtree; leaves are at level 0 and sample the grid with stride 1<<level
+		int x0,z0; // Index of tile's first grid sample
+		int children[4]; // Indices of the tile's children, or -1 for leaves or children outside the grid
+		Box box; // Bounding box of the tile's vertices in (transformed) model coordinates
+		Scalar heightMin; // Minimum height value of all grid samples covered by the tile
+		};
+	
+	struct TileBuffer // Structure for a tile uploaded into a vertex buffer object
+		{
+		/* Elements: */
+		public:
+		GLuint bufferId; // ID of vertex buffer object, or 0 if tile is not uploaded
+		std::list<int>::iterator lruIt; // Position of tile in the context's LRU list of uploaded tiles
+		unsigned int lastUsed; // Number of the frame in which the tile was last drawn
+		};
+	
 	struct DataItem:public GLObject::DataItem
 		{
 		/* Elements: */
@@ -56,12 +85,24 @@ class ElevationGridNode:public GeometryNode,public GLObject
 		GLuint vertexBufferObjectId; // ID of vertex buffer object containing the vertices, if supported
 		GLuint indexBufferObjectId; // ID of index buffer object containing the vertex indices, if supported
 		unsigned int version; // Version of point set stored in vertex buffer object
+		std::vector<TileBuffer> tileBuffers; // Vertex buffers for all quadtree tiles in tiled mode
+		std::list<int> tileLru; // List of uploaded tiles, most recently used first
+		unsigned int frameNumber; // Counter of rendering passes in tiled mode
+		unsigned int numUploadsInFrame; // Number of tiles uploaded during the current rendering pass
 		
 		/* Constructors and destructors: */
 		DataItem(void);
 		virtual ~DataItem(void);
+		
+		/* Methods: */
+		void releaseTiles(void); // Deletes all uploaded tiles
 		};
 	
+	class TileGenerationJob; // Class for background jobs generating tile vertices
+	friend class TileGenerationJob;
+	struct TileBoundsCalculator; // Functor to calculate the bounds of leaf tiles in parallel
+	friend struct TileBoundsCalculator;
+	
 	/* Fields: */
 	public:
 	SFTextureCoordinateNode texCoord;
@@ -81,22 +122,55 @@ class ElevationGridNode:public GeometryNode,public GLObject
 	SFBool heightIsY;
 	SFBool ccw;
 	SFBool solid;
+	SFInt tileSize; // Number of grid cells along each side of a level-of-detail tile; tiling is disabled if <=0
+	SFFloat lodDistance; // A tile is replaced by its children if the viewer is closer to it than this many times the tile's size
+	SFInt maxNumTiles; // Maximum number of tiles kept in memory and uploaded to each OpenGL context
 	
 	/* Derived state: */
 	protected:
 	Cluster::Multiplexer* multiplexer; // Pointer to a multicast pipe multiplexer when parsing VRML files in a cluster environment
 	bool valid; // Flag whether the elevation grid has a valid renderable representation
 	bool indexed; // Flag whether the elevation grid is represented as a set of indexed quad strips or a set of quads
-	unsigned int version; // Version number of elevation grid
+	DirtyRangeHistory vertexChanges; // Version number of elevation grid and ranges of grid vertices changed by recent versions
+	unsigned int lastLayoutVersion; // Combined version of the fields defining the grid's layout and attribute nodes at the last update
+	unsigned int lastAttributeVersion; // Combined version of the attribute nodes' value fields at the last update
+	unsigned int lastHeightVersion; // Version of the height field at the last update
+	int tileCells; // Number of grid cells along each side of a tile if the elevation grid is rendered in tiled mode, 0 otherwise
+	std::vector<Tile> tiles; // Quadtree of level-of-detail tiles; root is first element, children have higher indices than their parents
+	mutable Threads::Mutex tileVerticesMutex; // Mutex protecting the tile vertex cache
+	mutable std::vector<Vertex*> tileVertices; // Generated vertex arrays for each tile, or null if not generated
+	mutable std::vector<bool> tileRequested; // Flags whether a generation job for a tile is pending
+	mutable std::list<int> tileVerticesLru; // List of tiles with generated vertex arrays, most recently generated first
+	mutable Threads::MutexCond tileJobsCond; // Condition variable to wait for pending tile generation jobs
+	mutable unsigned int numTileJobs; // Number of pending tile generation jobs
 	
 	/* Private methods: */
 	Vector calcVertexNormal(int x,int z) const; // Calculates a vertex' normal vector using central differencing
+	unsigned int calcLayoutVersion(void) const; // Returns a number that changes whenever a field defining the grid's layout or attribute nodes changes
+	unsigned int calcAttributeVersion(void) const; // Returns a number that changes whenever the value fields of the grid's current attribute nodes change
+	void storeGridVertices(size_t begin,size_t end,Vertex* vertices) const; // Stores the given half-open range of grid vertices, as used by indexed quad strips, in the given array
 	void uploadIndexedQuadStripSet(void) const; // Uploads the elevation grid as a set of indexed quad strips
+	void updateIndexedQuadStripSet(size_t begin,size_t end) const; // Updates the given half-open range of vertices of the uploaded set of indexed quad strips
 	void uploadQuadSet(void) const; // Uploads the elevation grid as a set of quads
+	int createTile(int level,int x0,int z0); // Recursively creates the quadtree tile of the given level starting at the given grid sample; returns tile index or -1
+	void buildTiles(void); // Creates the quadtree of level-of-detail tiles
+	void setTileVertex(const Tile& tile,int i,int j,bool skirt,Vertex& vertex,Point& vertexPos,Vector& vertexNormal) const; // Sets a tile vertex' texture coordinate and color, and returns its untransformed position and normal vector
+	void calcTileBounds(Tile& tile) const; // Calculates a tile's bounding box and minimum height from its grid samples
+	size_t getNumTileVertices(void) const; // Returns the number of vertices in each tile, including skirts
+	size_t getNumTileIndices(void) const; // Returns the number of vertex indices in each tile, including skirts
+	Vertex* generateTileVertices(int tileIndex) const; // Generates the vertex array of the given tile; returns new[]-allocated array
+	void storeTileVertices(int tileIndex,Vertex* vertices) const; // Stores a generated vertex array in the tile cache
+	void waitForTileJobs(void) const; // Blocks until all pending tile generation jobs are finished
+	void releaseTileVertices(void); // Deletes all cached tile vertex arrays
+	void uploadTileIndices(void) const; // Uploads the index array shared by all tiles into the currently bound index buffer
+	bool isTileAvailable(DataItem* dataItem,int tileIndex) const; // Returns true if the given tile can be drawn right away; requests generation otherwise
+	void drawTile(DataItem* dataItem,int tileIndex) const; // Draws the given tile, uploading and if necessary generating it first
+	void renderTile(GLRenderState& renderState,DataItem* dataItem,int tileIndex,const Point& viewerPos) const; // Recursively renders a tile or its children
 	
 	/* Constructors and destructors: */
 	public:
 	ElevationGridNode(void); // Creates a default elevation grid
+	virtual ~ElevationGridNode(void);
 	
 	/* Methods from Node: */
 	static const char* getStaticClassName(void);
@@ -107,6 +181,7 @@ class ElevationGridNode:public GeometryNode,public GLObject
 	/* Methods from GeometryNode: */
 	virtual Box calcBoundingBox(void) const;
 	virtual void glRenderAction(GLRenderState& renderState) const;
+	virtual void collectTriangles(TriangleCollector& collector) const;
 	
 	/* Methods from GLObject: */
 	virtual void initContext(GLContextData& contextData) const;
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_FIELDTYPES_INCLUDED
 #define SCENEGRAPH_FIELDTYPES_INCLUDED
 
+#include <stddef.h>
 #include <string>
 #include <vector>
 #include <Misc/Autopointer.h>
@@ -65,14 +66,16 @@ class SF:public Field
 	/* Elements: */
 	private:
 	Value value; // Field value
+	unsigned int version; // Version number of the field's value, incremented on every change
 	
 	/* Constructors and destructors: */
 	public:
 	SF(void) // Default constructor
+		:version(0)
 		{
 		}
 	SF(const Value& sValue)
-		:value(sValue)
+		:value(sValue),version(0)
 		{
 		}
 	
@@ -84,6 +87,11 @@ class SF:public Field
 	void setValue(const Value& newValue) // Sets the field's value
 		{
 		value=newValue;
+		++version;
+		}
+	unsigned int getVersion(void) const // Returns the field's version number
+		{
+		return version;
 		}
 	};
 
@@ -102,13 +110,36 @@ class MF:public Field
 	/* Elements: */
 	private:
 	ValueList values; // List of field values
+	unsigned int version; // Version number of the value list, incremented on every change
+	unsigned int dirtyBaseVersion; // Version number since which changed values are tracked in the dirty range
+	size_t dirtyBegin,dirtyEnd; // Half-open range of value indices changed since the dirty base version; indices can exceed the current number of values after removals
+	
+	/* Private methods: */
+	void addDirtyRange(size_t begin,size_t end) // Adds the given index range to the dirty range and bumps up the version number
+		{
+		if(dirtyBegin>=dirtyEnd)
+			{
+			dirtyBegin=begin;
+			dirtyEnd=end;
+			}
+		else
+			{
+			if(dirtyBegin>begin)
+				dirtyBegin=begin;
+			if(dirtyEnd<end)
+				dirtyEnd=end;
+			}
+		++version;
+		}
 	
 	/* Constructors and destructors: */
 	public:
 	MF(void) // Default constructor
+		:version(0),dirtyBaseVersion(0),dirtyBegin(0),dirtyEnd(0)
 		{
 		}
 	MF(const ValueParam& sValue) // Creates a single-valued field
+		:version(0),dirtyBaseVersion(0),dirtyBegin(0),dirtyEnd(0)
 		{
 		values.push_back(sValue);
 		}
@@ -118,10 +149,44 @@ class MF:public Field
 		{
 		return values;
 		}
-	ValueList& getValues(void) // Ditto
+	ValueList& getValues(void) // Ditto; changes made through the returned list must be announced with markDirty
 		{
 		return values;
 		}
+	unsigned int getVersion(void) const // Returns the field's version number
+		{
+		return version;
+		}
+	void markDirty(size_t begin,size_t end) // Announces that the values in the given half-open index range were changed through the value list
+		{
+		addDirtyRange(begin,end);
+		}
+	void markDirty(void) // Announces that the entire value list was changed through the value list
+		{
+		addDirtyRange(0,values.size());
+		}
+	bool getDirtyRange(unsigned int sinceVersion,size_t& begin,size_t& end) const // Returns a half-open index range covering all values changed since the given version, or false if changes since that version are no longer tracked
+		{
+		if(sinceVersion==version)
+			{
+			/* Nothing changed: */
+			begin=end=0;
+			return true;
+			}
+		else if(version-sinceVersion<=version-dirtyBaseVersion)
+			{
+			begin=dirtyBegin;
+			end=dirtyEnd;
+			return true;
+			}
+		else
+			return false;
+		}
+	void clearDirty(void) // Starts tracking changed values anew from the current version
+		{
+		dirtyBaseVersion=version;
+		dirtyBegin=dirtyEnd=0;
+		}
 	size_t getNumValues(void) const // Returns the number of values in the field
 		{
 		return values.size();
@@ -132,38 +197,55 @@ class MF:public Field
 		}
 	void setValue(const Value& newValue) // Sets the field to the single given value
 		{
+		size_t oldNumValues=values.size();
 		values.clear();
 		values.push_back(newValue);
+		addDirtyRange(0,oldNumValues>1?oldNumValues:1);
 		}
 	void setValue(size_t index,const Value& newValue) // Sets one value in the list
 		{
 		values[index]=newValue;
+		addDirtyRange(index,index+1);
 		}
 	void clearValues(void) // Removes all values from the list
 		{
+		size_t oldNumValues=values.size();
 		values.clear();
+		addDirtyRange(0,oldNumValues);
 		}
 	void removeValue(size_t index) // Removes one value from the list
 		{
+		size_t oldNumValues=values.size();
 		values.erase(values.begin()+index);
+		addDirtyRange(index,oldNumValues);
 		}
 	void removeValue(const Value& value) // Removes all instances of the given value from the list
 		{
+		size_t oldNumValues=values.size();
+		size_t firstIndex=oldNumValues;
 		for(typename ValueList::iterator vIt=values.begin();vIt!=values.end();)
 			{
 			if(*vIt==value)
-				values.erase(vIt);
+				{
+				if(firstIndex==oldNumValues)
+					firstIndex=vIt-values.begin();
+				vIt=values.erase(vIt);
+				}
 			else
 				++vIt;
 			}
+		if(firstIndex<oldNumValues)
+			addDirtyRange(firstIndex,oldNumValues);
 		}
 	void appendValue(const Value& newValue) // Appends a new value to the end of the list
 		{
 		values.push_back(newValue);
+		addDirtyRange(values.size()-1,values.size());
 		}
 	void insertValue(size_t index,const Value& newValue) // Inserts the given value before the current value at the given index
 		{
 		values.insert(values.begin()+index,newValue);
+		addDirtyRange(index,values.size());
 		}
 	};
 
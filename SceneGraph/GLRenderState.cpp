@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <SceneGraph/GLRenderState.h>
 
+#include <Math/Math.h>
 #include <GL/gl.h>
 #include <GL/GLTexEnvTemplates.h>
 #include <GL/GLTransformationWrappers.h>
@@ -36,10 +37,17 @@ GLRenderState::GLRenderState(GLContextData& sContextData,const Point& sBaseViewe
 	:contextData(sContextData),
 	 baseViewerPos(sBaseViewerPos),baseUpVector(sBaseUpVector),
 	 currentTransform(OGTransform::identity),
-	 emissiveColor(0.0f,0.0f,0.0f)
+	 currentMaterial(0),
+	 emissiveColor(0.0f,0.0f,0.0f),
+	 frustumCullingEnabled(true),minProjectedRadius(0),occlusionCuller(0),
+	 renderQueue(0),
+	 time(0.0)
 	{
 	/* Initialize the view frustum from the current OpenGL context: */
 	baseFrustum.setFromGL();
+	GLint listIndex=0;
+	glGetIntegerv(GL_LIST_INDEX,&listIndex);
+	recordingDisplayList=listIndex!=0;
 	
 	/* Initialize OpenGL state tracking elements: */
 	cullingEnabled=glIsEnabled(GL_CULL_FACE);
@@ -64,6 +72,33 @@ GLRenderState::GLRenderState(GLContextData& sContextData,const Point& sBaseViewe
 	GLint lightModelColorControl;
 	glGetIntegerv(GL_LIGHT_MODEL_COLOR_CONTROL,&lightModelColorControl);
 	separateSpecularColorEnabled=lightModelColorControl==GL_SEPARATE_SPECULAR_COLOR;
+	
+	GLint textureBinding2D;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D,&textureBinding2D);
+	initialTexture2D=boundTexture2D=textureBinding2D;
+	}
+
+GLRenderState::~GLRenderState(void)
+	{
+	/* Restore the initial 2D texture binding: */
+	if(boundTexture2D!=initialTexture2D)
+		glBindTexture(GL_TEXTURE_2D,initialTexture2D);
+	}
+
+unsigned int GLRenderState::getModeState(void) const
+	{
+	unsigned int result=0x0U;
+	if(cullingEnabled)
+		result|=0x1U;
+	result|=(unsigned int)(culledFace-GL_FRONT)<<1;
+	if(lightingEnabled)
+		result|=0x10U;
+	if(colorMaterialEnabled)
+		result|=0x20U;
+	result|=(unsigned int)(highestTexturePriority+1)<<6;
+	if(separateSpecularColorEnabled)
+		result|=0x200U;
+	return result;
 	}
 
 OGTransform GLRenderState::pushTransform(const OGTransform& deltaTransform)
@@ -115,8 +150,46 @@ bool GLRenderState::doesBoxIntersectFrustum(const Box& box) const
 	return true;
 	}
 
+Scalar GLRenderState::calcProjectedRadius(const Box& box) const
+	{
+	/* Calculate the box's bounding sphere in initial model coordinates: */
+	Point center=currentTransform.transform(Geometry::mid(box.min,box.max));
+	Scalar radius=Math::div2(Geometry::dist(box.min,box.max))*currentTransform.getScaling();
+	
+	return baseFrustum.calcProjectedRadius(center,radius);
+	}
+
+bool GLRenderState::cullBox(const Box& box)
+	{
+	/* Never cull while recording a display list, or nodes whose extents are unknown or unbounded: */
+	if(recordingDisplayList||box.isNull()||box.isFull())
+		return false;
+	
+	/* Check the box against the view frustum: */
+	if(frustumCullingEnabled&&!doesBoxIntersectFrustum(box))
+		{
+		++cullingStatistics.numFrustumCulled;
+		return true;
+		}
+	
+	/* Check the box's projected size; boxes reaching behind the eye have negative or infinite projected radii: */
+	if(minProjectedRadius>Scalar(0))
+		{
+		Scalar projectedRadius=calcProjectedRadius(box);
+		if(projectedRadius>=Scalar(0)&&projectedRadius<minProjectedRadius)
+			{
+			++cullingStatistics.numSizeCulled;
+			return true;
+			}
+		}
+	
+	return false;
+	}
+
 void GLRenderState::enableCulling(GLenum newCulledFace)
 	{
+	unsigned int previousModeState=getModeState();
+	
 	if(!cullingEnabled)
 		{
 		glEnable(GL_CULL_FACE);
@@ -129,10 +202,14 @@ void GLRenderState::enableCulling(GLenum newCulledFace)
 		glCullFace(newCulledFace);
 		culledFace=newCulledFace;
 		}
+	
+	countStateChange(getModeState()!=previousModeState);
 	}
 
 void GLRenderState::disableCulling(void)
 	{
+	unsigned int previousModeState=getModeState();
+	
 	if(cullingEnabled)
 		{
 		glDisable(GL_CULL_FACE);
@@ -140,10 +217,14 @@ void GLRenderState::disableCulling(void)
 			glLightModeli(GL_LIGHT_MODEL_TWO_SIDE,GL_TRUE);
 		cullingEnabled=false;
 		}
+	
+	countStateChange(getModeState()!=previousModeState);
 	}
 
 void GLRenderState::enableMaterials(void)
 	{
+	unsigned int previousModeState=getModeState();
+	
 	if(!lightingEnabled)
 		{
 		glEnable(GL_LIGHTING);
@@ -165,10 +246,14 @@ void GLRenderState::enableMaterials(void)
 		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
 		separateSpecularColorEnabled=true;
 		}
+	
+	countStateChange(getModeState()!=previousModeState);
 	}
 
 void GLRenderState::disableMaterials(void)
 	{
+	unsigned int previousModeState=getModeState();
+	
 	if(lightingEnabled)
 		{
 		glDisable(GL_LIGHTING);
@@ -189,10 +274,14 @@ void GLRenderState::disableMaterials(void)
 		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SINGLE_COLOR);
 		separateSpecularColorEnabled=false;
 		}
+	
+	countStateChange(getModeState()!=previousModeState);
 	}
 
 void GLRenderState::enableTexture1D(void)
 	{
+	unsigned int previousModeState=getModeState();
+	
 	bool textureEnabled=highestTexturePriority>=0;
 	if(highestTexturePriority>=1)
 		glDisable(GL_TEXTURE_2D);
@@ -207,10 +296,14 @@ void GLRenderState::enableTexture1D(void)
 		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
 		separateSpecularColorEnabled=true;
 		}
+	
+	countStateChange(getModeState()!=previousModeState);
 	}
 
 void GLRenderState::enableTexture2D(void)
 	{
+	unsigned int previousModeState=getModeState();
+	
 	bool textureEnabled=highestTexturePriority>=0;
 	if(highestTexturePriority<1)
 		glEnable(GL_TEXTURE_2D);
@@ -223,10 +316,14 @@ void GLRenderState::enableTexture2D(void)
 		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
 		separateSpecularColorEnabled=true;
 		}
+	
+	countStateChange(getModeState()!=previousModeState);
 	}
 
 void GLRenderState::disableTextures(void)
 	{
+	unsigned int previousModeState=getModeState();
+	
 	if(highestTexturePriority>=1)
 		glDisable(GL_TEXTURE_2D);
 	if(highestTexturePriority>=0)
@@ -238,6 +335,29 @@ void GLRenderState::disableTextures(void)
 		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SINGLE_COLOR);
 		separateSpecularColorEnabled=false;
 		}
+	
+	countStateChange(getModeState()!=previousModeState);
+	}
+
+void GLRenderState::bindTexture2D(GLuint textureObjectId)
+	{
+	bool changed=boundTexture2D!=textureObjectId;
+	if(changed)
+		{
+		glBindTexture(GL_TEXTURE_2D,textureObjectId);
+		boundTexture2D=textureObjectId;
+		}
+	
+	countStateChange(changed);
+	}
+
+bool GLRenderState::setMaterial(const MaterialNode* newMaterial)
+	{
+	bool changed=currentMaterial!=newMaterial;
+	currentMaterial=newMaterial;
+	
+	countStateChange(changed);
+	return changed;
 	}
 
 }
@@ -31,6 +31,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 /* Forward declarations: */
 class GLContextData;
+namespace SceneGraph {
+class OcclusionCuller;
+class RenderQueue;
+class MaterialNode;
+}
 
 namespace SceneGraph {
 
@@ -41,6 +46,38 @@ class GLRenderState
 	typedef GLColor<GLfloat,3> Color; // Type for RGBA colors
 	typedef GLFrustum<Scalar> Frustum; // Class describing the rendering context's view frustum
 	
+	struct CullingStatistics // Structure counting the fates of child nodes during a traversal
+		{
+		/* Elements: */
+		public:
+		unsigned int numVisited; // Number of child nodes considered by their group nodes
+		unsigned int numFrustumCulled; // Number of child nodes skipped because they were outside the view frustum
+		unsigned int numSizeCulled; // Number of child nodes skipped because they projected to too few pixels
+		unsigned int numOcclusionCulled; // Number of child nodes skipped because they were hidden in the previous frame
+		unsigned int numDrawn; // Number of child nodes whose render actions were called
+		
+		/* Constructors and destructors: */
+		CullingStatistics(void)
+			:numVisited(0),numFrustumCulled(0),numSizeCulled(0),numOcclusionCulled(0),numDrawn(0)
+			{
+			}
+		};
+	
+	struct StateStatistics // Structure counting OpenGL state changes and draw calls during a traversal
+		{
+		/* Elements: */
+		public:
+		unsigned int numStateChanges; // Number of state change requests that changed OpenGL state
+		unsigned int numRedundantStateChanges; // Number of state change requests that were filtered out because the requested state was already current
+		unsigned int numDrawCalls; // Number of geometry nodes rendered by shape nodes
+		
+		/* Constructors and destructors: */
+		StateStatistics(void)
+			:numStateChanges(0),numRedundantStateChanges(0),numDrawCalls(0)
+			{
+			}
+		};
+	
 	/* Elements: */
 	GLContextData& contextData; // Context data of the current OpenGL context
 	private:
@@ -48,6 +85,10 @@ class GLRenderState
 	Point baseViewerPos; // Viewer position in initial model coordinates
 	Vector baseUpVector; // Up vector in initial model coordinates
 	OGTransform currentTransform; // Transformation from initial model coordinates to current model coordinates
+	GLuint initialTexture2D; // Texture object bound to the 2D texture target when the render state was created
+	GLuint boundTexture2D; // Texture object currently bound to the 2D texture target
+	const MaterialNode* currentMaterial; // Material node whose properties were uploaded to OpenGL last, or null
+	bool recordingDisplayList; // Flag whether the traversal is compiled into a display list that might be replayed for other views, which disables culling
 	
 	/* Elements shadowing current OpenGL state: */
 	public:
@@ -59,10 +100,40 @@ class GLRenderState
 	int highestTexturePriority; // Priority level of highest enabled texture unit (None=-1, 1D=0, 2D, 3D, cube map)
 	bool separateSpecularColorEnabled;
 	
+	/* Elements controlling hierarchical culling: */
+	bool frustumCullingEnabled; // Flag whether group nodes skip children whose bounding boxes are outside the view frustum
+	Scalar minProjectedRadius; // Minimum projected radius in pixels of a child's bounding sphere for the child to be rendered; 0 disables screen-size culling
+	const OcclusionCuller* occlusionCuller; // Occlusion culler deciding whether group nodes render children, or null to disable occlusion culling
+	CullingStatistics cullingStatistics; // Counters updated by group nodes during traversal
+	
+	/* Elements controlling state sorting: */
+	RenderQueue* renderQueue; // Render queue into which shape nodes record themselves instead of rendering immediately, or null
+	StateStatistics stateStatistics; // Counters updated by the OpenGL state management methods and shape nodes
+	
+	/* Elements describing the rendered frame: */
+	double time; // Application time of the frame in seconds; drives time-varying appearance such as animated materials
+	
+	/* Private methods: */
+	private:
+	unsigned int getModeState(void) const; // Returns a bit mask of the tracked OpenGL mode state to detect changes
+	void countStateChange(bool changed) // Updates the state statistics after a state change request
+		{
+		if(changed)
+			++stateStatistics.numStateChanges;
+		else
+			++stateStatistics.numRedundantStateChanges;
+		}
+	
 	/* Constructors and destructors: */
+	public:
 	GLRenderState(GLContextData& sContextData,const Point& sBaseViewerPos,const Vector& sBaseUpVector); // Creates a render state object
+	~GLRenderState(void); // Restores the 2D texture binding that was current when the render state was created
 	
 	/* Methods: */
+	const OGTransform& getTransform(void) const // Returns the transformation from initial model coordinates to current model coordinates
+		{
+		return currentTransform;
+		}
 	Point getViewerPos(void) const // Returns the viewer position in current model coordinates
 		{
 		return currentTransform.inverseTransform(baseViewerPos);
@@ -74,6 +145,8 @@ class GLRenderState
 	OGTransform pushTransform(const OGTransform& deltaTransform); // Pushes the given transformation onto the matrix stack and returns the previous transformation
 	void popTransform(const OGTransform& previousTransform); // Resets the matrix stack to the given transformation; must be result from previous pushTransform call
 	bool doesBoxIntersectFrustum(const Box& box) const; // Returns true if the given box in current model coordinates intersects the view frustum
+	Scalar calcProjectedRadius(const Box& box) const; // Returns the approximate projected radius in pixels of the bounding sphere of the given non-empty box in current model coordinates
+	bool cullBox(const Box& box); // Returns true if a node with the given bounding box in current model coordinates can be skipped by frustum or screen-size culling; updates culling statistics
 	
 	/* OpenGL state management methods: */
 	void enableCulling(GLenum newCulledFace); // Enables OpenGL face culling
@@ -83,6 +156,8 @@ class GLRenderState
 	void enableTexture1D(void); // Enables OpenGL 1D texture mapping
 	void enableTexture2D(void); // Enables OpenGL 2D texture mapping
 	void disableTextures(void); // Disables OpenGL texture mapping
+	void bindTexture2D(GLuint textureObjectId); // Binds the given texture object to the 2D texture target unless it is already bound
+	bool setMaterial(const MaterialNode* newMaterial); // Marks the given material node as current; returns true if its properties need to be uploaded to OpenGL
 	};
 
 }
@@ -31,11 +31,84 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Geometry/Vector.h>
 #include <Geometry/Box.h>
 #include <Geometry/Rotation.h>
+#include <Threads/Mutex.h>
+#include <Threads/ParallelFor.h>
 #include <SceneGraph/Geometry.h>
 #include <SceneGraph/VRMLFile.h>
 
 namespace SceneGraph {
 
+namespace {
+
+/******************************************************************
+Helper classes to process sub-ranges of arrays in parallel threads:
+******************************************************************/
+
+const size_t minParallelRangeSize=4096; // Minimum number of array elements processed by a single thread
+
+struct PointRangeTransformer // Transforms a range of points
+	{
+	/* Elements: */
+	public:
+	const GeodeticToCartesianPointTransformNode* node;
+	const Point* points;
+	Point* transformedPoints;
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end)
+		{
+		node->transformPointRange(end-begin,points+begin,transformedPoints+begin);
+		}
+	};
+
+struct NormalRangeTransformer // Transforms a range of normal vectors
+	{
+	/* Elements: */
+	public:
+	const GeodeticToCartesianPointTransformNode* node;
+	const Point* basePoints;
+	const Vector* normals;
+	Vector* transformedNormals;
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end)
+		{
+		node->transformNormalRange(end-begin,basePoints+begin,normals+begin,transformedNormals+begin);
+		}
+	};
+
+struct BoundingBoxCalculator // Calculates the bounding box of a range of transformed points
+	{
+	/* Elements: */
+	public:
+	const GeodeticToCartesianPointTransformNode* node;
+	const Point* points;
+	Threads::Mutex resultMutex; // Mutex serializing access to the result box
+	Box result; // Bounding box of all processed ranges
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end)
+		{
+		/* Transform the range in blocks and calculate its bounding box: */
+		Box rangeBox=Box::empty;
+		Point block[256];
+		while(begin<end)
+			{
+			size_t blockSize=end-begin<256?end-begin:256;
+			node->transformPointRange(blockSize,points+begin,block);
+			for(size_t i=0;i<blockSize;++i)
+				rangeBox.addPoint(block[i]);
+			begin+=blockSize;
+			}
+		
+		/* Merge the range's bounding box into the result: */
+		Threads::Mutex::Lock resultLock(resultMutex);
+		result.addBox(rangeBox);
+		}
+	};
+
+}
+
 /******************************************************
 Methods of class GeodeticToCartesianPointTransformNode:
 ******************************************************/
@@ -180,10 +253,16 @@ Point GeodeticToCartesianPointTransformNode::transformPoint(const Point& point)
 
 Box GeodeticToCartesianPointTransformNode::calcBoundingBox(const std::vector<Point>& points) const
 	{
-	Box result=Box::empty;
-	for(std::vector<Point>::const_iterator pIt=points.begin();pIt!=points.end();++pIt)
-		result.addPoint(transformPoint(*pIt));
-	return result;
+	if(points.empty())
+		return Box::empty;
+	
+	/* Calculate the bounding box in parallel: */
+	BoundingBoxCalculator bbc;
+	bbc.node=this;
+	bbc.points=&points[0];
+	bbc.result=Box::empty;
+	Threads::parallelFor(0,points.size(),bbc,minParallelRangeSize);
+	return bbc.result;
 	}
 
 Vector GeodeticToCartesianPointTransformNode::transformNormal(const Point& basePoint,const Vector& normal) const
@@ -222,4 +301,57 @@ Vector GeodeticToCartesianPointTransformNode::transformNormal(const Point& baseP
 	return Vector(Scalar(norm[0]/normLen),Scalar(norm[1]/normLen),Scalar(norm[2]/normLen));
 	}
 
+void GeodeticToCartesianPointTransformNode::transformPoints(size_t numPoints,const Point* points,Point* transformedPoints) const
+	{
+	PointRangeTransformer prt;
+	prt.node=this;
+	prt.points=points;
+	prt.transformedPoints=transformedPoints;
+	Threads::parallelFor(0,numPoints,prt,minParallelRangeSize);
+	}
+
+void GeodeticToCartesianPointTransformNode::transformNormals(size_t numNormals,const Point* basePoints,const Vector* normals,Vector* transformedNormals) const
+	{
+	NormalRangeTransformer nrt;
+	nrt.node=this;
+	nrt.basePoints=basePoints;
+	nrt.normals=normals;
+	nrt.transformedNormals=transformedNormals;
+	Threads::parallelFor(0,numNormals,nrt,minParallelRangeSize);
+	}
+
+void GeodeticToCartesianPointTransformNode::transformPointRange(size_t numPoints,const Point* points,Point* transformedPoints) const
+	{
+	/* Process the points in blocks: */
+	const size_t blockSize=256;
+	ReferenceEllipsoidNode::Geoid::Point geodetic[blockSize];
+	while(numPoints>0)
+		{
+		size_t blockPoints=numPoints<blockSize?numPoints:blockSize;
+		
+		/* Convert the geodetic points to longitude and latitude in radians and elevation in meters: */
+		for(size_t i=0;i<blockPoints;++i)
+			for(int j=0;j<3;++j)
+				geodetic[i][j]=GScalar(points[i][componentIndices[j]])*componentScales[j]+componentOffsets[j];
+		
+		/* Transform the block of points in place: */
+		re->geodeticToCartesian(blockPoints,geodetic,geodetic);
+		
+		/* Store the transformed points: */
+		for(size_t i=0;i<blockPoints;++i)
+			transformedPoints[i]=Point(geodetic[i]);
+		
+		points+=blockPoints;
+		transformedPoints+=blockPoints;
+		numPoints-=blockPoints;
+		}
+	}
+
+void GeodeticToCartesianPointTransformNode::transformNormalRange(size_t numNormals,const Point* basePoints,const Vector* normals,Vector* transformedNormals) const
+	{
+	/* Transform all normal vectors without going through the virtual function table: */
+	for(size_t i=0;i<numNormals;++i)
+		transformedNormals[i]=GeodeticToCartesianPointTransformNode::transformNormal(basePoints[i],normals[i]);
+	}
+
 }
@@ -70,6 +70,12 @@ class GeodeticToCartesianPointTransformNode:public PointTransformNode
 	virtual Point transformPoint(const Point& point) const;
 	virtual Box calcBoundingBox(const std::vector<Point>& points) const;
 	virtual Vector transformNormal(const Point& basePoint,const Vector& normal) const;
+	virtual void transformPoints(size_t numPoints,const Point* points,Point* transformedPoints) const;
+	virtual void transformNormals(size_t numNormals,const Point* basePoints,const Vector* normals,Vector* transformedNormals) const;
+	
+	/* New methods: */
+	void transformPointRange(size_t numPoints,const Point* points,Point* transformedPoints) const; // Transforms an array of points in the calling thread
+	void transformNormalRange(size_t numNormals,const Point* basePoints,const Vector* normals,Vector* transformedNormals) const; // Transforms an array of normal vectors in the calling thread
 	};
 
 }
@@ -28,6 +28,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Math/Constants.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/TriangleCollector.h>
+#include <SceneGraph/DrawListCollector.h>
 
 namespace SceneGraph {
 
@@ -104,6 +106,9 @@ void GeodeticToCartesianTransformNode::update(void)
 	/* Calculate the current transformation: */
 	ReferenceEllipsoidNode::Geoid::Frame frame=referenceEllipsoid.getValue()->getRE().geodeticToCartesianFrame(g);
 	transform=OGTransform(frame.getTranslation(),frame.getRotation(),referenceEllipsoid.getValue()->scale.getValue());
+	
+	/* Cache the children's bounding boxes for culling: */
+	updateChildBoxes();
 	}
 
 Box GeodeticToCartesianTransformNode::calcBoundingBox(void) const
@@ -115,9 +120,10 @@ Box GeodeticToCartesianTransformNode::calcBoundingBox(void) const
 		{
 		/* Calculate the group's bounding box as the union of the transformed children's boxes: */
 		Box result=Box::empty;
-		for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
+		bool useCachedBoxes=childBoxes.size()==children.getNumValues();
+		for(size_t i=0;i<children.getNumValues();++i)
 			{
-			Box childBox=(*chIt)->calcBoundingBox();
+			Box childBox=useCachedBoxes?childBoxes[i]:children.getValue(i)->calcBoundingBox();
 			childBox.transform(transform);
 			result.addBox(childBox);
 			}
@@ -130,12 +136,38 @@ void GeodeticToCartesianTransformNode::glRenderAction(GLRenderState& renderState
 	/* Push the transformation onto the matrix stack: */
 	OGTransform previousTransform=renderState.pushTransform(transform);
 	
-	/* Call the render actions of all children in order: */
-	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-		(*chIt)->glRenderAction(renderState);
+	/* Call the render actions of all visible children in order: */
+	renderChildren(renderState);
 		
 	/* Pop the transformation off the matrix stack: */
 	renderState.popTransform(previousTransform);
 	}
 
+
+void GeodeticToCartesianTransformNode::collectTriangles(TriangleCollector& collector) const
+	{
+	/* Push the transformation onto the collector's transformation stack: */
+	OGTransform previousTransform=collector.pushTransform(transform);
+	
+	/* Collect the triangles of all children in order: */
+	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
+		(*chIt)->collectTriangles(collector);
+	
+	/* Pop the transformation off the collector's transformation stack: */
+	collector.popTransform(previousTransform);
+	}
+
+void GeodeticToCartesianTransformNode::collectDrawItems(DrawListCollector& collector) const
+	{
+	/* Push the transformation onto the collector's transformation stack: */
+	OGTransform previousTransform=collector.pushTransform(transform);
+	
+	/* Collect the draw items of all children in order: */
+	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
+		collector.collectChild(**chIt);
+	
+	/* Pop the transformation off the collector's transformation stack: */
+	collector.popTransform(previousTransform);
+	}
+
 }
@@ -31,6 +31,7 @@ Methods of class GeometryNode:
 *****************************/
 
 GeometryNode::GeometryNode(void)
+	:geometryVersion(0)
 	{
 	}
 
@@ -45,6 +46,12 @@ void GeometryNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 	}
 
 void GeometryNode::update(void)
+	{
+	/* Bump up the geometry version number: */
+	++geometryVersion;
+	}
+
+void GeometryNode::collectTriangles(TriangleCollector& collector) const
 	{
 	}
 
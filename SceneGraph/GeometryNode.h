@@ -30,6 +30,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 /* Forward declarations: */
 namespace SceneGraph {
 class GLRenderState;
+class TriangleCollector;
 }
 
 namespace SceneGraph {
@@ -41,6 +42,8 @@ class GeometryNode:public Node
 	typedef SF<PointTransformNodePointer> SFPointTransformNode;
 	
 	/* Elements: */
+	private:
+	unsigned int geometryVersion; // Version number of the node's geometry, incremented on every update
 	
 	/* Fields: */
 	public:
@@ -53,12 +56,17 @@ class GeometryNode:public Node
 	/* Methods from Node: */
 	static const char* getStaticClassName(void);
 	virtual void parseField(const char* fieldName,VRMLFile& vrmlFile);
-	virtual void update(void);
+	virtual void update(void); // Bumps up the geometry version number; derived classes must call this from their own update methods
 	
 	/* New methods: */
 	public:
 	virtual Box calcBoundingBox(void) const =0; // Returns the bounding box of the geometry defined by the node
 	virtual void glRenderAction(GLRenderState& renderState) const =0; // Renders the geometry defined by the node into the current OpenGL context
+	virtual void collectTriangles(TriangleCollector& collector) const; // Adds the triangles of the geometry defined by the node to the given collector; default does nothing
+	unsigned int getGeometryVersion(void) const // Returns the version number of the node's geometry
+		{
+		return geometryVersion;
+		}
 	};
 
 typedef Misc::Autopointer<GeometryNode> GeometryNodePointer;
@@ -29,6 +29,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 /* Forward declarations: */
 namespace SceneGraph {
 class GLRenderState;
+class TriangleCollector;
+class DrawListCollector;
 }
 
 namespace SceneGraph {
@@ -39,6 +41,8 @@ class GraphNode:public Node
 	public:
 	virtual Box calcBoundingBox(void) const =0; // Returns the bounding box of the node
 	virtual void glRenderAction(GLRenderState& renderState) const =0; // Renders the node into the current OpenGL context
+	virtual void collectTriangles(TriangleCollector& collector) const; // Adds the triangles of the node's surfaces to the given collector; default does nothing
+	virtual void collectDrawItems(DrawListCollector& collector) const; // Adds the node's draw items to the given collector; default adds the node itself to be rendered through its render action
 	};
 
 typedef Misc::Autopointer<GraphNode> GraphNodePointer;
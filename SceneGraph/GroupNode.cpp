@@ -24,6 +24,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string.h>
 #include <SceneGraph/EventTypes.h>
 #include <SceneGraph/VRMLFile.h>
+#include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/OcclusionCuller.h>
+#include <SceneGraph/TriangleCollector.h>
+#include <SceneGraph/DrawListCollector.h>
 
 namespace SceneGraph {
 
@@ -31,6 +35,53 @@ namespace SceneGraph {
 Methods of class GroupNode:
 **************************/
 
+void GroupNode::updateChildBoxes(void)
+	{
+	/* Query the bounding boxes of all children in order: */
+	childBoxes.clear();
+	childBoxes.reserve(children.getNumValues());
+	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
+		childBoxes.push_back((*chIt)->calcBoundingBox());
+	}
+
+void GroupNode::renderChildren(GLRenderState& renderState) const
+	{
+	GLRenderState::CullingStatistics& stats=renderState.cullingStatistics;
+	const MFGraphNode::ValueList& c=children.getValues();
+	if(childBoxes.size()==c.size())
+		{
+		/* Call the render actions of all children whose bounding boxes survive culling: */
+		std::vector<Box>::const_iterator cbIt=childBoxes.begin();
+		for(MFGraphNode::ValueList::const_iterator chIt=c.begin();chIt!=c.end();++chIt,++cbIt)
+			{
+			++stats.numVisited;
+			if(renderState.cullBox(*cbIt))
+				continue;
+			
+			if(renderState.occlusionCuller!=0)
+				{
+				/* Let the occlusion culler decide whether to render the child: */
+				renderState.occlusionCuller->glRenderAction(**chIt,*cbIt,renderState);
+				}
+			else
+				{
+				++stats.numDrawn;
+				(*chIt)->glRenderAction(renderState);
+				}
+			}
+		}
+	else
+		{
+		/* The cached boxes are out of date; call the render actions of all children in order: */
+		for(MFGraphNode::ValueList::const_iterator chIt=c.begin();chIt!=c.end();++chIt)
+			{
+			++stats.numVisited;
+			++stats.numDrawn;
+			(*chIt)->glRenderAction(renderState);
+			}
+		}
+	}
+
 GroupNode::GroupNode(void)
 	:bboxCenter(Point::origin),
 	 bboxSize(Size(-1,-1,-1)),
@@ -142,6 +193,9 @@ void GroupNode::update(void)
 			}
 		explicitBoundingBox=Box(pmin,pmax);
 		}
+	
+	/* Cache the children's bounding boxes for culling: */
+	updateChildBoxes();
 	}
 
 Box GroupNode::calcBoundingBox(void) const
@@ -153,17 +207,40 @@ Box GroupNode::calcBoundingBox(void) const
 		{
 		/* Calculate the group's bounding box as the union of the children's boxes: */
 		Box result=Box::empty;
-		for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-			result.addBox((*chIt)->calcBoundingBox());
+		if(childBoxes.size()==children.getNumValues())
+			{
+			/* Use the cached boxes: */
+			for(std::vector<Box>::const_iterator cbIt=childBoxes.begin();cbIt!=childBoxes.end();++cbIt)
+				result.addBox(*cbIt);
+			}
+		else
+			{
+			for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
+				result.addBox((*chIt)->calcBoundingBox());
+			}
 		return result;
 		}
 	}
 
 void GroupNode::glRenderAction(GLRenderState& renderState) const
 	{
-	/* Call the render actions of all children in order: */
+	/* Call the render actions of all visible children in order: */
+	renderChildren(renderState);
+	}
+
+
+void GroupNode::collectTriangles(TriangleCollector& collector) const
+	{
+	/* Collect the triangles of all children in order: */
+	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
+		(*chIt)->collectTriangles(collector);
+	}
+
+void GroupNode::collectDrawItems(DrawListCollector& collector) const
+	{
+	/* Collect the draw items of all children in order: */
 	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-		(*chIt)->glRenderAction(renderState);
+		collector.collectChild(**chIt);
 	}
 
 }
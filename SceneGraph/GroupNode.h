@@ -53,6 +53,11 @@ class GroupNode:public GraphNode
 	protected:
 	bool haveExplicitBoundingBox; // Flag whether the node has an explicit bounding box
 	Box explicitBoundingBox; // The explicit bounding box, if it exists
+	std::vector<Box> childBoxes; // Cached bounding boxes of the node's children, recalculated by update()
+	
+	/* Protected methods: */
+	void updateChildBoxes(void); // Recalculates the cached bounding boxes of the node's children
+	void renderChildren(GLRenderState& renderState) const; // Calls the render actions of all children that survive the render state's culling tests
 	
 	/* Constructors and destructors: */
 	public:
@@ -69,6 +74,8 @@ class GroupNode:public GraphNode
 	/* Methods from GraphNode: */
 	virtual Box calcBoundingBox(void) const;
 	virtual void glRenderAction(GLRenderState& renderState) const;
+	virtual void collectTriangles(TriangleCollector& collector) const;
+	virtual void collectDrawItems(DrawListCollector& collector) const;
 	};
 
 typedef Misc::Autopointer<GroupNode> GroupNodePointer;
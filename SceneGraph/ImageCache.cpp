@@ -0,0 +1,351 @@
+/***********************************************************************
+ImageCache - Process-wide cache of decoded texture images shared by all
+scene graph nodes and decoded by background threads.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/ImageCache.h>
+
+#include <pthread.h>
+#include <sys/stat.h>
+#include <stdexcept>
+#include <Misc/HashTable.h>
+#include <Misc/StringHashFunctions.h>
+#include <Threads/MutexCond.h>
+#include <Threads/WorkerPool.h>
+#include <Images/RGBAImage.h>
+#include <Images/ReadImageFile.h>
+#include <SceneGraph/Internal/BackgroundJobs.h>
+
+namespace SceneGraph {
+
+namespace {
+
+/**************
+Helper objects:
+**************/
+
+typedef Misc::HashTable<std::string,ImageCache::Entry*> EntryMap; // Hash table type to map image URLs to cache entries
+
+struct CacheState // Structure holding the shared state of the image cache
+	{
+	/* Elements: */
+	public:
+	Threads::MutexCond mutex; // Mutex protecting the cache state and signaling finished decode jobs
+	EntryMap entryMap; // Map from image URLs to cache entries
+	ImageCache::Statistics statistics; // Current cache statistics
+	Images::MipmapChain::Filter mipmapFilter; // Filter to build mipmap chains
+	bool compressImages; // Flag whether to compress mipmap chains and cache them on disk
+	ImageCache::FinishedCallback finishedCallback; // Function to notify when a decode job finished
+	void* finishedCallbackUserData; // Opaque argument for the finished callback
+	
+	/* Constructors and destructors: */
+	CacheState(void)
+		:entryMap(31),
+		 mipmapFilter(Images::MipmapChain::LANCZOS),
+		 compressImages(false),
+		 finishedCallback(0),finishedCallbackUserData(0)
+		{
+		statistics.numHits=0;
+		statistics.numMisses=0;
+		statistics.numEntries=0;
+		statistics.numPending=0;
+		statistics.numBytes=0;
+		}
+	};
+
+pthread_once_t cacheStateOnce=PTHREAD_ONCE_INIT; // Guard to create the cache state exactly once
+CacheState* cacheState=0; // The shared cache state; never destroyed to avoid shutdown order problems with static scene graphs
+
+void createCacheState(void)
+	{
+	cacheState=new CacheState;
+	}
+
+inline CacheState& getCacheState(void)
+	{
+	pthread_once(&cacheStateOnce,createCacheState);
+	return *cacheState;
+	}
+
+inline size_t getImageSize(const ImageCache::Entry* entry) // Returns the memory size of a cache entry's mipmap chain in bytes
+	{
+	if(!entry->isValid())
+		return 0;
+	return entry->getMipmaps().getDataSize();
+	}
+
+}
+
+/******************************************
+Declaration of class ImageCache::DecodeJob:
+******************************************/
+
+class ImageCache::DecodeJob:public Threads::WorkerPool::Job
+	{
+	/* Elements: */
+	private:
+	Entry* entry; // The cache entry to decode; the job holds one use of the entry
+	
+	/* Constructors and destructors: */
+	public:
+	DecodeJob(Entry* sEntry)
+		:entry(sEntry)
+		{
+		}
+	
+	/* Methods from Threads::WorkerPool::Job: */
+	virtual void execute(void)
+		{
+		/* Get the current mipmap settings: */
+		Images::MipmapChain::Filter mipmapFilter;
+		bool compressImages;
+		{
+		CacheState& cs=getCacheState();
+		Threads::MutexCond::Lock cacheLock(cs.mutex);
+		mipmapFilter=cs.mipmapFilter;
+		compressImages=cs.compressImages;
+		}
+		
+		/* Build the mipmap chain directly into the entry, which is not accessed by anyone else until it is marked as finished: */
+		std::string error;
+		Images::MipmapChain* mipmaps=0;
+		try
+			{
+			/* Read a compressed mipmap chain from its cache file, or build it from scratch: */
+			const char* imageFileName=entry->url.c_str();
+			const bool gammaCorrect=true; // Texture images are assumed to be sRGB-encoded
+			mipmaps=new Images::MipmapChain;
+			if(!compressImages||!mipmaps->readCacheFile(imageFileName,mipmapFilter,gammaCorrect))
+				{
+				delete mipmaps;
+				mipmaps=0;
+				
+				/* Decode the image file; the decoded image is released as soon as the chain holds a copy of it: */
+				{
+				Images::RGBAImage image=Images::readTransparentImageFile(imageFileName);
+				mipmaps=new Images::MipmapChain(image,mipmapFilter,gammaCorrect);
+				}
+				if(compressImages)
+					{
+					mipmaps->compress();
+					mipmaps->writeCacheFile(imageFileName,mipmapFilter,gammaCorrect);
+					}
+				}
+			entry->mipmaps=mipmaps;
+			}
+		catch(std::runtime_error err)
+			{
+			delete mipmaps;
+			error=err.what();
+			}
+		catch(...)
+			{
+			/* Don't let unknown exceptions escape, or the entry would never be marked as finished: */
+			delete mipmaps;
+			error="ImageCache: Unknown error while decoding image file ";
+			error.append(entry->url);
+			}
+		
+		/* Publish the result; this releases the job's use of the entry: */
+		ImageCache::finishDecoding(entry,error);
+		}
+	};
+
+/**********************************
+Methods of class ImageCache::Entry:
+**********************************/
+
+ImageCache::Entry::Entry(const std::string& sUrl,off_t sFileSize,time_t sFileTime)
+	:url(sUrl),
+	 fileSize(sFileSize),fileTime(sFileTime),
+	 current(true),
+	 useCount(0),
+	 finished(false),
+	 mipmaps(0)
+	{
+	}
+
+ImageCache::Entry::~Entry(void)
+	{
+	delete mipmaps;
+	}
+
+bool ImageCache::Entry::isFinished(void) const
+	{
+	CacheState& cs=getCacheState();
+	Threads::MutexCond::Lock cacheLock(cs.mutex);
+	return finished;
+	}
+
+/***************************
+Methods of class ImageCache:
+***************************/
+
+void ImageCache::retireEntry(ImageCache::Entry* entry)
+	{
+	CacheState& cs=getCacheState();
+	
+	/* Remove the entry from the URL map so that the next acquire decodes the image again: */
+	if(entry->current)
+		{
+		cs.entryMap.removeEntry(entry->url);
+		entry->current=false;
+		}
+	}
+
+void ImageCache::destroyEntry(ImageCache::Entry* entry)
+	{
+	CacheState& cs=getCacheState();
+	
+	/* Remove the unused entry from the cache and destroy it: */
+	retireEntry(entry);
+	--cs.statistics.numEntries;
+	cs.statistics.numBytes-=getImageSize(entry);
+	delete entry;
+	}
+
+void ImageCache::finishDecoding(ImageCache::Entry* entry,const std::string& error)
+	{
+	CacheState& cs=getCacheState();
+	Threads::MutexCond::Lock cacheLock(cs.mutex);
+	
+	/* Mark the entry as finished: */
+	entry->error=error;
+	entry->finished=true;
+	--cs.statistics.numPending;
+	cs.statistics.numBytes+=getImageSize(entry);
+	
+	/* Release the decode job's use of the entry: */
+	if(--entry->useCount==0)
+		destroyEntry(entry);
+	
+	/* Wake up anyone waiting for pending decode jobs: */
+	cs.mutex.broadcast();
+	
+	/* Notify the application, e.g., to request a redraw that replaces placeholders: */
+	if(cs.finishedCallback!=0)
+		cs.finishedCallback(cs.finishedCallbackUserData);
+	}
+
+void ImageCache::setMipmapFilter(Images::MipmapChain::Filter newMipmapFilter)
+	{
+	CacheState& cs=getCacheState();
+	Threads::MutexCond::Lock cacheLock(cs.mutex);
+	cs.mipmapFilter=newMipmapFilter;
+	}
+
+void ImageCache::setCompressImages(bool newCompressImages)
+	{
+	CacheState& cs=getCacheState();
+	Threads::MutexCond::Lock cacheLock(cs.mutex);
+	cs.compressImages=newCompressImages;
+	}
+
+void ImageCache::setFinishedCallback(ImageCache::FinishedCallback newFinishedCallback,void* newFinishedCallbackUserData)
+	{
+	CacheState& cs=getCacheState();
+	Threads::MutexCond::Lock cacheLock(cs.mutex);
+	cs.finishedCallback=newFinishedCallback;
+	cs.finishedCallbackUserData=newFinishedCallbackUserData;
+	}
+
+ImageCache::Entry* ImageCache::acquireImage(const std::string& url)
+	{
+	/* Identify the current version of a local image file by its size and modification time: */
+	off_t fileSize=-1;
+	time_t fileTime=0;
+	struct stat fileStat;
+	if(stat(url.c_str(),&fileStat)==0)
+		{
+		fileSize=fileStat.st_size;
+		fileTime=fileStat.st_mtime;
+		}
+	
+	CacheState& cs=getCacheState();
+	Threads::MutexCond::Lock cacheLock(cs.mutex);
+	
+	/* Check if the image is already cached: */
+	EntryMap::Iterator eIt=cs.entryMap.findEntry(url);
+	if(!eIt.isFinished())
+		{
+		Entry* entry=eIt->getDest();
+		if(entry->fileSize==fileSize&&entry->fileTime==fileTime)
+			{
+			/* Share the existing entry: */
+			++cs.statistics.numHits;
+			++entry->useCount;
+			return entry;
+			}
+		
+		/* The image file changed; retire the stale entry, which stays alive until its current users release it: */
+		retireEntry(entry);
+		}
+	
+	/* Create a new entry used by the caller and the decode job: */
+	++cs.statistics.numMisses;
+	Entry* entry=new Entry(url,fileSize,fileTime);
+	entry->useCount=2;
+	cs.entryMap.setEntry(EntryMap::Entry(url,entry));
+	++cs.statistics.numEntries;
+	++cs.statistics.numPending;
+	
+	/* Decode the image in the background: */
+	submitBackgroundJob(new DecodeJob(entry));
+	
+	return entry;
+	}
+
+void ImageCache::releaseImage(ImageCache::Entry* entry)
+	{
+	CacheState& cs=getCacheState();
+	Threads::MutexCond::Lock cacheLock(cs.mutex);
+	
+	/* Destroy the entry if this was its last use: */
+	if(--entry->useCount==0)
+		destroyEntry(entry);
+	}
+
+void ImageCache::invalidateImage(const std::string& url)
+	{
+	CacheState& cs=getCacheState();
+	Threads::MutexCond::Lock cacheLock(cs.mutex);
+	
+	/* Retire the URL's current entry: */
+	EntryMap::Iterator eIt=cs.entryMap.findEntry(url);
+	if(!eIt.isFinished())
+		retireEntry(eIt->getDest());
+	}
+
+ImageCache::Statistics ImageCache::getStatistics(void)
+	{
+	CacheState& cs=getCacheState();
+	Threads::MutexCond::Lock cacheLock(cs.mutex);
+	return cs.statistics;
+	}
+
+void ImageCache::waitForImages(void)
+	{
+	CacheState& cs=getCacheState();
+	Threads::MutexCond::Lock cacheLock(cs.mutex);
+	while(cs.statistics.numPending>0)
+		cs.mutex.wait(cacheLock);
+	}
+
+}
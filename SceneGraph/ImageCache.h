@@ -0,0 +1,117 @@
+/***********************************************************************
+ImageCache - Process-wide cache of decoded texture images shared by all
+scene graph nodes and decoded by background threads.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_IMAGECACHE_INCLUDED
+#define SCENEGRAPH_IMAGECACHE_INCLUDED
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <time.h>
+#include <string>
+#include <Images/MipmapChain.h>
+
+namespace SceneGraph {
+
+class ImageCache
+	{
+	/* Embedded classes: */
+	private:
+	class DecodeJob; // Class to decode an image file in a background thread
+	friend class DecodeJob;
+	
+	public:
+	typedef void (*FinishedCallback)(void* userData); // Type for functions notified whenever a decode job finished
+	
+	class Entry // Class for cached images
+		{
+		friend class ImageCache;
+		friend class ImageCache::DecodeJob;
+		
+		/* Elements: */
+		private:
+		std::string url; // Fully-qualified URL of the image file
+		off_t fileSize; // Size of the image file when the entry was created, or -1 if the URL does not name a local file
+		time_t fileTime; // Modification time of the image file when the entry was created
+		bool current; // Flag whether the entry is the one the cache hands out for its URL; protected by the cache mutex
+		unsigned int useCount; // Number of clients and pending decode jobs using this entry; protected by the cache mutex
+		bool finished; // Flag whether the decode job finished, successfully or not; protected by the cache mutex
+		Images::MipmapChain* mipmaps; // Mipmap chain built from the decoded image, whose base level replaces the image; null if decoding failed; immutable once finished is set
+		std::string error; // Error message if decoding failed
+		
+		/* Constructors and destructors: */
+		Entry(const std::string& sUrl,off_t sFileSize,time_t sFileTime);
+		public:
+		~Entry(void);
+		
+		/* Methods: */
+		public:
+		const std::string& getUrl(void) const // Returns the image's URL
+			{
+			return url;
+			}
+		bool isFinished(void) const; // Returns true if the image has been decoded or failed to decode
+		bool isValid(void) const // Returns true if the image was decoded successfully; only valid after isFinished returned true
+			{
+			return mipmaps!=0;
+			}
+		const Images::MipmapChain& getMipmaps(void) const // Returns the mipmap chain; only valid after isValid returned true
+			{
+			return *mipmaps;
+			}
+		const std::string& getError(void) const // Returns the error message if decoding failed
+			{
+			return error;
+			}
+		};
+	
+	struct Statistics // Structure reporting cache usage
+		{
+		/* Elements: */
+		public:
+		size_t numHits; // Number of acquire calls that found an existing entry
+		size_t numMisses; // Number of acquire calls that started a new decode job
+		size_t numEntries; // Number of entries currently in the cache
+		size_t numPending; // Number of entries whose decode jobs have not finished yet
+		size_t numBytes; // Total size of all mipmap chains currently in the cache in bytes
+		};
+	
+	/* Private methods: */
+	private:
+	static void retireEntry(Entry* entry); // Removes an entry from the URL map so that it is no longer handed out; must be called with the cache mutex locked
+	static void destroyEntry(Entry* entry); // Retires an unused entry and destroys it; must be called with the cache mutex locked
+	static void finishDecoding(Entry* entry,const std::string& error); // Marks an entry as decoded and releases the decode job's use of it
+	
+	/* Methods: */
+	public:
+	static void setMipmapFilter(Images::MipmapChain::Filter newMipmapFilter); // Sets the filter used to build mipmap chains for subsequently decoded images
+	static void setCompressImages(bool newCompressImages); // Sets whether mipmap chains of subsequently decoded images are DXT-compressed and cached in files next to their source images
+	static void setFinishedCallback(FinishedCallback newFinishedCallback,void* newFinishedCallbackUserData); // Sets a function called from the decoding thread, with the cache locked, whenever a decode job finished; null disables notification
+	static Entry* acquireImage(const std::string& url); // Returns a cache entry for the image of the given fully-qualified URL and starts decoding it in the background if it is not yet cached or its file changed since it was cached; caller must release the entry
+	static void invalidateImage(const std::string& url); // Forces the next acquireImage call for the given URL to decode the image again; current users keep their entries
+	static void releaseImage(Entry* entry); // Releases a cache entry; destroys the entry and its image when no clients are left
+	static Statistics getStatistics(void); // Returns current cache statistics
+	static void waitForImages(void); // Blocks until all currently pending decode jobs have finished
+	};
+
+}
+
+#endif
@@ -24,8 +24,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string.h>
 #include <GL/gl.h>
 #include <GL/GLContextData.h>
+#include <GL/Extensions/GLARBTextureCompression.h>
+#include <GL/Extensions/GLEXTTextureCompressionS3TC.h>
 #include <Images/RGBAImage.h>
-#include <Images/ReadImageFile.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
 
@@ -37,9 +38,18 @@ Methods of class ImageTextureNode::DataItem:
 
 ImageTextureNode::DataItem::DataItem(void)
 	:textureObjectId(0),
-	 version(0)
+	 version(0),
+	 havePlaceholder(false),
+	 haveCompressedTextures(GLARBTextureCompression::isSupported()&&GLEXTTextureCompressionS3TC::isSupported())
 	{
 	glGenTextures(1,&textureObjectId);
+	
+	/* Initialize the texture compression extensions: */
+	if(haveCompressedTextures)
+		{
+		GLARBTextureCompression::initExtension();
+		GLEXTTextureCompressionS3TC::initExtension();
+		}
 	}
 
 ImageTextureNode::DataItem::~DataItem(void)
@@ -51,10 +61,29 @@ ImageTextureNode::DataItem::~DataItem(void)
 Methods of class ImageTextureNode:
 *********************************/
 
+void ImageTextureNode::uploadPlaceholder(void) const
+	{
+	/* Upload a single opaque white texel, which leaves the underlying material's color unchanged: */
+	static const GLubyte placeholder[4]={255,255,255,255};
+	glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8,1,1,0,GL_RGBA,GL_UNSIGNED_BYTE,placeholder);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_BASE_LEVEL,0);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAX_LEVEL,0);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+	}
+
 ImageTextureNode::ImageTextureNode(void)
 	:repeatS(true),repeatT(true),
-	 version(0)
+	 version(0),
+	 image(0)
+	{
+	}
+
+ImageTextureNode::~ImageTextureNode(void)
 	{
+	/* Release the texture image: */
+	if(image!=0)
+		ImageCache::releaseImage(image);
 	}
 
 const char* ImageTextureNode::getStaticClassName(void)
@@ -91,6 +120,16 @@ void ImageTextureNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void ImageTextureNode::update(void)
 	{
+	/* Get the texture image from the cache, which starts decoding it in the background if the URL or the image file changed: */
+	ImageCache::Entry* newImage=0;
+	if(url.getNumValues()>0)
+		newImage=ImageCache::acquireImage(url.getValue(0));
+	
+	/* Release the previous texture image after acquiring the new one, so that an unchanged image stays cached: */
+	if(image!=0)
+		ImageCache::releaseImage(image);
+	image=newImage;
+	
 	/* Bump up the texture's version number: */
 	++version;
 	}
@@ -105,26 +144,53 @@ void ImageTextureNode::setGLState(GLRenderState& renderState) const
 		/* Get the data item: */
 		DataItem* dataItem=renderState.contextData.retrieveDataItem<DataItem>(this);
 		
-		/* Bind the texture object: */
-		glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectId);
+		/* Bind the texture object unless it is already bound: */
+		renderState.bindTexture2D(dataItem->textureObjectId);
 		
 		/* Check if the texture object needs to be updated: */
 		if(dataItem->version!=version)
 			{
-			/* Load the texture image: */
-			Images::RGBAImage texture=Images::readTransparentImageFile(url.getValue(0).c_str());
-			
-			/* Upload the texture image: */
-			texture.glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8,false);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_BASE_LEVEL,0);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAX_LEVEL,0);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,repeatS.getValue()?GL_REPEAT:GL_CLAMP);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,repeatT.getValue()?GL_REPEAT:GL_CLAMP);
-			
-			/* Mark the texture object as up-to-date: */
-			dataItem->version=version;
+			if(image!=0&&image->isFinished())
+				{
+				/* Upload the decoded texture image, or the placeholder if the image could not be read: */
+				if(image->isValid())
+					{
+					const Images::MipmapChain& mipmaps=image->getMipmaps();
+					if(mipmaps.isCompressed()&&dataItem->haveCompressedTextures)
+						{
+						/* Upload the compressed mipmap chain: */
+						GLenum internalFormat=mipmaps.getFormat()==Images::MipmapChain::DXT1?GL_COMPRESSED_RGB_S3TC_DXT1_EXT:GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+						for(unsigned int l=0;l<mipmaps.getNumLevels();++l)
+							{
+							const Images::MipmapChain::Level& level=mipmaps.getLevel(l);
+							glCompressedTexImage2DARB(GL_TEXTURE_2D,l,internalFormat,level.size[0],level.size[1],0,level.dataSize,level.data);
+							}
+						glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_BASE_LEVEL,0);
+						glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAX_LEVEL,mipmaps.getNumLevels()-1);
+						glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_LINEAR);
+						}
+					else
+						{
+						/* Upload the mipmap chain uncompressed, decompressing it if the context does not support S3TC textures: */
+						mipmaps.glTexImage2D(GL_TEXTURE_2D,GL_RGBA8);
+						glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_LINEAR);
+						}
+					glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+					}
+				else
+					uploadPlaceholder();
+				glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,repeatS.getValue()?GL_REPEAT:GL_CLAMP);
+				glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,repeatT.getValue()?GL_REPEAT:GL_CLAMP);
+				
+				/* Mark the texture object as up-to-date: */
+				dataItem->version=version;
+				}
+			else if(!dataItem->havePlaceholder)
+				{
+				/* Show the placeholder until the texture image is decoded: */
+				uploadPlaceholder();
+				dataItem->havePlaceholder=true;
+				}
 			}
 		}
 	else
@@ -136,13 +202,7 @@ void ImageTextureNode::setGLState(GLRenderState& renderState) const
 
 void ImageTextureNode::resetGLState(GLRenderState& renderState) const
 	{
-	if(url.getNumValues()>0)
-		{
-		/* Unbind the texture object: */
-		glBindTexture(GL_TEXTURE_2D,0);
-		}
-	
-	/* Don't do anything else; next guy cleans up */
+	/* Don't do anything; the texture object stays bound for the next shape using it, and the render state restores the initial binding */
 	}
 
 void ImageTextureNode::initContext(GLContextData& contextData) const
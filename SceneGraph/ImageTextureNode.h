@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLObject.h>
 #include <SceneGraph/FieldTypes.h>
 #include <SceneGraph/TextureNode.h>
+#include <SceneGraph/ImageCache.h>
 
 namespace SceneGraph {
 
@@ -38,6 +39,8 @@ class ImageTextureNode:public TextureNode,public GLObject
 		/* Elements: */
 		GLuint textureObjectId; // ID of texture object
 		unsigned int version; // Version of texture in texture object
+		bool havePlaceholder; // Flag whether the texture object contains the placeholder image while the texture image is being decoded
+		bool haveCompressedTextures; // Flag whether the OpenGL context supports DXT-compressed textures
 		
 		/* Constructors and destructors: */
 		DataItem(void);
@@ -55,10 +58,15 @@ class ImageTextureNode:public TextureNode,public GLObject
 	/* Derived state: */
 	protected:
 	unsigned int version; // Version number of texture
+	ImageCache::Entry* image; // Cache entry for the texture image, decoded in the background; null if there is no URL
+	
+	/* Protected methods: */
+	void uploadPlaceholder(void) const; // Uploads a single-texel placeholder image into the currently bound texture object
 	
 	/* Constructors and destructors: */
 	public:
 	ImageTextureNode(void); // Creates a default image texture node with no texture image
+	virtual ~ImageTextureNode(void);
 	
 	/* Methods from Node: */
 	static const char* getStaticClassName(void);
@@ -23,6 +23,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/IndexedFaceSetNode.h>
 
 #include <string.h>
+#include <vector>
 #include <GL/gl.h>
 #include <GL/GLContextData.h>
 #include <GL/GLExtensionManager.h>
@@ -30,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLGeometryVertex.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/TriangleCollector.h>
 
 namespace SceneGraph {
 
@@ -161,6 +163,9 @@ void IndexedFaceSetNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void IndexedFaceSetNode::update(void)
 	{
+	/* Bump up the geometry version number: */
+	GeometryNode::update();
+	
 	/* Bump up the indexed face set's version number: */
 	++version;
 	}
@@ -248,6 +253,55 @@ void IndexedFaceSetNode::glRenderAction(GLRenderState& renderState) const
 		}
 	}
 
+void IndexedFaceSetNode::collectTriangles(TriangleCollector& collector) const
+	{
+	/* Bail out if there are no points: */
+	if(coord.getValue()==0||coord.getValue()->point.getNumValues()==0)
+		return;
+	
+	/* Get the face set's vertex positions, transformed by the point transformation if there is one: */
+	const std::vector<Point>& points=coord.getValue()->point.getValues();
+	size_t numPoints=points.size();
+	std::vector<Point> transformedPoints;
+	const Point* ps=&points[0];
+	if(pointTransform.getValue()!=0)
+		{
+		transformedPoints.resize(numPoints);
+		pointTransform.getValue()->transformPoints(numPoints,ps,&transformedPoints[0]);
+		ps=&transformedPoints[0];
+		}
+	
+	/* Triangulate each face as a triangle fan around its first vertex: */
+	const MFInt::ValueList& ci=coordIndex.getValues();
+	MFInt::ValueList::const_iterator faceBegin=ci.begin();
+	while(faceBegin!=ci.end())
+		{
+		/* Find the end of the current face and check its vertex indices: */
+		MFInt::ValueList::const_iterator faceEnd;
+		bool faceValid=true;
+		for(faceEnd=faceBegin;faceEnd!=ci.end()&&*faceEnd>=0;++faceEnd)
+			faceValid=faceValid&&size_t(*faceEnd)<numPoints;
+		
+		if(faceValid&&faceEnd-faceBegin>=3)
+			{
+			/* Add the face's triangles in counter-clockwise order: */
+			const Point& p0=ps[*faceBegin];
+			for(MFInt::ValueList::const_iterator vIt=faceBegin+1;vIt+1!=faceEnd;++vIt)
+				{
+				if(ccw.getValue())
+					collector.addTriangle(p0,ps[vIt[0]],ps[vIt[1]]);
+				else
+					collector.addTriangle(p0,ps[vIt[1]],ps[vIt[0]]);
+				}
+			}
+		
+		/* Go to the next face: */
+		faceBegin=faceEnd;
+		if(faceBegin!=ci.end())
+			++faceBegin;
+		}
+	}
+
 void IndexedFaceSetNode::initContext(GLContextData& contextData) const
 	{
 	/* Create a data item and store it in the context: */
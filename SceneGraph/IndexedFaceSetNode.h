@@ -99,6 +99,7 @@ class IndexedFaceSetNode:public GeometryNode,public GLObject
 	/* Methods from GeometryNode: */
 	virtual Box calcBoundingBox(void) const;
 	virtual void glRenderAction(GLRenderState& renderState) const;
+	virtual void collectTriangles(TriangleCollector& collector) const;
 	
 	/* Methods from GLObject: */
 	virtual void initContext(GLContextData& contextData) const;
@@ -66,6 +66,18 @@ IndexedLineSetNode::DataItem::~DataItem(void)
 Methods of class IndexedLineSetNode:
 ***********************************/
 
+const std::vector<Point>& IndexedLineSetNode::getPoints(std::vector<Point>& transformedPoints) const
+	{
+	const std::vector<Point>& points=coord.getValue()->point.getValues();
+	if(pointTransform.getValue()==0||points.empty())
+		return points;
+	
+	/* Transform all points in one batch instead of once per referencing vertex: */
+	transformedPoints.resize(points.size());
+	pointTransform.getValue()->transformPoints(points.size(),&points[0],&transformedPoints[0]);
+	return transformedPoints;
+	}
+
 void IndexedLineSetNode::uploadColoredLineSet(DataItem* dataItem) const
 	{
 	/* Define the vertex type used in the vertex array: */
@@ -75,8 +87,11 @@ void IndexedLineSetNode::uploadColoredLineSet(DataItem* dataItem) const
 	glBufferDataARB(GL_ARRAY_BUFFER_ARB,totalNumVertices*sizeof(Vertex),0,GL_STATIC_DRAW_ARB);
 	Vertex* vPtr=static_cast<Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
 	
+	/* Get the vertex positions: */
+	std::vector<Point> transformedPoints;
+	const std::vector<Point>& points=getPoints(transformedPoints);
+	
 	/* Copy vertices into the vertex buffer: */
-	const std::vector<Point>& points=coord.getValue()->point.getValues();
 	const MFInt::ValueList& coordIndices=coordIndex.getValues();
 	const std::vector<Color>& colors=color.getValue()->color.getValues();
 	const MFInt::ValueList& colorIndices=colorIndex.getValues();
@@ -90,10 +105,7 @@ void IndexedLineSetNode::uploadColoredLineSet(DataItem* dataItem) const
 				if(*coordIt>=0)
 					{
 					vPtr->color=colors[colorIndex];
-					if(pointTransform.getValue()!=0)
-						vPtr->position=pointTransform.getValue()->transformPoint(points[*coordIt]);
-					else
-						vPtr->position=points[*coordIt];
+					vPtr->position=points[*coordIt];
 					++vPtr;
 					++colorIndex;
 					}
@@ -107,10 +119,7 @@ void IndexedLineSetNode::uploadColoredLineSet(DataItem* dataItem) const
 				if(*coordIt>=0)
 					{
 					vPtr->color=colors[*colorIt];
-					if(pointTransform.getValue()!=0)
-						vPtr->position=pointTransform.getValue()->transformPoint(points[*coordIt]);
-					else
-						vPtr->position=points[*coordIt];
+					vPtr->position=points[*coordIt];
 					++vPtr;
 					}
 				++colorIt;
@@ -127,10 +136,7 @@ void IndexedLineSetNode::uploadColoredLineSet(DataItem* dataItem) const
 				if(*coordIt>=0)
 					{
 					vPtr->color=colors[colorIndex];
-					if(pointTransform.getValue()!=0)
-						vPtr->position=pointTransform.getValue()->transformPoint(points[*coordIt]);
-					else
-						vPtr->position=points[*coordIt];
+					vPtr->position=points[*coordIt];
 					++vPtr;
 					}
 				else
@@ -145,10 +151,7 @@ void IndexedLineSetNode::uploadColoredLineSet(DataItem* dataItem) const
 				if(*coordIt>=0)
 					{
 					vPtr->color=colors[*colorIt];
-					if(pointTransform.getValue()!=0)
-						vPtr->position=pointTransform.getValue()->transformPoint(points[*coordIt]);
-					else
-						vPtr->position=points[*coordIt];
+					vPtr->position=points[*coordIt];
 					++vPtr;
 					}
 				else
@@ -169,17 +172,17 @@ void IndexedLineSetNode::uploadLineSet(DataItem* dataItem) const
 	glBufferDataARB(GL_ARRAY_BUFFER_ARB,totalNumVertices*sizeof(Vertex),0,GL_STATIC_DRAW_ARB);
 	Vertex* vPtr=static_cast<Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
 	
+	/* Get the vertex positions: */
+	std::vector<Point> transformedPoints;
+	const std::vector<Point>& points=getPoints(transformedPoints);
+	
 	/* Copy vertices into the vertex buffer: */
-	const std::vector<Point>& points=coord.getValue()->point.getValues();
 	const MFInt::ValueList& coordIndices=coordIndex.getValues();
 	for(MFInt::ValueList::const_iterator coordIt=coordIndices.begin();coordIt!=coordIndices.end();++coordIt)
 		{
 		if(*coordIt>=0)
 			{
-			if(pointTransform.getValue()!=0)
-				vPtr->position=pointTransform.getValue()->transformPoint(points[*coordIt]);
-			else
-				vPtr->position=points[*coordIt];
+			vPtr->position=points[*coordIt];
 			++vPtr;
 			}
 		}
@@ -237,6 +240,9 @@ void IndexedLineSetNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void IndexedLineSetNode::update(void)
 	{
+	/* Bump up the geometry version number: */
+	GeometryNode::update();
+	
 	/* Iterate over the coordinate index array to count the number of vertices for each line and the total number of vertices: */
 	const MFInt::ValueList& coordIndices=coordIndex.getValues();
 	numVertices.clear();
@@ -362,8 +368,11 @@ void IndexedLineSetNode::glRenderAction(GLRenderState& renderState) const
 		
 		if(coord.getValue()!=0)
 			{
+			/* Get the vertex positions: */
+			std::vector<Point> transformedPoints;
+			const std::vector<Point>& points=getPoints(transformedPoints);
+			
 			/* Draw the line set: */
-			const std::vector<Point>& points=coord.getValue()->point.getValues();
 			const MFInt::ValueList& coordIndices=coordIndex.getValues();
 			if(color.getValue()!=0)
 				{
@@ -382,10 +391,7 @@ void IndexedLineSetNode::glRenderAction(GLRenderState& renderState) const
 							glColor(colors[colorCounter]);
 						else
 							glColor(colors[*colorIt]);
-						if(pointTransform.getValue()!=0)
-							glVertex(pointTransform.getValue()->transformPoint(points[*coordIt]));
-						else
-							glVertex(points[*coordIt]);
+						glVertex(points[*coordIt]);
 						if(colorPerVertex.getValue())
 							++colorIt;
 						++coordIt;
@@ -411,10 +417,7 @@ void IndexedLineSetNode::glRenderAction(GLRenderState& renderState) const
 					glBegin(GL_LINE_STRIP);
 					while(*coordIt>=0)
 						{
-						if(pointTransform.getValue()!=0)
-							glVertex(pointTransform.getValue()->transformPoint(points[*coordIt]));
-						else
-							glVertex(points[*coordIt]);
+						glVertex(points[*coordIt]);
 						++coordIt;
 						}
 					glEnd();
@@ -71,6 +71,7 @@ class IndexedLineSetNode:public GeometryNode,public GLObject
 	unsigned int version; // Version number of indexed line set
 	
 	/* Protected methods: */
+	const std::vector<Point>& getPoints(std::vector<Point>& transformedPoints) const; // Returns the coordinate node's points, transformed in one batch into the given list if there is a point transformation
 	void uploadColoredLineSet(DataItem* dataItem) const;
 	void uploadLineSet(DataItem* dataItem) const;
 	
@@ -23,17 +23,168 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/InlineNode.h>
 
 #include <string.h>
+#include <stdexcept>
+#include <GL/gl.h>
+#include <GL/GLColorTemplates.h>
+#include <GL/GLGeometryWrappers.h>
 #include <Cluster/OpenFile.h>
+#include <Cluster/MulticastPipe.h>
 #include <SceneGraph/VRMLFile.h>
+#include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/DrawListCollector.h>
+#include <SceneGraph/Internal/BackgroundJobs.h>
 
 namespace SceneGraph {
 
+/****************************************
+Declaration of class InlineNode::LoadJob:
+****************************************/
+
+class InlineNode::LoadJob:public Threads::WorkerPool::Job
+	{
+	/* Elements: */
+	private:
+	InlineNode* node; // The inline node whose external file is loaded
+	std::string fileName; // Fully-qualified URL of the external file
+	
+	/* Constructors and destructors: */
+	public:
+	LoadJob(InlineNode* sNode,const std::string& sFileName)
+		:node(sNode),fileName(sFileName)
+		{
+		}
+	
+	/* Methods from Threads::WorkerPool::Job: */
+	virtual void execute(void)
+		{
+		/* Parse the external VRML file into a temporary group node that is not yet visible to the main thread: */
+		GroupNodePointer root=new GroupNode;
+		std::vector<NodePointer> updates;
+		std::string error;
+		try
+			{
+			/* Parse the file without updating any nodes, because node updates can create OpenGL-related state and must run on the main thread: */
+			VRMLFile externalVrmlFile(fileName,Cluster::openFile(node->multiplexer,fileName.c_str()),*node->nodeCreator,node->multiplexer);
+			externalVrmlFile.setInBackground(true);
+			externalVrmlFile.setDeferredUpdates(&updates);
+			externalVrmlFile.parse(root);
+			
+			/* Load the external files of all nested inline nodes, which appends to the list of deferred updates: */
+			for(size_t i=0;i<updates.size();++i)
+				{
+				InlineNode* inlineNode=dynamic_cast<InlineNode*>(updates[i].getPointer());
+				if(inlineNode!=0)
+					inlineNode->loadNested(updates);
+				}
+			}
+		catch(std::runtime_error err)
+			{
+			/* Remember the error and hand over an empty result: */
+			error=err.what();
+			root=new GroupNode;
+			updates.clear();
+			}
+		
+		/* Hand the result to the inline node; the local references are released while holding the lock because node reference counts are not thread-safe: */
+		Threads::MutexCond::Lock loadLock(node->loadCond);
+		node->loadedRoot=root;
+		root=0;
+		node->loadedUpdates.swap(updates);
+		node->loadError=error;
+		node->loadFinished=true;
+		node->loadCond.broadcast();
+		}
+	};
+
+/***********************************
+Static elements of class InlineNode:
+***********************************/
+
+std::list<InlineNode*> InlineNode::pendingLoads;
+
 /***************************
 Methods of class InlineNode:
 ***************************/
 
+void InlineNode::startBackgroundLoad(const std::string& fileName)
+	{
+	/* Finish any previous background load first: */
+	if(loadPending)
+		swapInLoadedChildren();
+	
+	/* Register the node as loading: */
+	loadPending=true;
+	loadFinished=false;
+	pendingLoads.push_back(this);
+	
+	/* Submit the load job: */
+	submitBackgroundJob(new LoadJob(this,fileName));
+	}
+
+void InlineNode::loadNested(std::vector<NodePointer>& deferredUpdates)
+	{
+	if(loadRequested&&url.getNumValues()>0)
+		{
+		loadRequested=false;
+		
+		/* Load the external VRML file immediately, deferring all node updates: */
+		VRMLFile externalVrmlFile(url.getValue(0),Cluster::openFile(multiplexer,url.getValue(0).c_str()),*nodeCreator,multiplexer);
+		externalVrmlFile.setInBackground(true);
+		externalVrmlFile.setDeferredUpdates(&deferredUpdates);
+		externalVrmlFile.parse(this);
+		
+		/* Update this node again after its new children, to cache their bounding boxes: */
+		deferredUpdates.push_back(this);
+		}
+	}
+
+void InlineNode::swapInLoadedChildren(void)
+	{
+	/* Wait for the load job to finish and take its result: */
+	GroupNodePointer root;
+	std::vector<NodePointer> updates;
+	{
+	Threads::MutexCond::Lock loadLock(loadCond);
+	while(!loadFinished)
+		loadCond.wait(loadLock);
+	root=loadedRoot;
+	loadedRoot=0;
+	updates.swap(loadedUpdates);
+	}
+	
+	/* Update the loaded nodes in parse order, as the parser would have done: */
+	for(std::vector<NodePointer>::iterator uIt=updates.begin();uIt!=updates.end();++uIt)
+		(*uIt)->update();
+	
+	/* Append the loaded top-level nodes to the node's children: */
+	const MFGraphNode::ValueList& lc=root->children.getValues();
+	for(MFGraphNode::ValueList::const_iterator lcIt=lc.begin();lcIt!=lc.end();++lcIt)
+		children.appendValue(*lcIt);
+	updateChildBoxes();
+	
+	/* Unregister the node: */
+	loadPending=false;
+	for(std::list<InlineNode*>::iterator plIt=pendingLoads.begin();plIt!=pendingLoads.end();++plIt)
+		if(*plIt==this)
+			{
+			pendingLoads.erase(plIt);
+			break;
+			}
+	}
+
 InlineNode::InlineNode(void)
+	:loadInBackground(false),
+	 nodeCreator(0),multiplexer(0),parsedInBackground(false),
+	 loadRequested(false),
+	 loadPending(false),loadFinished(false)
+	{
+	}
+
+InlineNode::~InlineNode(void)
 	{
+	/* Wait for a pending background load, which still references this node: */
+	if(loadPending)
+		swapInLoadedChildren();
 	}
 
 const char* InlineNode::getStaticClassName(void)
@@ -52,10 +203,17 @@ void InlineNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 		{
 		vrmlFile.parseField(url);
 		
-		/* Load the external VRML file: */
-		std::string externalFileName=vrmlFile.getFullUrl(url.getValue(0));
-		SceneGraph::VRMLFile externalVrmlFile(externalFileName,Cluster::openFile(vrmlFile.getMultiplexer(),externalFileName.c_str()),vrmlFile.getNodeCreator(),vrmlFile.getMultiplexer());
-		externalVrmlFile.parse(this);
+		/* Remember how to load the external VRML file during the next update: */
+		for(size_t i=0;i<url.getNumValues();++i)
+			url.setValue(i,vrmlFile.getFullUrl(url.getValue(i)));
+		nodeCreator=&vrmlFile.getNodeCreator();
+		multiplexer=vrmlFile.getMultiplexer();
+		parsedInBackground=vrmlFile.isInBackground();
+		loadRequested=true;
+		}
+	else if(strcmp(fieldName,"loadInBackground")==0)
+		{
+		vrmlFile.parseField(loadInBackground);
 		}
 	else
 		GroupNode::parseField(fieldName,vrmlFile);
@@ -63,6 +221,156 @@ void InlineNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void InlineNode::update(void)
 	{
+	/* Update the group node state: */
+	GroupNode::update();
+	
+	if(loadRequested&&url.getNumValues()>0)
+		{
+		loadRequested=false;
+		
+		/*******************************************************************
+		Nodes inside a file that is already loading in the background are
+		loaded as part of that load. In a cluster, every file opened during
+		a load creates a multicast pipe, which must be created by the main
+		thread in the same order on the master and all slaves, so inline
+		files are then always loaded immediately.
+		*******************************************************************/
+		
+		if(loadInBackground.getValue()&&!parsedInBackground&&multiplexer==0)
+			{
+			/* Start loading the external VRML file in the background: */
+			startBackgroundLoad(url.getValue(0));
+			}
+		else
+			{
+			/* Load the external VRML file immediately: */
+			VRMLFile externalVrmlFile(url.getValue(0),Cluster::openFile(multiplexer,url.getValue(0).c_str()),*nodeCreator,multiplexer);
+			externalVrmlFile.setInBackground(parsedInBackground);
+			externalVrmlFile.parse(this);
+			
+			/* Cache the loaded children's bounding boxes for culling: */
+			updateChildBoxes();
+			}
+		}
+	}
+
+void InlineNode::glRenderAction(GLRenderState& renderState) const
+	{
+	/* Get the explicit bounding box, or the bounds of the children loaded so far: */
+	Box box=loadPending?calcBoundingBox():Box::empty;
+	if(!box.isNull()&&!box.isFull())
+		{
+		/* Draw the bounding box as a placeholder while the external file is loading: */
+		renderState.disableMaterials();
+		renderState.disableTextures();
+		GLRenderState::Color color=renderState.emissiveColor;
+		if(color[0]==0.0f&&color[1]==0.0f&&color[2]==0.0f)
+			{
+			/* Use a default color that is visible against the default black background: */
+			color=GLRenderState::Color(1.0f,1.0f,1.0f);
+			}
+		glColor(color);
+		glBegin(GL_LINES);
+		for(int axis=0;axis<3;++axis)
+			{
+			/* Draw the four box edges parallel to the current axis: */
+			int axisBit=1<<axis;
+			for(int i=0;i<8;++i)
+				if((i&axisBit)==0)
+					{
+					glVertex(box.getVertex(i));
+					glVertex(box.getVertex(i|axisBit));
+					}
+			}
+		glEnd();
+		}
+	
+	/* Render all children that have been loaded so far: */
+	GroupNode::glRenderAction(renderState);
+	}
+
+void InlineNode::collectDrawItems(DrawListCollector& collector) const
+	{
+	if(loadPending)
+		{
+		/* Render the node through its render action to draw the placeholder until the load finishes: */
+		collector.addNode(*this,calcBoundingBox());
+		}
+	else
+		GroupNode::collectDrawItems(collector);
+	}
+
+bool InlineNode::finishLoading(bool wait)
+	{
+	if(!loadPending)
+		return false;
+	
+	if(!wait)
+		{
+		/* Check if the load job has finished: */
+		Threads::MutexCond::Lock loadLock(loadCond);
+		if(!loadFinished)
+			return false;
+		}
+	
+	/* Swap in the loaded nodes: */
+	swapInLoadedChildren();
+	return true;
+	}
+
+bool InlineNode::haveBackgroundLoads(void)
+	{
+	return !pendingLoads.empty();
+	}
+
+unsigned int InlineNode::finishBackgroundLoads(Cluster::MulticastPipe* pipe)
+	{
+	/* Bail out if there is nothing to do; the pending list is identical on all cluster nodes: */
+	if(pendingLoads.empty())
+		return 0;
+	
+	if(pipe==0)
+		{
+		/* Swap in all finished loads: */
+		unsigned int numSwapped=0;
+		for(std::list<InlineNode*>::iterator plIt=pendingLoads.begin();plIt!=pendingLoads.end();)
+			{
+			/* Advance the iterator first because finishing a load removes the node from the list: */
+			InlineNode* node=*plIt;
+			++plIt;
+			if(node->finishLoading(false))
+				++numSwapped;
+			}
+		return numSwapped;
+		}
+	else
+		{
+		/*******************************************************************
+		Loads finish at different times on different cluster nodes. The
+		master determines how many loads at the head of the pending list
+		have finished, and all nodes swap in exactly those loads during the
+		same frame; slaves wait for their copies to finish if necessary.
+		*******************************************************************/
+		
+		unsigned int numFinished=0;
+		if(pipe->isMaster())
+			{
+			for(std::list<InlineNode*>::iterator plIt=pendingLoads.begin();plIt!=pendingLoads.end();++plIt,++numFinished)
+				{
+				Threads::MutexCond::Lock loadLock((*plIt)->loadCond);
+				if(!(*plIt)->loadFinished)
+					break;
+				}
+			pipe->broadcast(numFinished);
+			pipe->flush();
+			}
+		else
+			pipe->broadcast(numFinished);
+		
+		for(unsigned int i=0;i<numFinished&&!pendingLoads.empty();++i)
+			pendingLoads.front()->finishLoading(true);
+		return numFinished;
+		}
 	}
 
 }
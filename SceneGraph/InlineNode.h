@@ -23,28 +23,85 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_INLINENODE_INCLUDED
 #define SCENEGRAPH_INLINENODE_INCLUDED
 
+#include <string>
+#include <list>
+#include <vector>
+#include <Threads/MutexCond.h>
 #include <SceneGraph/FieldTypes.h>
 #include <SceneGraph/GroupNode.h>
 
+/* Forward declarations: */
+namespace Cluster {
+class Multiplexer;
+class MulticastPipe;
+}
+namespace SceneGraph {
+class NodeCreator;
+}
+
 namespace SceneGraph {
 
 class InlineNode:public GroupNode
 	{
+	/* Embedded classes: */
+	private:
+	class LoadJob; // Background job to parse the external VRML file
+	friend class LoadJob;
+	
 	/* Elements: */
+	static std::list<InlineNode*> pendingLoads; // List of inline nodes with unfinished background loads, in submission order; only accessed from the main thread
 	
 	/* Fields: */
 	public:
 	MFString url;
+	SFBool loadInBackground; // Flag whether to parse the external VRML file in a background thread; ignored in a cluster, where files are always parsed by the main thread
+	
+	/* Derived state: */
+	protected:
+	NodeCreator* nodeCreator; // Node creator of the VRML file containing this node
+	Cluster::Multiplexer* multiplexer; // Multicast pipe multiplexer of the VRML file containing this node
+	bool parsedInBackground; // Flag whether this node was itself created by a background load
+	bool loadRequested; // Flag whether the url field was changed since the last update
+	mutable Threads::MutexCond loadCond; // Condition variable protecting the background load state and signaling load completion
+	bool loadPending; // Flag whether a background load was started and its result has not yet been swapped in
+	bool loadFinished; // Flag whether the background load job has finished
+	GroupNodePointer loadedRoot; // Group node holding the external file's top-level nodes after a successful background load
+	std::vector<NodePointer> loadedUpdates; // Nodes created by the background load whose update methods are called by the main thread, in parse order
+	std::string loadError; // Error message from the most recent failed load
+	
+	/* Private methods: */
+	private:
+	void startBackgroundLoad(const std::string& fileName); // Starts loading the given external VRML file in the background
+	void loadNested(std::vector<NodePointer>& deferredUpdates); // Loads the external VRML file of an inline node created by a background load, deferring all node updates into the given list
+	void swapInLoadedChildren(void); // Waits for the background load to finish, updates the loaded nodes, and adds them to the node's children
 	
 	/* Constructors and destructors: */
 	public:
 	InlineNode(void); // Creates a default inline node
+	virtual ~InlineNode(void); // Waits for any pending background load and destroys the node
 	
 	/* Methods from Node: */
 	static const char* getStaticClassName(void);
 	virtual const char* getClassName(void) const;
 	virtual void parseField(const char* fieldName,VRMLFile& vrmlFile);
 	virtual void update(void);
+	
+	/* Methods from GraphNode: */
+	virtual void glRenderAction(GLRenderState& renderState) const;
+	virtual void collectDrawItems(DrawListCollector& collector) const;
+	
+	/* New methods: */
+	bool isLoading(void) const // Returns true if the external VRML file is still being loaded in the background
+		{
+		return loadPending;
+		}
+	const std::string& getLoadError(void) const // Returns the error message from the most recent failed load, or an empty string
+		{
+		return loadError;
+		}
+	bool finishLoading(bool wait); // Swaps in the result of a finished background load; waits for an unfinished load if flag is true; returns true if the children changed
+	static bool haveBackgroundLoads(void); // Returns true if any inline nodes have unfinished background loads
+	static unsigned int finishBackgroundLoads(Cluster::MulticastPipe* pipe =0); // Swaps in all finished background loads at a frame boundary; uses the given pipe to agree on the set of finished loads across a cluster; must be called from the main thread; returns number of swapped-in loads
 	};
 
 }
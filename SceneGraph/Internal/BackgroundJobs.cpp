@@ -0,0 +1,215 @@
+/***********************************************************************
+BackgroundJobs - Function to execute jobs such as geometry generation or
+file loading in a process-wide pool of background threads shared by all
+scene graph nodes.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/Internal/BackgroundJobs.h>
+
+#include <pthread.h>
+#include <string>
+#include <stdexcept>
+#include <Threads/MutexCond.h>
+#include <Threads/ParallelFor.h>
+
+namespace SceneGraph {
+
+namespace {
+
+/**************
+Helper objects:
+**************/
+
+pthread_once_t workerPoolOnce=PTHREAD_ONCE_INIT; // Guard to create the worker pool exactly once
+Threads::WorkerPool* workerPool=0; // The shared worker pool; never destroyed to avoid shutdown order problems with static scene graphs
+
+void createWorkerPool(void)
+	{
+	/* Use one thread less than there are processors to leave one for the rendering loop, but at least one: */
+	unsigned int numThreads=Threads::getNumParallelForThreads();
+	if(numThreads>1)
+		--numThreads;
+	workerPool=new Threads::WorkerPool(numThreads);
+	}
+
+pthread_once_t frameWorkerPoolOnce=PTHREAD_ONCE_INIT; // Guard to create the frame worker pool exactly once
+Threads::WorkerPool* frameWorkerPool=0; // Pool for short jobs the submitting thread waits on, kept separate so they never queue behind file loads; never destroyed
+
+void createFrameWorkerPool(void)
+	{
+	/* The submitting thread works alongside the pool, so use one thread less than there are processors, but at least one: */
+	unsigned int numThreads=Threads::getNumParallelForThreads();
+	if(numThreads>1)
+		--numThreads;
+	frameWorkerPool=new Threads::WorkerPool(numThreads);
+	}
+
+struct FrameLoopState // Structure shared by the threads executing a frame loop
+	{
+	/* Elements: */
+	public:
+	FrameLoopBody& body; // The loop body
+	size_t numIndices; // Number of loop iterations
+	Threads::MutexCond mutexCond; // Condition variable protecting the following state and signalled when a job finishes
+	size_t nextIndex; // Index of the next loop iteration to be executed
+	unsigned int numActiveJobs; // Number of helper jobs that have not finished yet
+	bool failed; // Flag whether a loop iteration executed by a helper job threw an exception
+	std::string error; // Message of the first exception thrown in a helper job
+	
+	/* Constructors and destructors: */
+	FrameLoopState(FrameLoopBody& sBody,size_t sNumIndices)
+		:body(sBody),numIndices(sNumIndices),
+		 nextIndex(0),numActiveJobs(0),
+		 failed(false)
+		{
+		}
+	
+	/* Methods: */
+	void cancel(void) // Stops handing out loop iterations after an exception
+		{
+		Threads::MutexCond::Lock lock(mutexCond);
+		nextIndex=numIndices;
+		}
+	void fail(const char* message) // Records an exception thrown in a helper job and stops handing out loop iterations
+		{
+		Threads::MutexCond::Lock lock(mutexCond);
+		if(!failed)
+			{
+			failed=true;
+			error=message;
+			}
+		nextIndex=numIndices;
+		}
+	void waitForJobs(void) // Blocks until all helper jobs have finished
+		{
+		Threads::MutexCond::Lock lock(mutexCond);
+		while(numActiveJobs>0)
+			mutexCond.wait(lock);
+		}
+	};
+
+void executeFrameLoop(FrameLoopState& state)
+	{
+	while(true)
+		{
+		/* Grab the next loop iteration: */
+		size_t index;
+		{
+		Threads::MutexCond::Lock lock(state.mutexCond);
+		if(state.nextIndex==state.numIndices)
+			break;
+		index=state.nextIndex;
+		++state.nextIndex;
+		}
+		
+		/* Execute the loop iteration: */
+		state.body(index);
+		}
+	}
+
+class FrameLoopJob:public Threads::WorkerPool::Job // Class for helper jobs executing a frame loop in the frame worker pool
+	{
+	/* Elements: */
+	private:
+	FrameLoopState& state; // Shared frame loop state
+	
+	/* Constructors and destructors: */
+	public:
+	FrameLoopJob(FrameLoopState& sState)
+		:state(sState)
+		{
+		}
+	
+	/* Methods from Threads::WorkerPool::Job: */
+	virtual void execute(void)
+		{
+		/* Execute loop iterations, and hand any exception to the thread running the loop: */
+		try
+			{
+			executeFrameLoop(state);
+			}
+		catch(std::runtime_error err)
+			{
+			state.fail(err.what());
+			}
+		catch(...)
+			{
+			state.fail("SceneGraph::runFrameLoop: Unknown exception in loop body");
+			}
+		
+		/* Notify the thread running the loop, even after an exception, so it never waits forever: */
+		Threads::MutexCond::Lock lock(state.mutexCond);
+		--state.numActiveJobs;
+		state.mutexCond.signal();
+		}
+	};
+
+}
+
+void submitBackgroundJob(Threads::WorkerPool::Job* job)
+	{
+	pthread_once(&workerPoolOnce,createWorkerPool);
+	workerPool->submitJob(job);
+	}
+
+void submitFrameJob(Threads::WorkerPool::Job* job)
+	{
+	pthread_once(&frameWorkerPoolOnce,createFrameWorkerPool);
+	frameWorkerPool->submitJob(job);
+	}
+
+void runFrameLoop(size_t numIndices,FrameLoopBody& body,unsigned int maxNumThreads)
+	{
+	if(numIndices==0)
+		return;
+	
+	/* Start helper jobs, leaving one iteration for the calling thread: */
+	if(maxNumThreads==0)
+		maxNumThreads=Threads::getNumParallelForThreads();
+	size_t numJobs=maxNumThreads-1;
+	if(numJobs>numIndices-1)
+		numJobs=numIndices-1;
+	FrameLoopState state(body,numIndices);
+	state.numActiveJobs=(unsigned int)numJobs;
+	for(size_t i=0;i<numJobs;++i)
+		submitFrameJob(new FrameLoopJob(state));
+	
+	/* Execute loop iterations in the calling thread as well: */
+	try
+		{
+		executeFrameLoop(state);
+		}
+	catch(...)
+		{
+		/* Stop the helper jobs and wait for them before the shared state goes out of scope: */
+		state.cancel();
+		state.waitForJobs();
+		throw;
+		}
+	
+	/* Wait for all helper jobs to finish: */
+	state.waitForJobs();
+	
+	/* Pass an exception from a helper job on to the caller: */
+	if(state.failed)
+		throw std::runtime_error(state.error);
+	}
+
+}
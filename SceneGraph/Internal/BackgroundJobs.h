@@ -0,0 +1,50 @@
+/***********************************************************************
+BackgroundJobs - Function to execute jobs such as geometry generation or
+file loading in a process-wide pool of background threads shared by all
+scene graph nodes.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_INTERNAL_BACKGROUNDJOBS_INCLUDED
+#define SCENEGRAPH_INTERNAL_BACKGROUNDJOBS_INCLUDED
+
+#include <stddef.h>
+#include <Threads/WorkerPool.h>
+
+namespace SceneGraph {
+
+class FrameLoopBody // Abstract base class for loop bodies executed by runFrameLoop
+	{
+	/* Constructors and destructors: */
+	public:
+	virtual ~FrameLoopBody(void)
+		{
+		}
+	
+	/* Methods: */
+	virtual void operator()(size_t index) =0; // Processes the loop iteration of the given index; called concurrently for different indices
+	};
+
+void submitBackgroundJob(Threads::WorkerPool::Job* job); // Queues a job for execution by the shared worker pool, which is created on first use; the pool takes ownership of the job
+void submitFrameJob(Threads::WorkerPool::Job* job); // Queues a short job that the calling thread waits for, such as per-frame scene graph work, for execution by a separate shared worker pool; takes ownership of the job
+void runFrameLoop(size_t numIndices,FrameLoopBody& body,unsigned int maxNumThreads =0); // Calls the loop body for all indices in [0, numIndices) using at most the given number of threads from the frame worker pool and the calling thread (0: one per processor); returns when all iterations are done; if an iteration throws, no further iterations are started and the exception is rethrown, or converted to std::runtime_error if thrown by a helper thread, once all threads have stopped
+
+}
+
+#endif
@@ -25,14 +25,61 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <vector>
 #include <Misc/Utility.h>
 #include <Misc/ThrowStdErr.h>
+#include <Math/Math.h>
 #include <SceneGraph/Internal/Doom3FileManager.h>
 #include <SceneGraph/Internal/Doom3ValueSource.h>
 #include <SceneGraph/Internal/Doom3MD5Mesh.h>
 
 namespace SceneGraph {
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+Doom3MD5Anim::Rotation slerp(const Doom3MD5Anim::Rotation& r0,const Doom3MD5Anim::Rotation& r1,Doom3MD5Anim::Scalar t)
+	{
+	typedef Doom3MD5Anim::Scalar Scalar;
+	const Scalar* q0=r0.getQuaternion();
+	const Scalar* q1=r1.getQuaternion();
+	
+	/* Interpolate along the shorter arc between the two rotations: */
+	Scalar cosAngle=q0[0]*q1[0]+q0[1]*q1[1]+q0[2]*q1[2]+q0[3]*q1[3];
+	Scalar sign(1);
+	if(cosAngle<Scalar(0))
+		{
+		cosAngle=-cosAngle;
+		sign=Scalar(-1);
+		}
+	Scalar w0,w1;
+	if(cosAngle<Scalar(0.9995))
+		{
+		Scalar angle=Math::acos(cosAngle);
+		Scalar sinAngle=Math::sin(angle);
+		w0=Math::sin((Scalar(1)-t)*angle)/sinAngle;
+		w1=Math::sin(t*angle)/sinAngle;
+		}
+	else
+		{
+		/* Interpolate linearly between nearly identical rotations: */
+		w0=Scalar(1)-t;
+		w1=t;
+		}
+	w1*=sign;
+	Scalar q[4];
+	for(int i=0;i<4;++i)
+		q[i]=q0[i]*w0+q1[i]*w1;
+	Doom3MD5Anim::Rotation result(q);
+	result.renormalize();
+	return result;
+	}
+
+}
+
 /*****************************
 Methods of class Doom3MD5Anim:
 *****************************/
@@ -196,14 +243,13 @@ Doom3MD5Anim::~Doom3MD5Anim(void)
 	delete[] frameComponents;
 	}
 
-void Doom3MD5Anim::animateMesh(Doom3MD5Mesh* mesh,int frameIndex) const
+void Doom3MD5Anim::calcFramePose(int frameIndex,Doom3MD5Anim::JointPose pose[]) const
 	{
-	/* Go through the joint hierarchy and update the mesh's joint transformations on-the-fly: */
+	/* Go through the joint hierarchy and extract each joint's animated transformation: */
 	const Scalar* frameBase=&frameComponents[frameIndex*numAnimatedComponents];
 	for(int jointIndex=0;jointIndex<numJoints;++jointIndex)
 		{
 		const Joint& j=joints[jointIndex];
-		Doom3MD5Mesh::Joint& mj=mesh->joints[jointIndex];
 		
 		/* Compose the joint's animated transformation in local coordinates: */
 		Scalar translation[3];
@@ -232,16 +278,77 @@ void Doom3MD5Anim::animateMesh(Doom3MD5Mesh* mesh,int frameIndex) const
 			}
 		Scalar weightDet=Scalar(1)-Math::sqr(rotation[0])-Math::sqr(rotation[1])-Math::sqr(rotation[2]);
 		rotation[3]=weightDet>Scalar(0)?-Math::sqrt(weightDet):Scalar(0);
-		Transform jointT(translation,Transform::Rotation(rotation));
-		
-		/* Compose the transformation with the joint's parent's transformation, and update the mesh: */
-		if(j.parentIndex>=0)
-			jointT.leftMultiply(mesh->joints[j.parentIndex].transform);
-		mj.transform=jointT;
+		pose[jointIndex].translation=Vector(translation);
+		pose[jointIndex].rotation=Rotation(rotation);
 		}
+	}
+
+void Doom3MD5Anim::calcPose(Doom3MD5Anim::Scalar time,Doom3MD5Anim::JointPose pose[]) const
+	{
+	/* Find the two frames surrounding the given time, looping the animation sequence: */
+	Scalar frame=time*frameRate;
+	frame-=Math::floor(frame/Scalar(numFrames))*Scalar(numFrames);
+	int frame0=int(Math::floor(frame));
+	if(frame0<0)
+		frame0=0;
+	if(frame0>=numFrames)
+		frame0=numFrames-1;
+	Scalar weight=frame-Scalar(frame0);
+	int frame1=frame0+1<numFrames?frame0+1:0;
 	
-	/* Update the mesh's joint tree version: */
-	++mesh->jointTreeVersion;
+	/* Interpolate between the two frames: */
+	calcFramePose(frame0,pose);
+	if(weight>Scalar(0))
+		{
+		std::vector<JointPose> pose1(numJoints);
+		calcFramePose(frame1,&pose1[0]);
+		blendPoses(numJoints,pose,&pose1[0],weight,pose);
+		}
+	}
+
+void Doom3MD5Anim::blendPoses(int numJoints,const Doom3MD5Anim::JointPose pose0[],const Doom3MD5Anim::JointPose pose1[],Doom3MD5Anim::Scalar weight,Doom3MD5Anim::JointPose result[])
+	{
+	Scalar weight0=Scalar(1)-weight;
+	for(int jointIndex=0;jointIndex<numJoints;++jointIndex)
+		{
+		/* Interpolate the joint's translation linearly and its rotation spherically: */
+		Vector translation=pose0[jointIndex].translation*weight0+pose1[jointIndex].translation*weight;
+		result[jointIndex].rotation=slerp(pose0[jointIndex].rotation,pose1[jointIndex].rotation,weight);
+		result[jointIndex].translation=translation;
+		}
+	}
+
+void Doom3MD5Anim::calcJointTransforms(const Doom3MD5Anim::JointPose pose[],Doom3MD5Anim::Transform jointTransforms[]) const
+	{
+	/* Go through the joint hierarchy, where parents always precede their children: */
+	for(int jointIndex=0;jointIndex<numJoints;++jointIndex)
+		{
+		/* Compose the joint's local transformation with its parent's transformation: */
+		Transform jointT(pose[jointIndex].translation,pose[jointIndex].rotation);
+		if(joints[jointIndex].parentIndex>=0)
+			jointT.leftMultiply(jointTransforms[joints[jointIndex].parentIndex]);
+		jointTransforms[jointIndex]=jointT;
+		}
+	}
+
+void Doom3MD5Anim::animateMesh(Doom3MD5Mesh* mesh,int frameIndex) const
+	{
+	/* Calculate the frame's pose and apply it to the mesh: */
+	std::vector<JointPose> pose(numJoints);
+	calcFramePose(frameIndex,&pose[0]);
+	std::vector<Transform> jointTransforms(numJoints);
+	calcJointTransforms(&pose[0],&jointTransforms[0]);
+	mesh->setJointTransforms(&jointTransforms[0]);
+	}
+
+void Doom3MD5Anim::animateMeshAtTime(Doom3MD5Mesh* mesh,Doom3MD5Anim::Scalar time) const
+	{
+	/* Calculate the interpolated pose and apply it to the mesh: */
+	std::vector<JointPose> pose(numJoints);
+	calcPose(time,&pose[0]);
+	std::vector<Transform> jointTransforms(numJoints);
+	calcJointTransforms(&pose[0],&jointTransforms[0]);
+	mesh->setJointTransforms(&jointTransforms[0]);
 	}
 
 }
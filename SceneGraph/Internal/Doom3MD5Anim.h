@@ -42,9 +42,18 @@ class Doom3MD5Anim
 	typedef float Scalar;
 	typedef Geometry::Point<Scalar,3> Point;
 	typedef Geometry::Vector<Scalar,3> Vector;
-	private:
 	typedef Geometry::OrthonormalTransformation<Scalar,3> Transform; // Type for joint transformations
+	typedef Transform::Rotation Rotation;
+	
+	struct JointPose // Structure for a joint's transformation relative to its parent in an animation pose
+		{
+		/* Elements: */
+		public:
+		Vector translation; // Joint's translation relative to its parent
+		Rotation rotation; // Joint's rotation relative to its parent
+		};
 	
+	private:
 	struct Joint // Structure to represent individual joints in the mesh's skeleton
 		{
 		/* Elements: */
@@ -94,7 +103,20 @@ class Doom3MD5Anim
 		{
 		return frameTime;
 		}
+	Scalar getDuration(void) const // Returns the duration of one cycle of the animation sequence
+		{
+		return Scalar(numFrames)*frameTime;
+		}
+	int getNumJoints(void) const // Returns the number of joints in the animated skeleton
+		{
+		return numJoints;
+		}
+	void calcFramePose(int frameIndex,JointPose pose[]) const; // Stores the local joint transformations of the given animation frame in the given array of getNumJoints() joint poses
+	void calcPose(Scalar time,JointPose pose[]) const; // Stores the local joint transformations at the given time, interpolated between frames and looping the sequence, in the given array
+	static void blendPoses(int numJoints,const JointPose pose0[],const JointPose pose1[],Scalar weight,JointPose result[]); // Blends two poses of the same skeleton with the given weight of the second pose; result can alias either pose
+	void calcJointTransforms(const JointPose pose[],Transform jointTransforms[]) const; // Composes the given local joint transformations along the joint hierarchy into the given array of model-space joint transformations
 	void animateMesh(Doom3MD5Mesh* mesh,int frameIndex) const; // Applies an animation frame to the given target mesh (mesh must match)
+	void animateMeshAtTime(Doom3MD5Mesh* mesh,Scalar time) const; // Applies the pose at the given time, interpolated between frames, to the given target mesh (mesh must match)
 	};
 
 }
@@ -0,0 +1,225 @@
+/***********************************************************************
+Doom3MD5Animator - Class to animate a crowd of MD5 mesh instances,
+sharing joint transformation palettes between instances in the same
+animation state and skinning instances in parallel.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/Internal/Doom3MD5Animator.h>
+
+#include <functional>
+#include <map>
+#include <Misc/ThrowStdErr.h>
+#include <Math/Math.h>
+#include <SceneGraph/Internal/BackgroundJobs.h>
+#include <SceneGraph/Internal/Doom3MD5Mesh.h>
+
+namespace SceneGraph {
+
+/**********************************************
+Methods of struct Doom3MD5Animator::PaletteKey:
+**********************************************/
+
+bool Doom3MD5Animator::PaletteKey::operator<(const Doom3MD5Animator::PaletteKey& other) const
+	{
+	for(int i=0;i<2;++i)
+		{
+		if(anims[i]!=other.anims[i])
+			return std::less<const Doom3MD5Anim*>()(anims[i],other.anims[i]);
+		if(times[i]!=other.times[i])
+			return times[i]<other.times[i];
+		}
+	return blendWeight<other.blendWeight;
+	}
+
+/*********************************************************
+Declaration of struct Doom3MD5Animator::PaletteCalculator:
+*********************************************************/
+
+struct Doom3MD5Animator::PaletteCalculator:public FrameLoopBody
+	{
+	/* Elements: */
+	public:
+	std::vector<Palette>& palettes; // List of palettes to calculate
+	
+	/* Constructors and destructors: */
+	PaletteCalculator(std::vector<Palette>& sPalettes)
+		:palettes(sPalettes)
+		{
+		}
+	
+	/* Methods from FrameLoopBody: */
+	virtual void operator()(size_t index)
+		{
+		Palette& p=palettes[index];
+		const Doom3MD5Anim* anim=p.key.anims[0];
+		int numJoints=anim->getNumJoints();
+		
+		/* Calculate the primary sequence's pose, and blend in the secondary sequence's pose: */
+		std::vector<Doom3MD5Anim::JointPose> pose(numJoints);
+		anim->calcPose(p.key.times[0],&pose[0]);
+		if(p.key.anims[1]!=0&&p.key.blendWeight>Scalar(0))
+			{
+			std::vector<Doom3MD5Anim::JointPose> pose1(numJoints);
+			p.key.anims[1]->calcPose(p.key.times[1],&pose1[0]);
+			Doom3MD5Anim::blendPoses(numJoints,&pose[0],&pose1[0],p.key.blendWeight,&pose[0]);
+			}
+		
+		/* Compose the model-space joint transformations: */
+		p.jointTransforms.resize(numJoints);
+		anim->calcJointTransforms(&pose[0],&p.jointTransforms[0]);
+		}
+	};
+
+/*****************************************************
+Declaration of struct Doom3MD5Animator::InstancePoser:
+*****************************************************/
+
+struct Doom3MD5Animator::InstancePoser:public FrameLoopBody
+	{
+	/* Elements: */
+	public:
+	std::vector<Instance>& instances; // List of instances to pose
+	const std::vector<Palette>& palettes; // List of calculated palettes
+	
+	/* Constructors and destructors: */
+	InstancePoser(std::vector<Instance>& sInstances,const std::vector<Palette>& sPalettes)
+		:instances(sInstances),palettes(sPalettes)
+		{
+		}
+	
+	/* Methods from FrameLoopBody: */
+	virtual void operator()(size_t index)
+		{
+		Instance& i=instances[index];
+		if(i.state.anims[0]!=0)
+			{
+			/* Pose the instance's mesh in this thread, as instances are already distributed across threads: */
+			i.mesh->setJointTransforms(&palettes[i.paletteIndex].jointTransforms[0]);
+			i.mesh->updatePose(1);
+			}
+		}
+	};
+
+/*********************************
+Methods of class Doom3MD5Animator:
+*********************************/
+
+Doom3MD5Animator::Scalar Doom3MD5Animator::quantizeTime(const Doom3MD5Anim* anim,Doom3MD5Animator::Scalar time) const
+	{
+	/* Wrap the time into the animation's cycle so that looping instances can share palettes: */
+	Scalar duration=anim->getDuration();
+	if(duration>Scalar(0))
+		time-=Math::floor(time/duration)*duration;
+	
+	/* Round the time to the time quantum: */
+	if(timeQuantum>Scalar(0))
+		time=Math::floor(time/timeQuantum+Scalar(0.5))*timeQuantum;
+	
+	return time;
+	}
+
+Doom3MD5Animator::Doom3MD5Animator(unsigned int sMaxNumThreads)
+	:maxNumThreads(sMaxNumThreads),
+	 timeQuantum(0)
+	{
+	}
+
+size_t Doom3MD5Animator::addInstance(Doom3MD5Mesh* mesh)
+	{
+	Instance i;
+	i.mesh=mesh;
+	for(int j=0;j<2;++j)
+		{
+		i.state.anims[j]=0;
+		i.state.times[j]=Scalar(0);
+		}
+	i.state.blendWeight=Scalar(0);
+	i.paletteIndex=0;
+	instances.push_back(i);
+	
+	return instances.size()-1;
+	}
+
+void Doom3MD5Animator::setTimeQuantum(Doom3MD5Animator::Scalar newTimeQuantum)
+	{
+	timeQuantum=newTimeQuantum;
+	}
+
+void Doom3MD5Animator::setAnimation(size_t instanceIndex,const Doom3MD5Anim* anim,Doom3MD5Animator::Scalar time)
+	{
+	setBlendedAnimation(instanceIndex,anim,time,0,Scalar(0),Scalar(0));
+	}
+
+void Doom3MD5Animator::setBlendedAnimation(size_t instanceIndex,const Doom3MD5Anim* anim0,Doom3MD5Animator::Scalar time0,const Doom3MD5Anim* anim1,Doom3MD5Animator::Scalar time1,Doom3MD5Animator::Scalar blendWeight)
+	{
+	Instance& i=instances[instanceIndex];
+	
+	/* Check that the animation sequences match the instance's skeleton: */
+	if(anim0!=0&&anim0->getNumJoints()!=i.mesh->getNumJoints())
+		Misc::throwStdErr("Doom3MD5Animator::setBlendedAnimation: Animation has %d joints instead of %d",anim0->getNumJoints(),i.mesh->getNumJoints());
+	if(anim1!=0&&anim1->getNumJoints()!=i.mesh->getNumJoints())
+		Misc::throwStdErr("Doom3MD5Animator::setBlendedAnimation: Animation has %d joints instead of %d",anim1->getNumJoints(),i.mesh->getNumJoints());
+	
+	/* Store the instance's animation state in canonical form: */
+	i.state.anims[0]=anim0;
+	i.state.times[0]=anim0!=0?quantizeTime(anim0,time0):Scalar(0);
+	if(anim0!=0&&anim1!=0&&blendWeight>Scalar(0))
+		{
+		i.state.anims[1]=anim1;
+		i.state.times[1]=quantizeTime(anim1,time1);
+		i.state.blendWeight=blendWeight;
+		}
+	else
+		{
+		i.state.anims[1]=0;
+		i.state.times[1]=Scalar(0);
+		i.state.blendWeight=Scalar(0);
+		}
+	}
+
+void Doom3MD5Animator::update(void)
+	{
+	/* Assign the instances to one palette per distinct animation state: */
+	palettes.clear();
+	std::map<PaletteKey,size_t> paletteMap;
+	for(std::vector<Instance>::iterator iIt=instances.begin();iIt!=instances.end();++iIt)
+		if(iIt->state.anims[0]!=0)
+			{
+			std::map<PaletteKey,size_t>::iterator pmIt=paletteMap.find(iIt->state);
+			if(pmIt==paletteMap.end())
+				{
+				Palette p;
+				p.key=iIt->state;
+				pmIt=paletteMap.insert(std::make_pair(iIt->state,palettes.size())).first;
+				palettes.push_back(p);
+				}
+			iIt->paletteIndex=pmIt->second;
+			}
+	
+	/* Calculate all palettes in parallel: */
+	PaletteCalculator calculator(palettes);
+	runFrameLoop(palettes.size(),calculator,maxNumThreads);
+	
+	/* Pose all instances in parallel: */
+	InstancePoser poser(instances,palettes);
+	runFrameLoop(instances.size(),poser,maxNumThreads);
+	}
+
+}
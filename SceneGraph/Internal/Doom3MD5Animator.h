@@ -0,0 +1,108 @@
+/***********************************************************************
+Doom3MD5Animator - Class to animate a crowd of MD5 mesh instances,
+sharing joint transformation palettes between instances in the same
+animation state and skinning instances in parallel.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_INTERNAL_DOOM3MD5ANIMATOR_INCLUDED
+#define SCENEGRAPH_INTERNAL_DOOM3MD5ANIMATOR_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <SceneGraph/Internal/Doom3MD5Anim.h>
+
+/* Forward declarations: */
+namespace SceneGraph {
+class Doom3MD5Mesh;
+}
+
+namespace SceneGraph {
+
+class Doom3MD5Animator
+	{
+	/* Embedded classes: */
+	public:
+	typedef Doom3MD5Anim::Scalar Scalar;
+	
+	private:
+	struct PaletteKey // Structure identifying an animation state whose joint transformations can be shared
+		{
+		/* Elements: */
+		public:
+		const Doom3MD5Anim* anims[2]; // Primary and optional secondary animation sequence
+		Scalar times[2]; // Sampling times in the primary and secondary sequences
+		Scalar blendWeight; // Weight of the secondary sequence
+		
+		/* Methods: */
+		bool operator<(const PaletteKey& other) const; // Lexicographic order for palette lookup
+		};
+	
+	struct Instance // Structure for animated mesh instances
+		{
+		/* Elements: */
+		public:
+		Doom3MD5Mesh* mesh; // Mesh posed by this instance
+		PaletteKey state; // Instance's current animation state
+		size_t paletteIndex; // Index of the instance's palette during the most recent update
+		};
+	
+	struct Palette // Structure for shared joint transformations
+		{
+		/* Elements: */
+		public:
+		PaletteKey key; // Animation state represented by the palette
+		std::vector<Doom3MD5Anim::Transform> jointTransforms; // Model-space joint transformations
+		};
+	
+	struct PaletteCalculator; // Loop body to calculate palettes in parallel
+	struct InstancePoser; // Loop body to pose instances in parallel
+	
+	/* Elements: */
+	unsigned int maxNumThreads; // Maximum number of threads used to update instances
+	Scalar timeQuantum; // Quantum to which sampling times are rounded to share palettes between instances; 0 disables rounding
+	std::vector<Instance> instances; // List of animated instances
+	std::vector<Palette> palettes; // List of palettes calculated during the most recent update
+	
+	/* Private methods: */
+	Scalar quantizeTime(const Doom3MD5Anim* anim,Scalar time) const; // Wraps the given time into the animation's cycle and rounds it to the time quantum
+	
+	/* Constructors and destructors: */
+	public:
+	Doom3MD5Animator(unsigned int sMaxNumThreads =0); // Creates an empty animator using at most the given number of threads (0: one per processor)
+	
+	/* Methods: */
+	size_t addInstance(Doom3MD5Mesh* mesh); // Adds an instance posing the given mesh, which must not be shared with other instances; returns the instance's index
+	size_t getNumInstances(void) const // Returns the number of animated instances
+		{
+		return instances.size();
+		}
+	void setTimeQuantum(Scalar newTimeQuantum); // Sets the quantum to which sampling times are rounded from now on
+	void setAnimation(size_t instanceIndex,const Doom3MD5Anim* anim,Scalar time); // Plays the given animation sequence at the given time on the given instance; a null sequence leaves the instance's pose alone
+	void setBlendedAnimation(size_t instanceIndex,const Doom3MD5Anim* anim0,Scalar time0,const Doom3MD5Anim* anim1,Scalar time1,Scalar blendWeight); // Plays a blend of two animation sequences at their given times on the given instance, with the given weight of the second sequence
+	void update(void); // Calculates the poses of all instances for their current animation states
+	size_t getNumPalettes(void) const // Returns the number of distinct palettes calculated during the most recent update
+		{
+		return palettes.size();
+		}
+	};
+
+}
+
+#endif
@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Math/Constants.h>
 #include <Geometry/ComponentArray.h>
 #include <Geometry/Matrix.h>
+#include <Threads/ParallelFor.h>
 #include <GL/gl.h>
 #define NONSTANDARD_GLVERTEX_TEMPLATES
 #include <GL/GLVertex.h>
@@ -88,43 +89,81 @@ Doom3MD5Mesh::DataItem::~DataItem(void)
 	delete[] meshIndexBufferObjectIds;
 	}
 
+/*********************************************
+Declaration of struct Doom3MD5Mesh::MeshPoser:
+*********************************************/
+
+struct Doom3MD5Mesh::MeshPoser
+	{
+	/* Elements: */
+	public:
+	Doom3MD5Mesh* md5Mesh; // The skeleton whose joint matrices are used
+	Mesh* mesh; // The mesh whose vertices are posed
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
+		{
+		md5Mesh->poseMesh(*mesh,int(begin),int(end));
+		}
+	};
+
 /*****************************
 Methods of class Doom3MD5Mesh:
 *****************************/
 
-void Doom3MD5Mesh::poseMesh(Doom3MD5Mesh::Mesh& mesh)
+void Doom3MD5Mesh::updateJointMatrices(void)
 	{
-	const Mesh::Vertex* vPtr=mesh.vertices;
-	Mesh::RenderVertex* rvPtr=mesh.posedVertices;
-	for(int vertexIndex=0;vertexIndex<mesh.numVertices;++vertexIndex,++vPtr,++rvPtr)
+	for(int jointIndex=0;jointIndex<numJoints;++jointIndex)
 		{
-		/* Initialize the posed vertex: */
-		rvPtr->normal=Vector::zero;
-		for(int i=0;i<2;++i)
-			rvPtr->tangents[i]=Vector::zero;
-		rvPtr->position=Point::origin;
-		
-		/* Accumulate the posed vertex from its joint weights: */
+		/* Store the joint transformation's rotation matrix and translation vector: */
+		const Transform& t=joints[jointIndex].transform;
+		JointMatrix& jm=jointMatrices[jointIndex];
+		for(int j=0;j<3;++j)
+			{
+			Vector column=t.getDirection(j);
+			for(int i=0;i<3;++i)
+				jm.m[i][j]=column[i];
+			}
+		for(int i=0;i<3;++i)
+			jm.m[i][3]=t.getOrigin()[i];
+		}
+	}
+
+void Doom3MD5Mesh::poseMesh(Doom3MD5Mesh::Mesh& mesh,int vertexBegin,int vertexEnd)
+	{
+	const Mesh::Vertex* vPtr=mesh.vertices+vertexBegin;
+	Mesh::RenderVertex* rvPtr=mesh.posedVertices+vertexBegin;
+	for(int vertexIndex=vertexBegin;vertexIndex<vertexEnd;++vertexIndex,++vPtr,++rvPtr)
+		{
+		/* Accumulate the posed vertex from its joint weights in plain arrays the compiler can keep in registers: */
+		Scalar n[3]={Scalar(0),Scalar(0),Scalar(0)};
+		Scalar tS[3]={Scalar(0),Scalar(0),Scalar(0)};
+		Scalar tT[3]={Scalar(0),Scalar(0),Scalar(0)};
+		Scalar p[3]={Scalar(0),Scalar(0),Scalar(0)};
 		const Mesh::Weight* wPtr=&mesh.weights[vPtr->firstWeightIndex];
 		for(int weightIndex=0;weightIndex<vPtr->numWeights;++weightIndex,++wPtr)
 			{
-			const Joint& j=joints[wPtr->jointIndex];
-			
-			/* Transform the vertex normal, tangent, and position: */
-			Vector ntrans=j.transform.transform(wPtr->normal);
-			Vector tStrans=j.transform.transform(wPtr->tangents[0]);
-			Vector tTtrans=j.transform.transform(wPtr->tangents[1]);
-			Point vtrans=j.transform.transform(wPtr->position);
+			const Scalar (*m)[4]=jointMatrices[wPtr->jointIndex].m;
+			Scalar w=wPtr->weight;
 			
-			/* Accumulate the transformed vertex: */
+			/* Transform the vertex normal, tangents, and position with the weight's joint matrix: */
 			for(int i=0;i<3;++i)
 				{
-				rvPtr->normal[i]+=ntrans[i]*wPtr->weight;
-				rvPtr->tangents[0][i]+=tStrans[i]*wPtr->weight;
-				rvPtr->tangents[1][i]+=tTtrans[i]*wPtr->weight;
-				rvPtr->position[i]+=vtrans[i]*wPtr->weight;
+				n[i]+=(m[i][0]*wPtr->normal[0]+m[i][1]*wPtr->normal[1]+m[i][2]*wPtr->normal[2])*w;
+				tS[i]+=(m[i][0]*wPtr->tangents[0][0]+m[i][1]*wPtr->tangents[0][1]+m[i][2]*wPtr->tangents[0][2])*w;
+				tT[i]+=(m[i][0]*wPtr->tangents[1][0]+m[i][1]*wPtr->tangents[1][1]+m[i][2]*wPtr->tangents[1][2])*w;
+				p[i]+=(m[i][0]*wPtr->position[0]+m[i][1]*wPtr->position[1]+m[i][2]*wPtr->position[2]+m[i][3])*w;
 				}
 			}
+		
+		/* Store the posed vertex: */
+		for(int i=0;i<3;++i)
+			{
+			rvPtr->normal[i]=n[i];
+			rvPtr->tangents[0][i]=tS[i];
+			rvPtr->tangents[1][i]=tT[i];
+			rvPtr->position[i]=p[i];
+			}
 		}
 	}
 
@@ -132,6 +171,7 @@ Doom3MD5Mesh::Doom3MD5Mesh(Doom3FileManager& fileManager,Doom3MaterialManager& s
 	:materialManager(sMaterialManager),
 	 numJoints(0),
 	 joints(0),
+	 jointMatrices(0),
 	 numMeshes(0),
 	 meshes(0),
 	 jointTreeVersion(1),
@@ -176,6 +216,7 @@ Doom3MD5Mesh::Doom3MD5Mesh(Doom3FileManager& fileManager,Doom3MaterialManager& s
 	
 	/* Allocate the joint array and parse the joint tree: */
 	joints=new Joint[numJoints];
+	jointMatrices=new JointMatrix[numJoints];
 	if(!source.isString("joints")||source.readChar()!='{')
 		Misc::throwStdErr("Doom3MD5Mesh::Doom3MD5Mesh: Input file %s does not contain a joint list",meshFileName);
 	for(int jointIndex=0;jointIndex<numJoints;++jointIndex)
@@ -227,6 +268,9 @@ Doom3MD5Mesh::Doom3MD5Mesh(Doom3FileManager& fileManager,Doom3MaterialManager& s
 	if(source.readChar()!='}')
 		Misc::throwStdErr("Doom3MD5Mesh::Doom3MD5Mesh: Long joint list at %s",source.where().c_str());
 	
+	/* Convert the bind pose joint transformations to matrices for initial posing: */
+	updateJointMatrices();
+	
 	/* Allocate the mesh array and read all meshes: */
 	meshes=new Mesh[numMeshes];
 	for(int meshIndex=0;meshIndex<numMeshes;++meshIndex)
@@ -335,7 +379,7 @@ Doom3MD5Mesh::Doom3MD5Mesh(Doom3FileManager& fileManager,Doom3MaterialManager& s
 		
 		/* Compute the initial posed positions for all vertices: */
 		m.posedVertices=new Mesh::RenderVertex[m.numVertices];
-		poseMesh(m);
+		poseMesh(m,0,m.numVertices);
 		vPtr=m.vertices;
 		Mesh::RenderVertex* pvPtr=m.posedVertices;
 		for(int vertexIndex=0;vertexIndex<m.numVertices;++vertexIndex,++vPtr,++pvPtr)
@@ -417,6 +461,7 @@ Doom3MD5Mesh::Doom3MD5Mesh(Doom3FileManager& fileManager,Doom3MaterialManager& s
 Doom3MD5Mesh::~Doom3MD5Mesh(void)
 	{
 	delete[] joints;
+	delete[] jointMatrices;
 	delete[] meshes;
 	}
 
@@ -544,15 +589,39 @@ void Doom3MD5Mesh::setJointTransform(const Doom3MD5Mesh::JointID& jointID,const
 	++jointTreeVersion;
 	}
 
-void Doom3MD5Mesh::updatePose(void)
+void Doom3MD5Mesh::setJointTransforms(const Doom3MD5Mesh::Transform jointTransforms[])
+	{
+	/* Set all joints' transformations: */
+	for(int i=0;i<numJoints;++i)
+		joints[i].transform=jointTransforms[i];
+	
+	/* Update the joint tree: */
+	++jointTreeVersion;
+	}
+
+void Doom3MD5Mesh::updatePose(unsigned int maxNumThreads)
 	{
 	/* Check if the current mesh pose is outdated: */
 	if(posedVerticesVersion!=jointTreeVersion)
 		{
+		/* Convert all joint transformations to matrices once for all vertices: */
+		updateJointMatrices();
+		
 		/* Pose all meshes: */
 		Mesh* mPtr=meshes;
 		for(int meshIndex=0;meshIndex<numMeshes;++meshIndex,++mPtr)
-			poseMesh(*mPtr);
+			{
+			if(maxNumThreads!=1)
+				{
+				/* Pose the mesh's vertices in parallel: */
+				MeshPoser poser;
+				poser.md5Mesh=this;
+				poser.mesh=mPtr;
+				Threads::parallelFor(0,mPtr->numVertices,poser,1024,maxNumThreads);
+				}
+			else
+				poseMesh(*mPtr,0,mPtr->numVertices);
+			}
 		
 		/* Update the mesh pose: */
 		posedVerticesVersion=jointTreeVersion;
@@ -171,6 +171,16 @@ class Doom3MD5Mesh:public GLObject
 			};
 		};
 	
+	struct JointMatrix // Structure for joint transformations as affine matrices, for fast vertex skinning
+		{
+		/* Elements: */
+		public:
+		Scalar m[3][4]; // Rotation in the left 3x3 submatrix, translation in the right column
+		};
+	
+	struct MeshPoser; // Functor to pose ranges of a mesh's vertices in parallel
+	friend struct MeshPoser;
+	
 	struct DataItem:public GLObject::DataItem
 		{
 		/* Elements: */
@@ -191,13 +201,15 @@ class Doom3MD5Mesh:public GLObject
 	Doom3MaterialManager& materialManager;
 	int numJoints; // Total number of joints in the skeleton
 	Joint* joints; // Array containing the skeleton's joint tree
+	JointMatrix* jointMatrices; // Array of joint transformations as matrices, updated when the mesh is posed
 	int numMeshes; // Total number of meshes associated with the skeleton
 	Mesh* meshes; // Array containing the meshes associated with the skeleton
 	unsigned int jointTreeVersion; // Version number of the joint tree settings
 	unsigned int posedVerticesVersion; // Version number of the posed mesh vertices
 	
 	/* Private methods: */
-	void poseMesh(Mesh& mesh); // Poses the given mesh according to the current joint transformations
+	void updateJointMatrices(void); // Converts the current joint transformations to joint matrices
+	void poseMesh(Mesh& mesh,int vertexBegin,int vertexEnd); // Poses the given half-open range of vertices of the given mesh according to the current joint matrices
 	
 	/* Constructors and destructors: */
 	public:
@@ -208,6 +220,10 @@ class Doom3MD5Mesh:public GLObject
 	virtual void initContext(GLContextData& contextData) const; // Initializes the mesh's OpenGL state
 	
 	/* New methods: */
+	int getNumJoints(void) const // Returns the number of joints in the skeleton
+		{
+		return numJoints;
+		}
 	JointID findJoint(const char* jointName) const; // Returns an ID of the joint of the given name
 	JointID pickJoint(const Point& position,Scalar maxDist) const; // Returns an ID of the joint touched by the given position
 	JointID pickJoint(const Ray& ray,Scalar cosMaxAngle) const; // Returns an ID of the first joint intersected by a cone along the given ray
@@ -224,7 +240,8 @@ class Doom3MD5Mesh:public GLObject
 		return joints[jointID.jointIndex].transform;
 		};
 	void setJointTransform(const JointID& jointID,const Transform& newTransform,bool cascade =true); // Sets the transformation of the given joint; applies transformation to children if cascade is true
-	void updatePose(void); // Updates the mesh's pose according to the most recent joint angles
+	void setJointTransforms(const Transform jointTransforms[]); // Sets the transformations of all joints from the given array of getNumJoints() transformations
+	void updatePose(unsigned int maxNumThreads =1); // Updates the mesh's pose according to the most recent joint angles, using at most the given number of threads (0: one per processor)
 	Box calcBoundingBox(void) const; // Returns a bounding box of the mesh surface as currently posed
 	void drawSkeleton(void) const; // Draws the mesh's skeleton as a tree of line segments
 	void drawSurface(GLContextData& contextData,bool useDefaultPipeline) const; // Draws the mesh as a shaded surface
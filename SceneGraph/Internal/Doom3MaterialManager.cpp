@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <ctype.h>
 #include <string>
+#include <functional>
 #include <Misc/ThrowStdErr.h>
 #include <GL/gl.h>
 #include <GL/GLContextData.h>
@@ -84,6 +85,213 @@ bool equal(const std::string& s1,const char* s2)
 
 }
 
+/*************************************************************
+Methods of struct Doom3MaterialManager::ExpressionEnvironment:
+*************************************************************/
+
+Doom3MaterialManager::ExpressionEnvironment::ExpressionEnvironment(void)
+	:time(0.0f),
+	 fragmentPrograms(1.0f),sound(0.0f)
+	{
+	for(int i=0;i<12;++i)
+		parm[i]=0.0f;
+	for(int i=0;i<8;++i)
+		global[i]=0.0f;
+	}
+
+/**********************************************************************
+Methods of struct Doom3MaterialManager::ExpressionProgram::Instruction:
+**********************************************************************/
+
+bool Doom3MaterialManager::ExpressionProgram::Instruction::operator<(const Doom3MaterialManager::ExpressionProgram::Instruction& other) const
+	{
+	if(opCode!=other.opCode)
+		return opCode<other.opCode;
+	if(operands[0]!=other.operands[0])
+		return operands[0]<other.operands[0];
+	if(operands[1]!=other.operands[1])
+		return operands[1]<other.operands[1];
+	if(constant!=other.constant)
+		return constant<other.constant;
+	return std::less<const Table*>()(table,other.table);
+	}
+
+/********************************************************
+Methods of class Doom3MaterialManager::ExpressionProgram:
+********************************************************/
+
+float Doom3MaterialManager::ExpressionProgram::execute(const Doom3MaterialManager::ExpressionProgram::Instruction& instruction) const
+	{
+	/* Mirror the evaluation rules of the expression tree classes: */
+	const float* r=&registers[0];
+	const int* ops=instruction.operands;
+	switch(instruction.opCode)
+		{
+		case Constant:
+			return instruction.constant;
+		
+		case EnvironmentVariable:
+			if(ops[0]==0)
+				return env.time;
+			else if(ops[0]-1<12)
+				return env.parm[ops[0]-1];
+			else if(ops[0]-13<8)
+				return env.global[ops[0]-13];
+			else if(ops[0]==21)
+				return env.fragmentPrograms;
+			else
+				return env.sound;
+		
+		case TableLookup:
+			return instruction.table!=0?(*instruction.table)(r[ops[0]]):0.0f;
+		
+		case Negate:
+			return -r[ops[0]];
+		
+		case Add:
+			return r[ops[0]]+r[ops[1]];
+		
+		case Subtract:
+			return r[ops[0]]-r[ops[1]];
+		
+		case Multiply:
+			return r[ops[0]]*r[ops[1]];
+		
+		case Divide:
+			return r[ops[0]]/r[ops[1]];
+		
+		case Modulo:
+			return Math::mod(r[ops[0]],r[ops[1]]);
+		
+		case Equal:
+			return r[ops[0]]==r[ops[1]]?1.0f:0.0f;
+		
+		case NotEqual:
+			return r[ops[0]]!=r[ops[1]]?1.0f:0.0f;
+		
+		case Less:
+			return r[ops[0]]<r[ops[1]]?1.0f:0.0f;
+		
+		case LessEqual:
+			return r[ops[0]]<=r[ops[1]]?1.0f:0.0f;
+		
+		case GreaterEqual:
+			return r[ops[0]]>=r[ops[1]]?1.0f:0.0f;
+		
+		case Greater:
+			return r[ops[0]]>r[ops[1]]?1.0f:0.0f;
+		
+		case And:
+			return (r[ops[0]]!=0.0f&&r[ops[1]]!=0.0f)?1.0f:0.0f;
+		
+		case Or:
+			return (r[ops[0]]!=0.0f||r[ops[1]]!=0.0f)?1.0f:0.0f;
+		
+		default:
+			return 0.0f; // Never reached
+		}
+	}
+
+int Doom3MaterialManager::ExpressionProgram::addInstruction(const Doom3MaterialManager::ExpressionProgram::Instruction& instruction)
+	{
+	/* Check if the instruction only depends on constants: */
+	bool dynamic=instruction.opCode==EnvironmentVariable;
+	if(instruction.opCode!=Constant&&instruction.opCode!=EnvironmentVariable)
+		for(int i=0;i<2;++i)
+			if(instruction.operands[i]>=0&&!isConstant(instruction.operands[i]))
+				dynamic=true;
+	
+	/* Replace constant instructions by their results: */
+	Instruction in=instruction;
+	if(!dynamic&&in.opCode!=Constant)
+		{
+		in.constant=execute(instruction);
+		in.opCode=Constant;
+		in.operands[0]=in.operands[1]=-1;
+		in.table=0;
+		}
+	
+	/* Return the register of an identical previous instruction: */
+	std::map<Instruction,int>::iterator imIt=instructionMap.find(in);
+	if(imIt!=instructionMap.end())
+		return imIt->second;
+	
+	/* Append the instruction and calculate its result for the current environment: */
+	int reg=int(instructions.size());
+	instructions.push_back(in);
+	registers.push_back(0.0f);
+	registers[reg]=execute(in);
+	if(dynamic)
+		dynamicInstructions.push_back(reg);
+	instructionMap.insert(std::make_pair(in,reg));
+	
+	return reg;
+	}
+
+Doom3MaterialManager::ExpressionProgram::ExpressionProgram(void)
+	{
+	}
+
+int Doom3MaterialManager::ExpressionProgram::addConstant(float constant)
+	{
+	Instruction in;
+	in.opCode=Constant;
+	in.operands[0]=in.operands[1]=-1;
+	in.constant=constant;
+	in.table=0;
+	return addInstruction(in);
+	}
+
+int Doom3MaterialManager::ExpressionProgram::addEnvironmentVariable(int varIndex)
+	{
+	Instruction in;
+	in.opCode=EnvironmentVariable;
+	in.operands[0]=varIndex;
+	in.operands[1]=-1;
+	in.constant=0.0f;
+	in.table=0;
+	return addInstruction(in);
+	}
+
+int Doom3MaterialManager::ExpressionProgram::addTableLookup(const Doom3MaterialManager::Table* table,int argument)
+	{
+	Instruction in;
+	in.opCode=TableLookup;
+	in.operands[0]=argument;
+	in.operands[1]=-1;
+	in.constant=0.0f;
+	in.table=table;
+	return addInstruction(in);
+	}
+
+int Doom3MaterialManager::ExpressionProgram::addOperation(Doom3MaterialManager::ExpressionProgram::OpCode opCode,int operand0,int operand1)
+	{
+	Instruction in;
+	in.opCode=opCode;
+	in.operands[0]=operand0;
+	in.operands[1]=operand1;
+	in.constant=0.0f;
+	in.table=0;
+	return addInstruction(in);
+	}
+
+void Doom3MaterialManager::ExpressionProgram::evaluate(const Doom3MaterialManager::ExpressionEnvironment& newEnv)
+	{
+	/* Bail out if the environment did not change, e.g., when another OpenGL context renders the same frame: */
+	bool changed=newEnv.time!=env.time||newEnv.fragmentPrograms!=env.fragmentPrograms||newEnv.sound!=env.sound;
+	for(int i=0;i<12&&!changed;++i)
+		changed=newEnv.parm[i]!=env.parm[i];
+	for(int i=0;i<8&&!changed;++i)
+		changed=newEnv.global[i]!=env.global[i];
+	if(!changed)
+		return;
+	env=newEnv;
+	
+	/* Execute all environment-dependent instructions in order: */
+	for(std::vector<int>::const_iterator diIt=dynamicInstructions.begin();diIt!=dynamicInstructions.end();++diIt)
+		registers[*diIt]=execute(instructions[*diIt]);
+	}
+
 /***********************************************
 Methods of class Doom3MaterialManager::Material:
 ***********************************************/
@@ -125,6 +333,9 @@ Doom3MaterialManager::Material::Stage& Doom3MaterialManager::Material::addStage(
 	stage.alphaTest=0.0f;
 	for(int i=0;i<4;++i)
 		stage.vertexColor[i]=1.0f;
+	stage.alphaTestRegister=-1;
+	for(int i=0;i<4;++i)
+		stage.vertexColorRegisters[i]=-1;
 	
 	/* Return the new stage: */
 	return stage;
@@ -408,6 +619,23 @@ Doom3MaterialManager::Expression* Doom3MaterialManager::parseExpression(Doom3Val
 	return result;
 	}
 
+GLfloat Doom3MaterialManager::parseStageExpression(Doom3ValueSource& source,const Doom3MaterialManager::ExpressionEnvironment& env,int& reg)
+	{
+	/* Parse the expression and evaluate it using the given environment: */
+	Expression* exp=parseExpression(source);
+	GLfloat result=GLfloat(exp->evaluate(env));
+	
+	/* Compile the expression, and only keep its register if it is time-varying: */
+	reg=exp->compile(expressionProgram);
+	if(expressionProgram.isConstant(reg))
+		reg=-1;
+	
+	/* Delete the expression: */
+	delete exp;
+	
+	return result;
+	}
+
 Doom3TextureManager::ImageID Doom3MaterialManager::parseImageMap(Doom3ValueSource& source)
 	{
 	/* Read the map name sourceen: */
@@ -662,13 +890,6 @@ void Doom3MaterialManager::parseMaterialFile(Doom3FileManager& fileManager,const
 	{
 	/* Create a default environment: */
 	ExpressionEnvironment currentEnv;
-	currentEnv.time=0.0f;
-	for(int i=0;i<12;++i)
-		currentEnv.parm[i]=0.0f;
-	for(int i=0;i<8;++i)
-		currentEnv.global[i]=0.0f;
-	currentEnv.fragmentPrograms=1.0f;
-	currentEnv.sound=0.0f;
 	
 	/* Read the material file and create a value source: */
 	Doom3ValueSource source(fileManager.getFile(fileName),fileName);
@@ -1108,84 +1329,50 @@ void Doom3MaterialManager::parseMaterialFile(Doom3FileManager& fileManager,const
 								}
 							else if(equal(setting,"alphaTest"))
 								{
-								/* Parse the alpha test expression: */
-								Expression* exp=parseExpression(source);
-								
-								/* Evaluate it using the current environment: */
-								stage.alphaTest=GLfloat(exp->evaluate(currentEnv));
-								
-								/* Delete the expression: */
-								delete exp;
+								/* Parse the alpha test expression and evaluate it using the current environment: */
+								stage.alphaTest=parseStageExpression(source,currentEnv,stage.alphaTestRegister);
 								}
 							else if(equal(setting,"red"))
 								{
-								/* Parse the red expression: */
-								Expression* exp=parseExpression(source);
-								
-								/* Evaluate it using the current environment: */
-								stage.vertexColor[0]=GLfloat(exp->evaluate(currentEnv));
-								
-								/* Delete the expression: */
-								delete exp;
+								/* Parse the red expression and evaluate it using the current environment: */
+								stage.vertexColor[0]=parseStageExpression(source,currentEnv,stage.vertexColorRegisters[0]);
 								}
 							else if(equal(setting,"green"))
 								{
-								/* Parse the green expression: */
-								Expression* exp=parseExpression(source);
-								
-								/* Evaluate it using the current environment: */
-								stage.vertexColor[1]=GLfloat(exp->evaluate(currentEnv));
-								
-								/* Delete the expression: */
-								delete exp;
+								/* Parse the green expression and evaluate it using the current environment: */
+								stage.vertexColor[1]=parseStageExpression(source,currentEnv,stage.vertexColorRegisters[1]);
 								}
 							else if(equal(setting,"blue"))
 								{
-								/* Parse the blue expression: */
-								Expression* exp=parseExpression(source);
-								
-								/* Evaluate it using the current environment: */
-								stage.vertexColor[2]=GLfloat(exp->evaluate(currentEnv));
-								
-								/* Delete the expression: */
-								delete exp;
+								/* Parse the blue expression and evaluate it using the current environment: */
+								stage.vertexColor[2]=parseStageExpression(source,currentEnv,stage.vertexColorRegisters[2]);
 								}
 							else if(equal(setting,"alpha"))
 								{
-								/* Parse the alpha expression: */
-								Expression* exp=parseExpression(source);
-								
-								/* Evaluate it using the current environment: */
-								stage.vertexColor[3]=GLfloat(exp->evaluate(currentEnv));
-								
-								/* Delete the expression: */
-								delete exp;
+								/* Parse the alpha expression and evaluate it using the current environment: */
+								stage.vertexColor[3]=parseStageExpression(source,currentEnv,stage.vertexColorRegisters[3]);
 								}
 							else if(equal(setting,"rgb"))
 								{
-								/* Parse the rgb expression: */
-								Expression* exp=parseExpression(source);
-								
-								/* Evaluate it using the current environment: */
-								GLfloat rgb=GLfloat(exp->evaluate(currentEnv));
+								/* Parse the rgb expression and evaluate it using the current environment: */
+								int reg;
+								GLfloat rgb=parseStageExpression(source,currentEnv,reg);
 								for(int i=0;i<3;++i)
+									{
 									stage.vertexColor[i]=rgb;
-								
-								/* Delete the expression: */
-								delete exp;
+									stage.vertexColorRegisters[i]=reg;
+									}
 								}
 							else if(equal(setting,"rgba"))
 								{
-								/* Parse the rgba expression: */
-								Expression* exp=parseExpression(source);
-								
-								/* Evaluate it using the current environment: */
-								GLfloat rgb=GLfloat(exp->evaluate(currentEnv));
+								/* Parse the rgba expression and evaluate it using the current environment: */
+								int reg;
+								GLfloat rgb=parseStageExpression(source,currentEnv,reg);
 								for(int i=0;i<4;++i)
+									{
 									stage.vertexColor[i]=rgb;
-								
-								/* Delete the expression: */
-								delete exp;
+									stage.vertexColorRegisters[i]=reg;
+									}
 								}
 							else if(equal(setting,"color"))
 								{
@@ -1194,9 +1381,7 @@ void Doom3MaterialManager::parseMaterialFile(Doom3FileManager& fileManager,const
 									{
 									if(i>0&&source.readChar()!=',')
 										Misc::throwStdErr("Doom3MaterialManager::parseMaterialFile: malformed color keyword at %s",source.where().c_str());
-									Expression* exp=parseExpression(source);
-									stage.vertexColor[i]=exp->evaluate(currentEnv);
-									delete exp;
+									stage.vertexColor[i]=parseStageExpression(source,currentEnv,stage.vertexColorRegisters[i]);
 									}
 								}
 							else if(equal(setting,"colored"))
@@ -1722,6 +1907,15 @@ Doom3MaterialManager::RenderContext Doom3MaterialManager::start(GLContextData& c
 	return result;
 	}
 
+void Doom3MaterialManager::setTime(float newTime)
+	{
+	/* Evaluate each distinct time-varying expression once, for all materials and OpenGL contexts: */
+	ExpressionEnvironment env;
+	env.time=newTime;
+	Threads::Mutex::Lock expressionProgramLock(expressionProgramMutex);
+	expressionProgram.evaluate(env);
+	}
+
 GLint Doom3MaterialManager::getTangentAttributeIndex(Doom3MaterialManager::RenderContext& renderContext,int tangentIndex) const
 	{
 	return renderContext.useDefaultPipeline?-1:renderContext.dataItem->tangentAttributeIndices[tangentIndex];
@@ -1736,7 +1930,7 @@ void Doom3MaterialManager::setStage(Doom3MaterialManager::RenderContext& renderC
 	/* Set the texture parameters: */
 	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,stage.texCoordClampMode);
 	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,stage.texCoordClampMode);
-	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,stage.texInterpMode);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,stage.texInterpMode==GL_LINEAR?GL_LINEAR_MIPMAP_LINEAR:stage.texInterpMode);
 	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,stage.texInterpMode);
 	}
 
@@ -1835,18 +2029,22 @@ bool Doom3MaterialManager::setMaterial(Doom3MaterialManager::RenderContext& rend
 			{
 			const Material::Stage& pStage=material.stages[parameterStage];
 			
-			/* Set up vertex color: */
-			glColor4fv(pStage.vertexColor);
+			/* Set up vertex color, using the current values of time-varying components: */
+			GLfloat vertexColor[4];
+			for(int i=0;i<4;++i)
+				vertexColor[i]=pStage.vertexColorRegisters[i]>=0?GLfloat(expressionProgram.getValue(pStage.vertexColorRegisters[i])):pStage.vertexColor[i];
+			glColor4fv(vertexColor);
 			
 			/* Set up channel masks: */
 			// glColorMask(pStage.channelMasks[0],pStage.channelMasks[1],pStage.channelMasks[2],pStage.channelMasks[3]);
 			// glDepthMask(pStage.channelMasks[4]);
 			
 			/* Set up alpha test: */
-			if(pStage.alphaTest>0.0f)
+			GLfloat alphaTest=pStage.alphaTestRegister>=0?GLfloat(expressionProgram.getValue(pStage.alphaTestRegister)):pStage.alphaTest;
+			if(alphaTest>0.0f)
 				{
 				glEnable(GL_ALPHA_TEST);
-				glAlphaFunc(GL_GREATER,pStage.alphaTest);
+				glAlphaFunc(GL_GREATER,alphaTest);
 				}
 			else
 				glDisable(GL_ALPHA_TEST);
@@ -23,7 +23,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_INTERNAL_DOOM3MATERIALMANAGER_INCLUDED
 #define SCENEGRAPH_INTERNAL_DOOM3MATERIALMANAGER_INCLUDED
 
+#include <stddef.h>
 #include <vector>
+#include <map>
+#include <Threads/Mutex.h>
 #include <Math/Math.h>
 #include <GL/gl.h>
 #include <GL/GLObject.h>
@@ -42,6 +45,8 @@ namespace SceneGraph {
 
 class Doom3MaterialManager:public GLObject
 	{
+	friend class Doom3MaterialExpressionBenchmark;
+	
 	/* Embedded classes: */
 	private:
 	struct Table // Structure for tables
@@ -126,6 +131,72 @@ class Doom3MaterialManager:public GLObject
 		float global[8];
 		float fragmentPrograms;
 		float sound;
+		
+		/* Constructors and destructors: */
+		ExpressionEnvironment(void); // Creates the default environment
+		};
+	
+	class ExpressionProgram // Class for expressions compiled into a flat list of register operations
+		{
+		/* Embedded classes: */
+		public:
+		enum OpCode // Enumerated type for operations
+			{
+			Constant,EnvironmentVariable,TableLookup,Negate,
+			Add,Subtract,Multiply,Divide,Modulo,Equal,NotEqual,Less,LessEqual,GreaterEqual,Greater,And,Or // Same order as binary operator indices
+			};
+		
+		private:
+		struct Instruction // Structure for instructions; instruction i writes register i
+			{
+			/* Elements: */
+			public:
+			OpCode opCode; // Operation
+			int operands[2]; // Indices of the operand registers, or the environment variable index
+			float constant; // Value of a constant
+			const Table* table; // Table of a table look-up
+			
+			/* Methods: */
+			bool operator<(const Instruction& other) const; // Orders instructions to find common subexpressions
+			};
+		
+		/* Elements: */
+		std::vector<Instruction> instructions; // List of instructions; instructions only read registers of lower indices
+		std::map<Instruction,int> instructionMap; // Map from instructions to the registers already holding their results
+		std::vector<int> dynamicInstructions; // Indices of instructions depending on the environment, in evaluation order
+		std::vector<float> registers; // Register file holding the results of all instructions for the current environment
+		ExpressionEnvironment env; // Environment for which the register file was last evaluated
+		
+		/* Private methods: */
+		float execute(const Instruction& instruction) const; // Returns the result of the given instruction for the current environment and register file
+		int addInstruction(const Instruction& instruction); // Adds an instruction, folding constants and sharing common subexpressions; returns the result register
+		
+		/* Constructors and destructors: */
+		public:
+		ExpressionProgram(void); // Creates an empty program
+		
+		/* Methods: */
+		int addConstant(float constant); // Adds a constant; returns its register
+		int addEnvironmentVariable(int varIndex); // Adds a read of the environment variable of the given index; returns the result register
+		int addTableLookup(const Table* table,int argument); // Adds a look-up of the given table; returns the result register
+		int addOperation(OpCode opCode,int operand0,int operand1 =-1); // Adds a unary or binary operation; returns the result register
+		size_t getNumRegisters(void) const // Returns the number of registers, i.e., of distinct subexpressions
+			{
+			return registers.size();
+			}
+		size_t getNumDynamicInstructions(void) const // Returns the number of instructions executed on each evaluation
+			{
+			return dynamicInstructions.size();
+			}
+		bool isConstant(int reg) const // Returns true if the given register does not depend on the environment
+			{
+			return instructions[reg].opCode==Constant;
+			}
+		void evaluate(const ExpressionEnvironment& newEnv); // Evaluates all registers for the given environment; does nothing if the environment did not change
+		float getValue(int reg) const // Returns the value of the given register for the most recently evaluated environment
+			{
+			return registers[reg];
+			}
 		};
 	
 	class Expression // Base class for expressions that can be evaluated for every frame
@@ -138,6 +209,7 @@ class Doom3MaterialManager:public GLObject
 		
 		/* Methods: */
 		virtual float evaluate(const ExpressionEnvironment& env) const =0; // Evaluates an expression
+		virtual int compile(ExpressionProgram& program) const =0; // Compiles the expression into the given program; returns the register holding its value
 		};
 	
 	class ConstExpression:public Expression // Class for numeric constants
@@ -158,6 +230,10 @@ class Doom3MaterialManager:public GLObject
 			{
 			return constant;
 			}
+		int compile(ExpressionProgram& program) const
+			{
+			return program.addConstant(constant);
+			}
 		};
 	
 	class EnvExpression:public Expression // Class for values from the environment
@@ -187,6 +263,10 @@ class Doom3MaterialManager:public GLObject
 			else
 				return env.sound;
 			}
+		int compile(ExpressionProgram& program) const
+			{
+			return program.addEnvironmentVariable(varIndex);
+			}
 		};
 	
 	class TableExpression:public Expression // Class for table look-ups
@@ -212,6 +292,10 @@ class Doom3MaterialManager:public GLObject
 			{
 			return table!=0?(*table)(child->evaluate(env)):0.0f;
 			}
+		int compile(ExpressionProgram& program) const
+			{
+			return program.addTableLookup(table,child->compile(program));
+			}
 		
 		/* New methods: */
 		void setTable(Table* newTable) // Override table pointer
@@ -253,6 +337,11 @@ class Doom3MaterialManager:public GLObject
 					return 0.0f; // Never reached
 				}
 			}
+		int compile(ExpressionProgram& program) const
+			{
+			int childReg=child->compile(program);
+			return unOpIndex==1?program.addOperation(ExpressionProgram::Negate,childReg):childReg;
+			}
 		};
 	
 	class BinOpExpression:public Expression // Class for binary operators
@@ -323,6 +412,12 @@ class Doom3MaterialManager:public GLObject
 					return 0.0f; // Never reached
 				}
 			}
+		int compile(ExpressionProgram& program) const
+			{
+			int child0Reg=child0->compile(program);
+			int child1Reg=child1->compile(program);
+			return program.addOperation(ExpressionProgram::OpCode(ExpressionProgram::Add+binOpIndex),child0Reg,child1Reg);
+			}
 		};
 	
 	struct Material // Structure to represent materials
@@ -348,6 +443,8 @@ class Doom3MaterialManager:public GLObject
 			bool channelMasks[5]; // Flags whether each of the R, G, B, A, depth channels is masked (write-protected)
 			GLfloat alphaTest; // Only write fragments with A value greater than this value
 			GLfloat vertexColor[4]; // RGBA vertex color
+			int alphaTestRegister; // Register of the expression program holding a time-varying alpha test value, or -1
+			int vertexColorRegisters[4]; // Registers of the expression program holding time-varying vertex color components, or -1
 			};
 		
 		/* Elements: */
@@ -433,11 +530,14 @@ class Doom3MaterialManager:public GLObject
 	Doom3TextureManager& textureManager; // Reference to the texture manager
 	std::vector<Table*> tables; // List of tables
 	MaterialTree materialTree; // Tree of requested materials
+	Threads::Mutex expressionProgramMutex; // Mutex serializing evaluation of the expression program by multiple rendering threads
+	ExpressionProgram expressionProgram; // Program containing the compiled time-varying expressions of all materials
 	
 	/* Private methods: */
 	Expression* parseTerm(Doom3ValueSource& source);
 	Expression* parseExp(Doom3ValueSource& source);
 	Expression* parseExpression(Doom3ValueSource& source);
+	GLfloat parseStageExpression(Doom3ValueSource& source,const ExpressionEnvironment& env,int& reg); // Parses an expression and returns its value in the given environment; sets reg to its register in the expression program if it is time-varying, or -1
 	Doom3TextureManager::ImageID parseImageMap(Doom3ValueSource& source);
 	
 	/* Constructors and destructors: */
@@ -450,6 +550,7 @@ class Doom3MaterialManager:public GLObject
 	MaterialID loadMaterial(const char* materialName); // Requests a material
 	void loadMaterials(Doom3FileManager& fileManager); // Creates all requested materials and loads required texture images
 	void parseMaterialFile(Doom3FileManager& fileManager,const char* fileName); // Parses the material file of the given name
+	void setTime(float newTime); // Evaluates all time-varying material expressions for the given time; called by render actions before drawing, evaluates only once per frame for all OpenGL contexts
 	int getCollisionFlags(const MaterialID& materialID) const // Returns the collision flags associated with the given material
 		{
 		return materialTree.getLeafValue(materialID).collisionFlags;
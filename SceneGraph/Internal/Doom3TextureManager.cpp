@@ -30,6 +30,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/gl.h>
 #include <GL/GLContextData.h>
 #include <Images/TargaImageFileReader.h>
+#include <Images/MipmapChain.h>
 #include <SceneGraph/Internal/Doom3FileManager.h>
 
 namespace SceneGraph {
@@ -88,18 +89,29 @@ void Doom3TextureManager::TextureUploader::operator()(std::string name,const Doo
 	/* Bind the texture object: */
 	glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectIds[image.textureIndex]);
 	
-	/* Upload the texture image: */
-	image.image.glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8);
+	/* Upload the texture image's shared mipmap chain: */
+	const Images::MipmapChain& mipmaps=*textureManager.mipmaps[image.textureIndex];
+	mipmaps.glTexImage2D(GL_TEXTURE_2D,GL_RGBA8);
 	
 	/* Keep track of the number of textures and pixels: */
 	++numTextures;
-	totalTextureSize+=size_t(image.image.getWidth())*size_t(image.image.getHeight())*sizeof(Images::RGBAImage::Color);
+	totalTextureSize+=mipmaps.getDataSize();
 	}
 
 /************************************
 Methods of class Doom3TextureManager:
 ************************************/
 
+void Doom3TextureManager::buildMipmaps(const Doom3TextureManager::Image& image)
+	{
+	/* Build the mipmap chain once for all OpenGL contexts; images are filtered without gamma correction because many of them are normal or height maps: */
+	if(mipmaps.size()<=size_t(image.textureIndex))
+		mipmaps.resize(image.textureIndex+1,0);
+	delete mipmaps[image.textureIndex];
+	mipmaps[image.textureIndex]=0;
+	mipmaps[image.textureIndex]=new Images::MipmapChain(image.image,Images::MipmapChain::BOX,false);
+	}
+
 Doom3TextureManager::Doom3TextureManager(Doom3FileManager& sFileManager)
 	:fileManager(sFileManager),
 	 numTextures(0)
@@ -108,7 +120,9 @@ Doom3TextureManager::Doom3TextureManager(Doom3FileManager& sFileManager)
 
 Doom3TextureManager::~Doom3TextureManager(void)
 	{
-	/* Nothing to do, since RGBAImages take care of themselves... */
+	/* Destroy the mipmap chains; RGBAImages take care of themselves: */
+	for(std::vector<Images::MipmapChain*>::iterator mIt=mipmaps.begin();mIt!=mipmaps.end();++mIt)
+		delete *mIt;
 	}
 
 void Doom3TextureManager::initContext(GLContextData& contextData) const
@@ -189,6 +203,9 @@ Doom3TextureManager::ImageID Doom3TextureManager::loadTexture(const char* textur
 			}
 		}
 	
+	/* Build the texture's mipmap chain: */
+	buildMipmaps(image);
+	
 	/* Return the image ID: */
 	return imageID;
 	}
@@ -231,6 +248,9 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeHeightmap(const Doom3Te
 			}
 		}
 	
+	/* Build the texture's mipmap chain: */
+	buildMipmaps(result);
+	
 	/* Return the result image ID: */
 	return resultId;
 	}
@@ -269,6 +289,9 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeAddNormals(const Doom3T
 			}
 		}
 	
+	/* Build the texture's mipmap chain: */
+	buildMipmaps(result);
+	
 	/* Return the result image ID: */
 	return resultId;
 	}
@@ -297,6 +320,9 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeSmoothNormals(const Doo
 			}
 		}
 	
+	/* Build the texture's mipmap chain: */
+	buildMipmaps(result);
+	
 	/* Return the result image ID: */
 	return resultId;
 	}
@@ -339,6 +365,9 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeAdd(const Doom3TextureM
 			}
 		}
 	
+	/* Build the texture's mipmap chain: */
+	buildMipmaps(result);
+	
 	/* Return the result image ID: */
 	return resultId;
 	}
@@ -376,6 +405,9 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeScale(const Doom3Textur
 			}
 		}
 	
+	/* Build the texture's mipmap chain: */
+	buildMipmaps(result);
+	
 	/* Return the result image ID: */
 	return resultId;
 	}
@@ -406,6 +438,9 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeInvertAlpha(const Doom3
 			}
 		}
 	
+	/* Build the texture's mipmap chain: */
+	buildMipmaps(result);
+	
 	/* Return the result image ID: */
 	return resultId;
 	}
@@ -436,6 +471,9 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeInvertColor(const Doom3
 			}
 		}
 	
+	/* Build the texture's mipmap chain: */
+	buildMipmaps(result);
+	
 	/* Return the result image ID: */
 	return resultId;
 	}
@@ -465,6 +503,9 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeMakeIntensity(const Doo
 			}
 		}
 	
+	/* Build the texture's mipmap chain: */
+	buildMipmaps(result);
+	
 	/* Return the result image ID: */
 	return resultId;
 	}
@@ -499,6 +540,9 @@ Doom3TextureManager::ImageID Doom3TextureManager::computeMakeAlpha(const Doom3Te
 			}
 		}
 	
+	/* Build the texture's mipmap chain: */
+	buildMipmaps(result);
+	
 	/* Return the result image ID: */
 	return resultId;
 	}
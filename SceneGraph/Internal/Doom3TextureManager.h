@@ -23,12 +23,16 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_INTERNAL_DOOM3TEXTUREMANAGER_INCLUDED
 #define SCENEGRAPH_INTERNAL_DOOM3TEXTUREMANAGER_INCLUDED
 
+#include <vector>
 #include <GL/gl.h>
 #include <GL/GLObject.h>
 #include <Images/RGBAImage.h>
 #include <SceneGraph/Internal/Doom3NameTree.h>
 
 /* Forward declarations: */
+namespace Images {
+class MipmapChain;
+}
 namespace SceneGraph {
 class Doom3FileManager;
 }
@@ -105,6 +109,10 @@ class Doom3TextureManager:public GLObject
 	Doom3FileManager& fileManager; // Reference to the file manager used to load texture images
 	int numTextures; // Number of textures currently in the image tree
 	ImageTree imageTree; // The tree containing requested texture images
+	std::vector<Images::MipmapChain*> mipmaps; // Mipmap chains of all texture images, indexed by texture index, shared by all OpenGL contexts
+	
+	/* Private methods: */
+	void buildMipmaps(const Image& image); // Builds the mipmap chain of a completed texture image
 	
 	/* Constructors and destructors: */
 	public:
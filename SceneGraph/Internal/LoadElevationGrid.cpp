@@ -172,6 +172,7 @@ void loadBILGrid(ElevationGridNode& node,Cluster::Multiplexer* multiplexer)
 	node.zDimension.setValue(size[1]);
 	node.zSpacing.setValue(cellSize[1]);
 	std::swap(node.height.getValues(),heights);
+	node.height.markDirty();
 	}
 
 void loadAGRGrid(ElevationGridNode& node,Cluster::Multiplexer* multiplexer)
@@ -229,6 +230,7 @@ void loadAGRGrid(ElevationGridNode& node,Cluster::Multiplexer* multiplexer)
 	node.zDimension.setValue(gridSize[1]);
 	node.zSpacing.setValue(cellSize);
 	std::swap(node.height.getValues(),heights);
+	node.height.markDirty();
 	}
 
 }
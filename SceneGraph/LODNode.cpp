@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/EventTypes.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/TriangleCollector.h>
 
 namespace SceneGraph {
 
@@ -126,4 +127,12 @@ void LODNode::glRenderAction(GLRenderState& renderState) const
 	level.getValue(l)->glRenderAction(renderState);
 	}
 
+
+void LODNode::collectTriangles(TriangleCollector& collector) const
+	{
+	/* Collect the triangles of the most detailed level, independent of the viewpoint: */
+	if(!level.getValues().empty())
+		level.getValue(0)->collectTriangles(collector);
+	}
+
 }
@@ -59,6 +59,7 @@ class LODNode:public GraphNode
 	/* Methods from GraphNode: */
 	virtual Box calcBoundingBox(void) const;
 	virtual void glRenderAction(GLRenderState& renderState) const;
+	virtual void collectTriangles(TriangleCollector& collector) const;
 	};
 
 typedef Misc::Autopointer<LODNode> LODNodePointer;
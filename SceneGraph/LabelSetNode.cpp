@@ -102,6 +102,9 @@ void LabelSetNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void LabelSetNode::update(void)
 	{
+	/* Bump up the geometry version number: */
+	GeometryNode::update();
+	
 	/* Create a default font style node if none was provided: */
 	if(fontStyle.getValue()==0)
 		{
@@ -213,15 +216,24 @@ void LabelSetNode::glRenderAction(GLRenderState& renderState) const
 		glEnable(GL_ALPHA_TEST);
 		glAlphaFunc(GL_GEQUAL,0.5f);
 		
+		/* Get the label positions, transformed in one batch if there is a point transformation: */
+		const std::vector<Point>& coordPoints=coord.getValue()->point.getValues();
+		size_t numLabels=string.getNumValues();
+		if(numLabels>coordPoints.size())
+			numLabels=coordPoints.size();
+		std::vector<Point> transformedPoints;
+		if(pointTransform.getValue()!=0&&numLabels>0)
+			{
+			transformedPoints.resize(numLabels);
+			pointTransform.getValue()->transformPoints(numLabels,&coordPoints[0],&transformedPoints[0]);
+			}
+		const std::vector<Point>& points=pointTransform.getValue()!=0?transformedPoints:coordPoints;
+		
 		/* Draw the label strings as texture-mapped quads billboarded at their point positions: */
-		const std::vector<Point>& points=coord.getValue()->point.getValues();
-		size_t numPoints=points.size();
-		for(size_t i=0;i<string.getNumValues()&&i<numPoints;++i)
+		for(size_t i=0;i<numLabels;++i)
 			{
-			/* Calculate the label position: */
-			Point labelPos=points[i];
-			if(pointTransform.getValue()!=0)
-				labelPos=pointTransform.getValue()->transformPoint(labelPos);
+			/* Get the label position: */
+			const Point& labelPos=points[i];
 			
 			/* Align the billboard's Z axis with the viewing direction: */
 			Rotation transform=Rotation::rotateFromTo(Vector(0,0,1),renderState.getViewerPos()-labelPos);
@@ -239,7 +251,7 @@ void LabelSetNode::glRenderAction(GLRenderState& renderState) const
 			glRotate(transform);
 			
 			/* Draw the label: */
-			glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectIds[i]);
+			renderState.bindTexture2D(dataItem->textureObjectIds[i]);
 			glBegin(GL_QUADS);
 			glNormal3f(0.0f,0.0f,1.0f);
 			glTexCoord(stringTexBox[i].getCorner(0));
@@ -256,7 +268,7 @@ void LabelSetNode::glRenderAction(GLRenderState& renderState) const
 			}
 		
 		/* Protect the texture objects: */
-		glBindTexture(GL_TEXTURE_2D,0);
+		renderState.bindTexture2D(0);
 		
 		/* Reset OpenGL state: */
 		glPopAttrib();
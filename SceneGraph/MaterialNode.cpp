@@ -101,8 +101,9 @@ void MaterialNode::setGLState(GLRenderState& renderState) const
 	/* Enable material rendering: */
 	renderState.enableMaterials();
 	
-	/* Set the material properties: */
-	glMaterial(GLMaterialEnums::FRONT_AND_BACK,material);
+	/* Set the material properties unless they are already current: */
+	if(renderState.setMaterial(this))
+		glMaterial(GLMaterialEnums::FRONT_AND_BACK,material);
 	renderState.emissiveColor=material.emission;
 	glColor(material.diffuse);
 	}
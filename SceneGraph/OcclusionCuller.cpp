@@ -0,0 +1,198 @@
+/***********************************************************************
+OcclusionCuller - Class to skip scene graph nodes that were hidden
+behind other geometry in the previous frame, using hardware occlusion
+queries with temporal coherence.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/OcclusionCuller.h>
+
+#include <GL/gl.h>
+#include <GL/GLGeometryWrappers.h>
+#include <GL/GLContextData.h>
+#include <GL/Extensions/GLNVOcclusionQuery.h>
+#include <SceneGraph/GraphNode.h>
+#include <SceneGraph/GroupNode.h>
+#include <SceneGraph/GLRenderState.h>
+
+namespace SceneGraph {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+bool isRecordingDisplayList(void)
+	{
+	/* Query commands are not compiled into display lists: */
+	GLint listIndex=0;
+	glGetIntegerv(GL_LIST_INDEX,&listIndex);
+	return listIndex!=0;
+	}
+
+void drawQueryBox(const Box& box)
+	{
+	/* Draw the box's faces without touching the color or depth buffers: */
+	glPushAttrib(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT|GL_ENABLE_BIT);
+	glColorMask(GL_FALSE,GL_FALSE,GL_FALSE,GL_FALSE);
+	glDepthMask(GL_FALSE);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_ALPHA_TEST);
+	glDisable(GL_LIGHTING);
+	
+	static const int faceVertices[6][4]={{0,4,6,2},{1,3,7,5},{0,1,5,4},{2,6,7,3},{0,2,3,1},{4,5,7,6}};
+	glBegin(GL_QUADS);
+	for(int face=0;face<6;++face)
+		for(int i=0;i<4;++i)
+			glVertex(box.getVertex(faceVertices[face][i]));
+	glEnd();
+	
+	glPopAttrib();
+	}
+
+}
+
+/******************************************
+Methods of class OcclusionCuller::DataItem:
+******************************************/
+
+OcclusionCuller::DataItem::DataItem(void)
+	:hasOcclusionQueryExtension(GLNVOcclusionQuery::isSupported()),
+	 nodeStates(101),
+	 queryActive(false)
+	{
+	/* Initialize the occlusion query extension: */
+	if(hasOcclusionQueryExtension)
+		GLNVOcclusionQuery::initExtension();
+	}
+
+OcclusionCuller::DataItem::~DataItem(void)
+	{
+	/* Delete all node query objects: */
+	for(NodeStateMap::Iterator nsIt=nodeStates.begin();!nsIt.isFinished();++nsIt)
+		if(nsIt->getDest().queryId!=0)
+			glDeleteOcclusionQueriesNV(1,&nsIt->getDest().queryId);
+	}
+
+/********************************
+Methods of class OcclusionCuller:
+********************************/
+
+OcclusionCuller::OcclusionCuller(void)
+	{
+	}
+
+void OcclusionCuller::initContext(GLContextData& contextData) const
+	{
+	/* Create a data item and store it in the OpenGL context: */
+	DataItem* dataItem=new DataItem;
+	contextData.addDataItem(this,dataItem);
+	}
+
+void OcclusionCuller::glRenderAction(const GraphNode& node,const Box& box,GLRenderState& renderState) const
+	{
+	GLRenderState::CullingStatistics& stats=renderState.cullingStatistics;
+	
+	/* Get the data item: */
+	DataItem* dataItem=renderState.contextData.retrieveDataItem<DataItem>(this);
+	
+	/* Render the node directly if it cannot be queried, if its shapes are only recorded into a render queue, or if the viewer is inside its bounding box: */
+	if(dataItem==0||!dataItem->hasOcclusionQueryExtension||dataItem->queryActive||renderState.renderQueue!=0||box.isNull()||box.isFull()||box.contains(renderState.getViewerPos())||isRecordingDisplayList())
+		{
+		++stats.numDrawn;
+		node.glRenderAction(renderState);
+		return;
+		}
+	
+	/* Get the node's visibility state: */
+	NodeState& ns=dataItem->nodeStates[&node].getDest();
+	if(ns.queryId==0)
+		glGenOcclusionQueriesNV(1,&ns.queryId);
+	
+	/* Retrieve the result of the node's last query if it is available, without waiting for it: */
+	const GroupNode* group=dynamic_cast<const GroupNode*>(&node);
+	if(ns.pending)
+		{
+		GLuint available=GL_FALSE;
+		glGetOcclusionQueryuivNV(ns.queryId,GL_PIXEL_COUNT_AVAILABLE_NV,&available);
+		if(available)
+			{
+			GLuint numPixels=0;
+			glGetOcclusionQueryuivNV(ns.queryId,GL_PIXEL_COUNT_NV,&numPixels);
+			ns.pending=false;
+			
+			if(!ns.visible&&numPixels>0&&group!=0)
+				{
+				/* Optimistically mark the children of a group that became visible as visible: */
+				const GroupNode::MFGraphNode::ValueList& c=group->children.getValues();
+				for(GroupNode::MFGraphNode::ValueList::const_iterator chIt=c.begin();chIt!=c.end();++chIt)
+					dataItem->nodeStates[chIt->getPointer()].getDest().visible=true;
+				}
+			ns.visible=numPixels>0;
+			}
+		}
+	
+	if(ns.visible)
+		{
+		++stats.numDrawn;
+		if(group!=0)
+			{
+			/* Render the group, whose children are culled individually: */
+			unsigned int numDrawn=stats.numDrawn;
+			unsigned int numOcclusionCulled=stats.numOcclusionCulled;
+			node.glRenderAction(renderState);
+			
+			/* Mark the group as hidden if some of its children were hidden and none were drawn: */
+			if(stats.numDrawn==numDrawn&&stats.numOcclusionCulled!=numOcclusionCulled)
+				ns.visible=false;
+			}
+		else if(!ns.pending)
+			{
+			/* Render the node inside a query to check whether it is still visible: */
+			dataItem->queryActive=true;
+			glBeginOcclusionQueryNV(ns.queryId);
+			node.glRenderAction(renderState);
+			glEndOcclusionQueryNV();
+			dataItem->queryActive=false;
+			ns.pending=true;
+			}
+		else
+			{
+			/* Render the node while its last query is still in flight: */
+			node.glRenderAction(renderState);
+			}
+		}
+	else
+		{
+		/* Skip the node: */
+		++stats.numOcclusionCulled;
+		
+		if(!ns.pending)
+			{
+			/* Render the node's bounding box inside a query to check whether the node became visible: */
+			glBeginOcclusionQueryNV(ns.queryId);
+			drawQueryBox(box);
+			glEndOcclusionQueryNV();
+			ns.pending=true;
+			}
+		}
+	}
+
+}
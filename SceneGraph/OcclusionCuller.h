@@ -0,0 +1,87 @@
+/***********************************************************************
+OcclusionCuller - Class to skip scene graph nodes that were hidden
+behind other geometry in the previous frame, using hardware occlusion
+queries with temporal coherence.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_OCCLUSIONCULLER_INCLUDED
+#define SCENEGRAPH_OCCLUSIONCULLER_INCLUDED
+
+#include <Misc/HashTable.h>
+#include <GL/gl.h>
+#include <GL/GLObject.h>
+#include <SceneGraph/Geometry.h>
+
+/* Forward declarations: */
+namespace SceneGraph {
+class GraphNode;
+class GLRenderState;
+}
+
+namespace SceneGraph {
+
+class OcclusionCuller:public GLObject
+	{
+	/* Embedded classes: */
+	private:
+	struct NodeState // Structure holding the visibility state of a node in one OpenGL context
+		{
+		/* Elements: */
+		public:
+		GLuint queryId; // ID of the node's occlusion query object, or 0 if none has been created yet
+		bool visible; // Flag whether the node was visible when it was last queried
+		bool pending; // Flag whether the node's last query has been issued, but its result has not been retrieved yet
+		
+		/* Constructors and destructors: */
+		NodeState(void)
+			:queryId(0),visible(true),pending(false)
+			{
+			}
+		};
+	
+	typedef Misc::HashTable<const GraphNode*,NodeState> NodeStateMap; // Hash table mapping nodes to their visibility states
+	
+	struct DataItem:public GLObject::DataItem
+		{
+		/* Elements: */
+		public:
+		bool hasOcclusionQueryExtension; // Flag whether the OpenGL context supports occlusion queries
+		NodeStateMap nodeStates; // Visibility states of all nodes that have been rendered in this context
+		bool queryActive; // Flag whether an occlusion query is currently active; queries must not be nested
+		
+		/* Constructors and destructors: */
+		DataItem(void);
+		virtual ~DataItem(void);
+		};
+	
+	/* Constructors and destructors: */
+	public:
+	OcclusionCuller(void); // Creates an occlusion culler
+	
+	/* Methods from GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
+	
+	/* New methods: */
+	void glRenderAction(const GraphNode& node,const Box& box,GLRenderState& renderState) const; // Renders the given node with the given bounding box in current model coordinates unless it was hidden in the previous frame; updates culling statistics
+	};
+
+}
+
+#endif
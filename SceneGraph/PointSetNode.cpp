@@ -36,13 +36,48 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 namespace SceneGraph {
 
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+typedef GLGeometry::Vertex<void,0,GLubyte,4,void,Scalar,3> ColorVertex; // Type for uploaded vertices of colored point sets
+typedef GLGeometry::Vertex<void,0,void,0,void,Scalar,3> Vertex; // Type for uploaded vertices of uncolored point sets
+
+/****************
+Helper functions:
+****************/
+
+void addRange(size_t& begin,size_t& end,size_t addBegin,size_t addEnd)
+	{
+	/* Extend the first half-open range to cover the second one: */
+	if(addBegin<addEnd)
+		{
+		if(begin>=end)
+			{
+			begin=addBegin;
+			end=addEnd;
+			}
+		else
+			{
+			if(begin>addBegin)
+				begin=addBegin;
+			if(end<addEnd)
+				end=addEnd;
+			}
+		}
+	}
+
+}
+
 /***************************************
 Methods of class PointSetNode::DataItem:
 ***************************************/
 
 PointSetNode::DataItem::DataItem(void)
 	:vertexBufferObjectId(0),
-	 version(0)
+	 version(0),numAllocatedVertices(0),haveColors(false)
 	{
 	if(GLARBVertexBufferObject::isSupported())
 		{
@@ -67,9 +102,50 @@ PointSetNode::DataItem::~DataItem(void)
 Methods of class PointSetNode:
 *****************************/
 
+void PointSetNode::uploadVertices(size_t begin,size_t end) const
+	{
+	/* Bail out on empty ranges, where the vectors below would have no first element to point to: */
+	if(begin>=end)
+		return;
+	
+	const std::vector<Point>& points=coord.getValue()->point.getValues();
+	size_t numPoints=end-begin;
+	
+	/* Transform the points in one batch if there is a point transformation: */
+	const Point* pPtr=&points[begin];
+	std::vector<Point> tPoints;
+	if(pointTransform.getValue()!=0)
+		{
+		tPoints.resize(numPoints);
+		pointTransform.getValue()->transformPoints(numPoints,pPtr,&tPoints[0]);
+		pPtr=&tPoints[0];
+		}
+	
+	if(color.getValue()!=0)
+		{
+		/* Assemble and upload colored vertices: */
+		const std::vector<Color>& colors=color.getValue()->color.getValues();
+		std::vector<ColorVertex> vertices(numPoints);
+		for(size_t i=0;i<numPoints;++i)
+			{
+			vertices[i].color=colors[begin+i];
+			vertices[i].position=pPtr[i];
+			}
+		glBufferSubDataARB(GL_ARRAY_BUFFER_ARB,begin*sizeof(ColorVertex),numPoints*sizeof(ColorVertex),&vertices[0]);
+		}
+	else
+		{
+		/* Assemble and upload uncolored vertices: */
+		std::vector<Vertex> vertices(numPoints);
+		for(size_t i=0;i<numPoints;++i)
+			vertices[i].position=pPtr[i];
+		glBufferSubDataARB(GL_ARRAY_BUFFER_ARB,begin*sizeof(Vertex),numPoints*sizeof(Vertex),&vertices[0]);
+		}
+	}
+
 PointSetNode::PointSetNode(void)
 	:pointSize(Scalar(1)),
-	 version(0)
+	 lastPointVersion(0),lastColorVersion(0)
 	{
 	}
 
@@ -103,8 +179,47 @@ void PointSetNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void PointSetNode::update(void)
 	{
-	/* Bump up the point set's version number: */
-	++version;
+	/* Bump up the geometry version number: */
+	GeometryNode::update();
+	
+	/* Check whether the point set's nodes are unchanged, so that only some points or colors can have changed: */
+	bool partial=coord.getValue()!=0&&coord.getValue()==lastCoord&&color.getValue()==lastColor&&pointTransform.getValue()==0;
+	bool valuesChanged=false;
+	size_t begin=0,end=0;
+	if(partial&&coord.getValue()->point.getVersion()!=lastPointVersion)
+		{
+		/* Get the range of changed points: */
+		valuesChanged=true;
+		partial=coord.getValue()->point.getDirtyRange(lastPointVersion,begin,end);
+		}
+	if(partial&&color.getValue()!=0&&color.getValue()->color.getVersion()!=lastColorVersion)
+		{
+		/* Add the range of changed colors: */
+		valuesChanged=true;
+		size_t colorBegin,colorEnd;
+		partial=color.getValue()->color.getDirtyRange(lastColorVersion,colorBegin,colorEnd);
+		addRange(begin,end,colorBegin,colorEnd);
+		}
+	
+	/* Bump up the point set's version number; an update without changed values must have changed something else: */
+	if(partial&&valuesChanged)
+		vertexChanges.addRangeChange(begin,end);
+	else
+		vertexChanges.addFullChange();
+	
+	/* Remember the state of the point set's coordinates and colors for the next update: */
+	lastCoord=coord.getValue();
+	if(lastCoord!=0)
+		{
+		lastPointVersion=lastCoord->point.getVersion();
+		lastCoord->point.clearDirty();
+		}
+	lastColor=color.getValue();
+	if(lastColor!=0)
+		{
+		lastColorVersion=lastColor->color.getVersion();
+		lastColor->color.clearDirty();
+		}
 	}
 
 Box PointSetNode::calcBoundingBox(void) const
@@ -141,60 +256,38 @@ void PointSetNode::glRenderAction(GLRenderState& renderState) const
 		
 		if(dataItem->vertexBufferObjectId!=0)
 			{
-			typedef GLGeometry::Vertex<void,0,GLubyte,4,void,Scalar,3> ColorVertex;
-			typedef GLGeometry::Vertex<void,0,void,0,void,Scalar,3> Vertex;
-			
 			/* Bind the point set's vertex buffer object: */
 			glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->vertexBufferObjectId);
 			
 			/* Check if the vertex buffer object is outdated: */
-			if(dataItem->version!=version)
+			if(dataItem->version!=vertexChanges.getVersion())
 				{
-				const std::vector<Point>& points=coord.getValue()->point.getValues();
-				size_t numPoints=points.size();
-				
-				/* Prepare a vertex buffer: */
-				glBufferDataARB(GL_ARRAY_BUFFER_ARB,numPoints*(color.getValue()!=0?sizeof(ColorVertex):sizeof(Vertex)),0,GL_STATIC_DRAW_ARB);
-				if(color.getValue()!=0)
+				size_t numPoints=coord.getValue()->point.getNumValues();
+				bool haveColors=color.getValue()!=0;
+				size_t begin,end;
+				if(haveColors==dataItem->haveColors&&numPoints<=dataItem->numAllocatedVertices&&vertexChanges.getRangeSince(dataItem->version,begin,end))
 					{
-					const std::vector<Color>& colors=color.getValue()->color.getValues();
-					ColorVertex* vPtr=static_cast<ColorVertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
-					if(pointTransform.getValue()!=0)
-						{
-						for(size_t i=0;i<numPoints;++i,++vPtr)
-							{
-							vPtr->color=colors[i];
-							vPtr->position=pointTransform.getValue()->transformPoint(points[i]);
-							}
-						}
-					else
-						{
-						for(size_t i=0;i<numPoints;++i,++vPtr)
-							{
-							vPtr->color=colors[i];
-							vPtr->position=points[i];
-							}
-						}
+					/* Upload only the changed points: */
+					if(end>numPoints)
+						end=numPoints;
+					if(begin<end)
+						uploadVertices(begin,end);
 					}
 				else
 					{
-					Vertex* vPtr=static_cast<Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
-					if(pointTransform.getValue()!=0)
-						{
-						for(size_t i=0;i<numPoints;++i,++vPtr)
-							vPtr->position=pointTransform.getValue()->transformPoint(points[i]);
-						}
-					else
-						{
-						for(size_t i=0;i<numPoints;++i,++vPtr)
-							vPtr->position=points[i];
-						}
+					/* Prepare a vertex buffer, leaving room to grow if the point set outgrew the previous one: */
+					bool growing=dataItem->numAllocatedVertices>0&&numPoints>dataItem->numAllocatedVertices;
+					size_t numAllocatedVertices=growing?numPoints+numPoints/2:numPoints;
+					glBufferDataARB(GL_ARRAY_BUFFER_ARB,numAllocatedVertices*(haveColors?sizeof(ColorVertex):sizeof(Vertex)),0,growing?GL_DYNAMIC_DRAW_ARB:GL_STATIC_DRAW_ARB);
+					dataItem->numAllocatedVertices=numAllocatedVertices;
+					dataItem->haveColors=haveColors;
+					
+					/* Upload all points: */
+					uploadVertices(0,numPoints);
 					}
 				
-				glUnmapBufferARB(GL_ARRAY_BUFFER_ARB);
-				
 				/* Mark the vertex buffer object as up-to-date: */
-				dataItem->version=version;
+				dataItem->version=vertexChanges.getVersion();
 				}
 			
 			/* Set up the vertex arrays: */
@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/gl.h>
 #include <GL/GLObject.h>
 #include <SceneGraph/FieldTypes.h>
+#include <SceneGraph/DirtyRangeHistory.h>
 #include <SceneGraph/GeometryNode.h>
 #include <SceneGraph/ColorNode.h>
 #include <SceneGraph/CoordinateNode.h>
@@ -45,6 +46,8 @@ class PointSetNode:public GeometryNode,public GLObject
 		public:
 		GLuint vertexBufferObjectId; // ID of vertex buffer object containing the point set, if supported
 		unsigned int version; // Version of point set stored in vertex buffer object
+		size_t numAllocatedVertices; // Number of vertices for which the vertex buffer object has room
+		bool haveColors; // Flag whether the vertices in the vertex buffer object have colors
 		
 		/* Constructors and destructors: */
 		DataItem(void);
@@ -61,7 +64,14 @@ class PointSetNode:public GeometryNode,public GLObject
 	
 	/* Derived state: */
 	protected:
-	unsigned int version; // Version number of point set
+	DirtyRangeHistory vertexChanges; // Version number of point set and ranges of points changed by recent versions
+	CoordinateNodePointer lastCoord; // Coordinate node at the last update
+	ColorNodePointer lastColor; // Color node at the last update
+	unsigned int lastPointVersion; // Version of the coordinate node's point field at the last update
+	unsigned int lastColorVersion; // Version of the color node's color field at the last update
+	
+	/* Protected methods: */
+	void uploadVertices(size_t begin,size_t end) const; // Uploads the given half-open range of points into the currently bound vertex buffer object
 	
 	/* Constructors and destructors: */
 	public:
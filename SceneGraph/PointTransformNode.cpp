@@ -0,0 +1,49 @@
+/***********************************************************************
+PointTransformNode - Base class for nodes that define non-linear
+transformations that can be applied to the point coordinates and normal
+vectors of Geometry nodes.
+Copyright (c) 2009-2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/PointTransformNode.h>
+
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+
+namespace SceneGraph {
+
+/***********************************
+Methods of class PointTransformNode:
+***********************************/
+
+void PointTransformNode::transformPoints(size_t numPoints,const Point* points,Point* transformedPoints) const
+	{
+	/* Transform all points individually: */
+	for(size_t i=0;i<numPoints;++i)
+		transformedPoints[i]=transformPoint(points[i]);
+	}
+
+void PointTransformNode::transformNormals(size_t numNormals,const Point* basePoints,const Vector* normals,Vector* transformedNormals) const
+	{
+	/* Transform all normal vectors individually: */
+	for(size_t i=0;i<numNormals;++i)
+		transformedNormals[i]=transformNormal(basePoints[i],normals[i]);
+	}
+
+}
@@ -2,7 +2,7 @@
 PointTransformNode - Base class for nodes that define non-linear
 transformations that can be applied to the point coordinates and normal
 vectors of Geometry nodes.
-Copyright (c) 2009 Oliver Kreylos
+Copyright (c) 2009-2011 Oliver Kreylos
 
 This file is part of the Simple Scene Graph Renderer (SceneGraph).
 
@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_POINTTRANSFORMNODE_INCLUDED
 #define SCENEGRAPH_POINTTRANSFORMNODE_INCLUDED
 
+#include <stddef.h>
 #include <vector>
 #include <Misc/Autopointer.h>
 #include <SceneGraph/Geometry.h>
@@ -38,6 +39,8 @@ class PointTransformNode:public Node
 	virtual Point transformPoint(const Point& point) const =0; // Transforms a point
 	virtual Box calcBoundingBox(const std::vector<Point>& points) const =0; // Calculates transformed bounding box of a point list
 	virtual Vector transformNormal(const Point& basePoint,const Vector& normal) const =0; // Transforms a normal vector based at the given point
+	virtual void transformPoints(size_t numPoints,const Point* points,Point* transformedPoints) const; // Transforms an array of points; source and destination arrays may be identical
+	virtual void transformNormals(size_t numNormals,const Point* basePoints,const Vector* normals,Vector* transformedNormals) const; // Transforms an array of normal vectors based at the given array of points; normal source and destination arrays may be identical
 	};
 
 typedef Misc::Autopointer<PointTransformNode> PointTransformNodePointer;
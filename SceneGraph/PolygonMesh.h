@@ -3,7 +3,7 @@ PolygonMesh - Class to represent meshes of planar convex polygons. Meant
 as a temporary helper structure to convert polygon soup into an
 efficiently rendered representation, and compute a full set of vertex
 attributes.
-Copyright (c) 2009-2010 Oliver Kreylos
+Copyright (c) 2009-2011 Oliver Kreylos
 
 This file is part of the Simple Scene Graph Renderer (SceneGraph).
 
@@ -25,8 +25,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_POLYGONMESH_INCLUDED
 #define SCENEGRAPH_POLYGONMESH_INCLUDED
 
+#include <stddef.h>
 #include <vector>
-#include <Misc/OrderedTuple.h>
+#include <Misc/SizedTypes.h>
 #include <Misc/UnorderedTuple.h>
 #include <Misc/HashTable.h>
 
@@ -50,9 +51,7 @@ class PolygonMesh
 	typedef typename MeshVertex::TPoint TPoint; // Type for points in texture space
 	typedef unsigned int Card; // Cardinal integer type
 	static const Card invalidIndex; // Invalid Cardinal integer
-	typedef Misc::OrderedTuple<Card,2> DirectedEdge; // Type to represent a directed edge as a pair of vertex indices
 	typedef Misc::UnorderedTuple<Card,2> UndirectedEdge; // Type to represent an undirected edge as a pair of vertex indices
-	typedef Misc::OrderedTuple<Card,2> FaceVertex; // Type to represent a (face index, vertex index) pair to store per-face vertex attributes
 	
 	private:
 	struct Face // Structure for polygon mesh faces
@@ -67,31 +66,40 @@ class PolygonMesh
 		Vector normal; // Face normal vector
 		};
 	
-	struct FaceEdge // Structure for half-edges around polygon mesh faces
-		{
-		/* Elements: */
-		Card faceIndex; // Index of face to which this half-edge belongs
-		Card previousVertexIndex; // Index of face vertex preceding half-edge in face order
-		};
-	
-	typedef Misc::HashTable<DirectedEdge,FaceEdge,DirectedEdge> FaceEdgeHasher; // Hash table type to map directed edges to face edges
-	typedef Misc::HashTable<FaceVertex,TPoint,FaceVertex> FaceVertexTexCoordHasher; // Hash table type to map face vertices to per-face vertex texture coordinates
 	typedef Misc::HashTable<UndirectedEdge,void,UndirectedEdge> CreaseEdgeHasher; // Hash table type to represent sets of crease edges
-	typedef Misc::HashTable<FaceVertex,Vector,FaceVertex> FaceVertexNormalHasher; // Hash table type to map face vertices to per-face vertex normals
+	
+	/* Parallel jobs working on ranges of edges, faces, or vertices: */
+	class EdgePartitioner; // Sorts face edges into partitions by hash value
+	class EdgeMatcher; // Matches opposite face edges inside partitions
+	class CreaseEdgeFinder; // Marks crease edges of a range of faces
+	class VertexNormalCalculator; // Calculates normal vectors of a range of vertices
+	class VertexTexCoordCalculator; // Calculates texture coordinates of a range of vertices
+	class FaceTriangulator; // Triangulates a range of faces into pre-allocated triangle sets
+	class TriangleVertexCreator; // Creates a range of triangle set vertices from face vertices
+	
+	/*********************************************************************
+	All adjacency information is stored in flat arrays indexed by face
+	vertex. Face edge i is the directed edge leading from face vertex i
+	to the next vertex of the same face; it is the vertex' outgoing edge
+	inside that face.
+	*********************************************************************/
 	
 	/* Elements: */
-	private:
 	std::vector<MeshVertex> vertices; // List of mesh vertices
-	std::vector<Card> vertexEdges; // List of one outgoing directed edge for each mesh vertex
-	std::vector<bool> vertexMultiSurfaceFlags; // List of flags indicating per-face texture coordinates for each mesh vertex
-	std::vector<bool> vertexCreaseFlags; // List of crease flags indicating per-face normal vectors for each mesh vertex
+	std::vector<Card> vertexEdges; // One outgoing face edge for each mesh vertex; a boundary edge if the vertex has one
+	std::vector<Misc::UInt8> vertexMultiSurfaceFlags; // List of flags indicating per-face texture coordinates for each mesh vertex; bytes instead of bits to allow concurrent updates
+	std::vector<Misc::UInt8> vertexCreaseFlags; // List of crease flags indicating per-face normal vectors for each mesh vertex
 	std::vector<Card> faceVertexIndices; // List of vertex indices for each mesh face
+	std::vector<Card> faceVertexFaces; // Index of the face containing each face vertex
 	std::vector<Face> faces; // List of mesh faces
 	Card numSurfaces; // Number of different surfaces present in the mesh
-	FaceEdgeHasher faceEdges; // Hash table of face edges
-	FaceVertexTexCoordHasher vertexTexCoords; // Hash table storing per-face vertex texture coordinates for multi-surface vertices
-	CreaseEdgeHasher creaseEdges; // Hash table of crease edges
-	FaceVertexNormalHasher vertexNormals; // Hash table storing per-face normal vectors for crease vertices
+	bool connected; // Flag whether the face edge adjacency arrays are up-to-date
+	std::vector<Card> faceEdgeOpposites; // Index of the opposite of each face edge, or invalidIndex for boundary edges
+	std::vector<Misc::UInt8> faceEdgeCreaseFlags; // Flags marking face edges as crease edges; an edge is a crease if either of its halves is marked
+	std::vector<TPoint> faceVertexTexCoords; // Per-face texture coordinates of face vertices belonging to multi-surface vertices
+	std::vector<Vector> faceVertexNormals; // Per-face normal vectors of face vertices belonging to crease vertices
+	CreaseEdgeHasher creaseEdges; // Hash table of crease edges marked explicitly by vertex indices
+	unsigned int maxNumThreads; // Maximum number of threads to use for parallel processing; 0 means one per processor
 	
 	/* Temporary state while adding a face: */
 	bool addingFace; // Flag that we're currently adding a face
@@ -99,11 +107,37 @@ class PolygonMesh
 	Card newFirstVertexIndex; // Index of new face's first vertex index
 	
 	/* Private methods: */
-	void connectFace(Card faceIndex); // Inserts a face into the mesh's connectivity
-	void triangulateFace(Card faceIndex,std::vector<Card>& triangleVertexIndices) const; // Triangulates the given convex or non-convex face; puts triangle vertex index triples into vector
-	const TPoint& getVertexTexCoord(Card faceIndex,Card vertexIndex) const; // Returns texture coordinates of a vertex for a given face
-	const Vector& getVertexNormal(Card faceIndex,Card vertexIndex) const; // Returns normal vector of a vertex for a given face
-	Card getTriangleVertexIndex(Card faceIndex,Card vertexIndex) const;
+	Card getNextFaceEdge(Card faceEdge) const // Returns the face edge following the given one in its face
+		{
+		const Face& face=faces[faceVertexFaces[faceEdge]];
+		return faceEdge+1<face.firstVertexIndex+face.numVertices?faceEdge+1:face.firstVertexIndex;
+		}
+	Card getPreviousFaceEdge(Card faceEdge) const // Returns the face edge preceding the given one in its face
+		{
+		const Face& face=faces[faceVertexFaces[faceEdge]];
+		return faceEdge>face.firstVertexIndex?faceEdge-1:face.firstVertexIndex+face.numVertices-1;
+		}
+	Card getNextVertexEdge(Card faceEdge) const // Returns the outgoing edge following the given one counter-clockwise around its start vertex, or invalidIndex if a boundary is reached
+		{
+		return faceEdgeOpposites[getPreviousFaceEdge(faceEdge)];
+		}
+	bool isCreaseEdge(Card faceEdge) const // Returns true if the given face edge is part of a crease edge
+		{
+		return faceEdgeCreaseFlags[faceEdge]!=0||(faceEdgeOpposites[faceEdge]!=invalidIndex&&faceEdgeCreaseFlags[faceEdgeOpposites[faceEdge]]!=0);
+		}
+	void initFace(Card faceIndex); // Calculates a new face's normal vector and convexity
+	void matchFaceEdges(std::vector<Card>& duplicateFaceEdges); // Finds the opposites of all face edges; returns face edges duplicating earlier face edges in ascending order
+	void connectFaces(void); // Updates the face edge adjacency arrays after faces have been added
+	Card findFaceEdge(Card vertexIndex0,Card vertexIndex1) const; // Returns the face edge leading from the first to the second vertex, or invalidIndex
+	void markCreaseEdge(const UndirectedEdge& edge); // Marks the face edges along the given edge as crease edges
+	void calcVertexTexCoord(Card vertexIndex,const std::vector<const TexCoordCalculator<MeshVertex>*>& texCoordCalculators); // Calculates texture coordinates for a single vertex
+	void calcVertexNormal(Card vertexIndex); // Calculates the normal vector(s) of a single vertex
+	void triangulateFace(Card faceIndex,std::vector<Card>& triangleFaceVertices) const; // Triangulates the given convex or non-convex face into exactly numVertices-2 triangles; puts triangle face vertex index triples into vector
+	const TPoint& getVertexTexCoord(Card faceVertex) const; // Returns texture coordinates of a face vertex
+	const Vector& getVertexNormal(Card faceVertex) const; // Returns normal vector of a face vertex
+	MeshVertex getTriangleVertex(Card faceVertex) const; // Returns a triangle set vertex for a face vertex
+	void triangulateFaces(Card surfaceIndex,std::vector<MeshVertex>& triangleVertices) const; // Triangulates all faces of the given surface, or all faces if surfaceIndex is invalidIndex, into a triangle set
+	void triangulateFaces(Card surfaceIndex,std::vector<MeshVertex>& triangleVertices,std::vector<Card>& triangleIndices) const; // Ditto, into an indexed triangle set
 	
 	/* Constructors and destructors: */
 	public:
@@ -111,6 +145,10 @@ class PolygonMesh
 	~PolygonMesh(void); // Destroys polygon mesh
 	
 	/* New Methods: */
+	void setMaxNumThreads(unsigned int newMaxNumThreads) // Sets the maximum number of threads used to process the mesh; 0 uses one thread per processor
+		{
+		maxNumThreads=newMaxNumThreads;
+		}
 	Card getNumVertices(void) const // Returns the current number of vertices in the mesh
 		{
 		return vertices.size();
@@ -145,10 +183,10 @@ class PolygonMesh
 	void findCreaseEdges(const std::vector<Scalar>& creaseAngles); // Marks all edges according to surface-specific crease angles
 	void findSurfaceCreaseEdges(void); // Marks all edges between faces belonging to different surfaces as crease edges
 	void calcVertexNormals(void); // Calculates vertex normals for all vertices, respecting previously marked crease edges
-	void triangulate(std::vector<MeshVertex>& vertices) const; // Triangulates all faces of the polygon mesh and adds them to the given triangle set
-	void triangulate(std::vector<MeshVertex>& vertices,std::vector<Card>& indices) const; // Triangulates all faces of the polygon mesh and adds them to the given indexed triangle set
-	void triangulateSurface(Card surfaceIndex,std::vector<MeshVertex>& vertices) const; // Triangulates all faces of the polygon mesh belonging to the given surface and adds them to the given triangle set
-	void triangulateSurface(Card surfaceIndex,std::vector<MeshVertex>& vertices,std::vector<Card>& indices) const; // Triangulates all faces of the polygon mesh belonging to the given surface and adds them to the given indexed triangle set
+	void triangulate(std::vector<MeshVertex>& triangleVertices) const; // Triangulates all faces of the polygon mesh and adds them to the given triangle set
+	void triangulate(std::vector<MeshVertex>& triangleVertices,std::vector<Card>& triangleIndices) const; // Triangulates all faces of the polygon mesh and adds them to the given indexed triangle set
+	void triangulateSurface(Card surfaceIndex,std::vector<MeshVertex>& triangleVertices) const; // Triangulates all faces of the polygon mesh belonging to the given surface and adds them to the given triangle set
+	void triangulateSurface(Card surfaceIndex,std::vector<MeshVertex>& triangleVertices,std::vector<Card>& triangleIndices) const; // Triangulates all faces of the polygon mesh belonging to the given surface and adds them to the given indexed triangle set
 	};
 
 }
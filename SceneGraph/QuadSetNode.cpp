@@ -28,6 +28,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLGeometryWrappers.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/TriangleCollector.h>
 
 namespace SceneGraph {
 
@@ -70,6 +71,9 @@ void QuadSetNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void QuadSetNode::update(void)
 	{
+	/* Bump up the geometry version number: */
+	GeometryNode::update();
+	
 	/* Initialize the quad corner texture coordinates: */
 	quadTexCoords[0]=Point(0,0,0);
 	quadTexCoords[1]=Point(1,0,0);
@@ -79,7 +83,17 @@ void QuadSetNode::update(void)
 	/* Calculate normal vectors for all quads: */
 	if(coord.getValue()!=0)
 		{
+		/* Get the quad set's corner points, transformed by the point transformation if there is one: */
 		size_t numPoints=coord.getValue()->point.getNumValues();
+		std::vector<Point> transformedPoints;
+		const Point* cps=numPoints>0?&coord.getValue()->point.getValues()[0]:0;
+		if(pointTransform.getValue()!=0&&numPoints>0)
+			{
+			transformedPoints.resize(numPoints);
+			pointTransform.getValue()->transformPoints(numPoints,cps,&transformedPoints[0]);
+			cps=&transformedPoints[0];
+			}
+		
 		std::vector<Vector> newQuadNormals;
 		for(size_t q=0;q+4<=numPoints;q+=4)
 			{
@@ -88,19 +102,12 @@ void QuadSetNode::update(void)
 			if(ccw.getValue())
 				{
 				for(size_t i=0;i<4;++i)
-					ps[i]=coord.getValue()->point.getValue(q+i);
+					ps[i]=cps[q+i];
 				}
 			else
 				{
 				for(size_t i=0;i<4;++i)
-					ps[i]=coord.getValue()->point.getValue(q+3-i);
-				}
-			
-			if(pointTransform.getValue()!=0)
-				{
-				/* Transform the quad's corner points: */
-				for(int i=0;i<4;++i)
-					ps[i]=pointTransform.getValue()->transformPoint(ps[i]);
+					ps[i]=cps[q+3-i];
 				}
 			
 			/* Calculate the quad's normal vector: */
@@ -140,8 +147,18 @@ void QuadSetNode::glRenderAction(GLRenderState& renderState) const
 	/* Set up OpenGL state: */
 	renderState.enableCulling(GL_BACK);
 	
-	/* Render the quad set: */
+	/* Get the quad set's corner points, transformed by the point transformation if there is one: */
 	size_t numPoints=coord.getValue()->point.getNumValues();
+	std::vector<Point> transformedPoints;
+	const Point* cps=&coord.getValue()->point.getValues()[0];
+	if(pointTransform.getValue()!=0)
+		{
+		transformedPoints.resize(numPoints);
+		pointTransform.getValue()->transformPoints(numPoints,cps,&transformedPoints[0]);
+		cps=&transformedPoints[0];
+		}
+	
+	/* Render the quad set: */
 	glBegin(GL_QUADS);
 	std::vector<Vector>::const_iterator qnIt=quadNormals.begin();
 	for(size_t q=0;q+4<=numPoints;q+=4,++qnIt)
@@ -151,19 +168,12 @@ void QuadSetNode::glRenderAction(GLRenderState& renderState) const
 		if(ccw.getValue())
 			{
 			for(size_t i=0;i<4;++i)
-				ps[i]=coord.getValue()->point.getValue(q+i);
+				ps[i]=cps[q+i];
 			}
 		else
 			{
 			for(size_t i=0;i<4;++i)
-				ps[i]=coord.getValue()->point.getValue(q+3-i);
-			}
-		
-		if(pointTransform.getValue()!=0)
-			{
-			/* Transform the quad's corner points: */
-			for(int i=0;i<4;++i)
-				ps[i]=pointTransform.getValue()->transformPoint(ps[i]);
+				ps[i]=cps[q+3-i];
 			}
 		
 		/* Draw the quad's front: */
@@ -188,4 +198,32 @@ void QuadSetNode::glRenderAction(GLRenderState& renderState) const
 	glEnd();
 	}
 
+
+void QuadSetNode::collectTriangles(TriangleCollector& collector) const
+	{
+	/* Bail out if there are less than 4 points: */
+	if(coord.getValue()==0||coord.getValue()->point.getNumValues()<4)
+		return;
+	
+	/* Get the quad set's corner points, transformed by the point transformation if there is one: */
+	size_t numPoints=coord.getValue()->point.getNumValues();
+	std::vector<Point> transformedPoints;
+	const Point* ps=&coord.getValue()->point.getValues()[0];
+	if(pointTransform.getValue()!=0)
+		{
+		transformedPoints.resize(numPoints);
+		pointTransform.getValue()->transformPoints(numPoints,ps,&transformedPoints[0]);
+		ps=&transformedPoints[0];
+		}
+	
+	/* Add all quads in counter-clockwise order: */
+	for(size_t q=0;q+4<=numPoints;q+=4)
+		{
+		if(ccw.getValue())
+			collector.addQuad(ps[q+0],ps[q+1],ps[q+2],ps[q+3]);
+		else
+			collector.addQuad(ps[q+3],ps[q+2],ps[q+1],ps[q+0]);
+		}
+	}
+
 }
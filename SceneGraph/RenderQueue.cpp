@@ -0,0 +1,113 @@
+/***********************************************************************
+RenderQueue - Class to record the shapes reached during a scene graph
+traversal, and to render them afterwards sorted by their OpenGL state.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/RenderQueue.h>
+
+#include <algorithm>
+#include <functional>
+#include <SceneGraph/ShapeNode.h>
+#include <SceneGraph/AppearanceNode.h>
+#include <SceneGraph/MaterialNode.h>
+#include <SceneGraph/TextureNode.h>
+#include <SceneGraph/GLRenderState.h>
+
+namespace SceneGraph {
+
+/************************************************
+Declaration of struct RenderQueue::DrawItemOrder:
+************************************************/
+
+struct RenderQueue::DrawItemOrder
+	{
+	/* Methods: */
+	public:
+	bool operator()(const DrawItem& di1,const DrawItem& di2) const
+		{
+		/* Render opaque shapes first, sorted by texture and material, and transparent shapes last in traversal order: */
+		if(di1.transparent!=di2.transparent)
+			return di2.transparent;
+		if(!di1.transparent)
+			{
+			if(di1.texture!=di2.texture)
+				return std::less<const TextureNode*>()(di1.texture,di2.texture);
+			if(di1.material!=di2.material)
+				return std::less<const MaterialNode*>()(di1.material,di2.material);
+			}
+		return di1.order<di2.order;
+		}
+	};
+
+/****************************
+Methods of class RenderQueue:
+****************************/
+
+RenderQueue::RenderQueue(bool sSortByState)
+	:sortByState(sSortByState)
+	{
+	}
+
+void RenderQueue::setSortByState(bool newSortByState)
+	{
+	sortByState=newSortByState;
+	}
+
+void RenderQueue::addShape(const ShapeNode& shape,const GLRenderState& renderState)
+	{
+	/* Create a draw item: */
+	DrawItem di;
+	di.shape=&shape;
+	di.transform=renderState.getTransform();
+	di.texture=0;
+	di.material=0;
+	di.transparent=false;
+	const AppearanceNode* appearance=shape.appearance.getValue().getPointer();
+	if(appearance!=0)
+		{
+		di.texture=appearance->texture.getValue().getPointer();
+		di.material=appearance->material.getValue().getPointer();
+		if(di.material!=0)
+			di.transparent=di.material->transparency.getValue()>0.0f;
+		}
+	di.order=drawItems.size();
+	
+	drawItems.push_back(di);
+	}
+
+void RenderQueue::glRenderAction(GLRenderState& renderState)
+	{
+	/* Sort the recorded shapes to minimize OpenGL state changes: */
+	if(sortByState)
+		std::sort(drawItems.begin(),drawItems.end(),DrawItemOrder());
+	
+	/* Render all recorded shapes: */
+	for(std::vector<DrawItem>::const_iterator diIt=drawItems.begin();diIt!=drawItems.end();++diIt)
+		{
+		OGTransform previousTransform=renderState.pushTransform(diIt->transform);
+		diIt->shape->glRenderShape(renderState);
+		renderState.popTransform(previousTransform);
+		}
+	
+	/* Clear the queue, but keep its memory for the next traversal: */
+	drawItems.clear();
+	}
+
+}
@@ -0,0 +1,83 @@
+/***********************************************************************
+RenderQueue - Class to record the shapes reached during a scene graph
+traversal, and to render them afterwards sorted by their OpenGL state.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_RENDERQUEUE_INCLUDED
+#define SCENEGRAPH_RENDERQUEUE_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Geometry/OrthogonalTransformation.h>
+#include <SceneGraph/Geometry.h>
+
+/* Forward declarations: */
+namespace SceneGraph {
+class ShapeNode;
+class TextureNode;
+class MaterialNode;
+class GLRenderState;
+}
+
+namespace SceneGraph {
+
+class RenderQueue
+	{
+	/* Embedded classes: */
+	private:
+	struct DrawItem // Structure for recorded shapes
+		{
+		/* Elements: */
+		public:
+		const ShapeNode* shape; // Shape node to render
+		OGTransform transform; // Transformation from the render state's initial model coordinates to the shape's model coordinates
+		const TextureNode* texture; // Shape's texture node, or null; primary sort key
+		const MaterialNode* material; // Shape's material node, or null; secondary sort key
+		bool transparent; // Flag whether the shape's material is transparent
+		size_t order; // Index of the shape in traversal order
+		};
+	
+	struct DrawItemOrder; // Functor to sort draw items by OpenGL state
+	
+	/* Elements: */
+	bool sortByState; // Flag whether to sort recorded shapes by OpenGL state before rendering them
+	std::vector<DrawItem> drawItems; // List of recorded shapes
+	
+	/* Constructors and destructors: */
+	public:
+	RenderQueue(bool sSortByState =true); // Creates an empty render queue
+	
+	/* Methods: */
+	bool getSortByState(void) const // Returns true if recorded shapes are sorted by OpenGL state
+		{
+		return sortByState;
+		}
+	void setSortByState(bool newSortByState); // Enables or disables sorting recorded shapes by OpenGL state
+	size_t getNumShapes(void) const // Returns the number of recorded shapes
+		{
+		return drawItems.size();
+		}
+	void addShape(const ShapeNode& shape,const GLRenderState& renderState); // Records the given shape at the render state's current transformation
+	void glRenderAction(GLRenderState& renderState); // Renders and removes all recorded shapes; the render state must be at its initial transformation
+	};
+
+}
+
+#endif
@@ -25,6 +25,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/RenderQueue.h>
+#include <SceneGraph/TriangleCollector.h>
+#include <SceneGraph/DrawListCollector.h>
 
 namespace SceneGraph {
 
@@ -71,6 +74,36 @@ Box ShapeNode::calcBoundingBox(void) const
 	}
 
 void ShapeNode::glRenderAction(GLRenderState& renderState) const
+	{
+	if(renderState.renderQueue!=0)
+		{
+		/* Record the shape for state-sorted rendering: */
+		renderState.renderQueue->addShape(*this,renderState);
+		}
+	else
+		glRenderShape(renderState);
+	}
+
+
+void ShapeNode::collectTriangles(TriangleCollector& collector) const
+	{
+	/* Collect the geometry node's triangles: */
+	if(geometry.getValue()!=0)
+		{
+		const GeometryNode* previousGeometry=collector.setGeometry(geometry.getValue().getPointer());
+		geometry.getValue()->collectTriangles(collector);
+		collector.setGeometry(previousGeometry);
+		}
+	}
+
+void ShapeNode::collectDrawItems(DrawListCollector& collector) const
+	{
+	/* Add the shape if it has geometry: */
+	if(geometry.getValue()!=0)
+		collector.addShape(*this,geometry.getValue()->calcBoundingBox());
+	}
+
+void ShapeNode::glRenderShape(GLRenderState& renderState) const
 	{
 	/* Set the attribute node's OpenGL state: */
 	if(appearance.getValue()!=0)
@@ -85,7 +118,10 @@ void ShapeNode::glRenderAction(GLRenderState& renderState) const
 	
 	/* Render the geometry node: */
 	if(geometry.getValue()!=0)
+		{
 		geometry.getValue()->glRenderAction(renderState);
+		++renderState.stateStatistics.numDrawCalls;
+		}
 	
 	/* Reset the attribute node's OpenGL state: */
 	if(appearance.getValue()!=0)
@@ -57,6 +57,11 @@ class ShapeNode:public GraphNode
 	/* Methods from GraphNode: */
 	virtual Box calcBoundingBox(void) const;
 	virtual void glRenderAction(GLRenderState& renderState) const;
+	virtual void collectTriangles(TriangleCollector& collector) const;
+	virtual void collectDrawItems(DrawListCollector& collector) const;
+	
+	/* New methods: */
+	void glRenderShape(GLRenderState& renderState) const; // Renders the shape's geometry with its appearance immediately, bypassing the render state's render queue
 	};
 
 typedef Misc::Autopointer<ShapeNode> ShapeNodePointer;
@@ -103,6 +103,9 @@ void TSurfFileNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void TSurfFileNode::update(void)
 	{
+	/* Bump up the geometry version number: */
+	GeometryNode::update();
+	
 	vertices.clear();
 	indices.clear();
 	
@@ -144,13 +147,7 @@ void TSurfFileNode::update(void)
 			/* Read a vertex: */
 			Vertex v;
 			v.normal=Vertex::Normal(0,0,1);
-			for(int i=0;i<3;++i)
-				v.position[i]=Vertex::Position::Scalar(tSurf.readNumber());
-			
-			/* Transform the vertex if asked: */
-			if(pointTransform.getValue()!=0)
-				v.position=pointTransform.getValue()->transformPoint(v.position);
-			
+			tSurf.readNumbers(3,v.position.getComponents());
 			vertices.push_back(v);
 			}
 		else if(keyword=="TRGL")
@@ -163,6 +160,19 @@ void TSurfFileNode::update(void)
 			break;
 		}
 	
+	if(pointTransform.getValue()!=0&&!vertices.empty())
+		{
+		/* Transform all vertex positions in one batch: */
+		std::vector<Point> positions;
+		positions.reserve(vertices.size());
+		for(std::vector<Vertex>::iterator vIt=vertices.begin();vIt!=vertices.end();++vIt)
+			positions.push_back(vIt->position);
+		pointTransform.getValue()->transformPoints(positions.size(),&positions[0],&positions[0]);
+		std::vector<Point>::iterator pIt=positions.begin();
+		for(std::vector<Vertex>::iterator vIt=vertices.begin();vIt!=vertices.end();++vIt,++pIt)
+			vIt->position=*pIt;
+		}
+	
 	/* Bump up the mesh version number: */
 	++version;
 	}
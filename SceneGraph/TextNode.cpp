@@ -91,6 +91,9 @@ void TextNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 
 void TextNode::update(void)
 	{
+	/* Bump up the geometry version number: */
+	GeometryNode::update();
+	
 	/* Create a default font style node if none was provided: */
 	if(fontStyle.getValue()==0)
 		{
@@ -227,7 +230,7 @@ void TextNode::glRenderAction(GLRenderState& renderState) const
 		/* Draw the strings as texture-mapped quads: */
 		for(size_t i=0;i<string.getNumValues();++i)
 			{
-			glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectIds[i]);
+			renderState.bindTexture2D(dataItem->textureObjectIds[i]);
 			glBegin(GL_QUADS);
 			glNormal3f(0.0f,0.0f,1.0f);
 			glTexCoord(stringTexBox[i].getCorner(0));
@@ -242,7 +245,7 @@ void TextNode::glRenderAction(GLRenderState& renderState) const
 			}
 		
 		/* Protect the texture objects: */
-		glBindTexture(GL_TEXTURE_2D,0);
+		renderState.bindTexture2D(0);
 		
 		/* Reset OpenGL state: */
 		glPopAttrib();
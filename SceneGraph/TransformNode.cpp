@@ -27,6 +27,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/EventTypes.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/TriangleCollector.h>
+#include <SceneGraph/DrawListCollector.h>
 
 namespace SceneGraph {
 
@@ -122,6 +124,9 @@ void TransformNode::update(void)
 	transform*=OGTransform::scale(uniformScale);
 	transform*=OGTransform::rotate(rotation.getValue());
 	transform*=OGTransform::translateToOriginFrom(center.getValue());
+	
+	/* Cache the children's bounding boxes for culling: */
+	updateChildBoxes();
 	}
 
 Box TransformNode::calcBoundingBox(void) const
@@ -133,9 +138,10 @@ Box TransformNode::calcBoundingBox(void) const
 		{
 		/* Calculate the group's bounding box as the union of the transformed children's boxes: */
 		Box result=Box::empty;
-		for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
+		bool useCachedBoxes=childBoxes.size()==children.getNumValues();
+		for(size_t i=0;i<children.getNumValues();++i)
 			{
-			Box childBox=(*chIt)->calcBoundingBox();
+			Box childBox=useCachedBoxes?childBoxes[i]:children.getValue(i)->calcBoundingBox();
 			childBox.transform(transform);
 			result.addBox(childBox);
 			}
@@ -148,12 +154,38 @@ void TransformNode::glRenderAction(GLRenderState& renderState) const
 	/* Push the transformation onto the matrix stack: */
 	OGTransform previousTransform=renderState.pushTransform(transform);
 	
-	/* Call the render actions of all children in order: */
-	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-		(*chIt)->glRenderAction(renderState);
+	/* Call the render actions of all visible children in order: */
+	renderChildren(renderState);
 		
 	/* Pop the transformation off the matrix stack: */
 	renderState.popTransform(previousTransform);
 	}
 
+
+void TransformNode::collectTriangles(TriangleCollector& collector) const
+	{
+	/* Push the transformation onto the collector's transformation stack: */
+	OGTransform previousTransform=collector.pushTransform(transform);
+	
+	/* Collect the triangles of all children in order: */
+	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
+		(*chIt)->collectTriangles(collector);
+	
+	/* Pop the transformation off the collector's transformation stack: */
+	collector.popTransform(previousTransform);
+	}
+
+void TransformNode::collectDrawItems(DrawListCollector& collector) const
+	{
+	/* Push the transformation onto the collector's transformation stack: */
+	OGTransform previousTransform=collector.pushTransform(transform);
+	
+	/* Collect the draw items of all children in order: */
+	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
+		collector.collectChild(**chIt);
+	
+	/* Pop the transformation off the collector's transformation stack: */
+	collector.popTransform(previousTransform);
+	}
+
 }
@@ -64,6 +64,8 @@ class TransformNode:public GroupNode
 	/* Methods from GraphNode: */
 	virtual Box calcBoundingBox(void) const;
 	virtual void glRenderAction(GLRenderState& renderState) const;
+	virtual void collectTriangles(TriangleCollector& collector) const;
+	virtual void collectDrawItems(DrawListCollector& collector) const;
 	
 	/* New methods: */
 	const OGTransform& getTransform(void) const // Returns the current derived transformation
@@ -0,0 +1,960 @@
+/***********************************************************************
+TriangleBVH - Class for bounding volume hierarchies over the triangles
+of a scene graph, to answer ray intersection and closest point queries.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/TriangleBVH.h>
+
+#include <algorithm>
+#include <Math/Math.h>
+#include <Threads/ParallelFor.h>
+
+namespace SceneGraph {
+
+namespace {
+
+/****************
+Helper constants:
+****************/
+
+const int numBins=16; // Number of bins along the split axis when evaluating the surface area heuristic
+const unsigned int maxLeafSize=8; // Maximum number of triangles in a leaf node
+const unsigned int maxSahDepth=48; // Nodes below this depth are split at the median to bound the hierarchy's depth
+const int maxStackSize=128; // Size of traversal stacks; the hierarchy's depth is bounded by maxSahDepth+32
+const Scalar traversalCost=Scalar(1); // Cost of traversing an interior node relative to intersecting a triangle
+
+/****************
+Helper functions:
+****************/
+
+inline Scalar calcHalfArea(const Box& box) // Returns half the surface area of a box, or zero for empty boxes
+	{
+	Scalar sx=box.max[0]-box.min[0];
+	Scalar sy=box.max[1]-box.min[1];
+	Scalar sz=box.max[2]-box.min[2];
+	if(sx<Scalar(0)||sy<Scalar(0)||sz<Scalar(0))
+		return Scalar(0);
+	return sx*sy+sy*sz+sz*sx;
+	}
+
+inline Scalar calcInverse(Scalar d) // Returns the inverse of a ray direction component, avoiding infinities
+	{
+	const Scalar tiny=Scalar(1.0e-30);
+	if(d>=Scalar(0)&&d<tiny)
+		d=tiny;
+	else if(d<Scalar(0)&&d>-tiny)
+		d=-tiny;
+	return Scalar(1)/d;
+	}
+
+inline bool intersectBox(const Box& box,const Scalar origin[3],const Scalar invDirection[3],Scalar maxLambda) // Returns true if a ray enters the box before the given ray parameter
+	{
+	Scalar lMin=Scalar(0);
+	Scalar lMax=maxLambda;
+	for(int i=0;i<3;++i)
+		{
+		Scalar l0=(box.min[i]-origin[i])*invDirection[i];
+		Scalar l1=(box.max[i]-origin[i])*invDirection[i];
+		if(l0>l1)
+			std::swap(l0,l1);
+		if(lMin<l0)
+			lMin=l0;
+		if(lMax>l1)
+			lMax=l1;
+		}
+	return lMin<=lMax;
+	}
+
+inline Scalar sqrDist(const Point& p,const Box& box) // Returns the squared distance from a point to a box
+	{
+	Scalar result=Scalar(0);
+	for(int i=0;i<3;++i)
+		{
+		if(p[i]<box.min[i])
+			result+=Math::sqr(box.min[i]-p[i]);
+		else if(p[i]>box.max[i])
+			result+=Math::sqr(p[i]-box.max[i]);
+		}
+	return result;
+	}
+
+inline bool intersectTriangle(const TriangleBVH::Triangle& t,const Point& origin,const Vector& direction,Scalar& lambda) // Intersects a ray with a triangle from either side; updates lambda if the intersection is closer
+	{
+	/* Moeller-Trumbore ray/triangle intersection: */
+	Vector e1=t.vertices[1]-t.vertices[0];
+	Vector e2=t.vertices[2]-t.vertices[0];
+	Vector p=Geometry::cross(direction,e2);
+	Scalar det=e1*p;
+	if(det==Scalar(0))
+		return false;
+	Scalar invDet=Scalar(1)/det;
+	Vector s=origin-t.vertices[0];
+	Scalar u=(s*p)*invDet;
+	if(u<Scalar(0)||u>Scalar(1))
+		return false;
+	Vector q=Geometry::cross(s,e1);
+	Scalar v=(direction*q)*invDet;
+	if(v<Scalar(0)||u+v>Scalar(1))
+		return false;
+	Scalar l=(e2*q)*invDet;
+	if(l<Scalar(0)||l>=lambda)
+		return false;
+	lambda=l;
+	return true;
+	}
+
+Point calcClosestPoint(const TriangleBVH::Triangle& t,const Point& p) // Returns the point on a triangle closest to the given point
+	{
+	/* Classify the point against the triangle's Voronoi regions: */
+	const Point& a=t.vertices[0];
+	const Point& b=t.vertices[1];
+	const Point& c=t.vertices[2];
+	Vector ab=b-a;
+	Vector ac=c-a;
+	Vector ap=p-a;
+	Scalar d1=ab*ap;
+	Scalar d2=ac*ap;
+	if(d1<=Scalar(0)&&d2<=Scalar(0))
+		return a;
+	Vector bp=p-b;
+	Scalar d3=ab*bp;
+	Scalar d4=ac*bp;
+	if(d3>=Scalar(0)&&d4<=d3)
+		return b;
+	Scalar vc=d1*d4-d3*d2;
+	if(vc<=Scalar(0)&&d1>=Scalar(0)&&d3<=Scalar(0))
+		return a+ab*(d1/(d1-d3));
+	Vector cp=p-c;
+	Scalar d5=ab*cp;
+	Scalar d6=ac*cp;
+	if(d6>=Scalar(0)&&d5<=d6)
+		return c;
+	Scalar vb=d5*d2-d1*d6;
+	if(vb<=Scalar(0)&&d2>=Scalar(0)&&d6<=Scalar(0))
+		return a+ac*(d2/(d2-d6));
+	Scalar va=d3*d6-d5*d4;
+	if(va<=Scalar(0)&&d4-d3>=Scalar(0)&&d5-d6>=Scalar(0))
+		return b+(c-b)*((d4-d3)/((d4-d3)+(d5-d6)));
+	
+	/* The point projects into the triangle's interior: */
+	Scalar denom=Scalar(1)/(va+vb+vc);
+	return a+ab*(vb*denom)+ac*(vc*denom);
+	}
+
+inline Vector calcNormal(const TriangleBVH::Triangle& t) // Returns the unit-length normal vector of a triangle's front face
+	{
+	Vector normal=Geometry::cross(t.vertices[1]-t.vertices[0],t.vertices[2]-t.vertices[0]);
+	Scalar mag=normal.mag();
+	if(mag>Scalar(0))
+		normal/=mag;
+	return normal;
+	}
+
+}
+
+/*****************************************
+Declaration of class TriangleBVH::Builder:
+*****************************************/
+
+class TriangleBVH::Builder
+	{
+	/* Embedded classes: */
+	public:
+	struct Job // Structure describing a node whose triangles still need to be distributed
+		{
+		/* Elements: */
+		public:
+		Index nodeIndex; // Index of the node; its box is already set
+		Index begin,end; // Range of the node's triangles in the order array
+		unsigned int depth; // Depth of the node in the hierarchy
+		};
+	
+	struct BinPredicate // Functor to partition triangles by bin index
+		{
+		/* Elements: */
+		public:
+		const Point* centroids; // Array of triangle centroids
+		int axis; // Split axis
+		Scalar binMin,binScale; // Mapping from centroid coordinates to bin indices
+		int splitBin; // Index of first bin on the right side of the split
+		
+		/* Methods: */
+		bool operator()(Index triangleIndex) const
+			{
+			int bin=int((centroids[triangleIndex][axis]-binMin)*binScale);
+			if(bin>numBins-1)
+				bin=numBins-1;
+			return bin<splitBin;
+			}
+		};
+	
+	struct CentroidLess // Functor to compare triangles by centroid coordinate along an axis
+		{
+		/* Elements: */
+		public:
+		const Point* centroids; // Array of triangle centroids
+		int axis; // Comparison axis
+		
+		/* Methods: */
+		bool operator()(Index t1,Index t2) const
+			{
+			return centroids[t1][axis]<centroids[t2][axis];
+			}
+		};
+	
+	struct TrianglePreparer // Functor to calculate triangle boxes and centroids in parallel
+		{
+		/* Elements: */
+		public:
+		Builder* builder;
+		
+		/* Methods: */
+		void operator()(size_t begin,size_t end) const
+			{
+			for(size_t i=begin;i<end;++i)
+				{
+				const Triangle& t=builder->triangles[i];
+				Box box(t.vertices[0],t.vertices[0]);
+				box.addPoint(t.vertices[1]);
+				box.addPoint(t.vertices[2]);
+				builder->boxes[i]=box;
+				for(int j=0;j<3;++j)
+					builder->centroids[i][j]=Math::mid(box.min[j],box.max[j]);
+				}
+			}
+		};
+	
+	struct SubtreeBuilder // Functor to build independent subtrees in parallel
+		{
+		/* Elements: */
+		public:
+		Builder* builder;
+		const std::vector<Job>* jobs; // List of subtree root jobs
+		std::vector<std::vector<Node> >* subtrees; // Node lists of the built subtrees
+		
+		/* Methods: */
+		void operator()(size_t begin,size_t end) const
+			{
+			for(size_t i=begin;i<end;++i)
+				{
+				/* Build the subtree into its own node list, starting with a copy of its root: */
+				std::vector<Node>& subtree=(*subtrees)[i];
+				subtree.push_back(builder->nodes[(*jobs)[i].nodeIndex]);
+				Job rootJob=(*jobs)[i];
+				rootJob.nodeIndex=0;
+				builder->buildSubtree(subtree,rootJob);
+				}
+			}
+		};
+	
+	/* Elements: */
+	const std::vector<Triangle>& triangles; // List of triangles in collection order
+	std::vector<Box> boxes; // Bounding box of each triangle
+	std::vector<Point> centroids; // Centroid of each triangle's bounding box
+	std::vector<Index> order; // Permutation of triangle indices into leaf order
+	std::vector<Node>& nodes; // The hierarchy's node list
+	
+	/* Constructors and destructors: */
+	Builder(const std::vector<Triangle>& sTriangles,std::vector<Node>& sNodes)
+		:triangles(sTriangles),
+		 boxes(triangles.size()),centroids(triangles.size()),order(triangles.size()),
+		 nodes(sNodes)
+		{
+		}
+	
+	/* Methods: */
+	bool split(const Job& job,const Box& nodeBox,Index& mid,int& axis,Box& leftBox,Box& rightBox); // Splits a node's triangles; returns false if the node should become a leaf
+	void buildSubtree(std::vector<Node>& subtree,const Job& rootJob); // Builds the subtree below the given root job into the given node list
+	void build(unsigned int maxNumThreads); // Builds the hierarchy
+	};
+
+/*************************************
+Methods of class TriangleBVH::Builder:
+*************************************/
+
+bool TriangleBVH::Builder::split(const TriangleBVH::Builder::Job& job,const Box& nodeBox,TriangleBVH::Index& mid,int& axis,Box& leftBox,Box& rightBox)
+	{
+	Index numTriangles=job.end-job.begin;
+	if(numTriangles<=2)
+		return false;
+	
+	/* Calculate the bounding box of the node's triangle centroids: */
+	Box centroidBox=Box::empty;
+	for(Index i=job.begin;i<job.end;++i)
+		centroidBox.addPoint(centroids[order[i]]);
+	
+	/* Split along the axis of largest centroid extent: */
+	axis=0;
+	for(int i=1;i<3;++i)
+		if(centroidBox.getSize(axis)<centroidBox.getSize(i))
+			axis=i;
+	Scalar extent=centroidBox.getSize(axis);
+	
+	bool sahSplit=extent>Scalar(0)&&job.depth<maxSahDepth;
+	if(sahSplit)
+		{
+		/* Distribute the triangles into bins along the split axis: */
+		Index binCounts[numBins];
+		Box binBoxes[numBins];
+		for(int bin=0;bin<numBins;++bin)
+			{
+			binCounts[bin]=0;
+			binBoxes[bin]=Box::empty;
+			}
+		BinPredicate bp;
+		bp.centroids=&centroids[0];
+		bp.axis=axis;
+		bp.binMin=centroidBox.min[axis];
+		bp.binScale=Scalar(numBins)*Scalar(0.999)/extent;
+		for(Index i=job.begin;i<job.end;++i)
+			{
+			int bin=int((centroids[order[i]][axis]-bp.binMin)*bp.binScale);
+			if(bin>numBins-1)
+				bin=numBins-1;
+			++binCounts[bin];
+			binBoxes[bin].addBox(boxes[order[i]]);
+			}
+		
+		/* Sweep the bins from the right to accumulate the right sides' areas and counts: */
+		Scalar rightAreas[numBins];
+		Index rightCounts[numBins];
+		Box accumBox=Box::empty;
+		Index accumCount=0;
+		for(int bin=numBins-1;bin>0;--bin)
+			{
+			accumBox.addBox(binBoxes[bin]);
+			accumCount+=binCounts[bin];
+			rightAreas[bin]=calcHalfArea(accumBox);
+			rightCounts[bin]=accumCount;
+			}
+		
+		/* Sweep the bins from the left to find the split of lowest cost: */
+		int bestSplit=0;
+		Scalar bestCost=Scalar(0);
+		accumBox=Box::empty;
+		accumCount=0;
+		for(int bin=1;bin<numBins;++bin)
+			{
+			accumBox.addBox(binBoxes[bin-1]);
+			accumCount+=binCounts[bin-1];
+			if(accumCount==0||rightCounts[bin]==0)
+				continue;
+			Scalar cost=calcHalfArea(accumBox)*Scalar(accumCount)+rightAreas[bin]*Scalar(rightCounts[bin]);
+			if(bestSplit==0||bestCost>cost)
+				{
+				bestSplit=bin;
+				bestCost=cost;
+				}
+			}
+		
+		/* Compare the best split against creating a leaf: */
+		Scalar nodeArea=calcHalfArea(nodeBox);
+		if(bestSplit==0)
+			sahSplit=false;
+		else if(numTriangles<=maxLeafSize&&traversalCost*nodeArea+bestCost>=Scalar(numTriangles)*nodeArea)
+			return false;
+		
+		if(sahSplit)
+			{
+			/* Partition the triangles by bin: */
+			bp.splitBin=bestSplit;
+			mid=Index(std::partition(order.begin()+job.begin,order.begin()+job.end,bp)-order.begin());
+			leftBox=Box::empty;
+			for(int bin=0;bin<bestSplit;++bin)
+				leftBox.addBox(binBoxes[bin]);
+			rightBox=Box::empty;
+			for(int bin=bestSplit;bin<numBins;++bin)
+				rightBox.addBox(binBoxes[bin]);
+			return true;
+			}
+		}
+	
+	/* Nodes whose centroids coincide can only be split if they are too large for a leaf: */
+	if(extent<=Scalar(0)&&numTriangles<=maxLeafSize)
+		return false;
+	
+	/* Split the triangles at the median along the split axis: */
+	mid=job.begin+numTriangles/2;
+	CentroidLess cl;
+	cl.centroids=&centroids[0];
+	cl.axis=axis;
+	std::nth_element(order.begin()+job.begin,order.begin()+mid,order.begin()+job.end,cl);
+	leftBox=Box::empty;
+	for(Index i=job.begin;i<mid;++i)
+		leftBox.addBox(boxes[order[i]]);
+	rightBox=Box::empty;
+	for(Index i=mid;i<job.end;++i)
+		rightBox.addBox(boxes[order[i]]);
+	return true;
+	}
+
+void TriangleBVH::Builder::buildSubtree(std::vector<TriangleBVH::Node>& subtree,const TriangleBVH::Builder::Job& rootJob)
+	{
+	std::vector<Job> jobs;
+	jobs.push_back(rootJob);
+	while(!jobs.empty())
+		{
+		Job job=jobs.back();
+		jobs.pop_back();
+		
+		Index mid;
+		int axis;
+		Box leftBox,rightBox;
+		if(split(job,subtree[job.nodeIndex].box,mid,axis,leftBox,rightBox))
+			{
+			/* Create the node's children: */
+			Index left=Index(subtree.size());
+			subtree.resize(subtree.size()+2);
+			Node& node=subtree[job.nodeIndex];
+			node.first=left;
+			node.numTriangles=0;
+			node.splitAxis=Misc::UInt16(axis);
+			subtree[left].box=leftBox;
+			subtree[left+1].box=rightBox;
+			
+			/* Distribute the children's triangles: */
+			Job leftJob;
+			leftJob.nodeIndex=left;
+			leftJob.begin=job.begin;
+			leftJob.end=mid;
+			leftJob.depth=job.depth+1;
+			jobs.push_back(leftJob);
+			Job rightJob;
+			rightJob.nodeIndex=left+1;
+			rightJob.begin=mid;
+			rightJob.end=job.end;
+			rightJob.depth=job.depth+1;
+			jobs.push_back(rightJob);
+			}
+		else
+			{
+			/* Make the node a leaf: */
+			Node& node=subtree[job.nodeIndex];
+			node.first=job.begin;
+			node.numTriangles=Misc::UInt16(job.end-job.begin);
+			node.splitAxis=0;
+			}
+		}
+	}
+
+void TriangleBVH::Builder::build(unsigned int maxNumThreads)
+	{
+	nodes.clear();
+	size_t numTriangles=triangles.size();
+	if(numTriangles==0)
+		return;
+	
+	/* Calculate all triangles' boxes and centroids: */
+	TrianglePreparer tp;
+	tp.builder=this;
+	Threads::parallelFor(0,numTriangles,tp,4096,maxNumThreads);
+	for(size_t i=0;i<numTriangles;++i)
+		order[i]=Index(i);
+	
+	/* Create the root node: */
+	Node root;
+	root.box=Box::empty;
+	for(size_t i=0;i<numTriangles;++i)
+		root.box.addBox(boxes[i]);
+	nodes.push_back(root);
+	
+	/* Split the top levels of the hierarchy until there are enough subtrees to keep all threads busy: */
+	if(maxNumThreads==0)
+		maxNumThreads=Threads::getNumParallelForThreads();
+	size_t subtreeSize=numTriangles/(size_t(maxNumThreads)*4);
+	if(subtreeSize<4096)
+		subtreeSize=4096;
+	std::vector<Job> jobs;
+	std::vector<Job> subtreeJobs;
+	Job rootJob;
+	rootJob.nodeIndex=0;
+	rootJob.begin=0;
+	rootJob.end=Index(numTriangles);
+	rootJob.depth=0;
+	jobs.push_back(rootJob);
+	while(!jobs.empty())
+		{
+		Job job=jobs.back();
+		jobs.pop_back();
+		
+		Index mid;
+		int axis;
+		Box leftBox,rightBox;
+		if(maxNumThreads>1&&size_t(job.end-job.begin)>subtreeSize&&split(job,nodes[job.nodeIndex].box,mid,axis,leftBox,rightBox))
+			{
+			/* Create the node's children: */
+			Index left=Index(nodes.size());
+			nodes.resize(nodes.size()+2);
+			Node& node=nodes[job.nodeIndex];
+			node.first=left;
+			node.numTriangles=0;
+			node.splitAxis=Misc::UInt16(axis);
+			nodes[left].box=leftBox;
+			nodes[left+1].box=rightBox;
+			
+			Job leftJob;
+			leftJob.nodeIndex=left;
+			leftJob.begin=job.begin;
+			leftJob.end=mid;
+			leftJob.depth=job.depth+1;
+			jobs.push_back(leftJob);
+			Job rightJob;
+			rightJob.nodeIndex=left+1;
+			rightJob.begin=mid;
+			rightJob.end=job.end;
+			rightJob.depth=job.depth+1;
+			jobs.push_back(rightJob);
+			}
+		else
+			subtreeJobs.push_back(job);
+		}
+	
+	/* Build the subtrees in parallel; they operate on disjoint ranges of the order array: */
+	std::vector<std::vector<Node> > subtrees(subtreeJobs.size());
+	SubtreeBuilder sb;
+	sb.builder=this;
+	sb.jobs=&subtreeJobs;
+	sb.subtrees=&subtrees;
+	Threads::parallelFor(0,subtreeJobs.size(),sb,1,maxNumThreads);
+	
+	/* Splice the subtrees into the node list: */
+	for(size_t i=0;i<subtreeJobs.size();++i)
+		{
+		/* Subtree nodes other than the root are appended to the node list: */
+		const std::vector<Node>& subtree=subtrees[i];
+		Index offset=Index(nodes.size())-1;
+		for(size_t j=0;j<subtree.size();++j)
+			{
+			Node node=subtree[j];
+			if(node.numTriangles==0)
+				node.first+=offset;
+			if(j==0)
+				nodes[subtreeJobs[i].nodeIndex]=node;
+			else
+				nodes.push_back(node);
+			}
+		}
+	}
+
+/***********************************************
+Declaration of struct TriangleBVH::LeafRefitter:
+***********************************************/
+
+struct TriangleBVH::LeafRefitter
+	{
+	/* Elements: */
+	public:
+	TriangleBVH* bvh;
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
+		{
+		for(size_t i=begin;i<end;++i)
+			{
+			Node& node=bvh->nodes[i];
+			if(node.numTriangles!=0)
+				{
+				/* Recalculate the leaf's box from its triangles: */
+				node.box=Box::empty;
+				std::vector<Triangle>::const_iterator tEnd=bvh->triangles.begin()+(node.first+node.numTriangles);
+				for(std::vector<Triangle>::const_iterator tIt=bvh->triangles.begin()+node.first;tIt!=tEnd;++tIt)
+					for(int j=0;j<3;++j)
+						node.box.addPoint(tIt->vertices[j]);
+				}
+			}
+		}
+	};
+
+/****************************************************
+Declaration of struct TriangleBVH::PacketIntersector:
+****************************************************/
+
+struct TriangleBVH::PacketIntersector
+	{
+	/* Elements: */
+	public:
+	const TriangleBVH* bvh;
+	size_t numRays;
+	const Ray* rays;
+	Scalar maxLambda;
+	RayHit* hits;
+	
+	/* Methods: */
+	void operator()(size_t begin,size_t end) const
+		{
+		for(size_t packet=begin;packet<end;++packet)
+			{
+			size_t rayBegin=packet*packetSize;
+			int numPacketRays=numRays-rayBegin<size_t(packetSize)?int(numRays-rayBegin):int(packetSize);
+			bvh->intersectPacket(numPacketRays,rays+rayBegin,maxLambda,hits+rayBegin);
+			}
+		}
+	};
+
+/****************************
+Methods of class TriangleBVH:
+****************************/
+
+void TriangleBVH::build(const std::vector<TriangleBVH::Triangle>& collectedTriangles)
+	{
+	/* Build the hierarchy: */
+	Builder builder(collectedTriangles,nodes);
+	builder.build(maxNumThreads);
+	
+	/* Store the triangles in leaf order: */
+	triangles.clear();
+	triangles.reserve(collectedTriangles.size());
+	for(std::vector<Index>::const_iterator oIt=builder.order.begin();oIt!=builder.order.end();++oIt)
+		triangles.push_back(collectedTriangles[*oIt]);
+	collectionOrder.swap(builder.order);
+	}
+
+void TriangleBVH::intersectPacket(int numRays,const Ray* rays,Scalar maxLambda,TriangleBVH::RayHit* hits) const
+	{
+	/* Store the packet's rays in component arrays; unused lanes never hit anything: */
+	Scalar origins[3][packetSize];
+	Scalar directions[3][packetSize];
+	Scalar invDirections[3][packetSize];
+	Scalar lambdas[packetSize];
+	Index hitTriangles[packetSize];
+	Vector meanDirection=Vector::zero;
+	for(int ray=0;ray<packetSize;++ray)
+		{
+		const Ray& r=rays[ray<numRays?ray:0];
+		for(int i=0;i<3;++i)
+			{
+			origins[i][ray]=r.getOrigin()[i];
+			directions[i][ray]=r.getDirection()[i];
+			invDirections[i][ray]=calcInverse(r.getDirection()[i]);
+			}
+		lambdas[ray]=ray<numRays?maxLambda:Scalar(-1);
+		hitTriangles[ray]=invalidIndex;
+		if(ray<numRays)
+			meanDirection+=r.getDirection();
+		}
+	
+	/* Traverse the hierarchy: */
+	Index stack[maxStackSize];
+	int stackSize=0;
+	stack[stackSize++]=0;
+	while(stackSize>0)
+		{
+		const Node& node=nodes[stack[--stackSize]];
+		
+		/* Check if any ray in the packet enters the node's box before its current closest hit: */
+		bool anyHit=false;
+		for(int ray=0;ray<packetSize;++ray)
+			{
+			Scalar lMin=Scalar(0);
+			Scalar lMax=lambdas[ray];
+			for(int i=0;i<3;++i)
+				{
+				Scalar l0=(node.box.min[i]-origins[i][ray])*invDirections[i][ray];
+				Scalar l1=(node.box.max[i]-origins[i][ray])*invDirections[i][ray];
+				lMin=std::max(lMin,std::min(l0,l1));
+				lMax=std::min(lMax,std::max(l0,l1));
+				}
+			anyHit=anyHit||lMin<=lMax;
+			}
+		if(!anyHit)
+			continue;
+		
+		if(node.numTriangles!=0)
+			{
+			/* Intersect the packet with all of the leaf's triangles: */
+			for(Index ti=node.first;ti<node.first+node.numTriangles;++ti)
+				{
+				const Triangle& t=triangles[ti];
+				Vector e1=t.vertices[1]-t.vertices[0];
+				Vector e2=t.vertices[2]-t.vertices[0];
+				for(int ray=0;ray<packetSize;++ray)
+					{
+					/* Moeller-Trumbore ray/triangle intersection without branches: */
+					Scalar p[3];
+					p[0]=directions[1][ray]*e2[2]-directions[2][ray]*e2[1];
+					p[1]=directions[2][ray]*e2[0]-directions[0][ray]*e2[2];
+					p[2]=directions[0][ray]*e2[1]-directions[1][ray]*e2[0];
+					Scalar det=e1[0]*p[0]+e1[1]*p[1]+e1[2]*p[2];
+					Scalar invDet=det!=Scalar(0)?Scalar(1)/det:Scalar(0);
+					Scalar s[3];
+					for(int i=0;i<3;++i)
+						s[i]=origins[i][ray]-t.vertices[0][i];
+					Scalar u=(s[0]*p[0]+s[1]*p[1]+s[2]*p[2])*invDet;
+					Scalar q[3];
+					q[0]=s[1]*e1[2]-s[2]*e1[1];
+					q[1]=s[2]*e1[0]-s[0]*e1[2];
+					q[2]=s[0]*e1[1]-s[1]*e1[0];
+					Scalar v=(directions[0][ray]*q[0]+directions[1][ray]*q[1]+directions[2][ray]*q[2])*invDet;
+					Scalar l=(e2[0]*q[0]+e2[1]*q[1]+e2[2]*q[2])*invDet;
+					bool hit=det!=Scalar(0)&&u>=Scalar(0)&&v>=Scalar(0)&&u+v<=Scalar(1)&&l>=Scalar(0)&&l<lambdas[ray];
+					lambdas[ray]=hit?l:lambdas[ray];
+					hitTriangles[ray]=hit?ti:hitTriangles[ray];
+					}
+				}
+			}
+		else
+			{
+			/* Traverse the child closer to the packet's mean origin first: */
+			Index nearChild=node.first;
+			Index farChild=node.first+1;
+			if(meanDirection[node.splitAxis]<Scalar(0))
+				std::swap(nearChild,farChild);
+			stack[stackSize++]=farChild;
+			stack[stackSize++]=nearChild;
+			}
+		}
+	
+	/* Report the packet's hits: */
+	for(int ray=0;ray<numRays;++ray)
+		{
+		hits[ray].lambda=lambdas[ray];
+		hits[ray].triangleIndex=hitTriangles[ray];
+		finishHit(hits[ray]);
+		}
+	}
+
+void TriangleBVH::finishHit(TriangleBVH::RayHit& hit) const
+	{
+	if(hit.triangleIndex!=invalidIndex)
+		{
+		const Triangle& t=triangles[hit.triangleIndex];
+		hit.geometry=t.geometry;
+		hit.normal=calcNormal(t);
+		}
+	else
+		{
+		hit.geometry=0;
+		hit.normal=Vector::zero;
+		}
+	}
+
+TriangleBVH::TriangleBVH(GraphNodePointer sRoot,unsigned int sMaxNumThreads)
+	:root(sRoot),
+	 maxNumThreads(sMaxNumThreads)
+	{
+	/* Build the initial hierarchy: */
+	rebuild();
+	}
+
+void TriangleBVH::rebuild(void)
+	{
+	/* Collect the scene graph's triangles: */
+	TriangleCollector collector;
+	if(root!=0)
+		root->collectTriangles(collector);
+	
+	/* Build a new hierarchy: */
+	build(collector.getTriangles());
+	geometryVersions=collector.getGeometryVersions();
+	}
+
+bool TriangleBVH::refit(void)
+	{
+	/* Collect the scene graph's current triangles: */
+	TriangleCollector collector;
+	if(root!=0)
+		root->collectTriangles(collector);
+	const std::vector<Triangle>& collectedTriangles=collector.getTriangles();
+	geometryVersions=collector.getGeometryVersions();
+	
+	if(collectedTriangles.size()!=triangles.size())
+		{
+		/* The scene graph's topology changed; build a new hierarchy: */
+		build(collectedTriangles);
+		return false;
+		}
+	
+	/* Replace the triangles in leaf order: */
+	for(size_t i=0;i<triangles.size();++i)
+		triangles[i]=collectedTriangles[collectionOrder[i]];
+	
+	/* Refit all leaf boxes in parallel: */
+	LeafRefitter lr;
+	lr.bvh=this;
+	Threads::parallelFor(0,nodes.size(),lr,4096,maxNumThreads);
+	
+	/* Refit all interior boxes bottom-up; children always have higher indices than their parents: */
+	for(size_t i=nodes.size();i>0;--i)
+		{
+		Node& node=nodes[i-1];
+		if(node.numTriangles==0)
+			{
+			node.box=nodes[node.first].box;
+			node.box.addBox(nodes[node.first+1].box);
+			}
+		}
+	
+	return true;
+	}
+
+bool TriangleBVH::isOutdated(void) const
+	{
+	/* Compare the collected geometry nodes' current versions against the recorded ones: */
+	for(std::vector<GeometryVersion>::const_iterator gvIt=geometryVersions.begin();gvIt!=geometryVersions.end();++gvIt)
+		if(gvIt->geometry->getGeometryVersion()!=gvIt->version)
+			return true;
+	return false;
+	}
+
+bool TriangleBVH::update(void)
+	{
+	if(!isOutdated())
+		return false;
+	
+	/* Refit the hierarchy to the updated geometry: */
+	refit();
+	return true;
+	}
+
+Box TriangleBVH::getBoundingBox(void) const
+	{
+	if(nodes.empty())
+		return Box::empty;
+	else
+		return nodes[0].box;
+	}
+
+bool TriangleBVH::intersectRay(const Ray& ray,Scalar maxLambda,TriangleBVH::RayHit& hit) const
+	{
+	hit.lambda=maxLambda;
+	hit.triangleIndex=invalidIndex;
+	if(!nodes.empty())
+		{
+		/* Prepare the ray for box intersection tests: */
+		const Point& origin=ray.getOrigin();
+		const Vector& direction=ray.getDirection();
+		Scalar o[3],invDirection[3];
+		for(int i=0;i<3;++i)
+			{
+			o[i]=origin[i];
+			invDirection[i]=calcInverse(direction[i]);
+			}
+		
+		/* Traverse the hierarchy front to back: */
+		Index stack[maxStackSize];
+		int stackSize=0;
+		stack[stackSize++]=0;
+		while(stackSize>0)
+			{
+			const Node& node=nodes[stack[--stackSize]];
+			if(!intersectBox(node.box,o,invDirection,hit.lambda))
+				continue;
+			
+			if(node.numTriangles!=0)
+				{
+				/* Intersect the ray with all of the leaf's triangles: */
+				for(Index ti=node.first;ti<node.first+node.numTriangles;++ti)
+					if(intersectTriangle(triangles[ti],origin,direction,hit.lambda))
+						hit.triangleIndex=ti;
+				}
+			else
+				{
+				/* Traverse the child closer to the ray's origin first: */
+				Index nearChild=node.first;
+				Index farChild=node.first+1;
+				if(direction[node.splitAxis]<Scalar(0))
+					std::swap(nearChild,farChild);
+				stack[stackSize++]=farChild;
+				stack[stackSize++]=nearChild;
+				}
+			}
+		}
+	
+	finishHit(hit);
+	return hit.isValid();
+	}
+
+void TriangleBVH::intersectRays(size_t numRays,const Ray* rays,Scalar maxLambda,TriangleBVH::RayHit* hits) const
+	{
+	if(nodes.empty())
+		{
+		for(size_t i=0;i<numRays;++i)
+			{
+			hits[i].lambda=maxLambda;
+			hits[i].triangleIndex=invalidIndex;
+			finishHit(hits[i]);
+			}
+		return;
+		}
+	
+	/* Intersect packets of adjacent rays in parallel: */
+	PacketIntersector pi;
+	pi.bvh=this;
+	pi.numRays=numRays;
+	pi.rays=rays;
+	pi.maxLambda=maxLambda;
+	pi.hits=hits;
+	Threads::parallelFor(0,(numRays+packetSize-1)/packetSize,pi,64,maxNumThreads);
+	}
+
+bool TriangleBVH::findClosestPoint(const Point& queryPoint,Scalar maxDist,TriangleBVH::ClosestPoint& result) const
+	{
+	result.sqrDist=Math::sqr(maxDist);
+	result.triangleIndex=invalidIndex;
+	result.geometry=0;
+	if(!nodes.empty())
+		{
+		/* Traverse the hierarchy, visiting closer children first: */
+		Index stack[maxStackSize];
+		int stackSize=0;
+		stack[stackSize++]=0;
+		while(stackSize>0)
+			{
+			const Node& node=nodes[stack[--stackSize]];
+			if(sqrDist(queryPoint,node.box)>=result.sqrDist)
+				continue;
+			
+			if(node.numTriangles!=0)
+				{
+				/* Find the closest point on each of the leaf's triangles: */
+				for(Index ti=node.first;ti<node.first+node.numTriangles;++ti)
+					{
+					Point cp=calcClosestPoint(triangles[ti],queryPoint);
+					Scalar cpDist2=Geometry::sqrDist(cp,queryPoint);
+					if(result.sqrDist>cpDist2)
+						{
+						result.point=cp;
+						result.sqrDist=cpDist2;
+						result.triangleIndex=ti;
+						}
+					}
+				}
+			else
+				{
+				Index nearChild=node.first;
+				Index farChild=node.first+1;
+				if(sqrDist(queryPoint,nodes[nearChild].box)>sqrDist(queryPoint,nodes[farChild].box))
+					std::swap(nearChild,farChild);
+				stack[stackSize++]=farChild;
+				stack[stackSize++]=nearChild;
+				}
+			}
+		}
+	
+	if(result.triangleIndex!=invalidIndex)
+		{
+		const Triangle& t=triangles[result.triangleIndex];
+		result.geometry=t.geometry;
+		result.normal=calcNormal(t);
+		}
+	return result.isValid();
+	}
+
+}
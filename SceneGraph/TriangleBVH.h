@@ -0,0 +1,151 @@
+/***********************************************************************
+TriangleBVH - Class for bounding volume hierarchies over the triangles
+of a scene graph, to answer ray intersection and closest point queries.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_TRIANGLEBVH_INCLUDED
+#define SCENEGRAPH_TRIANGLEBVH_INCLUDED
+
+#include <stddef.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Geometry/Box.h>
+#include <Geometry/Ray.h>
+#include <SceneGraph/Geometry.h>
+#include <SceneGraph/GraphNode.h>
+#include <SceneGraph/TriangleCollector.h>
+
+/* Forward declarations: */
+namespace SceneGraph {
+class GeometryNode;
+}
+
+namespace SceneGraph {
+
+class TriangleBVH
+	{
+	/* Embedded classes: */
+	public:
+	typedef Misc::UInt32 Index; // Type for triangle and node indices
+	static const Index invalidIndex=0xffffffffU; // Index denoting a non-existing triangle
+	static const int packetSize=8; // Number of rays traversing the hierarchy together in intersectRays
+	typedef TriangleCollector::Triangle Triangle; // Type for triangles
+	typedef TriangleCollector::GeometryVersion GeometryVersion; // Type for versions of geometry nodes
+	
+	struct RayHit // Structure to report the first intersection of a ray with the scene graph's triangles
+		{
+		/* Elements: */
+		public:
+		Scalar lambda; // Ray parameter of the intersection point, or the maximum ray parameter if the ray missed
+		Index triangleIndex; // Index of the intersected triangle, or invalidIndex if the ray missed
+		const GeometryNode* geometry; // Geometry node defining the intersected triangle
+		Vector normal; // Unit-length normal vector of the intersected triangle's front face
+		
+		/* Methods: */
+		bool isValid(void) const // Returns true if the ray intersected a triangle
+			{
+			return triangleIndex!=invalidIndex;
+			}
+		};
+	
+	struct ClosestPoint // Structure to report the closest point on the scene graph's triangles to a query point
+		{
+		/* Elements: */
+		public:
+		Point point; // Closest surface point
+		Scalar sqrDist; // Squared distance from the query point to the closest surface point
+		Index triangleIndex; // Index of the triangle containing the closest point, or invalidIndex if there is none within the query radius
+		const GeometryNode* geometry; // Geometry node defining the closest triangle
+		Vector normal; // Unit-length normal vector of the closest triangle's front face
+		
+		/* Methods: */
+		bool isValid(void) const // Returns true if a closest point was found
+			{
+			return triangleIndex!=invalidIndex;
+			}
+		};
+	
+	private:
+	struct Node // Structure for hierarchy nodes
+		{
+		/* Elements: */
+		public:
+		Box box; // Bounding box of all triangles below the node
+		Index first; // Index of the first triangle of a leaf node, or of the first of the two children of an interior node
+		Misc::UInt16 numTriangles; // Number of triangles in a leaf node; 0 for interior nodes
+		Misc::UInt16 splitAxis; // Axis along which an interior node's children were split
+		};
+	
+	class Builder; // Class to build hierarchies using binned surface area heuristic splits
+	friend class Builder;
+	struct LeafRefitter; // Functor to refit leaf node boxes in parallel
+	friend struct LeafRefitter;
+	struct PacketIntersector; // Functor to intersect ray packets in parallel
+	friend struct PacketIntersector;
+	
+	/* Elements: */
+	GraphNodePointer root; // Root of the scene graph whose triangles are stored in the hierarchy
+	unsigned int maxNumThreads; // Maximum number of threads used to build or refit the hierarchy and to intersect rays
+	std::vector<Triangle> triangles; // List of triangles in leaf order
+	std::vector<Index> collectionOrder; // Index of each triangle in the order in which it was collected from the scene graph
+	std::vector<Node> nodes; // List of hierarchy nodes; root is the first node, children have higher indices than their parents
+	std::vector<GeometryVersion> geometryVersions; // Geometry nodes whose triangles were collected at the last build or refit, with their geometry versions at the time
+	
+	/* Private methods: */
+	void build(const std::vector<Triangle>& collectedTriangles); // Builds a new hierarchy for the given list of triangles
+	void intersectPacket(int numRays,const Ray* rays,Scalar maxLambda,RayHit* hits) const; // Intersects a packet of at most packetSize rays with the hierarchy
+	void finishHit(RayHit& hit) const; // Fills in a ray hit's geometry node and normal vector from its triangle index
+	
+	/* Constructors and destructors: */
+	public:
+	TriangleBVH(GraphNodePointer sRoot,unsigned int sMaxNumThreads =0); // Builds a hierarchy over the triangles of the given scene graph, using the given maximum number of threads (0: one per online processor)
+	
+	/* Methods: */
+	const GraphNodePointer& getRoot(void) const // Returns the root of the scene graph
+		{
+		return root;
+		}
+	void rebuild(void); // Collects the scene graph's triangles and builds a new hierarchy from scratch
+	bool refit(void); // Collects the scene graph's triangles after nodes have been updated and refits the hierarchy's boxes; rebuilds and returns false if the number of triangles changed
+	bool isOutdated(void) const; // Returns true if any collected geometry node has been updated since the last build or refit
+	bool update(void); // Refits the hierarchy if it is outdated; returns true if the hierarchy changed
+	size_t getNumTriangles(void) const // Returns the number of triangles in the hierarchy
+		{
+		return triangles.size();
+		}
+	const Triangle& getTriangle(Index triangleIndex) const // Returns the triangle of the given index
+		{
+		return triangles[triangleIndex];
+		}
+	size_t getNumNodes(void) const // Returns the number of nodes in the hierarchy
+		{
+		return nodes.size();
+		}
+	Box getBoundingBox(void) const; // Returns the bounding box of all triangles
+	bool intersectRay(const Ray& ray,Scalar maxLambda,RayHit& hit) const; // Intersects the given ray with all triangles up to the given ray parameter; returns true if the ray hit a triangle
+	void intersectRays(size_t numRays,const Ray* rays,Scalar maxLambda,RayHit* hits) const; // Intersects an array of rays with all triangles up to the given ray parameter; coherent rays should be adjacent in the array
+	bool findClosestPoint(const Point& queryPoint,Scalar maxDist,ClosestPoint& result) const; // Finds the closest surface point to the given query point within the given distance; returns true if a point was found
+	};
+
+}
+
+#endif
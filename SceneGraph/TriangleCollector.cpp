@@ -0,0 +1,97 @@
+/***********************************************************************
+TriangleCollector - Class encapsulating the traversal state of a scene
+graph while collecting the triangles of all its surfaces in root
+coordinates.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/TriangleCollector.h>
+
+namespace SceneGraph {
+
+/**********************************
+Methods of class TriangleCollector:
+**********************************/
+
+TriangleCollector::TriangleCollector(void)
+	:currentTransform(OGTransform::identity),
+	 currentGeometry(0)
+	{
+	}
+
+OGTransform TriangleCollector::pushTransform(const OGTransform& deltaTransform)
+	{
+	/* Update the current transformation: */
+	OGTransform result=currentTransform;
+	currentTransform*=deltaTransform;
+	currentTransform.renormalize();
+	
+	return result;
+	}
+
+void TriangleCollector::popTransform(const OGTransform& previousTransform)
+	{
+	/* Reinstate the current transformation: */
+	currentTransform=previousTransform;
+	}
+
+const GeometryNode* TriangleCollector::setGeometry(const GeometryNode* newGeometry)
+	{
+	const GeometryNode* result=currentGeometry;
+	currentGeometry=newGeometry;
+	
+	/* Record the new geometry node's version unless it was just recorded: */
+	if(newGeometry!=0&&(geometryVersions.empty()||geometryVersions.back().geometry!=newGeometry))
+		{
+		GeometryVersion gv;
+		gv.geometry=const_cast<GeometryNode*>(newGeometry);
+		gv.version=newGeometry->getGeometryVersion();
+		geometryVersions.push_back(gv);
+		}
+	
+	return result;
+	}
+
+void TriangleCollector::addTriangle(const Point& p0,const Point& p1,const Point& p2)
+	{
+	/* Store the triangle in root coordinates: */
+	Triangle t;
+	t.vertices[0]=currentTransform.transform(p0);
+	t.vertices[1]=currentTransform.transform(p1);
+	t.vertices[2]=currentTransform.transform(p2);
+	t.geometry=currentGeometry;
+	triangles.push_back(t);
+	}
+
+void TriangleCollector::addQuad(const Point& p0,const Point& p1,const Point& p2,const Point& p3)
+	{
+	/* Split the quadrilateral into two triangles: */
+	addTriangle(p0,p1,p2);
+	addTriangle(p2,p3,p0);
+	}
+
+void TriangleCollector::clear(void)
+	{
+	currentTransform=OGTransform::identity;
+	currentGeometry=0;
+	triangles.clear();
+	geometryVersions.clear();
+	}
+
+}
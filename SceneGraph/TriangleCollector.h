@@ -0,0 +1,93 @@
+/***********************************************************************
+TriangleCollector - Class encapsulating the traversal state of a scene
+graph while collecting the triangles of all its surfaces in root
+coordinates.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_TRIANGLECOLLECTOR_INCLUDED
+#define SCENEGRAPH_TRIANGLECOLLECTOR_INCLUDED
+
+#include <vector>
+#include <Geometry/Point.h>
+#include <Geometry/OrthogonalTransformation.h>
+#include <SceneGraph/Geometry.h>
+#include <SceneGraph/GeometryNode.h>
+
+namespace SceneGraph {
+
+class TriangleCollector
+	{
+	/* Embedded classes: */
+	public:
+	struct Triangle // Structure for collected triangles
+		{
+		/* Elements: */
+		public:
+		Point vertices[3]; // Triangle's vertices in root coordinates in counter-clockwise order
+		const GeometryNode* geometry; // Geometry node that defined the triangle, or null
+		};
+	
+	struct GeometryVersion // Structure to remember the version of a visited geometry node
+		{
+		/* Elements: */
+		public:
+		GeometryNodePointer geometry; // Visited geometry node; referenced so that later version checks cannot see a destroyed node
+		unsigned int version; // Geometry version of the node at the time of the visit
+		};
+	
+	/* Elements: */
+	private:
+	OGTransform currentTransform; // Transformation from current model coordinates to root coordinates
+	const GeometryNode* currentGeometry; // Geometry node currently adding triangles
+	std::vector<Triangle> triangles; // List of collected triangles
+	std::vector<GeometryVersion> geometryVersions; // List of visited geometry nodes and their geometry versions
+	
+	/* Constructors and destructors: */
+	public:
+	TriangleCollector(void); // Creates an empty collector with an identity transformation
+	
+	/* Methods: */
+	const OGTransform& getTransform(void) const // Returns the transformation from current model coordinates to root coordinates
+		{
+		return currentTransform;
+		}
+	OGTransform pushTransform(const OGTransform& deltaTransform); // Appends the given transformation to the current transformation and returns the previous transformation
+	void popTransform(const OGTransform& previousTransform); // Resets the current transformation; must be result from previous pushTransform call
+	const GeometryNode* setGeometry(const GeometryNode* newGeometry); // Sets the geometry node whose triangles are added next and records its geometry version; returns the previous geometry node
+	void addTriangle(const Point& p0,const Point& p1,const Point& p2); // Adds a triangle given by its vertices in current model coordinates in counter-clockwise order
+	void addQuad(const Point& p0,const Point& p1,const Point& p2,const Point& p3); // Adds a planar convex quadrilateral given by its vertices in current model coordinates in counter-clockwise order
+	const std::vector<Triangle>& getTriangles(void) const // Returns the list of collected triangles
+		{
+		return triangles;
+		}
+	std::vector<Triangle>& getTriangles(void) // Ditto
+		{
+		return triangles;
+		}
+	const std::vector<GeometryVersion>& getGeometryVersions(void) const // Returns the list of visited geometry nodes and their geometry versions
+		{
+		return geometryVersions;
+		}
+	void clear(void); // Removes all collected triangles and resets the traversal state
+	};
+
+}
+
+#endif
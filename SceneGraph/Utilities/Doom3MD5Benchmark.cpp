@@ -0,0 +1,138 @@
+/***********************************************************************
+Doom3MD5Benchmark - Program to measure the time required to animate and
+skin a crowd of instances of an animated mesh in Doom3's MD5 format.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <Misc/Timer.h>
+#include <IO/OpenFile.h>
+#include <SceneGraph/Internal/Doom3FileManager.h>
+#include <SceneGraph/Internal/Doom3TextureManager.h>
+#include <SceneGraph/Internal/Doom3MaterialManager.h>
+#include <SceneGraph/Internal/Doom3MD5Mesh.h>
+#include <SceneGraph/Internal/Doom3MD5Anim.h>
+#include <SceneGraph/Internal/Doom3MD5Animator.h>
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	const char* baseDirName=0;
+	const char* pakFilePrefix=0;
+	const char* meshFileName=0;
+	std::vector<const char*> animFileNames;
+	int numInstances=100;
+	int numFrames=100;
+	unsigned int maxNumThreads=0;
+	float timeQuantum=0.0f;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"instances")==0&&i+1<argc)
+				numInstances=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"frames")==0&&i+1<argc)
+				numFrames=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"threads")==0&&i+1<argc)
+				maxNumThreads=(unsigned int)atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"quantum")==0&&i+1<argc)
+				timeQuantum=float(atof(argv[++i]));
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else if(baseDirName==0)
+			baseDirName=argv[i];
+		else if(pakFilePrefix==0)
+			pakFilePrefix=argv[i];
+		else if(meshFileName==0)
+			meshFileName=argv[i];
+		else
+			animFileNames.push_back(argv[i]);
+		}
+	if(meshFileName==0||animFileNames.empty())
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" <base directory> <pak file prefix> <mesh file name> <anim file name> [<anim file name>] [-instances <num instances>] [-frames <num frames>] [-threads <max num threads>] [-quantum <time quantum>]"<<std::endl;
+		return 1;
+		}
+	
+	try
+		{
+		/* Open the game data: */
+		SceneGraph::Doom3FileManager fileManager(IO::openDirectory(baseDirName),pakFilePrefix);
+		SceneGraph::Doom3TextureManager textureManager(fileManager);
+		SceneGraph::Doom3MaterialManager materialManager(textureManager);
+		
+		/* Load the animation sequences: */
+		std::vector<SceneGraph::Doom3MD5Anim*> anims;
+		for(std::vector<const char*>::iterator afnIt=animFileNames.begin();afnIt!=animFileNames.end();++afnIt)
+			anims.push_back(new SceneGraph::Doom3MD5Anim(fileManager,*afnIt));
+		
+		/* Create the instances, each playing its sequences with a different phase: */
+		SceneGraph::Doom3MD5Animator animator(maxNumThreads);
+		animator.setTimeQuantum(timeQuantum);
+		std::vector<SceneGraph::Doom3MD5Mesh*> meshes;
+		for(int i=0;i<numInstances;++i)
+			{
+			meshes.push_back(new SceneGraph::Doom3MD5Mesh(fileManager,materialManager,meshFileName));
+			animator.addInstance(meshes.back());
+			}
+		std::cout<<"Loaded "<<numInstances<<" instances of "<<meshFileName<<" with "<<meshes.front()->getNumJoints()<<" joints"<<std::endl;
+		
+		/* Animate all instances for the requested number of frames at 60 Hz: */
+		Misc::Timer timer;
+		size_t numPalettes=0;
+		for(int frame=0;frame<numFrames;++frame)
+			{
+			float time=float(frame)/60.0f;
+			for(int i=0;i<numInstances;++i)
+				{
+				float phase=float(i)*0.0371f;
+				if(anims.size()>1)
+					{
+					float blendWeight=float(i%5)*0.25f;
+					animator.setBlendedAnimation(i,anims[0],time+phase,anims[1],time+phase,blendWeight);
+					}
+				else
+					animator.setAnimation(i,anims[0],time+phase);
+				}
+			animator.update();
+			numPalettes+=animator.getNumPalettes();
+			}
+		timer.elapse();
+		
+		std::cout<<"Animated "<<numFrames<<" frames in "<<timer.getTime()*1000.0<<" ms ("<<timer.getTime()*1000.0/double(numFrames)<<" ms per frame, "<<double(numPalettes)/double(numFrames)<<" palettes per frame)"<<std::endl;
+		
+		/* Clean up: */
+		for(std::vector<SceneGraph::Doom3MD5Mesh*>::iterator mIt=meshes.begin();mIt!=meshes.end();++mIt)
+			delete *mIt;
+		for(std::vector<SceneGraph::Doom3MD5Anim*>::iterator aIt=anims.begin();aIt!=anims.end();++aIt)
+			delete *aIt;
+		}
+	catch(std::runtime_error err)
+		{
+		std::cerr<<"Caught exception "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -0,0 +1,158 @@
+/***********************************************************************
+Doom3MaterialExpressionBenchmark - Program to compare the evaluation
+times of Doom3 material expressions as expression trees and as compiled
+expression programs.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <SceneGraph/Internal/Doom3MaterialManager.h>
+
+namespace SceneGraph {
+
+class Doom3MaterialExpressionBenchmark // Class with access to the material manager's private expression classes
+	{
+	/* Embedded classes: */
+	private:
+	typedef Doom3MaterialManager MM;
+	
+	/* Private methods: */
+	static MM::Expression* createMaterialExpression(int expressionIndex,const MM::Table* sinTable); // Creates an expression of a shape typical for material stages
+	
+	/* Methods: */
+	public:
+	static void run(int numExpressions,int numFrames); // Compares evaluation of the given number of expressions over the given number of frames
+	};
+
+Doom3MaterialManager::Expression* Doom3MaterialExpressionBenchmark::createMaterialExpression(int expressionIndex,const Doom3MaterialManager::Table* sinTable)
+	{
+	/* Create expressions of the shapes typically found in material stages, with a few distinct phases and rates: */
+	float phase=float(expressionIndex%7)*0.125f;
+	float rate=float(1+expressionIndex%3)*0.5f;
+	switch(expressionIndex%4)
+		{
+		case 0: // sintable[time*rate+phase]*0.5+0.5
+			{
+			MM::Expression* arg=new MM::BinOpExpression(0,new MM::BinOpExpression(2,new MM::EnvExpression(0),new MM::ConstExpression(rate)),new MM::ConstExpression(phase));
+			return new MM::BinOpExpression(0,new MM::BinOpExpression(2,new MM::TableExpression(sinTable,arg),new MM::ConstExpression(0.5f)),new MM::ConstExpression(0.5f));
+			}
+		
+		case 1: // (time*rate)%1
+			return new MM::BinOpExpression(4,new MM::BinOpExpression(2,new MM::EnvExpression(0),new MM::ConstExpression(rate)),new MM::ConstExpression(1.0f));
+		
+		case 2: // parm0*(0.25*3)+(1-0.75)
+			{
+			MM::Expression* scale=new MM::BinOpExpression(2,new MM::ConstExpression(0.25f),new MM::ConstExpression(3.0f));
+			MM::Expression* offset=new MM::BinOpExpression(1,new MM::ConstExpression(1.0f),new MM::ConstExpression(0.75f));
+			return new MM::BinOpExpression(0,new MM::BinOpExpression(2,new MM::EnvExpression(1),scale),offset);
+			}
+		
+		default: // (time>phase)*sintable[time*rate]
+			{
+			MM::Expression* cond=new MM::BinOpExpression(10,new MM::EnvExpression(0),new MM::ConstExpression(phase));
+			MM::Expression* arg=new MM::BinOpExpression(2,new MM::EnvExpression(0),new MM::ConstExpression(rate));
+			return new MM::BinOpExpression(2,cond,new MM::TableExpression(sinTable,arg));
+			}
+		}
+	}
+
+void Doom3MaterialExpressionBenchmark::run(int numExpressions,int numFrames)
+	{
+	/* Create a sine table: */
+	MM::Table sinTable;
+	sinTable.numValues=256;
+	sinTable.values=new float[sinTable.numValues];
+	for(int i=0;i<sinTable.numValues;++i)
+		sinTable.values[i]=float(Math::sin(2.0*Math::Constants<double>::pi*double(i)/double(sinTable.numValues)));
+	
+	/* Create the expression trees and compile them into a shared program: */
+	std::vector<MM::Expression*> expressions;
+	std::vector<int> registers;
+	MM::ExpressionProgram program;
+	for(int i=0;i<numExpressions;++i)
+		{
+		expressions.push_back(createMaterialExpression(i,&sinTable));
+		registers.push_back(expressions.back()->compile(program));
+		}
+	std::cout<<numExpressions<<" expressions compiled into "<<program.getNumRegisters()<<" registers and "<<program.getNumDynamicInstructions()<<" instructions per evaluation"<<std::endl;
+	
+	/* Evaluate the expression trees for all frames: */
+	MM::ExpressionEnvironment env;
+	env.parm[0]=0.5f;
+	double treeSum=0.0;
+	Misc::Timer treeTimer;
+	for(int frame=0;frame<numFrames;++frame)
+		{
+		env.time=float(frame)/60.0f;
+		for(std::vector<MM::Expression*>::iterator eIt=expressions.begin();eIt!=expressions.end();++eIt)
+			treeSum+=(*eIt)->evaluate(env);
+		}
+	treeTimer.elapse();
+	
+	/* Evaluate the compiled program for all frames: */
+	double programSum=0.0;
+	Misc::Timer programTimer;
+	for(int frame=0;frame<numFrames;++frame)
+		{
+		env.time=float(frame)/60.0f;
+		program.evaluate(env);
+		for(std::vector<int>::iterator rIt=registers.begin();rIt!=registers.end();++rIt)
+			programSum+=program.getValue(*rIt);
+		}
+	programTimer.elapse();
+	
+	std::cout<<"Expression trees:  "<<treeTimer.getTime()*1000.0/double(numFrames)<<" ms per frame (checksum "<<treeSum<<")"<<std::endl;
+	std::cout<<"Compiled program:  "<<programTimer.getTime()*1000.0/double(numFrames)<<" ms per frame (checksum "<<programSum<<")"<<std::endl;
+	
+	/* Clean up: */
+	for(std::vector<MM::Expression*>::iterator eIt=expressions.begin();eIt!=expressions.end();++eIt)
+		delete *eIt;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int numExpressions=1000;
+	int numFrames=1000;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"expressions")==0&&i+1<argc)
+				numExpressions=atoi(argv[++i]);
+			else if(strcasecmp(argv[i]+1,"frames")==0&&i+1<argc)
+				numFrames=atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		}
+	
+	/* Run the benchmark: */
+	SceneGraph::Doom3MaterialExpressionBenchmark::run(numExpressions,numFrames);
+	
+	return 0;
+	}
@@ -0,0 +1,233 @@
+/***********************************************************************
+PolygonMeshBenchmark - Program to measure the time to convert a large
+synthetic polygon mesh into a renderable indexed triangle set, and to
+check that the result does not depend on the number of threads.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include <Misc/SizedTypes.h>
+#include <Misc/Timer.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <SceneGraph/PolygonMesh.h>
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+struct MeshVertex // Structure for mesh and triangle set vertices
+	{
+	/* Embedded classes: */
+	public:
+	typedef float Scalar;
+	typedef Geometry::Point<float,3> Point;
+	typedef Geometry::Vector<float,3> Vector;
+	typedef Geometry::Point<float,2> TPoint;
+	
+	/* Elements: */
+	TPoint texCoord;
+	Vector normal;
+	Point position;
+	};
+
+typedef SceneGraph::PolygonMesh<MeshVertex> Mesh;
+
+struct Result // Structure summarizing a mesh conversion
+	{
+	/* Elements: */
+	public:
+	double times[4]; // Times to create the mesh, find crease edges, calculate vertex normals, and triangulate the mesh in seconds
+	size_t numVertices; // Number of triangle set vertices
+	size_t numIndices; // Number of triangle set vertex indices
+	Misc::UInt64 hash; // Hash value of the triangle set's vertex positions, normal vectors, and indices
+	};
+
+/****************
+Helper functions:
+****************/
+
+void hashBytes(Misc::UInt64& hash,const void* data,size_t size)
+	{
+	/* Update a 64-bit FNV-1a hash value: */
+	const unsigned char* dPtr=static_cast<const unsigned char*>(data);
+	for(size_t i=0;i<size;++i)
+		{
+		hash^=Misc::UInt64(dPtr[i]);
+		hash*=0x100000001b3ULL;
+		}
+	}
+
+Result convertMesh(unsigned int gridSize,unsigned int maxNumThreads)
+	{
+	Result result;
+	Misc::Timer timer;
+	
+	{
+	Mesh mesh;
+	mesh.setMaxNumThreads(maxNumThreads);
+	
+	/* Create a grid of vertices folded along two lines to create crease edges, and randomly jittered in height to create non-planar faces: */
+	srand(1);
+	unsigned int fold0=gridSize/3;
+	unsigned int fold1=(gridSize*2)/3;
+	for(unsigned int y=0;y<=gridSize;++y)
+		for(unsigned int x=0;x<=gridSize;++x)
+			{
+			MeshVertex v;
+			float height=x>fold0?float(x-fold0):0.0f;
+			if(y>fold1)
+				height+=float(y-fold1)*0.5f;
+			height+=float(rand()%1000)*1.0e-5f;
+			v.position=MeshVertex::Point(float(x),float(y),height);
+			mesh.addVertex(v);
+			}
+	
+	/* Create the grid's faces; most are quadrilaterals, but every seventh pair of quadrilaterals in a row is merged into a hexagon, and every eleventh quadrilateral is split into two triangles: */
+	for(unsigned int y=0;y<gridSize;++y)
+		{
+		Mesh::Card row0=y*(gridSize+1);
+		Mesh::Card row1=row0+gridSize+1;
+		for(unsigned int x=0;x<gridSize;)
+			{
+			if(x%7==3&&x+2<=gridSize)
+				{
+				Mesh::Card hexagon[6]={row0+x,row0+x+1,row0+x+2,row1+x+2,row1+x+1,row1+x};
+				mesh.addFace(6,hexagon);
+				x+=2;
+				}
+			else if((x+y)%11==0)
+				{
+				Mesh::Card triangle0[3]={row0+x,row0+x+1,row1+x+1};
+				Mesh::Card triangle1[3]={row0+x,row1+x+1,row1+x};
+				mesh.addFace(3,triangle0);
+				mesh.addFace(3,triangle1);
+				++x;
+				}
+			else
+				{
+				Mesh::Card quad[4]={row0+x,row0+x+1,row1+x+1,row1+x};
+				mesh.addFace(4,quad);
+				++x;
+				}
+			}
+		}
+	result.times[0]=timer.peekTime();
+	
+	/* Connect the faces and find crease edges: */
+	mesh.findCreaseEdges(float(M_PI)*0.125f);
+	result.times[1]=timer.peekTime();
+	
+	/* Calculate vertex normal vectors: */
+	mesh.calcVertexNormals();
+	result.times[2]=timer.peekTime();
+	
+	/* Triangulate the mesh into an indexed triangle set: */
+	std::vector<MeshVertex> triangleVertices;
+	std::vector<Mesh::Card> triangleIndices;
+	mesh.triangulate(triangleVertices,triangleIndices);
+	result.times[3]=timer.peekTime();
+	
+	/* Summarize the triangle set: */
+	result.numVertices=triangleVertices.size();
+	result.numIndices=triangleIndices.size();
+	result.hash=0xcbf29ce484222325ULL;
+	for(std::vector<MeshVertex>::iterator tvIt=triangleVertices.begin();tvIt!=triangleVertices.end();++tvIt)
+		{
+		hashBytes(result.hash,tvIt->position.getComponents(),3*sizeof(float));
+		hashBytes(result.hash,tvIt->normal.getComponents(),3*sizeof(float));
+		}
+	if(!triangleIndices.empty())
+		hashBytes(result.hash,&triangleIndices[0],triangleIndices.size()*sizeof(Mesh::Card));
+	}
+	
+	/* Convert the phase end times into phase durations: */
+	for(int i=3;i>0;--i)
+		result.times[i]-=result.times[i-1];
+	
+	return result;
+	}
+
+void printResult(const char* label,const Result& result)
+	{
+	std::cout<<label<<": create "<<result.times[0]*1000.0<<" ms, connect and find creases "<<result.times[1]*1000.0<<" ms, vertex normals "<<result.times[2]*1000.0<<" ms, triangulate "<<result.times[3]*1000.0<<" ms";
+	std::cout<<" ("<<(result.times[1]+result.times[2]+result.times[3])*1000.0<<" ms after creation)"<<std::endl;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	size_t numFaces=10000000;
+	unsigned int maxNumThreads=0;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"faces")==0&&i+1<argc)
+				numFaces=size_t(atof(argv[++i]));
+			else if(strcasecmp(argv[i]+1,"threads")==0&&i+1<argc)
+				maxNumThreads=(unsigned int)atoi(argv[++i]);
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring unrecognized argument "<<argv[i]<<std::endl;
+		}
+	
+	/* Calculate the size of a grid with approximately the requested number of faces: */
+	unsigned int gridSize=(unsigned int)(ceil(sqrt(double(numFaces))));
+	if(gridSize<8)
+		gridSize=8;
+	
+	int exitCode=0;
+	try
+		{
+		/* Convert the mesh with a single thread and with the thread limit: */
+		Result serial=convertMesh(gridSize,1);
+		std::cout<<"Grid of "<<gridSize<<"x"<<gridSize<<" cells: "<<serial.numVertices<<" triangle vertices, "<<serial.numIndices/3<<" triangles"<<std::endl;
+		printResult("1 thread",serial);
+		Result parallel=convertMesh(gridSize,maxNumThreads);
+		printResult("All threads",parallel);
+		
+		/* Check that both conversions created the same triangle set: */
+		if(parallel.numVertices!=serial.numVertices||parallel.numIndices!=serial.numIndices||parallel.hash!=serial.hash)
+			{
+			std::cout<<"Triangle sets differ between thread counts"<<std::endl;
+			exitCode=1;
+			}
+		else
+			std::cout<<"Triangle sets are identical"<<std::endl;
+		}
+	catch(std::runtime_error err)
+		{
+		std::cerr<<"Caught exception "<<err.what()<<std::endl;
+		exitCode=1;
+		}
+	
+	return exitCode;
+	}
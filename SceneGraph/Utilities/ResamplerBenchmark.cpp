@@ -0,0 +1,236 @@
+/***********************************************************************
+ResamplerBenchmark - Program to check the image resampler against
+golden images and a direct two-dimensional reference implementation,
+and to measure its resampling times.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <iostream>
+#include <GL/gl.h>
+#include <Misc/Timer.h>
+#include <Images/Resampler.h>
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const char* filterNames[4]={"box","bilinear","bicubic","lanczos3"};
+
+bool checkConstantImage(Images::Resampler::Filter filter,const unsigned int sourceSize[2],const unsigned int destSize[2])
+	{
+	/* A normalized filter must reproduce a constant image exactly: */
+	std::vector<GLubyte> source(size_t(sourceSize[0])*size_t(sourceSize[1])*4);
+	for(size_t i=0;i<source.size();i+=4)
+		{
+		source[i+0]=GLubyte(17);
+		source[i+1]=GLubyte(128);
+		source[i+2]=GLubyte(255);
+		source[i+3]=GLubyte(200);
+		}
+	std::vector<GLubyte> dest(size_t(destSize[0])*size_t(destSize[1])*4);
+	Images::Resampler(filter).resample(4,sourceSize,&source[0],destSize,&dest[0]);
+	for(size_t i=0;i<dest.size();++i)
+		if(dest[i]!=source[i%4])
+			return false;
+	return true;
+	}
+
+bool checkBoxReduction(unsigned int width,unsigned int height)
+	{
+	/* A 2:1 box reduction must average each 2x2 block of source pixels: */
+	unsigned int sourceSize[2]={width*2,height*2};
+	unsigned int destSize[2]={width,height};
+	std::vector<GLfloat> source(size_t(sourceSize[0])*size_t(sourceSize[1]));
+	for(size_t i=0;i<source.size();++i)
+		source[i]=GLfloat(rand()%1000);
+	std::vector<GLfloat> dest(size_t(width)*size_t(height));
+	Images::Resampler(Images::Resampler::BOX).resample(1,sourceSize,&source[0],destSize,&dest[0]);
+	for(unsigned int y=0;y<height;++y)
+		for(unsigned int x=0;x<width;++x)
+			{
+			const GLfloat* s=&source[size_t(y*2)*size_t(sourceSize[0])+size_t(x*2)];
+			float average=(s[0]+s[1]+s[sourceSize[0]]+s[sourceSize[0]+1])*0.25f;
+			if(fabsf(dest[size_t(y)*size_t(width)+size_t(x)]-average)>1.0e-3f)
+				return false;
+			}
+	return true;
+	}
+
+bool checkLinearRamp(unsigned int sourceWidth,unsigned int destWidth)
+	{
+	/* Bilinear enlargement must reproduce a linear ramp away from the clamped image edges: */
+	unsigned int sourceSize[2]={sourceWidth,2};
+	unsigned int destSize[2]={destWidth,2};
+	std::vector<GLfloat> source(size_t(sourceWidth)*2);
+	for(unsigned int y=0;y<2;++y)
+		for(unsigned int x=0;x<sourceWidth;++x)
+			source[y*sourceWidth+x]=GLfloat(x);
+	std::vector<GLfloat> dest(size_t(destWidth)*2);
+	Images::Resampler(Images::Resampler::BILINEAR).resample(1,sourceSize,&source[0],destSize,&dest[0]);
+	float scale=float(sourceWidth)/float(destWidth);
+	for(unsigned int x=0;x<destWidth;++x)
+		{
+		float sourceX=(float(x)+0.5f)*scale-0.5f;
+		if(sourceX<0.0f||sourceX>float(sourceWidth-1))
+			continue;
+		if(fabsf(dest[x]-sourceX)>1.0e-3f||fabsf(dest[destWidth+x]-sourceX)>1.0e-3f)
+			return false;
+		}
+	return true;
+	}
+
+float compareWithReference(Images::Resampler::Filter filter,const unsigned int sourceSize[2],const unsigned int destSize[2])
+	{
+	/* Create a random multi-component source image: */
+	std::vector<GLfloat> source(size_t(sourceSize[0])*size_t(sourceSize[1])*3);
+	for(size_t i=0;i<source.size();++i)
+		source[i]=GLfloat(rand())/GLfloat(RAND_MAX);
+	
+	/* Resample the image with the separable, banded resampler: */
+	std::vector<GLfloat> dest(size_t(destSize[0])*size_t(destSize[1])*3);
+	Images::Resampler(filter).resample(3,sourceSize,&source[0],destSize,&dest[0]);
+	
+	/* Resample the image directly in two dimensions, in double precision: */
+	Images::Resampler::WeightTable wx(filter,sourceSize[0],destSize[0]);
+	Images::Resampler::WeightTable wy(filter,sourceSize[1],destSize[1]);
+	float maxError=0.0f;
+	for(unsigned int y=0;y<destSize[1];++y)
+		for(unsigned int x=0;x<destSize[0];++x)
+			for(int c=0;c<3;++c)
+				{
+				double sum=0.0;
+				for(size_t ty=wy.getFirstTap(y);ty<wy.getLastTap(y);++ty)
+					for(size_t tx=wx.getFirstTap(x);tx<wx.getLastTap(x);++tx)
+						sum+=double(wy.getTapWeight(ty))*double(wx.getTapWeight(tx))*double(source[(size_t(wy.getTapIndex(ty))*size_t(sourceSize[0])+size_t(wx.getTapIndex(tx)))*3+c]);
+				float error=fabsf(float(sum)-dest[(size_t(y)*size_t(destSize[0])+size_t(x))*3+c]);
+				if(maxError<error)
+					maxError=error;
+				}
+	return maxError;
+	}
+
+double timeResampling(Images::Resampler::Filter filter,unsigned int maxNumThreads,const unsigned int sourceSize[2],const GLubyte* source,const unsigned int destSize[2],GLubyte* dest,int numRuns)
+	{
+	Images::Resampler resampler(filter,maxNumThreads);
+	Misc::Timer timer;
+	for(int run=0;run<numRuns;++run)
+		resampler.resample(4,sourceSize,source,destSize,dest);
+	timer.elapse();
+	return timer.getTime()*1000.0/double(numRuns);
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int imageSize=2048;
+	unsigned int maxNumThreads=0;
+	int numRuns=3;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"size")==0)
+				{
+				++i;
+				if(i<argc)
+					imageSize=(unsigned int)(atoi(argv[i]));
+				}
+			else if(strcasecmp(argv[i]+1,"threads")==0)
+				{
+				++i;
+				if(i<argc)
+					maxNumThreads=(unsigned int)(atoi(argv[i]));
+				}
+			else if(strcasecmp(argv[i]+1,"runs")==0)
+				{
+				++i;
+				if(i<argc)
+					numRuns=atoi(argv[i]);
+				}
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			std::cerr<<"Ignoring unrecognized argument "<<argv[i]<<std::endl;
+		}
+	
+	/* Check the resampler against golden images: */
+	int result=0;
+	srand(1);
+	static const unsigned int testSizes[][4]=
+		{
+		{64,48,64,48},{64,48,32,24},{64,48,17,5},{13,7,64,40},{100,100,1,1},{1,1,9,9}
+		};
+	const int numTestSizes=sizeof(testSizes)/sizeof(testSizes[0]);
+	for(int f=0;f<4;++f)
+		{
+		Images::Resampler::Filter filter=Images::Resampler::Filter(f);
+		bool constantOk=true;
+		float maxReferenceError=0.0f;
+		for(int t=0;t<numTestSizes;++t)
+			{
+			const unsigned int* sourceSize=testSizes[t];
+			const unsigned int* destSize=testSizes[t]+2;
+			constantOk=constantOk&&checkConstantImage(filter,sourceSize,destSize);
+			float error=compareWithReference(filter,sourceSize,destSize);
+			if(maxReferenceError<error)
+				maxReferenceError=error;
+			}
+		std::cout<<"Filter "<<filterNames[f]<<": constant images "<<(constantOk?"passed":"FAILED")<<", max deviation from 2D reference "<<maxReferenceError<<std::endl;
+		if(!constantOk||maxReferenceError>1.0e-4f)
+			result=1;
+		}
+	bool boxOk=checkBoxReduction(64,33);
+	std::cout<<"2:1 box reduction "<<(boxOk?"passed":"FAILED")<<std::endl;
+	bool rampOk=checkLinearRamp(16,61)&&checkLinearRamp(7,64);
+	std::cout<<"Bilinear linear ramp "<<(rampOk?"passed":"FAILED")<<std::endl;
+	if(!boxOk||!rampOk)
+		result=1;
+	
+	/* Create a large RGBA benchmark image: */
+	unsigned int sourceSize[2]={imageSize,imageSize};
+	std::vector<GLubyte> source(size_t(imageSize)*size_t(imageSize)*4);
+	for(size_t i=0;i<source.size();++i)
+		source[i]=GLubyte(rand()&0xff);
+	unsigned int reducedSize[2]={imageSize*3/8,imageSize*3/8};
+	unsigned int enlargedSize[2]={imageSize*3/2,imageSize*3/2};
+	std::vector<GLubyte> dest(size_t(enlargedSize[0])*size_t(enlargedSize[1])*4);
+	
+	/* Time reduction and enlargement with all filters, using one thread and the thread limit: */
+	for(int f=0;f<4;++f)
+		{
+		Images::Resampler::Filter filter=Images::Resampler::Filter(f);
+		double reduce1=timeResampling(filter,1,sourceSize,&source[0],reducedSize,&dest[0],numRuns);
+		double reduceN=timeResampling(filter,maxNumThreads,sourceSize,&source[0],reducedSize,&dest[0],numRuns);
+		double enlarge1=timeResampling(filter,1,sourceSize,&source[0],enlargedSize,&dest[0],numRuns);
+		double enlargeN=timeResampling(filter,maxNumThreads,sourceSize,&source[0],enlargedSize,&dest[0],numRuns);
+		std::cout<<"Filter "<<filterNames[f]<<": "<<imageSize<<"^2 -> "<<reducedSize[0]<<"^2 in "<<reduce1<<" ms (1 thread), "<<reduceN<<" ms (all threads); ";
+		std::cout<<imageSize<<"^2 -> "<<enlargedSize[0]<<"^2 in "<<enlarge1<<" ms (1 thread), "<<enlargeN<<" ms (all threads)"<<std::endl;
+		}
+	
+	return result;
+	}
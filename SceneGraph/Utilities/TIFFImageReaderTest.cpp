@@ -0,0 +1,217 @@
+/***********************************************************************
+TIFFImageReaderTest - Program to check regions decoded by
+Images::TIFFImageReader from striped and tiled TIFF images against the
+images' known pixels.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Images/Config.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+
+#if IMAGES_CONFIG_HAVE_TIFF
+
+#include <tiffio.h>
+#include <Misc/SelfDestructPointer.h>
+#include <IO/File.h>
+#include <IO/OpenFile.h>
+#include <Images/RGBImage.h>
+#include <Images/ImageReader.h>
+#include <Images/ReadTIFFImage.h>
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const unsigned int imageSize[2]={203,157}; // Odd image size to create partial strips and tiles
+
+unsigned char getPixel(unsigned int x,unsigned int row,int channel) // Returns a channel of a test image pixel; rows are counted from the top
+	{
+	return (unsigned char)((x*7U+row*13U+(unsigned int)(channel)*71U+(x*row)%31U)&0xffU);
+	}
+
+void writeStripedImage(const char* imageFileName,unsigned int rowsPerStrip,int compression)
+	{
+	TIFF* tiff=TIFFOpen(imageFileName,"w");
+	if(tiff==0)
+		throw std::runtime_error("Unable to create striped test image");
+	TIFFSetField(tiff,TIFFTAG_IMAGEWIDTH,uint32(imageSize[0]));
+	TIFFSetField(tiff,TIFFTAG_IMAGELENGTH,uint32(imageSize[1]));
+	TIFFSetField(tiff,TIFFTAG_BITSPERSAMPLE,8);
+	TIFFSetField(tiff,TIFFTAG_SAMPLESPERPIXEL,3);
+	TIFFSetField(tiff,TIFFTAG_PHOTOMETRIC,PHOTOMETRIC_RGB);
+	TIFFSetField(tiff,TIFFTAG_PLANARCONFIG,PLANARCONFIG_CONTIG);
+	TIFFSetField(tiff,TIFFTAG_ORIENTATION,ORIENTATION_TOPLEFT);
+	TIFFSetField(tiff,TIFFTAG_COMPRESSION,compression);
+	TIFFSetField(tiff,TIFFTAG_ROWSPERSTRIP,uint32(rowsPerStrip));
+	std::vector<unsigned char> row(size_t(imageSize[0])*3);
+	for(unsigned int y=0;y<imageSize[1];++y)
+		{
+		for(unsigned int x=0;x<imageSize[0];++x)
+			for(int i=0;i<3;++i)
+				row[x*3+i]=getPixel(x,y,i);
+		TIFFWriteScanline(tiff,&row[0],y,0);
+		}
+	TIFFClose(tiff);
+	}
+
+void writeTiledImage(const char* imageFileName,unsigned int tileWidth,unsigned int tileHeight,int compression)
+	{
+	TIFF* tiff=TIFFOpen(imageFileName,"w");
+	if(tiff==0)
+		throw std::runtime_error("Unable to create tiled test image");
+	TIFFSetField(tiff,TIFFTAG_IMAGEWIDTH,uint32(imageSize[0]));
+	TIFFSetField(tiff,TIFFTAG_IMAGELENGTH,uint32(imageSize[1]));
+	TIFFSetField(tiff,TIFFTAG_BITSPERSAMPLE,8);
+	TIFFSetField(tiff,TIFFTAG_SAMPLESPERPIXEL,3);
+	TIFFSetField(tiff,TIFFTAG_PHOTOMETRIC,PHOTOMETRIC_RGB);
+	TIFFSetField(tiff,TIFFTAG_PLANARCONFIG,PLANARCONFIG_CONTIG);
+	TIFFSetField(tiff,TIFFTAG_ORIENTATION,ORIENTATION_TOPLEFT);
+	TIFFSetField(tiff,TIFFTAG_COMPRESSION,compression);
+	TIFFSetField(tiff,TIFFTAG_TILEWIDTH,uint32(tileWidth));
+	TIFFSetField(tiff,TIFFTAG_TILELENGTH,uint32(tileHeight));
+	std::vector<unsigned char> tile(size_t(tileWidth)*size_t(tileHeight)*3);
+	for(unsigned int tileY=0;tileY<imageSize[1];tileY+=tileHeight)
+		for(unsigned int tileX=0;tileX<imageSize[0];tileX+=tileWidth)
+			{
+			/* Pad partial tiles at the image's right and bottom edges with black: */
+			unsigned char* tPtr=&tile[0];
+			for(unsigned int y=tileY;y<tileY+tileHeight;++y)
+				for(unsigned int x=tileX;x<tileX+tileWidth;++x)
+					for(int i=0;i<3;++i,++tPtr)
+						*tPtr=x<imageSize[0]&&y<imageSize[1]?getPixel(x,y,i):0U;
+			TIFFWriteTile(tiff,&tile[0],tileX,tileY,0,0);
+			}
+	TIFFClose(tiff);
+	}
+
+size_t checkImage(const char* imageFileName,int numRegions)
+	{
+	size_t numMismatches=0;
+	
+	/* Decode random regions, starting with the full image: */
+	Misc::SelfDestructPointer<Images::ImageReader> reader(Images::ImageReader::create(imageFileName));
+	if(reader->getImageSize(0)!=imageSize[0]||reader->getImageSize(1)!=imageSize[1])
+		throw std::runtime_error("Mismatching image size");
+	for(int region=0;region<numRegions;++region)
+		{
+		unsigned int offset[2],size[2];
+		for(int i=0;i<2;++i)
+			{
+			offset[i]=region>0?(unsigned int)(rand())%imageSize[i]:0U;
+			size[i]=region>0?1U+(unsigned int)(rand())%(imageSize[i]-offset[i]):imageSize[i];
+			}
+		Images::RGBImage pixels=reader->readRegion(offset,size);
+		for(unsigned int y=0;y<size[1];++y)
+			for(unsigned int x=0;x<size[0];++x)
+				for(int i=0;i<3;++i)
+					if(pixels.getPixel(x,y)[i]!=getPixel(offset[0]+x,imageSize[1]-1-(offset[1]+y),i))
+						++numMismatches;
+		}
+	
+	/* Decode the entire image with the non-region reader: */
+	IO::FilePtr file=IO::openFile(imageFileName);
+	Images::RGBImage image=Images::readTIFFImage(imageFileName,*file);
+	for(unsigned int y=0;y<imageSize[1];++y)
+		for(unsigned int x=0;x<imageSize[0];++x)
+			for(int i=0;i<3;++i)
+				if(image.getPixel(x,y)[i]!=getPixel(x,imageSize[1]-1-y,i))
+					++numMismatches;
+	
+	return numMismatches;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Create a temporary directory for the test images: */
+	char tempDirName[]="/tmp/TIFFImageReaderTestXXXXXX";
+	if(mkdtemp(tempDirName)==0)
+		{
+		std::cerr<<"Unable to create temporary directory"<<std::endl;
+		return 1;
+		}
+	
+	struct TestImage // Structure describing a test image's layout
+		{
+		/* Elements: */
+		public:
+		const char* name; // Image file name inside the temporary directory
+		bool tiled; // Flag whether the image is tiled
+		unsigned int layout[2]; // Rows per strip, or tile width and height
+		int compression; // TIFF compression scheme
+		};
+	static const TestImage testImages[]=
+		{
+		{"Strips1.tif",false,{1,0},COMPRESSION_LZW},
+		{"Strips7.tif",false,{7,0},COMPRESSION_NONE},
+		{"SingleStrip.tiff",false,{imageSize[1],0},COMPRESSION_DEFLATE},
+		{"Tiles32x32.tif",true,{32,32},COMPRESSION_NONE},
+		{"Tiles64x16.tif",true,{64,16},COMPRESSION_LZW},
+		{"Tiles64x48.tif",true,{64,48},COMPRESSION_DEFLATE}
+		};
+	const int numTestImages=sizeof(testImages)/sizeof(testImages[0]);
+	
+	int result=0;
+	srand(1);
+	for(int i=0;i<numTestImages;++i)
+		{
+		std::string imageFileName=tempDirName;
+		imageFileName.push_back('/');
+		imageFileName.append(testImages[i].name);
+		try
+			{
+			if(testImages[i].tiled)
+				writeTiledImage(imageFileName.c_str(),testImages[i].layout[0],testImages[i].layout[1],testImages[i].compression);
+			else
+				writeStripedImage(imageFileName.c_str(),testImages[i].layout[0],testImages[i].compression);
+			size_t numMismatches=checkImage(imageFileName.c_str(),200);
+			std::cout<<testImages[i].name<<": "<<numMismatches<<" mismatching samples"<<std::endl;
+			if(numMismatches!=0)
+				result=1;
+			}
+		catch(std::runtime_error err)
+			{
+			std::cerr<<testImages[i].name<<": Caught exception "<<err.what()<<std::endl;
+			result=1;
+			}
+		unlink(imageFileName.c_str());
+		}
+	
+	rmdir(tempDirName);
+	return result;
+	}
+
+#else
+
+int main(int argc,char* argv[])
+	{
+	std::cerr<<"TIFF support is disabled in the Images library"<<std::endl;
+	return 1;
+	}
+
+#endif
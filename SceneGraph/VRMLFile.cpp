@@ -23,8 +23,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/VRMLFile.h>
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <vector>
+#include <Misc/SizedTypes.h>
 #include <Misc/StringPrintf.h>
 #include <Misc/ThrowStdErr.h>
+#include <IO/OpenFile.h>
+#include <IO/MemMappedFile.h>
+#include <IO/VariableMemoryFile.h>
 #include <Geometry/ComponentArray.h>
 #include <Geometry/Point.h>
 #include <Geometry/Vector.h>
@@ -37,15 +47,86 @@ namespace SceneGraph {
 
 namespace {
 
+/***************************************
+Helper functions for binary cache files:
+***************************************/
+
+const char cacheMagic[16]="VruiSGCache"; // Identifier at the beginning of binary cache files
+const Misc::UInt32 cacheVersion=2; // Version number of the binary cache file format
+const Misc::UInt32 cacheByteOrderMark=0x01020304U; // Marker to reject cache files written on machines with different endianness
+
+enum CacheTag // Enumerated type for tags structuring the node graph in binary cache files
+	{
+	CACHE_END=0,CACHE_FIELD,CACHE_ROUTE,CACHE_USE,CACHE_NODE
+	};
+
+inline void writeCacheString(const std::string& string,IO::File& file)
+	{
+	file.write<Misc::UInt32>(Misc::UInt32(string.size()));
+	file.writeRaw(string.data(),string.size());
+	}
+
+inline std::string readCacheString(IO::File& file)
+	{
+	Misc::UInt32 length=file.read<Misc::UInt32>();
+	std::vector<char> buffer(length);
+	if(length>0)
+		file.readRaw(&buffer[0],length);
+	return std::string(buffer.begin(),buffer.end());
+	}
+
+std::string getDefaultCacheDirectory(void)
+	{
+	/* Follow the XDG base directory convention: */
+	std::string result;
+	if(getenv("XDG_CACHE_HOME")!=0&&getenv("XDG_CACHE_HOME")[0]=='/')
+		result=getenv("XDG_CACHE_HOME");
+	else if(getenv("HOME")!=0)
+		{
+		result=getenv("HOME");
+		result.append("/.cache");
+		}
+	else
+		return result;
+	result.append("/SceneGraph");
+	return result;
+	}
+
+bool createCacheDirectory(const std::string& directory)
+	{
+	/* Create all missing path components, accessible only by the current user: */
+	for(std::string::size_type slash=directory.find('/',1);;slash=directory.find('/',slash+1))
+		{
+		std::string prefix(directory,0,slash);
+		struct stat dirStat;
+		if(stat(prefix.c_str(),&dirStat)!=0&&mkdir(prefix.c_str(),0700)!=0)
+			return false;
+		if(slash==std::string::npos)
+			break;
+		}
+	return true;
+	}
+
+std::string getCacheFileName(const std::string& directory,const std::string& absoluteSourceName)
+	{
+	/* Combine the source file's base name with a 64-bit FNV-1a hash of its absolute path: */
+	Misc::UInt64 hash=14695981039346656037ULL;
+	for(std::string::const_iterator snIt=absoluteSourceName.begin();snIt!=absoluteSourceName.end();++snIt)
+		{
+		hash^=Misc::UInt64((unsigned char)(*snIt));
+		hash*=1099511628211ULL;
+		}
+	std::string::size_type slash=absoluteSourceName.rfind('/');
+	std::string baseName=slash!=std::string::npos?std::string(absoluteSourceName,slash+1):absoluteSourceName;
+	return Misc::stringPrintf("%s/%s-%016llx.cache",directory.c_str(),baseName.c_str(),(unsigned long long)hash);
+	}
+
 /*************************************************************************
-Helper function to parse route statements (will move into VRMLFile class):
+Helper functions to parse route statements (will move into VRMLFile class):
 *************************************************************************/
 
-void parseRoute(VRMLFile& vrmlFile)
+void createRoute(VRMLFile& vrmlFile,const char* source,const char* sink)
 	{
-	/* Read the event source name: */
-	const char* source=vrmlFile.readNextToken();
-	
 	/* Split the event source into node name and field name: */
 	const char* periodPtr=0;
 	for(const char* sPtr=source;*sPtr!='\0';++sPtr)
@@ -70,14 +151,6 @@ void parseRoute(VRMLFile& vrmlFile)
 		throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("unknown field \"%s\" in event source",periodPtr+1));
 		}
 	
-	/* Check the TO keyword: */
-	vrmlFile.readNextToken();
-	if(!vrmlFile.isToken("TO"))
-		throw VRMLFile::ParseError(vrmlFile,"missing TO keyword in route definition");
-		
-	/* Read the event sink name: */
-	const char* sink=vrmlFile.readNextToken();
-	
 	/* Split the event sink into node name and field name: */
 	periodPtr=0;
 	for(const char* sPtr=sink;*sPtr!='\0';++sPtr)
@@ -114,6 +187,32 @@ void parseRoute(VRMLFile& vrmlFile)
 		}
 	}
 
+void parseRoute(VRMLFile& vrmlFile)
+	{
+	/* Read the event source name: */
+	std::string source=vrmlFile.readNextToken();
+	
+	/* Check the TO keyword: */
+	vrmlFile.readNextToken();
+	if(!vrmlFile.isToken("TO"))
+		throw VRMLFile::ParseError(vrmlFile,"missing TO keyword in route definition");
+		
+	/* Read the event sink name: */
+	std::string sink=vrmlFile.readNextToken();
+	
+	/* Record the route in the binary cache: */
+	IO::File* cacheSink=vrmlFile.getCacheSink();
+	if(cacheSink!=0)
+		{
+		cacheSink->write<Misc::UInt8>(CACHE_ROUTE);
+		writeCacheString(source,*cacheSink);
+		writeCacheString(sink,*cacheSink);
+		}
+	
+	/* Create the route: */
+	createRoute(vrmlFile,source.c_str(),sink.c_str());
+	}
+
 /********************************************************************
 Helper functions to parse floating-point values and component arrays:
 ********************************************************************/
@@ -333,6 +432,73 @@ class ValueParser<TexCoord>
 		}
 	};
 
+NodePointer readCachedNode(VRMLFile& vrmlFile)
+	{
+	IO::File& cacheSource=*vrmlFile.getCacheSource();
+	NodePointer result;
+	
+	/* Read the statement tag: */
+	int tag=cacheSource.read<Misc::UInt8>();
+	if(tag==CACHE_ROUTE)
+		{
+		/* Create a route: */
+		std::string source=readCacheString(cacheSource);
+		std::string sink=readCacheString(cacheSource);
+		createRoute(vrmlFile,source.c_str(),sink.c_str());
+		}
+	else if(tag==CACHE_USE)
+		{
+		/* Retrieve a named node from the VRML file: */
+		result=vrmlFile.useNode(readCacheString(cacheSource).c_str());
+		}
+	else if(tag==CACHE_NODE)
+		{
+		/* Read the optional node name and the node type name: */
+		std::string defName=readCacheString(cacheSource);
+		std::string nodeType=readCacheString(cacheSource);
+		
+		if(!nodeType.empty())
+			{
+			/* Create the result node: */
+			if((result=vrmlFile.createNode(nodeType.c_str()))==0)
+				throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("Unknown node type %s",nodeType.c_str()));
+			
+			/* Read fields and routes until the end of the node: */
+			while((tag=cacheSource.read<Misc::UInt8>())!=CACHE_END)
+				{
+				if(tag==CACHE_ROUTE)
+					{
+					/* Create a route: */
+					std::string source=readCacheString(cacheSource);
+					std::string sink=readCacheString(cacheSource);
+					createRoute(vrmlFile,source.c_str(),sink.c_str());
+					}
+				else if(tag==CACHE_FIELD)
+					{
+					/* Read a field value: */
+					std::string fieldName=readCacheString(cacheSource);
+					result->parseField(fieldName.c_str(),vrmlFile);
+					}
+				else
+					throw VRMLFile::ParseError(vrmlFile,"Corrupted binary cache file");
+				}
+			
+			/* Finalize the node: */
+			vrmlFile.finalizeNode(result);
+			}
+		
+		if(!defName.empty())
+			{
+			/* Store the named node in the VRML file: */
+			vrmlFile.defineNode(defName.c_str(),result);
+			}
+		}
+	else
+		throw VRMLFile::ParseError(vrmlFile,"Corrupted binary cache file");
+	
+	return result;
+	}
+
 template <>
 class ValueParser<NodePointer>
 	{
@@ -340,6 +506,11 @@ class ValueParser<NodePointer>
 	public:
 	static NodePointer parseValue(VRMLFile& vrmlFile)
 		{
+		/* Read the node from the binary cache file if there is one: */
+		if(vrmlFile.isReadingCache())
+			return readCachedNode(vrmlFile);
+		
+		IO::File* cacheSink=vrmlFile.getCacheSink();
 		NodePointer result;
 		
 		/* Read the node type name: */
@@ -352,7 +523,13 @@ class ValueParser<NodePointer>
 		else if(vrmlFile.isToken("USE"))
 			{
 			/* Retrieve a named node from the VRML file: */
-			result=vrmlFile.useNode(vrmlFile.readNextToken());
+			vrmlFile.readNextToken();
+			if(cacheSink!=0)
+				{
+				cacheSink->write<Misc::UInt8>(CACHE_USE);
+				writeCacheString(vrmlFile.getToken(),*cacheSink);
+				}
+			result=vrmlFile.useNode(vrmlFile.getToken());
 			}
 		else
 			{
@@ -367,7 +544,16 @@ class ValueParser<NodePointer>
 				vrmlFile.readNextToken();
 				}
 			
-			if(!vrmlFile.isToken("NULL"))
+			/* Record the node header in the binary cache: */
+			bool isNull=vrmlFile.isToken("NULL");
+			if(cacheSink!=0)
+				{
+				cacheSink->write<Misc::UInt8>(CACHE_NODE);
+				writeCacheString(defName,*cacheSink);
+				writeCacheString(isNull?"":vrmlFile.getToken(),*cacheSink);
+				}
+			
+			if(!isNull)
 				{
 				/* Create the result node: */
 				if((result=vrmlFile.createNode(vrmlFile.getToken()))==0)
@@ -389,6 +575,13 @@ class ValueParser<NodePointer>
 						}
 					else
 						{
+						/* Record the field name in the binary cache: */
+						if(cacheSink!=0)
+							{
+							cacheSink->write<Misc::UInt8>(CACHE_FIELD);
+							writeCacheString(vrmlFile.getToken(),*cacheSink);
+							}
+						
 						/* Parse a field value: */
 						result->parseField(vrmlFile.getToken(),vrmlFile);
 						}
@@ -398,9 +591,11 @@ class ValueParser<NodePointer>
 				if(vrmlFile.eof())
 					throw VRMLFile::ParseError(vrmlFile,"Missing closing brace in node definition");
 				vrmlFile.readNextToken();
+				if(cacheSink!=0)
+					cacheSink->write<Misc::UInt8>(CACHE_END);
 				
 				/* Finalize the node: */
-				result->update();
+				vrmlFile.finalizeNode(result);
 				}
 			
 			if(!defName.empty())
@@ -414,6 +609,92 @@ class ValueParser<NodePointer>
 		}
 	};
 
+/******************************************************************
+Templatized helper class to read and write values in binary caches:
+******************************************************************/
+
+template <class ValueParam>
+class ValueCoder // Generic class for values that are stored in their in-memory representation
+	{
+	/* Methods: */
+	public:
+	static void writeValue(const ValueParam& value,IO::File& file)
+		{
+		file.writeRaw(&value,sizeof(ValueParam));
+		}
+	static ValueParam readValue(IO::File& file)
+		{
+		ValueParam result;
+		file.readRaw(&result,sizeof(ValueParam));
+		return result;
+		}
+	static void writeValues(const std::vector<ValueParam>& values,IO::File& file)
+		{
+		/* Write the entire array in one go: */
+		if(!values.empty())
+			file.writeRaw(&values[0],values.size()*sizeof(ValueParam));
+		}
+	static void readValues(std::vector<ValueParam>& values,size_t numValues,IO::File& file)
+		{
+		/* Read the entire array in one go: */
+		values.resize(numValues);
+		if(numValues>0)
+			file.readRaw(&values[0],numValues*sizeof(ValueParam));
+		}
+	};
+
+template <>
+class ValueCoder<bool>
+	{
+	/* Methods: */
+	public:
+	static void writeValue(bool value,IO::File& file)
+		{
+		file.write<Misc::UInt8>(value?1:0);
+		}
+	static bool readValue(IO::File& file)
+		{
+		return file.read<Misc::UInt8>()!=0;
+		}
+	static void writeValues(const std::vector<bool>& values,IO::File& file)
+		{
+		for(std::vector<bool>::const_iterator vIt=values.begin();vIt!=values.end();++vIt)
+			writeValue(*vIt,file);
+		}
+	static void readValues(std::vector<bool>& values,size_t numValues,IO::File& file)
+		{
+		values.reserve(numValues);
+		for(size_t i=0;i<numValues;++i)
+			values.push_back(readValue(file));
+		}
+	};
+
+template <>
+class ValueCoder<std::string>
+	{
+	/* Methods: */
+	public:
+	static void writeValue(const std::string& value,IO::File& file)
+		{
+		writeCacheString(value,file);
+		}
+	static std::string readValue(IO::File& file)
+		{
+		return readCacheString(file);
+		}
+	static void writeValues(const std::vector<std::string>& values,IO::File& file)
+		{
+		for(std::vector<std::string>::const_iterator vIt=values.begin();vIt!=values.end();++vIt)
+			writeValue(*vIt,file);
+		}
+	static void readValues(std::vector<std::string>& values,size_t numValues,IO::File& file)
+		{
+		values.reserve(numValues);
+		for(size_t i=0;i<numValues;++i)
+			values.push_back(readValue(file));
+		}
+	};
+
 /***********************************************************
 Templatized helper class to parse fields from token sources:
 ***********************************************************/
@@ -434,8 +715,20 @@ class FieldParser<SF<ValueParam> >
 	public:
 	static void parseField(SF<ValueParam>& field,VRMLFile& vrmlFile)
 		{
-		/* Just read the field's value: */
-		field.setValue(ValueParser<ValueParam>::parseValue(vrmlFile));
+		if(vrmlFile.isReadingCache())
+			{
+			/* Read the field's value from the binary cache file: */
+			field.setValue(ValueCoder<ValueParam>::readValue(*vrmlFile.getCacheSource()));
+			}
+		else
+			{
+			/* Just read the field's value: */
+			field.setValue(ValueParser<ValueParam>::parseValue(vrmlFile));
+			
+			/* Record the field's value in the binary cache: */
+			if(vrmlFile.getCacheSink()!=0)
+				ValueCoder<ValueParam>::writeValue(field.getValue(),*vrmlFile.getCacheSink());
+			}
 		}
 	};
 
@@ -453,6 +746,15 @@ class FieldParser<MF<ValueParam> >
 		/* Clear the field: */
 		field.clearValues();
 		
+		if(vrmlFile.isReadingCache())
+			{
+			/* Read the field's values from the binary cache file: */
+			IO::File& cacheSource=*vrmlFile.getCacheSource();
+			size_t numValues=cacheSource.read<Misc::UInt32>();
+			ValueCoder<ValueParam>::readValues(field.getValues(),numValues,cacheSource);
+			return;
+			}
+		
 		/* Check for opening bracket: */
 		if(vrmlFile.peekc()=='[')
 			{
@@ -476,6 +778,40 @@ class FieldParser<MF<ValueParam> >
 			/* Read a single value: */
 			field.appendValue(ValueParser<ValueParam>::parseValue(vrmlFile));
 			}
+		
+		/* Record the field's values in the binary cache: */
+		IO::File* cacheSink=vrmlFile.getCacheSink();
+		if(cacheSink!=0)
+			{
+			cacheSink->write<Misc::UInt32>(Misc::UInt32(field.getNumValues()));
+			ValueCoder<ValueParam>::writeValues(field.getValues(),*cacheSink);
+			}
+		}
+	};
+
+/********************************************************
+Specializations for node fields, which record themselves:
+********************************************************/
+
+template <>
+class FieldParser<SFNode>
+	{
+	/* Methods: */
+	public:
+	static void parseField(SFNode& field,VRMLFile& vrmlFile)
+		{
+		vrmlFile.parseSFNode(field);
+		}
+	};
+
+template <>
+class FieldParser<MFNode>
+	{
+	/* Methods: */
+	public:
+	static void parseField(MFNode& field,VRMLFile& vrmlFile)
+		{
+		vrmlFile.parseMFNode(field);
 		}
 	};
 
@@ -490,36 +826,129 @@ VRMLFile::ParseError::ParseError(const VRMLFile& vrmlFile,std::string error)
 	{
 	}
 
+/*********************************
+Static elements of class VRMLFile:
+*********************************/
+
+bool VRMLFile::useBinaryCaches=false;
+std::string VRMLFile::cacheDirectory;
+
 /*************************
 Methods of class VRMLFile:
 *************************/
 
+void VRMLFile::openCache(void)
+	{
+	/* Only cache local files; in a cluster, slaves cannot access the master's cache files: */
+	struct stat sourceStat;
+	if(!useBinaryCaches||multiplexer!=0||stat(sourceUrl.c_str(),&sourceStat)!=0||!S_ISREG(sourceStat.st_mode))
+		return;
+	
+	/* Identify the source file by its absolute path: */
+	char* absoluteName=realpath(sourceUrl.c_str(),0);
+	if(absoluteName==0)
+		return;
+	std::string absoluteSourceName=absoluteName;
+	free(absoluteName);
+	
+	/* Locate the cache file in the per-user cache directory: */
+	std::string directory=cacheDirectory.empty()?getDefaultCacheDirectory():cacheDirectory;
+	if(directory.empty()||!createCacheDirectory(directory))
+		return;
+	cacheFileName=getCacheFileName(directory,absoluteSourceName);
+	
+	try
+		{
+		/* Open the cache file and check its header against the source file's path, size, and modification time: */
+		IO::FilePtr cache=new IO::MemMappedFile(cacheFileName.c_str());
+		char magic[sizeof(cacheMagic)];
+		cache->readRaw(magic,sizeof(magic));
+		bool valid=memcmp(magic,cacheMagic,sizeof(cacheMagic))==0;
+		valid=valid&&cache->read<Misc::UInt32>()==cacheVersion;
+		valid=valid&&cache->read<Misc::UInt32>()==cacheByteOrderMark;
+		valid=valid&&cache->read<Misc::UInt32>()==sizeof(Scalar);
+		valid=valid&&readCacheString(*cache)==absoluteSourceName;
+		valid=valid&&cache->read<Misc::SInt64>()==Misc::SInt64(sourceStat.st_size);
+		valid=valid&&cache->read<Misc::SInt64>()==Misc::SInt64(sourceStat.st_mtime);
+		if(valid)
+			{
+			cacheSource=cache;
+			return;
+			}
+		}
+	catch(std::runtime_error err)
+		{
+		/* Cache file does not exist or is unreadable; fall through to record a new one: */
+		}
+	
+	/* Prepare to record a new cache file while parsing the VRML file: */
+	cacheSink=new IO::VariableMemoryFile;
+	cacheSink->writeRaw(cacheMagic,sizeof(cacheMagic));
+	cacheSink->write<Misc::UInt32>(cacheVersion);
+	cacheSink->write<Misc::UInt32>(cacheByteOrderMark);
+	cacheSink->write<Misc::UInt32>(sizeof(Scalar));
+	writeCacheString(absoluteSourceName,*cacheSink);
+	cacheSink->write<Misc::SInt64>(Misc::SInt64(sourceStat.st_size));
+	cacheSink->write<Misc::SInt64>(Misc::SInt64(sourceStat.st_mtime));
+	}
+
+void VRMLFile::writeCache(void)
+	{
+	/* Write the cache into a temporary file first so that concurrent readers never see a partial cache: */
+	std::string tempFileName=Misc::stringPrintf("%s.%d",cacheFileName.c_str(),int(getpid()));
+	try
+		{
+		IO::FilePtr cache=IO::openFile(tempFileName.c_str(),IO::File::WriteOnly);
+		cacheSink->writeToSink(*cache);
+		cache->flush();
+		cache=0;
+		if(rename(tempFileName.c_str(),cacheFileName.c_str())!=0)
+			unlink(tempFileName.c_str());
+		}
+	catch(std::runtime_error err)
+		{
+		/* Caching is optional; ignore the error and remove any partial file: */
+		unlink(tempFileName.c_str());
+		}
+	
+	delete cacheSink;
+	cacheSink=0;
+	}
+
 VRMLFile::VRMLFile(std::string sSourceUrl,IO::FilePtr sSource,NodeCreator& sNodeCreator,Cluster::Multiplexer* sMultiplexer)
 	:IO::TokenSource(sSource),
 	 sourceUrl(sSourceUrl),
 	 nodeCreator(sNodeCreator),
 	 multiplexer(sMultiplexer),
+	 inBackground(false),deferredUpdates(0),
 	 nodeMap(101),
-	 currentLine(1)
+	 currentLine(1),
+	 cacheSink(0)
 	{
 	/* Initialize the token source: */
 	setWhitespace(',',true); // Comma is treated as whitespace
 	setPunctuation("#[]{}\n"); // Newline is treated as punctuation to count lines
 	setQuotes("\"\'");
 	
-	/* Check the VRML file header: */
-	IO::TokenSource::readNextToken();
-	if(!isToken("#"))
-		Misc::throwStdErr("VRMLFile: %s is not a valid VRML 2.0 file",sourceUrl.c_str());
-	IO::TokenSource::readNextToken();
-	if(!isToken("VRML"))
-		Misc::throwStdErr("VRMLFile: %s is not a valid VRML 2.0 file",sourceUrl.c_str());
-	IO::TokenSource::readNextToken();
-	if(!isToken("V2.0"))
-		Misc::throwStdErr("VRMLFile: %s is not a valid VRML 2.0 file",sourceUrl.c_str());
-	IO::TokenSource::readNextToken();
-	if(!isToken("utf8"))
-		Misc::throwStdErr("VRMLFile: %s is not a valid VRML 2.0 file",sourceUrl.c_str());
+	/* Check for a valid binary cache file: */
+	openCache();
+	
+	if(cacheSource==0)
+		{
+		/* Check the VRML file header: */
+		IO::TokenSource::readNextToken();
+		if(!isToken("#"))
+			Misc::throwStdErr("VRMLFile: %s is not a valid VRML 2.0 file",sourceUrl.c_str());
+		IO::TokenSource::readNextToken();
+		if(!isToken("VRML"))
+			Misc::throwStdErr("VRMLFile: %s is not a valid VRML 2.0 file",sourceUrl.c_str());
+		IO::TokenSource::readNextToken();
+		if(!isToken("V2.0"))
+			Misc::throwStdErr("VRMLFile: %s is not a valid VRML 2.0 file",sourceUrl.c_str());
+		IO::TokenSource::readNextToken();
+		if(!isToken("utf8"))
+			Misc::throwStdErr("VRMLFile: %s is not a valid VRML 2.0 file",sourceUrl.c_str());
+		}
 	
 	/* Extract the URL prefix: */
 	urlPrefix=sourceUrl.begin();
@@ -528,15 +957,51 @@ VRMLFile::VRMLFile(std::string sSourceUrl,IO::FilePtr sSource,NodeCreator& sNode
 			urlPrefix=suIt+1;
 	}
 
+VRMLFile::~VRMLFile(void)
+	{
+	/* Discard an incomplete cache recording: */
+	delete cacheSink;
+	}
+
+void VRMLFile::setUseBinaryCaches(bool newUseBinaryCaches)
+	{
+	useBinaryCaches=newUseBinaryCaches;
+	}
+
+void VRMLFile::setCacheDirectory(const std::string& newCacheDirectory)
+	{
+	cacheDirectory=newCacheDirectory;
+	}
+
 void VRMLFile::parse(GroupNodePointer root)
 	{
-	/* Read nodes until end of file: */
-	while(!eof())
+	if(cacheSource!=0)
 		{
-		SF<GraphNodePointer> node;
-		parseSFNode(node);
-		if(node.getValue()!=0)
-			root->children.appendValue(node.getValue());
+		/* Read nodes from the binary cache file: */
+		while(readCachedListItem())
+			{
+			SF<GraphNodePointer> node;
+			parseSFNode(node);
+			if(node.getValue()!=0)
+				root->children.appendValue(node.getValue());
+			}
+		}
+	else
+		{
+		/* Read nodes until end of file: */
+		while(!eof())
+			{
+			writeCachedListItem(true);
+			SF<GraphNodePointer> node;
+			parseSFNode(node);
+			if(node.getValue()!=0)
+				root->children.appendValue(node.getValue());
+			}
+		writeCachedListItem(false);
+		
+		/* Write the recorded binary cache file: */
+		if(cacheSink!=0)
+			writeCache();
 		}
 	}
 
@@ -577,6 +1042,22 @@ NodePointer VRMLFile::useNode(const char* nodeName)
 	return nIt->getDest();
 	}
 
+IO::File* VRMLFile::getCacheSink(void)
+	{
+	return cacheSink;
+	}
+
+bool VRMLFile::readCachedListItem(void)
+	{
+	return cacheSource->read<Misc::UInt8>()!=0;
+	}
+
+void VRMLFile::writeCachedListItem(bool another)
+	{
+	if(cacheSink!=0)
+		cacheSink->write<Misc::UInt8>(another?1:0);
+	}
+
 std::string VRMLFile::getFullUrl(std::string localUrl) const
 	{
 	/* Check if the local URL is already fully qualified: */
@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define SCENEGRAPH_VRMLFILE_INCLUDED
 
 #include <string>
+#include <vector>
 #include <stdexcept>
 #include <Misc/StringHashFunctions.h>
 #include <Misc/HashTable.h>
@@ -37,6 +38,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 namespace Cluster {
 class Multiplexer;
 }
+namespace IO {
+class VariableMemoryFile;
+}
 namespace SceneGraph {
 class NodeCreator;
 }
@@ -61,12 +65,19 @@ class VRMLFile:public IO::TokenSource
 	
 	/* Elements: */
 	private:
+	static bool useBinaryCaches; // Flag whether to read and write binary cache files for local VRML files; disabled by default
+	static std::string cacheDirectory; // Directory holding binary cache files; empty to use the per-user default cache directory
 	std::string sourceUrl; // Full URL of the VRML file
 	std::string::const_iterator urlPrefix; // Prefix for relative URLs
 	NodeCreator& nodeCreator; // Reference to the node creator
 	Cluster::Multiplexer* multiplexer; // Pointer to a multicast pipe multiplexer when parsing VRML files in a cluster environment
+	bool inBackground; // Flag whether the file is being parsed by a background loader thread
+	std::vector<NodePointer>* deferredUpdates; // List receiving parsed nodes whose update methods must be called later by the main thread, or null to update nodes immediately
 	NodeMap nodeMap; // Map of named nodes
 	size_t currentLine; // Number of currently processed line
+	std::string cacheFileName; // Name of the binary cache file associated with the VRML file; empty if caching is disabled
+	IO::FilePtr cacheSource; // Binary cache file from which the node graph is read instead of parsing the VRML file, or null
+	IO::VariableMemoryFile* cacheSink; // In-memory file into which the parsed node graph is recorded while parsing the VRML file, or null
 	
 	/* Private methods: */
 	void skipExtendedWhitespace(void) // Skips over "extended" whitespace, i.e., line comments and newlines
@@ -97,9 +108,17 @@ class VRMLFile:public IO::TokenSource
 			}
 		}
 	
+	void openCache(void); // Opens a valid binary cache file for the VRML file, or prepares to record one
+	void writeCache(void); // Writes the recorded binary cache file into the cache directory
+	
 	/* Constructors and destructors: */
 	public:
-	VRMLFile(std::string sSourceUrl,IO::FilePtr sSource,NodeCreator& sNodeCreator,Cluster::Multiplexer* sMultiplexer =0); // Creates a VRML parser for the given character source and node creator
+	VRMLFile(std::string sSourceUrl,IO::FilePtr sSource,NodeCreator& sNodeCreator,Cluster::Multiplexer* sMultiplexer =0); // Creates a VRML parser for the given character source and node creator; uses a binary cache file instead if a valid one exists
+	~VRMLFile(void);
+	
+	/* Methods: */
+	static void setUseBinaryCaches(bool newUseBinaryCaches); // Enables or disables binary cache files for subsequently opened VRML files
+	static void setCacheDirectory(const std::string& newCacheDirectory); // Sets the directory holding binary cache files; an empty name selects $XDG_CACHE_HOME/SceneGraph or $HOME/.cache/SceneGraph
 	
 	/* Overloaded methods from IO::TokenSource: */
 	bool eof(void)
@@ -145,8 +164,23 @@ class VRMLFile:public IO::TokenSource
 		/* Clear the field: */
 		field.clearValues();
 		
-		/* Check for opening bracket: */
-		if(peekc()=='[')
+		if(cacheSource!=0)
+			{
+			/* Read a list of values from the binary cache file: */
+			while(readCachedListItem())
+				{
+				/* Read a base-class node: */
+				NodePointer node=parseValue<NodePointer>();
+				
+				/* Check if the node type matches: */
+				if(node!=0&&dynamic_cast<typename NodePointerParam::Target*>(node.getPointer())==0)
+					throw ParseError(*this,"Mismatching node type");
+				
+				/* Set the field's node pointer: */
+				field.appendValue(node);
+				}
+			}
+		else if(peekc()=='[')
 			{
 			/* Skip the opening bracket: */
 			readNextToken();
@@ -155,6 +189,7 @@ class VRMLFile:public IO::TokenSource
 			while(!eof()&&peekc()!=']')
 				{
 				/* Read a base-class node: */
+				writeCachedListItem(true);
 				NodePointer node=parseValue<NodePointer>();
 				
 				/* Check if the node type matches: */
@@ -164,6 +199,7 @@ class VRMLFile:public IO::TokenSource
 				/* Set the field's node pointer: */
 				field.appendValue(node);
 				}
+			writeCachedListItem(false);
 			
 			/* Skip the closing bracket: */
 			if(eof())
@@ -173,7 +209,9 @@ class VRMLFile:public IO::TokenSource
 		else
 			{
 			/* Read a base-class node: */
+			writeCachedListItem(true);
 			NodePointer node=parseValue<NodePointer>();
+			writeCachedListItem(false);
 			
 			/* Check if the node type matches: */
 			if(node!=0&&dynamic_cast<typename NodePointerParam::Target*>(node.getPointer())==0)
@@ -191,10 +229,46 @@ class VRMLFile:public IO::TokenSource
 		{
 		return multiplexer;
 		}
+	bool isInBackground(void) const // Returns true if the file is being parsed by a background loader thread
+		{
+		return inBackground;
+		}
+	void setInBackground(bool newInBackground) // Marks the file as being parsed by a background loader thread
+		{
+		inBackground=newInBackground;
+		}
+	std::vector<NodePointer>* getDeferredUpdates(void) const // Returns the list receiving parsed nodes whose updates are deferred, or null
+		{
+		return deferredUpdates;
+		}
+	void setDeferredUpdates(std::vector<NodePointer>* newDeferredUpdates) // Defers the update methods of all parsed nodes by appending the nodes to the given list in parse order; updates nodes immediately if null
+		{
+		deferredUpdates=newDeferredUpdates;
+		}
+	void finalizeNode(NodePointer node) // Updates a completely parsed node, or defers its update
+		{
+		if(deferredUpdates!=0)
+			deferredUpdates->push_back(node);
+		else
+			node->update();
+		}
 	NodePointer createNode(const char* nodeType); // Creates a new node of the given type
 	void defineNode(const char* nodeName,NodePointer node); // Stores the given node under the given name, for future instantiation
 	NodePointer useNode(const char* nodeName); // Retrieves the node most recently stored under the given name
 	std::string getFullUrl(std::string localUrl) const; // Converts a file-relative URL into a fully-qualified URL
+	
+	/* Methods called while reading or recording binary cache files: */
+	bool isReadingCache(void) const // Returns true if the node graph is read from a binary cache file
+		{
+		return cacheSource!=0;
+		}
+	IO::File* getCacheSource(void) // Returns the binary cache file being read, or null
+		{
+		return cacheSource.getPointer();
+		}
+	IO::File* getCacheSink(void); // Returns the file into which the binary cache is recorded, or null
+	bool readCachedListItem(void); // Returns true if another item of a node list follows in the binary cache file
+	void writeCachedListItem(bool another); // Records whether another item of a node list follows, if a binary cache is being recorded
 	};
 
 }
@@ -23,7 +23,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define THREADS_CONFIG_INCLUDED
 
 #define THREADS_CONFIG_HAVE_BUILTIN_TLS 1
-#define THREADS_CONFIG_HAVE_BUILTIN_ATOMICS 1
+#define THREADS_CONFIG_HAVE_BUILTIN_ATOMICS 0
 #define THREADS_CONFIG_HAVE_SPINLOCKS 1
 
 #endif
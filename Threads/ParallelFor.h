@@ -0,0 +1,160 @@
+/***********************************************************************
+ParallelFor - Helper functions to split a loop over an index range into
+contiguous sub-ranges that are processed by a team of temporary threads.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_PARALLELFOR_INCLUDED
+#define THREADS_PARALLELFOR_INCLUDED
+
+#include <stddef.h>
+#include <unistd.h>
+#include <string>
+#include <stdexcept>
+#include <Threads/Thread.h>
+
+namespace Threads {
+
+namespace Internal {
+
+template <class RangeFunctorParam>
+class ParallelForRange // Helper class to call a range functor from a thread
+	{
+	/* Elements: */
+	public:
+	RangeFunctorParam* functor; // Pointer to the functor shared by all sub-ranges
+	size_t begin,end; // Sub-range of indices to be processed
+	bool failed; // Flag whether the functor threw an exception while processing the sub-range in a helper thread
+	std::string error; // Message of the exception thrown by the functor
+
+	/* Constructors and destructors: */
+	ParallelForRange(void)
+		:failed(false)
+		{
+		}
+
+	/* Methods: */
+	void* run(void) // Thread method; exceptions must not escape a thread's entry point, so they are recorded to be rethrown by the calling thread
+		{
+		try
+			{
+			(*functor)(begin,end);
+			}
+		catch(std::runtime_error err)
+			{
+			failed=true;
+			error=err.what();
+			}
+		catch(...)
+			{
+			failed=true;
+			error="Threads::parallelFor: Unknown exception in loop body";
+			}
+		return 0;
+		}
+	};
+
+}
+
+inline unsigned int getNumParallelForThreads(void) // Returns the default maximum number of threads used by parallel loops
+	{
+	long numProcessors=sysconf(_SC_NPROCESSORS_ONLN);
+	return numProcessors>1?(unsigned int)numProcessors:1U;
+	}
+
+/***********************************************************************
+Calls functor(rangeBegin,rangeEnd) for a set of disjoint sub-ranges
+covering [begin, end), using at most maxNumThreads threads (including
+the calling thread; 0 means one per online processor) and not splitting
+the range into pieces smaller than minRangeSize. The functor is shared
+between all threads and must be safe to call concurrently on disjoint
+sub-ranges. The function returns after all sub-ranges are processed.
+If the functor throws in the calling thread, the exception propagates
+unchanged once all helper threads have finished; if it throws in a
+helper thread, it is rethrown as std::runtime_error.
+***********************************************************************/
+
+template <class RangeFunctorParam>
+inline void parallelFor(size_t begin,size_t end,RangeFunctorParam& functor,size_t minRangeSize =1024,unsigned int maxNumThreads =0)
+	{
+	if(end<=begin)
+		return;
+
+	/* Determine the number of threads to use: */
+	if(maxNumThreads==0)
+		maxNumThreads=getNumParallelForThreads();
+	if(minRangeSize==0)
+		minRangeSize=1;
+	size_t numRanges=(end-begin+minRangeSize-1)/minRangeSize;
+	if(numRanges>size_t(maxNumThreads))
+		numRanges=size_t(maxNumThreads);
+
+	if(numRanges<=1)
+		{
+		/* Process the entire range in the calling thread: */
+		functor(begin,end);
+		return;
+		}
+
+	/* Split the range into approximately equal sub-ranges: */
+	typedef Internal::ParallelForRange<RangeFunctorParam> Range;
+	Range* ranges=new Range[numRanges];
+	size_t rangeSize=end-begin;
+	for(size_t i=0;i<numRanges;++i)
+		{
+		ranges[i].functor=&functor;
+		ranges[i].begin=begin+(rangeSize*i)/numRanges;
+		ranges[i].end=begin+(rangeSize*(i+1))/numRanges;
+		}
+
+	/* Start helper threads for all but the last sub-range: */
+	Thread* threads=new Thread[numRanges-1];
+	for(size_t i=0;i<numRanges-1;++i)
+		threads[i].start(&ranges[i],&Range::run);
+
+	/* Process the last sub-range in the calling thread: */
+	try
+		{
+		functor(ranges[numRanges-1].begin,ranges[numRanges-1].end);
+		}
+	catch(...)
+		{
+		/* Wait for the helper threads before propagating the exception: */
+		delete[] threads;
+		delete[] ranges;
+		throw;
+		}
+
+	/* Wait for all helper threads to finish (thread destructors join): */
+	delete[] threads;
+
+	/* Rethrow the first exception thrown in a helper thread: */
+	for(size_t i=0;i<numRanges-1;++i)
+		if(ranges[i].failed)
+			{
+			std::string error=ranges[i].error;
+			delete[] ranges;
+			throw std::runtime_error(error);
+			}
+	delete[] ranges;
+	}
+
+}
+
+#endif
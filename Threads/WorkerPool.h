@@ -0,0 +1,140 @@
+/***********************************************************************
+WorkerPool - Class for a fixed-size pool of threads that execute queued
+background jobs in first-in, first-out order.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_WORKERPOOL_INCLUDED
+#define THREADS_WORKERPOOL_INCLUDED
+
+#include <stddef.h>
+#include <deque>
+#include <Threads/Thread.h>
+#include <Threads/MutexCond.h>
+
+namespace Threads {
+
+class WorkerPool
+	{
+	/* Embedded classes: */
+	public:
+	class Job // Abstract base class for background jobs
+		{
+		/* Constructors and destructors: */
+		public:
+		virtual ~Job(void)
+			{
+			}
+
+		/* Methods: */
+		virtual void execute(void) =0; // Executes the job in one of the pool's worker threads
+		};
+
+	/* Elements: */
+	private:
+	MutexCond queueCond; // Condition variable protecting the job queue and signaling new jobs
+	std::deque<Job*> jobQueue; // Queue of jobs waiting for execution
+	bool shutdown; // Flag to tell worker threads to exit
+	unsigned int numThreads; // Number of worker threads
+	Thread* threads; // Array of worker threads
+
+	/* Private methods: */
+	void* workerThreadMethod(void) // Method run by each worker thread
+		{
+		while(true)
+			{
+			/* Wait for the next job: */
+			Job* job;
+			{
+			MutexCond::Lock queueLock(queueCond);
+			while(!shutdown&&jobQueue.empty())
+				queueCond.wait(queueLock);
+			if(shutdown)
+				break;
+			job=jobQueue.front();
+			jobQueue.pop_front();
+			}
+
+			/* Execute and destroy the job; jobs are expected to handle their own errors: */
+			try
+				{
+				job->execute();
+				}
+			catch(...)
+				{
+				}
+			delete job;
+			}
+
+		return 0;
+		}
+
+	/* Constructors and destructors: */
+	public:
+	WorkerPool(unsigned int sNumThreads) // Creates a worker pool with the given number of threads
+		:shutdown(false),
+		 numThreads(sNumThreads>0?sNumThreads:1),
+		 threads(new Thread[numThreads])
+		{
+		/* Start all worker threads: */
+		for(unsigned int i=0;i<numThreads;++i)
+			threads[i].start(this,&WorkerPool::workerThreadMethod);
+		}
+	private:
+	WorkerPool(const WorkerPool& source); // Prohibit copy constructor
+	WorkerPool& operator=(const WorkerPool& source); // Prohibit assignment operator
+	public:
+	~WorkerPool(void) // Waits for all executing jobs to finish and destroys all jobs still in the queue
+		{
+		/* Tell all worker threads to exit: */
+		{
+		MutexCond::Lock queueLock(queueCond);
+		shutdown=true;
+		queueCond.broadcast();
+		}
+
+		/* Wait for all worker threads to exit (thread destructors join): */
+		delete[] threads;
+
+		/* Destroy all unexecuted jobs: */
+		for(std::deque<Job*>::iterator jIt=jobQueue.begin();jIt!=jobQueue.end();++jIt)
+			delete *jIt;
+		}
+
+	/* Methods: */
+	unsigned int getNumThreads(void) const // Returns the number of worker threads
+		{
+		return numThreads;
+		}
+	void submitJob(Job* job) // Adds a job to the end of the queue; pool takes ownership of the job object and deletes it after execution
+		{
+		MutexCond::Lock queueLock(queueCond);
+		jobQueue.push_back(job);
+		queueCond.signal();
+		}
+	size_t getNumQueuedJobs(void) // Returns the number of jobs that have not yet started executing
+		{
+		MutexCond::Lock queueLock(queueCond);
+		return jobQueue.size();
+		}
+	};
+
+}
+
+#endif
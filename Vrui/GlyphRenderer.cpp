@@ -22,6 +22,11 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Vrui/GlyphRenderer.h>
 
+#include <math.h>
+#include <stdio.h>
+#include <stdexcept>
+#include <string>
+#include <algorithm>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
@@ -32,15 +37,354 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GL/GLGeometryWrappers.h>
 #include <GL/GLTransformationWrappers.h>
 #include <GL/GLModels.h>
+#include <GL/GLVertexArrayParts.h>
+#include <GL/GLVertex.h>
+#include <GL/GLShader.h>
+#include <GL/GLLightTracker.h>
+#include <GL/GLExtensionManager.h>
+#include <GL/Extensions/GLARBVertexBufferObject.h>
+#include <GL/Extensions/GLARBDrawInstanced.h>
+#include <GL/Extensions/GLARBShaderObjects.h>
 #include <Images/RGBAImage.h>
 #include <Images/ReadImageFile.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/Viewer.h>
 #include <Vrui/VRScreen.h>
 #include <Vrui/DisplayState.h>
+#include <Vrui/LightsourceManager.h>
 
 namespace Vrui {
 
+namespace {
+
+/****************************************************
+Helper classes and functions for instanced rendering:
+****************************************************/
+
+typedef GLVertex<void,0,void,0,GLfloat,GLfloat,3> GlyphVertex; // Type for vertices of tessellated glyphs
+
+const int maxNumInstances=32; // Maximum number of glyph instances rendered by a single instanced draw call
+
+class GlyphTessellator // Class to tessellate 3D glyphs into independent triangles
+	{
+	/* Elements: */
+	private:
+	std::vector<GlyphVertex>& vertices; // Vertex list receiving the tessellated triangles
+	GLfloat frame[3][3]; // Images of the local x, y, and z axes under the current glyph part transformation
+	GLfloat offset[3]; // Translation of the current glyph part transformation
+	
+	/* Private methods: */
+	void addVertex(const GLfloat normal[3],const GLfloat position[3]) // Adds a vertex in local coordinates
+		{
+		GlyphVertex v;
+		for(int i=0;i<3;++i)
+			{
+			v.normal[i]=frame[0][i]*normal[0]+frame[1][i]*normal[1]+frame[2][i]*normal[2];
+			v.position[i]=offset[i]+frame[0][i]*position[0]+frame[1][i]*position[1]+frame[2][i]*position[2];
+			}
+		vertices.push_back(v);
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	GlyphTessellator(std::vector<GlyphVertex>& sVertices)
+		:vertices(sVertices)
+		{
+		setFrame(0,1,2,0.0f,0.0f,0.0f);
+		}
+	
+	/* Methods: */
+	void setFrame(int xAxis,int yAxis,int zAxis,GLfloat ox,GLfloat oy,GLfloat oz) // Sets the current transformation; local axes map to the given global axes, with negative signs encoded as axis+3
+		{
+		int axes[3];
+		axes[0]=xAxis;
+		axes[1]=yAxis;
+		axes[2]=zAxis;
+		for(int i=0;i<3;++i)
+			{
+			for(int j=0;j<3;++j)
+				frame[i][j]=0.0f;
+			frame[i][axes[i]%3]=axes[i]>=3?-1.0f:1.0f;
+			}
+		offset[0]=ox;
+		offset[1]=oy;
+		offset[2]=oz;
+		}
+	void addTriangle(const GLfloat n0[3],const GLfloat p0[3],const GLfloat n1[3],const GLfloat p1[3],const GLfloat n2[3],const GLfloat p2[3]) // Adds a smooth-shaded triangle
+		{
+		addVertex(n0,p0);
+		addVertex(n1,p1);
+		addVertex(n2,p2);
+		}
+	void addQuad(const GLfloat normal[3],const GLfloat p0[3],const GLfloat p1[3],const GLfloat p2[3],const GLfloat p3[3]) // Adds a flat-shaded quadrilateral
+		{
+		addTriangle(normal,p0,normal,p1,normal,p2);
+		addTriangle(normal,p0,normal,p2,normal,p3);
+		}
+	};
+
+void tessellateBox(GlyphTessellator& tess,const GLfloat center[3],const GLfloat halfSize[3],int sideMask) // Tessellates the given sides of an axis-aligned box
+	{
+	static const GLfloat vertices[8][3]={{-1.0f,-1.0f,-1.0f},{ 1.0f,-1.0f,-1.0f},{-1.0f, 1.0f,-1.0f},{ 1.0f, 1.0f,-1.0f},
+	                                     {-1.0f,-1.0f, 1.0f},{ 1.0f,-1.0f, 1.0f},{-1.0f, 1.0f, 1.0f},{ 1.0f, 1.0f, 1.0f}};
+	static const int sides[6][4]={{0,4,6,2},{1,3,7,5},{0,1,5,4},{2,6,7,3},{0,2,3,1},{4,5,7,6}};
+	static const GLfloat normals[6][3]={{-1.0f, 0.0f, 0.0f},{ 1.0f, 0.0f, 0.0f},{ 0.0f,-1.0f, 0.0f},
+	                                    { 0.0f, 1.0f, 0.0f},{ 0.0f, 0.0f,-1.0f},{ 0.0f, 0.0f, 1.0f}};
+	
+	for(int side=0;side<6;++side)
+		if(sideMask&(1<<side))
+			{
+			GLfloat p[4][3];
+			for(int i=0;i<4;++i)
+				for(int j=0;j<3;++j)
+					p[i][j]=center[j]+vertices[sides[side][i]][j]*halfSize[j];
+			tess.addQuad(normals[side],p[0],p[1],p[2],p[3]);
+			}
+	}
+
+void tessellateWireframeCube(GlyphTessellator& tess,GLfloat cubeSize,GLfloat edgeSize,GLfloat vertexSize) // Same geometry as glDrawWireframeCube
+	{
+	GLfloat cs=cubeSize*0.5f;
+	GLfloat es=edgeSize*0.5f;
+	GLfloat vs=vertexSize*0.5f;
+	GLfloat halfSize[3];
+	GLfloat center[3];
+	
+	/* Tessellate box vertices: */
+	halfSize[0]=halfSize[1]=halfSize[2]=vs;
+	for(int vertex=0;vertex<8;++vertex)
+		{
+		for(int i=0;i<3;++i)
+			center[i]=vertex&(1<<i)?cs:-cs;
+		tessellateBox(tess,center,halfSize,0x3f);
+		}
+	
+	/* Tessellate box edges: */
+	for(int dim=0;dim<3;++dim)
+		{
+		halfSize[0]=halfSize[1]=halfSize[2]=es;
+		halfSize[dim]=cs-vs;
+		for(int edge=0;edge<4;++edge)
+			{
+			center[dim]=0.0f;
+			for(int i=0;i<2;++i)
+				center[(i+dim+1)%3]=edge&(1<<i)?cs:-cs;
+			tessellateBox(tess,center,halfSize,0x3f&~(0x3<<(dim*2)));
+			}
+		}
+	}
+
+void tessellateSphere(GlyphTessellator& tess,GLfloat radius,int numStrips) // Tessellates a sphere by subdividing each face of an icosahedron into numStrips^2 triangles
+	{
+	const GLfloat b0=0.525731112119133606f;
+	const GLfloat b1=0.850650808352039932f;
+	static const GLfloat vUnit[12][3]={{-b0,0.0f, b1},{ b0,0.0f, b1},{-b0,0.0f,-b1},{ b0,0.0f,-b1},
+	                                   {0.0f, b1, b0},{0.0f, b1,-b0},{0.0f,-b1, b0},{0.0f,-b1,-b0},
+	                                   { b1, b0,0.0f},{-b1, b0,0.0f},{ b1,-b0,0.0f},{-b1,-b0,0.0f}};
+	
+	/* Find the icosahedron's faces as triples of mutually adjacent vertices: */
+	for(int i0=0;i0<12;++i0)
+		for(int i1=i0+1;i1<12;++i1)
+			for(int i2=i1+1;i2<12;++i2)
+				{
+				const GLfloat* c[3];
+				c[0]=vUnit[i0];
+				c[1]=vUnit[i1];
+				c[2]=vUnit[i2];
+				bool face=true;
+				for(int i=0;i<3&&face;++i)
+					{
+					const GLfloat* a=c[i];
+					const GLfloat* b=c[(i+1)%3];
+					face=a[0]*b[0]+a[1]*b[1]+a[2]*b[2]>0.25f;
+					}
+				if(!face)
+					continue;
+				
+				/* Orient the face counter-clockwise when seen from the outside: */
+				GLfloat d1[3],d2[3];
+				for(int i=0;i<3;++i)
+					{
+					d1[i]=c[1][i]-c[0][i];
+					d2[i]=c[2][i]-c[0][i];
+					}
+				GLfloat orientation=(d1[1]*d2[2]-d1[2]*d2[1])*c[0][0]+(d1[2]*d2[0]-d1[0]*d2[2])*c[0][1]+(d1[0]*d2[1]-d1[1]*d2[0])*c[0][2];
+				if(orientation<0.0f)
+					std::swap(c[1],c[2]);
+				
+				/* Subdivide the face and project the subdivision vertices onto the sphere: */
+				std::vector<GLfloat> normals;
+				for(int v=0;v<=numStrips;++v)
+					for(int u=0;u<=numStrips-v;++u)
+						{
+						GLfloat w1=GLfloat(u)/GLfloat(numStrips);
+						GLfloat w2=GLfloat(v)/GLfloat(numStrips);
+						GLfloat w0=1.0f-w1-w2;
+						GLfloat n[3];
+						GLfloat nLen=0.0f;
+						for(int i=0;i<3;++i)
+							{
+							n[i]=c[0][i]*w0+c[1][i]*w1+c[2][i]*w2;
+							nLen+=n[i]*n[i];
+							}
+						nLen=sqrtf(nLen);
+						for(int i=0;i<3;++i)
+							normals.push_back(n[i]/nLen);
+						}
+				
+				/* Create the subdivision triangles: */
+				int rowStart=0;
+				for(int v=0;v<numStrips;++v)
+					{
+					int rowLength=numStrips-v+1;
+					int nextRowStart=rowStart+rowLength;
+					for(int u=0;u<rowLength-1;++u)
+						{
+						int vi[4];
+						vi[0]=rowStart+u;
+						vi[1]=rowStart+u+1;
+						vi[2]=nextRowStart+u;
+						vi[3]=nextRowStart+u+1;
+						GLfloat p[4][3];
+						for(int i=0;i<4;++i)
+							for(int j=0;j<3;++j)
+								p[i][j]=normals[vi[i]*3+j]*radius;
+						tess.addTriangle(&normals[vi[0]*3],p[0],&normals[vi[1]*3],p[1],&normals[vi[2]*3],p[2]);
+						if(u<rowLength-2)
+							tess.addTriangle(&normals[vi[1]*3],p[1],&normals[vi[3]*3],p[3],&normals[vi[2]*3],p[2]);
+						}
+					rowStart=nextRowStart;
+					}
+				}
+	}
+
+void tessellateCylinder(GlyphTessellator& tess,GLfloat radius,GLfloat height,int numStrips) // Same geometry as glDrawCylinder
+	{
+	const GLfloat pi=GLfloat(M_PI);
+	
+	GLfloat h=0.5f*height;
+	static const GLfloat bottomNormal[3]={0.0f,0.0f,-1.0f};
+	static const GLfloat topNormal[3]={0.0f,0.0f,1.0f};
+	GLfloat bottomCenter[3]={0.0f,0.0f,-h};
+	GLfloat topCenter[3]={0.0f,0.0f,h};
+	for(int j=0;j<numStrips;++j)
+		{
+		GLfloat n[2][3],bottom[2][3],top[2][3];
+		for(int i=0;i<2;++i)
+			{
+			GLfloat lng=GLfloat(j+i)*(2.0f*pi)/GLfloat(numStrips);
+			n[i][0]=cosf(lng);
+			n[i][1]=sinf(lng);
+			n[i][2]=0.0f;
+			bottom[i][0]=top[i][0]=n[i][0]*radius;
+			bottom[i][1]=top[i][1]=n[i][1]*radius;
+			bottom[i][2]=-h;
+			top[i][2]=h;
+			}
+		
+		/* Tessellate the bottom circle, mantle, and top circle segments: */
+		tess.addTriangle(bottomNormal,bottomCenter,bottomNormal,bottom[1],bottomNormal,bottom[0]);
+		tess.addTriangle(n[0],top[0],n[0],bottom[0],n[1],bottom[1]);
+		tess.addTriangle(n[0],top[0],n[1],bottom[1],n[1],top[1]);
+		tess.addTriangle(topNormal,topCenter,topNormal,top[0],topNormal,top[1]);
+		}
+	}
+
+void tessellateCone(GlyphTessellator& tess,GLfloat radius,GLfloat height,int numStrips) // Same geometry as glDrawCone
+	{
+	const GLfloat pi=GLfloat(M_PI);
+	
+	GLfloat z0=-0.25f*height;
+	GLfloat z1=0.75f*height;
+	GLfloat zn=radius/height;
+	GLfloat nl=sqrtf(1.0f+zn*zn);
+	GLfloat rn=1.0f/nl;
+	zn*=rn;
+	
+	static const GLfloat bottomNormal[3]={0.0f,0.0f,-1.0f};
+	GLfloat bottomCenter[3]={0.0f,0.0f,z0};
+	GLfloat apex[3]={0.0f,0.0f,z1};
+	for(int j=0;j<numStrips;++j)
+		{
+		GLfloat n[3][3],bottom[2][3];
+		for(int i=0;i<3;++i)
+			{
+			/* The apex normal points halfway between the segment's two side normals: */
+			GLfloat lng=(i<2?GLfloat(j+i):GLfloat(j)+0.5f)*(2.0f*pi)/GLfloat(numStrips);
+			GLfloat x=cosf(lng);
+			GLfloat y=sinf(lng);
+			n[i][0]=x*rn;
+			n[i][1]=y*rn;
+			n[i][2]=zn;
+			if(i<2)
+				{
+				bottom[i][0]=x*radius;
+				bottom[i][1]=y*radius;
+				bottom[i][2]=z0;
+				}
+			}
+		
+		/* Tessellate the bottom circle and mantle segments: */
+		tess.addTriangle(bottomNormal,bottomCenter,bottomNormal,bottom[1],bottomNormal,bottom[0]);
+		tess.addTriangle(n[2],apex,n[0],bottom[0],n[1],bottom[1]);
+		}
+	}
+
+void tessellateGlyph(int glyphType,GLfloat glyphSize,std::vector<GlyphVertex>& vertices) // Tessellates a 3D glyph of the given type and size into the same shape as Glyph::render
+	{
+	GlyphTessellator tess(vertices);
+	switch(glyphType)
+		{
+		case Glyph::CONE:
+			/* Rotate the cone's axis onto the y axis and move its apex to the origin: */
+			tess.setFrame(0,5,1,0.0f,-0.75f*glyphSize,0.0f);
+			tessellateCone(tess,0.25f*glyphSize,glyphSize,16);
+			break;
+		
+		case Glyph::CUBE:
+			{
+			GLfloat center[3]={0.0f,0.0f,0.0f};
+			GLfloat halfSize[3]={0.5f*glyphSize,0.5f*glyphSize,0.5f*glyphSize};
+			tessellateBox(tess,center,halfSize,0x3f);
+			break;
+			}
+		
+		case Glyph::SPHERE:
+			tessellateSphere(tess,0.5f*glyphSize,8);
+			break;
+		
+		case Glyph::CROSSBALL:
+			tessellateSphere(tess,0.4f*glyphSize,8);
+			tessellateCylinder(tess,0.125f*glyphSize,1.1f*glyphSize,16);
+			tess.setFrame(0,2,4,0.0f,0.0f,0.0f);
+			tessellateCylinder(tess,0.125f*glyphSize,1.1f*glyphSize,16);
+			tess.setFrame(1,2,0,0.0f,0.0f,0.0f);
+			tessellateCylinder(tess,0.125f*glyphSize,1.1f*glyphSize,16);
+			break;
+		
+		case Glyph::BOX:
+			tessellateWireframeCube(tess,glyphSize,glyphSize*0.075f,glyphSize*0.15f);
+			break;
+		}
+	}
+
+class BatchedGlyphOrder // Functor class to sort batched glyphs by type and material
+	{
+	/* Methods: */
+	public:
+	bool operator()(const GlyphRenderer::BatchedGlyph& g1,const GlyphRenderer::BatchedGlyph& g2) const
+		{
+		return g1.glyphType<g2.glyphType||(g1.glyphType==g2.glyphType&&g1.materialIndex<g2.materialIndex);
+		}
+	};
+
+bool equalMaterials(const GLMaterial& m1,const GLMaterial& m2)
+	{
+	return m1.ambient==m2.ambient&&m1.diffuse==m2.diffuse&&m1.specular==m2.specular&&m1.shininess==m2.shininess&&m1.emission==m2.emission;
+	}
+
+}
+
 /**********************
 Methods of class Glyph:
 **********************/
@@ -187,15 +531,33 @@ Methods of class GlyphRenderer::DataItem:
 GlyphRenderer::DataItem::DataItem(GLContextData& sContextData)
 	:contextData(sContextData),
 	 glyphDisplayLists(glGenLists(Glyph::GLYPHS_END)),
-	 cursorTextureObjectId(0)
+	 cursorTextureObjectId(0),
+	 instancingSupported(GLARBVertexBufferObject::isSupported()&&GLARBDrawInstanced::isSupported()&&GLShader::isSupported()),
+	 vertexBufferObjectId(0),
+	 instancingShader(0),lightTrackerVersion(0),
+	 instanceTranslationsLocation(-1),instanceRotationsLocation(-1)
 	{
 	glGenTextures(1,&cursorTextureObjectId);
+	
+	if(instancingSupported)
+		{
+		/* Initialize the required OpenGL extensions: */
+		GLARBVertexBufferObject::initExtension();
+		GLARBDrawInstanced::initExtension();
+		GLARBShaderObjects::initExtension();
+		
+		/* Create the vertex buffer object: */
+		glGenBuffersARB(1,&vertexBufferObjectId);
+		}
 	}
 
 GlyphRenderer::DataItem::~DataItem(void)
 	{
 	glDeleteLists(glyphDisplayLists,Glyph::GLYPHS_END);
 	glDeleteTextures(1,&cursorTextureObjectId);
+	if(instancingSupported)
+		glDeleteBuffersARB(1,&vertexBufferObjectId);
+	delete instancingShader;
 	}
 
 /******************************
@@ -283,6 +645,24 @@ void GlyphRenderer::initContext(GLContextData& contextData) const
 			glEndList();
 			}
 		}
+	
+	if(dataItem->instancingSupported)
+		{
+		/* Tessellate all 3D glyph types into a single vertex buffer: */
+		std::vector<GlyphVertex> vertices;
+		for(int glyphType=Glyph::CONE;glyphType<Glyph::GLYPHS_END;++glyphType)
+			{
+			dataItem->glyphVertexStarts[glyphType]=GLint(vertices.size());
+			if(glyphType!=Glyph::CURSOR)
+				tessellateGlyph(glyphType,glyphSize,vertices);
+			}
+		dataItem->glyphVertexStarts[Glyph::GLYPHS_END]=GLint(vertices.size());
+		
+		/* Upload the tessellated glyphs: */
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->vertexBufferObjectId);
+		glBufferDataARB(GL_ARRAY_BUFFER_ARB,vertices.size()*sizeof(GlyphVertex),&vertices[0],GL_STATIC_DRAW_ARB);
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+		}
 	}
 
 void GlyphRenderer::renderGlyph(const Glyph& glyph,const OGTransform& transformation,const GlyphRenderer::DataItem* contextDataItem) const
@@ -327,4 +707,230 @@ void GlyphRenderer::renderGlyph(const Glyph& glyph,const OGTransform& transforma
 		}
 	}
 
+void GlyphRenderer::addGlyph(const Glyph& glyph,const OGTransform& transformation,const GlyphRenderer::DataItem* contextDataItem) const
+	{
+	/* Check if the glyph is enabled: */
+	if(glyph.enabled)
+		{
+		/* Find the glyph's material in the batch's material list, checking the most recently added materials first: */
+		unsigned int materialIndex=0;
+		if(glyph.glyphType!=Glyph::CURSOR)
+			{
+			std::vector<GLMaterial>& materials=contextDataItem->batchMaterials;
+			for(materialIndex=(unsigned int)materials.size();materialIndex>0&&!equalMaterials(materials[materialIndex-1],glyph.glyphMaterial);--materialIndex)
+				;
+			if(materialIndex==0)
+				{
+				/* Add a new material: */
+				materials.push_back(glyph.glyphMaterial);
+				materialIndex=(unsigned int)materials.size();
+				}
+			--materialIndex;
+			}
+		
+		/* Add the glyph to the batch: */
+		contextDataItem->batchedGlyphs.push_back(BatchedGlyph(glyph.glyphType,materialIndex,transformation));
+		}
+	}
+
+void GlyphRenderer::renderGlyphBatch(const GlyphRenderer::DataItem* contextDataItem) const
+	{
+	std::vector<BatchedGlyph>& glyphs=contextDataItem->batchedGlyphs;
+	if(glyphs.empty())
+		return;
+	
+	/* Retrieve the modifiable context data item: */
+	DataItem* dataItem=contextDataItem->contextData.retrieveDataItem<DataItem>(this);
+	
+	/* Group the batched glyphs by type and material: */
+	std::sort(glyphs.begin(),glyphs.end(),BatchedGlyphOrder());
+	
+	/* Check whether instanced rendering can be used with the current lighting state: */
+	bool instanced=false;
+	if(dataItem->instancingSupported)
+		{
+		const GLLightTracker& lt=getLightsourceManager()->getLightTracker(dataItem->contextData);
+		if(lt.isLightingEnabled())
+			{
+			/* Check if the instancing shader is outdated: */
+			if(dataItem->instancingShader==0||dataItem->lightTrackerVersion!=lt.getVersion())
+				{
+				delete dataItem->instancingShader;
+				dataItem->instancingShader=0;
+				
+				/* Create the instanced vertex shader source: */
+				char maxNumInstancesString[16];
+				snprintf(maxNumInstancesString,sizeof(maxNumInstancesString),"%d",maxNumInstances);
+				std::string vertexShaderSource="\
+					#extension GL_ARB_draw_instanced : enable\n\
+					\n\
+					uniform vec4 instanceTranslations[";
+				vertexShaderSource.append(maxNumInstancesString);
+				vertexShaderSource.append("]; // Per-instance translations in xyz, scaling factor in w\n\
+					uniform vec4 instanceRotations[");
+				vertexShaderSource.append(maxNumInstancesString);
+				vertexShaderSource.append("]; // Per-instance rotations as unit quaternions\n\
+					\n\
+					vec3 rotate(in vec4 q,in vec3 v)\n\
+						{\n\
+						return v+2.0*cross(q.xyz,cross(q.xyz,v)+v*q.w);\n\
+						}\n\
+					\n");
+				
+				/* Create light accumulation functions for all enabled light sources: */
+				for(int lightIndex=0;lightIndex<lt.getMaxNumLights();++lightIndex)
+					if(lt.getLightState(lightIndex).isEnabled())
+						vertexShaderSource.append(lt.createAccumulateLightFunction(lightIndex));
+				
+				vertexShaderSource.append("\
+					void main()\n\
+						{\n\
+						/* Transform the vertex and normal by the instance's transformation: */\n\
+						vec4 translation=instanceTranslations[gl_InstanceIDARB];\n\
+						vec4 rotation=instanceRotations[gl_InstanceIDARB];\n\
+						vec4 vertexEc=gl_ModelViewMatrix*vec4(translation.xyz+rotate(rotation,gl_Vertex.xyz)*translation.w,1.0);\n\
+						vec3 normalEc=normalize(gl_NormalMatrix*rotate(rotation,gl_Normal));\n\
+						\n\
+						/* Illuminate the vertex: */\n\
+						vec4 ambientDiffuseAccumulator=gl_FrontLightModelProduct.sceneColor;\n\
+						vec4 specularAccumulator=vec4(0.0,0.0,0.0,0.0);\n");
+				for(int lightIndex=0;lightIndex<lt.getMaxNumLights();++lightIndex)
+					if(lt.getLightState(lightIndex).isEnabled())
+						{
+						char call[256];
+						snprintf(call,sizeof(call),"\taccumulateLight%d(vertexEc,normalEc,gl_FrontMaterial.ambient,gl_FrontMaterial.diffuse,gl_FrontMaterial.specular,gl_FrontMaterial.shininess,ambientDiffuseAccumulator,specularAccumulator);\n",lightIndex);
+						vertexShaderSource.append(call);
+						}
+				if(lt.isSpecularColorSeparate())
+					{
+					vertexShaderSource.append("\
+						gl_FrontColor=vec4(ambientDiffuseAccumulator.rgb,gl_FrontMaterial.diffuse.a);\n\
+						gl_FrontSecondaryColor=specularAccumulator;\n");
+					}
+				else
+					vertexShaderSource.append("\tgl_FrontColor=vec4(ambientDiffuseAccumulator.rgb+specularAccumulator.rgb,gl_FrontMaterial.diffuse.a);\n");
+				vertexShaderSource.append("\
+						\n\
+						/* Project the vertex: */\n\
+						gl_ClipVertex=vertexEc;\n\
+						gl_Position=gl_ProjectionMatrix*vertexEc;\n\
+						}\n");
+				
+				try
+					{
+					/* Compile and link the instancing shader: */
+					dataItem->instancingShader=new GLShader;
+					dataItem->instancingShader->compileVertexShaderFromString(vertexShaderSource.c_str());
+					dataItem->instancingShader->linkShader();
+					dataItem->instanceTranslationsLocation=dataItem->instancingShader->getUniformLocation("instanceTranslations");
+					dataItem->instanceRotationsLocation=dataItem->instancingShader->getUniformLocation("instanceRotations");
+					dataItem->lightTrackerVersion=lt.getVersion();
+					}
+				catch(std::runtime_error err)
+					{
+					/* Fall back to display lists for the rest of the context's lifetime: */
+					delete dataItem->instancingShader;
+					dataItem->instancingShader=0;
+					dataItem->instancingSupported=false;
+					}
+				}
+			
+			instanced=dataItem->instancingShader!=0;
+			}
+		}
+	
+	if(instanced)
+		{
+		/* Install the instancing shader and glyph vertex buffer: */
+		dataItem->instancingShader->useProgram();
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->vertexBufferObjectId);
+		GLVertexArrayParts::enable(GlyphVertex::getPartsMask());
+		glVertexPointer((GlyphVertex*)0);
+		}
+	
+	/* Render all groups of glyphs sharing the same type and material: */
+	GLfloat translations[maxNumInstances*4];
+	GLfloat rotations[maxNumInstances*4];
+	std::vector<BatchedGlyph>::iterator gEnd=glyphs.end();
+	for(std::vector<BatchedGlyph>::iterator groupBegin=glyphs.begin();groupBegin!=gEnd;)
+		{
+		/* Find the end of the current group: */
+		std::vector<BatchedGlyph>::iterator groupEnd;
+		for(groupEnd=groupBegin+1;groupEnd!=gEnd&&groupEnd->glyphType==groupBegin->glyphType&&groupEnd->materialIndex==groupBegin->materialIndex;++groupEnd)
+			;
+		
+		if(groupBegin->glyphType==Glyph::CURSOR)
+			{
+			/* Render cursor glyphs individually, as they depend on the current screen: */
+			Glyph cursorGlyph;
+			cursorGlyph.enable(Glyph::CURSOR,cursorGlyph.glyphMaterial);
+			for(std::vector<BatchedGlyph>::iterator gIt=groupBegin;gIt!=groupEnd;++gIt)
+				renderGlyph(cursorGlyph,gIt->transformation,contextDataItem);
+			}
+		else
+			{
+			/* Set the group's material once: */
+			glMaterial(GLMaterialEnums::FRONT,contextDataItem->batchMaterials[groupBegin->materialIndex]);
+			
+			if(instanced)
+				{
+				/* Render the group in chunks of instances: */
+				GLint first=dataItem->glyphVertexStarts[groupBegin->glyphType];
+				GLsizei count=dataItem->glyphVertexStarts[groupBegin->glyphType+1]-first;
+				for(std::vector<BatchedGlyph>::iterator chunkBegin=groupBegin;chunkBegin!=groupEnd;)
+					{
+					/* Upload the chunk's instance transformations: */
+					GLsizei numInstances=0;
+					std::vector<BatchedGlyph>::iterator gIt;
+					for(gIt=chunkBegin;gIt!=groupEnd&&numInstances<maxNumInstances;++gIt,++numInstances)
+						{
+						GLfloat* t=translations+numInstances*4;
+						GLfloat* r=rotations+numInstances*4;
+						const Vector& translation=gIt->transformation.getTranslation();
+						const Scalar* quaternion=gIt->transformation.getRotation().getQuaternion();
+						for(int i=0;i<3;++i)
+							t[i]=GLfloat(translation[i]);
+						t[3]=GLfloat(gIt->transformation.getScaling());
+						for(int i=0;i<4;++i)
+							r[i]=GLfloat(quaternion[i]);
+						}
+					glUniform4fvARB(dataItem->instanceTranslationsLocation,numInstances,translations);
+					glUniform4fvARB(dataItem->instanceRotationsLocation,numInstances,rotations);
+					
+					/* Render all instances in the chunk with a single draw call: */
+					glDrawArraysInstancedARB(GL_TRIANGLES,first,count,numInstances);
+					
+					chunkBegin=gIt;
+					}
+				}
+			else
+				{
+				/* Render the group's glyphs with their display list: */
+				GLuint displayList=contextDataItem->glyphDisplayLists+groupBegin->glyphType;
+				for(std::vector<BatchedGlyph>::iterator gIt=groupBegin;gIt!=groupEnd;++gIt)
+					{
+					glPushMatrix();
+					glMultMatrix(gIt->transformation);
+					glCallList(displayList);
+					glPopMatrix();
+					}
+				}
+			}
+		
+		groupBegin=groupEnd;
+		}
+	
+	if(instanced)
+		{
+		/* Restore OpenGL state: */
+		GLVertexArrayParts::disable(GlyphVertex::getPartsMask());
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+		GLShader::disablePrograms();
+		}
+	
+	/* Clear the batch: */
+	glyphs.clear();
+	contextDataItem->batchMaterials.clear();
+	}
+
 }
@@ -24,16 +24,19 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #define VRUI_GLYPHRENDERER_INCLUDED
 
 #include <string>
+#include <vector>
 #include <GL/gl.h>
 #include <GL/GLMaterial.h>
 #include <GL/GLObject.h>
 #include <GL/GLContextData.h>
+#include <Geometry/OrthogonalTransformation.h>
 #include <Vrui/Geometry.h>
 
 /* Forward declarations: */
 namespace Misc {
 class ConfigurationFileSection;
 }
+class GLShader;
 
 namespace Vrui {
 
@@ -90,6 +93,21 @@ class GlyphRenderer:public GLObject
 	{
 	/* Embedded classes: */
 	public:
+	struct BatchedGlyph // Structure for glyphs submitted for batched rendering
+		{
+		/* Elements: */
+		public:
+		int glyphType; // Type of the glyph
+		unsigned int materialIndex; // Index of the glyph's material in the batch's material list
+		OGTransform transformation; // Transformation from glyph space to current OpenGL model space
+		
+		/* Constructors and destructors: */
+		BatchedGlyph(int sGlyphType,unsigned int sMaterialIndex,const OGTransform& sTransformation)
+			:glyphType(sGlyphType),materialIndex(sMaterialIndex),transformation(sTransformation)
+			{
+			}
+		};
+	
 	struct DataItem:public GLObject::DataItem // Structure for OpenGL per-context data
 		{
 		friend class GlyphRenderer;
@@ -99,6 +117,15 @@ class GlyphRenderer:public GLObject
 		GLContextData& contextData; // Reference to context data structure containing this data item
 		GLuint glyphDisplayLists; // Base ID for consecutive display lists to render glyphs
 		GLuint cursorTextureObjectId; // ID of texture object containing cursor glyph texture
+		bool instancingSupported; // Flag whether the OpenGL context supports instanced rendering of batched glyphs
+		GLuint vertexBufferObjectId; // ID of vertex buffer object containing tessellated 3D glyphs for instanced rendering
+		GLint glyphVertexStarts[Glyph::GLYPHS_END+1]; // Index of the first vertex of each glyph type's triangles in the vertex buffer, plus one past-the-end index
+		GLShader* instancingShader; // Shader to transform and illuminate instanced glyphs; created on demand
+		unsigned int lightTrackerVersion; // Version of the light source state for which the instancing shader was created
+		int instanceTranslationsLocation; // Location of the per-instance translation and scaling array uniform
+		int instanceRotationsLocation; // Location of the per-instance rotation quaternion array uniform
+		mutable std::vector<GLMaterial> batchMaterials; // List of distinct materials used by the glyphs in the current batch
+		mutable std::vector<BatchedGlyph> batchedGlyphs; // List of glyphs submitted for batched rendering since the last flush
 		
 		/* Constructors and destructors: */
 		DataItem(GLContextData& sContextData);
@@ -128,6 +155,8 @@ class GlyphRenderer:public GLObject
 		return contextData.retrieveDataItem<DataItem>(this);
 		}
 	void renderGlyph(const Glyph& glyph,const OGTransform& transformation,const DataItem* contextDataItem) const; // Renders glyph into current OpenGL context
+	void addGlyph(const Glyph& glyph,const OGTransform& transformation,const DataItem* contextDataItem) const; // Adds glyph to the current OpenGL context's batch; glyph will be rendered on the next call to renderGlyphBatch
+	void renderGlyphBatch(const DataItem* contextDataItem) const; // Renders all glyphs batched in the current OpenGL context grouped by type and material, and clears the batch
 	};
 
 }
@@ -1483,14 +1483,14 @@ void InputGraphManager::glRenderAction(GLContextData& contextData) const
 	/* Get the glyph renderer's context data item: */
 	const GlyphRenderer::DataItem* glyphRendererContextDataItem=glyphRenderer->getContextDataItem(contextData);
 	
-	/* Render all input devices in the first input graph level: */
+	/* Batch glyphs for all input devices in the first input graph level: */
 	for(const GraphInputDevice* gid=deviceLevels[0];gid!=0;gid=gid->levelSucc)
 		{
 		/* Check if the device is an ungrabbed virtual input device: */
 		if(gid->grabber==0)
 			virtualInputDevice->renderDevice(gid->device,gid->navigational,glyphRendererContextDataItem,contextData);
 		else
-			glyphRenderer->renderGlyph(gid->deviceGlyph,OGTransform(gid->device->getTransformation()),glyphRendererContextDataItem);
+			glyphRenderer->addGlyph(gid->deviceGlyph,OGTransform(gid->device->getTransformation()),glyphRendererContextDataItem);
 		}
 
 	/* Render all tools in the first input graph level: */
@@ -1500,15 +1500,18 @@ void InputGraphManager::glRenderAction(GLContextData& contextData) const
 	/* Iterate through all higher input graph levels: */
 	for(int level=1;level<=maxGraphLevel;++level)
 		{
-		/* Render all input devices in this level: */
+		/* Batch glyphs for all input devices in this level: */
 		for(const GraphInputDevice* gid=deviceLevels[level];gid!=0;gid=gid->levelSucc)
-			glyphRenderer->renderGlyph(gid->deviceGlyph,OGTransform(gid->device->getTransformation()),glyphRendererContextDataItem);
+			glyphRenderer->addGlyph(gid->deviceGlyph,OGTransform(gid->device->getTransformation()),glyphRendererContextDataItem);
 		
 		/* Render all tools in this level: */
 		for(const GraphTool* gt=toolLevels[level];gt!=0;gt=gt->levelSucc)
 			gt->tool->display(contextData);
 		}
 	
+	/* Render all batched device glyphs grouped by glyph type and material: */
+	glyphRenderer->renderGlyphBatch(glyphRendererContextDataItem);
+	
 	/* Check if there is a tool stack visualization to display: */
 	if(toolStackNode!=0)
 		{
@@ -113,10 +113,10 @@ void ToolKillZone::glRenderAction(GLContextData& contextData) const
 		if(modelVersion!=dataItem->modelVersion)
 			{
 			/* Update and render the kill zone model: */
-			glNewList(dataItem->modelDisplayListId,GL_COMPILE_AND_EXECUTE);
+			contextData.newList(dataItem->modelDisplayListId,GL_COMPILE_AND_EXECUTE);
 			glMaterial(GLMaterialEnums::FRONT,material);
 			renderModel();
-			glEndList();
+			contextData.endList();
 			dataItem->modelVersion=modelVersion;
 			}
 		else
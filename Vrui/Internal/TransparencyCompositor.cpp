@@ -0,0 +1,380 @@
+/***********************************************************************
+TransparencyCompositor - Class to count the fragments generated by
+Vrui's transparency pass, and to composite transparent objects using
+weighted blended order-independent transparency.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Vrui/Internal/TransparencyCompositor.h>
+
+#include <stdexcept>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <GL/GLContextData.h>
+#include <GL/Extensions/GLARBMultitexture.h>
+#include <GL/Extensions/GLARBShaderObjects.h>
+#include <GL/Extensions/GLARBTextureFloat.h>
+#include <GL/Extensions/GLEXTBlendFuncSeparate.h>
+#include <GL/Extensions/GLEXTFramebufferObject.h>
+#include <GL/Extensions/GLEXTFramebufferBlit.h>
+#include <GL/Extensions/GLNVOcclusionQuery.h>
+#include <GL/GLShader.h>
+
+namespace Vrui {
+
+namespace {
+
+/**************
+Shader sources:
+**************/
+
+const char* compositeVertexShaderSource="\
+	void main()\n\
+		{\n\
+		gl_TexCoord[0]=gl_MultiTexCoord0;\n\
+		gl_Position=gl_Vertex;\n\
+		}\n";
+
+const char* compositeFragmentShaderSource="\
+	uniform sampler2D accumulationSampler;\n\
+	uniform sampler2D revealageSampler;\n\
+	\n\
+	void main()\n\
+		{\n\
+		/* Get the accumulated premultiplied color and the fraction of the background that remains visible: */\n\
+		vec4 accumulation=texture2D(accumulationSampler,gl_TexCoord[0].st);\n\
+		float revealage=texture2D(revealageSampler,gl_TexCoord[0].st).r;\n\
+		if(revealage>=1.0)\n\
+			discard;\n\
+		\n\
+		/* Output the average color of all transparent fragments, and the revealage as blending weight: */\n\
+		gl_FragColor=vec4(accumulation.rgb/max(accumulation.a,1.0e-5),revealage);\n\
+		}\n";
+
+/****************
+Helper functions:
+****************/
+
+inline bool isRecordingDisplayList(void)
+	{
+	GLint listIndex;
+	glGetIntegerv(GL_LIST_INDEX,&listIndex);
+	return listIndex!=0;
+	}
+
+}
+
+/*************************************************
+Methods of class TransparencyCompositor::DataItem:
+*************************************************/
+
+TransparencyCompositor::DataItem::DataItem(void)
+	:hasOcclusionQueryExtension(GLNVOcclusionQuery::isSupported()),
+	 fragmentQueryId(0),
+	 hasOrderIndependent(GLARBMultitexture::isSupported()&&GLARBTextureFloat::isSupported()&&GLEXTBlendFuncSeparate::isSupported()&&GLEXTFramebufferObject::isSupported()&&GLEXTFramebufferBlit::isSupported()&&GLShader::isSupported()),
+	 framebufferId(0),depthbufferId(0),
+	 depthBits(0),
+	 compositeShader(0)
+	{
+	for(int i=0;i<2;++i)
+		{
+		bufferTextureIds[i]=0;
+		bufferSize[i]=0;
+		textureSamplerLocs[i]=-1;
+		}
+	
+	if(hasOcclusionQueryExtension)
+		{
+		/* Initialize the occlusion query extension and create the fragment counting query: */
+		GLNVOcclusionQuery::initExtension();
+		glGenOcclusionQueriesNV(1,&fragmentQueryId);
+		}
+	
+	if(hasOrderIndependent)
+		{
+		/* Initialize the required extensions: */
+		GLARBMultitexture::initExtension();
+		GLARBTextureFloat::initExtension();
+		GLEXTBlendFuncSeparate::initExtension();
+		GLEXTFramebufferObject::initExtension();
+		GLEXTFramebufferBlit::initExtension();
+		
+		/* Create the frame buffer, depth buffer, and buffer texture objects; storage is allocated on first use: */
+		glGenFramebuffersEXT(1,&framebufferId);
+		glGenRenderbuffersEXT(1,&depthbufferId);
+		glGenTextures(2,bufferTextureIds);
+		}
+	}
+
+TransparencyCompositor::DataItem::~DataItem(void)
+	{
+	if(hasOcclusionQueryExtension)
+		glDeleteOcclusionQueriesNV(1,&fragmentQueryId);
+	if(framebufferId!=0)
+		{
+		glDeleteFramebuffersEXT(1,&framebufferId);
+		glDeleteRenderbuffersEXT(1,&depthbufferId);
+		glDeleteTextures(2,bufferTextureIds);
+		}
+	delete compositeShader;
+	}
+
+/***************************************
+Methods of class TransparencyCompositor:
+***************************************/
+
+TransparencyCompositor::TransparencyCompositor(void)
+	{
+	}
+
+void TransparencyCompositor::initContext(GLContextData& contextData) const
+	{
+	/* Create a data item and store it in the context: */
+	DataItem* dataItem=new DataItem;
+	contextData.addDataItem(this,dataItem);
+	
+	if(dataItem->hasOrderIndependent)
+		{
+		try
+			{
+			/* Create the composite shader: */
+			dataItem->compositeShader=new GLShader;
+			dataItem->compositeShader->compileVertexShaderFromString(compositeVertexShaderSource);
+			dataItem->compositeShader->compileFragmentShaderFromString(compositeFragmentShaderSource);
+			dataItem->compositeShader->linkShader();
+			
+			/* Get the shader's texture sampler uniform locations: */
+			dataItem->textureSamplerLocs[0]=dataItem->compositeShader->getUniformLocation("accumulationSampler");
+			dataItem->textureSamplerLocs[1]=dataItem->compositeShader->getUniformLocation("revealageSampler");
+			}
+		catch(std::runtime_error)
+			{
+			/* Fall back to sorted transparency: */
+			delete dataItem->compositeShader;
+			dataItem->compositeShader=0;
+			dataItem->hasOrderIndependent=false;
+			}
+		}
+	}
+
+bool TransparencyCompositor::beginCounting(GLContextData& contextData) const
+	{
+	/* Get the data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem==0||!dataItem->hasOcclusionQueryExtension)
+		return false;
+	
+	/* Frame buffer and query commands are not compiled into display lists; bail out while the scene is recorded for multi-view rendering: */
+	if(isRecordingDisplayList())
+		return false;
+	
+	/* Start counting fragments: */
+	glBeginOcclusionQueryNV(dataItem->fragmentQueryId);
+	return true;
+	}
+
+unsigned int TransparencyCompositor::endCounting(GLContextData& contextData) const
+	{
+	/* Get the data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	
+	/* Stop counting fragments and wait for the result: */
+	glEndOcclusionQueryNV();
+	GLuint numFragments=0;
+	glGetOcclusionQueryuivNV(dataItem->fragmentQueryId,GL_PIXEL_COUNT_NV,&numFragments);
+	
+	return numFragments;
+	}
+
+bool TransparencyCompositor::beginAccumulation(GLContextData& contextData) const
+	{
+	/* Get the data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem==0||!dataItem->hasOrderIndependent)
+		return false;
+	
+	/* Frame buffer and query commands are not compiled into display lists; bail out while the scene is recorded for multi-view rendering: */
+	if(isRecordingDisplayList())
+		return false;
+	
+	/* Remember the current frame buffer and viewport: */
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT,&dataItem->savedFramebufferId);
+	glGetIntegerv(GL_VIEWPORT,dataItem->savedViewport);
+	GLsizei width=dataItem->savedViewport[2];
+	GLsizei height=dataItem->savedViewport[3];
+	
+	/* Check if the buffers need to be reallocated: */
+	GLint depthBits;
+	glGetIntegerv(GL_DEPTH_BITS,&depthBits);
+	GLsizei textureSize[2];
+	for(textureSize[0]=1;textureSize[0]<width;textureSize[0]<<=1)
+		;
+	for(textureSize[1]=1;textureSize[1]<height;textureSize[1]<<=1)
+		;
+	bool reallocate=textureSize[0]!=dataItem->bufferSize[0]||textureSize[1]!=dataItem->bufferSize[1]||depthBits!=dataItem->depthBits;
+	if(reallocate)
+		{
+		/* Allocate the accumulation and revealage textures: */
+		for(int i=0;i<2;++i)
+			{
+			glBindTexture(GL_TEXTURE_2D,dataItem->bufferTextureIds[i]);
+			glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA16F_ARB,textureSize[0],textureSize[1],0,GL_RGBA,GL_FLOAT,0);
+			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP);
+			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP);
+			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+			}
+		glBindTexture(GL_TEXTURE_2D,0);
+		
+		/* Allocate a depth buffer matching the current frame buffer's depth precision so that it can be copied: */
+		glBindRenderbufferEXT(GL_RENDERBUFFER_EXT,dataItem->depthbufferId);
+		GLenum depthFormat=depthBits>=32?GL_DEPTH_COMPONENT32:depthBits>=24?GL_DEPTH_COMPONENT24:GL_DEPTH_COMPONENT16;
+		glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT,depthFormat,textureSize[0],textureSize[1]);
+		glBindRenderbufferEXT(GL_RENDERBUFFER_EXT,0);
+		
+		/* Attach the buffers to the frame buffer: */
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,dataItem->framebufferId);
+		glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT,GL_COLOR_ATTACHMENT0_EXT,GL_TEXTURE_2D,dataItem->bufferTextureIds[0],0);
+		glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT,GL_COLOR_ATTACHMENT1_EXT,GL_TEXTURE_2D,dataItem->bufferTextureIds[1],0);
+		glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT,GL_DEPTH_ATTACHMENT_EXT,GL_RENDERBUFFER_EXT,dataItem->depthbufferId);
+		glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
+		glReadBuffer(GL_COLOR_ATTACHMENT0_EXT);
+		bool complete=glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT)==GL_FRAMEBUFFER_COMPLETE_EXT;
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,dataItem->savedFramebufferId);
+		if(!complete)
+			{
+			/* Fall back to sorted transparency: */
+			dataItem->hasOrderIndependent=false;
+			return false;
+			}
+		
+		dataItem->bufferSize[0]=textureSize[0];
+		dataItem->bufferSize[1]=textureSize[1];
+		dataItem->depthBits=depthBits;
+		
+		/* Clear any pending errors to check the first depth buffer copy below: */
+		while(glGetError()!=GL_NO_ERROR)
+			;
+		}
+	
+	/* Copy the opaque pass's depth buffer so that transparent fragments are occluded correctly: */
+	glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT,dataItem->savedFramebufferId);
+	glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT,dataItem->framebufferId);
+	glBlitFramebufferEXT(dataItem->savedViewport[0],dataItem->savedViewport[1],dataItem->savedViewport[0]+width,dataItem->savedViewport[1]+height,0,0,width,height,GL_DEPTH_BUFFER_BIT,GL_NEAREST);
+	if(reallocate&&glGetError()!=GL_NO_ERROR)
+		{
+		/* The depth buffer formats are incompatible; fall back to sorted transparency: */
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,dataItem->savedFramebufferId);
+		dataItem->hasOrderIndependent=false;
+		return false;
+		}
+	
+	/* Redirect rendering into the accumulation buffer; save state before binding because draw buffers are per-frame buffer state: */
+	glPushAttrib(GL_COLOR_BUFFER_BIT|GL_VIEWPORT_BIT);
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,dataItem->framebufferId);
+	glViewport(0,0,width,height);
+	glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
+	glClearColor(0.0f,0.0f,0.0f,0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	
+	/* Accumulate premultiplied colors and total opacity: */
+	glEnable(GL_BLEND);
+	glBlendFuncSeparateEXT(GL_SRC_ALPHA,GL_ONE,GL_ONE,GL_ONE);
+	
+	return true;
+	}
+
+void TransparencyCompositor::beginRevealage(GLContextData& contextData) const
+	{
+	/* Redirect rendering into the revealage buffer: */
+	glDrawBuffer(GL_COLOR_ATTACHMENT1_EXT);
+	glClearColor(1.0f,1.0f,1.0f,1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	
+	/* Multiply the fraction of the background that remains visible by each fragment's transparency: */
+	glBlendFunc(GL_ZERO,GL_ONE_MINUS_SRC_ALPHA);
+	}
+
+void TransparencyCompositor::composite(GLContextData& contextData) const
+	{
+	/* Get the data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	
+	/* Return to the original frame buffer and OpenGL state: */
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,dataItem->savedFramebufferId);
+	glPopAttrib();
+	
+	/* Prepare to draw a viewport-filling quad: */
+	glPushAttrib(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT|GL_ENABLE_BIT|GL_TEXTURE_BIT);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_CULL_FACE);
+	GLint numClipPlanes;
+	glGetIntegerv(GL_MAX_CLIP_PLANES,&numClipPlanes);
+	for(GLint i=0;i<numClipPlanes;++i)
+		glDisable(GL_CLIP_PLANE0+i);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE_MINUS_SRC_ALPHA,GL_SRC_ALPHA);
+	
+	/* Bind the accumulation and revealage textures: */
+	glActiveTextureARB(GL_TEXTURE1_ARB);
+	glBindTexture(GL_TEXTURE_2D,dataItem->bufferTextureIds[1]);
+	glActiveTextureARB(GL_TEXTURE0_ARB);
+	glBindTexture(GL_TEXTURE_2D,dataItem->bufferTextureIds[0]);
+	
+	/* Install the composite shader: */
+	dataItem->compositeShader->useProgram();
+	glUniform1iARB(dataItem->textureSamplerLocs[0],0);
+	glUniform1iARB(dataItem->textureSamplerLocs[1],1);
+	
+	/* Draw the quad: */
+	GLfloat s=GLfloat(dataItem->savedViewport[2])/GLfloat(dataItem->bufferSize[0]);
+	GLfloat t=GLfloat(dataItem->savedViewport[3])/GLfloat(dataItem->bufferSize[1]);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glBegin(GL_QUADS);
+	glTexCoord2f(0.0f,0.0f);
+	glVertex2f(-1.0f,-1.0f);
+	glTexCoord2f(s,0.0f);
+	glVertex2f(1.0f,-1.0f);
+	glTexCoord2f(s,t);
+	glVertex2f(1.0f,1.0f);
+	glTexCoord2f(0.0f,t);
+	glVertex2f(-1.0f,1.0f);
+	glEnd();
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	
+	/* Restore OpenGL state: */
+	GLShader::disablePrograms();
+	glActiveTextureARB(GL_TEXTURE1_ARB);
+	glBindTexture(GL_TEXTURE_2D,0);
+	glActiveTextureARB(GL_TEXTURE0_ARB);
+	glBindTexture(GL_TEXTURE_2D,0);
+	glPopAttrib();
+	}
+
+}
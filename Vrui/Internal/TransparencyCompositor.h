@@ -0,0 +1,79 @@
+/***********************************************************************
+TransparencyCompositor - Class to count the fragments generated by
+Vrui's transparency pass, and to composite transparent objects using
+weighted blended order-independent transparency.
+Copyright (c) 2011 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef VRUI_INTERNAL_TRANSPARENCYCOMPOSITOR_INCLUDED
+#define VRUI_INTERNAL_TRANSPARENCYCOMPOSITOR_INCLUDED
+
+#include <GL/gl.h>
+#include <GL/GLObject.h>
+
+/* Forward declarations: */
+class GLShader;
+
+namespace Vrui {
+
+class TransparencyCompositor:public GLObject
+	{
+	/* Embedded classes: */
+	private:
+	struct DataItem:public GLObject::DataItem
+		{
+		/* Elements: */
+		public:
+		bool hasOcclusionQueryExtension; // Flag if the local OpenGL supports the NV occlusion query extension
+		GLuint fragmentQueryId; // ID of the occlusion query counting the fragments of a transparency pass
+		bool hasOrderIndependent; // Flag if the local OpenGL supports all features required for order-independent transparency
+		GLuint framebufferId; // ID of the frame buffer object holding the accumulation and revealage buffers
+		GLuint depthbufferId; // ID of the render buffer receiving a copy of the opaque pass's depth buffer
+		GLuint bufferTextureIds[2]; // IDs of the accumulation and revealage textures
+		GLsizei bufferSize[2]; // Current size of the accumulation and revealage buffers
+		GLint depthBits; // Depth buffer precision for which the depth buffer was allocated
+		GLShader* compositeShader; // Shader to composite the accumulated transparent objects over the opaque image
+		int textureSamplerLocs[2]; // Locations of the composite shader's texture sampler uniforms
+		GLint savedFramebufferId; // ID of the frame buffer object that was current at the beginning of accumulation
+		GLint savedViewport[4]; // Viewport that was current at the beginning of accumulation
+		
+		/* Constructors and destructors: */
+		DataItem(void);
+		virtual ~DataItem(void);
+		};
+	
+	/* Constructors and destructors: */
+	public:
+	TransparencyCompositor(void);
+	
+	/* Methods from GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
+	
+	/* New methods: */
+	bool beginCounting(GLContextData& contextData) const; // Starts counting generated fragments; returns false if the OpenGL context does not support fragment counting
+	unsigned int endCounting(GLContextData& contextData) const; // Returns the number of fragments generated since the matching beginCounting call
+	bool beginAccumulation(GLContextData& contextData) const; // Redirects rendering into the accumulation buffer; returns false and leaves OpenGL state unchanged if order-independent transparency is not supported
+	void beginRevealage(GLContextData& contextData) const; // Redirects rendering into the revealage buffer; must be called after a successful beginAccumulation
+	void composite(GLContextData& contextData) const; // Composites the accumulated objects over the original frame buffer and restores OpenGL state
+	};
+
+}
+
+#endif
@@ -553,10 +553,23 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	ambientLightColor=configFileSection.retrieveValue<Color>("./ambientLightColor",ambientLightColor);
 	widgetMaterial=configFileSection.retrieveValue<GLMaterial>("./widgetMaterial",widgetMaterial);
 	
+	/* Configure the transparency rendering pass: */
+	std::string transparencyPassModeName=configFileSection.retrieveString("./transparencyPassMode","Sorted");
+	if(transparencyPassModeName=="Unsorted")
+		TransparentObject::setPassMode(TransparentObject::UNSORTED);
+	else if(transparencyPassModeName=="Sorted")
+		TransparentObject::setPassMode(TransparentObject::SORTED);
+	else if(transparencyPassModeName=="OrderIndependent")
+		TransparentObject::setPassMode(TransparentObject::ORDER_INDEPENDENT);
+	else
+		Misc::throwStdErr("VruiState::initialize: Invalid transparency pass mode %s",transparencyPassModeName.c_str());
+	TransparentObject::setStatisticsEnabled(configFileSection.retrieveValue<bool>("./transparencyPassStatistics",false));
+	
 	/* Create Vrui's default widget style sheet: */
 	GLFont* font=loadFont(configFileSection.retrieveString("./uiFontName","CenturySchoolbookBoldItalic").c_str());
 	font->setTextHeight(configFileSection.retrieveValue<double>("./uiFontTextHeight",1.0*inchScale));
 	font->setAntialiasing(configFileSection.retrieveValue<bool>("./uiFontAntialiasing",true));
+	font->setAtlasRendering(configFileSection.retrieveValue<bool>("./uiFontAtlasRendering",false));
 	uiStyleSheet.setFont(font);
 	uiStyleSheet.setSize(configFileSection.retrieveValue<float>("./uiSize",uiStyleSheet.size));
 	uiStyleSheet.borderColor=uiStyleSheet.bgColor=configFileSection.retrieveValue<Color>("./uiBgColor",uiStyleSheet.bgColor);
@@ -1009,6 +1022,9 @@ void VruiState::update(void)
 
 void VruiState::display(DisplayState* displayState,GLContextData& contextData) const
 	{
+	/* Start sorting transparent objects for the current eye in the background while the opaque pass renders: */
+	TransparentObject::Sorter transparentObjectSorter(displayState->eyePosition);
+	
 	/* Initialize standard OpenGL settings: */
 	glEnable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LEQUAL);
@@ -1095,7 +1111,7 @@ void VruiState::display(DisplayState* displayState,GLContextData& contextData) c
 		glDepthMask(GL_FALSE);
 		
 		/* Execute transparent rendering pass: */
-		TransparentObject::transparencyPass(contextData);
+		TransparentObject::transparencyPass(contextData,transparentObjectSorter);
 		
 		/* Return to standard OpenGL state: */
 		glDisable(GL_BLEND);
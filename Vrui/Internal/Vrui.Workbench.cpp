@@ -61,6 +61,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GLMotif/Popup.h>
 #include <AL/Config.h>
 #include <AL/ALContextData.h>
+#include <SceneGraph/ImageCache.h>
 #include <Vrui/InputDeviceManager.h>
 #include <Vrui/Internal/InputDeviceAdapterMouse.h>
 #include <Vrui/CoordinateManager.h>
@@ -111,6 +112,12 @@ void vruiTerminate(int)
 	vruiAsynchronousShutdown=true;
 	}
 
+/* Callback to redraw when a scene graph texture image finished decoding in the background: */
+void vruiImageFinishedCallback(void*)
+	{
+	requestUpdate();
+	}
+
 /* Generic cleanup function called in case of an error: */
 void vruiErrorShutdown(bool signalError)
 	{
@@ -127,6 +134,7 @@ void vruiErrorShutdown(bool signalError)
 		}
 	
 	/* Clean up: */
+	SceneGraph::ImageCache::setFinishedCallback(0,0);
 	vruiState->finishMainLoop();
 	GLContextData::shutdownThingManager();
 	if(vruiRenderingThreads!=0)
@@ -412,6 +420,9 @@ void init(int& argc,char**& argv,char**&)
 			fcntl(vruiEventPipe[i],F_SETFL,flags|O_NONBLOCK);
 			}
 		
+		/* Replace texture placeholders as soon as their images are decoded: */
+		SceneGraph::ImageCache::setFinishedCallback(vruiImageFinishedCallback,0);
+		
 		/* Get the user configuration file's name: */
 		const char* userConfigFileName=getenv("VRUI_CONFIGFILE");
 		if(userConfigFileName==0)
@@ -1299,6 +1310,9 @@ void mainLoop(void)
 
 void deinit(void)
 	{
+	/* Stop background image decoders from calling into Vrui: */
+	SceneGraph::ImageCache::setFinishedCallback(0,0);
+	
 	/* Clean up: */
 	delete[] vruiApplicationName;
 	delete vruiState;
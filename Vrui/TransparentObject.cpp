@@ -1,7 +1,7 @@
 /***********************************************************************
 TransparentObject - Base class for objects that require a second
 rendering pass with alpha blending enabled.
-Copyright (c) 2007 Oliver Kreylos
+Copyright (c) 2007-2011 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -23,14 +23,145 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Vrui/TransparentObject.h>
 
+#include <pthread.h>
+#include <algorithm>
+#include <Misc/Timer.h>
+#include <Threads/Mutex.h>
+#include <Threads/WorkerPool.h>
+#include <Vrui/DisplayState.h>
+#include <Vrui/Vrui.h>
+#include <Vrui/Internal/TransparencyCompositor.h>
+
 namespace Vrui {
 
+namespace {
+
+/**************
+Helper objects:
+**************/
+
+pthread_once_t sortWorkerOnce=PTHREAD_ONCE_INIT; // Guard to create the sort worker exactly once
+Threads::WorkerPool* sortWorker=0; // Single-threaded pool sorting transparent objects while the opaque pass renders; never destroyed
+
+void createSortWorker(void)
+	{
+	sortWorker=new Threads::WorkerPool(1);
+	}
+
+pthread_once_t compositorOnce=PTHREAD_ONCE_INIT; // Guard to create the transparency compositor exactly once
+TransparencyCompositor* compositor=0; // Compositor for fragment counting and order-independent transparency; never destroyed
+
+void createCompositor(void)
+	{
+	compositor=new TransparencyCompositor;
+	}
+
+Threads::Mutex passStatisticsMutex; // Mutex serializing access to the most recent pass statistics from multiple rendering threads
+TransparentObject::PassStatistics passStatistics={0,0,0,0,0.0}; // Statistics of the most recent transparency pass
+
+}
+
+/*******************************************************
+Declaration of class TransparentObject::Sorter::SortJob:
+*******************************************************/
+
+class TransparentObject::Sorter::SortJob:public Threads::WorkerPool::Job
+	{
+	/* Elements: */
+	private:
+	Sorter& sorter; // The sorter whose objects to sort
+	
+	/* Constructors and destructors: */
+	public:
+	SortJob(Sorter& sSorter)
+		:sorter(sSorter)
+		{
+		}
+	
+	/* Methods from Threads::WorkerPool::Job: */
+	virtual void execute(void)
+		{
+		/* Sort the objects and wake up the rendering thread: */
+		sorter.sort();
+		Threads::MutexCond::Lock sortLock(sorter.sortCond);
+		sorter.sorted=true;
+		sorter.sortCond.broadcast();
+		}
+	};
+
+/******************************************
+Methods of class TransparentObject::Sorter:
+******************************************/
+
+void TransparentObject::Sorter::sort(void)
+	{
+	Misc::Timer sortTimer;
+	
+	/* Separate objects with bounding spheres from those without, retaining the registration order of the latter: */
+	std::vector<const TransparentObject*>::iterator unsortedEnd=objects.begin();
+	for(std::vector<const TransparentObject*>::iterator oIt=objects.begin();oIt!=objects.end();++oIt)
+		{
+		Point center;
+		Scalar radius;
+		if((*oIt)->getBoundingSphere(center,radius))
+			{
+			SortEntry se;
+			se.sqrDist=Geometry::sqrDist(eyePosition,center);
+			se.object=*oIt;
+			sortedObjects.push_back(se);
+			}
+		else
+			*(unsortedEnd++)=*oIt;
+		}
+	objects.erase(unsortedEnd,objects.end());
+	
+	/* Sort the objects with bounding spheres back-to-front: */
+	std::sort(sortedObjects.begin(),sortedObjects.end());
+	
+	sortTimer.elapse();
+	sortTime=sortTimer.getTime();
+	}
+
+void TransparentObject::Sorter::waitForSort(void)
+	{
+	Threads::MutexCond::Lock sortLock(sortCond);
+	while(!sorted)
+		sortCond.wait(sortLock);
+	}
+
+TransparentObject::Sorter::Sorter(const Point& sEyePosition)
+	:eyePosition(sEyePosition),
+	 passMode(TransparentObject::passMode),
+	 sorted(true),
+	 sortTime(0.0)
+	{
+	/* Take a snapshot of the registered objects: */
+	for(const TransparentObject* toPtr=head;toPtr!=0;toPtr=toPtr->succ)
+		objects.push_back(toPtr);
+	
+	if(passMode!=UNSORTED&&!objects.empty())
+		{
+		/* Sort the objects in the background: */
+		sorted=false;
+		pthread_once(&sortWorkerOnce,createSortWorker);
+		sortWorker->submitJob(new SortJob(*this));
+		}
+	}
+
+TransparentObject::Sorter::~Sorter(void)
+	{
+	/* The sort job references this sorter; wait until it is done: */
+	waitForSort();
+	}
+
 /******************************************
 Static elements of class TransparentObject:
 ******************************************/
 
 TransparentObject* TransparentObject::head=0;
 TransparentObject* TransparentObject::tail=0;
+TransparentObject::PassMode TransparentObject::passMode=TransparentObject::SORTED;
+bool TransparentObject::statisticsEnabled=false;
 
 /**********************************
 Methods of class TransparentObject:
@@ -61,11 +192,84 @@ TransparentObject::~TransparentObject(void)
 		tail=pred;
 	}
 
+bool TransparentObject::getBoundingSphere(Point& center,Scalar& radius) const
+	{
+	/* Objects are unsorted by default: */
+	return false;
+	}
+
+void TransparentObject::setPassMode(TransparentObject::PassMode newPassMode)
+	{
+	passMode=newPassMode;
+	if(passMode==ORDER_INDEPENDENT)
+		pthread_once(&compositorOnce,createCompositor);
+	}
+
+void TransparentObject::setStatisticsEnabled(bool newStatisticsEnabled)
+	{
+	statisticsEnabled=newStatisticsEnabled;
+	if(statisticsEnabled)
+		pthread_once(&compositorOnce,createCompositor);
+	}
+
+TransparentObject::PassStatistics TransparentObject::getPassStatistics(void)
+	{
+	Threads::Mutex::Lock passStatisticsLock(passStatisticsMutex);
+	return passStatistics;
+	}
+
+void TransparentObject::transparencyPass(GLContextData& contextData,TransparentObject::Sorter& sorter)
+	{
+	/* Wait for the background sort to complete: */
+	sorter.waitForSort();
+	
+	PassStatistics stats;
+	stats.numObjects=(unsigned int)(sorter.objects.size()+sorter.sortedObjects.size());
+	stats.numSortedObjects=(unsigned int)sorter.sortedObjects.size();
+	stats.numRenderCalls=0;
+	stats.numFragments=0;
+	stats.sortTime=sorter.sortTime;
+	bool counting=statisticsEnabled&&compositor!=0&&compositor->beginCounting(contextData);
+	
+	/* Call rendering method of all objects without bounding spheres in registration order: */
+	for(std::vector<const TransparentObject*>::const_iterator oIt=sorter.objects.begin();oIt!=sorter.objects.end();++oIt,++stats.numRenderCalls)
+		(*oIt)->glRenderActionTransparent(contextData);
+	
+	if(!sorter.sortedObjects.empty())
+		{
+		if(sorter.passMode==ORDER_INDEPENDENT&&compositor!=0&&compositor->beginAccumulation(contextData))
+			{
+			/* Render all objects into the accumulation buffer, then into the revealage buffer, and composite the result: */
+			for(int pass=0;pass<2;++pass)
+				{
+				if(pass==1)
+					compositor->beginRevealage(contextData);
+				for(std::vector<Sorter::SortEntry>::const_iterator soIt=sorter.sortedObjects.begin();soIt!=sorter.sortedObjects.end();++soIt,++stats.numRenderCalls)
+					soIt->object->glRenderActionTransparent(contextData);
+				}
+			compositor->composite(contextData);
+			}
+		else
+			{
+			/* Call rendering method of all objects with bounding spheres back-to-front: */
+			for(std::vector<Sorter::SortEntry>::const_iterator soIt=sorter.sortedObjects.begin();soIt!=sorter.sortedObjects.end();++soIt,++stats.numRenderCalls)
+				soIt->object->glRenderActionTransparent(contextData);
+			}
+		}
+	
+	if(counting)
+		stats.numFragments=compositor->endCounting(contextData);
+	
+	/* Publish the pass statistics: */
+	Threads::Mutex::Lock passStatisticsLock(passStatisticsMutex);
+	passStatistics=stats;
+	}
+
 void TransparentObject::transparencyPass(GLContextData& contextData)
 	{
-	/* Call rendering method of all registered transparent objects: */
-	for(const TransparentObject* toPtr=head;toPtr!=0;toPtr=toPtr->succ)
-		toPtr->glRenderActionTransparent(contextData);
+	/* Sort the registered objects for the current eye and render them: */
+	Sorter sorter(getDisplayState(contextData).eyePosition);
+	transparencyPass(contextData,sorter);
 	}
 
 }
@@ -1,7 +1,7 @@
 /***********************************************************************
 TransparentObject - Base class for objects that require a second
 rendering pass with alpha blending enabled.
-Copyright (c) 2007 Oliver Kreylos
+Copyright (c) 2007-2011 Oliver Kreylos
 
 This file is part of the Virtual Reality User Interface Library (Vrui).
 
@@ -24,6 +24,11 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_TRANSPARENTOBJECT_INCLUDED
 #define VRUI_TRANSPARENTOBJECT_INCLUDED
 
+#include <vector>
+#include <Threads/MutexCond.h>
+#include <Geometry/Point.h>
+#include <Vrui/Geometry.h>
+
 /* Forward declarations: */
 class GLContextData;
 
@@ -31,10 +36,78 @@ namespace Vrui {
 
 class TransparentObject
 	{
+	/* Embedded classes: */
+	public:
+	enum PassMode // Enumerated type for the ways in which the transparency pass composites objects
+		{
+		UNSORTED, // Render all objects in registration order
+		SORTED, // Render objects without bounding spheres in registration order, then objects with bounding spheres back-to-front
+		ORDER_INDEPENDENT // Render objects without bounding spheres in registration order, then composite objects with bounding spheres using weighted blended order-independent transparency
+		};
+	
+	struct PassStatistics // Structure to report the cost of the most recent transparency pass
+		{
+		/* Elements: */
+		public:
+		unsigned int numObjects; // Number of rendered transparent objects
+		unsigned int numSortedObjects; // Number of objects rendered back-to-front or order-independently
+		unsigned int numRenderCalls; // Number of calls to glRenderActionTransparent
+		unsigned int numFragments; // Number of fragments generated during the pass, or 0 if statistics are disabled or not supported by the OpenGL context
+		double sortTime; // Time spent sorting objects in seconds
+		};
+	
+	class Sorter // Class to sort transparent objects back-to-front for one eye in a background thread while the opaque rendering pass is running
+		{
+		friend class TransparentObject;
+		
+		/* Embedded classes: */
+		private:
+		struct SortEntry // Structure associating an object with its sort key
+			{
+			/* Elements: */
+			public:
+			Scalar sqrDist; // Squared distance from the eye to the object's bounding sphere's center
+			const TransparentObject* object; // Pointer to the object
+			
+			/* Methods: */
+			bool operator<(const SortEntry& other) const // Sorts entries far-to-near
+				{
+				return sqrDist>other.sqrDist;
+				}
+			};
+		
+		class SortJob; // Class for background sort jobs
+		friend class SortJob;
+		
+		/* Elements: */
+		Point eyePosition; // Eye position in physical coordinates
+		PassMode passMode; // Pass mode at the time the sorter was created
+		std::vector<const TransparentObject*> objects; // Snapshot of registered objects; after sorting, the objects without bounding spheres in registration order
+		std::vector<SortEntry> sortedObjects; // Objects with bounding spheres in back-to-front order
+		Threads::MutexCond sortCond; // Condition variable signaling completion of the background sort
+		bool sorted; // Flag whether the background sort has completed
+		double sortTime; // Time spent sorting in seconds
+		
+		/* Private methods: */
+		void sort(void); // Queries bounding spheres and sorts the object snapshot
+		void waitForSort(void); // Blocks until the background sort has completed
+		
+		/* Constructors and destructors: */
+		public:
+		Sorter(const Point& sEyePosition); // Takes a snapshot of the currently registered objects and starts sorting them for the given eye position in physical coordinates
+		private:
+		Sorter(const Sorter& source); // Prohibit copy constructor
+		Sorter& operator=(const Sorter& source); // Prohibit assignment operator
+		public:
+		~Sorter(void); // Waits for a background sort to complete
+		};
+	
 	/* Elements: */
 	private:
 	static TransparentObject* head; // Head of the list of transparent objects
 	static TransparentObject* tail; // Tail of the list of transparent objects
+	static PassMode passMode; // Current pass mode
+	static bool statisticsEnabled; // Flag whether to count fragments during each pass
 	TransparentObject* pred; // Pointer to predecessor in the list
 	TransparentObject* succ; // Pointer to successor in the list
 	
@@ -45,11 +118,20 @@ class TransparentObject
 	
 	/* Methods: */
 	virtual void glRenderActionTransparent(GLContextData& contextData) const =0; // Rendering method
+	virtual bool getBoundingSphere(Point& center,Scalar& radius) const; // Returns the object's bounding sphere in physical coordinates and true if the object can be sorted; objects reporting bounding spheres must not change the blending function; called from a background thread during rendering
 	static bool needRenderPass(void) // Returns true if there are any registered transparent objects
 		{
 		return head!=0;
 		}
-	static void transparencyPass(GLContextData& contextData); // Calls the transparent rendering methods of all transparent objects; does not change OpenGL state
+	static PassMode getPassMode(void) // Returns the current pass mode
+		{
+		return passMode;
+		}
+	static void setPassMode(PassMode newPassMode); // Sets the pass mode; order-independent passes fall back to sorted passes in OpenGL contexts that do not support them
+	static void setStatisticsEnabled(bool newStatisticsEnabled); // Enables or disables counting fragments during each pass
+	static PassStatistics getPassStatistics(void); // Returns the statistics of the most recent transparency pass
+	static void transparencyPass(GLContextData& contextData,Sorter& sorter); // Calls the transparent rendering methods of all objects captured by the given sorter; does not change OpenGL state
+	static void transparencyPass(GLContextData& contextData); // Ditto, for all currently registered objects sorted for the current eye
 	};
 
 }
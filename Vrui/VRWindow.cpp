@@ -59,6 +59,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <GL/Extensions/GLARBMultitexture.h>
 #include <GL/Extensions/GLARBShaderObjects.h>
 #include <GL/Extensions/GLEXTFramebufferObject.h>
+#include <GL/Extensions/GLEXTFramebufferBlit.h>
 #include <GL/GLShader.h>
 #include <GL/GLContextData.h>
 #include <GL/GLFont.h>
@@ -337,6 +338,14 @@ void VRWindow::render(const GLWindow::WindowPos& viewportPos,int screenIndex,con
 	OGTransform modelview=OGTransform::translateToOriginFrom(screenEyePos);
 	modelview*=OGTransform(invScreenT);
 	
+	if(multiViewListId!=0)
+		{
+		/* Move the difference between this view and the recorded view into the projection matrix: */
+		glMultMatrix(modelview*Geometry::invert(multiViewModelview));
+		modelview=multiViewModelview;
+		displayState->eyePosition=multiViewEye;
+		}
+	
 	/* Store the physical and navigational modelview matrices: */
 	displayState->modelviewPhysical=modelview;
 	modelview*=getNavigationTransformation();
@@ -344,7 +353,32 @@ void VRWindow::render(const GLWindow::WindowPos& viewportPos,int screenIndex,con
 	displayState->modelviewNavigational=modelview;
 	
 	/* Render Vrui state: */
-	vruiState->display(displayState,*contextData);
+	if(multiViewListId==0||multiViewTruncated)
+		vruiState->display(displayState,*contextData);
+	else if(!multiViewRecorded)
+		{
+		/* Traverse the scene once and record it for the remaining views; display lists compiled via the context data during the traversal are nested into the recording: */
+		contextData->newList(multiViewListId,GL_COMPILE_AND_EXECUTE);
+		vruiState->display(displayState,*contextData);
+		
+		/* Check if a display list compiled directly via glNewList during the traversal ended the recording early: */
+		GLint listIndex=0;
+		glGetIntegerv(GL_LIST_INDEX,&listIndex);
+		contextData->endList();
+		if(listIndex!=0)
+			multiViewRecorded=true;
+		else
+			{
+			/* The recorded list is incomplete; traverse the scene for all remaining views of this frame: */
+			multiViewTruncated=true;
+			}
+		}
+	else
+		{
+		/* Replay the recorded scene: */
+		glCallList(multiViewListId);
+		++numSavedTraversals;
+		}
 	
 	if(protectScreens&&vruiState->numProtectors>0)
 		{
@@ -439,7 +473,22 @@ void VRWindow::render(const GLWindow::WindowPos& viewportPos,int screenIndex,con
 		char buffer[20];
 		snprintf(buffer,sizeof(buffer),"%6.1f fps",1.0/vruiState->currentFrameTime);
 		glDisable(GL_LIGHTING);
-		showFpsFont->drawString(GLFont::Vector(showFpsFont->getCharacterWidth()*9.5f+2.0f,2.0f,0.0f),buffer);
+		GLfloat lineY=2.0f;
+		showFpsFont->drawString(GLFont::Vector(showFpsFont->getCharacterWidth()*9.5f+2.0f,lineY,0.0f),buffer);
+		lineY+=showFpsFont->getTextHeight()+2.0f;
+		if(multiViewListId!=0)
+			{
+			/* Print the number of scene traversals saved by multi-view rendering so far in this frame: */
+			snprintf(buffer,sizeof(buffer),"%3u saved",numSavedTraversals);
+			showFpsFont->drawString(GLFont::Vector(showFpsFont->getCharacterWidth()*9.5f+2.0f,lineY,0.0f),buffer);
+			lineY+=showFpsFont->getTextHeight()+2.0f;
+			}
+		if(arFramebufferId!=0)
+			{
+			/* Print the current resolution scale: */
+			snprintf(buffer,sizeof(buffer),"%3.0f%% res",arScale*100.0);
+			showFpsFont->drawString(GLFont::Vector(showFpsFont->getCharacterWidth()*9.5f+2.0f,lineY,0.0f),buffer);
+			}
 		glEnable(GL_LIGHTING);
 		#endif
 		
@@ -451,6 +500,103 @@ void VRWindow::render(const GLWindow::WindowPos& viewportPos,int screenIndex,con
 		}
 	}
 
+void VRWindow::renderAdaptiveResolution(void)
+	{
+	/* Reallocate the off-screen buffers if the window changed size: */
+	const int* windowSize=GLWindow::getWindowSize();
+	if(arBufferSize[0]!=windowSize[0]||arBufferSize[1]!=windowSize[1])
+		{
+		glBindRenderbufferEXT(GL_RENDERBUFFER_EXT,arColorbufferId);
+		glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT,GL_RGBA8,windowSize[0],windowSize[1]);
+		glBindRenderbufferEXT(GL_RENDERBUFFER_EXT,arDepthbufferId);
+		glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT,GL_DEPTH_COMPONENT,windowSize[0],windowSize[1]);
+		glBindRenderbufferEXT(GL_RENDERBUFFER_EXT,0);
+		
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,arFramebufferId);
+		glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT,GL_COLOR_ATTACHMENT0_EXT,GL_RENDERBUFFER_EXT,arColorbufferId);
+		glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT,GL_DEPTH_ATTACHMENT_EXT,GL_RENDERBUFFER_EXT,arDepthbufferId);
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,0);
+		
+		for(int i=0;i<2;++i)
+			arBufferSize[i]=windowSize[i];
+		}
+	
+	/* Adjust the resolution scale such that the rendered pixel area tracks the ratio of target frame time to measured frame time: */
+	double frameTimeRatio=arTargetFrameTime/vruiState->currentFrameTime;
+	if(frameTimeRatio<0.95||frameTimeRatio>1.05)
+		{
+		/* Take a damped step towards the estimated optimal scale to avoid oscillation caused by the delayed frame time measurement: */
+		arScale*=Math::pow(frameTimeRatio,0.25);
+		if(arScale<arMinScale)
+			arScale=arMinScale;
+		if(arScale>1.0)
+			arScale=1.0;
+		}
+	int scaledSize[2];
+	for(int i=0;i<2;++i)
+		{
+		scaledSize[i]=int(Math::floor(double(windowSize[i])*arScale+0.5));
+		if(scaledSize[i]<1)
+			scaledSize[i]=1;
+		}
+	GLWindow::WindowPos scaledPos(scaledSize[0],scaledSize[1]);
+	
+	/* Render all views into the off-screen buffer and upscale each into the window's back buffer(s): */
+	int numViews=windowType==QUADBUFFER_STEREO?2:1;
+	for(int view=0;view<numViews;++view)
+		{
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,arFramebufferId);
+		glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT);
+		glViewport(0,0,scaledPos.size[0],scaledPos.size[1]);
+		switch(windowType)
+			{
+			case MONO:
+				render(scaledPos,0,viewer->getEyePosition(Viewer::MONO));
+				break;
+			
+			case LEFT:
+				render(scaledPos,0,viewer->getEyePosition(Viewer::LEFT));
+				break;
+			
+			case RIGHT:
+				render(scaledPos,1,viewer->getEyePosition(Viewer::RIGHT));
+				break;
+			
+			case QUADBUFFER_STEREO:
+				displayState->eyeIndex=view;
+				render(scaledPos,view,viewer->getEyePosition(view==0?Viewer::LEFT:Viewer::RIGHT));
+				break;
+			
+			case ANAGLYPHIC_STEREO:
+				/* Render both views with color masks as in the full-resolution path: */
+				glColorMask(GL_TRUE,GL_FALSE,GL_FALSE,GL_FALSE);
+				displayState->eyeIndex=0;
+				render(scaledPos,0,viewer->getEyePosition(Viewer::LEFT));
+				glColorMask(GL_FALSE,GL_TRUE,GL_TRUE,GL_FALSE);
+				displayState->eyeIndex=1;
+				render(scaledPos,1,viewer->getEyePosition(Viewer::RIGHT));
+				glColorMask(GL_TRUE,GL_TRUE,GL_TRUE,GL_TRUE);
+				break;
+			
+			default:
+				;
+			}
+		
+		/* Upscale the rendered view into the window: */
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,0);
+		if(windowType==QUADBUFFER_STEREO)
+			glDrawBuffer(view==0?GL_BACK_LEFT:GL_BACK_RIGHT);
+		else
+			glDrawBuffer(GL_BACK);
+		glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT,arFramebufferId);
+		glBlitFramebufferEXT(0,0,scaledPos.size[0],scaledPos.size[1],0,0,windowSize[0],windowSize[1],GL_COLOR_BUFFER_BIT,arScale<1.0?GL_LINEAR:GL_NEAREST);
+		glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT,0);
+		}
+	
+	/* Reset the viewport to the full window: */
+	glViewport(0,0,windowSize[0],windowSize[1]);
+	}
+
 bool VRWindow::calcMousePos(int x,int y,Scalar mousePos[2]) const
 	{
 	if(windowType==SPLITVIEWPORT_STEREO)
@@ -503,6 +649,10 @@ VRWindow::VRWindow(const char* windowName,const Misc::ConfigurationFileSection&
 	 navigate(configFileSection.retrieveValue<bool>("./navigate",false)),
 	 movePrimaryWidgets(configFileSection.retrieveValue<bool>("./movePrimaryWidgets",false)),
 	 hasFramebufferObjectExtension(false),
+	 multiViewListId(0),multiViewRecorded(false),multiViewTruncated(false),
+	 numSavedTraversals(0),
+	 arTargetFrameTime(0.0),arMinScale(1.0),arScale(1.0),
+	 arFramebufferId(0),arColorbufferId(0),arDepthbufferId(0),
 	 ivEyeIndexOffset(0),
 	 ivRightViewportTextureID(0),ivRightDepthbufferObjectID(0),ivRightFramebufferObjectID(0),
 	 asNumViewZones(0),asViewZoneOffset(0),
@@ -540,6 +690,7 @@ VRWindow::VRWindow(const char* windowName,const Misc::ConfigurationFileSection&
 		ivTextureSize[i]=0;
 		ivTexCoord[i]=0.0f;
 		asNumTiles[i]=0;
+		arBufferSize[i]=0;
 		asTextureSize[i]=0;
 		}
 	for(int i=0;i<4;++i)
@@ -706,6 +857,41 @@ VRWindow::VRWindow(const char* windowName,const Misc::ConfigurationFileSection&
 	if(multisamplingLevel>1)
 		glEnable(GL_MULTISAMPLE_ARB);
 	
+	/* Check if the window should render all its views from a single scene traversal: */
+	if(windowType>=QUADBUFFER_STEREO&&configFileSection.retrieveValue<bool>("./multiViewRendering",false))
+		{
+		/* Create a display list to record the scene once per frame: */
+		multiViewListId=glGenLists(1);
+		}
+	
+	/* Check if the window should adapt its rendering resolution to hold a target frame rate: */
+	if(configFileSection.retrieveValue<bool>("./adaptiveResolution",false))
+		{
+		/* Adaptive resolution upscales with a frame buffer blit, which does not work for multisampled or composited window types: */
+		bool windowTypeSupported=windowType==MONO||windowType==LEFT||windowType==RIGHT||windowType==QUADBUFFER_STEREO||windowType==ANAGLYPHIC_STEREO;
+		if(windowTypeSupported&&multisamplingLevel<=1&&GLEXTFramebufferObject::isSupported()&&GLEXTFramebufferBlit::isSupported())
+			{
+			/* Initialize the extensions: */
+			GLEXTFramebufferObject::initExtension();
+			GLEXTFramebufferBlit::initExtension();
+			
+			/* Read the adaptation parameters: */
+			arTargetFrameTime=1.0/configFileSection.retrieveValue<double>("./adaptiveResolutionTargetFrameRate",60.0);
+			arMinScale=configFileSection.retrieveValue<double>("./adaptiveResolutionMinScale",0.5);
+			if(arMinScale<0.1)
+				arMinScale=0.1;
+			if(arMinScale>1.0)
+				arMinScale=1.0;
+			
+			/* Create the off-screen frame buffer; buffer storage is allocated on the first draw() call: */
+			glGenRenderbuffersEXT(1,&arColorbufferId);
+			glGenRenderbuffersEXT(1,&arDepthbufferId);
+			glGenFramebuffersEXT(1,&arFramebufferId);
+			}
+		else
+			std::cerr<<"VRWindow::VRWindow: Adaptive resolution not supported by window type, multisampling level, or local OpenGL; rendering at full resolution"<<std::endl;
+		}
+	
 	if(windowType==INTERLEAVEDVIEWPORT_STEREO)
 		{
 		/* Create the viewport buffer texture for the right viewport rendering pass: */
@@ -942,6 +1128,14 @@ VRWindow::~VRWindow(void)
 		glDeleteTextures(1,&asViewZoneTextureID);
 		glDeleteTextures(1,&asViewMapTextureID);
 		}
+	if(multiViewListId!=0)
+		glDeleteLists(multiViewListId,1);
+	if(arFramebufferId!=0)
+		{
+		glDeleteFramebuffersEXT(1,&arFramebufferId);
+		glDeleteRenderbuffersEXT(1,&arDepthbufferId);
+		glDeleteRenderbuffersEXT(1,&arColorbufferId);
+		}
 	delete showFpsFont;
 	GLContextData::makeCurrent(0);
 	delete contextData;
@@ -1478,333 +1672,355 @@ void VRWindow::draw(void)
 	/* Update things in the window's GL context data: */
 	contextData->updateThings();
 	
+	numSavedTraversals=0;
+	if(multiViewListId!=0)
+		{
+		/* Record the scene from the mono eye position during the first view rendered in this frame: */
+		multiViewRecorded=false;
+		multiViewTruncated=false;
+		ONTransform invScreenT=screens[0]->getScreenTransformation();
+		invScreenT.doInvert();
+		multiViewEye=viewer->getEyePosition(Viewer::MONO);
+		multiViewModelview=OGTransform::translateToOriginFrom(invScreenT.transform(multiViewEye));
+		multiViewModelview*=OGTransform(invScreenT);
+		}
+	
 	/* Draw the window's contents: */
-	switch(windowType)
+	if(arFramebufferId!=0)
 		{
-		case MONO:
-			/* Render both-eyes view: */
-			glDrawBuffer(GL_BACK);
-			render(getWindowPos(),0,viewer->getEyePosition(Viewer::MONO));
-			break;
-		
-		case LEFT:
-			/* Render left-eye view: */
-			glDrawBuffer(GL_BACK);
-			render(getWindowPos(),0,viewer->getEyePosition(Viewer::LEFT));
-			break;
-		
-		case RIGHT:
-			/* Render right-eye view: */
-			glDrawBuffer(GL_BACK);
-			render(getWindowPos(),1,viewer->getEyePosition(Viewer::RIGHT));
-			break;
-		
-		case QUADBUFFER_STEREO:
-			/* Render left-eye view: */
-			glDrawBuffer(GL_BACK_LEFT);
-			displayState->eyeIndex=0;
-			render(getWindowPos(),0,viewer->getEyePosition(Viewer::LEFT));
-			
-			/* Render right-eye view: */
-			glDrawBuffer(GL_BACK_RIGHT);
-			displayState->eyeIndex=1;
-			render(getWindowPos(),1,viewer->getEyePosition(Viewer::RIGHT));
-			break;
-		
-		case ANAGLYPHIC_STEREO:
-			glDrawBuffer(GL_BACK);
-			
-			/* Render left-eye view: */
-			glColorMask(GL_TRUE,GL_FALSE,GL_FALSE,GL_FALSE);
-			displayState->eyeIndex=0;
-			render(getWindowPos(),0,viewer->getEyePosition(Viewer::LEFT));
-			
-			/* Render right-eye view: */
-			glColorMask(GL_FALSE,GL_TRUE,GL_TRUE,GL_FALSE);
-			displayState->eyeIndex=1;
-			render(getWindowPos(),1,viewer->getEyePosition(Viewer::RIGHT));
-			break;
-		
-		case SPLITVIEWPORT_STEREO:
+		/* Render at the current resolution scale: */
+		renderAdaptiveResolution();
+		}
+	else
+		{
+		/* Render at full resolution: */
+		switch(windowType)
 			{
-			glDrawBuffer(GL_BACK);
+			case MONO:
+				/* Render both-eyes view: */
+				glDrawBuffer(GL_BACK);
+				render(getWindowPos(),0,viewer->getEyePosition(Viewer::MONO));
+				break;
 			
-			/* Render both views into the split viewport: */
-			glEnable(GL_SCISSOR_TEST);
-			for(int eye=0;eye<2;++eye)
-				{
-				glViewport(splitViewportPos[eye].origin[0],splitViewportPos[eye].origin[1],
-				           splitViewportPos[eye].size[0],splitViewportPos[eye].size[1]);
-				glScissor(splitViewportPos[eye].origin[0],splitViewportPos[eye].origin[1],
-				          splitViewportPos[eye].size[0],splitViewportPos[eye].size[1]);
-				displayState->eyeIndex=eye;
-				render(splitViewportPos[eye],eye,viewer->getEyePosition(eye==0?Viewer::LEFT:Viewer::RIGHT));
-				}
-			glDisable(GL_SCISSOR_TEST);
-			break;
-			}
-		
-		case INTERLEAVEDVIEWPORT_STEREO:
-			glDrawBuffer(GL_BACK);
+			case LEFT:
+				/* Render left-eye view: */
+				glDrawBuffer(GL_BACK);
+				render(getWindowPos(),0,viewer->getEyePosition(Viewer::LEFT));
+				break;
 			
-			if(hasFramebufferObjectExtension)
-				{
-				/* Render the left-eye view into the window's default framebuffer: */
+			case RIGHT:
+				/* Render right-eye view: */
+				glDrawBuffer(GL_BACK);
+				render(getWindowPos(),1,viewer->getEyePosition(Viewer::RIGHT));
+				break;
+			
+			case QUADBUFFER_STEREO:
+				/* Render left-eye view: */
+				glDrawBuffer(GL_BACK_LEFT);
 				displayState->eyeIndex=0;
 				render(getWindowPos(),0,viewer->getEyePosition(Viewer::LEFT));
 				
-				/* Render the right-eye view into the right viewport framebuffer: */
-				glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,ivRightFramebufferObjectID);
-				displayState->eyeIndex=1;
-				render(getWindowPos(),1,viewer->getEyePosition(Viewer::RIGHT));
-				
-				/* Re-bind the default framebuffer to get access to the right viewport image as a texture: */
-				glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,0);
-				}
-			else
-				{
-				/* Render the right-eye view into the window's default framebuffer: */
+				/* Render right-eye view: */
+				glDrawBuffer(GL_BACK_RIGHT);
 				displayState->eyeIndex=1;
 				render(getWindowPos(),1,viewer->getEyePosition(Viewer::RIGHT));
+				break;
+			
+			case ANAGLYPHIC_STEREO:
+				glDrawBuffer(GL_BACK);
 				
-				/* Copy the rendered view into the viewport texture: */
-				glBindTexture(GL_TEXTURE_2D,ivRightViewportTextureID);
-				glCopyTexSubImage2D(GL_TEXTURE_2D,0,0,0,0,0,GLWindow::getWindowSize()[0],GLWindow::getWindowSize()[1]);
-				glBindTexture(GL_TEXTURE_2D,0);
-				
-				/* Render the left-eye view into the window's default framebuffer: */
+				/* Render left-eye view: */
+				glColorMask(GL_TRUE,GL_FALSE,GL_FALSE,GL_FALSE);
 				displayState->eyeIndex=0;
 				render(getWindowPos(),0,viewer->getEyePosition(Viewer::LEFT));
-				}
-			
-			/* Set up matrices to render a full-screen quad: */
-			glMatrixMode(GL_PROJECTION);
-			glPushMatrix();
-			glLoadIdentity();
-			glMatrixMode(GL_MODELVIEW);
-			glPushMatrix();
-			glLoadIdentity();
-			glDisable(GL_DEPTH_TEST);
-			
-			/* Set up polygon stippling: */
-			glEnable(GL_POLYGON_STIPPLE);
-			
-			/* Bind the right viewport texture: */
-			glEnable(GL_TEXTURE_2D);
-			glBindTexture(GL_TEXTURE_2D,ivRightViewportTextureID);
-			glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_REPLACE);
-			
-			/* Set the polygon stippling pattern: */
-			glPolygonStipple(ivRightStipplePatterns[ivEyeIndexOffset]);
 				
-			/* Render the quad: */
-			glBegin(GL_QUADS);
-			glTexCoord2f(0.0f,0.0f);
-			glVertex2f(-1.0f,-1.0f);
-			
-			glTexCoord2f(ivTexCoord[0],0.0f);
-			glVertex2f(1.0f,-1.0f);
-			
-			glTexCoord2f(ivTexCoord[0],ivTexCoord[1]);
-			glVertex2f(1.0f,1.0f);
-			
-			glTexCoord2f(0.0f,ivTexCoord[1]);
-			glVertex2f(-1.0f,1.0f);
-			glEnd();
-			
-			/* Reset OpenGL state: */
-			glBindTexture(GL_TEXTURE_2D,0);
-			glDisable(GL_TEXTURE_2D);
-			glDisable(GL_POLYGON_STIPPLE);
-			glEnable(GL_DEPTH_TEST);
-			glMatrixMode(GL_PROJECTION);
-			glPopMatrix();
-			glMatrixMode(GL_MODELVIEW);
-			glPopMatrix();
-			break;
-		
-		case AUTOSTEREOSCOPIC_STEREO:
-			{
-			/* Set up the view zone mapping: */
-			int asTileSize[2];
-			float asTileTexCoord[2];
-			int asQuadSize[2];
-			for(int i=0;i<2;++i)
-				{
-				asTileSize[i]=GLWindow::getWindowSize()[i]/asNumTiles[i];
-				asTileTexCoord[i]=float(asTileSize[i])/float(asTextureSize[i]);
-				asQuadSize[i]=asTileSize[i]*asNumTiles[i];
-				}
+				/* Render right-eye view: */
+				glColorMask(GL_FALSE,GL_TRUE,GL_TRUE,GL_FALSE);
+				displayState->eyeIndex=1;
+				render(getWindowPos(),1,viewer->getEyePosition(Viewer::RIGHT));
+				break;
 			
-			if(hasFramebufferObjectExtension)
+			case SPLITVIEWPORT_STEREO:
 				{
-				/* Bind the framebuffer for view zone rendering: */
-				glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,asFrameBufferObjectID);
+				glDrawBuffer(GL_BACK);
+				
+				/* Render both views into the split viewport: */
+				glEnable(GL_SCISSOR_TEST);
+				for(int eye=0;eye<2;++eye)
+					{
+					glViewport(splitViewportPos[eye].origin[0],splitViewportPos[eye].origin[1],
+					           splitViewportPos[eye].size[0],splitViewportPos[eye].size[1]);
+					glScissor(splitViewportPos[eye].origin[0],splitViewportPos[eye].origin[1],
+					          splitViewportPos[eye].size[0],splitViewportPos[eye].size[1]);
+					displayState->eyeIndex=eye;
+					render(splitViewportPos[eye],eye,viewer->getEyePosition(eye==0?Viewer::LEFT:Viewer::RIGHT));
+					}
+				glDisable(GL_SCISSOR_TEST);
+				break;
 				}
 			
-			/* Calculate the central eye position and the view zone offset vector: */
-			Point asEye=viewer->getEyePosition(Viewer::MONO);
-			Vector asViewZoneOffsetVector=screens[0]->getScreenTransformation().inverseTransform(Vector(asViewZoneOffset,0,0));
-			
-			/* Render the view zones: */
-			glEnable(GL_SCISSOR_TEST);
-			for(int zoneIndex=0;zoneIndex<asNumViewZones;++zoneIndex)
-				{
-				int row=zoneIndex/asNumTiles[0];
-				int col=zoneIndex%asNumTiles[0];
-				glViewport(asTileSize[0]*col,asTileSize[1]*row,asTileSize[0],asTileSize[1]);
-				glScissor(asTileSize[0]*col,asTileSize[1]*row,asTileSize[0],asTileSize[1]);
-				Point eyePos=asEye;
-				eyePos+=asViewZoneOffsetVector*(Scalar(zoneIndex)-Math::div2(Scalar(asNumViewZones-1)));
-				displayState->eyeIndex=zoneIndex;
-				render(GLWindow::WindowPos(asTileSize[0],asTileSize[1]),0,eyePos);
-				}
-			glDisable(GL_SCISSOR_TEST);
+			case INTERLEAVEDVIEWPORT_STEREO:
+				glDrawBuffer(GL_BACK);
+				
+				if(hasFramebufferObjectExtension)
+					{
+					/* Render the left-eye view into the window's default framebuffer: */
+					displayState->eyeIndex=0;
+					render(getWindowPos(),0,viewer->getEyePosition(Viewer::LEFT));
+					
+					/* Render the right-eye view into the right viewport framebuffer: */
+					glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,ivRightFramebufferObjectID);
+					displayState->eyeIndex=1;
+					render(getWindowPos(),1,viewer->getEyePosition(Viewer::RIGHT));
+					
+					/* Re-bind the default framebuffer to get access to the right viewport image as a texture: */
+					glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,0);
+					}
+				else
+					{
+					/* Render the right-eye view into the window's default framebuffer: */
+					displayState->eyeIndex=1;
+					render(getWindowPos(),1,viewer->getEyePosition(Viewer::RIGHT));
+					
+					/* Copy the rendered view into the viewport texture: */
+					glBindTexture(GL_TEXTURE_2D,ivRightViewportTextureID);
+					glCopyTexSubImage2D(GL_TEXTURE_2D,0,0,0,0,0,GLWindow::getWindowSize()[0],GLWindow::getWindowSize()[1]);
+					glBindTexture(GL_TEXTURE_2D,0);
+					
+					/* Render the left-eye view into the window's default framebuffer: */
+					displayState->eyeIndex=0;
+					render(getWindowPos(),0,viewer->getEyePosition(Viewer::LEFT));
+					}
+				
+				/* Set up matrices to render a full-screen quad: */
+				glMatrixMode(GL_PROJECTION);
+				glPushMatrix();
+				glLoadIdentity();
+				glMatrixMode(GL_MODELVIEW);
+				glPushMatrix();
+				glLoadIdentity();
+				glDisable(GL_DEPTH_TEST);
+				
+				/* Set up polygon stippling: */
+				glEnable(GL_POLYGON_STIPPLE);
+				
+				/* Bind the right viewport texture: */
+				glEnable(GL_TEXTURE_2D);
+				glBindTexture(GL_TEXTURE_2D,ivRightViewportTextureID);
+				glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_REPLACE);
+				
+				/* Set the polygon stippling pattern: */
+				glPolygonStipple(ivRightStipplePatterns[ivEyeIndexOffset]);
+				
+				/* Render the quad: */
+				glBegin(GL_QUADS);
+				glTexCoord2f(0.0f,0.0f);
+				glVertex2f(-1.0f,-1.0f);
+				
+				glTexCoord2f(ivTexCoord[0],0.0f);
+				glVertex2f(1.0f,-1.0f);
+				
+				glTexCoord2f(ivTexCoord[0],ivTexCoord[1]);
+				glVertex2f(1.0f,1.0f);
+				
+				glTexCoord2f(0.0f,ivTexCoord[1]);
+				glVertex2f(-1.0f,1.0f);
+				glEnd();
+				
+				/* Reset OpenGL state: */
+				glBindTexture(GL_TEXTURE_2D,0);
+				glDisable(GL_TEXTURE_2D);
+				glDisable(GL_POLYGON_STIPPLE);
+				glEnable(GL_DEPTH_TEST);
+				glMatrixMode(GL_PROJECTION);
+				glPopMatrix();
+				glMatrixMode(GL_MODELVIEW);
+				glPopMatrix();
+				break;
 			
-			/* Read the view zone image into a texture: */
-			if(hasFramebufferObjectExtension)
+			case AUTOSTEREOSCOPIC_STEREO:
 				{
-				/* Unbind the frame buffer to get access to the texture image: */
-				glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,0);
+				/* Set up the view zone mapping: */
+				int asTileSize[2];
+				float asTileTexCoord[2];
+				int asQuadSize[2];
+				for(int i=0;i<2;++i)
+					{
+					asTileSize[i]=GLWindow::getWindowSize()[i]/asNumTiles[i];
+					asTileTexCoord[i]=float(asTileSize[i])/float(asTextureSize[i]);
+					asQuadSize[i]=asTileSize[i]*asNumTiles[i];
+					}
 				
-				/* Bind the view zone texture to texture unit 0: */
-				glActiveTextureARB(GL_TEXTURE0_ARB);
-				glBindTexture(GL_TEXTURE_2D,asViewZoneTextureID);
-				}
-			else
-				{
-				/* Copy the view zone image from the back buffer into the texture image and bind it to texture 0: */
+				if(hasFramebufferObjectExtension)
+					{
+					/* Bind the framebuffer for view zone rendering: */
+					glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,asFrameBufferObjectID);
+					}
+				
+				/* Calculate the central eye position and the view zone offset vector: */
+				Point asEye=viewer->getEyePosition(Viewer::MONO);
+				Vector asViewZoneOffsetVector=screens[0]->getScreenTransformation().inverseTransform(Vector(asViewZoneOffset,0,0));
+				
+				/* Render the view zones: */
+				glEnable(GL_SCISSOR_TEST);
+				for(int zoneIndex=0;zoneIndex<asNumViewZones;++zoneIndex)
+					{
+					int row=zoneIndex/asNumTiles[0];
+					int col=zoneIndex%asNumTiles[0];
+					glViewport(asTileSize[0]*col,asTileSize[1]*row,asTileSize[0],asTileSize[1]);
+					glScissor(asTileSize[0]*col,asTileSize[1]*row,asTileSize[0],asTileSize[1]);
+					Point eyePos=asEye;
+					eyePos+=asViewZoneOffsetVector*(Scalar(zoneIndex)-Math::div2(Scalar(asNumViewZones-1)));
+					displayState->eyeIndex=zoneIndex;
+					render(GLWindow::WindowPos(asTileSize[0],asTileSize[1]),0,eyePos);
+					}
+				glDisable(GL_SCISSOR_TEST);
+				
+				/* Read the view zone image into a texture: */
+				if(hasFramebufferObjectExtension)
+					{
+					/* Unbind the frame buffer to get access to the texture image: */
+					glBindFramebufferEXT(GL_FRAMEBUFFER_EXT,0);
+					
+					/* Bind the view zone texture to texture unit 0: */
+					glActiveTextureARB(GL_TEXTURE0_ARB);
+					glBindTexture(GL_TEXTURE_2D,asViewZoneTextureID);
+					}
+				else
+					{
+					/* Copy the view zone image from the back buffer into the texture image and bind it to texture 0: */
+					glActiveTextureARB(GL_TEXTURE0_ARB);
+					glBindTexture(GL_TEXTURE_2D,asViewZoneTextureID);
+					glCopyTexSubImage2D(GL_TEXTURE_2D,0,0,0,0,0,GLWindow::getWindowSize()[0],GLWindow::getWindowSize()[1]);
+					}
+				
+				/* Bind the view map image to texture unit 1: */
+				glActiveTextureARB(GL_TEXTURE1_ARB);
+				glBindTexture(GL_TEXTURE_2D,asViewMapTextureID);
+				
+				/* Enable the interzigging shader: */
+				asInterzigShader->useProgram();
+				glUniformARB(asInterzigShader->getUniformLocation("viewZonesTexture"),0);
+				glUniformARB(asInterzigShader->getUniformLocation("viewMapTexture"),1);
+				glUniformARB<2>(asQuadSizeUniformIndex,1,asTileTexCoord);
+				
+				/* Set up matrices to render a full-screen quad: */
+				glViewport(0,0,asQuadSize[0],asQuadSize[1]);
+				glMatrixMode(GL_PROJECTION);
+				glPushMatrix();
+				glLoadIdentity();
+				glOrtho(0.0,GLdouble(asQuadSize[0]),0.0,GLdouble(asQuadSize[1]),-1.0,1.0);
+				glMatrixMode(GL_MODELVIEW);
+				glPushMatrix();
+				glLoadIdentity();
+				
+				/* Render the quad: */
+				glBegin(GL_QUADS);
+				glMultiTexCoord2fARB(GL_TEXTURE0_ARB,0.0f,0.0f);
+				glMultiTexCoord2fARB(GL_TEXTURE1_ARB,0.0f,0.0f);
+				glVertex2i(0,0);
+				
+				glMultiTexCoord2fARB(GL_TEXTURE0_ARB,asTileTexCoord[0],0.0f);
+				glMultiTexCoord2fARB(GL_TEXTURE1_ARB,asTileTexCoord[0]*3.0f,0.0f);
+				glVertex2i(asQuadSize[0],0);
+				
+				glMultiTexCoord2fARB(GL_TEXTURE0_ARB,asTileTexCoord[0],asTileTexCoord[1]);
+				glMultiTexCoord2fARB(GL_TEXTURE1_ARB,asTileTexCoord[0]*3.0f,asTileTexCoord[1]*3.0f);
+				glVertex2i(asQuadSize[0],asQuadSize[1]);
+				
+				glMultiTexCoord2fARB(GL_TEXTURE0_ARB,0.0f,asTileTexCoord[1]);
+				glMultiTexCoord2fARB(GL_TEXTURE1_ARB,0.0f,asTileTexCoord[1]*3.0f);
+				glVertex2i(0,asQuadSize[1]);
+				glEnd();
+				
+				/* Reset OpenGL state: */
+				glMatrixMode(GL_PROJECTION);
+				glPopMatrix();
+				glMatrixMode(GL_MODELVIEW);
+				glPopMatrix();
+				GLShader::disablePrograms();
+				glActiveTextureARB(GL_TEXTURE1_ARB);
+				glBindTexture(GL_TEXTURE_2D,0);
 				glActiveTextureARB(GL_TEXTURE0_ARB);
-				glBindTexture(GL_TEXTURE_2D,asViewZoneTextureID);
-				glCopyTexSubImage2D(GL_TEXTURE_2D,0,0,0,0,0,GLWindow::getWindowSize()[0],GLWindow::getWindowSize()[1]);
+				glBindTexture(GL_TEXTURE_2D,0);
+				break;
 				}
+			}
+		
+		/* Check for OpenGL errors: */
+		glPrintError(std::cerr);
+		
+		/* Take a screen shot if requested: */
+		if(saveScreenshot)
+			{
+			/* Wait for the OpenGL pipeline to finish: */
+			glFinish();
 			
-			/* Bind the view map image to texture unit 1: */
-			glActiveTextureARB(GL_TEXTURE1_ARB);
-			glBindTexture(GL_TEXTURE_2D,asViewMapTextureID);
+			/* Create an RGB image of the same size as the window: */
+			Images::RGBImage image(getWindowWidth(),getWindowHeight());
 			
-			/* Enable the interzigging shader: */
-			asInterzigShader->useProgram();
-			glUniformARB(asInterzigShader->getUniformLocation("viewZonesTexture"),0);
-			glUniformARB(asInterzigShader->getUniformLocation("viewMapTexture"),1);
-			glUniformARB<2>(asQuadSizeUniformIndex,1,asTileTexCoord);
+			/* Read the window contents into an RGB image: */
+			image.glReadPixels(0,0);
 			
-			/* Set up matrices to render a full-screen quad: */
-			glViewport(0,0,asQuadSize[0],asQuadSize[1]);
-			glMatrixMode(GL_PROJECTION);
-			glPushMatrix();
-			glLoadIdentity();
-			glOrtho(0.0,GLdouble(asQuadSize[0]),0.0,GLdouble(asQuadSize[1]),-1.0,1.0);
+			/* Save the image buffer to the given image file: */
+			Images::writeImageFile(image,screenshotImageFileName.c_str());
+			
+			#if SAVE_SCREENSHOT_PROJECTION
+			
+			/* Temporarily load the navigation-space modelview matrix: */
 			glMatrixMode(GL_MODELVIEW);
 			glPushMatrix();
 			glLoadIdentity();
+			glMultMatrix(displayState->modelviewNavigational);
 			
-			/* Render the quad: */
-			glBegin(GL_QUADS);
-			glMultiTexCoord2fARB(GL_TEXTURE0_ARB,0.0f,0.0f);
-			glMultiTexCoord2fARB(GL_TEXTURE1_ARB,0.0f,0.0f);
-			glVertex2i(0,0);
+			/* Query the current projection and modelview matrices: */
+			GLdouble proj[16],mv[16];
+			glGetDoublev(GL_PROJECTION_MATRIX,proj);
+			glGetDoublev(GL_MODELVIEW_MATRIX,mv);
 			
-			glMultiTexCoord2fARB(GL_TEXTURE0_ARB,asTileTexCoord[0],0.0f);
-			glMultiTexCoord2fARB(GL_TEXTURE1_ARB,asTileTexCoord[0]*3.0f,0.0f);
-			glVertex2i(asQuadSize[0],0);
+			glPopMatrix();
 			
-			glMultiTexCoord2fARB(GL_TEXTURE0_ARB,asTileTexCoord[0],asTileTexCoord[1]);
-			glMultiTexCoord2fARB(GL_TEXTURE1_ARB,asTileTexCoord[0]*3.0f,asTileTexCoord[1]*3.0f);
-			glVertex2i(asQuadSize[0],asQuadSize[1]);
+			/* Write the matrices to a projection file: */
+			{
+			IO::AutoFile projFile(Vrui::openFile((screenshotImageFileName+".proj").c_str(),Misc::BufferedFile::WriteOnly));
+			projFile->setEndianness(IO::File::LittleEndian);
+			projFile->write(proj,16);
+			projFile->write(mv,16);
+			}
 			
-			glMultiTexCoord2fARB(GL_TEXTURE0_ARB,0.0f,asTileTexCoord[1]);
-			glMultiTexCoord2fARB(GL_TEXTURE1_ARB,0.0f,asTileTexCoord[1]*3.0f);
-			glVertex2i(0,asQuadSize[1]);
-			glEnd();
+			#endif
 			
-			/* Reset OpenGL state: */
-			glMatrixMode(GL_PROJECTION);
-			glPopMatrix();
-			glMatrixMode(GL_MODELVIEW);
-			glPopMatrix();
-			GLShader::disablePrograms();
-			glActiveTextureARB(GL_TEXTURE1_ARB);
-			glBindTexture(GL_TEXTURE_2D,0);
-			glActiveTextureARB(GL_TEXTURE0_ARB);
-			glBindTexture(GL_TEXTURE_2D,0);
-			break;
+			saveScreenshot=false;
 			}
-		}
-	
-	/* Check for OpenGL errors: */
-	glPrintError(std::cerr);
-	
-	/* Take a screen shot if requested: */
-	if(saveScreenshot)
-		{
-		/* Wait for the OpenGL pipeline to finish: */
-		glFinish();
-		
-		/* Create an RGB image of the same size as the window: */
-		Images::RGBImage image(getWindowWidth(),getWindowHeight());
-		
-		/* Read the window contents into an RGB image: */
-		image.glReadPixels(0,0);
-		
-		/* Save the image buffer to the given image file: */
-		Images::writeImageFile(image,screenshotImageFileName.c_str());
-		
-		#if SAVE_SCREENSHOT_PROJECTION
-		
-		/* Temporarily load the navigation-space modelview matrix: */
-		glMatrixMode(GL_MODELVIEW);
-		glPushMatrix();
-		glLoadIdentity();
-		glMultMatrix(displayState->modelviewNavigational);
-		
-		/* Query the current projection and modelview matrices: */
-		GLdouble proj[16],mv[16];
-		glGetDoublev(GL_PROJECTION_MATRIX,proj);
-		glGetDoublev(GL_MODELVIEW_MATRIX,mv);
-		
-		glPopMatrix();
 		
-		/* Write the matrices to a projection file: */
-		{
-		IO::AutoFile projFile(Vrui::openFile((screenshotImageFileName+".proj").c_str(),Misc::BufferedFile::WriteOnly));
-		projFile->setEndianness(IO::File::LittleEndian);
-		projFile->write(proj,16);
-		projFile->write(mv,16);
-		}
-		
-		#endif
+		/* Check if the window is supposed to save a movie: */
+		if(movieSaver!=0)
+			{
+			/* Get a fresh frame buffer: */
+			MovieSaver::FrameBuffer& frameBuffer=movieSaver->startNewFrame();
+			
+			/* Update the frame buffer's size and prepare it for writing: */
+			frameBuffer.setFrameSize(getWindowWidth(),getWindowHeight());
+			frameBuffer.prepareWrite();
+			
+			/* Wait for the OpenGL pipeline to finish: */
+			glFinish();
+			
+			/* Read the window contents into the movie saver's frame buffer: */
+			glPixelStorei(GL_PACK_ALIGNMENT,1);
+			glPixelStorei(GL_PACK_SKIP_PIXELS,0);
+			glPixelStorei(GL_PACK_ROW_LENGTH,0);
+			glPixelStorei(GL_PACK_SKIP_ROWS,0);
+			glReadPixels(0,0,getWindowWidth(),getWindowHeight(),GL_RGB,GL_UNSIGNED_BYTE,frameBuffer.getBuffer());
+			
+			/* Post the new frame: */
+			movieSaver->postNewFrame();
+			}
 		
-		saveScreenshot=false;
+		/* Window is now up-to-date: */
+		resizeViewport=false;
+		dirty=false;
 		}
-	
-	/* Check if the window is supposed to save a movie: */
-	if(movieSaver!=0)
-		{
-		/* Get a fresh frame buffer: */
-		MovieSaver::FrameBuffer& frameBuffer=movieSaver->startNewFrame();
-		
-		/* Update the frame buffer's size and prepare it for writing: */
-		frameBuffer.setFrameSize(getWindowWidth(),getWindowHeight());
-		frameBuffer.prepareWrite();
-		
-		/* Wait for the OpenGL pipeline to finish: */
-		glFinish();
-		
-		/* Read the window contents into the movie saver's frame buffer: */
-		glPixelStorei(GL_PACK_ALIGNMENT,1);
-		glPixelStorei(GL_PACK_SKIP_PIXELS,0);
-		glPixelStorei(GL_PACK_ROW_LENGTH,0);
-		glPixelStorei(GL_PACK_SKIP_ROWS,0);
-		glReadPixels(0,0,getWindowWidth(),getWindowHeight(),GL_RGB,GL_UNSIGNED_BYTE,frameBuffer.getBuffer());
-		
-		/* Post the new frame: */
-		movieSaver->postNewFrame();
 		}
-	
-	/* Window is now up-to-date: */
-	resizeViewport=false;
-	dirty=false;
-	}
 
 }
@@ -28,6 +28,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <string>
 #include <Geometry/Point.h>
 #include <Geometry/Ray.h>
+#include <Geometry/OrthogonalTransformation.h>
 #include <GL/gl.h>
 #include <GL/GLWindow.h>
 #include <Vrui/Geometry.h>
@@ -80,6 +81,23 @@ class VRWindow:public GLWindow
 	Scalar viewports[2][4]; // Viewport borders (left, right, bottom, top) for each VR screen in VR screen coordinates
 	bool hasFramebufferObjectExtension; // Flag whether the local OpenGL supports GL_EXT_framebuffer_object (for interleaved viewport and autostereoscopic stereo modes)
 	
+	/* State for rendering multiple views from a single scene traversal: */
+	GLuint multiViewListId; // ID of the display list recording the scene for all views of the current frame, or 0 if multi-view rendering is disabled
+	bool multiViewRecorded; // Flag whether the scene has been recorded during the current frame
+	bool multiViewTruncated; // Flag whether the recording was cut short by a display list compiled directly via glNewList during the scene traversal, and all views have to traverse the scene during the current frame
+	Point multiViewEye; // Eye position from which the scene is recorded
+	OGTransform multiViewModelview; // Physical modelview matrix with which the scene is recorded
+	unsigned int numSavedTraversals; // Number of scene traversals saved by multi-view rendering during the most recent frame
+	
+	/* State for rendering at a reduced resolution adapted to hold a target frame time: */
+	double arTargetFrameTime; // Frame time the window tries to hold by adjusting its rendering resolution
+	double arMinScale; // Lower limit for the resolution scale factor
+	double arScale; // Current resolution scale factor, 1.0 if the window renders at full resolution
+	GLuint arFramebufferId; // ID of the off-screen frame buffer for reduced-resolution rendering, or 0 if adaptive resolution is disabled
+	GLuint arColorbufferId; // ID of the off-screen frame buffer's color buffer
+	GLuint arDepthbufferId; // ID of the off-screen frame buffer's depth buffer
+	int arBufferSize[2]; // Allocated size of the off-screen buffers
+	
 	/* State for interleaved-viewport stereoscopic rendering: */
 	int ivTextureSize[2]; // Size of off-screen buffer and textures used for interleaved-viewport rendering
 	float ivTexCoord[2]; // Texture coordinates to map the viewport textures to the window
@@ -116,6 +134,7 @@ class VRWindow:public GLWindow
 	static std::string getDisplayName(const Misc::ConfigurationFileSection& configFileSection);
 	static int* getVisualProperties(const Misc::ConfigurationFileSection& configFileSection);
 	void render(const GLWindow::WindowPos& viewportPos,int screenIndex,const Point& eye);
+	void renderAdaptiveResolution(void); // Renders the window's views into the off-screen frame buffer at the current resolution scale and upscales them into the window
 	bool calcMousePos(int x,int y,Scalar mousePos[2]) const; // Returns mouse position in screen coordinates based on window coordinates
 	
 	/* Constructors and destructors: */
@@ -193,6 +212,14 @@ class VRWindow:public GLWindow
 		{
 		return dirty;
 		}
+	double getResolutionScale(void) const // Returns the resolution scale factor used during the most recent frame
+		{
+		return arScale;
+		}
+	unsigned int getNumSavedTraversals(void) const // Returns the number of scene traversals saved by multi-view rendering during the most recent frame
+		{
+		return numSavedTraversals;
+		}
 	void requestScreenshot(const char* sScreenshotImageFileName); // Asks the window to save its contents to the given image file on the next render pass
 	void draw(void); // Redraws the window's contents
 	};
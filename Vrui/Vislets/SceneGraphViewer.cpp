@@ -23,11 +23,18 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Vrui/Vislets/SceneGraphViewer.h>
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <GL/gl.h>
 #include <GL/GLTransformationWrappers.h>
 #include <SceneGraph/NodeCreator.h>
+#include <SceneGraph/InlineNode.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/OcclusionCuller.h>
+#include <SceneGraph/RenderQueue.h>
+#include <SceneGraph/DrawList.h>
 #include <Vrui/Vrui.h>
 #include <Vrui/OpenFile.h>
 #include <Vrui/DisplayState.h>
@@ -107,6 +114,12 @@ Methods of class SceneGraphViewer:
 *********************************/
 
 SceneGraphViewer::SceneGraphViewer(int numArguments,const char* const arguments[])
+	:frustumCulling(true),minProjectedRadius(0),
+	 occlusionCuller(0),
+	 stateSorting(false),
+	 drawList(0),
+	 printStatistics(false),
+	 lastStatisticsTime(0.0)
 	{
 	/* Create a node creator: */
 	SceneGraph::NodeCreator nodeCreator;
@@ -114,16 +127,49 @@ SceneGraphViewer::SceneGraphViewer(int numArguments,const char* const arguments[
 	/* Create the scene graph's root node: */
 	root=new SceneGraph::GroupNode;
 	
-	/* Load all VRML files from the command line: */
+	/* Parse the command line and load all VRML files: */
 	for(int i=0;i<numArguments;++i)
 		{
-		SceneGraph::VRMLFile vrmlFile(arguments[i],Vrui::openFile(arguments[i]),nodeCreator,getClusterMultiplexer());
-		vrmlFile.parse(root);
+		if(arguments[i][0]=='-')
+			{
+			if(strcasecmp(arguments[i]+1,"NOFRUSTUMCULLING")==0)
+				frustumCulling=false;
+			else if(strcasecmp(arguments[i]+1,"MINPROJECTEDRADIUS")==0)
+				{
+				++i;
+				if(i<numArguments)
+					minProjectedRadius=SceneGraph::Scalar(atof(arguments[i]));
+				}
+			else if(strcasecmp(arguments[i]+1,"OCCLUSIONCULLING")==0)
+				{
+				if(occlusionCuller==0)
+					occlusionCuller=new SceneGraph::OcclusionCuller;
+				}
+			else if(strcasecmp(arguments[i]+1,"STATESORTING")==0)
+				stateSorting=true;
+			else if(strcasecmp(arguments[i]+1,"DRAWLIST")==0)
+				{
+				if(drawList==0)
+					drawList=new SceneGraph::DrawList;
+				}
+			else if(strcasecmp(arguments[i]+1,"STATISTICS")==0)
+				printStatistics=true;
+			}
+		else
+			{
+			SceneGraph::VRMLFile vrmlFile(arguments[i],Vrui::openFile(arguments[i]),nodeCreator,getClusterMultiplexer());
+			vrmlFile.parse(root);
+			}
 		}
+	
+	/* Cache the bounding boxes of the root node's children: */
+	root->update();
 	}
 
 SceneGraphViewer::~SceneGraphViewer(void)
 	{
+	delete occlusionCuller;
+	delete drawList;
 	}
 
 VisletFactory* SceneGraphViewer::getFactory(void) const
@@ -143,6 +189,33 @@ void SceneGraphViewer::enable(void)
 	active=true;
 	}
 
+void SceneGraphViewer::frame(void)
+	{
+	/* Swap in any inline nodes that finished loading in the background: */
+	SceneGraph::InlineNode::finishBackgroundLoads(getMainPipe());
+	
+	/* Flatten the scene graph after all of this frame's changes, so the draw list never refers to outdated transformations or removed nodes: */
+	if(drawList!=0)
+		drawList->build(*root);
+	
+	/* Keep checking while there are unfinished loads: */
+	if(SceneGraph::InlineNode::haveBackgroundLoads())
+		scheduleUpdate(getApplicationTime()+0.1);
+	
+	if(printStatistics&&getApplicationTime()>=lastStatisticsTime+1.0)
+		{
+		/* Print the statistics of the most recent traversal: */
+		{
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		printf("SceneGraphViewer: %u nodes visited, %u frustum culled, %u size culled, %u occlusion culled, %u drawn\n",cullingStatistics.numVisited,cullingStatistics.numFrustumCulled,cullingStatistics.numSizeCulled,cullingStatistics.numOcclusionCulled,cullingStatistics.numDrawn);
+		printf("SceneGraphViewer: %u draw calls, %u state changes, %u redundant state changes filtered\n",stateStatistics.numDrawCalls,stateStatistics.numStateChanges,stateStatistics.numRedundantStateChanges);
+		fflush(stdout);
+		}
+		lastStatisticsTime=getApplicationTime();
+		scheduleUpdate(lastStatisticsTime+1.0);
+		}
+	}
+
 void SceneGraphViewer::display(GLContextData& contextData) const
 	{
 	/* Save OpenGL state: */
@@ -155,9 +228,38 @@ void SceneGraphViewer::display(GLContextData& contextData) const
 	
 	/* Create a render state to traverse the scene graph: */
 	SceneGraph::GLRenderState renderState(contextData,getHeadPosition(),getNavigationTransformation().inverseTransform(getUpDirection()));
+	renderState.frustumCullingEnabled=frustumCulling;
+	renderState.minProjectedRadius=minProjectedRadius;
+	renderState.occlusionCuller=occlusionCuller;
+	renderState.time=getApplicationTime();
+	
+	if(drawList!=0)
+		{
+		/* Render the flattened scene graph: */
+		drawList->glRenderAction(renderState);
+		}
+	else if(stateSorting)
+		{
+		/* Traverse the scene graph to record its shapes, then render them sorted by OpenGL state: */
+		SceneGraph::RenderQueue renderQueue;
+		renderState.renderQueue=&renderQueue;
+		root->glRenderAction(renderState);
+		renderState.renderQueue=0;
+		renderQueue.glRenderAction(renderState);
+		}
+	else
+		{
+		/* Traverse the scene graph: */
+		root->glRenderAction(renderState);
+		}
 	
-	/* Traverse the scene graph: */
-	root->glRenderAction(renderState);
+	if(printStatistics)
+		{
+		/* Remember the traversal's statistics: */
+		Threads::Mutex::Lock statisticsLock(statisticsMutex);
+		cullingStatistics=renderState.cullingStatistics;
+		stateStatistics=renderState.stateStatistics;
+		}
 	
 	/* Restore OpenGL state: */
 	glPopMatrix();
@@ -24,10 +24,16 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_VISLETS_SCENEGRAPHVIEWER_INCLUDED
 #define VRUI_VISLETS_SCENEGRAPHVIEWER_INCLUDED
 
+#include <Threads/Mutex.h>
 #include <SceneGraph/GroupNode.h>
+#include <SceneGraph/GLRenderState.h>
 #include <Vrui/Vislet.h>
 
 /* Forward declarations: */
+namespace SceneGraph {
+class OcclusionCuller;
+class DrawList;
+}
 namespace Vrui {
 class VisletManager;
 }
@@ -60,6 +66,16 @@ class SceneGraphViewer:public Vrui::Vislet
 	static SceneGraphViewerFactory* factory; // Pointer to the factory object for this class
 	
 	SceneGraph::GroupNodePointer root; // The scene graph root node
+	bool frustumCulling; // Flag whether to skip nodes outside the view frustum
+	SceneGraph::Scalar minProjectedRadius; // Minimum projected radius of rendered nodes in pixels
+	SceneGraph::OcclusionCuller* occlusionCuller; // Occlusion culler to skip hidden nodes, or null
+	bool stateSorting; // Flag whether to render shapes sorted by OpenGL state through a render queue
+	SceneGraph::DrawList* drawList; // Flattened draw list rebuilt in every frame and rendered instead of traversing the scene graph, or null
+	bool printStatistics; // Flag whether to print culling and state statistics once per second
+	mutable Threads::Mutex statisticsMutex; // Mutex serializing access to the statistics of the most recent traversal
+	mutable SceneGraph::GLRenderState::CullingStatistics cullingStatistics; // Culling statistics of the most recent traversal
+	mutable SceneGraph::GLRenderState::StateStatistics stateStatistics; // State statistics of the most recent traversal
+	double lastStatisticsTime; // Application time at which culling statistics were printed last
 	
 	/* Constructors and destructors: */
 	public:
@@ -71,6 +87,7 @@ class SceneGraphViewer:public Vrui::Vislet
 	virtual VisletFactory* getFactory(void) const;
 	virtual void disable(void);
 	virtual void enable(void);
+	virtual void frame(void);
 	virtual void display(GLContextData& contextData) const;
 	};
 